@@ -112,7 +112,13 @@ const struct Radio_s Radio =
     SX1276ReadBuffer,
     SX1276SetMaxPayloadLength,
     SX1276SetPublicNetwork,
-    SX1276GetWakeupTime
+    SX1276GetWakeupTime,
+#ifdef SX1276_DEFERRED_IRQ_ENABLED
+    SX1276IrqProcess,
+    NULL, // void ( *RxBoosted )( uint32_t timeout )
+    NULL, // void ( *SetRxDutyCycle )( uint32_t rxTime, uint32_t sleepTime )
+    SX1276GetIrqTime
+#endif
 };
 
 uint32_t SX1276GetWakeTime( void )
@@ -0,0 +1,279 @@
+/**
+  ******************************************************************************
+  * @file    modem_engine.c
+  * @author  MCD Application Team
+  * @brief   Non blocking AT command engine: queues the commands, sends each
+  *          one as soon as the previous response is complete, matches the
+  *          response lines and dispatches the unsolicited events
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "stm32l0xx_hal.h"
+#include "timeServer.h"
+#include "modem_uart.h"
+#include "modem_engine.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  char Cmd[MODEM_ENGINE_CMD_SIZE];
+  uint16_t Len;
+  uint32_t Timeout;
+  Modem_Engine_Request_t Request;
+} Modem_Engine_Entry_t;
+
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static const Modem_Engine_Callbacks_t *EngineCallbacks = NULL;
+
+static Modem_Engine_Entry_t Queue[MODEM_ENGINE_QUEUE_SIZE];
+
+static uint8_t QueueHead = 0;                  /* command sent or to be sent next */
+
+static uint8_t QueueCount = 0;
+
+static uint8_t Pending = 0;                    /* the head command has been sent */
+
+static TimerEvent_t ResponseTimer;
+
+static volatile uint8_t ResponseTimeout = 0;   /* set by the timer interrupt */
+
+static char Line[MODEM_ENGINE_LINE_SIZE];
+
+static uint8_t LineOverflow = 0;               /* dropping the end of a long line */
+
+/* Private function prototypes -----------------------------------------------*/
+static void Modem_Engine_OnTimeout(void *context);
+static void Modem_Engine_ParseLine(char *Buffer, uint16_t Len);
+static void Modem_Engine_Complete(Modem_Engine_Status_t Status);
+static void Modem_Engine_SendNext(void);
+
+/* Exported functions ------------------------------------------------------- */
+void Modem_Engine_Init(const Modem_Engine_Callbacks_t *Callbacks)
+{
+  EngineCallbacks = Callbacks;
+  QueueHead = 0;
+  QueueCount = 0;
+  Pending = 0;
+  LineOverflow = 0;
+  ResponseTimeout = 0;
+  TimerInit(&ResponseTimer, Modem_Engine_OnTimeout);
+}
+
+HAL_StatusTypeDef Modem_Engine_Submit(const char *Cmd, uint16_t Len, uint32_t Timeout, uint32_t Tag, void *Data,
+                                      uint16_t DataSize)
+{
+  Modem_Engine_Entry_t *entry;
+
+  if (Len > MODEM_ENGINE_CMD_SIZE)
+  {
+    return HAL_ERROR;
+  }
+  if (QueueCount == MODEM_ENGINE_QUEUE_SIZE)
+  {
+    return HAL_BUSY;
+  }
+
+  entry = &Queue[(QueueHead + QueueCount) % MODEM_ENGINE_QUEUE_SIZE];
+  memcpy(entry->Cmd, Cmd, Len);
+  entry->Len = Len;
+  entry->Timeout = Timeout;
+  entry->Request.Tag = Tag;
+  entry->Request.Data = Data;
+  entry->Request.DataSize = DataSize;
+  entry->Request.Result = 0;
+  QueueCount++;
+  return HAL_OK;
+}
+
+void Modem_Engine_StoreData(Modem_Engine_Request_t *Request, const char *Value)
+{
+  char *data = Request->Data;
+  size_t len = strlen(Value);
+
+  if ((data == NULL) || (Request->DataSize == 0))
+  {
+    Request->Data = NULL;
+    return;
+  }
+  if (len >= Request->DataSize)
+  {
+    len = Request->DataSize - 1;
+  }
+  memcpy(data, Value, len);
+  data[len] = '\0';
+  Request->Data = NULL;
+}
+
+void Modem_Engine_Process(void)
+{
+  uint16_t len;
+
+  if (EngineCallbacks == NULL)
+  {
+    return;
+  }
+
+  /* Lines received so far, the events as well as the responses */
+  while ((len = Modem_UART_ReadLine(Line, sizeof(Line), 0)) != 0)
+  {
+    if (Line[len - 1] != '\n')
+    {
+      /* Longer than the line buffer, dropped up to its end of line */
+      LineOverflow = 1;
+    }
+    else if (LineOverflow != 0)
+    {
+      LineOverflow = 0;
+    }
+    else
+    {
+      Modem_Engine_ParseLine(Line, len);
+    }
+  }
+
+  if (ResponseTimeout != 0)
+  {
+    ResponseTimeout = 0;
+    if (Pending != 0)
+    {
+      Modem_Engine_Complete(MODEM_ENGINE_TIMEOUT);
+    }
+  }
+
+  /* The next command leaves as soon as the previous one is complete */
+  Modem_Engine_SendNext();
+}
+
+uint8_t Modem_Engine_IsIdle(void)
+{
+  return (QueueCount == 0) ? 1 : 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Response timer callback, the timeout is handled by the next
+ *         Modem_Engine_Process call
+ * @param  context unused
+ * @retval None
+ */
+static void Modem_Engine_OnTimeout(void *context)
+{
+  (void)context;
+  ResponseTimeout = 1;
+}
+
+/**
+ * @brief  Splits a received line on its '\r' and '\n', some modems ending
+ *         their events with '\r' only, and hands each non empty part to the
+ *         driver
+ * @param  Buffer received line, modified
+ * @param  Len line length
+ * @retval None
+ */
+static void Modem_Engine_ParseLine(char *Buffer, uint16_t Len)
+{
+  char *end;
+  char last;
+  uint16_t i;
+
+  /* Some modems send a null character when waking up */
+  for (i = 0; i < Len; i++)
+  {
+    if (Buffer[i] == '\0')
+    {
+      Buffer[i] = '\r';
+    }
+  }
+
+  while (*Buffer != '\0')
+  {
+    end = Buffer + strcspn(Buffer, "\r\n");
+    last = *end;
+    *end = '\0';
+    if (end != Buffer)
+    {
+      if ((Pending != 0) && (EngineCallbacks->OnLine(&Queue[QueueHead].Request, Buffer) != 0))
+      {
+        Modem_Engine_Complete(MODEM_ENGINE_OK);
+      }
+      else if (Pending == 0)
+      {
+        EngineCallbacks->OnLine(NULL, Buffer);
+      }
+    }
+    if (last == '\0')
+    {
+      break;
+    }
+    Buffer = end + 1;
+  }
+}
+
+/**
+ * @brief  Ends the head command and notifies the driver
+ * @param  Status completion status
+ * @retval None
+ */
+static void Modem_Engine_Complete(Modem_Engine_Status_t Status)
+{
+  /* Copied so that the driver may queue a command from its callback */
+  Modem_Engine_Request_t request = Queue[QueueHead].Request;
+
+  TimerStop(&ResponseTimer);
+  Pending = 0;
+  QueueHead = (QueueHead + 1) % MODEM_ENGINE_QUEUE_SIZE;
+  QueueCount--;
+
+  EngineCallbacks->OnDone(&request, Status);
+}
+
+/**
+ * @brief  Starts the transmission of the head command when possible
+ * @param  None
+ * @retval None
+ */
+static void Modem_Engine_SendNext(void)
+{
+  Modem_Engine_Entry_t *entry;
+
+  if ((Pending != 0) && (Queue[QueueHead].Timeout == 0) && (Modem_UART_IsTxBusy() == 0))
+  {
+    /* No response awaited, the command buffer is released once sent */
+    Modem_Engine_Complete(MODEM_ENGINE_OK);
+  }
+
+  while ((Pending == 0) && (QueueCount != 0) && (Modem_UART_IsTxBusy() == 0))
+  {
+    entry = &Queue[QueueHead];
+    Pending = 1;
+    if (Modem_UART_SendIT((uint8_t *)entry->Cmd, entry->Len) != HAL_OK)
+    {
+      Modem_Engine_Complete(MODEM_ENGINE_LINK_ERROR);
+    }
+    else if (entry->Timeout != 0)
+    {
+      ResponseTimeout = 0;
+      TimerSetValue(&ResponseTimer, entry->Timeout);
+      TimerStart(&ResponseTimer);
+    }
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
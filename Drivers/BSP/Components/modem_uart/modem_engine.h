@@ -0,0 +1,146 @@
+/**
+  ******************************************************************************
+  * @file    modem_engine.h
+  * @author  MCD Application Team
+  * @brief   Header for modem_engine.c module
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MODEM_ENGINE_H__
+#define __MODEM_ENGINE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm32l0xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Number of commands that can be queued
+ */
+#ifndef MODEM_ENGINE_QUEUE_SIZE
+#define MODEM_ENGINE_QUEUE_SIZE                     4
+#endif
+
+/**
+ * Maximum length of a queued command, the commands are copied
+ */
+#ifndef MODEM_ENGINE_CMD_SIZE
+#define MODEM_ENGINE_CMD_SIZE                       80
+#endif
+
+/**
+ * Maximum length of a received line, longer lines are dropped
+ */
+#ifndef MODEM_ENGINE_LINE_SIZE
+#define MODEM_ENGINE_LINE_SIZE                      128
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  MODEM_ENGINE_OK = 0,         /* the final line of the response was received */
+  MODEM_ENGINE_TIMEOUT,        /* no final line within the command timeout */
+  MODEM_ENGINE_LINK_ERROR,     /* the command could not be transmitted */
+} Modem_Engine_Status_t;
+
+typedef struct
+{
+  uint32_t Tag;                /* set by the driver, e.g. the ATCmd_t */
+  void *Data;                  /* set by the driver, e.g. a GET output buffer */
+  uint16_t DataSize;           /* size of the Data buffer in bytes */
+  int32_t Result;              /* set by the driver from the response lines */
+} Modem_Engine_Request_t;
+
+typedef struct
+{
+  /**
+   * @brief  Handles a line received from the modem, without its end of line
+   * @param  Request command waiting for its response, NULL when none
+   * @param  Line received line
+   * @retval 1 when Line is the final line of the Request response, 0 for
+   *         a response part or an unsolicited event
+   */
+  uint8_t (*OnLine)(Modem_Engine_Request_t *Request, const char *Line);
+  /**
+   * @brief  Notifies the end of a command
+   * @param  Request completed command, only valid during the call
+   * @param  Status completion status
+   * @retval None
+   */
+  void (*OnDone)(Modem_Engine_Request_t *Request, Modem_Engine_Status_t Status);
+} Modem_Engine_Callbacks_t;
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Initializes the engine and drops the queued commands. The modem
+ *         reception must be started (see Modem_UART_Start).
+ * @param  Callbacks driver line parser and completion handler
+ * @retval None
+ */
+void Modem_Engine_Init(const Modem_Engine_Callbacks_t *Callbacks);
+
+/**
+ * @brief  Queues a command. It is sent once the previous ones are completed,
+ *         without waiting for the application.
+ * @param  Cmd complete command, including its end of line
+ * @param  Len command length
+ * @param  Timeout maximum time in ms between the command and its final line,
+ *         0 when no response is awaited (the command completes once sent)
+ * @param  Tag Data DataSize driver request identification, see
+ *         Modem_Engine_Request_t
+ * @retval HAL_OK when queued, HAL_BUSY when the queue is full, HAL_ERROR when
+ *         the command is too long
+ */
+HAL_StatusTypeDef Modem_Engine_Submit(const char *Cmd, uint16_t Len, uint32_t Timeout, uint32_t Tag, void *Data,
+                                      uint16_t DataSize);
+
+/**
+ * @brief  Stores a value string in the Data buffer of a request, truncated to
+ *         its DataSize, and releases the buffer so that the next lines of the
+ *         response are not stored. To be called from the OnLine callback.
+ * @param  Request command waiting for its response
+ * @param  Value null terminated value
+ * @retval None
+ */
+void Modem_Engine_StoreData(Modem_Engine_Request_t *Request, const char *Value);
+
+/**
+ * @brief  Runs the engine: parses the received lines, handles the timeouts
+ *         and sends the next command. Never blocks, to be called from the
+ *         application main loop, which may sleep in between since the modem
+ *         lines and the timeouts wake the MCU up.
+ * @param  None
+ * @retval None
+ */
+void Modem_Engine_Process(void);
+
+/**
+ * @brief  Checks whether commands are queued or in progress
+ * @param  None
+ * @retval 1 when no command is queued, 0 otherwise
+ */
+uint8_t Modem_Engine_IsIdle(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MODEM_ENGINE_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,245 @@
+/**
+  ******************************************************************************
+  * @file    modem_uart.c
+  * @author  MCD Application Team
+  * @brief   AT modem UART transport: DMA circular reception with idle line
+  *          detection, delivering complete lines to the AT parsers while the
+  *          MCU sleeps
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include "stm32l0xx_hal.h"
+#include "modem_uart.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define MODEM_UART_TX_TIMEOUT                       5000   /* ms */
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static UART_HandleTypeDef *ModemUart = NULL;
+
+static uint8_t RxBuffer[MODEM_UART_RX_BUFFER_SIZE];   /* written by the DMA */
+
+static uint16_t RxTail = 0;                           /* next byte to be read */
+
+/* Private function prototypes -----------------------------------------------*/
+static uint16_t Modem_UART_RxHead(void);
+static uint16_t Modem_UART_LineLength(uint16_t Max);
+static void Modem_UART_CheckRx(void);
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef Modem_UART_Start(UART_HandleTypeDef *huart)
+{
+  if ((huart == NULL) || (huart->hdmarx == NULL))
+  {
+    return HAL_ERROR;
+  }
+  ModemUart = huart;
+
+  /* The reception never ends, the DMA wraps around the buffer */
+  if (huart->hdmarx->Init.Mode != DMA_CIRCULAR)
+  {
+    huart->hdmarx->Init.Mode = DMA_CIRCULAR;
+    if (HAL_DMA_Init(huart->hdmarx) != HAL_OK)
+    {
+      return HAL_ERROR;
+    }
+  }
+
+  RxTail = 0;
+  if (HAL_UART_Receive_DMA(huart, RxBuffer, MODEM_UART_RX_BUFFER_SIZE) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  /* The end of each modem burst wakes the MCU up, along with the DMA half
+     and full transfer interrupts, instead of an interrupt per character */
+  __HAL_UART_CLEAR_IDLEFLAG(huart);
+  __HAL_UART_ENABLE_IT(huart, UART_IT_IDLE);
+  return HAL_OK;
+}
+
+void Modem_UART_Stop(void)
+{
+  if (ModemUart != NULL)
+  {
+    __HAL_UART_DISABLE_IT(ModemUart, UART_IT_IDLE);
+    HAL_UART_DMAStop(ModemUart);
+    ModemUart = NULL;
+  }
+}
+
+void Modem_UART_IRQHandler(void)
+{
+  if ((ModemUart != NULL) && (__HAL_UART_GET_FLAG(ModemUart, UART_FLAG_IDLE) != RESET))
+  {
+    /* Nothing else to do, the reader computes the received length from
+       the DMA counter once woken up */
+    __HAL_UART_CLEAR_IDLEFLAG(ModemUart);
+  }
+}
+
+HAL_StatusTypeDef Modem_UART_Send(uint8_t *buf, uint16_t len)
+{
+  if (ModemUart == NULL)
+  {
+    return HAL_ERROR;
+  }
+  return HAL_UART_Transmit(ModemUart, buf, len, MODEM_UART_TX_TIMEOUT);
+}
+
+HAL_StatusTypeDef Modem_UART_SendIT(uint8_t *buf, uint16_t len)
+{
+  if (ModemUart == NULL)
+  {
+    return HAL_ERROR;
+  }
+  return HAL_UART_Transmit_IT(ModemUart, buf, len);
+}
+
+uint8_t Modem_UART_IsTxBusy(void)
+{
+  /* gState only tracks the transmission, the reception is in RxState */
+  return ((ModemUart != NULL) && (ModemUart->gState != HAL_UART_STATE_READY)) ? 1 : 0;
+}
+
+HAL_StatusTypeDef Modem_UART_WaitLine(uint32_t Timeout)
+{
+  uint32_t tickstart = HAL_GetTick();
+  uint16_t head;
+
+  if (ModemUart == NULL)
+  {
+    return HAL_ERROR;
+  }
+
+  while (1)
+  {
+    Modem_UART_CheckRx();
+
+    head = Modem_UART_RxHead();
+    if (Modem_UART_LineLength(MODEM_UART_RX_BUFFER_SIZE - 1) != 0)
+    {
+      return HAL_OK;
+    }
+    if ((HAL_GetTick() - tickstart) >= Timeout)
+    {
+      return HAL_TIMEOUT;
+    }
+
+    /* Sleep until the next interrupt (idle line, DMA transfer or tick). The
+       interrupts are masked so that one occurring after the check above still
+       wakes the core up */
+    __disable_irq();
+    if (Modem_UART_RxHead() == head)
+    {
+      HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+    }
+    __enable_irq();
+  }
+}
+
+uint16_t Modem_UART_ReadLine(char *Line, uint16_t Size, uint32_t Timeout)
+{
+  uint16_t len = 0;
+  uint16_t i;
+
+  /* At least one character and the null: a smaller buffer could never take
+     a line, its 0 would be taken for a timeout after waiting for nothing */
+  assert_param(Size >= 2);
+  if (Size < 2)
+  {
+    if (Size == 1)
+    {
+      Line[0] = '\0';
+    }
+    return 0;
+  }
+
+  if (Modem_UART_WaitLine(Timeout) == HAL_OK)
+  {
+    len = Modem_UART_LineLength(Size - 1);
+    for (i = 0; i < len; i++)
+    {
+      Line[i] = (char)RxBuffer[RxTail];
+      RxTail = (RxTail + 1) % MODEM_UART_RX_BUFFER_SIZE;
+    }
+  }
+  Line[len] = '\0';
+  return len;
+}
+
+void Modem_UART_Flush(void)
+{
+  if (ModemUart != NULL)
+  {
+    RxTail = Modem_UART_RxHead();
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Gets the DMA write index in the reception buffer
+ * @param  None
+ * @retval index of the next byte to be received
+ */
+static uint16_t Modem_UART_RxHead(void)
+{
+  /* The DMA counter holds the number of bytes left before wrapping around */
+  uint16_t head = MODEM_UART_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(ModemUart->hdmarx);
+
+  return (head == MODEM_UART_RX_BUFFER_SIZE) ? 0 : head;
+}
+
+/**
+ * @brief  Gets the length of the next line
+ * @param  Max maximum length returned
+ * @retval length up to and including the next '\n', Max when Max bytes are
+ *         received without '\n', 0 when the line is not complete yet
+ */
+static uint16_t Modem_UART_LineLength(uint16_t Max)
+{
+  uint16_t count = (Modem_UART_RxHead() + MODEM_UART_RX_BUFFER_SIZE - RxTail) % MODEM_UART_RX_BUFFER_SIZE;
+  uint16_t i;
+
+  for (i = 0; (i < count) && (i < Max); i++)
+  {
+    if (RxBuffer[(RxTail + i) % MODEM_UART_RX_BUFFER_SIZE] == '\n')
+    {
+      return i + 1;
+    }
+  }
+  return (count >= Max) ? Max : 0;
+}
+
+/**
+ * @brief  Restarts the reception when a UART error aborted it
+ * @param  None
+ * @retval None
+ */
+static void Modem_UART_CheckRx(void)
+{
+  if (ModemUart->RxState != HAL_UART_STATE_BUSY_RX)
+  {
+    /* The pending data is lost */
+    RxTail = 0;
+    HAL_UART_Receive_DMA(ModemUart, RxBuffer, MODEM_UART_RX_BUFFER_SIZE);
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,121 @@
+/**
+  ******************************************************************************
+  * @file    modem_uart.h
+  * @author  MCD Application Team
+  * @brief   Header for modem_uart.c module
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MODEM_UART_H__
+#define __MODEM_UART_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm32l0xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Size of the DMA circular reception buffer. It must hold all the modem
+ * output received between two reads.
+ */
+#ifndef MODEM_UART_RX_BUFFER_SIZE
+#define MODEM_UART_RX_BUFFER_SIZE                   512
+#endif
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Starts the modem reception in a DMA circular buffer with idle line
+ *         detection. The UART must be initialized with its hdmarx DMA handle
+ *         linked, whose channel interrupt calls HAL_DMA_IRQHandler.
+ * @param  huart modem UART handle
+ * @retval HAL_OK in case of success
+ */
+HAL_StatusTypeDef Modem_UART_Start(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  Stops the modem reception
+ * @param  None
+ * @retval None
+ */
+void Modem_UART_Stop(void);
+
+/**
+ * @brief  Handles the idle line interrupt. To be called from the modem USART
+ *         IRQ handler, before HAL_UART_IRQHandler.
+ * @param  None
+ * @retval None
+ */
+void Modem_UART_IRQHandler(void);
+
+/**
+ * @brief  Transmits a buffer to the modem
+ * @param  buf buffer to transmit
+ * @param  len buffer length
+ * @retval HAL return code
+ */
+HAL_StatusTypeDef Modem_UART_Send(uint8_t *buf, uint16_t len);
+
+/**
+ * @brief  Starts the transmission of a buffer to the modem in interrupt mode
+ * @param  buf buffer to transmit, to be kept until the transmission ends
+ * @param  len buffer length
+ * @retval HAL return code
+ */
+HAL_StatusTypeDef Modem_UART_SendIT(uint8_t *buf, uint16_t len);
+
+/**
+ * @brief  Checks whether a transmission is ongoing
+ * @param  None
+ * @retval 1 while transmitting, 0 otherwise
+ */
+uint8_t Modem_UART_IsTxBusy(void);
+
+/**
+ * @brief  Waits, in sleep mode, for a complete line from the modem
+ * @param  Timeout maximum waiting time in ms, 0 to only check
+ * @retval HAL_OK when a line is available, HAL_TIMEOUT otherwise
+ */
+HAL_StatusTypeDef Modem_UART_WaitLine(uint32_t Timeout);
+
+/**
+ * @brief  Reads the next line from the modem, up to and including its '\n'.
+ *         A line longer than the buffer is returned in several parts, only
+ *         the last one ending with '\n'.
+ * @param  Line buffer receiving the null terminated line
+ * @param  Size buffer size, at least 2 (asserted): a smaller buffer returns 0
+ *         at once, without waiting
+ * @param  Timeout maximum waiting time in ms, 0 to only check
+ * @retval length of the line, 0 when no line was received within Timeout
+ */
+uint16_t Modem_UART_ReadLine(char *Line, uint16_t Size, uint32_t Timeout);
+
+/**
+ * @brief  Discards everything received from the modem so far
+ * @param  None
+ * @retval None
+ */
+void Modem_UART_Flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MODEM_UART_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
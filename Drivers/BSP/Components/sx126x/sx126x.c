@@ -44,6 +44,9 @@
 #include "radio.h"
 #include "sx126x.h"
 #include "sx126x_board.h"
+#ifdef ENERGY_MONITOR_ENABLED
+#include "energy_monitor.h"
+#endif
 
 /*
  * Local types definition
@@ -126,9 +129,30 @@ RadioOperatingModes_t SX126xGetOperatingMode( void )
     return OperatingMode;
 }
 
+#ifdef ENERGY_MONITOR_ENABLED
+/*!
+ * Power state of each operating mode, the synthesizer mode is accounted as
+ * standby and the RX duty cycle mode as RX
+ */
+static const EM_RadioState_t OperatingModeEnergyStates[] =
+{
+    EM_RADIO_SLEEP,     // MODE_SLEEP
+    EM_RADIO_STANDBY,   // MODE_STDBY_RC
+    EM_RADIO_STANDBY,   // MODE_STDBY_XOSC
+    EM_RADIO_STANDBY,   // MODE_FS
+    EM_RADIO_TX,        // MODE_TX
+    EM_RADIO_RX,        // MODE_RX
+    EM_RADIO_RX,        // MODE_RX_DC
+    EM_RADIO_CAD,       // MODE_CAD
+};
+#endif
+
 void SX126xSetOperatingMode( RadioOperatingModes_t mode )
 {
     OperatingMode = mode;
+#ifdef ENERGY_MONITOR_ENABLED
+    EM_SetRadioState( OperatingModeEnergyStates[mode] );
+#endif
 }
 
 void SX126xCheckDeviceReady( void )
@@ -46,6 +46,9 @@
 #include "radio.h"
 #include "sx1276.h"
 #include "timeServer.h"
+#ifdef ENERGY_MONITOR_ENABLED
+#include "energy_monitor.h"
+#endif
 
 /*
  * Local types definition
@@ -105,6 +108,11 @@ void SX1276ReadFifo( uint8_t *buffer, uint8_t size );
  */
 void SX1276SetOpMode( uint8_t opMode );
 
+/*!
+ * \brief Reads the received LoRa packet, its RSSI and SNR
+ */
+static void SX1276ReadLoRaPacket( void );
+
 /*
  * SX1276 DIO IRQ callback functions prototype
  */
@@ -144,6 +152,41 @@ void SX1276OnDio5Irq( void* context );
  */
 void SX1276OnTimeoutIrq( void* context );
 
+#ifdef SX1276_DEFERRED_IRQ_ENABLED
+/*!
+ * \brief DIO 0 IRQ top half, defers the LoRa events to SX1276IrqProcess
+ */
+static void SX1276OnDio0IrqDeferred( void* context );
+
+/*!
+ * \brief DIO 1 IRQ top half, defers the LoRa events to SX1276IrqProcess
+ */
+static void SX1276OnDio1IrqDeferred( void* context );
+
+/*!
+ * \brief DIO 3 IRQ top half, defers the LoRa events to SX1276IrqProcess
+ */
+static void SX1276OnDio3IrqDeferred( void* context );
+
+/*!
+ * \brief Keeps the deferred DIO IRQs of the operation being replaced,
+ *        reading from the radio what they report
+ *
+ * \remark Must not be called with the IRQs masked: the IRQ flags and the
+ *         FIFO are read outside of the critical sections
+ */
+static void SX1276ReplaceIrqs( void );
+
+/*!
+ * \brief Notifies a deferred DIO IRQ of a replaced operation
+ *
+ * \param [IN] dio DIO number
+ * \param [IN] state Radio state when the IRQ was raised
+ * \param [IN] irqFlags LoRa IRQ flags read when the operation was replaced
+ */
+static void SX1276OnReplacedIrq( uint8_t dio, RadioState_t state, uint8_t irqFlags );
+#endif
+
 /*
  * Private global constants
  */
@@ -199,6 +242,24 @@ const FskBandwidth_t FskBandwidths[] =
  */
 static RadioEvents_t *RadioEvents;
 
+#ifdef ENERGY_MONITOR_ENABLED
+/*!
+ * Power state of each operating mode, the synthesizer modes are accounted as
+ * standby
+ */
+static const EM_RadioState_t OpModeEnergyStates[] =
+{
+    EM_RADIO_SLEEP,     // RF_OPMODE_SLEEP
+    EM_RADIO_STANDBY,   // RF_OPMODE_STANDBY
+    EM_RADIO_STANDBY,   // RF_OPMODE_SYNTHESIZER_TX
+    EM_RADIO_TX,        // RF_OPMODE_TRANSMITTER
+    EM_RADIO_STANDBY,   // RF_OPMODE_SYNTHESIZER_RX
+    EM_RADIO_RX,        // RF_OPMODE_RECEIVER
+    EM_RADIO_RX,        // RFLR_OPMODE_RECEIVER_SINGLE
+    EM_RADIO_CAD,       // RFLR_OPMODE_CAD
+};
+#endif
+
 /*!
  * Reception buffer
  */
@@ -218,9 +279,72 @@ SX1276_t SX1276;
 /*!
  * Hardware DIO IRQ callback initialization
  */
+#ifdef SX1276_DEFERRED_IRQ_ENABLED
+DioIrqHandler *DioIrq[] = { SX1276OnDio0IrqDeferred, SX1276OnDio1IrqDeferred,
+                            SX1276OnDio2Irq, SX1276OnDio3IrqDeferred,
+                            SX1276OnDio4Irq, NULL };
+
+/*!
+ * Maximum number of bytes transferred over SPI with the interrupts disabled
+ */
+#define SX1276_SPI_BURST_SIZE                       16
+
+/*!
+ * Deferred DIO IRQ bottom halves, indexed by DIO number
+ */
+static DioIrqHandler *DioIrqDeferred[] = { SX1276OnDio0Irq, SX1276OnDio1Irq,
+                                           NULL, SX1276OnDio3Irq };
+
+/*!
+ * Number of DIOs which IRQs can be deferred
+ */
+#define SX1276_DEFERRED_DIO_NB                      ( sizeof( DioIrqDeferred ) / sizeof( DioIrqDeferred[0] ) )
+
+/*!
+ * Pending deferred DIO IRQs, one bit per DIO number
+ */
+static volatile uint8_t IrqPending = 0;
+
+/*!
+ * Time at which each deferred DIO IRQ was raised
+ */
+static volatile uint32_t IrqTimestamps[SX1276_DEFERRED_DIO_NB];
+
+/*!
+ * Radio state when each deferred DIO IRQ was raised
+ */
+static volatile RadioState_t IrqStates[SX1276_DEFERRED_DIO_NB];
+
+/*!
+ * Pending deferred DIO IRQs of operations replaced before they were
+ * processed, one bit per DIO number. Only the oldest one of a DIO is kept.
+ */
+static volatile uint8_t IrqReplaced = 0;
+
+/*!
+ * Time at which each replaced operation DIO IRQ was raised
+ */
+static volatile uint32_t IrqReplacedTimestamps[SX1276_DEFERRED_DIO_NB];
+
+/*!
+ * Radio state when each replaced operation DIO IRQ was raised
+ */
+static volatile RadioState_t IrqReplacedStates[SX1276_DEFERRED_DIO_NB];
+
+/*!
+ * LoRa IRQ flags of the replaced operations
+ */
+static volatile uint8_t IrqReplacedFlags = 0;
+
+/*!
+ * Time at which the DIO IRQ being processed was raised
+ */
+static uint32_t IrqTime = 0;
+#else
 DioIrqHandler *DioIrq[] = { SX1276OnDio0Irq, SX1276OnDio1Irq,
                             SX1276OnDio2Irq, SX1276OnDio3Irq,
                             SX1276OnDio4Irq, NULL };
+#endif
 
 /*!
  * Tx and Rx timers
@@ -747,7 +871,7 @@ uint32_t SX1276GetTimeOnAir( RadioModems_t modem, uint8_t pktLen )
         break;
     case MODEM_LORA:
         {
-            double bw = 0.0;
+            MathFloat_t bw = 0;
             // REMARK: When using LoRa modem only bandwidths 125, 250 and 500 kHz are supported
             switch( SX1276.Settings.LoRa.Bandwidth )
             {
@@ -784,23 +908,23 @@ uint32_t SX1276GetTimeOnAir( RadioModems_t modem, uint8_t pktLen )
             }
 
             // Symbol rate : time for one symbol (secs)
-            double rs = bw / ( 1 << SX1276.Settings.LoRa.Datarate );
-            double ts = 1 / rs;
+            MathFloat_t rs = bw / ( 1 << SX1276.Settings.LoRa.Datarate );
+            MathFloat_t ts = 1 / rs;
             // time of preamble
-            double tPreamble = ( SX1276.Settings.LoRa.PreambleLen + 4.25 ) * ts;
+            MathFloat_t tPreamble = ( SX1276.Settings.LoRa.PreambleLen + ( MathFloat_t )4.25 ) * ts;
             // Symbol length of payload and time
-            double tmp = ceil( ( 8 * pktLen - 4 * SX1276.Settings.LoRa.Datarate +
+            MathFloat_t tmp = MATH_CEIL( ( 8 * pktLen - 4 * SX1276.Settings.LoRa.Datarate +
                                  28 + 16 * SX1276.Settings.LoRa.CrcOn -
                                  ( SX1276.Settings.LoRa.FixLen ? 20 : 0 ) ) /
-                                 ( double )( 4 * ( SX1276.Settings.LoRa.Datarate -
+                                 ( MathFloat_t )( 4 * ( SX1276.Settings.LoRa.Datarate -
                                  ( ( SX1276.Settings.LoRa.LowDatarateOptimize > 0 ) ? 2 : 0 ) ) ) ) *
                                  ( SX1276.Settings.LoRa.Coderate + 4 );
-            double nPayload = 8 + ( ( tmp > 0 ) ? tmp : 0 );
-            double tPayload = nPayload * ts;
+            MathFloat_t nPayload = 8 + ( ( tmp > 0 ) ? tmp : 0 );
+            MathFloat_t tPayload = nPayload * ts;
             // Time on air
-            double tOnAir = tPreamble + tPayload;
+            MathFloat_t tOnAir = tPreamble + tPayload;
             // return ms secs
-            airTime = (uint32_t) floor( tOnAir * 1000 + 0.999 );
+            airTime = (uint32_t) MATH_FLOOR( tOnAir * 1000 + ( MathFloat_t )0.999 );
         }
         break;
     }
@@ -1238,6 +1362,13 @@ void SX1276Reset( void )
 
 void SX1276SetOpMode( uint8_t opMode )
 {
+#ifdef ENERGY_MONITOR_ENABLED
+    EM_SetRadioState( OpModeEnergyStates[opMode & ~RF_OPMODE_MASK] );
+#endif
+#ifdef SX1276_DEFERRED_IRQ_ENABLED
+    // The events not yet processed belong to the previous operation
+    SX1276ReplaceIrqs( );
+#endif
     if( opMode == RF_OPMODE_SLEEP )
     {
       SX1276Write( REG_OPMODE, ( SX1276Read( REG_OPMODE ) & RF_OPMODE_MASK ) | opMode );
@@ -1311,6 +1442,10 @@ uint8_t SX1276Read( uint16_t addr )
 void SX1276WriteBuffer( uint16_t addr, uint8_t *buffer, uint8_t size )
 {
     uint8_t i;
+#ifdef SX1276_DEFERRED_IRQ_ENABLED
+    // The main loop context accesses may be interrupted by the timers accesses
+    CRITICAL_SECTION_BEGIN( );
+#endif
 
     //NSS = 0;
     HW_GPIO_Write( RADIO_NSS_PORT, RADIO_NSS_PIN, 0 );
@@ -1323,11 +1458,18 @@ void SX1276WriteBuffer( uint16_t addr, uint8_t *buffer, uint8_t size )
 
     //NSS = 1;
     HW_GPIO_Write( RADIO_NSS_PORT, RADIO_NSS_PIN, 1 );
+#ifdef SX1276_DEFERRED_IRQ_ENABLED
+    CRITICAL_SECTION_END( );
+#endif
 }
 
 void SX1276ReadBuffer( uint16_t addr, uint8_t *buffer, uint8_t size )
 {
     uint8_t i;
+#ifdef SX1276_DEFERRED_IRQ_ENABLED
+    // The main loop context accesses may be interrupted by the timers accesses
+    CRITICAL_SECTION_BEGIN( );
+#endif
 
     //NSS = 0;
     HW_GPIO_Write( RADIO_NSS_PORT, RADIO_NSS_PIN, 0 );
@@ -1341,8 +1483,40 @@ void SX1276ReadBuffer( uint16_t addr, uint8_t *buffer, uint8_t size )
 
     //NSS = 1;
     HW_GPIO_Write( RADIO_NSS_PORT, RADIO_NSS_PIN, 1 );
+#ifdef SX1276_DEFERRED_IRQ_ENABLED
+    CRITICAL_SECTION_END( );
+#endif
+}
+
+#ifdef SX1276_DEFERRED_IRQ_ENABLED
+void SX1276WriteFifo( uint8_t *buffer, uint8_t size )
+{
+    uint8_t burst;
+
+    // The FIFO pointer auto-increments across bursts, so the interrupts are
+    // only disabled for SX1276_SPI_BURST_SIZE bytes at a time
+    while( size > 0 )
+    {
+        burst = MIN( size, SX1276_SPI_BURST_SIZE );
+        SX1276WriteBuffer( 0, buffer, burst );
+        buffer += burst;
+        size -= burst;
+    }
 }
 
+void SX1276ReadFifo( uint8_t *buffer, uint8_t size )
+{
+    uint8_t burst;
+
+    while( size > 0 )
+    {
+        burst = MIN( size, SX1276_SPI_BURST_SIZE );
+        SX1276ReadBuffer( 0, buffer, burst );
+        buffer += burst;
+        size -= burst;
+    }
+}
+#else
 void SX1276WriteFifo( uint8_t *buffer, uint8_t size )
 {
     SX1276WriteBuffer( 0, buffer, size );
@@ -1352,6 +1526,7 @@ void SX1276ReadFifo( uint8_t *buffer, uint8_t size )
 {
     SX1276ReadBuffer( 0, buffer, size );
 }
+#endif
 
 void SX1276SetMaxPayloadLength( RadioModems_t modem, uint8_t max )
 {
@@ -1583,42 +1758,15 @@ void SX1276OnDio0Irq( void* context )
                         break;
                     }
 
-                    // Returns SNR value [dB] rounded to the nearest integer value
-                    SX1276.Settings.LoRaPacketHandler.SnrValue = ( ( ( int8_t )SX1276Read( REG_LR_PKTSNRVALUE ) ) + 2 ) >> 2;
-
-                    int16_t rssi = SX1276Read( REG_LR_PKTRSSIVALUE );
-                    if( SX1276.Settings.LoRaPacketHandler.SnrValue < 0 )
-                    {
-                        if( SX1276.Settings.Channel > RF_MID_BAND_THRESH )
-                        {
-                            SX1276.Settings.LoRaPacketHandler.RssiValue = RSSI_OFFSET_HF + rssi + ( rssi >> 4 ) +
-                                                                          SX1276.Settings.LoRaPacketHandler.SnrValue;
-                        }
-                        else
-                        {
-                            SX1276.Settings.LoRaPacketHandler.RssiValue = RSSI_OFFSET_LF + rssi + ( rssi >> 4 ) +
-                                                                          SX1276.Settings.LoRaPacketHandler.SnrValue;
-                        }
-                    }
-                    else
-                    {
-                        if( SX1276.Settings.Channel > RF_MID_BAND_THRESH )
-                        {
-                            SX1276.Settings.LoRaPacketHandler.RssiValue = RSSI_OFFSET_HF + rssi + ( rssi >> 4 );
-                        }
-                        else
-                        {
-                            SX1276.Settings.LoRaPacketHandler.RssiValue = RSSI_OFFSET_LF + rssi + ( rssi >> 4 );
-                        }
-                    }
-
-                    SX1276.Settings.LoRaPacketHandler.Size = SX1276Read( REG_LR_RXNBBYTES );
-                    SX1276Write( REG_LR_FIFOADDRPTR, SX1276Read( REG_LR_FIFORXCURRENTADDR ) );
-                    SX1276ReadFifo( RxTxBuffer, SX1276.Settings.LoRaPacketHandler.Size );
+                    SX1276ReadLoRaPacket( );
 
                     if( SX1276.Settings.LoRa.RxContinuous == false )
                     {
                         SX1276.Settings.State = RF_IDLE;
+#ifdef ENERGY_MONITOR_ENABLED
+                        // The radio went back to standby at the end of the single reception
+                        EM_SetRadioState( EM_RADIO_STANDBY );
+#endif
                     }
                     TimerStop( &RxTimeoutTimer );
 
@@ -1644,6 +1792,10 @@ void SX1276OnDio0Irq( void* context )
             case MODEM_FSK:
             default:
                 SX1276.Settings.State = RF_IDLE;
+#ifdef ENERGY_MONITOR_ENABLED
+                // The radio went back to standby at the end of the transmission
+                EM_SetRadioState( EM_RADIO_STANDBY );
+#endif
                 if( ( RadioEvents != NULL ) && ( RadioEvents->TxDone != NULL ) )
                 {
                     RadioEvents->TxDone( );
@@ -1656,6 +1808,42 @@ void SX1276OnDio0Irq( void* context )
     }
 }
 
+static void SX1276ReadLoRaPacket( void )
+{
+    // Returns SNR value [dB] rounded to the nearest integer value
+    SX1276.Settings.LoRaPacketHandler.SnrValue = ( ( ( int8_t )SX1276Read( REG_LR_PKTSNRVALUE ) ) + 2 ) >> 2;
+
+    int16_t rssi = SX1276Read( REG_LR_PKTRSSIVALUE );
+    if( SX1276.Settings.LoRaPacketHandler.SnrValue < 0 )
+    {
+        if( SX1276.Settings.Channel > RF_MID_BAND_THRESH )
+        {
+            SX1276.Settings.LoRaPacketHandler.RssiValue = RSSI_OFFSET_HF + rssi + ( rssi >> 4 ) +
+                                                          SX1276.Settings.LoRaPacketHandler.SnrValue;
+        }
+        else
+        {
+            SX1276.Settings.LoRaPacketHandler.RssiValue = RSSI_OFFSET_LF + rssi + ( rssi >> 4 ) +
+                                                          SX1276.Settings.LoRaPacketHandler.SnrValue;
+        }
+    }
+    else
+    {
+        if( SX1276.Settings.Channel > RF_MID_BAND_THRESH )
+        {
+            SX1276.Settings.LoRaPacketHandler.RssiValue = RSSI_OFFSET_HF + rssi + ( rssi >> 4 );
+        }
+        else
+        {
+            SX1276.Settings.LoRaPacketHandler.RssiValue = RSSI_OFFSET_LF + rssi + ( rssi >> 4 );
+        }
+    }
+
+    SX1276.Settings.LoRaPacketHandler.Size = SX1276Read( REG_LR_RXNBBYTES );
+    SX1276Write( REG_LR_FIFOADDRPTR, SX1276Read( REG_LR_FIFORXCURRENTADDR ) );
+    SX1276ReadFifo( RxTxBuffer, SX1276.Settings.LoRaPacketHandler.Size );
+}
+
 void SX1276OnDio1Irq( void* context )
 {
     switch( SX1276.Settings.State )
@@ -1706,6 +1894,9 @@ void SX1276OnDio1Irq( void* context )
                 SX1276Write( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_RXTIMEOUT );
 
                 SX1276.Settings.State = RF_IDLE;
+#ifdef ENERGY_MONITOR_ENABLED
+                EM_SetRadioState( EM_RADIO_STANDBY );
+#endif
                 if( ( RadioEvents != NULL ) && ( RadioEvents->RxTimeout != NULL ) )
                 {
                     RadioEvents->RxTimeout( );
@@ -1823,6 +2014,9 @@ void SX1276OnDio3Irq( void* context )
     case MODEM_FSK:
         break;
     case MODEM_LORA:
+#ifdef ENERGY_MONITOR_ENABLED
+        EM_SetRadioState( EM_RADIO_STANDBY );
+#endif
         if( ( SX1276Read( REG_LR_IRQFLAGS ) & RFLR_IRQFLAGS_CADDETECTED ) == RFLR_IRQFLAGS_CADDETECTED )
         {
             // Clear Irq
@@ -1878,4 +2072,231 @@ void SX1276OnDio5Irq( void* context )
         break;
     }
 }
+
+#ifdef SX1276_DEFERRED_IRQ_ENABLED
+/*!
+ * \brief Timestamps a DIO IRQ and defers its processing to SX1276IrqProcess
+ *
+ * \param [IN] dio DIO number
+ */
+static void SX1276DeferIrq( uint8_t dio )
+{
+    IrqTimestamps[dio] = TimerGetCurrentTime( );
+    IrqStates[dio] = SX1276.Settings.State;
+    IrqPending |= ( 1 << dio );
+
+    if( ( RadioEvents != NULL ) && ( RadioEvents->IrqNotify != NULL ) )
+    {
+        RadioEvents->IrqNotify( );
+    }
+}
+
+static void SX1276OnDio0IrqDeferred( void* context )
+{
+    // The FSK packet handler shares the FIFO with the DIO 1 FifoLevel
+    // interrupt, which must be served in real time
+    if( SX1276.Settings.Modem == MODEM_FSK )
+    {
+        IrqTime = TimerGetCurrentTime( );
+        SX1276OnDio0Irq( context );
+        return;
+    }
+
+    // Avoid the timeout handling of an already completed operation
+    switch( SX1276.Settings.State )
+    {
+        case RF_RX_RUNNING:
+            TimerStop( &RxTimeoutTimer );
+            break;
+        case RF_TX_RUNNING:
+            TimerStop( &TxTimeoutTimer );
+            break;
+        default:
+            break;
+    }
+    SX1276DeferIrq( 0 );
+}
+
+static void SX1276OnDio1IrqDeferred( void* context )
+{
+    if( SX1276.Settings.Modem == MODEM_FSK )
+    {
+        IrqTime = TimerGetCurrentTime( );
+        SX1276OnDio1Irq( context );
+        return;
+    }
+
+    if( SX1276.Settings.State == RF_RX_RUNNING )
+    {
+        TimerStop( &RxTimeoutTimer );
+    }
+    SX1276DeferIrq( 1 );
+}
+
+static void SX1276OnDio3IrqDeferred( void* context )
+{
+    if( SX1276.Settings.Modem == MODEM_FSK )
+    {
+        return;
+    }
+    SX1276DeferIrq( 3 );
+}
+
+static void SX1276ReplaceIrqs( void )
+{
+    uint32_t timestamps[SX1276_DEFERRED_DIO_NB];
+    RadioState_t states[SX1276_DEFERRED_DIO_NB];
+    uint8_t replaced = 0;
+    uint8_t irqFlags = 0;
+    uint8_t dio;
+
+    // Until the new mode is written, a late DIO IRQ still belongs to the
+    // operation being replaced: loop until none is left
+    for( ; ; )
+    {
+        // Only the bookkeeping is done with the IRQs masked: hand over the
+        // events read in the previous pass and take the pending ones, the SPI
+        // accesses follow outside of the critical section
+        CRITICAL_SECTION_BEGIN( );
+        for( dio = 0; dio < SX1276_DEFERRED_DIO_NB; dio++ )
+        {
+            if( ( replaced & ( 1 << dio ) ) != 0 )
+            {
+                IrqReplacedTimestamps[dio] = timestamps[dio];
+                IrqReplacedStates[dio] = states[dio];
+            }
+        }
+        IrqReplaced |= replaced;
+        IrqReplacedFlags |= irqFlags;
+
+        replaced = IrqPending & ~IrqReplaced;
+        IrqPending = 0;
+        for( dio = 0; dio < SX1276_DEFERRED_DIO_NB; dio++ )
+        {
+            timestamps[dio] = IrqTimestamps[dio];
+            states[dio] = IrqStates[dio];
+        }
+        CRITICAL_SECTION_END( );
+
+        if( ( replaced == 0 ) || ( SX1276.Settings.Modem != MODEM_LORA ) )
+        {
+            // Nothing left, or switching to FSK: the LoRa events have no
+            // meaning anymore
+            return;
+        }
+
+        irqFlags = SX1276Read( REG_LR_IRQFLAGS );
+
+        // The next operation may overwrite the FIFO
+        if( ( ( replaced & 0x01 ) != 0 ) && ( states[0] == RF_RX_RUNNING ) &&
+            ( ( irqFlags & RFLR_IRQFLAGS_PAYLOADCRCERROR_MASK ) != RFLR_IRQFLAGS_PAYLOADCRCERROR ) )
+        {
+            SX1276ReadLoRaPacket( );
+        }
+
+        // Release the DIO lines for the next operation
+        SX1276Write( REG_LR_IRQFLAGS, irqFlags );
+    }
+}
+
+static void SX1276OnReplacedIrq( uint8_t dio, RadioState_t state, uint8_t irqFlags )
+{
+    if( RadioEvents == NULL )
+    {
+        return;
+    }
+
+    switch( dio )
+    {
+    case 0:
+        if( state == RF_TX_RUNNING )
+        {
+            if( RadioEvents->TxDone != NULL )
+            {
+                RadioEvents->TxDone( );
+            }
+        }
+        else if( state == RF_RX_RUNNING )
+        {
+            if( ( irqFlags & RFLR_IRQFLAGS_PAYLOADCRCERROR_MASK ) == RFLR_IRQFLAGS_PAYLOADCRCERROR )
+            {
+                if( RadioEvents->RxError != NULL )
+                {
+                    RadioEvents->RxError( );
+                }
+            }
+            else if( RadioEvents->RxDone != NULL )
+            {
+                RadioEvents->RxDone( RxTxBuffer, SX1276.Settings.LoRaPacketHandler.Size, SX1276.Settings.LoRaPacketHandler.RssiValue, SX1276.Settings.LoRaPacketHandler.SnrValue );
+            }
+        }
+        break;
+    case 1:
+        if( ( state == RF_RX_RUNNING ) && ( RadioEvents->RxTimeout != NULL ) )
+        {
+            RadioEvents->RxTimeout( );
+        }
+        break;
+    case 3:
+        if( RadioEvents->CadDone != NULL )
+        {
+            RadioEvents->CadDone( ( irqFlags & RFLR_IRQFLAGS_CADDETECTED ) == RFLR_IRQFLAGS_CADDETECTED );
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void SX1276IrqProcess( void )
+{
+    uint8_t pending;
+    uint8_t irqFlags;
+    RadioState_t state;
+    uint32_t time;
+    uint8_t dio;
+
+    // The events of the replaced operations come first, in DIO order
+    for( dio = 0; dio < SX1276_DEFERRED_DIO_NB; dio++ )
+    {
+        CRITICAL_SECTION_BEGIN( );
+        pending = IrqReplaced & ( 1 << dio );
+        IrqReplaced &= ~( 1 << dio );
+        time = IrqReplacedTimestamps[dio];
+        state = IrqReplacedStates[dio];
+        irqFlags = IrqReplacedFlags;
+        if( IrqReplaced == 0 )
+        {
+            IrqReplacedFlags = 0;
+        }
+        CRITICAL_SECTION_END( );
+
+        if( pending != 0 )
+        {
+            IrqTime = time;
+            SX1276OnReplacedIrq( dio, state, irqFlags );
+        }
+    }
+
+    CRITICAL_SECTION_BEGIN( );
+    pending = IrqPending;
+    IrqPending = 0;
+    CRITICAL_SECTION_END( );
+
+    for( dio = 0; pending != 0; dio++ )
+    {
+        if( ( pending & ( 1 << dio ) ) != 0 )
+        {
+            pending &= ~( 1 << dio );
+            IrqTime = IrqTimestamps[dio];
+            DioIrqDeferred[dio]( NULL );
+        }
+    }
+}
+
+uint32_t SX1276GetIrqTime( void )
+{
+    return IrqTime;
+}
+#endif
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
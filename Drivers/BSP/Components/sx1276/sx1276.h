@@ -541,4 +541,22 @@ void SX1276SetPublicNetwork( bool enable );
  */
 uint32_t SX1276GetWakeupTime( void );
 
+#ifdef SX1276_DEFERRED_IRQ_ENABLED
+/*!
+ * \brief Processes the radio interrupts deferred by the DIO interrupt handlers
+ *
+ * \remark The DIO interrupt handlers only timestamp the LoRa events and notify
+ *         RadioEvents->IrqNotify. The registers and FIFO are read and the radio
+ *         events are called from this function, in the main loop context.
+ */
+void SX1276IrqProcess( void );
+
+/*!
+ * \brief Gets the time at which the DIO interrupt being processed was raised
+ *
+ * \retval time Interrupt timestamp in ms
+ */
+uint32_t SX1276GetIrqTime( void );
+#endif
+
 #endif /* __SX1276_H__ */
@@ -25,6 +25,8 @@
 #include "stm32l0xx_hal.h"
 #include "hw_conf.h"
 #include "hw_usart.h"
+#include "modem_uart.h"
+#include "modem_engine.h"
 #include "i_nucleo_lrwan1_wm_sg_sm_xx.h"
 #include "tiny_sscanf.h"
 
@@ -78,7 +80,7 @@ extern uint8_t FWVersion;  /* to store the USI FW version - defined in lora_driv
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
-
+#define AT_RESPONSE_TIMEOUT     10000   /* ms, maximum time for the slave to answer an asynchronous command */
 
 /* Private macro -------------------------------------------------------------*/
 
@@ -91,6 +93,8 @@ static uint16_t Offset = 0;   /*write position needed for send command*/
 
 static uint8_t aRxBuffer[5];  /* Buffer used for Rx input character */
 
+static const Modem_AT_Callbacks_t *AsyncCallbacks = NULL;   /*asynchronous AT cmd notifications*/
+
 static char response[DATA_RX_MAX_BUFF_SIZE];
 /*has to be the largest of the response*/
 /*not only for return code but also for*/
@@ -127,6 +131,18 @@ static ATEerror_t at_cmd_AsyncEventAnalysing(const char *ReturnResp, int8_t *Fla
 
 static ATEerror_t at_cmd_receive_async_event_downlink_data(void *ptr);
 
+static ATEerror_t at_cmd_lineAnalysing(const char *Line);
+
+static uint8_t at_cmd_async_line(Modem_Engine_Request_t *Request, const char *Line);
+
+static void at_cmd_async_done(Modem_Engine_Request_t *Request, Modem_Engine_Status_t Status);
+
+static const Modem_Engine_Callbacks_t AsyncEngineCallbacks =
+{
+  at_cmd_async_line,
+  at_cmd_async_done
+};
+
 
 
 /* Exported functions ------------------------------------------------------- */
@@ -158,6 +174,7 @@ ATEerror_t Modem_IO_Init(void)
 *****************************************************************************/
 void Modem_IO_DeInit(void)
 {
+  Modem_UART_Stop();
   HAL_UART_MspDeInit(&huart2);
 }
 
@@ -282,6 +299,87 @@ ATEerror_t  Modem_AT_Cmd(ATGroup_t at_group, ATCmd_t Cmd, void *pdata)
 }
 
 
+/******************************************************************************
+ * @brief  Starts the asynchronous AT cmd handling
+ * @param  Callbacks command completion and unsolicited event notifications
+ * @retval AT_OK in case of success
+ * @retval AT_UART_LINK_ERROR in case of failure
+ *****************************************************************************/
+ATEerror_t Modem_AT_AsyncInit(const Modem_AT_Callbacks_t *Callbacks)
+{
+  /*the per character reception is replaced by the DMA circular buffer*/
+  HAL_UART_AbortReceive(&huart2);
+  if (Modem_UART_Start(&huart2) != HAL_OK)
+  {
+    return (AT_UART_LINK_ERROR);
+  }
+  AsyncCallbacks = Callbacks;
+  Modem_Engine_Init(&AsyncEngineCallbacks);
+  return AT_OK;
+}
+
+
+/******************************************************************************
+ * @brief  Queues an AT cmd without waiting for its response
+ * @param  at_group AT group [control, set , get)
+ *         Cmd AT command
+ *         pdata pointer to the IN/OUT buffer
+ *         size size of the OUT buffer of a get
+ * @retval AT_OK when queued
+ *****************************************************************************/
+ATEerror_t Modem_AT_CmdAsync(ATGroup_t at_group, ATCmd_t Cmd, void *pdata, uint16_t size)
+{
+  HAL_StatusTypeDef HAL_Status;
+  uint16_t Len;
+  uint32_t Timeout = AT_RESPONSE_TIMEOUT;
+
+  /*reset At_cmd buffer for each transmission*/
+  memset(LoRa_AT_Cmd_Buff, 0x00, sizeof LoRa_AT_Cmd_Buff);
+
+  switch (at_group)
+  {
+    case AT_CTRL:
+    {
+      Len = at_cmd_format(Cmd, NULL, CTRL_MARKER);
+      if (Cmd == AT_RESET)
+      {
+        Timeout = 0;  /*the slave does not answer*/
+      }
+      pdata = NULL;
+      break;
+    }
+    case AT_SET:
+    {
+      Len = at_cmd_format(Cmd, pdata, SET_MARKER);
+      pdata = NULL;   /*only a return code is expected*/
+      break;
+    }
+    case AT_GET:
+    {
+      Len = at_cmd_format(Cmd, pdata, GET_MARKER);
+      break;
+    }
+    default:
+      /*the asynchronous events are notified through OnEvent, the*/
+      /*exception sequences rely on delays: use Modem_AT_Cmd*/
+      DBG_PRINTF("unsupported group\n\r");
+      return AT_END_ERROR;
+  } /*end switch(at_group)*/
+
+  /*the command is copied, LoRa_AT_Cmd_Buff can be reused right away*/
+  HAL_Status = Modem_Engine_Submit(LoRa_AT_Cmd_Buff, Len, Timeout, Cmd, pdata, size);
+  if (HAL_Status == HAL_BUSY)
+  {
+    return (AT_UART_LINK_ERROR);
+  }
+  else if (HAL_Status != HAL_OK)
+  {
+    return (AT_TEST_PARAM_OVERFLOW);
+  }
+  return AT_OK;
+}
+
+
 /******************************************************************************
  * @brief  format the cmd in order to be send
  * @param  Cmd AT command
@@ -834,6 +932,87 @@ static ATEerror_t at_cmd_AsyncEventAnalysing(const char *ReturnResp, int8_t *Fla
 
 
 
+/******************************************************************************
+  * @brief This function does analysis of a line received by the device
+  * @param Line: received line, without <cr><lf>
+  * @retval ATEerror_t error type, AT_END_ERROR when not a return code
+******************************************************************************/
+static ATEerror_t at_cmd_lineAnalysing(const char *Line)
+{
+  const char *code;
+  size_t len;
+  int i;
+
+  for (i = 0; i < AT_END_ERROR; i++)
+  {
+    /*return code string without its surrounding <cr><lf>*/
+    code = ATE_RetCode[i].RetCodeStr + strspn(ATE_RetCode[i].RetCodeStr, "\r\n");
+    len = strcspn(code, "\r\n");
+    if ((strlen(Line) == len) && (strncmp(Line, code, len) == 0))
+    {
+      return (ATE_RetCode[i].RetCode);
+    }
+  }
+  return (AT_END_ERROR);
+}
+
+
+
+/******************************************************************************
+  * @brief This function handles a line received by the asynchronous engine
+  * @param Request: command waiting for its response, NULL when none
+  * @param Line: received line, without <cr><lf>
+  * @retval 1 when the line is the return code ending the response
+******************************************************************************/
+static uint8_t at_cmd_async_line(Modem_Engine_Request_t *Request, const char *Line)
+{
+  ATEerror_t status = at_cmd_lineAnalysing(Line);
+  char *ptrChr;
+
+  if ((Request != NULL) && (status != AT_END_ERROR))
+  {
+    Request->Result = status;
+    return 1;
+  }
+
+  if ((Request != NULL) && (Request->Data != NULL) && (Line[0] != '+'))
+  {
+    /*returned value following a GET cmd, after its '=' in brief mode*/
+    ptrChr = strchr(Line, '=');
+    Modem_Engine_StoreData(Request, (ptrChr != NULL) ? (ptrChr + 1) : Line);
+  }
+  else if ((AsyncCallbacks != NULL) && (AsyncCallbacks->OnEvent != NULL))
+  {
+    /*+JoinAccepted, +RXPORT, +PAYLOADSIZE, +RCV, ...*/
+    AsyncCallbacks->OnEvent(Line);
+  }
+  return 0;
+}
+
+
+
+/******************************************************************************
+  * @brief This function notifies the end of an asynchronous AT cmd
+  * @param Request: completed command
+  * @param Status: engine completion status
+  * @retval None
+******************************************************************************/
+static void at_cmd_async_done(Modem_Engine_Request_t *Request, Modem_Engine_Status_t Status)
+{
+  ATEerror_t status = AT_UART_LINK_ERROR;  /*no response from the slave*/
+
+  if (Status == MODEM_ENGINE_OK)
+  {
+    status = (ATEerror_t)Request->Result;
+  }
+  if ((AsyncCallbacks != NULL) && (AsyncCallbacks->OnCmdDone != NULL))
+  {
+    AsyncCallbacks->OnCmdDone((ATCmd_t)Request->Tag, status);
+  }
+}
+
+
+
 /******************************************************************************
   * @brief format the AT frame to be sent to the modem (slave)
   * @param pointer to the format string
@@ -24,6 +24,8 @@
 #include "stm32l0xx_hal.h"
 #include "hw_conf.h"
 #include "hw_usart.h"
+#include "modem_uart.h"
+#include "modem_engine.h"
 #include "lrwan_ns1_atcmd.h"
 #include "tiny_sscanf.h"
 #include "timeServer.h"
@@ -34,8 +36,12 @@
 
 #define ATCTL_WAKEUP    1
 
+/* asynchronous request tag: AT group and AT command */
+#define ATCTL_ASYNC_TAG(group, cmd)     (((uint32_t)(group) << 16) | (uint32_t)(cmd))
+#define ATCTL_ASYNC_GROUP(tag)          ((ATGroup_t)((tag) >> 16))
+#define ATCTL_ASYNC_CMD(tag)            ((ATCmd_t)((tag) & 0xFFFF))
+
 /*Globle variables------------------------------------------------------------*/
-uint32_t record_num = 0;
 uint8_t atctl_dl_buf[256];
 char LoRa_AT_Cmd_Buff[DATA_TX_MAX_BUFF_SIZE];    /* Buffer used for AT cmd transmission */
 char response[DATA_RX_MAX_BUFF_SIZE];   /*not only for return code but also for return value: exemple KEY*/
@@ -56,9 +62,22 @@ static HAL_StatusTypeDef at_cmd_send(uint16_t len);
 
 static uint8_t at_cmd_format(ATCmd_t Cmd, void *ptr, Marker_t Marker);
 
+static uint8_t at_cmd_async_line(Modem_Engine_Request_t *Request, const char *Line);
+
+static void at_cmd_async_done(Modem_Engine_Request_t *Request, Modem_Engine_Status_t Status);
+
 /* Private variables ---------------------------------------------------------*/
 static uint16_t Offset = 0;   /*write position needed for sendb command*/
-static uint8_t aRxBuffer[5];  /* Buffer used for Rx input character */
+
+static const Modem_AT_Callbacks_t *AsyncCallbacks = NULL;   /*asynchronous AT cmd notifications*/
+
+static uint8_t AsyncLines = 0;   /*response lines received for the pending asynchronous cmd*/
+
+static const Modem_Engine_Callbacks_t AsyncEngineCallbacks =
+{
+  at_cmd_async_line,
+  at_cmd_async_done
+};
 static const atctl_cmd_list_t atctl_cmd_list[] =
 {
   {AT,             "AT",          atctl_at},
@@ -151,11 +170,7 @@ static const struct band_str
   {STE920,                        "STE920"},
 };
 
-static atctl_sta_t atctl_sta;
 static char atctl_rx_buf[ATCTL_CMD_BUF_SIZE];
-static volatile int16_t atctl_rx_wr_index;
-static uint8_t atctl_rx_tmp_buf[ATCTL_CMD_BUF_SIZE];
-static volatile int16_t atctl_rx_tmp_wr_index, atctl_rx_tmp_rd_index, atctl_rx_tmp_cnt;
 
 extern atctl_data_t dt;
 
@@ -594,66 +609,54 @@ static atctl_ret_t atctl_msg(char *buf, int len, atctl_data_t *dt)
 **************************************************************/
 static void atctl_reset(void)
 {
-  atctl_sta = ATCTL_RX_HEAD;
-  atctl_rx_wr_index = 0;
-  atctl_rx_tmp_cnt = 0;
-  atctl_rx_tmp_rd_index = atctl_rx_tmp_wr_index;
+  /* drop what the modem sent before the command */
+  Modem_UART_Flush();
 }
 
 /**************************************************************
-* @brief  Store the received data in some place base on the rule for easy parse
-* @param  data: one byte received
-* @retval void
+* @brief  Get the next line starting with '+' from the modem into
+*         atctl_rx_buf, the other lines are dropped
+* @param  timeout: maximum waiting time in ms, 0 to only check
+* @retval length of the line, 0 if none was received
 **************************************************************/
-static void atctl_rx_byte(uint8_t data)
+static int atctl_rx_line(uint32_t timeout)
 {
-  switch (atctl_sta)
-  {
-    case ATCTL_RX_HEAD:
-      atctl_rx_buf[0] = data;
-      if (atctl_rx_buf[0] == '+')
-      {
-        atctl_rx_wr_index = 1;
-        atctl_sta = ATCTL_RX_CMD;
-      }
-      break;
-    case ATCTL_RX_CMD:
-      atctl_rx_buf[atctl_rx_wr_index++] = data;
-      if (data == '\n')
-      {
-        atctl_sta = ATCTL_RX_DONE;
-        atctl_rx_buf[atctl_rx_wr_index] = '\0';
-      }
-      else if ((data == '\t') || (data == '\r') || (data > 'a' && data <= 'z') || \
-               (data >= ' ' && data <= '~'))
-      {
+  uint32_t tickstart = HAL_GetTick();
+  uint32_t elapsed = 0;
+  uint16_t len;
+  char *head;
+  int i;
 
-      }
-      else
-      {
-        /** Unknow character */
-        atctl_reset();
-      }
-      if ((atctl_rx_wr_index >= ATCTL_CMD_BUF_SIZE) && (atctl_sta != ATCTL_RX_DONE))
-      {
-        /** atmunication buffer overflow */
-        atctl_reset();
-      }
-      break;
-    case ATCTL_RX_DONE:
-    case ATCTL_PARSE_DONE:
-      /*save ongoing commands */
-      if (atctl_rx_tmp_cnt < ATCTL_CMD_BUF_SIZE)
+  do
+  {
+    /* the MCU sleeps until a complete line is received */
+    len = Modem_UART_ReadLine(response, sizeof(response), timeout - elapsed);
+    if (len == 0)
+    {
+      return 0;
+    }
+    head = strchr(response, '+');
+    if ((head != NULL) && (response[len - 1] == '\n') && ((len - (head - response)) < ATCTL_CMD_BUF_SIZE))
+    {
+      for (i = 0; head[i] != '\0'; i++)
       {
-        atctl_rx_tmp_buf[atctl_rx_tmp_wr_index++] = data;
-        if (atctl_rx_tmp_wr_index == ATCTL_CMD_BUF_SIZE)
+        if ((head[i] != '\t') && (head[i] != '\r') && (head[i] != '\n') && ((head[i] < ' ') || (head[i] > '~')))
         {
-          atctl_rx_tmp_wr_index = 0;
+          /** Unknow character */
+          break;
         }
-        atctl_rx_tmp_cnt++;
       }
-      break;
+      if (head[i] == '\0')
+      {
+        strcpy(atctl_rx_buf, head);
+        return i;
+      }
+    }
+    elapsed = HAL_GetTick() - tickstart;
   }
+  while (elapsed < timeout);
+
+  return 0;
 }
 
 /**************************************************************
@@ -762,7 +765,7 @@ atctl_ret_t atctl_tx(atctl_data_t *dt, ATCmd_t cmd, char *fmt, ...)
 
   if (ATCTL_WAKEUP)
   {
-    HAL_UART_Transmit(&huart1, wakeup_ch, strlen((char *)wakeup_ch), 5000);
+    Modem_UART_Send(wakeup_ch, sizeof(wakeup_ch));
   }
 
   memset(LoRa_AT_Cmd_Buff, 0x00, sizeof LoRa_AT_Cmd_Buff);
@@ -813,62 +816,14 @@ atctl_ret_t atctl_tx(atctl_data_t *dt, ATCmd_t cmd, char *fmt, ...)
 **************************************************************/
 atctl_ret_t atctl_rx(atctl_data_t *dt, int timeout)
 {
-  atctl_ret_t ret = ATCTL_RET_CMD_ERR;
-  int curindex;
-
-  if (timeout == 0)
-  {
-    if ((atctl_sta == ATCTL_RX_DONE) || ((atctl_sta == ATCTL_PARSE_DONE) && (atctl_rx_tmp_cnt > 0)))
-    {
-      timeout = ATCTL_RX_TIMEOUT;
-    }
-    else
-    {
-      return ATCTL_RET_IDLE;
-    }
-  }
+  int len;
 
-  curindex = atctl_rx_wr_index;
-  while (1)
+  len = atctl_rx_line(timeout);
+  if (len == 0)
   {
-    if ((atctl_sta == ATCTL_PARSE_DONE) && (atctl_rx_tmp_cnt > 0))
-    {
-      __disable_irq();
-      atctl_sta = ATCTL_RX_HEAD;
-      while (atctl_rx_tmp_cnt > 0)
-      {
-        atctl_rx_byte(atctl_rx_tmp_buf[atctl_rx_tmp_rd_index++]);
-        if (atctl_rx_tmp_rd_index == ATCTL_CMD_BUF_SIZE)
-        {
-          atctl_rx_tmp_rd_index = 0;
-        }
-        atctl_rx_tmp_cnt--;
-        if (atctl_sta == ATCTL_RX_DONE)
-        {
-          break;
-        }
-      }
-      __enable_irq();
-    }
-    else if (atctl_sta == ATCTL_RX_DONE)
-    {
-      atctl_sta = ATCTL_PARSE_DONE;
-      ret = atctl_parse(atctl_rx_buf, atctl_rx_wr_index, dt);
-      if (atctl_rx_tmp_cnt == 0)
-      {
-        atctl_sta = ATCTL_RX_HEAD;
-      }
-      return ret;
-    }
-    else if (atctl_sta == ATCTL_RX_HEAD)
-    {
-      return ret;
-    }
-    if (atctl_rx_wr_index > curindex)
-    {
-      curindex = atctl_rx_wr_index;
-    }
+    return (timeout == 0) ? ATCTL_RET_IDLE : ATCTL_RET_CMD_ERR;
   }
+  return atctl_parse(atctl_rx_buf, len, dt);
 }
 
 /******************************************************************************
@@ -879,7 +834,7 @@ atctl_ret_t atctl_rx(atctl_data_t *dt, int timeout)
 *****************************************************************************/
 HAL_StatusTypeDef Modem_IO_Init(void)
 {
-  if (HW_UART_Modem_Init(BAUD_RATE) == HAL_OK)
+  if ((HW_UART_Modem_Init(BAUD_RATE) == HAL_OK) && (Modem_UART_Start(&huart1) == HAL_OK))
   {
     return HAL_OK;
   }
@@ -897,6 +852,7 @@ HAL_StatusTypeDef Modem_IO_Init(void)
 *****************************************************************************/
 void Modem_IO_DeInit(void)
 {
+  Modem_UART_Stop();
   HAL_UART_MspDeInit(&huart2);
   HAL_UART_MspDeInit(&huart1);
 }
@@ -922,7 +878,7 @@ ATEerror_t  Modem_AT_Cmd(ATGroup_t at_group, ATCmd_t Cmd, void *pdata)
 
   if (ATCTL_WAKEUP)
   {
-    HAL_UART_Transmit(&huart1, wakeup_ch, strlen((char *)wakeup_ch), 5000);
+    Modem_UART_Send(wakeup_ch, sizeof(wakeup_ch));
   }
 
   switch (at_group)
@@ -980,6 +936,87 @@ ATEerror_t  Modem_AT_Cmd(ATGroup_t at_group, ATCmd_t Cmd, void *pdata)
   return Status;
 }
 
+/******************************************************************************
+ * @brief  Starts the asynchronous AT cmd handling
+ * @param  Callbacks command completion and unsolicited event notifications
+ * @retval ATCTL_RET_IDLE
+ *****************************************************************************/
+ATEerror_t Modem_AT_AsyncInit(const Modem_AT_Callbacks_t *Callbacks)
+{
+  AsyncCallbacks = Callbacks;
+  AsyncLines = 0;
+  Modem_Engine_Init(&AsyncEngineCallbacks);
+  return ATCTL_RET_IDLE;
+}
+
+/******************************************************************************
+ * @brief  Queues an AT cmd without waiting for its response
+ * @param  at_group AT group [control, set , get)
+ *         Cmd AT command
+ *         pdata pointer to the IN buffer
+ * @retval ATCTL_RET_IDLE when queued
+ *****************************************************************************/
+ATEerror_t Modem_AT_CmdAsync(ATGroup_t at_group, ATCmd_t Cmd, void *pdata)
+{
+  char cmd[MODEM_ENGINE_CMD_SIZE];
+  uint16_t Len;
+  uint16_t wakeup = 0;
+  uint32_t Timeout = ATCTL_ASYNC_TIMEOUT;
+
+  /*reset At_cmd buffer for each transmission*/
+  memset(LoRa_AT_Cmd_Buff, 0x00, sizeof LoRa_AT_Cmd_Buff);
+
+  switch (at_group)
+  {
+    case AT_CTRL:
+      Len = at_cmd_format(Cmd, NULL, CTRL_MARKER);
+      break;
+    case AT_SET:
+      Len = at_cmd_format(Cmd, pdata, SET_MARKER);
+      break;
+    case AT_GET:
+      Len = at_cmd_format(Cmd, pdata, GET_MARKER);
+      break;
+    default:
+      DBG_PRINTF("unknow group\n\r");
+      return ATCTL_RET_ERR;
+  } /*end switch(at_group)*/
+
+  switch (Cmd)
+  {
+    case AT_RESET:
+      Timeout = 0;  /*the modem does not answer*/
+      break;
+    case AT_JOIN:
+    case AT_SEND:
+    case AT_SENDB:
+    case AT_CMSG:
+    case AT_CMSGHEX:
+      Timeout = ATCTL_ASYNC_MSG_TIMEOUT;
+      break;
+    default:
+      break;
+  }
+
+  if (ATCTL_WAKEUP)
+  {
+    /*same wake up sequence as the blocking commands*/
+    memset(cmd, 0xFF, 4);
+    wakeup = 4;
+  }
+  if ((wakeup + Len) > sizeof(cmd))
+  {
+    return ATCTL_RET_ERR;
+  }
+  memcpy(&cmd[wakeup], LoRa_AT_Cmd_Buff, Len);
+
+  if (Modem_Engine_Submit(cmd, wakeup + Len, Timeout, ATCTL_ASYNC_TAG(at_group, Cmd), NULL, 0) != HAL_OK)
+  {
+    return ATCTL_RET_ERR;
+  }
+  return ATCTL_RET_IDLE;
+}
+
 
 /******************************************************************************
  * @brief  format the cmd in order to be send
@@ -1334,91 +1371,130 @@ static HAL_StatusTypeDef at_cmd_send(uint16_t len)
   HAL_StatusTypeDef RetCode;
 
   /*transmit the command from master to slave*/
-  RetCode = HAL_UART_Transmit(&huart1, (uint8_t *)LoRa_AT_Cmd_Buff, len, 5000);
+  RetCode = Modem_UART_Send((uint8_t *)LoRa_AT_Cmd_Buff, len);
   return (RetCode);
 }
 
 /******************************************************************************
-* @brief This function sends an AT cmd to debug in PC
-* @param len: length of the AT cmd to be sent
-* @retval HAL return code
+* @brief This function handles a line received by the asynchronous engine
+* @param Request: command waiting for its response, NULL when none
+* @param Line: received line, without <cr><lf>
+* @retval 1 when the line ends the response
 ******************************************************************************/
-HAL_StatusTypeDef at_printf_send(uint8_t *buf, uint16_t len)
+static uint8_t at_cmd_async_line(Modem_Engine_Request_t *Request, const char *Line)
 {
-  HAL_StatusTypeDef RetCode;
-
-  /*transmit the command from master to debug*/
-  RetCode = HAL_UART_Transmit(&huart2, (uint8_t *)buf, len, 5000);
-  return (RetCode);
-}
-
-/******************************************************************************
-* @brief This function receives response from the slave device
-* @param viod
-* @retval LoRa return code
-******************************************************************************/
-atctl_ret_t at_cmd_receive_evt(void)
-{
-  uint8_t  ResponseComplete = 0;
-
-  atctl_ret_t RetCode = ATCTL_RET_CMD_OK;
-  uint32_t time_ms = 0;
-  /*cleanup the response buffer*/
-  memset(response, 0x00, sizeof(response));
-
-  record_num = 0;
+  atctl_ret_t RetCode;
+  int i;
+  int len = strlen(Line);
+  int cmdlen = 0;
 
-  /*UART peripheral in reception process for response returned by slave*/
-  if (HAL_UART_Receive_IT(&huart1, (uint8_t *)aRxBuffer, 1) != HAL_OK)
+  if ((Line[0] != '+') || (len >= ATCTL_CMD_BUF_SIZE))
   {
-    while (1);
+    return 0;
   }
 
-
-  time_ms = TimerGetCurrentTime();
-
-  while (!ResponseComplete)
+  if (Request != NULL)
   {
-    while (HW_UART_Modem_IsNewCharReceived() == RESET)
+    for (i = 0; i < sizeof(atctl_cmd_list) / sizeof(atctl_cmd_list_t); i ++)
     {
-      if (record_num != 0)
+      if (atctl_cmd_list[i].cmd == ATCTL_ASYNC_CMD(Request->Tag))
       {
-        if (response[record_num - 1] != '\n')
+        cmdlen = strlen(atctl_cmd_list[i].name);
+        if ((0 != strncasecmp(atctl_cmd_list[i].name, Line + 1, cmdlen)) || (Line[cmdlen + 1] != ':'))
         {
-          continue;
+          cmdlen = 0;
         }
-      }
-      if (TimerGetElapsedTime(time_ms) > 300)
-      {
-        ResponseComplete = 1;
         break;
       }
     }
+  }
 
-    if (ResponseComplete)
+  if (cmdlen == 0)
+  {
+    /*not part of the pending response*/
+    if ((AsyncCallbacks != NULL) && (AsyncCallbacks->OnEvent != NULL))
     {
-      break;
+      AsyncCallbacks->OnEvent(Line);
     }
+    return 0;
+  }
 
-    time_ms = TimerGetCurrentTime();
-
-    /*process the response*/
-    response[record_num] = HW_UART_Modem_GetNewChar();
+  if (AsyncLines == 0)
+  {
+    memset(&dt, 0, sizeof(atctl_data_t));
+  }
+  strcpy(atctl_rx_buf, Line);
+  RetCode = atctl_parse(atctl_rx_buf, len, &dt);
+  Request->Result = RetCode;
+  AsyncLines++;
 
-    if (response[record_num] == '\0')
-    {
-      continue;
-    }
+  /*a message or a join ends with its Done line, DR and DELAY answer on several lines*/
+  switch (RetCode)
+  {
+    case ATCTL_RET_CMD_MSG:
+      return ((dt.msg.sta == ATCTL_MSG_DONE) || (dt.msg.sta == ATCTL_MSG_BUSY)) ? 1 : 0;
+    case ATCTL_RET_CMD_JOIN:
+      return ((dt.join.sta == ATCTL_MSG_DONE) || (dt.join.sta == ATCTL_MSG_BUSY)) ? 1 : 0;
+    case ATCTL_RET_CMD_DELAY:
+      return ((ATCTL_ASYNC_GROUP(Request->Tag) != AT_GET) || (AsyncLines >= 4)) ? 1 : 0;
+    case ATCTL_RET_CMD_DR:
+      return (AsyncLines >= 2) ? 1 : 0;
+    default:
+      return 1;
+  }
+}
 
-    /*process the rx data in the atctl_rx_byte*/
-    atctl_rx_byte(response[record_num++]);
+/******************************************************************************
+* @brief This function notifies the end of an asynchronous AT cmd
+* @param Request: completed command
+* @param Status: engine completion status
+* @retval None
+******************************************************************************/
+static void at_cmd_async_done(Modem_Engine_Request_t *Request, Modem_Engine_Status_t Status)
+{
+  ATEerror_t RetCode = ATCTL_RET_IDLE;  /*no response from the modem*/
 
-    HAL_UART_Receive_IT(&huart1, (uint8_t *)aRxBuffer, 1) ;
+  if ((Status == MODEM_ENGINE_OK) || (AsyncLines != 0))
+  {
+    /*a timeout after some response lines keeps what was parsed*/
+    RetCode = (ATEerror_t)Request->Result;
+  }
+  else if (Status == MODEM_ENGINE_LINK_ERROR)
+  {
+    RetCode = ATCTL_RET_ERR;
   }
-  huart1.gState = HAL_UART_STATE_READY;
-  huart1.RxState = HAL_UART_STATE_READY;        /*to be checked since was validated with previous */
+  AsyncLines = 0;
+  if ((AsyncCallbacks != NULL) && (AsyncCallbacks->OnCmdDone != NULL))
+  {
+    AsyncCallbacks->OnCmdDone(ATCTL_ASYNC_CMD(Request->Tag), RetCode);
+  }
+}
+
+/******************************************************************************
+* @brief This function sends an AT cmd to debug in PC
+* @param len: length of the AT cmd to be sent
+* @retval HAL return code
+******************************************************************************/
+HAL_StatusTypeDef at_printf_send(uint8_t *buf, uint16_t len)
+{
+  HAL_StatusTypeDef RetCode;
 
-  return RetCode;
+  /*transmit the command from master to debug*/
+  RetCode = HAL_UART_Transmit(&huart2, (uint8_t *)buf, len, 5000);
+  return (RetCode);
+}
+
+/******************************************************************************
+* @brief This function receives response from the slave device
+* @param viod
+* @retval LoRa return code
+******************************************************************************/
+atctl_ret_t at_cmd_receive_evt(void)
+{
+  /* the event stays buffered until atctl_rx parses it */
+  Modem_UART_WaitLine(ATCTL_RX_TIMEOUT);
+
+  return ATCTL_RET_CMD_OK;
 }
 
 /******************************************************************************
@@ -1429,80 +1505,33 @@ atctl_ret_t at_cmd_receive_evt(void)
 ******************************************************************************/
 atctl_ret_t at_cmd_receive(ATCmd_t Cmd, atctl_data_t *dt)
 {
-  uint8_t  ResponseComplete = 0;
   uint16_t i = 0;
-  uint32_t time_ms = 0;
+  int len;
 
   atctl_ret_t RetCode = ATCTL_RET_IDLE;
 
   uint32_t response_timeout = 0;
-  /*cleanup the response buffer*/
-  memset(response, 0x00, sizeof(response));
 
-  /*UART peripheral in reception process for response returned by slave*/
-  if (HAL_UART_Receive_IT(&huart1, (uint8_t *)aRxBuffer, 1) != HAL_OK)
+  if (Cmd == AT_DR)
   {
-    while (1);
+    response_timeout = 3000;
   }
-
-
-  time_ms = TimerGetCurrentTime();
-
-  while (!ResponseComplete)
+  else
   {
-    while (HW_UART_Modem_IsNewCharReceived() == RESET)
-    {
-      if ((Cmd == AT_DR) && (i == 0))
-      {
-        response_timeout = 3000;
-      }
-      else
-      {
-        response_timeout = 300;
-      }
-
-      if (TimerGetElapsedTime(time_ms) > response_timeout)
-      {
-        ResponseComplete = 1;
-        break;
-      }
-    }
-
-    if (ResponseComplete)
-    {
-      break;
-    }
-
-    time_ms = TimerGetCurrentTime();
-
-    /*process the response*/
-    response[i] = HW_UART_Modem_GetNewChar();
-
-    if (response[i] == '\0')
-    {
-      continue;
-    }
-
-    /*process the rx data in the atctl_rx_byte*/
-    atctl_rx_byte(response[i]);
-
-    i++;
-
-    HAL_UART_Receive_IT(&huart1, (uint8_t *)aRxBuffer, 1) ;
+    response_timeout = ATCTL_RX_TIMEOUT;
   }
-  huart1.gState = HAL_UART_STATE_READY;
-  huart1.RxState = HAL_UART_STATE_READY;        /*to be checked since was validated with previous */
 
+  len = atctl_rx_line(response_timeout);
 
   /* need to parse the rx data, and RetCode indicates the result */
-  if (i == 0)
+  if (len == 0)
   {
     return RetCode;
   }
 
   memset(dt, 0, sizeof(atctl_data_t));
   /*handle  and parse the rx data*/
-  RetCode = atctl_rx(dt, 300);/* 300ms */
+  RetCode = atctl_parse(atctl_rx_buf, len, dt);
 
   /*do next base on the parsed data*/
   if (RetCode == ATCTL_RET_CMD_MSG)
@@ -71,6 +71,8 @@ typedef enum Marker_s
 #define ATCTL_CMD_BUF_SIZE              (250)
 #define ATCTL_DL_BUF_SIZE               (100)
 #define ATCTL_RX_TIMEOUT                (300)       /* ms */
+#define ATCTL_ASYNC_TIMEOUT             (3000)      /* ms, asynchronous command response */
+#define ATCTL_ASYNC_MSG_TIMEOUT         (30000)     /* ms, asynchronous join or message up to its Done */
 #define ATCTL_CMD_MAX_SIZE              (10)
 
 /* Private typedef -----------------------------------------------------------*/
@@ -172,13 +174,12 @@ typedef struct
   atctl_func func;
 } atctl_cmd_list_t;
 
-typedef enum
+/*type definition for the asynchronous AT cmd notifications*/
+typedef struct sModemATCallbacks
 {
-  ATCTL_RX_HEAD,
-  ATCTL_RX_CMD,
-  ATCTL_RX_DONE,
-  ATCTL_PARSE_DONE,
-} atctl_sta_t;
+  void (*OnCmdDone)(ATCmd_t Cmd, ATEerror_t Status);   /*Modem_AT_CmdAsync completed, response parsed in dt*/
+  void (*OnEvent)(const char *Event);                  /*line sent by the modem outside of a response*/
+} Modem_AT_Callbacks_t;
 
 /*type definition for SENDB command*/
 typedef struct sSendDataBinary
@@ -268,6 +269,28 @@ HAL_StatusTypeDef at_printf_send(uint8_t *buf, uint16_t len);
 
 ATEerror_t  Modem_AT_Cmd(ATGroup_t at_group, ATCmd_t Cmd, void *pdata);
 
+/******************************************************************************
+ * @brief  Starts the asynchronous AT cmd handling, Modem_Engine_Process() is
+ *         then to be called from the application main loop
+ * @param  Callbacks command completion and unsolicited event notifications
+ * @retval ATCTL_RET_IDLE
+ *****************************************************************************/
+ATEerror_t Modem_AT_AsyncInit(const Modem_AT_Callbacks_t *Callbacks);
+
+/******************************************************************************
+ * @brief  Queues an AT cmd without waiting for its response, its status is
+ *         notified through OnCmdDone once the response is parsed in dt. A
+ *         join or a message completes on its Done line. A command longer
+ *         than MODEM_ENGINE_CMD_SIZE, e.g. a long MSGHEX, is rejected: the
+ *         application may define it up to DATA_TX_MAX_BUFF_SIZE + 4.
+ * @param  at_group AT group [control, set , get)
+ *         Cmd AT command
+ *         pdata pointer to the IN buffer
+ * @retval ATCTL_RET_IDLE when queued
+ * @retval ATCTL_RET_ERR when the queue is full or the command too long
+ *****************************************************************************/
+ATEerror_t Modem_AT_CmdAsync(ATGroup_t at_group, ATCmd_t Cmd, void *pdata);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,6 +24,8 @@
 #include "stm32l0xx_hal.h"
 #include "hw_conf.h"
 #include "hw_usart.h"
+#include "modem_uart.h"
+#include "modem_engine.h"
 #include "atcmd.h"
 #include "tiny_sscanf.h"
 
@@ -35,7 +37,7 @@
 /* External variables --------------------------------------------------------*/
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
-
+#define AT_RESPONSE_TIMEOUT     10000   /* ms, maximum time for the slave to answer a command */
 
 /* Private macro -------------------------------------------------------------*/
 
@@ -46,7 +48,7 @@ char LoRa_AT_Cmd_Buff[DATA_TX_MAX_BUFF_SIZE];    /* Buffer used for AT cmd trans
 
 static uint16_t Offset = 0;   /*write position needed for sendb command*/
 
-static uint8_t aRxBuffer[5];  /* Buffer used for Rx input character */
+static const Modem_AT_Callbacks_t *AsyncCallbacks = NULL;   /*asynchronous AT cmd notifications*/
 
 static char response[DATA_RX_MAX_BUFF_SIZE];
 /*has to be the largest of the response*/
@@ -77,6 +79,17 @@ static ATEerror_t at_cmd_receive(void *pdata);
 
 static ATEerror_t at_cmd_responseAnalysing(const char *ReturnResp);
 
+static ATEerror_t at_cmd_lineAnalysing(const char *Line);
+
+static uint8_t at_cmd_async_line(Modem_Engine_Request_t *Request, const char *Line);
+
+static void at_cmd_async_done(Modem_Engine_Request_t *Request, Modem_Engine_Status_t Status);
+
+static const Modem_Engine_Callbacks_t AsyncEngineCallbacks =
+{
+  at_cmd_async_line,
+  at_cmd_async_done
+};
 
 
 /* Exported functions ------------------------------------------------------- */
@@ -90,7 +103,7 @@ static ATEerror_t at_cmd_responseAnalysing(const char *ReturnResp);
 *****************************************************************************/
 ATEerror_t Modem_IO_Init(void)
 {
-  if (HW_UART_Modem_Init(BAUD_RATE) == HAL_OK)
+  if ((HW_UART_Modem_Init(BAUD_RATE) == HAL_OK) && (Modem_UART_Start(&huart2) == HAL_OK))
   {
     return AT_OK;
   }
@@ -108,6 +121,7 @@ ATEerror_t Modem_IO_Init(void)
 *****************************************************************************/
 void Modem_IO_DeInit(void)
 {
+  Modem_UART_Stop();
   HAL_UART_MspDeInit(&huart2);
 }
 
@@ -125,6 +139,12 @@ ATEerror_t  Modem_AT_Cmd(ATGroup_t at_group, ATCmd_t Cmd, void *pdata)
   HAL_StatusTypeDef HAL_Status;
   uint16_t Len;
 
+  if (Cmd >= AT_END_AT)
+  {
+    DBG_PRINTF("unknow cmd\n\r");
+    return AT_END_ERROR;
+  }
+
   /*reset At_cmd buffer for each transmission*/
   memset(LoRa_AT_Cmd_Buff, 0x00, sizeof LoRa_AT_Cmd_Buff);
 
@@ -175,6 +195,84 @@ ATEerror_t  Modem_AT_Cmd(ATGroup_t at_group, ATCmd_t Cmd, void *pdata)
 }
 
 
+/******************************************************************************
+ * @brief  Starts the asynchronous AT cmd handling
+ * @param  Callbacks command completion and unsolicited event notifications
+ * @retval AT_OK
+ *****************************************************************************/
+ATEerror_t Modem_AT_AsyncInit(const Modem_AT_Callbacks_t *Callbacks)
+{
+  AsyncCallbacks = Callbacks;
+  Modem_Engine_Init(&AsyncEngineCallbacks);
+  return AT_OK;
+}
+
+
+/******************************************************************************
+ * @brief  Queues an AT cmd without waiting for its response
+ * @param  at_group AT group [control, set , get)
+ *         Cmd AT command
+ *         pdata pointer to the IN/OUT buffer
+ *         size size of the OUT buffer of a get
+ * @retval AT_OK when queued
+ *****************************************************************************/
+ATEerror_t Modem_AT_CmdAsync(ATGroup_t at_group, ATCmd_t Cmd, void *pdata, uint16_t size)
+{
+  HAL_StatusTypeDef HAL_Status;
+  uint16_t Len;
+  uint32_t Timeout = AT_RESPONSE_TIMEOUT;
+
+  if (Cmd >= AT_END_AT)
+  {
+    DBG_PRINTF("unknow cmd\n\r");
+    return AT_END_ERROR;
+  }
+
+  /*reset At_cmd buffer for each transmission*/
+  memset(LoRa_AT_Cmd_Buff, 0x00, sizeof LoRa_AT_Cmd_Buff);
+
+  switch (at_group)
+  {
+    case AT_CTRL:
+    {
+      Len = at_cmd_format(Cmd, NULL, CTRL_MARKER);
+      if (Cmd == AT_RESET)
+      {
+        Timeout = 0;  /*the slave does not answer*/
+      }
+      pdata = NULL;
+      break;
+    }
+    case AT_SET:
+    {
+      Len = at_cmd_format(Cmd, pdata, SET_MARKER);
+      pdata = NULL;   /*only a return code is expected*/
+      break;
+    }
+    case AT_GET:
+    {
+      Len = at_cmd_format(Cmd, pdata, GET_MARKER);
+      break;
+    }
+    default:
+      DBG_PRINTF("unknow group\n\r");
+      return AT_END_ERROR;
+  } /*end switch (at_group)*/
+
+  /*the command is copied, LoRa_AT_Cmd_Buff can be reused right away*/
+  HAL_Status = Modem_Engine_Submit(LoRa_AT_Cmd_Buff, Len, Timeout, Cmd, pdata, size);
+  if (HAL_Status == HAL_BUSY)
+  {
+    return (AT_BUSY_ERROR);
+  }
+  else if (HAL_Status != HAL_OK)
+  {
+    return (AT_TEST_PARAM_OVERFLOW);
+  }
+  return AT_OK;
+}
+
+
 /******************************************************************************
  * @brief  format the cmd in order to be send
  * @param  Cmd AT command
@@ -356,7 +454,14 @@ static uint8_t at_cmd_format(ATCmd_t Cmd, void *ptr, Marker_t Marker)
       break;
     }
     default:
-      len = AT_VPRINTF("%s%s%s\r\n", AT_HEADER, CmdTab[Cmd], Marker);
+      /*no AT string beyond CmdTab, AT_END_AT included*/
+      if (Cmd >= (sizeof(CmdTab) / sizeof(CmdTab[0])))
+      {
+        len = 0;
+        break;
+      }
+      len = AT_VPRINTF("%s%s%s\r\n", AT_HEADER, CmdTab[Cmd],
+                       (Marker == SET_MARKER) ? AT_SET_MARKER : (Marker == GET_MARKER) ? AT_GET_MARKER : AT_NULL_MARKER);
       DBG_PRINTF("format not yet supported \n\r");
       break;
   } /*end switch(cmd)*/
@@ -373,8 +478,11 @@ static HAL_StatusTypeDef at_cmd_send(uint16_t len)
 {
   HAL_StatusTypeDef RetCode;
 
+  /*drop what the slave sent outside of a command response*/
+  Modem_UART_Flush();
+
   /*transmit the command from master to slave*/
-  RetCode = HAL_UART_Transmit(&huart2, (uint8_t *)LoRa_AT_Cmd_Buff, len, 5000);
+  RetCode = Modem_UART_Send((uint8_t *)LoRa_AT_Cmd_Buff, len);
   return (RetCode);
 }
 
@@ -387,81 +495,55 @@ static HAL_StatusTypeDef at_cmd_send(uint16_t len)
 ******************************************************************************/
 static ATEerror_t at_cmd_receive(void *pdata)
 {
-  uint8_t  ResponseComplete = 0;
-  int8_t i = 0;
-  int8_t charnumber = 0;
-  ATEerror_t RetCode;
+  uint16_t i = 0;    /*length of the response received so far*/
+  uint16_t len;
   uint8_t NoReturnCode = 1;  /*to discriminate the Get return code from return value*/
 
   /*cleanup the response buffer*/
   memset(response, 0x00, 16);
 
-  /*UART peripheral in reception process for response returned by slave*/
-  if (HAL_UART_Receive_IT(&huart2, (uint8_t *)aRxBuffer, 1) != HAL_OK)
-  {
-    while (1);
-  }
-
-  while (!ResponseComplete)
+  while (1)
   {
-    while (HW_UART_Modem_IsNewCharReceived() == RESET);
-
-    /*process the response*/
-    response[i] = HW_UART_Modem_GetNewChar();
+    /*wait up to the line feed marker, the MCU sleeps meanwhile*/
+    len = Modem_UART_ReadLine(&response[i], DATA_RX_MAX_BUFF_SIZE - i, AT_RESPONSE_TIMEOUT);
+    if (len == 0)
+    {
+      return (AT_UART_LINK_ERROR);  /*no response from the slave*/
+    }
+    i += len;
+    if (response[i - 1] != '\n') /* frame overflow */
+    {
+      return (AT_TEST_PARAM_OVERFLOW);
+    }
 
-    /*wait up to carriage return OR the line feed marker*/
-    if (/*(response[i] =='\r') || */(response[i] == '\n'))
+    if (pdata == NULL) /*return code following a SET cmd or simple AT cmd*/
     {
-      if (pdata == NULL) /*return code following a SET cmd or simple AT cmd*/
+      if (i > 2) /*return code following a SET cmd or simple AT cmd- we skip the first <cr><ln>*/
       {
-        if (i > 1) /*return code following a SET cmd or simple AT cmd- we skip the first <cr><ln>*/
-        {
-          i = 0;
-          ResponseComplete = 1;
-          RetCode = at_cmd_responseAnalysing(response);
-          break;
-        }
+        return (at_cmd_responseAnalysing(response));
       }
-      else    /* returned value following a GET cmd */
+    }
+    else    /* returned value following a GET cmd */
+    {
+      if (NoReturnCode)
       {
-        if (i != 0 && NoReturnCode)
+        if (i > 1)
         {
           /*first statement to get back the return value*/
-          response[i] = '\0';
+          response[i - 1] = '\0';
           strcpy(pdata, response);
           memset(response, 0x00, 16);
-          i = -1; /*to compensate the next index iteration and restart in [0]*/
+          i = 0;
           NoReturnCode = 0;  /*return code for the Get cmd*/
         }
-        else
-        {
-          if (i > 1)
-          {
-            /*second statement to get back the return code*/
-            i = 0;
-            ResponseComplete = 1;   /*when value + return code have been trapped*/
-            RetCode = at_cmd_responseAnalysing(response);
-            memset(response, 0x00, 16);
-            break;
-          }
-        }
       }
-    }
-    else
-    {
-      if (i == (DATA_RX_MAX_BUFF_SIZE - 1)) /* frame overflow */
+      else if (i > 2)
       {
-        i = 0;
-        return (AT_TEST_PARAM_OVERFLOW);
+        /*second statement to get back the return code*/
+        return (at_cmd_responseAnalysing(response));
       }
     }
-    i++;
-    HAL_UART_Receive_IT(&huart2, (uint8_t *)aRxBuffer, 1) ;
-    charnumber++;
-  } /*end while(!Responsablecomplete)*/
-  huart2.gState = HAL_UART_STATE_READY;
-  huart2.RxState = HAL_UART_STATE_READY;        /*to be checked since was validated with previous */
-  return (RetCode);                             /*version of HAL .. there was not Rx field state*/
+  }
 }
 
 
@@ -492,6 +574,84 @@ static ATEerror_t at_cmd_responseAnalysing(const char *ReturnResp)
 
 
 
+/******************************************************************************
+  * @brief This function does analysis of a line received by the device
+  * @param Line: received line, without <cr><lf>
+  * @retval ATEerror_t error type, AT_END_ERROR when not a return code
+******************************************************************************/
+static ATEerror_t at_cmd_lineAnalysing(const char *Line)
+{
+  const char *code;
+  size_t len;
+  int i;
+
+  for (i = 0; i < AT_END_ERROR; i++)
+  {
+    /*return code string without its surrounding <cr><lf>*/
+    code = ATE_RetCode[i].RetCodeStr + strspn(ATE_RetCode[i].RetCodeStr, "\r\n");
+    len = strcspn(code, "\r\n");
+    if ((strlen(Line) == len) && (strncmp(Line, code, len) == 0))
+    {
+      return (ATE_RetCode[i].RetCode);
+    }
+  }
+  return (AT_END_ERROR);
+}
+
+
+
+/******************************************************************************
+  * @brief This function handles a line received by the asynchronous engine
+  * @param Request: command waiting for its response, NULL when none
+  * @param Line: received line, without <cr><lf>
+  * @retval 1 when the line is the return code ending the response
+******************************************************************************/
+static uint8_t at_cmd_async_line(Modem_Engine_Request_t *Request, const char *Line)
+{
+  ATEerror_t status = at_cmd_lineAnalysing(Line);
+
+  if ((Request != NULL) && (status != AT_END_ERROR))
+  {
+    Request->Result = status;
+    return 1;
+  }
+
+  if ((Request != NULL) && (Request->Data != NULL))
+  {
+    /*returned value following a GET cmd, before its return code*/
+    Modem_Engine_StoreData(Request, Line);
+  }
+  else if ((AsyncCallbacks != NULL) && (AsyncCallbacks->OnEvent != NULL))
+  {
+    AsyncCallbacks->OnEvent(Line);
+  }
+  return 0;
+}
+
+
+
+/******************************************************************************
+  * @brief This function notifies the end of an asynchronous AT cmd
+  * @param Request: completed command
+  * @param Status: engine completion status
+  * @retval None
+******************************************************************************/
+static void at_cmd_async_done(Modem_Engine_Request_t *Request, Modem_Engine_Status_t Status)
+{
+  ATEerror_t status = AT_UART_LINK_ERROR;  /*no response from the slave*/
+
+  if (Status == MODEM_ENGINE_OK)
+  {
+    status = (ATEerror_t)Request->Result;
+  }
+  if ((AsyncCallbacks != NULL) && (AsyncCallbacks->OnCmdDone != NULL))
+  {
+    AsyncCallbacks->OnCmdDone((ATCmd_t)Request->Tag, status);
+  }
+}
+
+
+
 /******************************************************************************
   * @brief format the AT frame to be sent to the modem (slave)
   * @param pointer to the format string
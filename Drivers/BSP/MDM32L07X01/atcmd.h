@@ -109,6 +109,13 @@ typedef struct RetCode_s
   ATEerror_t RetCode;
 } ATE_RetCode_t;
 
+/*type definition for the asynchronous AT cmd notifications*/
+typedef struct sModemATCallbacks
+{
+  void (*OnCmdDone)(ATCmd_t Cmd, ATEerror_t Status);   /*Modem_AT_CmdAsync completed, GET value copied*/
+  void (*OnEvent)(const char *Event);                  /*line sent by the modem outside of a response*/
+} Modem_AT_Callbacks_t;
+
 /*type definition for AT cmd format identification*/
 typedef enum Fmt
 {
@@ -163,6 +170,26 @@ void Modem_IO_DeInit(void) ;
  *****************************************************************************/
 ATEerror_t Modem_AT_Cmd(ATGroup_t at_group, ATCmd_t Cmd, void *pdata);
 
+/******************************************************************************
+ * @brief  Starts the asynchronous AT cmd handling, Modem_Engine_Process() is
+ *         then to be called from the application main loop
+ * @param  Callbacks command completion and unsolicited event notifications
+ * @retval AT_OK
+ *****************************************************************************/
+ATEerror_t Modem_AT_AsyncInit(const Modem_AT_Callbacks_t *Callbacks);
+
+/******************************************************************************
+ * @brief  Queues an AT cmd without waiting for its response, its status is
+ *         notified through OnCmdDone
+ * @param  at_group AT group [control, set , get)
+ *         Cmd AT command
+ *         pdata pointer to the IN/OUT buffer, kept until OnCmdDone for a get
+ *         size size of the OUT buffer of a get, including the null character
+ * @retval AT_OK when queued
+ * @retval AT_BUSY_ERROR when the queue is full
+ *****************************************************************************/
+ATEerror_t Modem_AT_CmdAsync(ATGroup_t at_group, ATCmd_t Cmd, void *pdata, uint16_t size);
+
 
 
 #ifdef __cplusplus
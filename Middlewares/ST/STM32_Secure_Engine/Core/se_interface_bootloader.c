@@ -714,6 +714,336 @@ SE_ErrorStatus SE_VerifyFwRawHeaderTag(SE_StatusTypeDef *peSE_Status, SE_FwRawHe
 
 }
 
+/**
+  * @brief Streaming install helper: calls a CRYPTO_LL Init service without caller region check.
+  *        The check is done by the public SE_IMG_Install_xxx function calling this helper.
+  * @param eID CallGate function ID (SE_CRYPTO_LL_DECRYPT_INIT_ID or SE_CRYPTO_LL_AUTHENTICATE_FW_INIT_ID).
+  * @param peSE_Status Secure Engine Status.
+  * @param pxSE_Metadata Metadata that will be used to fill the Crypto Init structure.
+  * @param SE_FwType Type of Fw Image.
+  * @retval SE_ErrorStatus SE_SUCCESS if successful, SE_ERROR otherwise.
+  */
+static SE_ErrorStatus SE_IMG_Install_CallInit(SE_FunctionIDTypeDef eID, SE_StatusTypeDef *peSE_Status,
+                                              SE_FwRawHeaderTypeDef *pxSE_Metadata, int32_t SE_FwType)
+{
+  SE_ErrorStatus e_ret_status;
+
+#ifdef SFU_ISOLATE_SE_WITH_MPU
+  if (0 != SE_IsUnprivileged())
+  {
+    uint32_t params[2] = {(uint32_t)pxSE_Metadata, (uint32_t)SE_FwType};
+    SE_SysCall(&e_ret_status, eID, peSE_Status, &params);
+  }
+  else
+  {
+#endif /* SFU_ISOLATE_SE_WITH_MPU */
+
+    /* Set the CallGate function pointer */
+    SET_CALLGATE();
+
+    SE_EnterSecureMode();
+    e_ret_status = (*SE_CallGatePtr)(eID, peSE_Status, pxSE_Metadata, SE_FwType);
+    SE_ExitSecureMode();
+#ifdef SFU_ISOLATE_SE_WITH_MPU
+  }
+#endif /* SFU_ISOLATE_SE_WITH_MPU */
+  return e_ret_status;
+}
+
+/**
+  * @brief Streaming install helper: calls a CRYPTO_LL Append service without caller region check.
+  * @param eID CallGate function ID (SE_CRYPTO_LL_DECRYPT_APPEND_ID or SE_CRYPTO_LL_AUTHENTICATE_FW_APPEND_ID).
+  * @param peSE_Status Secure Engine Status.
+  * @param pInputBuffer pointer to Input Buffer.
+  * @param InputSize Input Size (bytes).
+  * @param pOutputBuffer pointer to Output Buffer.
+  * @param pOutputSize pointer to Output Size (bytes).
+  * @retval SE_ErrorStatus SE_SUCCESS if successful, SE_ERROR otherwise.
+  */
+static SE_ErrorStatus SE_IMG_Install_CallAppend(SE_FunctionIDTypeDef eID, SE_StatusTypeDef *peSE_Status,
+                                                const uint8_t *pInputBuffer, int32_t InputSize,
+                                                uint8_t *pOutputBuffer, int32_t *pOutputSize)
+{
+  SE_ErrorStatus e_ret_status;
+
+#ifdef SFU_ISOLATE_SE_WITH_MPU
+  if (0 != SE_IsUnprivileged())
+  {
+    uint32_t params[4] = {(uint32_t)pInputBuffer, (uint32_t)InputSize, (uint32_t)pOutputBuffer, (uint32_t)pOutputSize};
+    SE_SysCall(&e_ret_status, eID, peSE_Status, &params);
+  }
+  else
+  {
+#endif /* SFU_ISOLATE_SE_WITH_MPU */
+
+    /* Set the CallGate function pointer */
+    SET_CALLGATE();
+
+    SE_EnterSecureMode();
+    e_ret_status = (*SE_CallGatePtr)(eID, peSE_Status, pInputBuffer, InputSize, pOutputBuffer, pOutputSize);
+    SE_ExitSecureMode();
+#ifdef SFU_ISOLATE_SE_WITH_MPU
+  }
+#endif /* SFU_ISOLATE_SE_WITH_MPU */
+  return e_ret_status;
+}
+
+/**
+  * @brief Streaming install helper: calls a CRYPTO_LL Finish service without caller region check.
+  * @param eID CallGate function ID (SE_CRYPTO_LL_DECRYPT_FINISH_ID or SE_CRYPTO_LL_AUTHENTICATE_FW_FINISH_ID).
+  * @param peSE_Status Secure Engine Status.
+  * @param pOutputBuffer pointer to Output Buffer.
+  * @param pOutputSize pointer to Output Size (bytes).
+  * @retval SE_ErrorStatus SE_SUCCESS if successful, SE_ERROR otherwise.
+  */
+static SE_ErrorStatus SE_IMG_Install_CallFinish(SE_FunctionIDTypeDef eID, SE_StatusTypeDef *peSE_Status,
+                                                uint8_t *pOutputBuffer, int32_t *pOutputSize)
+{
+  SE_ErrorStatus e_ret_status;
+
+#ifdef SFU_ISOLATE_SE_WITH_MPU
+  if (0 != SE_IsUnprivileged())
+  {
+    uint32_t params[2] = {(uint32_t)pOutputBuffer, (uint32_t)pOutputSize};
+    SE_SysCall(&e_ret_status, eID, peSE_Status, &params);
+  }
+  else
+  {
+#endif /* SFU_ISOLATE_SE_WITH_MPU */
+
+    /* Set the CallGate function pointer */
+    SET_CALLGATE();
+
+    SE_EnterSecureMode();
+    e_ret_status = (*SE_CallGatePtr)(eID, peSE_Status, pOutputBuffer, pOutputSize);
+    SE_ExitSecureMode();
+#ifdef SFU_ISOLATE_SE_WITH_MPU
+  }
+#endif /* SFU_ISOLATE_SE_WITH_MPU */
+  return e_ret_status;
+}
+
+/**
+  * @brief Streaming install helper: hands a decrypted buffer over to the flash.
+  *        The previous write (other buffer) is completed first, then the new write is started and the buffers are
+  *        swapped so that the next chunk can be decrypted while this one is programmed.
+  * @param pxCtx Streaming install context.
+  * @param Length Number of decrypted bytes available in the active buffer.
+  * @retval SE_ErrorStatus SE_SUCCESS if successful, SE_ERROR otherwise.
+  */
+static SE_ErrorStatus SE_IMG_Install_Program(SE_IMG_InstallCtxTypeDef *pxCtx, uint32_t Length)
+{
+  /* Wait for the programming of the previous chunk: its buffer is about to be reused */
+  if (pxCtx->WritePending != 0U)
+  {
+    pxCtx->WritePending = 0U;
+    if (pxCtx->pFlashOps->WriteWait() != SE_SUCCESS)
+    {
+      return SE_ERROR;
+    }
+  }
+
+  if (Length == 0U)
+  {
+    return SE_SUCCESS;
+  }
+
+  if (pxCtx->pFlashOps->WriteStart(pxCtx->pDestination, pxCtx->pBuffer[pxCtx->Active], Length) != SE_SUCCESS)
+  {
+    return SE_ERROR;
+  }
+  pxCtx->WritePending = 1U;
+  pxCtx->pDestination += Length;
+  pxCtx->InstalledSize += Length;
+  pxCtx->Active ^= 1U;
+
+  return SE_SUCCESS;
+}
+
+/**
+  * @brief Secure Engine streaming install Init function.
+  *        Initializes the decryption (and the FW authentication when the FW tag is computed on the clear firmware)
+  *        and the double-buffered pipeline programming the decrypted firmware into flash.
+  * @param peSE_Status Secure Engine Status.
+  *        This parameter can be a value of @ref SE_Status_Structure_definition.
+  * @param pxCtx Streaming install context, allocated by the caller.
+  * @param pxFlashOps Flash programming primitives.
+  * @param pBuffer0 first buffer (ChunkSize bytes) in SBSFU RAM.
+  * @param pBuffer1 second buffer (ChunkSize bytes) in SBSFU RAM.
+  * @param ChunkSize size of each buffer, i.e. maximum InputSize of @ref SE_IMG_Install_Append.
+  * @param pDestination flash address where the decrypted firmware is programmed.
+  * @param pxSE_Metadata Metadata that will be used to fill the Crypto Init structure.
+  * @param SE_FwType Type of Fw Image.
+  *        This parameter can be SE_FW_IMAGE_COMPLETE or SE_FW_IMAGE_PARTIAL.
+  * @retval SE_ErrorStatus SE_SUCCESS if successful, SE_ERROR otherwise.
+  */
+SE_ErrorStatus SE_IMG_Install_Init(SE_StatusTypeDef *peSE_Status, SE_IMG_InstallCtxTypeDef *pxCtx,
+                                   const SE_IMG_FlashOpsTypeDef *pxFlashOps, uint8_t *pBuffer0, uint8_t *pBuffer1,
+                                   uint32_t ChunkSize, void *pDestination, SE_FwRawHeaderTypeDef *pxSE_Metadata,
+                                   int32_t SE_FwType)
+{
+  SE_ErrorStatus e_ret_status;
+
+  /* Check if the call is coming from SFU code*/
+  __IS_SFU_RESERVED();
+
+  /* Check the parameters */
+  if ((pxCtx == NULL) || (pxFlashOps == NULL) || (pxFlashOps->WriteStart == NULL) || (pxFlashOps->WriteWait == NULL)
+      || (pBuffer0 == NULL) || (pBuffer1 == NULL))
+  {
+    return SE_ERROR;
+  }
+  /*  in AES-GCM 16 bytes can be written by the Finish services */
+  if (ChunkSize < 16U)
+  {
+    return SE_ERROR;
+  }
+  if ((SE_FwType != SE_FW_IMAGE_COMPLETE) && (SE_FwType != SE_FW_IMAGE_PARTIAL))
+  {
+    return SE_ERROR;
+  }
+
+  pxCtx->pFlashOps = pxFlashOps;
+  pxCtx->pBuffer[0] = pBuffer0;
+  pxCtx->pBuffer[1] = pBuffer1;
+  pxCtx->ChunkSize = ChunkSize;
+  pxCtx->pDestination = (uint8_t *)pDestination;
+  pxCtx->Active = 0U;
+  pxCtx->WritePending = 0U;
+  pxCtx->InstalledSize = 0U;
+
+  e_ret_status = SE_IMG_Install_CallInit(SE_CRYPTO_LL_DECRYPT_INIT_ID, peSE_Status, pxSE_Metadata, SE_FwType);
+
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_ECCDSA_WITH_AES128_CBC_SHA256)
+  /* The FW tag is computed on the clear firmware: hash each chunk right after its decryption */
+  if (e_ret_status == SE_SUCCESS)
+  {
+    e_ret_status = SE_IMG_Install_CallInit(SE_CRYPTO_LL_AUTHENTICATE_FW_INIT_ID, peSE_Status, pxSE_Metadata,
+                                           SE_FwType);
+  }
+#endif /* SECBOOT_CRYPTO_SCHEME */
+
+  return e_ret_status;
+}
+
+/**
+  * @brief Secure Engine streaming install Append function.
+  *        Decrypts (and authenticates) one encrypted chunk into the free buffer while the previous chunk is still
+  *        being programmed, then starts the programming of this chunk.
+  * @param peSE_Status Secure Engine Status.
+  *        This parameter can be a value of @ref SE_Status_Structure_definition.
+  * @param pxCtx Streaming install context.
+  * @param pInputBuffer pointer to the encrypted chunk.
+  * @param InputSize size (bytes) of the encrypted chunk, lower or equal to the context ChunkSize.
+  * @retval SE_ErrorStatus SE_SUCCESS if successful, SE_ERROR otherwise.
+  */
+SE_ErrorStatus SE_IMG_Install_Append(SE_StatusTypeDef *peSE_Status, SE_IMG_InstallCtxTypeDef *pxCtx,
+                                     const uint8_t *pInputBuffer, int32_t InputSize)
+{
+  SE_ErrorStatus e_ret_status;
+  int32_t output_size = 0;
+
+  /* Check if the call is coming from SFU code*/
+  __IS_SFU_RESERVED();
+
+  /* Check the parameters */
+  if ((pxCtx == NULL) || (InputSize <= 0) || ((uint32_t)InputSize > pxCtx->ChunkSize))
+  {
+    return SE_ERROR;
+  }
+
+  /* Decrypt into the free buffer: the other one may still be programmed */
+  e_ret_status = SE_IMG_Install_CallAppend(SE_CRYPTO_LL_DECRYPT_APPEND_ID, peSE_Status, pInputBuffer, InputSize,
+                                           pxCtx->pBuffer[pxCtx->Active], &output_size);
+
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_ECCDSA_WITH_AES128_CBC_SHA256)
+  if ((e_ret_status == SE_SUCCESS) && (output_size > 0))
+  {
+    int32_t auth_size = 0;
+
+    /* SHA256 does not produce any output: the buffer is left untouched */
+    e_ret_status = SE_IMG_Install_CallAppend(SE_CRYPTO_LL_AUTHENTICATE_FW_APPEND_ID, peSE_Status,
+                                             pxCtx->pBuffer[pxCtx->Active], output_size,
+                                             pxCtx->pBuffer[pxCtx->Active], &auth_size);
+  }
+#endif /* SECBOOT_CRYPTO_SCHEME */
+
+  if (e_ret_status == SE_SUCCESS)
+  {
+    e_ret_status = SE_IMG_Install_Program(pxCtx, (uint32_t)output_size);
+  }
+
+  return e_ret_status;
+}
+
+/**
+  * @brief Secure Engine streaming install Finish function.
+  *        Flushes the pipeline and finalizes decryption and authentication.
+  * @note  The installed firmware must not be considered as valid unless this function returns SE_SUCCESS.
+  * @param peSE_Status Secure Engine Status.
+  *        This parameter can be a value of @ref SE_Status_Structure_definition.
+  * @param pxCtx Streaming install context.
+  * @param pOutputBuffer pointer to the authentication output buffer (32 bytes), as returned by
+  *        @ref SE_AuthenticateFW_Finish. Not used with AES-GCM: the tag is verified inside the Secure Engine.
+  * @param pOutputSize pointer to the authentication output size (bytes).
+  * @retval SE_ErrorStatus SE_SUCCESS if successful, SE_ERROR otherwise.
+  */
+SE_ErrorStatus SE_IMG_Install_Finish(SE_StatusTypeDef *peSE_Status, SE_IMG_InstallCtxTypeDef *pxCtx,
+                                     uint8_t *pOutputBuffer, int32_t *pOutputSize)
+{
+  SE_ErrorStatus e_ret_status;
+  int32_t output_size = 0;
+
+  /* Check if the call is coming from SFU code*/
+  __IS_SFU_RESERVED();
+
+  /* Check the parameters */
+  if ((pxCtx == NULL) || (pOutputSize == NULL))
+  {
+    return SE_ERROR;
+  }
+  *pOutputSize = 0;
+
+  /* Remaining decrypted bytes (if any) are written into the free buffer */
+  e_ret_status = SE_IMG_Install_CallFinish(SE_CRYPTO_LL_DECRYPT_FINISH_ID, peSE_Status,
+                                           pxCtx->pBuffer[pxCtx->Active], &output_size);
+
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_ECCDSA_WITH_AES128_CBC_SHA256)
+  if ((e_ret_status == SE_SUCCESS) && (output_size > 0))
+  {
+    int32_t auth_size = 0;
+
+    e_ret_status = SE_IMG_Install_CallAppend(SE_CRYPTO_LL_AUTHENTICATE_FW_APPEND_ID, peSE_Status,
+                                             pxCtx->pBuffer[pxCtx->Active], output_size,
+                                             pxCtx->pBuffer[pxCtx->Active], &auth_size);
+  }
+#endif /* SECBOOT_CRYPTO_SCHEME */
+
+  /* Program the last chunk, then wait for both pending writes */
+  if (e_ret_status == SE_SUCCESS)
+  {
+    e_ret_status = SE_IMG_Install_Program(pxCtx, (uint32_t)output_size);
+  }
+  if (pxCtx->WritePending != 0U)
+  {
+    pxCtx->WritePending = 0U;
+    if (pxCtx->pFlashOps->WriteWait() != SE_SUCCESS)
+    {
+      e_ret_status = SE_ERROR;
+    }
+  }
+
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_ECCDSA_WITH_AES128_CBC_SHA256)
+  if (e_ret_status == SE_SUCCESS)
+  {
+    e_ret_status = SE_IMG_Install_CallFinish(SE_CRYPTO_LL_AUTHENTICATE_FW_FINISH_ID, peSE_Status, pOutputBuffer,
+                                             pOutputSize);
+  }
+#endif /* SECBOOT_CRYPTO_SCHEME */
+
+  return e_ret_status;
+}
+
 #endif /* SECBOOT_CRYPTO_SCHEME */
 
 /**
@@ -42,6 +42,58 @@ extern "C" {
   * @{
   */
 
+/** @defgroup SE_INTERFACE_BOOTLOADER_Exported_Constants Exported Constants
+  * @{
+  */
+
+/**
+  * @brief Default size (bytes) of each of the two buffers used by the streaming install pipeline.
+  *        Must be a multiple of the flash programming granularity and of the AES block size.
+  */
+#ifndef SE_IMG_INSTALL_CHUNK_SIZE
+#define SE_IMG_INSTALL_CHUNK_SIZE                 (1024U)
+#endif /* SE_IMG_INSTALL_CHUNK_SIZE */
+
+/**
+  * @}
+  */
+
+/** @defgroup SE_INTERFACE_BOOTLOADER_Exported_Types Exported Types
+  * @{
+  */
+
+/**
+  * @brief Flash programming primitives used by the streaming install pipeline.
+  *        WriteStart may return as soon as programming is started (interrupt or DMA driven);
+  *        WriteWait must block until the last started write is completed.
+  *        A blocking WriteStart with an empty WriteWait is valid: the pipeline is then sequential.
+  */
+typedef struct
+{
+  SE_ErrorStatus(*WriteStart)(void *pDestination, const void *pSource, uint32_t Length); /*!< Start a write     */
+  SE_ErrorStatus(*WriteWait)(void);                                                    /*!< Wait last write   */
+} SE_IMG_FlashOpsTypeDef;
+
+/**
+  * @brief Streaming install pipeline context.
+  *        It is allocated by the caller (no global variable in se_interface, see se_interface_bootloader.c).
+  *        While chunk N is decrypted (and authenticated) into one buffer, chunk N-1 is programmed from the other one.
+  */
+typedef struct
+{
+  const SE_IMG_FlashOpsTypeDef *pFlashOps; /*!< Flash programming primitives                      */
+  uint8_t  *pBuffer[2];                    /*!< Double buffer receiving the decrypted chunks        */
+  uint32_t ChunkSize;                      /*!< Size (bytes) of each buffer                         */
+  uint8_t  *pDestination;                  /*!< Flash address of the next chunk to be programmed    */
+  uint32_t Active;                         /*!< Index of the buffer receiving the next chunk        */
+  uint32_t WritePending;                   /*!< 1 when a flash write is in progress, 0 otherwise    */
+  uint32_t InstalledSize;                  /*!< Number of bytes handed over to the flash so far     */
+} SE_IMG_InstallCtxTypeDef;
+
+/**
+  * @}
+  */
+
 /** @addtogroup SE_INTERFACE_BOOTLOADER_Exported_Functions
   * @{
   */
@@ -74,6 +126,16 @@ SE_ErrorStatus SE_AuthenticateFW_Append(SE_StatusTypeDef *peSE_Status, const uin
                                         uint8_t *pOutputBuffer, int32_t *pOutputSize);
 SE_ErrorStatus SE_AuthenticateFW_Finish(SE_StatusTypeDef *peSE_Status, uint8_t *pOutputBuffer, int32_t *pOutputSize);
 
+/* Streaming install functions (decrypt and program in a double-buffered pipeline) */
+SE_ErrorStatus SE_IMG_Install_Init(SE_StatusTypeDef *peSE_Status, SE_IMG_InstallCtxTypeDef *pxCtx,
+                                   const SE_IMG_FlashOpsTypeDef *pxFlashOps, uint8_t *pBuffer0, uint8_t *pBuffer1,
+                                   uint32_t ChunkSize, void *pDestination, SE_FwRawHeaderTypeDef *pxSE_Metadata,
+                                   int32_t SE_FwType);
+SE_ErrorStatus SE_IMG_Install_Append(SE_StatusTypeDef *peSE_Status, SE_IMG_InstallCtxTypeDef *pxCtx,
+                                     const uint8_t *pInputBuffer, int32_t InputSize);
+SE_ErrorStatus SE_IMG_Install_Finish(SE_StatusTypeDef *peSE_Status, SE_IMG_InstallCtxTypeDef *pxCtx,
+                                     uint8_t *pOutputBuffer, int32_t *pOutputSize);
+
 /**
   * @}
   */
@@ -13,15 +13,24 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 #
-import keys
 import sys
 import argparse
 import os
 import hashlib
-import numpy
+import zlib
+import time
 #import string
-from elftools.elf.elffile import ELFFile
-from struct import pack
+from struct import pack, unpack
+# The delta and compress commands only need the standard library: they also
+# run where the crypto, numpy and elftools modules are not installed, e.g. for
+# the host tests of the update packages
+missing_module = None
+try:
+    import keys
+    import numpy
+    from elftools.elf.elffile import ELFFile
+except ImportError as e:
+    missing_module = e
 
 def gen_ecdsa_p256(args):
     keys.ECDSA256P1.generate().export_private(args.key)
@@ -484,6 +493,245 @@ def do_diff(args):
     with open(args.poffset, 'w') as f:
         f.write(str(first_diff*args.align))
 
+# Delta file format, must match DeltaPatch.h
+DELTA_MAGIC = 0x544C4544
+DELTA_HEADER_SIZE = 16
+# Shorter matches cost more as a COPY command than as literal bytes
+DELTA_MIN_MATCH = 8
+# Old image offsets kept per DELTA_MIN_MATCH bytes key
+DELTA_MAX_CANDIDATES = 8
+
+def delta_varint(value):
+    out = bytearray()
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+    return out
+
+def delta_encode(old, new):
+    index = {}
+    for pos in range(0, len(old) - DELTA_MIN_MATCH + 1):
+        candidates = index.setdefault(old[pos:pos + DELTA_MIN_MATCH], [])
+        if len(candidates) < DELTA_MAX_CANDIDATES:
+            candidates.append(pos)
+    out = bytearray(pack('<IIII', DELTA_MAGIC, len(old), len(new), zlib.crc32(new) & 0xFFFFFFFF))
+    ops = {'copy': 0, 'insert': 0}
+    literal = bytearray()
+    cursor = 0
+    pos = 0
+    while pos < len(new):
+        best_len = 0
+        best_off = 0
+        candidates = index.get(new[pos:pos + DELTA_MIN_MATCH], [])
+        # Continuing after the previous copy gives the shortest offset, try it first
+        if cursor not in candidates:
+            candidates = [cursor] + candidates
+        for off in candidates:
+            length = 0
+            while pos + length < len(new) and off + length < len(old) and old[off + length] == new[pos + length]:
+                length += 1
+            if length > best_len:
+                best_len = length
+                best_off = off
+        if best_len < DELTA_MIN_MATCH:
+            literal.append(new[pos])
+            pos += 1
+            continue
+        if len(literal) > 0:
+            out += delta_varint(len(literal) << 1) + literal
+            ops['insert'] += 1
+            literal = bytearray()
+        rel = best_off - cursor
+        out += delta_varint((best_len << 1) | 1) + delta_varint((rel << 1) if rel >= 0 else ((-rel << 1) - 1))
+        ops['copy'] += 1
+        cursor = best_off + best_len
+        pos += best_len
+    if len(literal) > 0:
+        out += delta_varint(len(literal) << 1) + literal
+        ops['insert'] += 1
+    return out, ops
+
+def delta_apply(old, delta):
+    magic, old_size, new_size, crc = unpack('<IIII', delta[0:DELTA_HEADER_SIZE])
+    if magic != DELTA_MAGIC or old_size > len(old):
+        raise ValueError("delta does not apply to this image")
+    new = bytearray()
+    pos = DELTA_HEADER_SIZE
+    cursor = 0
+    def varint():
+        nonlocal pos
+        value = 0
+        shift = 0
+        while True:
+            byte = delta[pos]
+            pos += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if byte < 0x80:
+                return value
+    while len(new) < new_size:
+        op = varint()
+        length = op >> 1
+        if op & 1:
+            rel = varint()
+            cursor += (rel >> 1) if (rel & 1) == 0 else -((rel >> 1) + 1)
+            new += old[cursor:cursor + length]
+            cursor += length
+        else:
+            new += delta[pos:pos + length]
+            pos += length
+    if len(new) != new_size or (zlib.crc32(new) & 0xFFFFFFFF) != crc:
+        raise ValueError("delta verification failed")
+    return new
+
+def do_delta(args):
+    with open(args.file1, 'rb') as f:
+        old = f.read()
+    with open(args.file2, 'rb') as f:
+        new = f.read()
+    delta, ops = delta_encode(old, new)
+    # Check the delta rebuilds the new image, as DeltaPatch does on target
+    start = time.perf_counter()
+    if delta_apply(old, delta) != new:
+        raise ValueError("delta verification failed")
+    apply_time = time.perf_counter() - start
+    with open(args.outfile, 'wb') as f:
+        f.write(delta)
+    print("old image   : {} bytes".format(len(old)))
+    print("new image   : {} bytes".format(len(new)))
+    print("delta       : {} bytes ({} copy, {} insert commands)".format(len(delta), ops['copy'], ops['insert']))
+    print("ratio       : {:.2f}% of the new image ({:.1f}:1)".format(100.0 * len(delta) / len(new), len(new) / len(delta)))
+    print("apply time  : {:.2f} ms (host)".format(apply_time * 1000))
+
+# Compressed file format, must match LzDecompress.h
+LZ_MAGIC = 0x53535A4C
+LZ_HEADER_SIZE = 16
+LZ_MIN_MATCH = 3
+LZ_MAX_WINDOW_BITS = 12
+# Match positions visited per hash chain, trades compression time for ratio
+LZ_MAX_CHAIN = 64
+# Longer matches are taken without trying a lazy match at the next position
+LZ_LAZY_LENGTH = 32
+
+def lz_encode(data, window_bits):
+    window = 1 << window_bits
+    head = {}
+    prev = [-1] * len(data)
+    out = bytearray(pack('<IIIB3x', LZ_MAGIC, len(data), zlib.crc32(data) & 0xFFFFFFFF, window_bits))
+    state = {'flags': 0, 'items': 8}
+    def insert(pos):
+        if pos + LZ_MIN_MATCH <= len(data):
+            key = data[pos:pos + LZ_MIN_MATCH]
+            prev[pos] = head.get(key, -1)
+            head[key] = pos
+    def find(pos):
+        best_len = 0
+        best_dist = 0
+        if pos + LZ_MIN_MATCH > len(data):
+            return 0, 0
+        cand = head.get(data[pos:pos + LZ_MIN_MATCH], -1)
+        chain = 0
+        while cand >= 0 and pos - cand <= window and chain < LZ_MAX_CHAIN:
+            length = 0
+            end = len(data) - pos
+            while length < end and data[cand + length] == data[pos + length]:
+                length += 1
+            if length > best_len:
+                best_len = length
+                best_dist = pos - cand
+            if length == end:
+                break
+            cand = prev[cand]
+            chain += 1
+        return best_len, best_dist
+    def item(is_match):
+        if state['items'] == 8:
+            state['flags'] = len(out)
+            state['items'] = 0
+            out.append(0)
+        if is_match:
+            out[state['flags']] |= 1 << state['items']
+        state['items'] += 1
+    pos = 0
+    while pos < len(data):
+        length, dist = find(pos)
+        insert(pos)
+        # Lazy matching: emit a literal when the next position matches longer
+        if length >= LZ_MIN_MATCH and length < LZ_LAZY_LENGTH and find(pos + 1)[0] > length + 1:
+            length = 0
+        if length >= LZ_MIN_MATCH:
+            item(True)
+            extra = length - LZ_MIN_MATCH
+            out.append((dist - 1) & 0xFF)
+            out.append((((dist - 1) >> 8) << 4) | min(extra, 15))
+            if extra >= 15:
+                extra -= 15
+                while extra >= 255:
+                    out.append(255)
+                    extra -= 255
+                out.append(extra)
+            for ite in range(pos + 1, pos + length):
+                insert(ite)
+            pos += length
+        else:
+            item(False)
+            out.append(data[pos])
+            pos += 1
+    return out
+
+def lz_decode(comp):
+    magic, size, crc, window_bits = unpack('<IIIB3x', comp[0:LZ_HEADER_SIZE])
+    if magic != LZ_MAGIC or window_bits > LZ_MAX_WINDOW_BITS:
+        raise ValueError("not a compressed file")
+    out = bytearray()
+    pos = LZ_HEADER_SIZE
+    while len(out) < size:
+        flags = comp[pos]
+        pos += 1
+        for ite in range(0, 8):
+            if len(out) >= size:
+                break
+            if (flags >> ite) & 1:
+                dist = (comp[pos] | ((comp[pos + 1] >> 4) << 8)) + 1
+                length = (comp[pos + 1] & 0x0F) + LZ_MIN_MATCH
+                pos += 2
+                if length == 15 + LZ_MIN_MATCH:
+                    while True:
+                        length += comp[pos]
+                        pos += 1
+                        if comp[pos - 1] != 255:
+                            break
+                for ite2 in range(0, length):
+                    out.append(out[-dist])
+            else:
+                out.append(comp[pos])
+                pos += 1
+    if (zlib.crc32(out) & 0xFFFFFFFF) != crc:
+        raise ValueError("compressed file verification failed")
+    return out
+
+def do_compress(args):
+    if args.window < 4 or args.window > LZ_MAX_WINDOW_BITS:
+        msg = "Wrong window value ({}), must be in range [4..{}]".format(args.window, LZ_MAX_WINDOW_BITS)
+        raise argparse.ArgumentTypeError(msg)
+    with open(args.infile, 'rb') as f:
+        data = f.read()
+    comp = lz_encode(data, args.window)
+    # Check the file decompresses back, as LzDecompress does on target
+    start = time.perf_counter()
+    if lz_decode(comp) != data:
+        raise ValueError("compressed file verification failed")
+    decode_time = time.perf_counter() - start
+    with open(args.outfile, 'wb') as f:
+        f.write(comp)
+    frags = int((len(data) + args.fragsize - 1) / args.fragsize)
+    comp_frags = int((len(comp) + args.fragsize - 1) / args.fragsize)
+    print("image       : {} bytes, {} fragments of {} bytes".format(len(data), frags, args.fragsize))
+    print("compressed  : {} bytes, {} fragments ({} bytes window)".format(len(comp), comp_frags, 1 << args.window))
+    print("ratio       : {:.2f}% of the image ({} fragments saved)".format(100.0 * len(comp) / len(data), frags - comp_frags))
+    print("decode time : {:.2f} ms (host)".format(decode_time * 1000))
+
 def do_inject(args):
     key = keys.load(args.key)
     np_key = numpy.frombuffer(key.get_key(args.type), numpy.uint8)
@@ -594,6 +842,17 @@ subcmds = {
         'pack':do_pack,
         #
         'diff':do_diff,
+        #delta file applied in-stream by DeltaPatch
+        #-1 old binary file
+        #-2 new binary file
+        #output file delta
+        'delta':do_delta,
+        #compressed file decompressed in-stream by LzDecompress
+        #-w log2 of the window size
+        #-s fragment size
+        #input file binary
+        #output file compressed
+        'compress':do_compress,
         #merge appli.elf , header binary and sbsfu elf in a big binary
         #input file appli.elf
         #-h header file
@@ -695,6 +954,17 @@ def args():
     diff.add_argument('-a', '--align', type=int, metavar='align', default=2, required=False, help="difference binary file alignment in bytes (default: 2)")
     diff.add_argument("outfile")
     
+    delta = subs.add_parser('delta', help='compute a delta file rebuilding a new binary from an old one')
+    delta.add_argument('-1', '--file1', type=str, metavar='filename', required=True, help="old (running) binary file")
+    delta.add_argument('-2', '--file2', type=str, metavar='filename', required=True, help="new binary file")
+    delta.add_argument("outfile")
+    
+    compress = subs.add_parser('compress', help='compress a binary file to be decompressed in-stream by LzDecompress')
+    compress.add_argument('-w', '--window', type=int, metavar='bits', default=10, required=False, help="log2 of the window size, must not exceed LZ_DECOMPRESS_WINDOW_BITS (default: 10)")
+    compress.add_argument('-s', '--fragsize', type=int, metavar='size', default=50, required=False, help="fragment size used to report the number of fragments (default: 50)")
+    compress.add_argument("infile")
+    compress.add_argument("outfile")
+    
     mrg = subs.add_parser('merge', help='merge elf appli , install header and sbsfu.elf in a contiguous binary')
     mrg.add_argument('-i', '--install', metavar='filename',  help="filename of installed binary header", required = True)
     mrg.add_argument('-s', '--sbsfu', metavar='filename', help="filename of sbsfu elf", required = True)
@@ -716,6 +986,9 @@ def args():
     if args.subcmd is None:
         print('Must specify a subcommand')
         sys.exit(1)
+    if missing_module is not None and args.subcmd not in ('delta', 'compress'):
+        print(missing_module)
+        sys.exit(1)
     subcmds[args.subcmd](args)
 
 if __name__ == '__main__':
@@ -647,7 +647,7 @@ TimerTime_t RtcTempCompensation(TimerTime_t period, float temperature)
   interim = ((float) period * ppm) / 1000000;
   // Calculate the resulting time period
   interim += period;
-  interim = floor(interim);
+  interim = MATH_FLOOR(interim);
 
   if (interim < 0.0f)
   {
@@ -25,13 +25,31 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ),
 
 #include "LoRaMacCrypto.h"
 #include "utilities.h"
+#if defined( SOFT_SE_USE_MBEDTLS )
+#include "mbedtls/aes.h"
+#else
 #include "aes.h"
 #include "cmac.h"
+#endif
 #include "radio.h"
 
-#define NUM_OF_KEYS      24
+/*!
+ * Unicast keys up to MC_ROOT_KEY, MC_KE_KEY, one key triplet per multicast
+ * group and SLOT_RAND_ZERO_KEY
+ */
+#define NUM_OF_KEYS      ( MC_ROOT_KEY + 3 + ( 3 * LORAMAC_MAX_MC_CTX ) )
 #define KEY_SIZE         16
 
+#if defined( SOFT_SE_USE_MBEDTLS )
+/*!
+ * Number of expanded AES key schedules kept in RAM by the mbedTLS backend.
+ * Frame processing uses up to four session keys (FNwkSIntKey, SNwkSIntKey, NwkSEncKey, AppSKey).
+ */
+#ifndef SOFT_SE_MBEDTLS_KEY_CTX_NB
+#define SOFT_SE_MBEDTLS_KEY_CTX_NB      4
+#endif
+#endif
+
 /*!
  * Identifier value pair type for Keys
  */
@@ -60,6 +78,7 @@ typedef struct sSecureElementNvCtx
      * Join EUI storage
      */
     uint8_t JoinEui[SE_EUI_SIZE];
+#if !defined( SOFT_SE_USE_MBEDTLS )
     /*
      * AES computation context variable
      */
@@ -68,6 +87,7 @@ typedef struct sSecureElementNvCtx
      * CMAC computation context variable
      */
     AES_CMAC_CTX AesCmacCtx[1];
+#endif
     /*
      * Key List
      */
@@ -81,6 +101,46 @@ static SecureElementNvCtx_t SeNvmCtx;
 
 static SecureElementNvmEvent SeNvmCtxChanged;
 
+#if defined( SOFT_SE_USE_MBEDTLS )
+/*!
+ * Persistent key context of the mbedTLS backend
+ *
+ * mbedtls_aes_context points to its own round keys, hence the contexts are
+ * kept out of the non volatile context which is saved and restored by copy.
+ */
+typedef struct sKeyCtx
+{
+    /*
+     * Key identifier of the expanded key, valid when InUse is true
+     */
+    KeyIdentifier_t KeyID;
+    /*
+     * Set when the context holds an expanded key
+     */
+    bool InUse;
+    /*
+     * Value of KeyCtxUseCounter at last use, for least recently used eviction
+     */
+    uint32_t LastUse;
+    /*
+     * Expanded encryption key
+     */
+    mbedtls_aes_context Aes;
+    /*
+     * CMAC subkeys derived from the key
+     */
+    uint8_t K1[16];
+    uint8_t K2[16];
+}KeyCtx_t;
+
+/*
+ * mbedTLS backend key contexts
+ */
+static KeyCtx_t KeyCtxs[SOFT_SE_MBEDTLS_KEY_CTX_NB];
+
+static uint32_t KeyCtxUseCounter;
+#endif
+
 /*
  * Local functions
  */
@@ -96,15 +156,28 @@ static SecureElementNvmEvent SeNvmCtxChanged;
  */
 SecureElementStatus_t GetKeyByID( KeyIdentifier_t keyID, Key_t** keyItem )
 {
-    for( uint8_t i = 0; i < NUM_OF_KEYS; i++ )
+    uint8_t index;
+
+    // The key list is laid out in identifier order, see SecureElementInit
+    if( keyID <= MC_ROOT_KEY )
     {
-        if( SeNvmCtx.KeyList[i].KeyID == keyID )
-        {
-            *keyItem = &( SeNvmCtx.KeyList[i] );
-            return SECURE_ELEMENT_SUCCESS;
-        }
+        index = keyID;
     }
-    return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+    else if( ( keyID >= MC_KE_KEY ) && ( keyID <= SLOT_RAND_ZERO_KEY ) )
+    {
+        index = MC_ROOT_KEY + 1 + ( keyID - MC_KE_KEY );
+    }
+    else
+    {
+        return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+    }
+
+    if( SeNvmCtx.KeyList[index].KeyID != keyID )
+    {
+        return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+    }
+    *keyItem = &( SeNvmCtx.KeyList[index] );
+    return SECURE_ELEMENT_SUCCESS;
 }
 
 /*
@@ -115,6 +188,211 @@ static void DummyCB( void )
     return;
 }
 
+#if defined( SOFT_SE_USE_MBEDTLS )
+/*
+ * Drops the expanded contexts of a key
+ *
+ * \param[IN]  keyID          - Key identifier
+ */
+static void KeyCtxInvalidate( KeyIdentifier_t keyID )
+{
+    for( uint8_t i = 0; i < SOFT_SE_MBEDTLS_KEY_CTX_NB; i++ )
+    {
+        if( ( KeyCtxs[i].InUse == true ) && ( KeyCtxs[i].KeyID == keyID ) )
+        {
+            mbedtls_aes_free( &KeyCtxs[i].Aes );
+            KeyCtxs[i].InUse = false;
+        }
+    }
+}
+
+/*
+ * Drops all the expanded key contexts
+ */
+static void KeyCtxInvalidateAll( void )
+{
+    for( uint8_t i = 0; i < SOFT_SE_MBEDTLS_KEY_CTX_NB; i++ )
+    {
+        if( KeyCtxs[i].InUse == true )
+        {
+            mbedtls_aes_free( &KeyCtxs[i].Aes );
+            KeyCtxs[i].InUse = false;
+        }
+    }
+}
+
+/*
+ * Doubles a CMAC subkey in GF(2^128)
+ */
+static void CmacDouble( const uint8_t* in, uint8_t* out )
+{
+    uint8_t msb = in[0] & 0x80;
+
+    for( uint8_t i = 0; i < 15; i++ )
+    {
+        out[i] = ( uint8_t )( ( in[i] << 1 ) | ( in[i + 1] >> 7 ) );
+    }
+    out[15] = ( uint8_t )( in[15] << 1 );
+    if( msb != 0 )
+    {
+        out[15] ^= 0x87;
+    }
+}
+
+/*
+ * Gets the expanded context of a key, expanding it on a miss
+ *
+ * The least recently used context is recycled when all of them are in use.
+ *
+ * \param[IN]  keyID          - Key identifier
+ * \param[OUT] keyCtx         - Key context reference
+ * \retval                    - Status of the operation
+ */
+static SecureElementStatus_t GetKeyCtx( KeyIdentifier_t keyID, KeyCtx_t** keyCtx )
+{
+    KeyCtx_t* victim = &KeyCtxs[0];
+
+    KeyCtxUseCounter++;
+    for( uint8_t i = 0; i < SOFT_SE_MBEDTLS_KEY_CTX_NB; i++ )
+    {
+        if( KeyCtxs[i].InUse == false )
+        {
+            if( victim->InUse == true )
+            {
+                victim = &KeyCtxs[i];
+            }
+            continue;
+        }
+        if( KeyCtxs[i].KeyID == keyID )
+        {
+            KeyCtxs[i].LastUse = KeyCtxUseCounter;
+            *keyCtx = &KeyCtxs[i];
+            return SECURE_ELEMENT_SUCCESS;
+        }
+        if( ( victim->InUse == true ) && ( KeyCtxs[i].LastUse < victim->LastUse ) )
+        {
+            victim = &KeyCtxs[i];
+        }
+    }
+
+    Key_t* keyItem;
+    SecureElementStatus_t retval = GetKeyByID( keyID, &keyItem );
+    if( retval != SECURE_ELEMENT_SUCCESS )
+    {
+        return retval;
+    }
+
+    if( victim->InUse == true )
+    {
+        mbedtls_aes_free( &victim->Aes );
+        victim->InUse = false;
+    }
+    mbedtls_aes_init( &victim->Aes );
+    if( mbedtls_aes_setkey_enc( &victim->Aes, keyItem->KeyValue, KEY_SIZE * 8 ) != 0 )
+    {
+        mbedtls_aes_free( &victim->Aes );
+        return SECURE_ELEMENT_ERROR;
+    }
+
+    // Generate the CMAC subkeys once per key
+    uint8_t l[16] = { 0 };
+    mbedtls_aes_crypt_ecb( &victim->Aes, MBEDTLS_AES_ENCRYPT, l, l );
+    CmacDouble( l, victim->K1 );
+    CmacDouble( victim->K1, victim->K2 );
+    memset1( l, 0, sizeof( l ) );
+
+    victim->KeyID = keyID;
+    victim->InUse = true;
+    victim->LastUse = KeyCtxUseCounter;
+    *keyCtx = victim;
+    return SECURE_ELEMENT_SUCCESS;
+}
+
+/*
+ * Computes a CMAC of a message using provided initial Bx block
+ *
+ *  cmac = aes128_cmac(keyID, blocks[i].Buffer)
+ *
+ * \param[IN]  micBxBuffer    - Buffer containing the initial Bx block
+ * \param[IN]  buffer         - Data buffer
+ * \param[IN]  size           - Data buffer size
+ * \param[IN]  keyID          - Key identifier to determine the AES key to be used
+ * \param[OUT] cmac           - Computed cmac
+ * \retval                    - Status of the operation
+ */
+static SecureElementStatus_t ComputeCmac( uint8_t *micBxBuffer, uint8_t *buffer, uint16_t size, KeyIdentifier_t keyID, uint32_t* cmac )
+{
+    if( ( buffer == NULL ) || ( cmac == NULL ) )
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+
+    KeyCtx_t* keyCtx;
+    SecureElementStatus_t retval = GetKeyCtx( keyID, &keyCtx );
+
+    if( retval == SECURE_ELEMENT_SUCCESS )
+    {
+        uint8_t x[16] = { 0 };
+        uint16_t i;
+
+        // The Bx block is always a complete block followed by the message
+        if( micBxBuffer != NULL )
+        {
+            for( i = 0; i < 16; i++ )
+            {
+                x[i] ^= micBxBuffer[i];
+            }
+            if( size != 0 )
+            {
+                mbedtls_aes_crypt_ecb( &keyCtx->Aes, MBEDTLS_AES_ENCRYPT, x, x );
+            }
+        }
+
+        // All message blocks but the last one
+        while( size > 16 )
+        {
+            for( i = 0; i < 16; i++ )
+            {
+                x[i] ^= buffer[i];
+            }
+            mbedtls_aes_crypt_ecb( &keyCtx->Aes, MBEDTLS_AES_ENCRYPT, x, x );
+            buffer += 16;
+            size -= 16;
+        }
+
+        // Last block, complete or padded
+        if( ( size == 16 ) || ( ( size == 0 ) && ( micBxBuffer != NULL ) ) )
+        {
+            for( i = 0; i < size; i++ )
+            {
+                x[i] ^= buffer[i];
+            }
+            for( i = 0; i < 16; i++ )
+            {
+                x[i] ^= keyCtx->K1[i];
+            }
+        }
+        else
+        {
+            for( i = 0; i < size; i++ )
+            {
+                x[i] ^= buffer[i];
+            }
+            x[size] ^= 0x80;
+            for( i = 0; i < 16; i++ )
+            {
+                x[i] ^= keyCtx->K2[i];
+            }
+        }
+        mbedtls_aes_crypt_ecb( &keyCtx->Aes, MBEDTLS_AES_ENCRYPT, x, x );
+
+        // Bring into the required format
+        *cmac = ( uint32_t )( ( uint32_t ) x[3] << 24 | ( uint32_t ) x[2] << 16 | ( uint32_t ) x[1] << 8 | ( uint32_t ) x[0] );
+    }
+
+    return retval;
+}
+#else
 /*
  * Computes a CMAC of a message using provided initial Bx block
  *
@@ -160,6 +438,7 @@ static SecureElementStatus_t ComputeCmac( uint8_t *micBxBuffer, uint8_t *buffer,
 
     return retval;
 }
+#endif
 
 /*
  * API functions
@@ -182,18 +461,12 @@ SecureElementStatus_t SecureElementInit( SecureElementNvmEvent seNvmCtxChanged )
     SeNvmCtx.KeyList[itr++].KeyID = APP_S_KEY;
     SeNvmCtx.KeyList[itr++].KeyID = MC_ROOT_KEY;
     SeNvmCtx.KeyList[itr++].KeyID = MC_KE_KEY;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_KEY_0;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_APP_S_KEY_0;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_NWK_S_KEY_0;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_KEY_1;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_APP_S_KEY_1;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_NWK_S_KEY_1;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_KEY_2;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_APP_S_KEY_2;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_NWK_S_KEY_2;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_KEY_3;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_APP_S_KEY_3;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_NWK_S_KEY_3;
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        SeNvmCtx.KeyList[itr++].KeyID = MC_KEY( i );
+        SeNvmCtx.KeyList[itr++].KeyID = MC_APP_S_KEY( i );
+        SeNvmCtx.KeyList[itr++].KeyID = MC_NWK_S_KEY( i );
+    }
     SeNvmCtx.KeyList[itr].KeyID = SLOT_RAND_ZERO_KEY;
 
     // Set standard keys
@@ -202,6 +475,10 @@ SecureElementStatus_t SecureElementInit( SecureElementNvmEvent seNvmCtxChanged )
     memset1( SeNvmCtx.DevEui, 0, SE_EUI_SIZE );
     memset1( SeNvmCtx.JoinEui, 0, SE_EUI_SIZE );
 
+#if defined( SOFT_SE_USE_MBEDTLS )
+    KeyCtxInvalidateAll( );
+#endif
+
     // Assign callback
     if( seNvmCtxChanged != 0 )
     {
@@ -221,6 +498,9 @@ SecureElementStatus_t SecureElementRestoreNvmCtx( void* seNvmCtx )
     if( seNvmCtx != 0 )
     {
         memcpy1( ( uint8_t* ) &SeNvmCtx, ( uint8_t* ) seNvmCtx, sizeof( SeNvmCtx ) );
+#if defined( SOFT_SE_USE_MBEDTLS )
+        KeyCtxInvalidateAll( );
+#endif
         return SECURE_ELEMENT_SUCCESS;
     }
     else
@@ -246,7 +526,10 @@ SecureElementStatus_t SecureElementSetKey( KeyIdentifier_t keyID, uint8_t* key )
     {
         if( SeNvmCtx.KeyList[i].KeyID == keyID )
         {
-            if( ( keyID == MC_KEY_0 ) || ( keyID == MC_KEY_1 ) || ( keyID == MC_KEY_2 ) || ( keyID == MC_KEY_3 ) )
+#if defined( SOFT_SE_USE_MBEDTLS )
+            KeyCtxInvalidate( keyID );
+#endif
+            if( ( keyID >= MC_KEY_0 ) && ( keyID < SLOT_RAND_ZERO_KEY ) && ( ( ( keyID - MC_KEY_0 ) % 3 ) == 0 ) )
             {  // Decrypt the key if its a Mckey
                 SecureElementStatus_t retval = SECURE_ELEMENT_ERROR;
                 uint8_t decryptedKey[16] = { 0 };
@@ -281,7 +564,7 @@ SecureElementStatus_t SecureElementComputeAesCmac( uint8_t *micBxBuffer, uint8_t
     return ComputeCmac( micBxBuffer, buffer, size, keyID, cmac );
 }
 
-SecureElementStatus_t SecureElementVerifyAesCmac( uint8_t* buffer, uint16_t size, uint32_t expectedCmac, KeyIdentifier_t keyID )
+SecureElementStatus_t SecureElementVerifyAesCmac( uint8_t* micBxBuffer, uint8_t* buffer, uint16_t size, uint32_t expectedCmac, KeyIdentifier_t keyID )
 {
     if( buffer == NULL )
     {
@@ -290,7 +573,7 @@ SecureElementStatus_t SecureElementVerifyAesCmac( uint8_t* buffer, uint16_t size
 
     SecureElementStatus_t retval = SECURE_ELEMENT_ERROR;
     uint32_t compCmac = 0;
-    retval = ComputeCmac( NULL, buffer, size, keyID, &compCmac );
+    retval = ComputeCmac( micBxBuffer, buffer, size, keyID, &compCmac );
     if( retval != SECURE_ELEMENT_SUCCESS )
     {
         return retval;
@@ -317,6 +600,22 @@ SecureElementStatus_t SecureElementAesEncrypt( uint8_t* buffer, uint16_t size, K
         return SECURE_ELEMENT_ERROR_BUF_SIZE;
     }
 
+#if defined( SOFT_SE_USE_MBEDTLS )
+    KeyCtx_t* keyCtx;
+    SecureElementStatus_t retval = GetKeyCtx( keyID, &keyCtx );
+
+    if( retval == SECURE_ELEMENT_SUCCESS )
+    {
+        uint16_t block = 0;
+
+        while( size != 0 )
+        {
+            mbedtls_aes_crypt_ecb( &keyCtx->Aes, MBEDTLS_AES_ENCRYPT, &buffer[block], &encBuffer[block] );
+            block = block + 16;
+            size = size - 16;
+        }
+    }
+#else
     memset1( SeNvmCtx.AesContext.ksch, '\0', 240 );
 
     Key_t* pItem;
@@ -335,6 +634,40 @@ SecureElementStatus_t SecureElementAesEncrypt( uint8_t* buffer, uint16_t size, K
             size = size - 16;
         }
     }
+#endif
+    return retval;
+}
+
+SecureElementStatus_t SecureElementAesCtrEncrypt( uint8_t* buffer, uint16_t size, uint8_t* ctrBlock, KeyIdentifier_t keyID )
+{
+    if( ( buffer == NULL ) || ( ctrBlock == NULL ) )
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+
+    uint8_t aBlock[16];
+    uint8_t sBlock[16];
+    SecureElementStatus_t retval = SECURE_ELEMENT_SUCCESS;
+
+    memcpy1( aBlock, ctrBlock, 16 );
+    while( size > 0 )
+    {
+        retval = SecureElementAesEncrypt( aBlock, 16, keyID, sBlock );
+        if( retval != SECURE_ELEMENT_SUCCESS )
+        {
+            break;
+        }
+
+        for( uint8_t i = 0; i < ( ( size > 16 ) ? 16 : size ); i++ )
+        {
+            buffer[i] = buffer[i] ^ sBlock[i];
+        }
+        aBlock[15]++;
+        buffer += ( size > 16 ) ? 16 : size;
+        size -= ( size > 16 ) ? 16 : size;
+    }
+    memset1( sBlock, 0, sizeof( sBlock ) );
+
     return retval;
 }
 
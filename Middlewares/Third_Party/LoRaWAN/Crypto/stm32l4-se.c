@@ -0,0 +1,904 @@
+/******************************************************************************
+  * @file    stm32l4-se.c
+  * @author  MCD Application Team
+  * @brief   Secure Element implementation on the AES peripheral of the STM32L4
+  *          devices which have one (STM32L4x2, L4x3, L4x5 and L4x6 with AES,
+  *          e.g. STM32L486, STM32L4A6): ECB, CTR payload encryption and CMAC
+  *          are processed by the hardware. To build instead of soft-se.c,
+  *          with HAL_CRYP_MODULE_ENABLED in the HAL configuration and the
+  *          SRAM2 sections of stm32l4-se.ld in the linker script.
+  *          The root keys are not part of the NVM context, which holds their
+  *          check values: they are provisioned at each start.
+  *          SE_BENCH_ENABLED of the End_Node application compares its DWT
+  *          cycles with those of soft-se.c.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "stm32l4xx_hal.h"
+#include "secure-element.h"
+#include "LoRaMacCrypto.h"
+#include "utilities.h"
+#include "radio.h"
+
+#if !defined( AES )
+#error "This STM32L4 device has no AES peripheral, build soft-se.c instead"
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+/*!
+ * Identifier value pair type for Keys
+ */
+typedef struct sKey
+{
+    /*
+     * Key identifier
+     */
+    KeyIdentifier_t KeyID;
+    /*
+     * Key value
+     */
+    uint8_t KeyValue[16];
+} Key_t;
+
+/*
+ * Secure Element Non Volatile Context structure, same layout as the soft-se
+ * one without its software AES contexts
+ */
+typedef struct sSecureElementNvCtx
+{
+    /*
+     * DevEUI storage
+     */
+    uint8_t DevEui[SE_EUI_SIZE];
+    /*
+     * Join EUI storage
+     */
+    uint8_t JoinEui[SE_EUI_SIZE];
+    /*
+     * Key List
+     */
+    Key_t KeyList[( MC_ROOT_KEY + 3 + ( 3 * LORAMAC_MAX_MC_CTX ) )];
+}SecureElementNvCtx_t;
+
+/* Private define ------------------------------------------------------------*/
+/*!
+ * Unicast keys up to MC_ROOT_KEY, MC_KE_KEY, one key triplet per multicast
+ * group and SLOT_RAND_ZERO_KEY
+ */
+#define NUM_OF_KEYS      ( MC_ROOT_KEY + 3 + ( 3 * LORAMAC_MAX_MC_CTX ) )
+#define KEY_SIZE         16
+
+/*!
+ * Processing timeout of the AES peripheral, ms. A block takes about 50
+ * AES clock cycles.
+ */
+#define L4_SE_AES_TIMEOUT                           10
+
+/*!
+ * Root keys, provisioned in the device: APP_KEY, GEN_APP_KEY and NWK_KEY
+ */
+#define NUM_OF_ROOT_KEYS ( NWK_KEY + 1 )
+
+/*!
+ * Size of the key check value exported in the key list in place of a root
+ * key: the first bytes of a zero block encrypted with the key
+ */
+#define L4_SE_KCV_SIZE                              3
+
+/*!
+ * Linker section of the key slots and CMAC subkeys, mapped to SRAM2 by
+ * stm32l4-se.ld: SRAM2 is erased by the hardware on a readout protection
+ * regression, can be erased on a tamper event (SYSCFG_SCSR SRAM2ER) and is
+ * parity checked.
+ */
+#ifndef L4_SE_KEY_SECTION
+#define L4_SE_KEY_SECTION                           ".sram2"
+#endif
+
+/*!
+ * Linker section of the root keys, SRAM2 pages of their own mapped by
+ * stm32l4-se.ld. The pages are write protected (SYSCFG_SWPR) at the first
+ * use of a root key, until the next system reset.
+ */
+#ifndef L4_SE_ROOT_KEY_SECTION
+#define L4_SE_ROOT_KEY_SECTION                      ".sram2_wp"
+#endif
+
+/*!
+ * SRAM2 write protection granularity, the pages of SYSCFG_SWPR
+ */
+#define L4_SE_SRAM2_PAGE_SIZE                       1024
+#define L4_SE_SRAM2_PAGES                           32
+
+#define L4_SE_KEY_STORE                             __attribute__( ( section( L4_SE_KEY_SECTION ) ) )
+#define L4_SE_ROOT_KEY_STORE                        __attribute__( ( section( L4_SE_ROOT_KEY_SECTION ) ) )
+
+/* Private variables ---------------------------------------------------------*/
+/*
+ * Module context
+ */
+static SecureElementNvCtx_t SeNvmCtx L4_SE_KEY_STORE;
+
+/*
+ * Root key values loaded in the AES peripheral, write protected once in use.
+ * Their only copy: the key list exported for the NVM keeps their check value.
+ */
+static uint8_t SeRootKeys[NUM_OF_ROOT_KEYS][KEY_SIZE] L4_SE_ROOT_KEY_STORE;
+
+/*
+ * CMAC subkeys of the key loaded in the AES peripheral
+ */
+static uint8_t CmacK1[16] L4_SE_KEY_STORE;
+static uint8_t CmacK2[16] L4_SE_KEY_STORE;
+
+static SecureElementNvmEvent SeNvmCtxChanged;
+
+static CRYP_HandleTypeDef CrypHandle;
+
+/*
+ * Key and chaining mode loaded in the AES peripheral, kept across the calls
+ * so that the frames processed with the same session key in ECB do not
+ * reload it
+ */
+static bool AesLoaded = false;
+
+static KeyIdentifier_t AesKeyID;
+
+static uint32_t AesChainingMode;
+
+static bool CmacSubkeysValid = false;
+
+/* Private function prototypes -----------------------------------------------*/
+static SecureElementStatus_t GetKeyByID( KeyIdentifier_t keyID, Key_t** keyItem );
+static SecureElementStatus_t SetRootKey( KeyIdentifier_t keyID, uint8_t* key );
+static bool RootKeyIsSet( KeyIdentifier_t keyID );
+static SecureElementStatus_t RootKeyKcv( KeyIdentifier_t keyID, uint8_t* kcv );
+static uint32_t RootKeysPages( void );
+static bool RootKeysLocked( void );
+static SecureElementStatus_t RootKeysLock( void );
+static void DummyCB( void );
+static SecureElementStatus_t AesLoad( KeyIdentifier_t keyID, uint32_t chainingMode, uint8_t* initVect );
+static void AesUnload( void );
+static SecureElementStatus_t AesProcess( uint8_t* input, uint16_t size, uint8_t* output );
+static void CmacDouble( const uint8_t* in, uint8_t* out );
+static SecureElementStatus_t ComputeCmac( uint8_t *micBxBuffer, uint8_t *buffer, uint16_t size, KeyIdentifier_t keyID, uint32_t* cmac );
+
+/* Exported functions ------------------------------------------------------- */
+SecureElementStatus_t SecureElementInit( SecureElementNvmEvent seNvmCtxChanged )
+{
+    uint8_t itr = 0;
+    uint8_t zeroKey[16] = { 0 };
+
+    __HAL_RCC_AES_CLK_ENABLE( );
+    AesUnload( );
+
+    memset1( ( uint8_t* )&SeNvmCtx, 0, sizeof( SeNvmCtx ) );
+    if( RootKeysLocked( ) == false )
+    {
+        memset1( ( uint8_t* )SeRootKeys, 0, sizeof( SeRootKeys ) );
+    }
+
+    // Initialize with defaults
+    SeNvmCtx.KeyList[itr++].KeyID = APP_KEY;
+    SeNvmCtx.KeyList[itr++].KeyID = GEN_APP_KEY;
+    SeNvmCtx.KeyList[itr++].KeyID = NWK_KEY;
+    SeNvmCtx.KeyList[itr++].KeyID = J_S_INT_KEY;
+    SeNvmCtx.KeyList[itr++].KeyID = J_S_ENC_KEY;
+    SeNvmCtx.KeyList[itr++].KeyID = F_NWK_S_INT_KEY;
+    SeNvmCtx.KeyList[itr++].KeyID = S_NWK_S_INT_KEY;
+    SeNvmCtx.KeyList[itr++].KeyID = NWK_S_ENC_KEY;
+    SeNvmCtx.KeyList[itr++].KeyID = APP_S_KEY;
+    SeNvmCtx.KeyList[itr++].KeyID = MC_ROOT_KEY;
+    SeNvmCtx.KeyList[itr++].KeyID = MC_KE_KEY;
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        SeNvmCtx.KeyList[itr++].KeyID = MC_KEY( i );
+        SeNvmCtx.KeyList[itr++].KeyID = MC_APP_S_KEY( i );
+        SeNvmCtx.KeyList[itr++].KeyID = MC_NWK_S_KEY( i );
+    }
+    SeNvmCtx.KeyList[itr].KeyID = SLOT_RAND_ZERO_KEY;
+
+    // Set standard keys
+    memcpy1( SeNvmCtx.KeyList[itr].KeyValue, zeroKey, KEY_SIZE );
+
+    // Root keys kept since the protection, until the next system reset
+    for( uint8_t i = 0; i < NUM_OF_ROOT_KEYS; i++ )
+    {
+        if( RootKeyIsSet( ( KeyIdentifier_t )i ) == true )
+        {
+            RootKeyKcv( ( KeyIdentifier_t )i, SeNvmCtx.KeyList[i].KeyValue );
+        }
+    }
+
+    // Assign callback
+    if( seNvmCtxChanged != 0 )
+    {
+        SeNvmCtxChanged = seNvmCtxChanged;
+    }
+    else
+    {
+        SeNvmCtxChanged = DummyCB;
+    }
+
+    return SECURE_ELEMENT_SUCCESS;
+}
+
+SecureElementStatus_t SecureElementRestoreNvmCtx( void* seNvmCtx )
+{
+    // Restore nvm context
+    if( seNvmCtx != 0 )
+    {
+        SecureElementStatus_t retval = SECURE_ELEMENT_SUCCESS;
+
+        memcpy1( ( uint8_t* ) &SeNvmCtx, ( uint8_t* ) seNvmCtx, sizeof( SeNvmCtx ) );
+        AesUnload( );
+
+        // The context holds the check values of the root keys, never the keys:
+        // those provisioned must match, the others are provisioned afterwards
+        // with SecureElementSetKey
+        for( uint8_t i = 0; i < NUM_OF_ROOT_KEYS; i++ )
+        {
+            uint8_t* kcv = SeNvmCtx.KeyList[i].KeyValue;
+            uint8_t diff = 0;
+
+            memset1( kcv + L4_SE_KCV_SIZE, 0, KEY_SIZE - L4_SE_KCV_SIZE );
+            if( RootKeyIsSet( ( KeyIdentifier_t )i ) == true )
+            {
+                uint8_t keyKcv[KEY_SIZE] = { 0 };
+
+                if( RootKeyKcv( ( KeyIdentifier_t )i, keyKcv ) != SECURE_ELEMENT_SUCCESS )
+                {
+                    return SECURE_ELEMENT_ERROR;
+                }
+                for( uint8_t j = 0; j < L4_SE_KCV_SIZE; j++ )
+                {
+                    diff |= kcv[j] ^ keyKcv[j];
+                }
+                if( diff != 0 )
+                {
+                    // Context of another root key
+                    memcpy1( kcv, keyKcv, KEY_SIZE );
+                    retval = SECURE_ELEMENT_ERROR;
+                }
+            }
+        }
+        return retval;
+    }
+    else
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+}
+
+void* SecureElementGetNvmCtx( size_t* seNvmCtxSize )
+{
+    *seNvmCtxSize = sizeof( SeNvmCtx );
+    return &SeNvmCtx;
+}
+
+SecureElementStatus_t SecureElementSetKey( KeyIdentifier_t keyID, uint8_t* key )
+{
+    if( key == NULL )
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+
+    for( uint8_t i = 0; i < NUM_OF_KEYS; i++ )
+    {
+        if( SeNvmCtx.KeyList[i].KeyID == keyID )
+        {
+            if( ( AesLoaded == true ) && ( AesKeyID == keyID ) )
+            {
+                AesUnload( );
+            }
+            if( keyID < NUM_OF_ROOT_KEYS )
+            {
+                return SetRootKey( keyID, key );
+            }
+            else if( ( keyID >= MC_KEY_0 ) && ( keyID < SLOT_RAND_ZERO_KEY ) && ( ( ( keyID - MC_KEY_0 ) % 3 ) == 0 ) )
+            {  // Decrypt the key if its a Mckey
+                SecureElementStatus_t retval = SECURE_ELEMENT_ERROR;
+                uint8_t decryptedKey[16] = { 0 };
+
+                retval = SecureElementAesEncrypt( key, 16, MC_KE_KEY, decryptedKey );
+
+                memcpy1( SeNvmCtx.KeyList[i].KeyValue, decryptedKey, KEY_SIZE );
+                memset1( decryptedKey, 0, sizeof( decryptedKey ) );
+                SeNvmCtxChanged( );
+
+                return retval;
+            }
+            else
+            {
+                memcpy1( SeNvmCtx.KeyList[i].KeyValue, key, KEY_SIZE );
+                SeNvmCtxChanged( );
+                return SECURE_ELEMENT_SUCCESS;
+            }
+        }
+    }
+
+    return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+}
+
+SecureElementStatus_t SecureElementComputeAesCmac( uint8_t *micBxBuffer, uint8_t *buffer, uint16_t size, KeyIdentifier_t keyID, uint32_t* cmac )
+{
+    if( keyID >= LORAMAC_CRYPTO_MULTICAST_KEYS )
+    {
+        //Never accept multicast key identifier for cmac computation
+        return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+    }
+
+    return ComputeCmac( micBxBuffer, buffer, size, keyID, cmac );
+}
+
+SecureElementStatus_t SecureElementVerifyAesCmac( uint8_t* micBxBuffer, uint8_t* buffer, uint16_t size, uint32_t expectedCmac, KeyIdentifier_t keyID )
+{
+    if( buffer == NULL )
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+
+    SecureElementStatus_t retval = SECURE_ELEMENT_ERROR;
+    uint32_t compCmac = 0;
+    retval = ComputeCmac( micBxBuffer, buffer, size, keyID, &compCmac );
+    if( retval != SECURE_ELEMENT_SUCCESS )
+    {
+        return retval;
+    }
+
+    if( expectedCmac != compCmac )
+    {
+        retval = SECURE_ELEMENT_FAIL_CMAC;
+    }
+
+    return retval;
+}
+
+SecureElementStatus_t SecureElementAesEncrypt( uint8_t* buffer, uint16_t size, KeyIdentifier_t keyID, uint8_t* encBuffer )
+{
+    if( buffer == NULL || encBuffer == NULL )
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+
+    // Check if the size is divisible by 16,
+    if( ( size % 16 ) != 0 )
+    {
+        return SECURE_ELEMENT_ERROR_BUF_SIZE;
+    }
+    if( size == 0 )
+    {
+        return SECURE_ELEMENT_SUCCESS;
+    }
+
+    SecureElementStatus_t retval = AesLoad( keyID, CRYP_CHAINMODE_AES_ECB, NULL );
+
+    if( retval == SECURE_ELEMENT_SUCCESS )
+    {
+        retval = AesProcess( buffer, size, encBuffer );
+    }
+    return retval;
+}
+
+SecureElementStatus_t SecureElementAesCtrEncrypt( uint8_t* buffer, uint16_t size, uint8_t* ctrBlock, KeyIdentifier_t keyID )
+{
+    if( ( buffer == NULL ) || ( ctrBlock == NULL ) )
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+    if( size == 0 )
+    {
+        return SECURE_ELEMENT_SUCCESS;
+    }
+
+    // The peripheral increments the last 32 bits word of the counter block,
+    // the same as the last byte for the up to 16 blocks of a LoRaWAN payload
+    SecureElementStatus_t retval = AesLoad( keyID, CRYP_CHAINMODE_AES_CTR, ctrBlock );
+    uint16_t blocksSize = size & ~0x0F;
+    uint8_t lastBlock[16];
+
+    if( ( retval == SECURE_ELEMENT_SUCCESS ) && ( blocksSize != 0 ) )
+    {
+        retval = AesProcess( buffer, blocksSize, buffer );
+    }
+    if( ( retval == SECURE_ELEMENT_SUCCESS ) && ( blocksSize != size ) )
+    {
+        // Partial last block, padded
+        memset1( lastBlock, 0, sizeof( lastBlock ) );
+        memcpy1( lastBlock, &buffer[blocksSize], size - blocksSize );
+        retval = AesProcess( lastBlock, 16, lastBlock );
+        memcpy1( &buffer[blocksSize], lastBlock, size - blocksSize );
+        memset1( lastBlock, 0, sizeof( lastBlock ) );
+    }
+    return retval;
+}
+
+SecureElementStatus_t SecureElementDeriveAndStoreKey( Version_t version, uint8_t* input, KeyIdentifier_t rootKeyID, KeyIdentifier_t targetKeyID )
+{
+    if( input == NULL )
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+
+    SecureElementStatus_t retval = SECURE_ELEMENT_ERROR;
+    uint8_t key[16] = { 0 };
+
+    // In case of MC_KE_KEY, prevent other keys than NwkKey or AppKey for LoRaWAN 1.1 or later
+    if( targetKeyID == MC_KE_KEY )
+    {
+        if( ( ( rootKeyID == APP_KEY ) && ( version.Fields.Minor == 0 ) ) || ( rootKeyID == NWK_KEY ) )
+        {
+            return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+        }
+    }
+
+    // Derive key
+    retval = SecureElementAesEncrypt( input, 16, rootKeyID, key );
+    if( retval == SECURE_ELEMENT_SUCCESS )
+    {
+        // Store key
+        retval = SecureElementSetKey( targetKeyID, key );
+    }
+    memset1( key, 0, sizeof( key ) );
+
+    return retval;
+}
+
+SecureElementStatus_t SecureElementRandomNumber( uint32_t* randomNum )
+{
+    if( randomNum == NULL )
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+    *randomNum = Radio.Random( );
+    return SECURE_ELEMENT_SUCCESS;
+}
+
+SecureElementStatus_t SecureElementSetDevEui( uint8_t* devEui )
+{
+    if( devEui == NULL )
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+    memcpy1( SeNvmCtx.DevEui, devEui, SE_EUI_SIZE );
+    SeNvmCtxChanged( );
+    return SECURE_ELEMENT_SUCCESS;
+}
+
+uint8_t* SecureElementGetDevEui( void )
+{
+    return SeNvmCtx.DevEui;
+}
+
+SecureElementStatus_t SecureElementSetJoinEui( uint8_t* joinEui )
+{
+    if( joinEui == NULL )
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+    memcpy1( SeNvmCtx.JoinEui, joinEui, SE_EUI_SIZE );
+    SeNvmCtxChanged( );
+    return SECURE_ELEMENT_SUCCESS;
+}
+
+uint8_t* SecureElementGetJoinEui( void )
+{
+    return SeNvmCtx.JoinEui;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ * Gets key item from key list.
+ *
+ * \param[IN]  keyID          - Key identifier
+ * \param[OUT] keyItem        - Key item reference
+ * \retval                    - Status of the operation
+ */
+static SecureElementStatus_t GetKeyByID( KeyIdentifier_t keyID, Key_t** keyItem )
+{
+    uint8_t index;
+
+    // The key list is laid out in identifier order, see SecureElementInit
+    if( keyID <= MC_ROOT_KEY )
+    {
+        index = keyID;
+    }
+    else if( ( keyID >= MC_KE_KEY ) && ( keyID <= SLOT_RAND_ZERO_KEY ) )
+    {
+        index = MC_ROOT_KEY + 1 + ( keyID - MC_KE_KEY );
+    }
+    else
+    {
+        return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+    }
+
+    if( SeNvmCtx.KeyList[index].KeyID != keyID )
+    {
+        return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+    }
+    *keyItem = &( SeNvmCtx.KeyList[index] );
+    return SECURE_ELEMENT_SUCCESS;
+}
+
+/*
+ * Stores a root key and exports its check value in the key list, unless the
+ * root keys are write protected: the same key is then accepted, any other
+ * one rejected until the next system reset
+ *
+ * \param[IN]  keyID          - Root key identifier
+ * \param[IN]  key            - Key value
+ * \retval                    - Status of the operation
+ */
+static SecureElementStatus_t SetRootKey( KeyIdentifier_t keyID, uint8_t* key )
+{
+    if( RootKeysLocked( ) == true )
+    {
+        uint8_t diff = 0;
+
+        for( uint8_t i = 0; i < KEY_SIZE; i++ )
+        {
+            diff |= SeRootKeys[keyID][i] ^ key[i];
+        }
+        return ( diff == 0 ) ? SECURE_ELEMENT_SUCCESS : SECURE_ELEMENT_ERROR;
+    }
+    memcpy1( SeRootKeys[keyID], key, KEY_SIZE );
+
+    uint8_t kcv[KEY_SIZE] = { 0 };
+    uint8_t diff = 0;
+
+    if( RootKeyKcv( keyID, kcv ) != SECURE_ELEMENT_SUCCESS )
+    {
+        return SECURE_ELEMENT_ERROR;
+    }
+    for( uint8_t i = 0; i < KEY_SIZE; i++ )
+    {
+        diff |= SeNvmCtx.KeyList[keyID].KeyValue[i] ^ kcv[i];
+    }
+    if( diff != 0 )
+    {
+        memcpy1( SeNvmCtx.KeyList[keyID].KeyValue, kcv, KEY_SIZE );
+        SeNvmCtxChanged( );
+    }
+    return SECURE_ELEMENT_SUCCESS;
+}
+
+/*
+ * Tells whether a root key has been provisioned
+ */
+static bool RootKeyIsSet( KeyIdentifier_t keyID )
+{
+    uint8_t set = 0;
+
+    for( uint8_t i = 0; i < KEY_SIZE; i++ )
+    {
+        set |= SeRootKeys[keyID][i];
+    }
+    return set != 0;
+}
+
+/*
+ * Computes the check value of a root key, exported in its key list slot. The
+ * key is loaded in the AES peripheral without ending the provisioning.
+ *
+ * \param[IN]  keyID          - Root key identifier
+ * \param[OUT] kcv            - Key check value, L4_SE_KCV_SIZE bytes followed
+ *                              by zeros up to KEY_SIZE
+ * \retval                    - Status of the operation
+ */
+static SecureElementStatus_t RootKeyKcv( KeyIdentifier_t keyID, uint8_t* kcv )
+{
+    uint8_t block[16] = { 0 };
+    SecureElementStatus_t retval = SECURE_ELEMENT_ERROR;
+
+    AesUnload( );
+    CrypHandle.Instance = AES;
+    CrypHandle.Init.DataType = CRYP_DATATYPE_8B;
+    CrypHandle.Init.KeySize = CRYP_KEYSIZE_128B;
+    CrypHandle.Init.OperatingMode = CRYP_ALGOMODE_ENCRYPT;
+    CrypHandle.Init.ChainingMode = CRYP_CHAINMODE_AES_ECB;
+    CrypHandle.Init.KeyWriteFlag = CRYP_KEY_WRITE_ENABLE;
+    CrypHandle.Init.pKey = SeRootKeys[keyID];
+    CrypHandle.Init.pInitVect = NULL;
+    if( ( HAL_CRYP_Init( &CrypHandle ) == HAL_OK ) &&
+        ( HAL_CRYPEx_AES( &CrypHandle, block, 16, block, L4_SE_AES_TIMEOUT ) == HAL_OK ) )
+    {
+        memset1( kcv, 0, KEY_SIZE );
+        memcpy1( kcv, block, L4_SE_KCV_SIZE );
+        retval = SECURE_ELEMENT_SUCCESS;
+    }
+    CrypHandle.Init.pKey = NULL;
+    memset1( block, 0, sizeof( block ) );
+    AesUnload( );
+    return retval;
+}
+
+/*
+ * Gets the SRAM2 pages of the root keys
+ *
+ * \retval                    - SYSCFG_SWPR mask of the pages, 0 if the root
+ *                              keys are not in the first 32 pages of SRAM2
+ */
+static uint32_t RootKeysPages( void )
+{
+    uint32_t start = ( uint32_t )( uintptr_t )SeRootKeys;
+    uint32_t end = start + sizeof( SeRootKeys ) - 1;
+    uint32_t first;
+    uint32_t last;
+
+    if( ( start < SRAM2_BASE ) || ( ( end - SRAM2_BASE ) >= ( L4_SE_SRAM2_PAGES * L4_SE_SRAM2_PAGE_SIZE ) ) )
+    {
+        return 0;
+    }
+    first = ( start - SRAM2_BASE ) / L4_SE_SRAM2_PAGE_SIZE;
+    last = ( end - SRAM2_BASE ) / L4_SE_SRAM2_PAGE_SIZE;
+    return ( uint32_t )( ( ( 2ULL << last ) - 1 ) & ~( ( 1UL << first ) - 1 ) );
+}
+
+/*
+ * Tells whether the root keys are write protected
+ */
+static bool RootKeysLocked( void )
+{
+    uint32_t pages = RootKeysPages( );
+
+    return ( pages != 0 ) && ( ( SYSCFG->SWPR & pages ) == pages );
+}
+
+/*
+ * Write protects the SRAM2 pages of the root keys until the next system
+ * reset, a write to them then raising a fault
+ *
+ * \retval                    - Status of the operation, an error if the root
+ *                              keys are not in SRAM2 (linker script without
+ *                              stm32l4-se.ld)
+ */
+static SecureElementStatus_t RootKeysLock( void )
+{
+    uint32_t pages = RootKeysPages( );
+
+    if( pages == 0 )
+    {
+        return SECURE_ELEMENT_ERROR;
+    }
+    __HAL_RCC_SYSCFG_CLK_ENABLE( );
+    __HAL_SYSCFG_SRAM2_WRP_1_31_ENABLE( pages );
+    return SECURE_ELEMENT_SUCCESS;
+}
+
+/*
+ * Dummy callback in case if the user provides NULL function pointer
+ */
+static void DummyCB( void )
+{
+    return;
+}
+
+/*
+ * Configures the AES peripheral for an encryption with a key, unless it is
+ * already configured so in ECB
+ *
+ * \param[IN]  keyID          - Key identifier
+ * \param[IN]  chainingMode   - CRYP_CHAINMODE_AES_ECB or CRYP_CHAINMODE_AES_CTR
+ * \param[IN]  initVect       - First counter block in CTR, NULL in ECB
+ * \retval                    - Status of the operation
+ */
+static SecureElementStatus_t AesLoad( KeyIdentifier_t keyID, uint32_t chainingMode, uint8_t* initVect )
+{
+    Key_t* keyItem;
+
+    if( ( AesLoaded == true ) && ( AesKeyID == keyID ) && ( chainingMode == CRYP_CHAINMODE_AES_ECB ) &&
+        ( AesChainingMode == CRYP_CHAINMODE_AES_ECB ) )
+    {
+        return SECURE_ELEMENT_SUCCESS;
+    }
+
+    SecureElementStatus_t retval = GetKeyByID( keyID, &keyItem );
+    if( retval != SECURE_ELEMENT_SUCCESS )
+    {
+        return retval;
+    }
+
+    // Provisioning ends with the first use of a root key
+    if( ( keyID < NUM_OF_ROOT_KEYS ) && ( RootKeysLocked( ) == false ) )
+    {
+        retval = RootKeysLock( );
+        if( retval != SECURE_ELEMENT_SUCCESS )
+        {
+            return retval;
+        }
+    }
+
+    if( ( AesLoaded == false ) || ( AesKeyID != keyID ) )
+    {
+        CmacSubkeysValid = false;
+    }
+    AesLoaded = false;
+
+    CrypHandle.Instance = AES;
+    CrypHandle.Init.DataType = CRYP_DATATYPE_8B;
+    CrypHandle.Init.KeySize = CRYP_KEYSIZE_128B;
+    CrypHandle.Init.OperatingMode = CRYP_ALGOMODE_ENCRYPT;
+    CrypHandle.Init.ChainingMode = chainingMode;
+    CrypHandle.Init.KeyWriteFlag = CRYP_KEY_WRITE_ENABLE;
+    CrypHandle.Init.pKey = ( keyID < NUM_OF_ROOT_KEYS ) ? SeRootKeys[keyID] : keyItem->KeyValue;
+    CrypHandle.Init.pInitVect = initVect;
+    if( HAL_CRYP_Init( &CrypHandle ) != HAL_OK )
+    {
+        return SECURE_ELEMENT_ERROR;
+    }
+    CrypHandle.Init.pKey = NULL;
+
+    AesKeyID = keyID;
+    AesChainingMode = chainingMode;
+    AesLoaded = true;
+    return SECURE_ELEMENT_SUCCESS;
+}
+
+/*
+ * Clears the key loaded in the AES peripheral and its CMAC subkeys
+ */
+static void AesUnload( void )
+{
+    if( CrypHandle.State != HAL_CRYP_STATE_RESET )
+    {
+        // Disables the peripheral, then resetting it clears the key registers
+        HAL_CRYP_DeInit( &CrypHandle );
+    }
+    __HAL_RCC_AES_FORCE_RESET( );
+    __HAL_RCC_AES_RELEASE_RESET( );
+
+    memset1( CmacK1, 0, sizeof( CmacK1 ) );
+    memset1( CmacK2, 0, sizeof( CmacK2 ) );
+    CmacSubkeysValid = false;
+    AesLoaded = false;
+}
+
+/*
+ * Processes blocks with the loaded key and chaining mode
+ *
+ * \param[IN]  input          - Input blocks
+ * \param[IN]  size           - Size, multiple of 16
+ * \param[OUT] output         - Output blocks, can be the input ones
+ * \retval                    - Status of the operation
+ */
+static SecureElementStatus_t AesProcess( uint8_t* input, uint16_t size, uint8_t* output )
+{
+    if( HAL_CRYPEx_AES( &CrypHandle, input, size, output, L4_SE_AES_TIMEOUT ) != HAL_OK )
+    {
+        AesUnload( );
+        return SECURE_ELEMENT_ERROR;
+    }
+    return SECURE_ELEMENT_SUCCESS;
+}
+
+/*
+ * Doubles a CMAC subkey in GF(2^128)
+ */
+static void CmacDouble( const uint8_t* in, uint8_t* out )
+{
+    uint8_t msb = in[0] & 0x80;
+
+    for( uint8_t i = 0; i < 15; i++ )
+    {
+        out[i] = ( uint8_t )( ( in[i] << 1 ) | ( in[i + 1] >> 7 ) );
+    }
+    out[15] = ( uint8_t )( in[15] << 1 );
+    if( msb != 0 )
+    {
+        out[15] ^= 0x87;
+    }
+}
+
+/*
+ * Computes a CMAC of a message using provided initial Bx block, chaining the
+ * blocks through the peripheral in ECB
+ *
+ *  cmac = aes128_cmac(keyID, blocks[i].Buffer)
+ *
+ * \param[IN]  micBxBuffer    - Buffer containing the initial Bx block
+ * \param[IN]  buffer         - Data buffer
+ * \param[IN]  size           - Data buffer size
+ * \param[IN]  keyID          - Key identifier to determine the AES key to be used
+ * \param[OUT] cmac           - Computed cmac
+ * \retval                    - Status of the operation
+ */
+static SecureElementStatus_t ComputeCmac( uint8_t *micBxBuffer, uint8_t *buffer, uint16_t size, KeyIdentifier_t keyID, uint32_t* cmac )
+{
+    if( ( buffer == NULL ) || ( cmac == NULL ) )
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+
+    SecureElementStatus_t retval = AesLoad( keyID, CRYP_CHAINMODE_AES_ECB, NULL );
+    uint8_t x[16] = { 0 };
+    uint16_t i;
+
+    // Subkeys generated once per loaded key
+    if( ( retval == SECURE_ELEMENT_SUCCESS ) && ( CmacSubkeysValid == false ) )
+    {
+        retval = AesProcess( x, 16, x );
+        if( retval == SECURE_ELEMENT_SUCCESS )
+        {
+            CmacDouble( x, CmacK1 );
+            CmacDouble( CmacK1, CmacK2 );
+            CmacSubkeysValid = true;
+        }
+        memset1( x, 0, sizeof( x ) );
+    }
+    if( retval != SECURE_ELEMENT_SUCCESS )
+    {
+        return retval;
+    }
+
+    // The Bx block is always a complete block followed by the message
+    if( micBxBuffer != NULL )
+    {
+        for( i = 0; i < 16; i++ )
+        {
+            x[i] ^= micBxBuffer[i];
+        }
+        if( size != 0 )
+        {
+            retval = AesProcess( x, 16, x );
+        }
+    }
+
+    // All message blocks but the last one
+    while( ( retval == SECURE_ELEMENT_SUCCESS ) && ( size > 16 ) )
+    {
+        for( i = 0; i < 16; i++ )
+        {
+            x[i] ^= buffer[i];
+        }
+        retval = AesProcess( x, 16, x );
+        buffer += 16;
+        size -= 16;
+    }
+    if( retval != SECURE_ELEMENT_SUCCESS )
+    {
+        return retval;
+    }
+
+    // Last block, complete or padded
+    for( i = 0; i < size; i++ )
+    {
+        x[i] ^= buffer[i];
+    }
+    if( ( size == 16 ) || ( ( size == 0 ) && ( micBxBuffer != NULL ) ) )
+    {
+        for( i = 0; i < 16; i++ )
+        {
+            x[i] ^= CmacK1[i];
+        }
+    }
+    else
+    {
+        x[size] ^= 0x80;
+        for( i = 0; i < 16; i++ )
+        {
+            x[i] ^= CmacK2[i];
+        }
+    }
+    retval = AesProcess( x, 16, x );
+
+    // Bring into the required format
+    *cmac = ( uint32_t )( ( uint32_t ) x[3] << 24 | ( uint32_t ) x[2] << 16 | ( uint32_t ) x[1] << 8 | ( uint32_t ) x[0] );
+    return retval;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -92,6 +92,19 @@ enum eLoRaMacState
     LORAMAC_RX_ABORT      = 0x00000080,
 };
 
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+/*
+ * Class C sniff states
+ */
+typedef enum eLoRaMacRxCSniffState
+{
+    RXC_SNIFF_IDLE = 0,
+    RXC_SNIFF_SLEEP,
+    RXC_SNIFF_CAD,
+    RXC_SNIFF_RX,
+}LoRaMacRxCSniffState_t;
+#endif
+
 /*
  * Request permission state
  */
@@ -198,6 +211,20 @@ typedef struct sLoRaMacNvmCtx
      * Last received Message integrity Code (MIC)
      */
     uint32_t LastRxMic;
+#ifdef LORAMAC_RX_TIMING_CALIBRATION_ENABLED
+    /*
+     * Learned mean of the downlink arrival time error [1/16 ms]
+     */
+    int16_t RxTimingErrorMean;
+    /*
+     * Learned mean deviation of the downlink arrival time error [1/16 ms]
+     */
+    uint16_t RxTimingErrorDev;
+    /*
+     * Number of timed downlinks, saturates at LORAMAC_RX_TIMING_MIN_SAMPLES
+     */
+    uint8_t RxTimingSamples;
+#endif
 }LoRaMacNvmCtx_t;
 
 typedef struct sLoRaMacCtx
@@ -259,12 +286,28 @@ typedef struct sLoRaMacCtx
     */
     uint32_t RxWindow1Delay;
     uint32_t RxWindow2Delay;
+#ifdef LORAMAC_RX_TIMING_CALIBRATION_ENABLED
+    /*
+    * Correction of the learned mean timing error applied to the windows delays [ms]
+    */
+    int32_t RxTimingCorrection;
+#endif
     /*
     * LoRaMac Rx windows configuration
     */
     RxConfigParams_t RxWindow1Config;
     RxConfigParams_t RxWindow2Config;
     RxConfigParams_t RxWindowCConfig;
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+    /*
+    * LoRaMac class C sniff timer, wakes up the radio for the next preamble detection
+    */
+    TimerEvent_t RxCSniffTimer;
+    /*
+    * LoRaMac class C sniff state
+    */
+    LoRaMacRxCSniffState_t RxCSniffState;
+#endif
     /*
      * Limit of uplinks without any donwlink response before the ADRACKReq bit will be set.
      */
@@ -339,6 +382,20 @@ typedef struct sLoRaMacCtx
     * Non-volatile module context structure
     */
     LoRaMacNvmCtx_t* NvmCtx;
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+    /*
+    * Latency of the MAC processing stages
+    */
+    LoRaMacLatencyStats_t LatencyStats[LORAMAC_LATENCY_STAGE_NB];
+#endif
+    /*
+    * Group ids of the enabled multicast channels, sorted by address
+    */
+    uint8_t McAddrIndex[LORAMAC_MAX_MC_CTX];
+    /*
+    * Number of entries in McAddrIndex
+    */
+    uint8_t McAddrIndexSize;
 }LoRaMacCtx_t;
 
 /*
@@ -371,6 +428,8 @@ typedef union uLoRaMacRadioEvents
         uint32_t TxTimeout : 1;
         uint32_t RxDone    : 1;
         uint32_t TxDone    : 1;
+        uint32_t CadDone   : 1;
+        uint32_t CadDetect : 1;
     }Events;
 }LoRaMacRadioEvents_t;
 
@@ -379,6 +438,27 @@ typedef union uLoRaMacRadioEvents
  */
 LoRaMacRadioEvents_t LoRaMacRadioEvents = { .Value = 0 };
 
+/*!
+ * \brief Gets the time at which the radio raised the event being notified
+ *
+ * \retval Event time [ms]
+ */
+static TimerTime_t GetRadioEventTime( void );
+
+/*!
+ * \brief Gets the time remaining until a delay counted from the TxDone event
+ *
+ * \param [IN] delay Delay counted from the TxDone event [ms]
+ *
+ * \retval Time remaining [ms], 1 ms when the delay has already elapsed
+ */
+static uint32_t GetDelayFromTxDone( uint32_t delay );
+
+/*!
+ * \brief Function executed on Radio interrupt pending event
+ */
+static void OnRadioIrqNotify( void );
+
 /*!
  * \brief Function to be executed on Radio Tx Done event
  */
@@ -410,6 +490,23 @@ static void OnRadioRxError( void );
  */
 static void OnRadioRxTimeout( void );
 
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+/*!
+ * \brief Function executed on Radio CAD Done event
+ */
+static void OnRadioCadDone( bool channelActivityDetected );
+
+/*!
+ * \brief Function executed on class C sniff timer event
+ */
+static void OnRxCSniffTimerEvent( void* context );
+
+/*!
+ * \brief Stops the class C sniff cycle, before using the radio for something else
+ */
+static void StopRxCSniff( void );
+#endif
+
 /*!
  * \brief Function executed on duty cycle delayed Tx  timer event
  */
@@ -452,6 +549,21 @@ static void SetMlmeScheduleUplinkIndication( void );
 static LoRaMacCryptoStatus_t GetFCntDown( AddressIdentifier_t addrID, FType_t fType, LoRaMacMessageData_t* macMsg, Version_t lrWanVersion,
                                           uint16_t maxFCntGap, FCntIdentifier_t* fCntID, uint32_t* currentDown );
 
+/*!
+ * \brief Rebuilds the address index of the enabled multicast channels.
+ *        Must be called whenever MulticastChannelList changes.
+ */
+static void McAddrIndexRebuild( void );
+
+/*!
+ * \brief Looks up an enabled multicast channel by address
+ *
+ * \param [IN] address Multicast address
+ *
+ * \retval Group id of the channel, or LORAMAC_MAX_MC_CTX if none matches
+ */
+static uint8_t McAddrIndexFind( uint32_t address );
+
 /*!
  * \brief Switches the device class
  *
@@ -615,6 +727,39 @@ static void RxWindowSetup( TimerEvent_t* rxTimer, RxConfigParams_t* rxConfig );
  */
 static void OpenContinuousRxCWindow( void );
 
+#ifdef LORAMAC_RX_TIMING_CALIBRATION_ENABLED
+/*!
+ * \brief Returns the timing error used to size the RX1 and RX2 windows
+ *
+ * \retval Timing error [ms]
+ */
+static uint32_t GetRxTimingError( void );
+
+/*!
+ * \brief Updates the learned timing error with a downlink received in RX1 or RX2
+ *
+ * \param [IN] size Size of the received PHY payload
+ */
+static void UpdateRxTiming( uint16_t size );
+#endif
+
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+/*!
+ * \brief Starts a latency measurement
+ *
+ * \retval Cycle counter value at the start of the stage
+ */
+static uint32_t LatencyProbeStart( void );
+
+/*!
+ * \brief Accounts the cycles elapsed since the start of a stage
+ *
+ * \param [IN] stage Measured stage
+ * \param [IN] start Value returned by LatencyProbeStart
+ */
+static void LatencyProbeStop( LoRaMacLatencyStage_t stage, uint32_t start );
+#endif
+
 /*!
  * \brief   Returns a pointer to the internal contexts structure.
  *
@@ -791,10 +936,47 @@ struct
     int8_t Snr;
 }RxDoneParams;
 
+static TimerTime_t GetRadioEventTime( void )
+{
+    // The radios deferring their interrupts notify the events later
+    if( Radio.GetIrqTime != NULL )
+    {
+        return Radio.GetIrqTime( );
+    }
+    return TimerGetCurrentTime( );
+}
+
+static uint32_t GetDelayFromTxDone( uint32_t delay )
+{
+    TimerTime_t elapsed = TimerGetElapsedTime( TxDoneParams.CurTime );
+
+    if( elapsed >= delay )
+    {
+        return 1;
+    }
+    return delay - elapsed;
+}
+
+static void OnRadioIrqNotify( void )
+{
+    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
+    {
+        MacCtx.MacCallbacks->MacProcessNotify( );
+    }
+}
+
 static void OnRadioTxDone( void )
 {
-    TxDoneParams.CurTime = TimerGetCurrentTime( );
-    MacCtx.LastTxSysTime = SysTimeGet( );
+    TimerTime_t elapsed;
+    SysTime_t sysTimeElapsed;
+
+    TxDoneParams.CurTime = GetRadioEventTime( );
+
+    // Back date the system time to the TxDone interrupt
+    elapsed = TimerGetElapsedTime( TxDoneParams.CurTime );
+    sysTimeElapsed.Seconds = elapsed / 1000;
+    sysTimeElapsed.SubSeconds = elapsed - sysTimeElapsed.Seconds * 1000;
+    MacCtx.LastTxSysTime = SysTimeSub( SysTimeGet( ), sysTimeElapsed );
 
     LoRaMacRadioEvents.Events.TxDone = 1;
 
@@ -809,7 +991,7 @@ static void OnRadioTxDone( void )
 
 static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
 {
-    RxDoneParams.LastRxDone = TimerGetCurrentTime( );
+    RxDoneParams.LastRxDone = GetRadioEventTime( );
     RxDoneParams.Payload = payload;
     RxDoneParams.Size = size;
     RxDoneParams.Rssi = rssi;
@@ -862,6 +1044,19 @@ static void OnRadioRxTimeout( void )
 #endif
 }
 
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+static void OnRadioCadDone( bool channelActivityDetected )
+{
+    LoRaMacRadioEvents.Events.CadDone = 1;
+    LoRaMacRadioEvents.Events.CadDetect = ( channelActivityDetected == true ) ? 1 : 0;
+
+    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
+    {
+        MacCtx.MacCallbacks->MacProcessNotify( );
+    }
+}
+#endif
+
 static void UpdateRxSlotIdleState( void )
 {
     if( MacCtx.NvmCtx->DeviceClass != CLASS_C )
@@ -884,17 +1079,21 @@ static void ProcessRadioTxDone( void )
     {
         Radio.Sleep( );
     }
-    // Setup timers
-    TimerSetValue( &MacCtx.RxWindowTimer1, MacCtx.RxWindow1Delay );
+#ifdef ENERGY_MONITOR_ENABLED
+    EM_AddTx( MacCtx.McpsConfirm.Datarate, MacCtx.McpsConfirm.TxPower, MacCtx.TxTimeOnAir );
+#endif
+    // Setup timers, counted from the TxDone interrupt as the event may be
+    // processed later
+    TimerSetValue( &MacCtx.RxWindowTimer1, GetDelayFromTxDone( MacCtx.RxWindow1Delay ) );
     TimerStart( &MacCtx.RxWindowTimer1 );
-    TimerSetValue( &MacCtx.RxWindowTimer2, MacCtx.RxWindow2Delay );
+    TimerSetValue( &MacCtx.RxWindowTimer2, GetDelayFromTxDone( MacCtx.RxWindow2Delay ) );
     TimerStart( &MacCtx.RxWindowTimer2 );
 
     if( ( MacCtx.NvmCtx->DeviceClass == CLASS_C ) || ( MacCtx.NodeAckRequested == true ) )
     {
         getPhy.Attribute = PHY_ACK_TIMEOUT;
         phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-        TimerSetValue( &MacCtx.AckTimeoutTimer, MacCtx.RxWindow2Delay + phyParam.Value );
+        TimerSetValue( &MacCtx.AckTimeoutTimer, GetDelayFromTxDone( MacCtx.RxWindow2Delay + phyParam.Value ) );
         TimerStart( &MacCtx.AckTimeoutTimer );
     }
 
@@ -958,6 +1157,14 @@ static void ProcessRadioRxDone( void )
     uint8_t multicast = 0;
     AddressIdentifier_t addrID = UNICAST_DEV_ADDR;
     FCntIdentifier_t fCntID;
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+    uint32_t latencyStart;
+#endif
+
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+    // The sniff cycle restarts once the frame is processed
+    StopRxCSniff( );
+#endif
 
     MacCtx.McpsConfirm.AckReceived = false;
     MacCtx.McpsIndication.Rssi = rssi;
@@ -979,7 +1186,7 @@ static void ProcessRadioRxDone( void )
     TimerStop( &MacCtx.RxWindowTimer2 );
 
     // This function must be called even if we are not in class b mode yet.
-    if( LoRaMacClassBRxBeacon( payload, size ) == true )
+    if( LoRaMacClassBRxBeacon( payload, size, RxDoneParams.LastRxDone ) == true )
     {
         MacCtx.MlmeIndication.BeaconInfo.Rssi = rssi;
         MacCtx.MlmeIndication.BeaconInfo.Snr = snr;
@@ -1017,10 +1224,20 @@ static void ProcessRadioRxDone( void )
                 PrepareRxDoneAbort( );
                 return;
             }
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+            latencyStart = LatencyProbeStart( );
+#endif
             macCryptoStatus = LoRaMacCryptoHandleJoinAccept( JOIN_REQ, SecureElementGetJoinEui( ), &macMsgJoinAccept );
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+            LatencyProbeStop( LORAMAC_LATENCY_RX_JOIN_ACCEPT, latencyStart );
+#endif
 
             if( LORAMAC_CRYPTO_SUCCESS == macCryptoStatus )
             {
+#ifdef LORAMAC_RX_TIMING_CALIBRATION_ENABLED
+                // Authenticated, before the join accept changes the receive delays
+                UpdateRxTiming( size );
+#endif
                 // Network ID
                 MacCtx.NvmCtx->NetID = ( uint32_t ) macMsgJoinAccept.NetID[0];
                 MacCtx.NvmCtx->NetID |= ( ( uint32_t ) macMsgJoinAccept.NetID[1] << 8 );
@@ -1116,20 +1333,16 @@ static void ProcessRadioRxDone( void )
             //Check if it is a multicast message
             multicast = 0;
             downLinkCounter = 0;
-            for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
-            {
-                if( ( MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.Address == macMsgData.FHDR.DevAddr ) &&
-                    ( MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.IsEnabled == true ) )
+            uint8_t mcGroup = McAddrIndexFind( macMsgData.FHDR.DevAddr );
+            if( mcGroup < LORAMAC_MAX_MC_CTX )
+            {
+                multicast = 1;
+                addrID = MacCtx.NvmCtx->MulticastChannelList[mcGroup].ChannelParams.GroupID;
+                downLinkCounter = *( MacCtx.NvmCtx->MulticastChannelList[mcGroup].DownLinkCounter );
+                address = MacCtx.NvmCtx->MulticastChannelList[mcGroup].ChannelParams.Address;
+                if( MacCtx.NvmCtx->DeviceClass == CLASS_C )
                 {
-                    multicast = 1;
-                    addrID = MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.GroupID;
-                    downLinkCounter = *( MacCtx.NvmCtx->MulticastChannelList[i].DownLinkCounter );
-                    address = MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.Address;
-                    if( MacCtx.NvmCtx->DeviceClass == CLASS_C )
-                    {
-                        MacCtx.McpsIndication.RxSlot = RX_SLOT_WIN_CLASS_C_MULTICAST;
-                    }
-                    break;
+                    MacCtx.McpsIndication.RxSlot = RX_SLOT_WIN_CLASS_C_MULTICAST;
                 }
             }
 
@@ -1165,7 +1378,13 @@ static void ProcessRadioRxDone( void )
                 return;
             }
 
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+            latencyStart = LatencyProbeStart( );
+#endif
             macCryptoStatus = LoRaMacCryptoUnsecureMessage( addrID, address, fCntID, downLinkCounter, &macMsgData );
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+            LatencyProbeStop( LORAMAC_LATENCY_RX_UNSECURE, latencyStart );
+#endif
             if( macCryptoStatus != LORAMAC_CRYPTO_SUCCESS )
             {
                 if( macCryptoStatus == LORAMAC_CRYPTO_FAIL_ADDRESS )
@@ -1181,6 +1400,10 @@ static void ProcessRadioRxDone( void )
                 PrepareRxDoneAbort( );
                 return;
             }
+#ifdef LORAMAC_RX_TIMING_CALIBRATION_ENABLED
+            // Authenticated, a forged or foreign frame must not move the windows
+            UpdateRxTiming( size );
+#endif
 
             // Frame is valid
             MacCtx.McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_OK;
@@ -1199,6 +1422,9 @@ static void ProcessRadioRxDone( void )
                 ( MacCtx.McpsIndication.RxSlot == RX_SLOT_WIN_2 ) )
             {
                 MacCtx.NvmCtx->AdrAckCounter = 0;
+#ifdef LORAMAC_ADR_LINK_MARGIN_ENABLED
+                LoRaMacAdrAddDownlinkSnr( MacCtx.NvmCtx->Region, snr, MacCtx.McpsIndication.RxDatarate );
+#endif
             }
 
             // MCPS Indication and ack requested handling
@@ -1395,6 +1621,14 @@ static void HandleRadioRxErrorTimeout( LoRaMacEventInfoStatus_t rx1EventInfoStat
             if( MacCtx.NodeAckRequested == true )
             {
                 MacCtx.McpsConfirm.Status = rx2EventInfoStatus;
+#ifdef LORAMAC_RX_TIMING_CALIBRATION_ENABLED
+                if( MacCtx.RxSlot == RX_SLOT_WIN_2 )
+                {
+                    // The acknowledgement may have been missed by a too narrow window, widen the next ones
+                    MacCtx.NvmCtx->RxTimingErrorDev = MIN( MacCtx.NvmCtx->RxTimingErrorDev * 2 + 16,
+                                                           MacCtx.NvmCtx->MacParams.SystemMaxRxError << 4 );
+                }
+#endif
             }
             LoRaMacConfirmQueueSetStatusCmn( rx2EventInfoStatus );
 
@@ -1408,13 +1642,65 @@ static void HandleRadioRxErrorTimeout( LoRaMacEventInfoStatus_t rx1EventInfoStat
     UpdateRxSlotIdleState( );
 }
 
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+static void ProcessRadioCadDone( bool channelActivityDetected )
+{
+    if( MacCtx.RxCSniffState != RXC_SNIFF_CAD )
+    {
+        return;
+    }
+
+    if( channelActivityDetected == true )
+    {
+        // A preamble is on air, receive the frame
+        Radio.Rx( MacCtx.NvmCtx->MacParams.MaxRxWindow );
+        MacCtx.RxCSniffState = RXC_SNIFF_RX;
+    }
+    else
+    {
+        Radio.Sleep( );
+        MacCtx.RxCSniffState = RXC_SNIFF_SLEEP;
+        TimerSetValue( &MacCtx.RxCSniffTimer, LORAMAC_CLASS_C_SNIFF_PERIOD );
+        TimerStart( &MacCtx.RxCSniffTimer );
+    }
+}
+
+/*!
+ * \brief Handles the end of a class C sniff reception without a frame
+ *
+ * \retval Returns true, if the event belongs to the sniff cycle.
+ */
+static bool ProcessRxCSniffAbort( void )
+{
+    if( MacCtx.RxCSniffState != RXC_SNIFF_RX )
+    {
+        return false;
+    }
+    // False detection or corrupted frame, the sniff cycle restarts from LoRaMacProcess
+    StopRxCSniff( );
+    return true;
+}
+#endif
+
 static void ProcessRadioRxError( void )
 {
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+    if( ProcessRxCSniffAbort( ) == true )
+    {
+        return;
+    }
+#endif
     HandleRadioRxErrorTimeout( LORAMAC_EVENT_INFO_STATUS_RX1_ERROR, LORAMAC_EVENT_INFO_STATUS_RX2_ERROR );
 }
 
 static void ProcessRadioRxTimeout( void )
 {
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+    if( ProcessRxCSniffAbort( ) == true )
+    {
+        return;
+    }
+#endif
     HandleRadioRxErrorTimeout( LORAMAC_EVENT_INFO_STATUS_RX1_TIMEOUT, LORAMAC_EVENT_INFO_STATUS_RX2_TIMEOUT );
 }
 
@@ -1435,7 +1721,13 @@ static void LoRaMacHandleIrqEvents( void )
         }
         if( events.Events.RxDone == 1 )
         {
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+            uint32_t latencyStart = LatencyProbeStart( );
             ProcessRadioRxDone( );
+            LatencyProbeStop( LORAMAC_LATENCY_RX_DONE, latencyStart );
+#else
+            ProcessRadioRxDone( );
+#endif
         }
         if( events.Events.TxTimeout == 1 )
         {
@@ -1449,6 +1741,12 @@ static void LoRaMacHandleIrqEvents( void )
         {
             ProcessRadioRxTimeout( );
         }
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+        if( events.Events.CadDone == 1 )
+        {
+            ProcessRadioCadDone( events.Events.CadDetect == 1 );
+        }
+#endif
     }
 }
 
@@ -1603,7 +1901,13 @@ static void LoRaMacHandleMcpsRequest( void )
             // Reset the state of the AckTimeout
             MacCtx.AckTimeoutRetry = false;
             // Sends the same frame again
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+            uint32_t latencyStart = LatencyProbeStart( );
+            OnTxDelayedTimerEvent( NULL );
+            LatencyProbeStop( LORAMAC_LATENCY_RETRANSMISSION, latencyStart );
+#else
             OnTxDelayedTimerEvent( NULL );
+#endif
         }
     }
 }
@@ -1658,6 +1962,12 @@ void LoRaMacProcess( void )
 {
     uint8_t noTx = false;
 
+    // Process the radio interrupts deferred to the main loop context
+    if( Radio.IrqProcess != NULL )
+    {
+        Radio.IrqProcess( );
+    }
+
     LoRaMacHandleIrqEvents( );
     LoRaMacClassBProcess( );
 
@@ -1792,25 +2102,69 @@ static LoRaMacCryptoStatus_t GetFCntDown( AddressIdentifier_t addrID, FType_t fT
                 *fCntID = FCNT_DOWN;
             }
             break;
-        case MULTICAST_0_ADDR:
-            *fCntID = MC_FCNT_DOWN_0;
-            break;
-        case MULTICAST_1_ADDR:
-            *fCntID = MC_FCNT_DOWN_1;
-            break;
-        case MULTICAST_2_ADDR:
-            *fCntID = MC_FCNT_DOWN_2;
-            break;
-        case MULTICAST_3_ADDR:
-            *fCntID = MC_FCNT_DOWN_3;
-            break;
         default:
+            if( addrID < LORAMAC_MAX_MC_CTX )
+            {
+                *fCntID = MC_FCNT_DOWN( addrID );
+                break;
+            }
             return LORAMAC_CRYPTO_FAIL_FCNT_ID;
     }
 
     return LoRaMacCryptoGetFCntDown( *fCntID, maxFCntGap, macMsg->FHDR.FCnt, currentDown );
 }
 
+static void McAddrIndexRebuild( void )
+{
+    uint8_t size = 0;
+
+    // Insertion sort, equal addresses keep the lower group id first
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        if( MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.IsEnabled == false )
+        {
+            continue;
+        }
+        uint32_t address = MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.Address;
+        uint8_t pos = size;
+        while( ( pos > 0 ) &&
+               ( MacCtx.NvmCtx->MulticastChannelList[MacCtx.McAddrIndex[pos - 1]].ChannelParams.Address > address ) )
+        {
+            MacCtx.McAddrIndex[pos] = MacCtx.McAddrIndex[pos - 1];
+            pos--;
+        }
+        MacCtx.McAddrIndex[pos] = i;
+        size++;
+    }
+    MacCtx.McAddrIndexSize = size;
+}
+
+static uint8_t McAddrIndexFind( uint32_t address )
+{
+    uint8_t low = 0;
+    uint8_t high = MacCtx.McAddrIndexSize;
+
+    // Lower bound search
+    while( low < high )
+    {
+        uint8_t mid = ( low + high ) >> 1;
+        if( MacCtx.NvmCtx->MulticastChannelList[MacCtx.McAddrIndex[mid]].ChannelParams.Address < address )
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    if( ( low < MacCtx.McAddrIndexSize ) &&
+        ( MacCtx.NvmCtx->MulticastChannelList[MacCtx.McAddrIndex[low]].ChannelParams.Address == address ) )
+    {
+        return MacCtx.McAddrIndex[low];
+    }
+    return LORAMAC_MAX_MC_CTX;
+}
+
 static LoRaMacStatus_t SwitchClass( DeviceClass_t deviceClass )
 {
     LoRaMacStatus_t status = LORAMAC_STATUS_PARAMETER_INVALID;
@@ -1889,6 +2243,9 @@ static LoRaMacStatus_t SwitchClass( DeviceClass_t deviceClass )
             {
                 MacCtx.NvmCtx->DeviceClass = deviceClass;
 
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+                StopRxCSniff( );
+#endif
                 // Set the radio into sleep to setup a defined state
                 Radio.Sleep( );
 
@@ -1939,312 +2296,399 @@ static bool ValidatePayloadLength( uint8_t lenN, int8_t datarate, uint8_t fOptsL
     return false;
 }
 
-static void SetMlmeScheduleUplinkIndication( void )
+static void SetMlmeScheduleUplinkIndication( void )
+{
+    MacCtx.MacFlags.Bits.MlmeSchedUplinkInd = 1;
+}
+
+/*!
+ * Network server MAC command being processed
+ */
+typedef struct sSrvMacCmd
+{
+    /*!
+     * Payload of the command, following its CID
+     */
+    uint8_t* Payload;
+    /*!
+     * Size from the CID up to the end of the MAC commands
+     */
+    uint8_t RemainingSize;
+    /*!
+     * Size consumed by the command, CID included. Set from the descriptor,
+     * a handler processing several contiguous commands enlarges it.
+     */
+    uint8_t Size;
+    /*!
+     * SNR of the frame
+     */
+    int8_t Snr;
+    /*!
+     * Set once the first block of LinkADRReq commands of the frame is processed
+     */
+    bool AdrBlockFound;
+}SrvMacCmd_t;
+
+/*!
+ * Network server MAC command descriptor
+ */
+typedef struct sSrvMacCmdDesc
+{
+    /*!
+     * Size of the command payload
+     */
+    uint8_t PayloadSize;
+    /*!
+     * Decodes and applies the command, NULL for the commands not supported by
+     * the end-device
+     */
+    void ( *Handler )( SrvMacCmd_t* cmd );
+}SrvMacCmdDesc_t;
+
+static void ProcessSrvMacLinkCheckAns( SrvMacCmd_t* cmd )
+{
+    if( LoRaMacConfirmQueueIsCmdActive( MLME_LINK_CHECK ) == true )
+    {
+        LoRaMacConfirmQueueSetStatus( LORAMAC_EVENT_INFO_STATUS_OK, MLME_LINK_CHECK );
+        MacCtx.MlmeConfirm.DemodMargin = cmd->Payload[0];
+        MacCtx.MlmeConfirm.NbGateways = cmd->Payload[1];
+#ifdef LORAMAC_ADR_LINK_MARGIN_ENABLED
+        LoRaMacAdrAddLinkCheckMargin( MacCtx.NvmCtx->Region, MacCtx.MlmeConfirm.DemodMargin, MacCtx.McpsConfirm.Datarate );
+#endif
+    }
+}
+
+static void ProcessSrvMacLinkAdrReq( SrvMacCmd_t* cmd )
+{
+    LinkAdrReqParams_t linkAdrReq;
+    int8_t linkAdrDatarate = DR_0;
+    int8_t linkAdrTxPower = TX_POWER_0;
+    uint8_t linkAdrNbRep = 0;
+    uint8_t linkAdrNbBytesParsed = 0;
+    uint8_t status;
+
+    if( cmd->AdrBlockFound == true )
+    {
+        return;
+    }
+    cmd->AdrBlockFound = true;
+
+    // Fill parameter structure
+    linkAdrReq.Payload = cmd->Payload - 1;
+    linkAdrReq.PayloadSize = cmd->RemainingSize;
+    linkAdrReq.AdrEnabled = MacCtx.NvmCtx->AdrCtrlOn;
+    linkAdrReq.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
+    linkAdrReq.CurrentDatarate = MacCtx.NvmCtx->MacParams.ChannelsDatarate;
+    linkAdrReq.CurrentTxPower = MacCtx.NvmCtx->MacParams.ChannelsTxPower;
+    linkAdrReq.CurrentNbRep = MacCtx.NvmCtx->MacParams.ChannelsNbTrans;
+    linkAdrReq.Version = MacCtx.NvmCtx->Version;
+
+    // Process the ADR requests
+    status = RegionLinkAdrReq( MacCtx.NvmCtx->Region, &linkAdrReq, &linkAdrDatarate,
+                               &linkAdrTxPower, &linkAdrNbRep, &linkAdrNbBytesParsed );
+
+    if( ( status & 0x07 ) == 0x07 )
+    {
+        MacCtx.NvmCtx->MacParams.ChannelsDatarate = linkAdrDatarate;
+        MacCtx.NvmCtx->MacParams.ChannelsTxPower = linkAdrTxPower;
+        MacCtx.NvmCtx->MacParams.ChannelsNbTrans = linkAdrNbRep;
+    }
+
+    // Add the answers to the buffer
+    for( uint8_t i = 0; i < ( linkAdrNbBytesParsed / 5 ); i++ )
+    {
+        LoRaMacCommandsAddCmd( MOTE_MAC_LINK_ADR_ANS, &status, 1 );
+    }
+    // Skip the whole block of contiguous ADR requests
+    if( linkAdrNbBytesParsed > 0 )
+    {
+        cmd->Size = linkAdrNbBytesParsed;
+    }
+}
+
+static void ProcessSrvMacDutyCycleReq( SrvMacCmd_t* cmd )
+{
+    uint8_t macCmdPayload[1] = { 0x00 };
+
+    MacCtx.NvmCtx->MaxDCycle = cmd->Payload[0] & 0x0F;
+    MacCtx.NvmCtx->AggregatedDCycle = 1 << MacCtx.NvmCtx->MaxDCycle;
+    LoRaMacCommandsAddCmd( MOTE_MAC_DUTY_CYCLE_ANS, macCmdPayload, 0 );
+}
+
+static void ProcessSrvMacRxParamSetupReq( SrvMacCmd_t* cmd )
+{
+    RxParamSetupReqParams_t rxParamSetupReq;
+    uint8_t status = 0x07;
+
+    rxParamSetupReq.DrOffset = ( cmd->Payload[0] >> 4 ) & 0x07;
+    rxParamSetupReq.Datarate = cmd->Payload[0] & 0x0F;
+
+    rxParamSetupReq.Frequency = ( uint32_t ) cmd->Payload[1];
+    rxParamSetupReq.Frequency |= ( uint32_t ) cmd->Payload[2] << 8;
+    rxParamSetupReq.Frequency |= ( uint32_t ) cmd->Payload[3] << 16;
+    rxParamSetupReq.Frequency *= 100;
+
+    // Perform request on region
+    status = RegionRxParamSetupReq( MacCtx.NvmCtx->Region, &rxParamSetupReq );
+
+    if( ( status & 0x07 ) == 0x07 )
+    {
+        MacCtx.NvmCtx->MacParams.Rx2Channel.Datarate = rxParamSetupReq.Datarate;
+        MacCtx.NvmCtx->MacParams.RxCChannel.Datarate = rxParamSetupReq.Datarate;
+        MacCtx.NvmCtx->MacParams.Rx2Channel.Frequency = rxParamSetupReq.Frequency;
+        MacCtx.NvmCtx->MacParams.RxCChannel.Frequency = rxParamSetupReq.Frequency;
+        MacCtx.NvmCtx->MacParams.Rx1DrOffset = rxParamSetupReq.DrOffset;
+    }
+    LoRaMacCommandsAddCmd( MOTE_MAC_RX_PARAM_SETUP_ANS, &status, 1 );
+    // Setup indication to inform the application
+    SetMlmeScheduleUplinkIndication( );
+}
+
+static void ProcessSrvMacDevStatusReq( SrvMacCmd_t* cmd )
+{
+    uint8_t macCmdPayload[2];
+    uint8_t batteryLevel = BAT_LEVEL_NO_MEASURE;
+
+    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->GetBatteryLevel != NULL ) )
+    {
+        batteryLevel = MacCtx.MacCallbacks->GetBatteryLevel( );
+    }
+    macCmdPayload[0] = batteryLevel;
+    macCmdPayload[1] = ( uint8_t )( cmd->Snr & 0x3F );
+    LoRaMacCommandsAddCmd( MOTE_MAC_DEV_STATUS_ANS, macCmdPayload, 2 );
+}
+
+static void ProcessSrvMacNewChannelReq( SrvMacCmd_t* cmd )
 {
-    MacCtx.MacFlags.Bits.MlmeSchedUplinkInd = 1;
+    NewChannelReqParams_t newChannelReq;
+    ChannelParams_t chParam;
+    uint8_t status = 0x03;
+
+    newChannelReq.ChannelId = cmd->Payload[0];
+    newChannelReq.NewChannel = &chParam;
+
+    chParam.Frequency = ( uint32_t ) cmd->Payload[1];
+    chParam.Frequency |= ( uint32_t ) cmd->Payload[2] << 8;
+    chParam.Frequency |= ( uint32_t ) cmd->Payload[3] << 16;
+    chParam.Frequency *= 100;
+    chParam.Rx1Frequency = 0;
+    chParam.DrRange.Value = cmd->Payload[4];
+
+    status = RegionNewChannelReq( MacCtx.NvmCtx->Region, &newChannelReq );
+
+    LoRaMacCommandsAddCmd( MOTE_MAC_NEW_CHANNEL_ANS, &status, 1 );
 }
 
-static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t commandsSize, int8_t snr, LoRaMacRxSlot_t rxSlot )
+static void ProcessSrvMacRxTimingSetupReq( SrvMacCmd_t* cmd )
 {
-    uint8_t status = 0;
-    bool adrBlockFound = false;
-    uint8_t macCmdPayload[2] = { 0x00, 0x00 };
+    uint8_t macCmdPayload[1] = { 0x00 };
+    uint8_t delay = cmd->Payload[0] & 0x0F;
 
-    while( macIndex < commandsSize )
+    if( delay == 0 )
     {
-        // Decode Frame MAC commands
-        switch( payload[macIndex++] )
-        {
-            case SRV_MAC_LINK_CHECK_ANS:
-            {
-                if( LoRaMacConfirmQueueIsCmdActive( MLME_LINK_CHECK ) == true )
-                {
-                    LoRaMacConfirmQueueSetStatus( LORAMAC_EVENT_INFO_STATUS_OK, MLME_LINK_CHECK );
-                    MacCtx.MlmeConfirm.DemodMargin = payload[macIndex++];
-                    MacCtx.MlmeConfirm.NbGateways = payload[macIndex++];
-                }
-                break;
-            }
-            case SRV_MAC_LINK_ADR_REQ:
-            {
-                LinkAdrReqParams_t linkAdrReq;
-                int8_t linkAdrDatarate = DR_0;
-                int8_t linkAdrTxPower = TX_POWER_0;
-                uint8_t linkAdrNbRep = 0;
-                uint8_t linkAdrNbBytesParsed = 0;
+        delay++;
+    }
+    MacCtx.NvmCtx->MacParams.ReceiveDelay1 = delay * 1000;
+    MacCtx.NvmCtx->MacParams.ReceiveDelay2 = MacCtx.NvmCtx->MacParams.ReceiveDelay1 + 1000;
+    LoRaMacCommandsAddCmd( MOTE_MAC_RX_TIMING_SETUP_ANS, macCmdPayload, 0 );
+    // Setup indication to inform the application
+    SetMlmeScheduleUplinkIndication( );
+}
 
-                if( adrBlockFound == false )
-                {
-                    adrBlockFound = true;
-
-                    // Fill parameter structure
-                    linkAdrReq.Payload = &payload[macIndex - 1];
-                    linkAdrReq.PayloadSize = commandsSize - ( macIndex - 1 );
-                    linkAdrReq.AdrEnabled = MacCtx.NvmCtx->AdrCtrlOn;
-                    linkAdrReq.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
-                    linkAdrReq.CurrentDatarate = MacCtx.NvmCtx->MacParams.ChannelsDatarate;
-                    linkAdrReq.CurrentTxPower = MacCtx.NvmCtx->MacParams.ChannelsTxPower;
-                    linkAdrReq.CurrentNbRep = MacCtx.NvmCtx->MacParams.ChannelsNbTrans;
-                    linkAdrReq.Version = MacCtx.NvmCtx->Version;
-
-                    // Process the ADR requests
-                    status = RegionLinkAdrReq( MacCtx.NvmCtx->Region, &linkAdrReq, &linkAdrDatarate,
-                                               &linkAdrTxPower, &linkAdrNbRep, &linkAdrNbBytesParsed );
-
-                    if( ( status & 0x07 ) == 0x07 )
-                    {
-                        MacCtx.NvmCtx->MacParams.ChannelsDatarate = linkAdrDatarate;
-                        MacCtx.NvmCtx->MacParams.ChannelsTxPower = linkAdrTxPower;
-                        MacCtx.NvmCtx->MacParams.ChannelsNbTrans = linkAdrNbRep;
-                    }
+static void ProcessSrvMacTxParamSetupReq( SrvMacCmd_t* cmd )
+{
+    TxParamSetupReqParams_t txParamSetupReq;
+    GetPhyParams_t getPhy;
+    PhyParam_t phyParam;
+    uint8_t macCmdPayload[1] = { 0x00 };
+    uint8_t eirpDwellTime = cmd->Payload[0];
 
-                    // Add the answers to the buffer
-                    for( uint8_t i = 0; i < ( linkAdrNbBytesParsed / 5 ); i++ )
-                    {
-                        LoRaMacCommandsAddCmd( MOTE_MAC_LINK_ADR_ANS, &status, 1 );
-                    }
-                    // Update MAC index
-                    macIndex += linkAdrNbBytesParsed - 1;
-                }
-                break;
-            }
-            case SRV_MAC_DUTY_CYCLE_REQ:
-            {
-                MacCtx.NvmCtx->MaxDCycle = payload[macIndex++] & 0x0F;
-                MacCtx.NvmCtx->AggregatedDCycle = 1 << MacCtx.NvmCtx->MaxDCycle;
-                LoRaMacCommandsAddCmd( MOTE_MAC_DUTY_CYCLE_ANS, macCmdPayload, 0 );
-                break;
-            }
-            case SRV_MAC_RX_PARAM_SETUP_REQ:
-            {
-                RxParamSetupReqParams_t rxParamSetupReq;
-                status = 0x07;
+    txParamSetupReq.UplinkDwellTime = 0;
+    txParamSetupReq.DownlinkDwellTime = 0;
 
-                rxParamSetupReq.DrOffset = ( payload[macIndex] >> 4 ) & 0x07;
-                rxParamSetupReq.Datarate = payload[macIndex] & 0x0F;
-                macIndex++;
+    if( ( eirpDwellTime & 0x20 ) == 0x20 )
+    {
+        txParamSetupReq.DownlinkDwellTime = 1;
+    }
+    if( ( eirpDwellTime & 0x10 ) == 0x10 )
+    {
+        txParamSetupReq.UplinkDwellTime = 1;
+    }
+    txParamSetupReq.MaxEirp = eirpDwellTime & 0x0F;
 
-                rxParamSetupReq.Frequency = ( uint32_t ) payload[macIndex++];
-                rxParamSetupReq.Frequency |= ( uint32_t ) payload[macIndex++] << 8;
-                rxParamSetupReq.Frequency |= ( uint32_t ) payload[macIndex++] << 16;
-                rxParamSetupReq.Frequency *= 100;
+    // Check the status for correctness
+    if( RegionTxParamSetupReq( MacCtx.NvmCtx->Region, &txParamSetupReq ) != -1 )
+    {
+        // Accept command
+        MacCtx.NvmCtx->MacParams.UplinkDwellTime = txParamSetupReq.UplinkDwellTime;
+        MacCtx.NvmCtx->MacParams.DownlinkDwellTime = txParamSetupReq.DownlinkDwellTime;
+        MacCtx.NvmCtx->MacParams.MaxEirp = LoRaMacMaxEirpTable[txParamSetupReq.MaxEirp];
+        // Update the datarate in case of the new configuration limits it
+        getPhy.Attribute = PHY_MIN_TX_DR;
+        getPhy.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
+        phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+        MacCtx.NvmCtx->MacParams.ChannelsDatarate = MAX( MacCtx.NvmCtx->MacParams.ChannelsDatarate, ( int8_t )phyParam.Value );
 
-                // Perform request on region
-                status = RegionRxParamSetupReq( MacCtx.NvmCtx->Region, &rxParamSetupReq );
+        // Add command response
+        LoRaMacCommandsAddCmd( MOTE_MAC_TX_PARAM_SETUP_ANS, macCmdPayload, 0 );
+    }
+}
 
-                if( ( status & 0x07 ) == 0x07 )
-                {
-                    MacCtx.NvmCtx->MacParams.Rx2Channel.Datarate = rxParamSetupReq.Datarate;
-                    MacCtx.NvmCtx->MacParams.RxCChannel.Datarate = rxParamSetupReq.Datarate;
-                    MacCtx.NvmCtx->MacParams.Rx2Channel.Frequency = rxParamSetupReq.Frequency;
-                    MacCtx.NvmCtx->MacParams.RxCChannel.Frequency = rxParamSetupReq.Frequency;
-                    MacCtx.NvmCtx->MacParams.Rx1DrOffset = rxParamSetupReq.DrOffset;
-                }
-                macCmdPayload[0] = status;
-                LoRaMacCommandsAddCmd( MOTE_MAC_RX_PARAM_SETUP_ANS, macCmdPayload, 1 );
-                // Setup indication to inform the application
-                SetMlmeScheduleUplinkIndication( );
-                break;
-            }
-            case SRV_MAC_DEV_STATUS_REQ:
-            {
-                uint8_t batteryLevel = BAT_LEVEL_NO_MEASURE;
-                if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->GetBatteryLevel != NULL ) )
-                {
-                    batteryLevel = MacCtx.MacCallbacks->GetBatteryLevel( );
-                }
-                macCmdPayload[0] = batteryLevel;
-                macCmdPayload[1] = ( uint8_t )( snr & 0x3F );
-                LoRaMacCommandsAddCmd( MOTE_MAC_DEV_STATUS_ANS, macCmdPayload, 2 );
-                break;
-            }
-            case SRV_MAC_NEW_CHANNEL_REQ:
-            {
-                NewChannelReqParams_t newChannelReq;
-                ChannelParams_t chParam;
-                status = 0x03;
+static void ProcessSrvMacDlChannelReq( SrvMacCmd_t* cmd )
+{
+    DlChannelReqParams_t dlChannelReq;
+    uint8_t status = 0x03;
+
+    dlChannelReq.ChannelId = cmd->Payload[0];
+    dlChannelReq.Rx1Frequency = ( uint32_t ) cmd->Payload[1];
+    dlChannelReq.Rx1Frequency |= ( uint32_t ) cmd->Payload[2] << 8;
+    dlChannelReq.Rx1Frequency |= ( uint32_t ) cmd->Payload[3] << 16;
+    dlChannelReq.Rx1Frequency *= 100;
+
+    status = RegionDlChannelReq( MacCtx.NvmCtx->Region, &dlChannelReq );
+    LoRaMacCommandsAddCmd( MOTE_MAC_DL_CHANNEL_ANS, &status, 1 );
+    // Setup indication to inform the application
+    SetMlmeScheduleUplinkIndication( );
+}
 
-                newChannelReq.ChannelId = payload[macIndex++];
-                newChannelReq.NewChannel = &chParam;
+static void ProcessSrvMacDeviceTimeAns( SrvMacCmd_t* cmd )
+{
+    SysTime_t gpsEpochTime = { 0 };
+    SysTime_t sysTime = { 0 };
+    SysTime_t sysTimeCurrent = { 0 };
+
+    gpsEpochTime.Seconds = ( uint32_t )cmd->Payload[0];
+    gpsEpochTime.Seconds |= ( uint32_t )cmd->Payload[1] << 8;
+    gpsEpochTime.Seconds |= ( uint32_t )cmd->Payload[2] << 16;
+    gpsEpochTime.Seconds |= ( uint32_t )cmd->Payload[3] << 24;
+    gpsEpochTime.SubSeconds = cmd->Payload[4];
+
+    // Convert the fractional second received in ms
+    // round( pow( 0.5, 8.0 ) * 1000 ) = 3.90625
+    gpsEpochTime.SubSeconds = ( int16_t )( ( ( int32_t )gpsEpochTime.SubSeconds * 1000 ) >> 8 );
+
+    // Copy received GPS Epoch time into system time
+    sysTime = gpsEpochTime;
+    // Add Unix to Gps epcoh offset. The system time is based on Unix time.
+    sysTime.Seconds += UNIX_GPS_EPOCH_OFFSET;
+
+    // Compensate time difference between Tx Done time and now
+    sysTimeCurrent = SysTimeGet( );
+    sysTime = SysTimeAdd( sysTimeCurrent, SysTimeSub( sysTime, MacCtx.LastTxSysTime ) );
+
+    // Apply the new system time.
+    SysTimeSet( sysTime );
+    LoRaMacClassBDeviceTimeAns( );
+    MacCtx.McpsIndication.DeviceTimeAnsReceived = true;
+}
 
-                chParam.Frequency = ( uint32_t ) payload[macIndex++];
-                chParam.Frequency |= ( uint32_t ) payload[macIndex++] << 8;
-                chParam.Frequency |= ( uint32_t ) payload[macIndex++] << 16;
-                chParam.Frequency *= 100;
-                chParam.Rx1Frequency = 0;
-                chParam.DrRange.Value = payload[macIndex++];
+static void ProcessSrvMacPingSlotInfoAns( SrvMacCmd_t* cmd )
+{
+    // According to the specification, it is not allowed to process this answer in
+    // a ping or multicast slot
+    if( ( MacCtx.RxSlot != RX_SLOT_WIN_CLASS_B_PING_SLOT ) && ( MacCtx.RxSlot != RX_SLOT_WIN_CLASS_B_MULTICAST_SLOT ) )
+    {
+        LoRaMacClassBPingSlotInfoAns( );
+    }
+}
 
-                status = RegionNewChannelReq( MacCtx.NvmCtx->Region, &newChannelReq );
+static void ProcessSrvMacPingSlotChannelReq( SrvMacCmd_t* cmd )
+{
+    uint8_t status = 0x03;
+    uint32_t frequency = 0;
+    uint8_t datarate;
+
+    frequency = ( uint32_t )cmd->Payload[0];
+    frequency |= ( uint32_t )cmd->Payload[1] << 8;
+    frequency |= ( uint32_t )cmd->Payload[2] << 16;
+    frequency *= 100;
+    datarate = cmd->Payload[3] & 0x0F;
+
+    status = LoRaMacClassBPingSlotChannelReq( datarate, frequency );
+    LoRaMacCommandsAddCmd( MOTE_MAC_PING_SLOT_FREQ_ANS, &status, 1 );
+}
 
-                macCmdPayload[0] = status;
-                LoRaMacCommandsAddCmd( MOTE_MAC_NEW_CHANNEL_ANS, macCmdPayload, 1 );
-                break;
-            }
-            case SRV_MAC_RX_TIMING_SETUP_REQ:
-            {
-                uint8_t delay = payload[macIndex++] & 0x0F;
+static void ProcessSrvMacBeaconTimingAns( SrvMacCmd_t* cmd )
+{
+    uint16_t beaconTimingDelay = 0;
+    uint8_t beaconTimingChannel = 0;
 
-                if( delay == 0 )
-                {
-                    delay++;
-                }
-                MacCtx.NvmCtx->MacParams.ReceiveDelay1 = delay * 1000;
-                MacCtx.NvmCtx->MacParams.ReceiveDelay2 = MacCtx.NvmCtx->MacParams.ReceiveDelay1 + 1000;
-                LoRaMacCommandsAddCmd( MOTE_MAC_RX_TIMING_SETUP_ANS, macCmdPayload, 0 );
-                // Setup indication to inform the application
-                SetMlmeScheduleUplinkIndication( );
-                break;
-            }
-            case SRV_MAC_TX_PARAM_SETUP_REQ:
-            {
-                TxParamSetupReqParams_t txParamSetupReq;
-                GetPhyParams_t getPhy;
-                PhyParam_t phyParam;
-                uint8_t eirpDwellTime = payload[macIndex++];
+    beaconTimingDelay = ( uint16_t )cmd->Payload[0];
+    beaconTimingDelay |= ( uint16_t )cmd->Payload[1] << 8;
+    beaconTimingChannel = cmd->Payload[2];
 
-                txParamSetupReq.UplinkDwellTime = 0;
-                txParamSetupReq.DownlinkDwellTime = 0;
+    LoRaMacClassBBeaconTimingAns( beaconTimingDelay, beaconTimingChannel, RxDoneParams.LastRxDone );
+}
 
-                if( ( eirpDwellTime & 0x20 ) == 0x20 )
-                {
-                    txParamSetupReq.DownlinkDwellTime = 1;
-                }
-                if( ( eirpDwellTime & 0x10 ) == 0x10 )
-                {
-                    txParamSetupReq.UplinkDwellTime = 1;
-                }
-                txParamSetupReq.MaxEirp = eirpDwellTime & 0x0F;
+static void ProcessSrvMacBeaconFreqReq( SrvMacCmd_t* cmd )
+{
+    uint32_t frequency = 0;
+    uint8_t status;
 
-                // Check the status for correctness
-                if( RegionTxParamSetupReq( MacCtx.NvmCtx->Region, &txParamSetupReq ) != -1 )
-                {
-                    // Accept command
-                    MacCtx.NvmCtx->MacParams.UplinkDwellTime = txParamSetupReq.UplinkDwellTime;
-                    MacCtx.NvmCtx->MacParams.DownlinkDwellTime = txParamSetupReq.DownlinkDwellTime;
-                    MacCtx.NvmCtx->MacParams.MaxEirp = LoRaMacMaxEirpTable[txParamSetupReq.MaxEirp];
-                    // Update the datarate in case of the new configuration limits it
-                    getPhy.Attribute = PHY_MIN_TX_DR;
-                    getPhy.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
-                    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-                    MacCtx.NvmCtx->MacParams.ChannelsDatarate = MAX( MacCtx.NvmCtx->MacParams.ChannelsDatarate, ( int8_t )phyParam.Value );
-
-                    // Add command response
-                    LoRaMacCommandsAddCmd( MOTE_MAC_TX_PARAM_SETUP_ANS, macCmdPayload, 0 );
-                }
-                break;
-            }
-            case SRV_MAC_DL_CHANNEL_REQ:
-            {
-                DlChannelReqParams_t dlChannelReq;
-                status = 0x03;
-
-                dlChannelReq.ChannelId = payload[macIndex++];
-                dlChannelReq.Rx1Frequency = ( uint32_t ) payload[macIndex++];
-                dlChannelReq.Rx1Frequency |= ( uint32_t ) payload[macIndex++] << 8;
-                dlChannelReq.Rx1Frequency |= ( uint32_t ) payload[macIndex++] << 16;
-                dlChannelReq.Rx1Frequency *= 100;
-
-                status = RegionDlChannelReq( MacCtx.NvmCtx->Region, &dlChannelReq );
-                macCmdPayload[0] = status;
-                LoRaMacCommandsAddCmd( MOTE_MAC_DL_CHANNEL_ANS, macCmdPayload, 1 );
-                // Setup indication to inform the application
-                SetMlmeScheduleUplinkIndication( );
-                break;
-            }
-            case SRV_MAC_DEVICE_TIME_ANS:
-            {
-                SysTime_t gpsEpochTime = { 0 };
-                SysTime_t sysTime = { 0 };
-                SysTime_t sysTimeCurrent = { 0 };
-
-                gpsEpochTime.Seconds = ( uint32_t )payload[macIndex++];
-                gpsEpochTime.Seconds |= ( uint32_t )payload[macIndex++] << 8;
-                gpsEpochTime.Seconds |= ( uint32_t )payload[macIndex++] << 16;
-                gpsEpochTime.Seconds |= ( uint32_t )payload[macIndex++] << 24;
-                gpsEpochTime.SubSeconds = payload[macIndex++];
-
-                // Convert the fractional second received in ms
-                // round( pow( 0.5, 8.0 ) * 1000 ) = 3.90625
-                gpsEpochTime.SubSeconds = ( int16_t )( ( ( int32_t )gpsEpochTime.SubSeconds * 1000 ) >> 8 );
-
-                // Copy received GPS Epoch time into system time
-                sysTime = gpsEpochTime;
-                // Add Unix to Gps epcoh offset. The system time is based on Unix time.
-                sysTime.Seconds += UNIX_GPS_EPOCH_OFFSET;
-
-                // Compensate time difference between Tx Done time and now
-                sysTimeCurrent = SysTimeGet( );
-                sysTime = SysTimeAdd( sysTimeCurrent, SysTimeSub( sysTime, MacCtx.LastTxSysTime ) );
-
-                // Apply the new system time.
-                SysTimeSet( sysTime );
-                LoRaMacClassBDeviceTimeAns( );
-                MacCtx.McpsIndication.DeviceTimeAnsReceived = true;
-                break;
-            }
-            case SRV_MAC_PING_SLOT_INFO_ANS:
-            {
-                // According to the specification, it is not allowed to process this answer in
-                // a ping or multicast slot
-                if( ( MacCtx.RxSlot != RX_SLOT_WIN_CLASS_B_PING_SLOT ) && ( MacCtx.RxSlot != RX_SLOT_WIN_CLASS_B_MULTICAST_SLOT ) )
-                {
-                    LoRaMacClassBPingSlotInfoAns( );
-                }
-                break;
-            }
-            case SRV_MAC_PING_SLOT_CHANNEL_REQ:
-            {
-                uint8_t status = 0x03;
-                uint32_t frequency = 0;
-                uint8_t datarate;
-
-                frequency = ( uint32_t )payload[macIndex++];
-                frequency |= ( uint32_t )payload[macIndex++] << 8;
-                frequency |= ( uint32_t )payload[macIndex++] << 16;
-                frequency *= 100;
-                datarate = payload[macIndex++] & 0x0F;
-
-                status = LoRaMacClassBPingSlotChannelReq( datarate, frequency );
-                macCmdPayload[0] = status;
-                LoRaMacCommandsAddCmd( MOTE_MAC_PING_SLOT_FREQ_ANS, macCmdPayload, 1 );
-                break;
-            }
-            case SRV_MAC_BEACON_TIMING_ANS:
-            {
-                uint16_t beaconTimingDelay = 0;
-                uint8_t beaconTimingChannel = 0;
+    frequency = ( uint32_t )cmd->Payload[0];
+    frequency |= ( uint32_t )cmd->Payload[1] << 8;
+    frequency |= ( uint32_t )cmd->Payload[2] << 16;
+    frequency *= 100;
 
-                beaconTimingDelay = ( uint16_t )payload[macIndex++];
-                beaconTimingDelay |= ( uint16_t )payload[macIndex++] << 8;
-                beaconTimingChannel = payload[macIndex++];
+    if( LoRaMacClassBBeaconFreqReq( frequency ) == true )
+    {
+        status = 1;
+    }
+    else
+    {
+        status = 0;
+    }
+    LoRaMacCommandsAddCmd( MOTE_MAC_BEACON_FREQ_ANS, &status, 1 );
+}
 
-                LoRaMacClassBBeaconTimingAns( beaconTimingDelay, beaconTimingChannel, RxDoneParams.LastRxDone );
-                break;
-            }
-            case SRV_MAC_BEACON_FREQ_REQ:
-                {
-                    uint32_t frequency = 0;
+/*!
+ * Descriptors of the network server MAC commands, indexed by CID
+ */
+static const SrvMacCmdDesc_t SrvMacCmdDescs[SRV_MAC_BEACON_FREQ_REQ + 1] =
+{
+    [SRV_MAC_LINK_CHECK_ANS]        = { 2, ProcessSrvMacLinkCheckAns },
+    [SRV_MAC_LINK_ADR_REQ]          = { 4, ProcessSrvMacLinkAdrReq },
+    [SRV_MAC_DUTY_CYCLE_REQ]        = { 1, ProcessSrvMacDutyCycleReq },
+    [SRV_MAC_RX_PARAM_SETUP_REQ]    = { 4, ProcessSrvMacRxParamSetupReq },
+    [SRV_MAC_DEV_STATUS_REQ]        = { 0, ProcessSrvMacDevStatusReq },
+    [SRV_MAC_NEW_CHANNEL_REQ]       = { 5, ProcessSrvMacNewChannelReq },
+    [SRV_MAC_RX_TIMING_SETUP_REQ]   = { 1, ProcessSrvMacRxTimingSetupReq },
+    [SRV_MAC_TX_PARAM_SETUP_REQ]    = { 1, ProcessSrvMacTxParamSetupReq },
+    [SRV_MAC_DL_CHANNEL_REQ]        = { 4, ProcessSrvMacDlChannelReq },
+    [SRV_MAC_DEVICE_TIME_ANS]       = { 5, ProcessSrvMacDeviceTimeAns },
+    [SRV_MAC_PING_SLOT_INFO_ANS]    = { 0, ProcessSrvMacPingSlotInfoAns },
+    [SRV_MAC_PING_SLOT_CHANNEL_REQ] = { 4, ProcessSrvMacPingSlotChannelReq },
+    [SRV_MAC_BEACON_TIMING_ANS]     = { 3, ProcessSrvMacBeaconTimingAns },
+    [SRV_MAC_BEACON_FREQ_REQ]       = { 3, ProcessSrvMacBeaconFreqReq },
+};
 
-                    frequency = ( uint32_t )payload[macIndex++];
-                    frequency |= ( uint32_t )payload[macIndex++] << 8;
-                    frequency |= ( uint32_t )payload[macIndex++] << 16;
-                    frequency *= 100;
+static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t commandsSize, int8_t snr, LoRaMacRxSlot_t rxSlot )
+{
+    const SrvMacCmdDesc_t* desc;
+    SrvMacCmd_t cmd;
 
-                    if( LoRaMacClassBBeaconFreqReq( frequency ) == true )
-                    {
-                        macCmdPayload[0] = 1;
-                    }
-                    else
-                    {
-                        macCmdPayload[0] = 0;
-                    }
-                    LoRaMacCommandsAddCmd( MOTE_MAC_BEACON_FREQ_ANS, macCmdPayload, 1 );
-                }
-                break;
-            default:
-                // Unknown command. ABORT MAC commands processing
-                return;
+    cmd.Snr = snr;
+    cmd.AdrBlockFound = false;
+
+    while( macIndex < commandsSize )
+    {
+        // Unknown or truncated command. ABORT MAC commands processing
+        if( payload[macIndex] >= ( sizeof( SrvMacCmdDescs ) / sizeof( SrvMacCmdDescs[0] ) ) )
+        {
+            return;
+        }
+        desc = &SrvMacCmdDescs[payload[macIndex]];
+        if( ( desc->Handler == NULL ) || ( ( macIndex + 1 + desc->PayloadSize ) > commandsSize ) )
+        {
+            return;
         }
+
+        // Every command consumes its full payload, whatever its handler reads
+        cmd.Payload = &payload[macIndex + 1];
+        cmd.RemainingSize = commandsSize - macIndex;
+        cmd.Size = 1 + desc->PayloadSize;
+        desc->Handler( &cmd );
+        macIndex += cmd.Size;
     }
 }
 
@@ -2303,7 +2747,13 @@ LoRaMacStatus_t Send( LoRaMacHeader_t* macHdr, uint8_t fPort, void* fBuffer, uin
                                                &MacCtx.NvmCtx->MacParams.ChannelsTxPower, &adrAckCounter );
 
     // Prepare the frame
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+    uint32_t latencyStart = LatencyProbeStart( );
     status = PrepareFrame( macHdr, &fCtrl, fPort, fBuffer, fBufferSize );
+    LatencyProbeStop( LORAMAC_LATENCY_PREPARE_FRAME, latencyStart );
+#else
+    status = PrepareFrame( macHdr, &fCtrl, fPort, fBuffer, fBufferSize );
+#endif
 
     // Validate status
     if( ( status == LORAMAC_STATUS_OK ) || ( status == LORAMAC_STATUS_SKIPPED_APP_DATA ) )
@@ -2419,17 +2869,23 @@ static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
         }
     }
 
+#ifdef LORAMAC_RX_TIMING_CALIBRATION_ENABLED
+    uint32_t rxError = GetRxTimingError( );
+#else
+    uint32_t rxError = MacCtx.NvmCtx->MacParams.SystemMaxRxError;
+#endif
+
     // Compute Rx1 windows parameters
     RegionComputeRxWindowParameters( MacCtx.NvmCtx->Region,
                                      RegionApplyDrOffset( MacCtx.NvmCtx->Region, MacCtx.NvmCtx->MacParams.DownlinkDwellTime, MacCtx.NvmCtx->MacParams.ChannelsDatarate, MacCtx.NvmCtx->MacParams.Rx1DrOffset ),
                                      MacCtx.NvmCtx->MacParams.MinRxSymbols,
-                                     MacCtx.NvmCtx->MacParams.SystemMaxRxError,
+                                     rxError,
                                      &MacCtx.RxWindow1Config );
     // Compute Rx2 windows parameters
     RegionComputeRxWindowParameters( MacCtx.NvmCtx->Region,
                                      MacCtx.NvmCtx->MacParams.Rx2Channel.Datarate,
                                      MacCtx.NvmCtx->MacParams.MinRxSymbols,
-                                     MacCtx.NvmCtx->MacParams.SystemMaxRxError,
+                                     rxError,
                                      &MacCtx.RxWindow2Config );
 
     if( MacCtx.NvmCtx->NetworkActivation == ACTIVATION_TYPE_NONE )
@@ -2452,15 +2908,39 @@ static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
         MacCtx.RxWindow2Delay = MacCtx.NvmCtx->MacParams.ReceiveDelay2 + MacCtx.RxWindow2Config.WindowOffset;
     }
 
+#ifdef LORAMAC_RX_TIMING_CALIBRATION_ENABLED
+    // Center the windows on the learned arrival time
+    MacCtx.RxTimingCorrection = 0;
+    if( MacCtx.NvmCtx->RxTimingSamples >= LORAMAC_RX_TIMING_MIN_SAMPLES )
+    {
+        MacCtx.RxTimingCorrection = ( MacCtx.NvmCtx->RxTimingErrorMean + 8 ) >> 4;
+    }
+    MacCtx.RxWindow1Delay += MacCtx.RxTimingCorrection;
+    MacCtx.RxWindow2Delay += MacCtx.RxTimingCorrection;
+#endif
+
     // Secure frame
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+    uint32_t latencyStart = LatencyProbeStart( );
     LoRaMacStatus_t retval = SecureFrame( MacCtx.NvmCtx->MacParams.ChannelsDatarate, MacCtx.Channel );
+    LatencyProbeStop( LORAMAC_LATENCY_SECURE_FRAME, latencyStart );
+#else
+    LoRaMacStatus_t retval = SecureFrame( MacCtx.NvmCtx->MacParams.ChannelsDatarate, MacCtx.Channel );
+#endif
     if( retval != LORAMAC_STATUS_OK )
     {
         return retval;
     }
 
     // Try to send now
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+    latencyStart = LatencyProbeStart( );
+    retval = SendFrameOnChannel( MacCtx.Channel );
+    LatencyProbeStop( LORAMAC_LATENCY_SEND_FRAME_ON_CHANNEL, latencyStart );
+    return retval;
+#else
     return SendFrameOnChannel( MacCtx.Channel );
+#endif
 }
 
 static LoRaMacStatus_t SecureFrame( uint8_t txDr, uint8_t txCh )
@@ -2488,9 +2968,14 @@ static LoRaMacStatus_t SecureFrame( uint8_t txDr, uint8_t txCh )
             if( ( MacCtx.ChannelsNbTransCounter >= 1 ) || ( MacCtx.AckTimeoutRetriesCounter > 1 ) )
             {
                 fCntUp -= 1;
-            }
 
-            macCryptoStatus = LoRaMacCryptoSecureMessage( fCntUp, txDr, txCh, &MacCtx.TxMsg.Message.Data );
+                // Same frame again, keep its encryption and serialization
+                macCryptoStatus = LoRaMacCryptoSecureRetransmission( fCntUp, txDr, txCh, &MacCtx.TxMsg.Message.Data );
+            }
+            else
+            {
+                macCryptoStatus = LoRaMacCryptoSecureMessage( fCntUp, txDr, txCh, &MacCtx.TxMsg.Message.Data );
+            }
             if( LORAMAC_CRYPTO_SUCCESS != macCryptoStatus )
             {
                 return LORAMAC_STATUS_CRYPTO_ERROR;
@@ -2562,6 +3047,9 @@ static void ResetMacParameters( void )
 
     // ADR counter
     MacCtx.NvmCtx->AdrAckCounter = 0;
+#ifdef LORAMAC_ADR_LINK_MARGIN_ENABLED
+    LoRaMacAdrResetLinkHistory( );
+#endif
 
     MacCtx.ChannelsNbTransCounter = 0;
     MacCtx.AckTimeoutRetries = 1;
@@ -2612,6 +3100,9 @@ static void ResetMacParameters( void )
 static void RxWindowSetup( TimerEvent_t* rxTimer, RxConfigParams_t* rxConfig )
 {
     TimerStop( rxTimer );
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+    StopRxCSniff( );
+#endif
 
     // Ensure the radio is Idle
     Radio.Standby( );
@@ -2625,6 +3116,32 @@ static void RxWindowSetup( TimerEvent_t* rxTimer, RxConfigParams_t* rxConfig )
 
 static void OpenContinuousRxCWindow( void )
 {
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+    if( MacCtx.RxCSniffState != RXC_SNIFF_IDLE )
+    {
+        // The sniff cycle is already running
+        return;
+    }
+    MacCtx.RxWindowCConfig.RxSlot = RX_SLOT_WIN_CLASS_C;
+    // Each detected preamble is received in single mode
+    MacCtx.RxWindowCConfig.RxContinuous = false;
+
+    if( RegionRxConfig( MacCtx.NvmCtx->Region, &MacCtx.RxWindowCConfig, ( int8_t* )&MacCtx.McpsIndication.RxDatarate ) == true )
+    {
+        if( Radio.SetRxDutyCycle != NULL )
+        {
+            // The radio alternates listening and sleeping by itself. Steps of 15.625 us.
+            Radio.SetRxDutyCycle( LORAMAC_CLASS_C_SNIFF_RX_TIME << 6, ( LORAMAC_CLASS_C_SNIFF_PERIOD - LORAMAC_CLASS_C_SNIFF_RX_TIME ) << 6 );
+            MacCtx.RxCSniffState = RXC_SNIFF_RX;
+        }
+        else
+        {
+            Radio.StartCad( );
+            MacCtx.RxCSniffState = RXC_SNIFF_CAD;
+        }
+        MacCtx.RxSlot = MacCtx.RxWindowCConfig.RxSlot;
+    }
+#else
     MacCtx.RxWindowCConfig.RxSlot = RX_SLOT_WIN_CLASS_C;
     // Setup continuous listening
     MacCtx.RxWindowCConfig.RxContinuous = true;
@@ -2636,7 +3153,136 @@ static void OpenContinuousRxCWindow( void )
         Radio.Rx( 0 ); // Continuous mode
         MacCtx.RxSlot = MacCtx.RxWindowCConfig.RxSlot;
     }
+#endif
+}
+
+#ifdef LORAMAC_RX_TIMING_CALIBRATION_ENABLED
+static uint32_t GetRxTimingError( void )
+{
+    uint32_t rxError;
+
+    // Until enough downlinks were timed, the static system error applies
+    if( MacCtx.NvmCtx->RxTimingSamples < LORAMAC_RX_TIMING_MIN_SAMPLES )
+    {
+        return MacCtx.NvmCtx->MacParams.SystemMaxRxError;
+    }
+
+    // Two mean deviations plus the 1 ms resolution of the timestamps
+    rxError = ( ( ( uint32_t )MacCtx.NvmCtx->RxTimingErrorDev * 2 ) + 16 + 15 ) >> 4;
+    rxError = MAX( rxError, LORAMAC_RX_TIMING_MIN_ERROR );
+
+    return MIN( rxError, MacCtx.NvmCtx->MacParams.SystemMaxRxError );
+}
+
+static void UpdateRxTiming( uint16_t size )
+{
+    int32_t nominalDelay;
+    int32_t error;
+    uint16_t deviation;
+
+    // The expected arrival time is only known for the class A windows
+    if( MacCtx.RxSlot == RX_SLOT_WIN_1 )
+    {
+        nominalDelay = ( int32_t )MacCtx.RxWindow1Delay - MacCtx.RxWindow1Config.WindowOffset;
+    }
+    else if( MacCtx.RxSlot == RX_SLOT_WIN_2 )
+    {
+        nominalDelay = ( int32_t )MacCtx.RxWindow2Delay - MacCtx.RxWindow2Config.WindowOffset;
+    }
+    else
+    {
+        return;
+    }
+    nominalDelay -= MacCtx.RxTimingCorrection;
+
+    // The preamble starts ReceiveDelay after TxDone, the RxDone comes a time on air later
+    error = ( int32_t )( RxDoneParams.LastRxDone - TxDoneParams.CurTime ) - nominalDelay -
+            ( int32_t )Radio.TimeOnAir( MODEM_LORA, size );
+
+    // Discard what the static error would not have caught either, e.g. FSK frames
+    if( ( error > ( int32_t )MacCtx.NvmCtx->MacParams.SystemMaxRxError ) ||
+        ( error < -( int32_t )MacCtx.NvmCtx->MacParams.SystemMaxRxError ) )
+    {
+        return;
+    }
+
+    // Exponential averages with a 1/8 weight, in 1/16 ms
+    error <<= 4;
+    if( MacCtx.NvmCtx->RxTimingSamples == 0 )
+    {
+        MacCtx.NvmCtx->RxTimingErrorMean = error;
+        MacCtx.NvmCtx->RxTimingErrorDev = 0;
+    }
+    else
+    {
+        deviation = ( uint16_t )( ( error > MacCtx.NvmCtx->RxTimingErrorMean ) ? ( error - MacCtx.NvmCtx->RxTimingErrorMean ) : ( MacCtx.NvmCtx->RxTimingErrorMean - error ) );
+        MacCtx.NvmCtx->RxTimingErrorMean += ( error - MacCtx.NvmCtx->RxTimingErrorMean ) / 8;
+        MacCtx.NvmCtx->RxTimingErrorDev = ( int32_t )MacCtx.NvmCtx->RxTimingErrorDev +
+                                          ( ( int32_t )deviation - ( int32_t )MacCtx.NvmCtx->RxTimingErrorDev ) / 8;
+    }
+    if( MacCtx.NvmCtx->RxTimingSamples < LORAMAC_RX_TIMING_MIN_SAMPLES )
+    {
+        MacCtx.NvmCtx->RxTimingSamples++;
+    }
+}
+#endif
+
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+static uint32_t LatencyProbeStart( void )
+{
+    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->GetCycleCount != NULL ) )
+    {
+        return MacCtx.MacCallbacks->GetCycleCount( );
+    }
+    return 0;
+}
+
+static void LatencyProbeStop( LoRaMacLatencyStage_t stage, uint32_t start )
+{
+    LoRaMacLatencyStats_t* stats = &MacCtx.LatencyStats[stage];
+    uint32_t cycles = LatencyProbeStart( ) - start;
+
+    stats->Count++;
+    stats->Last = cycles;
+    if( cycles > stats->Max )
+    {
+        stats->Max = cycles;
+    }
+}
+#endif
+
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+static void OnRxCSniffTimerEvent( void* context )
+{
+    TimerStop( &MacCtx.RxCSniffTimer );
+
+    if( MacCtx.RxCSniffState != RXC_SNIFF_SLEEP )
+    {
+        return;
+    }
+
+    if( RegionRxConfig( MacCtx.NvmCtx->Region, &MacCtx.RxWindowCConfig, ( int8_t* )&MacCtx.McpsIndication.RxDatarate ) == true )
+    {
+        Radio.StartCad( );
+        MacCtx.RxCSniffState = RXC_SNIFF_CAD;
+    }
+    else
+    {
+        // Let LoRaMacProcess restart the cycle
+        MacCtx.RxCSniffState = RXC_SNIFF_IDLE;
+        if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
+        {
+            MacCtx.MacCallbacks->MacProcessNotify( );
+        }
+    }
+}
+
+static void StopRxCSniff( void )
+{
+    TimerStop( &MacCtx.RxCSniffTimer );
+    MacCtx.RxCSniffState = RXC_SNIFF_IDLE;
 }
+#endif
 
 LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl, uint8_t fPort, void* fBuffer, uint16_t fBufferSize )
 {
@@ -2807,6 +3453,10 @@ LoRaMacStatus_t SendFrameOnChannel( uint8_t channel )
         MacCtx.ChannelsNbTransCounter++;
     }
 
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+    StopRxCSniff( );
+#endif
+
     // Send now
     Radio.Send( MacCtx.PktBuffer, MacCtx.PktBufferLen );
 
@@ -2869,6 +3519,7 @@ LoRaMacStatus_t RestoreCtxs( LoRaMacCtxs_t* contexts )
     if( contexts->MacNvmCtx != NULL )
     {
         memcpy1( ( uint8_t* ) &NvmMacCtx, ( uint8_t* ) contexts->MacNvmCtx, contexts->MacNvmCtxSize );
+        McAddrIndexRebuild( );
     }
 
     InitDefaultsParams_t params;
@@ -3011,6 +3662,13 @@ static bool StopRetransmission( void )
         {
             MacCtx.NvmCtx->AdrAckCounter++;
         }
+#ifdef LORAMAC_ADR_LINK_MARGIN_ENABLED
+        else
+        {
+            // The link margin ADR detects a lost link with its own counter
+            LoRaMacAdrAddLostUplink( );
+        }
+#endif
     }
 
     MacCtx.ChannelsNbTransCounter = 0;
@@ -3260,6 +3918,9 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
     TimerInit( &MacCtx.RxWindowTimer1, OnRxWindow1TimerEvent );
     TimerInit( &MacCtx.RxWindowTimer2, OnRxWindow2TimerEvent );
     TimerInit( &MacCtx.AckTimeoutTimer, OnAckTimeoutTimerEvent );
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+    TimerInit( &MacCtx.RxCSniffTimer, OnRxCSniffTimerEvent );
+#endif
 
     // Store the current initialization time
     MacCtx.NvmCtx->InitializationTime = TimerGetCurrentTime( );
@@ -3270,6 +3931,10 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
     MacCtx.RadioEvents.RxError = OnRadioRxError;
     MacCtx.RadioEvents.TxTimeout = OnRadioTxTimeout;
     MacCtx.RadioEvents.RxTimeout = OnRadioRxTimeout;
+    MacCtx.RadioEvents.IrqNotify = OnRadioIrqNotify;
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+    MacCtx.RadioEvents.CadDone = OnRadioCadDone;
+#endif
     Radio.Init( &MacCtx.RadioEvents );
 
     InitDefaultsParams_t params;
@@ -3589,6 +4254,32 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
             mibGet->Param.DefaultAntennaGain = MacCtx.NvmCtx->MacParamsDefaults.AntennaGain;
             break;
         }
+#ifdef ENERGY_MONITOR_ENABLED
+        case MIB_ENERGY_STATS:
+        {
+            mibGet->Param.EnergyStats = EM_GetStats( );
+            break;
+        }
+#endif
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+        case MIB_LATENCY_STATS:
+        {
+            mibGet->Param.LatencyStats = MacCtx.LatencyStats;
+            break;
+        }
+#endif
+#ifdef STACK_MONITOR_ENABLED
+        case MIB_STACK_HIGH_WATER_MARK:
+        {
+            if( ( MacCtx.MacCallbacks == NULL ) || ( MacCtx.MacCallbacks->GetStackHighWaterMark == NULL ) )
+            {
+                status = LORAMAC_STATUS_SERVICE_UNKNOWN;
+                break;
+            }
+            mibGet->Param.StackHighWaterMark = MacCtx.MacCallbacks->GetStackHighWaterMark( );
+            break;
+        }
+#endif
         default:
         {
             status = LoRaMacClassBMibGetRequestConfirm( mibGet );
@@ -4313,9 +5004,9 @@ LoRaMacStatus_t LoRaMacMcChannelSetup( McChannelParams_t *channel )
     }
 
     MacCtx.NvmCtx->MulticastChannelList[channel->GroupID].ChannelParams = *channel;
+    McAddrIndexRebuild( );
 
-    const KeyIdentifier_t mcKeys[LORAMAC_MAX_MC_CTX] = { MC_KEY_0, MC_KEY_1, MC_KEY_2, MC_KEY_3 };
-    if( LoRaMacCryptoSetKey( mcKeys[channel->GroupID], channel->McKeyE ) != LORAMAC_CRYPTO_SUCCESS )
+    if( LoRaMacCryptoSetKey( MC_KEY( channel->GroupID ), channel->McKeyE ) != LORAMAC_CRYPTO_SUCCESS )
     {
         return LORAMAC_STATUS_CRYPTO_ERROR;
     }
@@ -4355,6 +5046,7 @@ LoRaMacStatus_t LoRaMacMcChannelDelete( AddressIdentifier_t groupID )
     memset1( ( uint8_t* )&channel, 0, sizeof( McChannelParams_t ) );
 
     MacCtx.NvmCtx->MulticastChannelList[groupID].ChannelParams = channel;
+    McAddrIndexRebuild( );
 
     EventMacNvmCtxChanged( );
     EventRegionNvmCtxChanged( );
@@ -4363,14 +5055,13 @@ LoRaMacStatus_t LoRaMacMcChannelDelete( AddressIdentifier_t groupID )
 
 uint8_t LoRaMacMcChannelGetGroupId( uint32_t mcAddress )
 {
-    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    uint8_t groupID = McAddrIndexFind( mcAddress );
+
+    if( groupID >= LORAMAC_MAX_MC_CTX )
     {
-        if( mcAddress == MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.Address )
-        {
-            return i;
-        }
+        return 0xFF;
     }
-    return 0xFF;
+    return groupID;
 }
 
 LoRaMacStatus_t LoRaMacMcChannelSetupRxParams( AddressIdentifier_t groupID, McRxParams_t *rxParams, uint8_t *status )
@@ -4683,7 +5374,13 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t* mcpsRequest )
             }
         }
 
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+        uint32_t latencyStart = LatencyProbeStart( );
         status = Send( &macHdr, fPort, fBuffer, fBufferSize );
+        LatencyProbeStop( LORAMAC_LATENCY_SEND, latencyStart );
+#else
+        status = Send( &macHdr, fPort, fBuffer, fBufferSize );
+#endif
         if( status == LORAMAC_STATUS_OK )
         {
             MacCtx.McpsConfirm.McpsRequest = mcpsRequest->Type;
@@ -128,6 +128,9 @@
 #include "systime.h"
 #include "radio.h"
 #include "LoRaMacTypes.h"
+#ifdef ENERGY_MONITOR_ENABLED
+#include "energy_monitor.h"
+#endif
 
 /*!
  * Maximum number of times the MAC layer tries to get an acknowledge.
@@ -163,14 +166,123 @@
 #define LORA_MAC_FRMPAYLOAD_OVERHEAD                13 // MHDR(1) + FHDR(7) + Port(1) + MIC(4)
 
 /*!
- * Maximum number of multicast context
+ * Start value for multicast keys enumeration
  */
-#define   LORAMAC_MAX_MC_CTX       4
+#define LORAMAC_CRYPTO_MULTICAST_KEYS   127
 
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
 /*!
- * Start value for multicast keys enumeration
+ * Class C sniff mode: instead of listening continuously, the radio wakes up
+ * every LORAMAC_CLASS_C_SNIFF_PERIOD to look for a preamble, using the RX duty
+ * cycle of the radio when available (SX126x) or a CAD otherwise.
+ *
+ * \remark The network server must send the class C downlinks with a preamble
+ *         lasting at least LORAMAC_CLASS_C_SNIFF_PERIOD plus
+ *         LORAMAC_CLASS_C_SNIFF_RX_TIME, otherwise they are missed. With
+ *         CAD, the preamble must also cover the CAD and the symbols the
+ *         receiver needs to lock, about 7 symbols (1300 ms at SF12/125 kHz).
  */
-#define LORAMAC_CRYPTO_MULTICAST_KEYS   127
+
+/*!
+ * Period between two preamble detections [ms]
+ */
+#ifndef LORAMAC_CLASS_C_SNIFF_PERIOD
+#define LORAMAC_CLASS_C_SNIFF_PERIOD                1000
+#endif
+
+/*!
+ * Listening time of a RX duty cycle period [ms]. Covers two symbols at SF12/125 kHz.
+ */
+#ifndef LORAMAC_CLASS_C_SNIFF_RX_TIME
+#define LORAMAC_CLASS_C_SNIFF_RX_TIME               70
+#endif
+#endif /* LORAMAC_CLASS_C_SNIFF_ENABLED */
+
+#ifdef LORAMAC_RX_TIMING_CALIBRATION_ENABLED
+/*!
+ * RX timing calibration: the MAC measures the arrival time of the RX1/RX2
+ * downlinks against their expected time and sizes the RX windows from the
+ * learned timing error instead of the static SystemMaxRxError, which stays
+ * the upper bound.
+ */
+
+/*!
+ * Number of timed downlinks before the learned timing error is used
+ */
+#ifndef LORAMAC_RX_TIMING_MIN_SAMPLES
+#define LORAMAC_RX_TIMING_MIN_SAMPLES               4
+#endif
+
+/*!
+ * Lower bound of the learned timing error [ms]
+ */
+#ifndef LORAMAC_RX_TIMING_MIN_ERROR
+#define LORAMAC_RX_TIMING_MIN_ERROR                 3
+#endif
+#endif /* LORAMAC_RX_TIMING_CALIBRATION_ENABLED */
+
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+/*!
+ * MAC processing stages measured by the latency probes
+ */
+typedef enum eLoRaMacLatencyStage
+{
+    /*!
+     * Send, from the MCPS request up to the radio TX start
+     */
+    LORAMAC_LATENCY_SEND,
+    /*!
+     * Uplink frame preparation, including the MAC commands serialization
+     */
+    LORAMAC_LATENCY_PREPARE_FRAME,
+    /*!
+     * Uplink frame encryption and MIC computation
+     */
+    LORAMAC_LATENCY_SECURE_FRAME,
+    /*!
+     * Radio TX configuration and start
+     */
+    LORAMAC_LATENCY_SEND_FRAME_ON_CHANNEL,
+    /*!
+     * Processing of a received frame, up to the indications
+     */
+    LORAMAC_LATENCY_RX_DONE,
+    /*!
+     * Join accept decryption and MIC verification
+     */
+    LORAMAC_LATENCY_RX_JOIN_ACCEPT,
+    /*!
+     * Downlink MIC verification and decryption
+     */
+    LORAMAC_LATENCY_RX_UNSECURE,
+    /*!
+     * Retransmission of an uplink, from the retry decision up to the radio
+     * TX start or the duty cycle delay
+     */
+    LORAMAC_LATENCY_RETRANSMISSION,
+    LORAMAC_LATENCY_STAGE_NB
+}LoRaMacLatencyStage_t;
+
+/*!
+ * Latency of a MAC processing stage, in cycles of the counter provided by
+ * LoRaMacCallback_t::GetCycleCount
+ */
+typedef struct sLoRaMacLatencyStats
+{
+    /*!
+     * Number of measurements
+     */
+    uint32_t Count;
+    /*!
+     * Last measurement
+     */
+    uint32_t Last;
+    /*!
+     * Maximum measurement
+     */
+    uint32_t Max;
+}LoRaMacLatencyStats_t;
+#endif /* LORAMAC_LATENCY_PROBES_ENABLED */
 
 /*!
  * End-Device activation type
@@ -1274,6 +1386,9 @@ typedef struct sMlmeIndication
  * \ref MIB_DEFAULT_ANTENNA_GAIN                 | YES | YES
  * \ref MIB_NVM_CTXS                             | YES | YES
  * \ref MIB_ABP_LORAWAN_VERSION                  | YES | YES
+ * \ref MIB_LATENCY_STATS                        | YES | NO
+ * \ref MIB_ENERGY_STATS                         | YES | NO
+ * \ref MIB_STACK_HIGH_WATER_MARK                | YES | NO
  *
  * The following table provides links to the function implementations of the
  * related MIB primitives:
@@ -1688,6 +1803,24 @@ typedef enum eMib
      * The allowed ranges are region specific. Please refer to \ref DR_0 to \ref DR_15 for details.
      */
      MIB_PING_SLOT_DATARATE,
+    /*!
+     * Latency of the MAC processing stages, indexed by \ref LoRaMacLatencyStage_t
+     *
+     * \remark Available when LORAMAC_LATENCY_PROBES_ENABLED is defined.
+     */
+    MIB_LATENCY_STATS,
+    /*!
+     * Time spent in each MCU and radio power state and estimated charge.
+     *
+     * \remark Available when ENERGY_MONITOR_ENABLED is defined.
+     */
+    MIB_ENERGY_STATS,
+    /*!
+     * Largest stack usage seen since reset, in bytes
+     *
+     * \remark Available when STACK_MONITOR_ENABLED is defined.
+     */
+    MIB_STACK_HIGH_WATER_MARK,
 }Mib_t;
 
 /*!
@@ -2025,6 +2158,30 @@ typedef union uMibParam
      * Related MIB type: \ref MIB_ABP_LORAWAN_VERSION
      */
     Version_t AbpLrWanVersion;
+#ifdef ENERGY_MONITOR_ENABLED
+    /*!
+     * Time spent in each MCU and radio power state and estimated charge.
+     *
+     * Related MIB type: \ref MIB_ENERGY_STATS
+     */
+    const EM_Stats_t* EnergyStats;
+#endif
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+    /*!
+     * Latency of the MAC processing stages, indexed by \ref LoRaMacLatencyStage_t
+     *
+     * Related MIB type: \ref MIB_LATENCY_STATS
+     */
+    const LoRaMacLatencyStats_t* LatencyStats;
+#endif
+#ifdef STACK_MONITOR_ENABLED
+    /*!
+     * Largest stack usage seen since reset, in bytes
+     *
+     * Related MIB type: \ref MIB_STACK_HIGH_WATER_MARK
+     */
+    uint32_t StackHighWaterMark;
+#endif
     /*!
      * Beacon interval in ms
      *
@@ -2392,6 +2549,21 @@ typedef struct sLoRaMacCallback
      *\warning  Runs in a IRQ context. Should only change variables state.
      */
     void ( *MacProcessNotify )( void );
+    /*!
+     *\brief    Reads a free running cycle counter, used by the latency probes
+     *          when LORAMAC_LATENCY_PROBES_ENABLED is defined. Optional.
+     *
+     *\retval   Cycle counter value
+     */
+    uint32_t ( *GetCycleCount )( void );
+    /*!
+     *\brief    Reads the stack high water mark, used by the
+     *          MIB_STACK_HIGH_WATER_MARK request when STACK_MONITOR_ENABLED
+     *          is defined. Optional.
+     *
+     *\retval   Largest stack usage seen since reset, in bytes
+     */
+    uint32_t ( *GetStackHighWaterMark )( void );
 }LoRaMacCallback_t;
 
 
@@ -2546,6 +2718,7 @@ LoRaMacStatus_t LoRaMacMcChannelDelete( AddressIdentifier_t groupID );
 
 /*!
  * \brief   LoRaMAC multicast channel get groupId from MC address.
+ *          Only enabled channels are looked up.
  *
  * \param   [IN]  mcAddress - Multicast address to be checked
  *
@@ -107,6 +107,216 @@ static bool CalcNextV10X( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* t
     return adrAckReq;
 }
 
+#ifdef LORAMAC_ADR_LINK_MARGIN_ENABLED
+/*!
+ * Ring of the recent link SNR measurements, brought back to 125 kHz [0.1 dB]
+ */
+static struct sLinkHistory
+{
+    int16_t Snr[LORAMAC_ADR_LINK_HISTORY_SIZE];
+    uint8_t Index;
+    uint8_t Count;
+    /*!
+     * Uplinks without a downlink since the last measurement
+     */
+    uint32_t LostUplinks;
+}LinkHistory;
+
+static void AddLinkSample( int16_t snr )
+{
+    LinkHistory.Snr[LinkHistory.Index] = snr;
+    LinkHistory.Index = ( LinkHistory.Index + 1 ) % LORAMAC_ADR_LINK_HISTORY_SIZE;
+    if( LinkHistory.Count < LORAMAC_ADR_LINK_HISTORY_SIZE )
+    {
+        LinkHistory.Count++;
+    }
+    LinkHistory.LostUplinks = 0;
+}
+
+static int16_t GetLinkSnr( void )
+{
+    // The worst recent measurement keeps the estimation on the safe side of fading
+    int16_t snr = LinkHistory.Snr[0];
+
+    for( uint8_t i = 1; i < LinkHistory.Count; i++ )
+    {
+        snr = MIN( snr, LinkHistory.Snr[i] );
+    }
+    return snr;
+}
+
+/*!
+ * Gets the SNR increase of a bandwidth over 125 kHz, the noise power growing
+ * with the bandwidth [0.1 dB]
+ */
+static int16_t GetBandwidthNoise( uint32_t bandwidth )
+{
+    int16_t noise = 0;
+
+    for( ; bandwidth > 125000; bandwidth >>= 1 )
+    {
+        noise += 30;
+    }
+    return noise;
+}
+
+/*!
+ * Gets the demodulation floor of a datarate from its spreading factor and
+ * bandwidth in the region, brought back to 125 kHz [0.1 dB]
+ *
+ * \retval false for the FSK datarates, which have no SNR floor
+ */
+static bool GetSnrFloor( LoRaMacRegion_t region, int8_t datarate, int16_t* snrFloor )
+{
+    GetPhyParams_t getPhy;
+    PhyParam_t phyParam;
+    uint32_t bandwidth;
+
+    getPhy.Attribute = PHY_BW_FROM_DR;
+    getPhy.Datarate = datarate;
+    phyParam = RegionGetPhyParam( region, &getPhy );
+    bandwidth = phyParam.Value;
+    if( bandwidth == 0 )
+    {
+        return false;
+    }
+
+    getPhy.Attribute = PHY_SF_FROM_DR;
+    phyParam = RegionGetPhyParam( region, &getPhy );
+    *snrFloor = LORAMAC_ADR_SNR_FLOOR_SF12 + ( ( 12 - ( int16_t )phyParam.Value ) * LORAMAC_ADR_SNR_FLOOR_SF_STEP ) +
+                GetBandwidthNoise( bandwidth );
+    return true;
+}
+
+static bool CalcNextLinkMargin( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* txPowOut, uint32_t* adrAckCounter )
+{
+    int8_t datarate;
+    int8_t maxDatarate;
+    int8_t txPower = TX_POWER_0;
+    int16_t linkSnr;
+    int16_t snrFloor;
+    int16_t headroom = 0;
+    bool fastest = true;
+    GetPhyParams_t getPhy;
+    PhyParam_t phyParam;
+    VerifyParams_t verify;
+
+    // The ADR ack counter belongs to the network ADR, it is left untouched
+    *adrAckCounter = adrNext->AdrAckCounter;
+
+    if( LinkHistory.LostUplinks >= adrNext->AdrAckLimit )
+    {
+        // The link is lost, the history no longer describes it
+        LinkHistory.Index = 0;
+        LinkHistory.Count = 0;
+    }
+    if( LinkHistory.Count == 0 )
+    {
+        // Without recent measurements, back off the same way the network driven ADR does.
+        // The ADRACKReq bit stays cleared as the network does not control the datarate.
+        CalcNextAdrParams_t backOff = *adrNext;
+        uint32_t lostUplinks = LinkHistory.LostUplinks;
+
+        backOff.AdrEnabled = true;
+        backOff.AdrAckCounter = lostUplinks;
+        CalcNextV10X( &backOff, drOut, txPowOut, &lostUplinks );
+        LinkHistory.LostUplinks = lostUplinks;
+        return false;
+    }
+
+    // Query minimum and maximum TX Datarates
+    getPhy.Attribute = PHY_MIN_TX_DR;
+    getPhy.UplinkDwellTime = adrNext->UplinkDwellTime;
+    phyParam = RegionGetPhyParam( adrNext->Region, &getPhy );
+    datarate = phyParam.Value;
+    getPhy.Attribute = PHY_MAX_TX_DR;
+    phyParam = RegionGetPhyParam( adrNext->Region, &getPhy );
+    maxDatarate = phyParam.Value;
+
+    // SNR the datarate floors must leave once the link margin is kept
+    linkSnr = GetLinkSnr( ) - ( LORAMAC_ADR_LINK_MARGIN * 10 );
+    if( GetSnrFloor( adrNext->Region, datarate, &snrFloor ) == true )
+    {
+        headroom = linkSnr - snrFloor;
+    }
+
+    // Select the fastest datarate whose demodulation floor fits the link
+    verify.DatarateParams.UplinkDwellTime = adrNext->UplinkDwellTime;
+    for( verify.DatarateParams.Datarate = datarate + 1; verify.DatarateParams.Datarate <= maxDatarate;
+         verify.DatarateParams.Datarate++ )
+    {
+        if( ( RegionVerify( adrNext->Region, &verify, PHY_TX_DR ) == false ) ||
+            ( GetSnrFloor( adrNext->Region, verify.DatarateParams.Datarate, &snrFloor ) == false ) )
+        {
+            continue;
+        }
+        if( linkSnr >= snrFloor )
+        {
+            datarate = verify.DatarateParams.Datarate;
+            headroom = linkSnr - snrFloor;
+            fastest = true;
+        }
+        else
+        {
+            // A faster LoRa datarate exists but the link does not hold it
+            fastest = false;
+        }
+    }
+
+    // Once at the fastest datarate, spend the remaining headroom on the TX power
+    if( fastest == true )
+    {
+        verify.TxPower = txPower + 1;
+        while( ( headroom >= LORAMAC_ADR_TX_POWER_STEP ) &&
+               ( RegionVerify( adrNext->Region, &verify, PHY_TX_POWER ) == true ) )
+        {
+            txPower = verify.TxPower;
+            verify.TxPower++;
+            headroom -= LORAMAC_ADR_TX_POWER_STEP;
+        }
+    }
+
+    *drOut = datarate;
+    *txPowOut = txPower;
+    return false;
+}
+
+void LoRaMacAdrAddDownlinkSnr( LoRaMacRegion_t region, int8_t snr, int8_t datarate )
+{
+    GetPhyParams_t getPhy;
+    PhyParam_t phyParam;
+
+    // The SNR is measured in the bandwidth of the downlink
+    getPhy.Attribute = PHY_BW_FROM_DR;
+    getPhy.Datarate = datarate;
+    phyParam = RegionGetPhyParam( region, &getPhy );
+    AddLinkSample( ( ( snr - LORAMAC_ADR_DOWNLINK_SNR_OFFSET ) * 10 ) + GetBandwidthNoise( phyParam.Value ) );
+}
+
+void LoRaMacAdrAddLinkCheckMargin( LoRaMacRegion_t region, uint8_t demodMargin, int8_t datarate )
+{
+    int16_t snrFloor;
+
+    // The margin is given above the floor of the uplink datarate
+    if( GetSnrFloor( region, datarate, &snrFloor ) == true )
+    {
+        AddLinkSample( ( demodMargin * 10 ) + snrFloor );
+    }
+}
+
+void LoRaMacAdrAddLostUplink( void )
+{
+    LinkHistory.LostUplinks++;
+}
+
+void LoRaMacAdrResetLinkHistory( void )
+{
+    LinkHistory.Index = 0;
+    LinkHistory.Count = 0;
+    LinkHistory.LostUplinks = 0;
+}
+#endif /* LORAMAC_ADR_LINK_MARGIN_ENABLED */
+
 /*!
  * \brief Calculates the next datarate to set, when ADR is on or off.
  *
@@ -124,6 +334,12 @@ bool LoRaMacAdrCalcNext( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* tx
 {
     if( adrNext->Version.Fields.Minor == 0 )
     {
+#ifdef LORAMAC_ADR_LINK_MARGIN_ENABLED
+        if( adrNext->AdrEnabled == false )
+        {
+            return CalcNextLinkMargin( adrNext, drOut, txPowOut, adrAckCounter );
+        }
+#endif
         return CalcNextV10X( adrNext, drOut, txPowOut, adrAckCounter );
     }
     return false;
@@ -39,6 +39,60 @@
 
 /*! \} defgroup LORAMACADR */
 
+#ifdef LORAMAC_ADR_LINK_MARGIN_ENABLED
+/*!
+ * Link margin ADR: when the network ADR is off, the end-device selects the
+ * fastest datarate and the lowest TX power keeping the link SNR, estimated from
+ * the recent downlinks and LinkCheckAns, LORAMAC_ADR_LINK_MARGIN dB above the
+ * demodulation floor.
+ */
+
+/*!
+ * Link margin to keep above the demodulation floor [dB]
+ */
+#ifndef LORAMAC_ADR_LINK_MARGIN
+#define LORAMAC_ADR_LINK_MARGIN                     10
+#endif
+
+/*!
+ * Number of link measurements used for the link SNR estimation
+ */
+#ifndef LORAMAC_ADR_LINK_HISTORY_SIZE
+#define LORAMAC_ADR_LINK_HISTORY_SIZE               8
+#endif
+
+/*!
+ * Correction applied to the downlink SNR to account for the gateway to
+ * end-device link budget difference [dB]
+ */
+#ifndef LORAMAC_ADR_DOWNLINK_SNR_OFFSET
+#define LORAMAC_ADR_DOWNLINK_SNR_OFFSET             0
+#endif
+
+/*!
+ * Demodulation floor of SF12 [0.1 dB]. The spreading factor and the bandwidth
+ * of each datarate are taken from the region, every bandwidth doubling above
+ * 125 kHz raises the floor by 3 dB.
+ */
+#ifndef LORAMAC_ADR_SNR_FLOOR_SF12
+#define LORAMAC_ADR_SNR_FLOOR_SF12                  -200
+#endif
+
+/*!
+ * Demodulation floor increase per spreading factor step down [0.1 dB]
+ */
+#ifndef LORAMAC_ADR_SNR_FLOOR_SF_STEP
+#define LORAMAC_ADR_SNR_FLOOR_SF_STEP               25
+#endif
+
+/*!
+ * TX power decrease per TX power index [0.1 dB]
+ */
+#ifndef LORAMAC_ADR_TX_POWER_STEP
+#define LORAMAC_ADR_TX_POWER_STEP                   20
+#endif
+#endif /* LORAMAC_ADR_LINK_MARGIN_ENABLED */
+
 /*
  * Parameter structure for the function CalcNextAdr.
  */
@@ -101,4 +155,40 @@ typedef struct sCalcNextAdrParams
  */
 bool LoRaMacAdrCalcNext( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* txPowOut, uint32_t* adrAckCounter );
 
+#ifdef LORAMAC_ADR_LINK_MARGIN_ENABLED
+/*!
+ * \brief Adds the SNR of a downlink received in RX1 or RX2 to the link history.
+ *
+ * \param [IN] region LoRaWAN region.
+ *
+ * \param [IN] snr Downlink SNR [dB].
+ *
+ * \param [IN] datarate Datarate of the downlink.
+ */
+void LoRaMacAdrAddDownlinkSnr( LoRaMacRegion_t region, int8_t snr, int8_t datarate );
+
+/*!
+ * \brief Adds the margin reported by a LinkCheckAns to the link history.
+ *
+ * \param [IN] region LoRaWAN region.
+ *
+ * \param [IN] demodMargin Uplink demodulation margin [dB].
+ *
+ * \param [IN] datarate Datarate of the uplink which carried the LinkCheckReq.
+ */
+void LoRaMacAdrAddLinkCheckMargin( LoRaMacRegion_t region, uint8_t demodMargin, int8_t datarate );
+
+/*!
+ * \brief Counts an uplink which got no downlink in RX1 or RX2. After
+ *        AdrAckLimit of them the link history is dropped and the datarate
+ *        backs off as with the network ADR.
+ */
+void LoRaMacAdrAddLostUplink( void );
+
+/*!
+ * \brief Discards the link history.
+ */
+void LoRaMacAdrResetLinkHistory( void );
+#endif /* LORAMAC_ADR_LINK_MARGIN_ENABLED */
+
 #endif // __LORAMACADR_H__
@@ -1103,7 +1103,7 @@ static void LoRaMacClassBProcessMulticastSlot( void )
         case PINGSLOT_STATE_CALC_PING_OFFSET:
         {
             // Compute all offsets for every multicast slots
-            for( uint8_t i = 0; i < 4; i++ )
+            for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
             {
                 ComputePingOffset( Ctx.BeaconCtx.BeaconTime.Seconds,
                                    cur->ChannelParams.Address,
@@ -1119,7 +1119,7 @@ static void LoRaMacClassBProcessMulticastSlot( void )
             cur = Ctx.LoRaMacClassBParams.MulticastChannels;
             Ctx.PingSlotCtx.NextMulticastChannel = NULL;
 
-            for( uint8_t i = 0; i < 4; i++ )
+            for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
             {
                 // Calculate the next slot time for every multicast slot
                 if( CalcNextSlotTime( cur->PingOffset, cur->PingPeriod, cur->PingNb, &slotTime ) == true )
@@ -1221,7 +1221,7 @@ static void LoRaMacClassBProcessMulticastSlot( void )
 }
 #endif // LORAMAC_CLASSB_ENABLED
 
-bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size )
+bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size, TimerTime_t rxDoneTime )
 {
 #ifdef LORAMAC_CLASSB_ENABLED
     GetPhyParams_t getPhy;
@@ -1282,7 +1282,8 @@ bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size )
             // Reset beacon variables, if one of the crc is valid
             if( beaconProcessed == true )
             {
-                TimerTime_t time = Radio.TimeOnAir( MODEM_LORA, size );
+                // The beacon ended a time on air after its start, and was processed later
+                TimerTime_t time = Radio.TimeOnAir( MODEM_LORA, size ) + TimerGetElapsedTime( rxDoneTime );
                 SysTime_t timeOnAir;
                 timeOnAir.Seconds = time / 1000;
                 timeOnAir.SubSeconds = time - timeOnAir.Seconds * 1000;
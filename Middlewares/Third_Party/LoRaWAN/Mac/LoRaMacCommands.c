@@ -60,12 +60,64 @@ typedef struct sLoRaMacCommandsCtx
      * Buffer to store MAC command elements
      */
     MacCommand_t MacCommandSlots[NUM_OF_MAC_COMMANDS];
+    /*
+     * Stack of the indexes of the free MAC command slots
+     */
+    uint8_t FreeSlots[NUM_OF_MAC_COMMANDS];
+    /*
+     * Number of free MAC command slots
+     */
+    uint8_t FreeSlotsCnt;
+    /*
+     * Set for the MAC command slots handed out, indexed as MacCommandSlots
+     */
+    bool SlotInUse[NUM_OF_MAC_COMMANDS];
     /*
      * Size of all MAC commands serialized as buffer
      */
     size_t SerializedCmdsSize;
 } LoRaMacCommandsCtx_t;
 
+/*!
+ * MAC command descriptor
+ */
+typedef struct sMacCommandDesc
+{
+    /*
+     * Set for the MAC commands known by the module
+     */
+    bool IsValid;
+    /*
+     * Size of the MAC command payload
+     */
+    uint8_t PayloadSize;
+    /*
+     * Indicates if it's a sticky MAC command
+     */
+    bool IsSticky;
+} MacCommandDesc_t;
+
+/*!
+ * Descriptors of the end-device MAC commands, indexed by CID
+ */
+static const MacCommandDesc_t MacCommandDescs[MOTE_MAC_BEACON_FREQ_ANS + 1] =
+{
+    [MOTE_MAC_LINK_CHECK_REQ]       = { true, 0, false },
+    [MOTE_MAC_LINK_ADR_ANS]         = { true, 1, false },
+    [MOTE_MAC_DUTY_CYCLE_ANS]       = { true, 0, false },
+    [MOTE_MAC_RX_PARAM_SETUP_ANS]   = { true, 1, true  },
+    [MOTE_MAC_DEV_STATUS_ANS]       = { true, 2, false },
+    [MOTE_MAC_NEW_CHANNEL_ANS]      = { true, 1, false },
+    [MOTE_MAC_RX_TIMING_SETUP_ANS]  = { true, 0, true  },
+    [MOTE_MAC_TX_PARAM_SETUP_ANS]   = { true, 0, false },
+    [MOTE_MAC_DL_CHANNEL_ANS]       = { true, 1, true  },
+    [MOTE_MAC_DEVICE_TIME_REQ]      = { true, 0, false },
+    [MOTE_MAC_PING_SLOT_INFO_REQ]   = { true, 1, false },
+    [MOTE_MAC_PING_SLOT_FREQ_ANS]   = { true, 1, false },
+    [MOTE_MAC_BEACON_TIMING_REQ]    = { true, 0, false },
+    [MOTE_MAC_BEACON_FREQ_ANS]      = { true, 1, false },
+};
+
 /*!
  * Callback function to notify the upper layer about context change
  */
@@ -79,23 +131,17 @@ static LoRaMacCommandsCtx_t NvmCtx;
 /* Memory management functions */
 
 /*!
- * \brief Determines if a MAC command slot is free
- *
- * \param[IN]     slot           - Slot to check
- * \retval                       - Status of the operation
+ * \brief Initializes the pool of MAC command slots, all slots are free
  */
-static bool IsSlotFree( const MacCommand_t* slot )
+static void MacCommandSlotsInit( void )
 {
-    uint8_t* mem = ( uint8_t* )slot;
-
-    for( uint16_t size = 0; size < sizeof( MacCommand_t ); size++ )
+    for( uint8_t i = 0; i < NUM_OF_MAC_COMMANDS; i++ )
     {
-        if( mem[size] != 0x00 )
-        {
-            return false;
-        }
+        // Pushed in reverse order so that the slots are handed out from the first one
+        NvmCtx.FreeSlots[i] = NUM_OF_MAC_COMMANDS - 1 - i;
+        NvmCtx.SlotInUse[i] = false;
     }
-    return true;
+    NvmCtx.FreeSlotsCnt = NUM_OF_MAC_COMMANDS;
 }
 
 /*!
@@ -105,18 +151,18 @@ static bool IsSlotFree( const MacCommand_t* slot )
  */
 static MacCommand_t* MallocNewMacCommandSlot( void )
 {
-    uint8_t itr = 0;
+    uint8_t index;
 
-    while( IsSlotFree( ( const MacCommand_t* )&NvmCtx.MacCommandSlots[itr] ) == false )
+    if( NvmCtx.FreeSlotsCnt == 0 )
     {
-        itr++;
-        if( itr == NUM_OF_MAC_COMMANDS )
-        {
-            return 0;
-        }
+        return NULL;
     }
 
-    return &NvmCtx.MacCommandSlots[itr];
+    NvmCtx.FreeSlotsCnt--;
+    index = NvmCtx.FreeSlots[NvmCtx.FreeSlotsCnt];
+    NvmCtx.SlotInUse[index] = true;
+
+    return &NvmCtx.MacCommandSlots[index];
 }
 
 /*!
@@ -128,13 +174,26 @@ static MacCommand_t* MallocNewMacCommandSlot( void )
  */
 static bool FreeMacCommandSlot( MacCommand_t* slot )
 {
-    if( slot == 0 )
+    uint8_t index;
+
+    if( ( slot < NvmCtx.MacCommandSlots ) || ( slot >= &NvmCtx.MacCommandSlots[NUM_OF_MAC_COMMANDS] ) )
+    {
+        return false;
+    }
+    index = ( uint8_t )( slot - NvmCtx.MacCommandSlots );
+
+    // A slot freed twice would be handed out twice
+    if( ( &NvmCtx.MacCommandSlots[index] != slot ) || ( NvmCtx.SlotInUse[index] == false ) ||
+        ( NvmCtx.FreeSlotsCnt >= NUM_OF_MAC_COMMANDS ) )
     {
         return false;
     }
 
     memset1( ( uint8_t* )slot, 0x00, sizeof( MacCommand_t ) );
 
+    NvmCtx.SlotInUse[index] = false;
+    NvmCtx.FreeSlots[NvmCtx.FreeSlotsCnt++] = index;
+
     return true;
 }
 
@@ -168,7 +227,7 @@ static bool LinkedListInit( MacCommandsList_t* list )
  */
 static bool LinkedListAdd( MacCommandsList_t* list, MacCommand_t* element )
 {
-    if( ( list == 0 ) && ( element == 0 ) )
+    if( ( list == 0 ) || ( element == 0 ) )
     {
         return false;
     }
@@ -185,8 +244,9 @@ static bool LinkedListAdd( MacCommandsList_t* list, MacCommand_t* element )
         list->Last->Next = element;
     }
 
-    // Update the next point of this entry.
+    // Update the next and previous points of this entry.
     element->Next = 0;
+    element->Prev = list->Last;
 
     // Update the last entry of the list.
     list->Last = element;
@@ -194,42 +254,6 @@ static bool LinkedListAdd( MacCommandsList_t* list, MacCommand_t* element )
     return true;
 }
 
-/*!
- * \brief Return the previous element in the list.
- *
- * \param[IN]     list           - List
- * \param[IN]     element        - Element where the previous element shall be searched
- * \retval                       - Status of the operation
- */
-static MacCommand_t* LinkedListGetPrevious( MacCommandsList_t* list, MacCommand_t* element )
-{
-    if( ( list == 0 ) && ( element == 0 ) )
-    {
-        return NULL;
-    }
-
-    MacCommand_t* curElement;
-
-    // Start at the head of the list
-    curElement = list->First;
-
-    // When current element is the first of the list, there's no previous element so we can return NULL immediately.
-    if( element != curElement )
-    {
-        // Loop through all elements until the end is reached or the next of current is the current element.
-        while( ( curElement != NULL ) && ( curElement->Next != element ) )
-        {
-            curElement = curElement->Next;
-        }
-    }
-    else
-    {
-        curElement = NULL;
-    }
-
-    return curElement;
-}
-
 /*!
  * \brief Remove an element from the list
  *
@@ -239,29 +263,37 @@ static MacCommand_t* LinkedListGetPrevious( MacCommandsList_t* list, MacCommand_
  */
 static bool LinkedListRemove( MacCommandsList_t* list, MacCommand_t* element )
 {
-    if( ( list == 0 ) && ( element == 0 ) )
+    if( ( list == 0 ) || ( element == 0 ) )
     {
         return false;
     }
 
-    MacCommand_t* PrevElement = LinkedListGetPrevious( list, element );
+    // Only the head of the list has no previous element.
+    if( ( element->Prev == NULL ) && ( list->First != element ) )
+    {
+        return false;
+    }
 
-    if( list->First == element )
+    if( element->Prev != NULL )
+    {
+        element->Prev->Next = element->Next;
+    }
+    else
     {
         list->First = element->Next;
     }
 
-    if( list->Last == element )
+    if( element->Next != NULL )
     {
-        list->Last = PrevElement;
+        element->Next->Prev = element->Prev;
     }
-
-    if( PrevElement != NULL )
+    else
     {
-        PrevElement->Next = element->Next;
+        list->Last = element->Prev;
     }
 
     element->Next = NULL;
+    element->Prev = NULL;
 
     return true;
 }
@@ -275,15 +307,11 @@ static bool LinkedListRemove( MacCommandsList_t* list, MacCommand_t* element )
  */
 static bool IsSticky( uint8_t cid )
 {
-    switch( cid )
+    if( cid >= ( sizeof( MacCommandDescs ) / sizeof( MacCommandDescs[0] ) ) )
     {
-        case MOTE_MAC_DL_CHANNEL_ANS:
-        case MOTE_MAC_RX_PARAM_SETUP_ANS:
-        case MOTE_MAC_RX_TIMING_SETUP_ANS:
-            return true;
-        default:
-            return false;
+        return false;
     }
+    return MacCommandDescs[cid].IsSticky;
 }
 
 /*
@@ -302,6 +330,7 @@ LoRaMacCommandStatus_t LoRaMacCommandsInit( LoRaMacCommandsNvmEvent commandsNvmC
     // Initialize with default
     memset1( ( uint8_t* )&NvmCtx, 0, sizeof( NvmCtx ) );
 
+    MacCommandSlotsInit( );
     LinkedListInit( &NvmCtx.MacCommandList );
 
     // Assign callback
@@ -336,6 +365,16 @@ LoRaMacCommandStatus_t LoRaMacCommandsAddCmd( uint8_t cid, uint8_t* payload, siz
     {
         return LORAMAC_COMMANDS_ERROR_NPE;
     }
+    if( payloadSize > LORAMAC_COMMADS_MAX_NUM_OF_PARAMS )
+    {
+        return LORAMAC_COMMANDS_ERROR;
+    }
+    // Known MAC commands must match their descriptor
+    if( ( cid < ( sizeof( MacCommandDescs ) / sizeof( MacCommandDescs[0] ) ) ) && ( MacCommandDescs[cid].IsValid == true ) &&
+        ( MacCommandDescs[cid].PayloadSize != payloadSize ) )
+    {
+        return LORAMAC_COMMANDS_ERROR_UNKNOWN_CMD;
+    }
     MacCommand_t* newCmd;
 
     // Allocate a memory slot
@@ -504,6 +543,8 @@ LoRaMacCommandStatus_t LoRaMacCommandsSerializeCmds( size_t availableSize, size_
         curElement = curElement->Next;
     }
 
+    *effectiveSize = itr;
+
     return LORAMAC_COMMANDS_SUCCESS;
 }
 
@@ -56,6 +56,10 @@ struct sMacCommand
      *  The pointer to the next MAC Command element in the list
      */
     MacCommand_t* Next;
+    /*!
+     *  The pointer to the previous MAC Command element in the list
+     */
+    MacCommand_t* Prev;
     /*!
      * MAC command identifier
      */
@@ -44,7 +44,9 @@
 /*!
  * Indicates if LoRaWAN 1.1.x crypto scheme is enabled
  */
+#ifndef USE_LRWAN_1_1_X_CRYPTO
 #define USE_LRWAN_1_1_X_CRYPTO                      0
+#endif
 
 /*!
  * Indicates if a random devnonce must be used or not
@@ -82,9 +84,9 @@
 #define DEV_NONCE_SIZE                  2
 
 /*
- * Number of security context entries
+ * Number of security context entries, one per multicast group plus the unicast one
  */
-#define NUM_OF_SEC_CTX                  5
+#define NUM_OF_SEC_CTX                  ( LORAMAC_MAX_MC_CTX + 1 )
 
 /*
  * Size of the module context
@@ -136,21 +138,9 @@ typedef struct sFCntList
      */
     uint32_t FCntDown;
     /*!
-     * Multicast downlink counter for index 0
-     */
-    uint32_t McFCntDown0;
-    /*!
-     * Multicast downlink counter for index 1
-     */
-    uint32_t McFCntDown1;
-    /*!
-     * Multicast downlink counter for index 2
+     * Multicast downlink counters, indexed by group id
      */
-    uint32_t McFCntDown2;
-    /*!
-     * Multicast downlink counter for index 3
-     */
-    uint32_t McFCntDown3;
+    uint32_t McFCntDown[LORAMAC_MAX_MC_CTX];
 }FCntList_t;
 
 /*
@@ -241,16 +231,9 @@ static LoRaMacCryptoCtx_t CryptoCtx;
 static LoRaMacCryptoNvmCtx_t NvmCryptoCtx;
 
 /*
- * Key-Address list
+ * Key-Address list, indexed by address identifier. Filled by InitKeyAddrList.
  */
-static KeyAddr_t KeyAddrList[NUM_OF_SEC_CTX] =
-    {
-        { MULTICAST_0_ADDR, MC_APP_S_KEY_0, MC_NWK_S_KEY_0, MC_KEY_0 },
-        { MULTICAST_1_ADDR, MC_APP_S_KEY_1, MC_NWK_S_KEY_1, MC_KEY_1 },
-        { MULTICAST_2_ADDR, MC_APP_S_KEY_2, MC_NWK_S_KEY_2, MC_KEY_2 },
-        { MULTICAST_3_ADDR, MC_APP_S_KEY_3, MC_NWK_S_KEY_3, MC_KEY_3 },
-        { UNICAST_DEV_ADDR, APP_S_KEY, S_NWK_S_INT_KEY, NO_KEY }
-    };
+static KeyAddr_t KeyAddrList[NUM_OF_SEC_CTX];
 
 /*
  * Local functions
@@ -274,11 +257,13 @@ static LoRaMacCryptoStatus_t PayloadEncrypt( uint8_t* buffer, int16_t size, KeyI
         return LORAMAC_CRYPTO_ERROR_NPE;
     }
 
-    uint8_t bufferIndex = 0;
-    uint16_t ctr = 1;
-    uint8_t sBlock[16] = { 0 };
     uint8_t aBlock[16] = { 0 };
 
+    if( size <= 0 )
+    {
+        return LORAMAC_CRYPTO_SUCCESS;
+    }
+
     aBlock[0] = 0x01;
 
     aBlock[5] = dir;
@@ -293,21 +278,12 @@ static LoRaMacCryptoStatus_t PayloadEncrypt( uint8_t* buffer, int16_t size, KeyI
     aBlock[12] = ( frameCounter >> 16 ) & 0xFF;
     aBlock[13] = ( frameCounter >> 24 ) & 0xFF;
 
-    while( size > 0 )
-    {
-        aBlock[15] = ctr & 0xFF;
-        ctr++;
-        if( SecureElementAesEncrypt( aBlock, 16, keyID, sBlock ) != SECURE_ELEMENT_SUCCESS )
-        {
-            return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
-        }
+    aBlock[15] = 1;
 
-        for( uint8_t i = 0; i < ( ( size > 16 ) ? 16 : size ); i++ )
-        {
-            buffer[bufferIndex + i] = buffer[bufferIndex + i] ^ sBlock[i];
-        }
-        size -= 16;
-        bufferIndex += 16;
+    // The whole payload at once, in hardware when the secure element has it
+    if( SecureElementAesCtrEncrypt( buffer, size, aBlock, keyID ) != SECURE_ELEMENT_SUCCESS )
+    {
+        return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
     }
 
     return LORAMAC_CRYPTO_SUCCESS;
@@ -397,19 +373,7 @@ static LoRaMacCryptoStatus_t FOptsEncrypt( uint16_t size, uint32_t address, uint
 }
 #endif
 
-/*
- * Prepares B0 block for cmac computation.
- *
- * \param[IN]  msgLen         - Length of message
- * \param[IN]  keyID          - Key identifier
- * \param[IN]  isAck          - True if it is a acknowledge frame ( Sets ConfFCnt in B0 block )
- * \param[IN]  devAddr        - Device address
- * \param[IN]  dir            - Frame direction ( Uplink:0, Downlink:1 )
- * \param[IN]  fCnt           - Frame counter
- * \param[IN/OUT]  b0         - B0 block
- * \retval                    - Status of the operation
- */
-static LoRaMacCryptoStatus_t PrepareB0( uint16_t msgLen, KeyIdentifier_t keyID, bool isAck, uint8_t dir, uint32_t devAddr, uint32_t fCnt, uint8_t* b0 )
+LoRaMacCryptoStatus_t LoRaMacCryptoPrepareB0( uint16_t msgLen, uint16_t confFCnt, uint8_t dir, uint32_t devAddr, uint32_t fCnt, uint8_t* b0 )
 {
     if( b0 == 0 )
     {
@@ -418,21 +382,8 @@ static LoRaMacCryptoStatus_t PrepareB0( uint16_t msgLen, KeyIdentifier_t keyID,
 
     b0[0] = 0x49;
 
-    if( ( isAck == true ) && ( dir == DOWNLINK ) )
-    {
-        // confFCnt contains the frame counter value modulo 2^16 of the "confirmed" uplink or downlink frame that is being acknowledged
-        uint16_t confFCnt = 0;
-
-        confFCnt = ( uint16_t )( CryptoCtx.NvmCtx->FCntList.FCntUp % 65536 );
-
-        b0[1] = confFCnt & 0xFF;
-        b0[2] = ( confFCnt >> 8 ) & 0xFF;
-    }
-    else
-    {
-        b0[1] = 0x00;
-        b0[2] = 0x00;
-    }
+    b0[1] = confFCnt & 0xFF;
+    b0[2] = ( confFCnt >> 8 ) & 0xFF;
 
     b0[3] = 0x00;
     b0[4] = 0x00;
@@ -483,9 +434,16 @@ static LoRaMacCryptoStatus_t ComputeCmacB0( uint8_t* msg, uint16_t len, KeyIdent
     }
 
     uint8_t micBuff[MIC_BLOCK_BX_SIZE];
+    uint16_t confFCnt = 0;
+
+    if( ( isAck == true ) && ( dir == DOWNLINK ) )
+    {
+        // confFCnt contains the frame counter value modulo 2^16 of the "confirmed" uplink or downlink frame that is being acknowledged
+        confFCnt = ( uint16_t )( CryptoCtx.NvmCtx->FCntList.FCntUp % 65536 );
+    }
 
     // Initialize the first Block
-    PrepareB0( len, keyID, isAck, dir, devAddr, fCnt, micBuff );
+    LoRaMacCryptoPrepareB0( len, confFCnt, dir, devAddr, fCnt, micBuff );
 
     if( SecureElementComputeAesCmac( micBuff, msg, len, keyID, cmac ) != SECURE_ELEMENT_SUCCESS )
     {
@@ -497,6 +455,10 @@ static LoRaMacCryptoStatus_t ComputeCmacB0( uint8_t* msg, uint16_t len, KeyIdent
 /*!
  * Verifies cmac with adding B0 block in front.
  *
+ * The B0 block is handed to the secure element separately so the message
+ * does not have to be copied behind it, the comparison is left to the
+ * secure element.
+ *
  * \param[IN]  msg            - Message to compute the integrity code
  * \param[IN]  len            - Length of message
  * \param[IN]  keyID          - Key identifier
@@ -518,17 +480,19 @@ static LoRaMacCryptoStatus_t VerifyCmacB0( uint8_t* msg, uint16_t len, KeyIdenti
         return LORAMAC_CRYPTO_ERROR_BUF_SIZE;
     }
 
-    uint8_t micBuff[CRYPTO_BUFFER_SIZE];
-    memset1( micBuff, 0, CRYPTO_BUFFER_SIZE );
+    uint8_t micBuff[MIC_BLOCK_BX_SIZE];
+    uint16_t confFCnt = 0;
 
-    // Initialize the first Block
-    PrepareB0( len, keyID, isAck, dir, devAddr, fCnt, micBuff );
+    if( ( isAck == true ) && ( dir == DOWNLINK ) )
+    {
+        // confFCnt contains the frame counter value modulo 2^16 of the "confirmed" uplink frame that is being acknowledged
+        confFCnt = ( uint16_t )( CryptoCtx.NvmCtx->FCntList.FCntUp % 65536 );
+    }
 
-    // Copy the given data to the mic computation buffer
-    memcpy1( ( micBuff + MIC_BLOCK_BX_SIZE ), msg, len );
+    // Initialize the first Block
+    LoRaMacCryptoPrepareB0( len, confFCnt, dir, devAddr, fCnt, micBuff );
 
-    SecureElementStatus_t retval = SECURE_ELEMENT_ERROR;
-    retval = SecureElementVerifyAesCmac( micBuff, ( len + MIC_BLOCK_BX_SIZE ), expectedCmac, keyID );
+    SecureElementStatus_t retval = SecureElementVerifyAesCmac( micBuff, msg, len, expectedCmac, keyID );
 
     if( retval == SECURE_ELEMENT_SUCCESS )
     {
@@ -543,20 +507,7 @@ static LoRaMacCryptoStatus_t VerifyCmacB0( uint8_t* msg, uint16_t len, KeyIdenti
 }
 
 #if( USE_LRWAN_1_1_X_CRYPTO == 1 )
-/*
- * Prpares B1 block for cmac computation.
- *
- * \param[IN]  msgLen         - Length of message
- * \param[IN]  keyID          - Key identifier
- * \param[IN]  isAck          - True if it is a acknowledge frame ( Sets ConfFCnt in B0 block )
- * \param[IN]  txDr           - Data rate used for the transmission
- * \param[IN]  txCh           - Index of the channel used for the transmission
- * \param[IN]  devAddr        - Device address
- * \param[IN]  fCntUp         - Frame counter
- * \param[IN/OUT]  b0         - B0 block
- * \retval                    - Status of the operation
- */
-static LoRaMacCryptoStatus_t PrepareB1( uint16_t msgLen, KeyIdentifier_t keyID, bool isAck, uint8_t txDr, uint8_t txCh, uint32_t devAddr, uint32_t fCntUp, uint8_t* b1 )
+LoRaMacCryptoStatus_t LoRaMacCryptoPrepareB1( uint16_t msgLen, uint16_t confFCnt, uint8_t txDr, uint8_t txCh, uint32_t devAddr, uint32_t fCntUp, uint8_t* b1 )
 {
     if( b1 == 0 )
     {
@@ -565,18 +516,8 @@ static LoRaMacCryptoStatus_t PrepareB1( uint16_t msgLen, KeyIdentifier_t keyID,
 
     b1[0] = 0x49;
 
-    if( isAck == true )
-    {
-        // confFCnt contains the frame counter value modulo 2^16 of the "confirmed" uplink frame that is being acknowledged
-        uint16_t confFCnt = ( uint16_t )( *CryptoCtx.NvmCtx->LastDownFCnt % 65536 );
-        b1[1] = confFCnt & 0xFF;
-        b1[2] = ( confFCnt >> 8 ) & 0xFF;
-    }
-    else
-    {
-        b1[1] = 0x00;
-        b1[2] = 0x00;
-    }
+    b1[1] = confFCnt & 0xFF;
+    b1[2] = ( confFCnt >> 8 ) & 0xFF;
 
     b1[3] = txDr;
     b1[4] = txCh;
@@ -627,9 +568,16 @@ static LoRaMacCryptoStatus_t ComputeCmacB1( uint8_t* msg, uint16_t len, KeyIdent
     }
 
     uint8_t micBuff[MIC_BLOCK_BX_SIZE];
+    uint16_t confFCnt = 0;
+
+    if( isAck == true )
+    {
+        // confFCnt contains the frame counter value modulo 2^16 of the "confirmed" downlink frame that is being acknowledged
+        confFCnt = ( uint16_t )( *CryptoCtx.NvmCtx->LastDownFCnt % 65536 );
+    }
 
     // Initialize the first Block
-    PrepareB1( len, keyID, isAck, txDr, txCh, devAddr, fCntUp, micBuff );
+    LoRaMacCryptoPrepareB1( len, confFCnt, txDr, txCh, devAddr, fCntUp, micBuff );
 
     if( SecureElementComputeAesCmac( micBuff, msg, len, keyID, cmac ) != SECURE_ELEMENT_SUCCESS )
     {
@@ -648,15 +596,31 @@ static LoRaMacCryptoStatus_t ComputeCmacB1( uint8_t* msg, uint16_t len, KeyIdent
  */
 static LoRaMacCryptoStatus_t GetKeyAddrItem( AddressIdentifier_t addrID, KeyAddr_t** item )
 {
-    for( uint8_t i = 0; i < NUM_OF_SEC_CTX; i++ )
+    if( addrID >= NUM_OF_SEC_CTX )
     {
-        if( KeyAddrList[i].AddrID == addrID )
-        {
-            *item = &( KeyAddrList[i] );
-            return LORAMAC_CRYPTO_SUCCESS;
-        }
+        return LORAMAC_CRYPTO_ERROR_INVALID_ADDR_ID;
     }
-    return LORAMAC_CRYPTO_ERROR_INVALID_ADDR_ID;
+    *item = &( KeyAddrList[addrID] );
+    return LORAMAC_CRYPTO_SUCCESS;
+}
+
+/*
+ * Fills the security item list. The multicast groups take their key
+ * triplets in order, the unicast context is the last entry.
+ */
+static void InitKeyAddrList( void )
+{
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        KeyAddrList[i].AddrID = ( AddressIdentifier_t )i;
+        KeyAddrList[i].AppSkey = MC_APP_S_KEY( i );
+        KeyAddrList[i].NwkSkey = MC_NWK_S_KEY( i );
+        KeyAddrList[i].RootKey = MC_KEY( i );
+    }
+    KeyAddrList[UNICAST_DEV_ADDR].AddrID = UNICAST_DEV_ADDR;
+    KeyAddrList[UNICAST_DEV_ADDR].AppSkey = APP_S_KEY;
+    KeyAddrList[UNICAST_DEV_ADDR].NwkSkey = S_NWK_S_INT_KEY;
+    KeyAddrList[UNICAST_DEV_ADDR].RootKey = NO_KEY;
 }
 
 /*
@@ -821,19 +785,12 @@ static LoRaMacCryptoStatus_t GetLastFcntDown( FCntIdentifier_t fCntID, uint32_t*
             *lastDown = CryptoCtx.NvmCtx->FCntList.FCntDown;
             CryptoCtx.NvmCtx->LastDownFCnt = &CryptoCtx.NvmCtx->FCntList.FCntDown;
             break;
-        case MC_FCNT_DOWN_0:
-            *lastDown = CryptoCtx.NvmCtx->FCntList.McFCntDown0;
-            break;
-        case MC_FCNT_DOWN_1:
-            *lastDown = CryptoCtx.NvmCtx->FCntList.McFCntDown1;
-            break;
-        case MC_FCNT_DOWN_2:
-            *lastDown = CryptoCtx.NvmCtx->FCntList.McFCntDown2;
-            break;
-        case MC_FCNT_DOWN_3:
-            *lastDown = CryptoCtx.NvmCtx->FCntList.McFCntDown3;
-            break;
         default:
+            if( ( fCntID >= MC_FCNT_DOWN_0 ) && ( fCntID < MC_FCNT_DOWN( LORAMAC_MAX_MC_CTX ) ) )
+            {
+                *lastDown = CryptoCtx.NvmCtx->FCntList.McFCntDown[fCntID - MC_FCNT_DOWN_0];
+                break;
+            }
             return LORAMAC_CRYPTO_FAIL_FCNT_ID;
     }
     return LORAMAC_CRYPTO_SUCCESS;
@@ -887,19 +844,11 @@ static void UpdateFCntDown( FCntIdentifier_t fCntID, uint32_t currentDown )
         case FCNT_DOWN:
             CryptoCtx.NvmCtx->FCntList.FCntDown = currentDown;
             break;
-        case MC_FCNT_DOWN_0:
-            CryptoCtx.NvmCtx->FCntList.McFCntDown0 = currentDown;
-            break;
-        case MC_FCNT_DOWN_1:
-            CryptoCtx.NvmCtx->FCntList.McFCntDown1 = currentDown;
-            break;
-        case MC_FCNT_DOWN_2:
-            CryptoCtx.NvmCtx->FCntList.McFCntDown2 = currentDown;
-            break;
-        case MC_FCNT_DOWN_3:
-            CryptoCtx.NvmCtx->FCntList.McFCntDown3 = currentDown;
-            break;
         default:
+            if( ( fCntID >= MC_FCNT_DOWN_0 ) && ( fCntID < MC_FCNT_DOWN( LORAMAC_MAX_MC_CTX ) ) )
+            {
+                CryptoCtx.NvmCtx->FCntList.McFCntDown[fCntID - MC_FCNT_DOWN_0] = currentDown;
+            }
             break;
     }
     CryptoCtx.EventCryptoNvmCtxChanged( );
@@ -917,10 +866,10 @@ static void ResetFCnts( void )
     CryptoCtx.NvmCtx->FCntList.FCntDown = FCNT_DOWN_INITAL_VALUE;
     CryptoCtx.NvmCtx->LastDownFCnt = &CryptoCtx.NvmCtx->FCntList.FCntDown;
 
-    CryptoCtx.NvmCtx->FCntList.McFCntDown0 = FCNT_DOWN_INITAL_VALUE;
-    CryptoCtx.NvmCtx->FCntList.McFCntDown1 = FCNT_DOWN_INITAL_VALUE;
-    CryptoCtx.NvmCtx->FCntList.McFCntDown2 = FCNT_DOWN_INITAL_VALUE;
-    CryptoCtx.NvmCtx->FCntList.McFCntDown3 = FCNT_DOWN_INITAL_VALUE;
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        CryptoCtx.NvmCtx->FCntList.McFCntDown[i] = FCNT_DOWN_INITAL_VALUE;
+    }
 
     CryptoCtx.EventCryptoNvmCtxChanged( );
 }
@@ -955,6 +904,8 @@ LoRaMacCryptoStatus_t LoRaMacCryptoInit( LoRaMacCryptoNvmEvent cryptoNvmCtxChang
     // Initialize with default
     memset1( (uint8_t*) CryptoCtx.NvmCtx, 0, sizeof( LoRaMacCryptoNvmCtx_t ) );
 
+    InitKeyAddrList( );
+
     // Set default LoRaWAN version
     CryptoCtx.NvmCtx->LrWanVersion.Fields.Major = 1;
     CryptoCtx.NvmCtx->LrWanVersion.Fields.Minor = 1;
@@ -1067,10 +1018,10 @@ LoRaMacCryptoStatus_t LoRaMacCryptoSetMulticastReference( MulticastCtx_t* multic
         return LORAMAC_CRYPTO_ERROR_NPE;
     }
 
-    multicastList[0].DownLinkCounter = &CryptoCtx.NvmCtx->FCntList.McFCntDown0;
-    multicastList[1].DownLinkCounter = &CryptoCtx.NvmCtx->FCntList.McFCntDown1;
-    multicastList[2].DownLinkCounter = &CryptoCtx.NvmCtx->FCntList.McFCntDown2;
-    multicastList[3].DownLinkCounter = &CryptoCtx.NvmCtx->FCntList.McFCntDown3;
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        multicastList[i].DownLinkCounter = &CryptoCtx.NvmCtx->FCntList.McFCntDown[i];
+    }
 
     return LORAMAC_CRYPTO_SUCCESS;
 }
@@ -1296,7 +1247,7 @@ LoRaMacCryptoStatus_t LoRaMacCryptoHandleJoinAccept( JoinReqIdentifier_t joinReq
     {
         // For legacy mode :
         //   cmac = aes128_cmac(NwkKey, MHDR |  JoinNonce | NetID | DevAddr | DLSettings | RxDelay | CFList | CFListType)
-        if( SecureElementVerifyAesCmac( macMsg->Buffer, ( macMsg->BufSize - LORAMAC_MIC_FIELD_SIZE ), macMsg->MIC, micComputationKeyID ) != SECURE_ELEMENT_SUCCESS )
+        if( SecureElementVerifyAesCmac( NULL, macMsg->Buffer, ( macMsg->BufSize - LORAMAC_MIC_FIELD_SIZE ), macMsg->MIC, micComputationKeyID ) != SECURE_ELEMENT_SUCCESS )
         {
             return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
         }
@@ -1318,7 +1269,7 @@ LoRaMacCryptoStatus_t LoRaMacCryptoHandleJoinAccept( JoinReqIdentifier_t joinReq
 
         procBuffer[bufItr++] = macMsg->MHDR.Value;
 
-        if( SecureElementVerifyAesCmac( procBuffer,  ( macMsg->BufSize + micComputationOffset - LORAMAC_MHDR_FIELD_SIZE - LORAMAC_MIC_FIELD_SIZE ), macMsg->MIC, micComputationKeyID ) != SECURE_ELEMENT_SUCCESS )
+        if( SecureElementVerifyAesCmac( NULL, procBuffer,  ( macMsg->BufSize + micComputationOffset - LORAMAC_MHDR_FIELD_SIZE - LORAMAC_MIC_FIELD_SIZE ), macMsg->MIC, micComputationKeyID ) != SECURE_ELEMENT_SUCCESS )
         {
             return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
         }
@@ -1527,6 +1478,43 @@ LoRaMacCryptoStatus_t LoRaMacCryptoSecureMessage( uint32_t fCntUp, uint8_t txDr,
     return LORAMAC_CRYPTO_SUCCESS;
 }
 
+LoRaMacCryptoStatus_t LoRaMacCryptoSecureRetransmission( uint32_t fCntUp, uint8_t txDr, uint8_t txCh, LoRaMacMessageData_t* macMsg )
+{
+    if( macMsg == NULL )
+    {
+        return LORAMAC_CRYPTO_ERROR_NPE;
+    }
+
+    if( ( fCntUp != CryptoCtx.NvmCtx->FCntList.FCntUp ) || ( macMsg->BufSize <= LORAMAC_MIC_FIELD_SIZE ) )
+    {
+        // Not the last secured message
+        return LoRaMacCryptoSecureMessage( fCntUp, txDr, txCh, macMsg );
+    }
+
+#if( USE_LRWAN_1_1_X_CRYPTO == 1 )
+    if( CryptoCtx.NvmCtx->LrWanVersion.Fields.Minor == 1 )
+    {
+        LoRaMacCryptoStatus_t retval = LORAMAC_CRYPTO_ERROR;
+        uint32_t cmacS = 0;
+        uint16_t micIndex = macMsg->BufSize - LORAMAC_MIC_FIELD_SIZE;
+
+        // cmacS  = aes128_cmac(SNwkSIntKey, B1 | msg), cmacF is unchanged
+        retval = ComputeCmacB1( macMsg->Buffer, micIndex, S_NWK_S_INT_KEY, macMsg->FHDR.FCtrl.Bits.Ack, txDr, txCh, macMsg->FHDR.DevAddr, fCntUp, &cmacS );
+        if( retval != LORAMAC_CRYPTO_SUCCESS )
+        {
+            return retval;
+        }
+        macMsg->MIC = ( macMsg->MIC & 0xFFFF0000 ) | ( cmacS & 0x0000FFFF );
+
+        // Patch the MIC field in place
+        macMsg->Buffer[micIndex] = macMsg->MIC & 0xFF;
+        macMsg->Buffer[micIndex + 1] = ( macMsg->MIC >> 8 ) & 0xFF;
+    }
+#endif
+
+    return LORAMAC_CRYPTO_SUCCESS;
+}
+
 LoRaMacCryptoStatus_t LoRaMacCryptoUnsecureMessage( AddressIdentifier_t addrID, uint32_t address, FCntIdentifier_t fCntID, uint32_t fCntDown, LoRaMacMessageData_t* macMsg )
 {
     if( macMsg == 0 )
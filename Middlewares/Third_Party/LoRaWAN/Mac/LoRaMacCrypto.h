@@ -262,6 +262,22 @@ LoRaMacCryptoStatus_t LoRaMacCryptoHandleJoinAccept( JoinReqIdentifier_t joinReq
  */
 LoRaMacCryptoStatus_t LoRaMacCryptoSecureMessage( uint32_t fCntUp, uint8_t txDr, uint8_t txCh, LoRaMacMessageData_t* macMsg );
 
+/*!
+ * Updates a message secured by LoRaMacCryptoSecureMessage for its retransmission.
+ * The encrypted and serialized frame is kept. For LoRaWAN 1.1 only the MIC half
+ * computed over the B1 block, which depends on the data rate and channel, is
+ * computed again. For LoRaWAN 1.0.x the frame is sent unchanged.
+ * Falls back to LoRaMacCryptoSecureMessage if fCntUp is not the counter of the
+ * last secured message.
+ *
+ * \param[IN]     fCntUp          - Uplink sequence counter of the secured message
+ * \param[IN]     txDr            - Data rate used for the retransmission
+ * \param[IN]     txCh            - Index of the channel used for the retransmission
+ * \param[IN/OUT] macMsg          - Data message object, as secured for the first transmission
+ * \retval                        - Status of the operation
+ */
+LoRaMacCryptoStatus_t LoRaMacCryptoSecureRetransmission( uint32_t fCntUp, uint8_t txDr, uint8_t txCh, LoRaMacMessageData_t* macMsg );
+
 /*!
  * Unsecures a message (decryption + integrity verification).
  *
@@ -274,6 +290,39 @@ LoRaMacCryptoStatus_t LoRaMacCryptoSecureMessage( uint32_t fCntUp, uint8_t txDr,
  */
 LoRaMacCryptoStatus_t LoRaMacCryptoUnsecureMessage( AddressIdentifier_t addrID, uint32_t address, FCntIdentifier_t fCntID, uint32_t fCntDown, LoRaMacMessageData_t* macMsg );
 
+/*!
+ * Prepares the B0 block of a MIC computation.
+ *
+ * The block only depends on its parameters, it does not use the module
+ * context and can be built for any device.
+ *
+ * \param[IN]     msgLen          - Length of the message following the block
+ * \param[IN]     confFCnt        - Frame counter modulo 2^16 of the acknowledged frame, 0 if none
+ * \param[IN]     dir             - Frame direction ( Uplink:0, Downlink:1 )
+ * \param[IN]     devAddr         - Device address
+ * \param[IN]     fCnt            - Frame counter
+ * \param[OUT]    b0              - B0 block, 16 bytes
+ * \retval                        - Status of the operation
+ */
+LoRaMacCryptoStatus_t LoRaMacCryptoPrepareB0( uint16_t msgLen, uint16_t confFCnt, uint8_t dir, uint32_t devAddr, uint32_t fCnt, uint8_t* b0 );
+
+/*!
+ * Prepares the B1 block of the MIC computation of a LoRaWAN 1.1 uplink.
+ *
+ * Only built with the LoRaWAN 1.1.x crypto scheme ( USE_LRWAN_1_1_X_CRYPTO ),
+ * as LoRaMacCryptoPrepareB0 it does not use the module context.
+ *
+ * \param[IN]     msgLen          - Length of the message following the block
+ * \param[IN]     confFCnt        - Frame counter modulo 2^16 of the acknowledged downlink, 0 if none
+ * \param[IN]     txDr            - Data rate used for the transmission
+ * \param[IN]     txCh            - Index of the channel used for the transmission
+ * \param[IN]     devAddr         - Device address
+ * \param[IN]     fCntUp          - Uplink frame counter
+ * \param[OUT]    b1              - B1 block, 16 bytes
+ * \retval                        - Status of the operation
+ */
+LoRaMacCryptoStatus_t LoRaMacCryptoPrepareB1( uint16_t msgLen, uint16_t confFCnt, uint8_t txDr, uint8_t txCh, uint32_t devAddr, uint32_t fCntUp, uint8_t* b1 );
+
 /*!
  * Derives the McRootKey from the GenAppKey or AppKey.
  *
@@ -49,6 +49,21 @@
  */
 #define LORAMAC_CRYPTO_MULTICAST_KEYS   127
 
+/*!
+ * Maximum number of multicast context
+ *
+ * Each group takes three key slots in the secure element and one downlink
+ * counter in the crypto context. Groups 0 to 3 are also reachable through
+ * the MIB_MC_xxx_KEY_n attributes.
+ */
+#ifndef LORAMAC_MAX_MC_CTX
+#define LORAMAC_MAX_MC_CTX              4
+#endif
+
+#if ( LORAMAC_MAX_MC_CTX < 4 ) || ( LORAMAC_MAX_MC_CTX > 40 )
+#error "LORAMAC_MAX_MC_CTX must be in the range 4 to 40"
+#endif
+
 /*!
  * LoRaWAN devices classes definition
  *
@@ -251,9 +266,10 @@ typedef enum eKeyIdentifier
      */
     MC_NWK_S_KEY_3,
     /*!
-     * Zero key for slot randomization in class B
+     * Zero key for slot randomization in class B, located after the key
+     * triplets of all LORAMAC_MAX_MC_CTX multicast groups
      */
-    SLOT_RAND_ZERO_KEY,
+    SLOT_RAND_ZERO_KEY = MC_KEY_0 + ( 3 * LORAMAC_MAX_MC_CTX ),
     /*!
      * No Key
      */
@@ -284,9 +300,29 @@ typedef enum eAddressIdentifier
     /*!
      * Unicast End-device address
      */
-    UNICAST_DEV_ADDR = 4,
+    UNICAST_DEV_ADDR = LORAMAC_MAX_MC_CTX,
 }AddressIdentifier_t;
 
+/*!
+ * Root key identifier of multicast group id
+ */
+#define MC_KEY( id )                    ( ( KeyIdentifier_t )( MC_KEY_0 + ( 3 * ( id ) ) ) )
+
+/*!
+ * Application session key identifier of multicast group id
+ */
+#define MC_APP_S_KEY( id )              ( ( KeyIdentifier_t )( MC_APP_S_KEY_0 + ( 3 * ( id ) ) ) )
+
+/*!
+ * Network session key identifier of multicast group id
+ */
+#define MC_NWK_S_KEY( id )              ( ( KeyIdentifier_t )( MC_NWK_S_KEY_0 + ( 3 * ( id ) ) ) )
+
+/*!
+ * Downlink counter identifier of multicast group id
+ */
+#define MC_FCNT_DOWN( id )              ( ( FCntIdentifier_t )( MC_FCNT_DOWN_0 + ( id ) ) )
+
 /*
  * Multicast Rx window parameters
  */
@@ -795,7 +795,15 @@ typedef enum ePhyAttribute
     /*!
      * The datarate of a ping slot channel.
      */
-    PHY_PING_SLOT_CHANNEL_DR
+    PHY_PING_SLOT_CHANNEL_DR,
+    /*!
+     * Spreading factor of a datarate, the bitrate in kbps for FSK.
+     */
+    PHY_SF_FROM_DR,
+    /*!
+     * Bandwidth of a datarate in Hz, 0 for FSK.
+     */
+    PHY_BW_FROM_DR
 }PhyAttribute_t;
 
 /*!
@@ -888,7 +896,8 @@ typedef struct sGetPhyParams
     /*!
      * Datarate.
      * The parameter is needed for the following queries:
-     * PHY_MAX_PAYLOAD, PHY_MAX_PAYLOAD_REPEATER, PHY_NEXT_LOWER_TX_DR.
+     * PHY_MAX_PAYLOAD, PHY_MAX_PAYLOAD_REPEATER, PHY_NEXT_LOWER_TX_DR,
+     * PHY_SF_FROM_DR, PHY_BW_FROM_DR.
      */
     int8_t Datarate;
     /*!
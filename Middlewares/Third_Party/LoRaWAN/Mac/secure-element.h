@@ -134,13 +134,14 @@ SecureElementStatus_t SecureElementComputeAesCmac( uint8_t* micBxBuffer, uint8_t
 /*!
  * Verifies a CMAC (computes and compare with expected cmac)
  *
+ * \param[IN]  micBxBuffer    - Buffer containing the initial Bx block, NULL if none
  * \param[IN]  buffer         - Data buffer
  * \param[IN]  size           - Data buffer size
  * \param[in]  expectedCmac   - Expected cmac
  * \param[IN]  keyID          - Key identifier to determine the AES key to be used
  * \retval                    - Status of the operation
  */
-SecureElementStatus_t SecureElementVerifyAesCmac( uint8_t* buffer, uint16_t size, uint32_t expectedCmac, KeyIdentifier_t keyID );
+SecureElementStatus_t SecureElementVerifyAesCmac( uint8_t* micBxBuffer, uint8_t* buffer, uint16_t size, uint32_t expectedCmac, KeyIdentifier_t keyID );
 
 /*!
  * Encrypt a buffer
@@ -153,6 +154,19 @@ SecureElementStatus_t SecureElementVerifyAesCmac( uint8_t* buffer, uint16_t size
  */
 SecureElementStatus_t SecureElementAesEncrypt( uint8_t* buffer, uint16_t size, KeyIdentifier_t keyID, uint8_t* encBuffer );
 
+/*!
+ * Encrypts or decrypts a buffer in place in AES counter mode, as the
+ * LoRaWAN payload encryption: the last byte of the counter block is
+ * incremented for each 16 bytes block
+ *
+ * \param[IN/OUT] buffer     - Data buffer
+ * \param[IN]  size           - Data buffer size, up to 255 bytes
+ * \param[IN]  ctrBlock       - First counter block ( 16 byte )
+ * \param[IN]  keyID          - Key identifier to determine the AES key to be used
+ * \retval                    - Status of the operation
+ */
+SecureElementStatus_t SecureElementAesCtrEncrypt( uint8_t* buffer, uint16_t size, uint8_t* ctrBlock, KeyIdentifier_t keyID );
+
 /*!
  * Derives and store a key
  *
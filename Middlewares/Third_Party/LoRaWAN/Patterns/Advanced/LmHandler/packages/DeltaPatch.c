@@ -0,0 +1,265 @@
+/*!
+ * \file      DeltaPatch.c
+ *
+ * \brief     Implements a streaming binary delta patcher rebuilding a new
+ *            firmware image from the running one while the delta file is
+ *            received ( e.g. through \ref LmhpFragmentation ).
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include "utilities.h"
+#include "DeltaPatch.h"
+
+#if ( DELTA_PATCH_BUFFER_SIZE < DELTA_PATCH_HEADER_SIZE )
+#error "DELTA_PATCH_BUFFER_SIZE must be at least DELTA_PATCH_HEADER_SIZE"
+#endif
+
+/*!
+ * Delta file parser states
+ */
+enum
+{
+    DELTA_PATCH_STATE_HEADER,
+    DELTA_PATCH_STATE_COMMAND,
+    DELTA_PATCH_STATE_OFFSET,
+    DELTA_PATCH_STATE_INSERT,
+};
+
+/*!
+ * \brief Reads a little endian 32 bits value
+ *
+ * \param [IN] buffer Buffer pointer
+ *
+ * \retval value      Read value
+ */
+static uint32_t DeltaPatchRead32( uint8_t *buffer )
+{
+    return ( ( uint32_t )buffer[0] << 0 ) | ( ( uint32_t )buffer[1] << 8 ) |
+           ( ( uint32_t )buffer[2] << 16 ) | ( ( uint32_t )buffer[3] << 24 );
+}
+
+/*!
+ * \brief Accumulates a varint byte
+ *
+ * \param [IN] patch Patcher instance
+ * \param [IN] byte  Delta file byte
+ *
+ * \retval done      True when patch->Varint holds the complete value
+ */
+static bool DeltaPatchVarint( DeltaPatch_t *patch, uint8_t byte )
+{
+    // The 5th byte only holds the 4 upper bits of a 32 bits value
+    if( ( patch->VarintShift >= 32 ) || ( ( patch->VarintShift == 28 ) && ( ( byte & 0x70 ) != 0 ) ) )
+    {
+        patch->Status = DELTA_PATCH_ERROR_FORMAT;
+        return false;
+    }
+    patch->Varint |= ( uint32_t )( byte & 0x7F ) << patch->VarintShift;
+    patch->VarintShift += 7;
+    return ( byte & 0x80 ) == 0;
+}
+
+/*!
+ * \brief Writes the buffered new image bytes
+ *
+ * \param [IN] patch Patcher instance
+ */
+static void DeltaPatchFlush( DeltaPatch_t *patch )
+{
+    if( patch->BufferIndex == 0 )
+    {
+        return;
+    }
+    if( patch->Callbacks->DeltaPatchWriteNew( patch->WriteOffset, patch->Buffer, patch->BufferIndex ) != 0 )
+    {
+        patch->Status = DELTA_PATCH_ERROR_WRITE;
+    }
+    patch->WriteOffset += patch->BufferIndex;
+    patch->BufferIndex = 0;
+}
+
+/*!
+ * \brief Appends bytes to the new image. The old image bytes of a COPY are
+ *        read straight into the write buffer.
+ *
+ * \param [IN] patch Patcher instance
+ * \param [IN] data  Bytes to append, NULL to copy from the old image
+ * \param [IN] size  Number of bytes to append
+ */
+static void DeltaPatchAppend( DeltaPatch_t *patch, uint8_t *data, uint32_t size )
+{
+    while( ( size > 0 ) && ( patch->Status == DELTA_PATCH_ONGOING ) )
+    {
+        uint32_t chunk = MIN( size, ( uint32_t )( DELTA_PATCH_BUFFER_SIZE - patch->BufferIndex ) );
+
+        if( data == NULL )
+        {
+            if( patch->Callbacks->DeltaPatchReadOld( patch->OldOffset, patch->Buffer + patch->BufferIndex, chunk ) != 0 )
+            {
+                patch->Status = DELTA_PATCH_ERROR_READ;
+                return;
+            }
+            patch->OldOffset += chunk;
+        }
+        else
+        {
+            memcpy1( patch->Buffer + patch->BufferIndex, data, chunk );
+            data += chunk;
+        }
+        patch->Crc = Crc32Update( patch->Crc, patch->Buffer + patch->BufferIndex, chunk );
+        patch->BufferIndex += chunk;
+        patch->NewOffset += chunk;
+        patch->Length -= chunk;
+        size -= chunk;
+
+        if( patch->BufferIndex == DELTA_PATCH_BUFFER_SIZE )
+        {
+            DeltaPatchFlush( patch );
+        }
+    }
+}
+
+/*!
+ * \brief Ends the current command and checks the new image once complete
+ *
+ * \param [IN] patch Patcher instance
+ */
+static void DeltaPatchNextCommand( DeltaPatch_t *patch )
+{
+    patch->State = DELTA_PATCH_STATE_COMMAND;
+    if( ( patch->Status == DELTA_PATCH_ONGOING ) && ( patch->NewOffset == patch->NewSize ) )
+    {
+        DeltaPatchFlush( patch );
+        if( patch->Status == DELTA_PATCH_ONGOING )
+        {
+            patch->Status = ( Crc32Finalize( patch->Crc ) == patch->NewCrc ) ? DELTA_PATCH_DONE : DELTA_PATCH_ERROR_CRC;
+        }
+    }
+}
+
+void DeltaPatchInit( DeltaPatch_t *patch, uint32_t oldMaxSize, uint32_t newMaxSize, DeltaPatchCallbacks_t *callbacks )
+{
+    memset1( ( uint8_t* )patch, 0, sizeof( DeltaPatch_t ) );
+    patch->Callbacks = callbacks;
+    patch->OldMaxSize = oldMaxSize;
+    patch->NewMaxSize = newMaxSize;
+    patch->Crc = Crc32Init( );
+    patch->State = DELTA_PATCH_STATE_HEADER;
+    patch->Status = DELTA_PATCH_ONGOING;
+}
+
+DeltaPatchStatus_t DeltaPatchProcess( DeltaPatch_t *patch, uint8_t *data, uint32_t size )
+{
+    uint32_t index = 0;
+
+    while( ( index < size ) && ( patch->Status == DELTA_PATCH_ONGOING ) )
+    {
+        switch( patch->State )
+        {
+            case DELTA_PATCH_STATE_HEADER:
+            {
+                // The header is gathered in the still unused write buffer
+                patch->Buffer[patch->BufferIndex++] = data[index++];
+                if( patch->BufferIndex == DELTA_PATCH_HEADER_SIZE )
+                {
+                    patch->OldSize = DeltaPatchRead32( patch->Buffer + 4 );
+                    patch->NewSize = DeltaPatchRead32( patch->Buffer + 8 );
+                    patch->NewCrc = DeltaPatchRead32( patch->Buffer + 12 );
+                    patch->BufferIndex = 0;
+                    if( ( DeltaPatchRead32( patch->Buffer ) != DELTA_PATCH_MAGIC ) ||
+                        ( patch->OldSize > patch->OldMaxSize ) || ( patch->NewSize > patch->NewMaxSize ) )
+                    {
+                        patch->Status = DELTA_PATCH_ERROR_HEADER;
+                        break;
+                    }
+                    DeltaPatchNextCommand( patch );
+                }
+                break;
+            }
+            case DELTA_PATCH_STATE_COMMAND:
+            {
+                if( DeltaPatchVarint( patch, data[index++] ) == true )
+                {
+                    patch->Length = patch->Varint >> 1;
+                    patch->State = ( ( patch->Varint & 1 ) != 0 ) ? DELTA_PATCH_STATE_OFFSET : DELTA_PATCH_STATE_INSERT;
+                    patch->Varint = 0;
+                    patch->VarintShift = 0;
+                    if( ( patch->Length == 0 ) || ( patch->Length > ( patch->NewSize - patch->NewOffset ) ) )
+                    {
+                        patch->Status = DELTA_PATCH_ERROR_FORMAT;
+                    }
+                }
+                break;
+            }
+            case DELTA_PATCH_STATE_OFFSET:
+            {
+                if( DeltaPatchVarint( patch, data[index++] ) == true )
+                {
+                    // ZigZag decoding, the offset wraps around on underflow
+                    if( ( patch->Varint & 1 ) == 0 )
+                    {
+                        patch->OldOffset += patch->Varint >> 1;
+                    }
+                    else
+                    {
+                        patch->OldOffset -= ( patch->Varint >> 1 ) + 1;
+                    }
+                    patch->Varint = 0;
+                    patch->VarintShift = 0;
+                    if( ( patch->OldOffset > patch->OldSize ) || ( patch->Length > ( patch->OldSize - patch->OldOffset ) ) )
+                    {
+                        patch->Status = DELTA_PATCH_ERROR_FORMAT;
+                        break;
+                    }
+                    DeltaPatchAppend( patch, NULL, patch->Length );
+                    DeltaPatchNextCommand( patch );
+                }
+                break;
+            }
+            case DELTA_PATCH_STATE_INSERT:
+            {
+                uint32_t chunk = MIN( patch->Length, size - index );
+
+                DeltaPatchAppend( patch, data + index, chunk );
+                index += chunk;
+                if( patch->Length == 0 )
+                {
+                    DeltaPatchNextCommand( patch );
+                }
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+    return patch->Status;
+}
+
+DeltaPatchStatus_t DeltaPatchFinish( DeltaPatch_t *patch )
+{
+    if( patch->Status == DELTA_PATCH_ONGOING )
+    {
+        patch->Status = DELTA_PATCH_ERROR_TRUNCATED;
+    }
+    return patch->Status;
+}
+
+uint32_t DeltaPatchGetProgress( DeltaPatch_t *patch )
+{
+    return patch->NewOffset;
+}
@@ -0,0 +1,196 @@
+/*!
+ * \file      DeltaPatch.h
+ *
+ * \brief     Implements a streaming binary delta patcher rebuilding a new
+ *            firmware image from the running one while the delta file is
+ *            received ( e.g. through \ref LmhpFragmentation ).
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * Delta file format ( little endian ), as generated by the `delta` command of
+ * prepareimage.py:
+ *
+ *   Header  : Magic (4) | Old image size (4) | New image size (4) |
+ *             New image CRC32 (4)
+ *   Command : Varint ( Length << 1 | IsCopy ) followed by
+ *             - COPY   : ZigZag varint offset of the copied old image bytes,
+ *                        relative to the end of the previous COPY
+ *             - INSERT : Length literal bytes
+ *
+ * Commands are applied in order until the new image size is reached, any
+ * trailing byte ( e.g. fragmentation padding ) is ignored.
+ */
+#ifndef __DELTA_PATCH_H__
+#define __DELTA_PATCH_H__
+
+#include <stdint.h>
+
+/*!
+ * Delta file magic number ( "DELT" )
+ */
+#define DELTA_PATCH_MAGIC                           0x544C4544
+
+/*!
+ * Delta file header size
+ */
+#define DELTA_PATCH_HEADER_SIZE                     16
+
+/*!
+ * Size of the new image write buffer. Every write but the last one is made of
+ * DELTA_PATCH_BUFFER_SIZE bytes, at an offset multiple of it.
+ *
+ * \remark Must be a multiple of the flash programming granularity and at least
+ *         DELTA_PATCH_HEADER_SIZE. This parameter has an impact on the memory
+ *         footprint of each \ref DeltaPatch_t instance.
+ */
+#ifndef DELTA_PATCH_BUFFER_SIZE
+#define DELTA_PATCH_BUFFER_SIZE                     128
+#endif
+
+typedef enum eDeltaPatchStatus
+{
+    /*!
+     * More delta data is expected
+     */
+    DELTA_PATCH_ONGOING = 0,
+    /*!
+     * The new image is written and its CRC is correct
+     */
+    DELTA_PATCH_DONE,
+    /*!
+     * The delta does not apply to the old image or its new image does not
+     * fit in the slot
+     */
+    DELTA_PATCH_ERROR_HEADER,
+    /*!
+     * A delta command is out of the images bounds
+     */
+    DELTA_PATCH_ERROR_FORMAT,
+    /*!
+     * The old image could not be read
+     */
+    DELTA_PATCH_ERROR_READ,
+    /*!
+     * The new image could not be written
+     */
+    DELTA_PATCH_ERROR_WRITE,
+    /*!
+     * The new image CRC is wrong
+     */
+    DELTA_PATCH_ERROR_CRC,
+    /*!
+     * The delta file ended before the new image was complete
+     */
+    DELTA_PATCH_ERROR_TRUNCATED,
+}DeltaPatchStatus_t;
+
+typedef struct sDeltaPatchCallbacks
+{
+    /*!
+     * Reads `data` buffer of `size` starting at offset `addr` of the old
+     * ( running ) image
+     *
+     * \param [IN] addr Offset from the old image start to read from.
+     * \param [IN] data Data buffer to be read.
+     * \param [IN] size Size of data buffer to be read.
+     *
+     * \retval status Read operation status [0: Success, -1 Fail]
+     */
+    uint8_t ( *DeltaPatchReadOld )( uint32_t addr, uint8_t *data, uint32_t size );
+    /*!
+     * Writes `data` buffer of `size` starting at offset `addr` of the new
+     * image slot ( e.g. SE_IMG_Write ). The slot must not overlap the old
+     * image.
+     *
+     * \param [IN] addr Offset from the new image start to write to.
+     * \param [IN] data Data buffer to be written.
+     * \param [IN] size Size of data buffer to be written.
+     *
+     * \retval status Write operation status [0: Success, -1 Fail]
+     */
+    uint8_t ( *DeltaPatchWriteNew )( uint32_t addr, uint8_t *data, uint32_t size );
+}DeltaPatchCallbacks_t;
+
+/*!
+ * Delta patcher instance
+ */
+typedef struct sDeltaPatch
+{
+    DeltaPatchCallbacks_t *Callbacks;
+    uint32_t OldMaxSize;
+    uint32_t NewMaxSize;
+    uint32_t OldSize;
+    uint32_t NewSize;
+    uint32_t NewCrc;
+    uint32_t Crc;
+    uint32_t OldOffset;
+    uint32_t NewOffset;
+    uint32_t WriteOffset;
+    uint32_t Length;
+    uint32_t Varint;
+    uint8_t VarintShift;
+    uint8_t State;
+    uint16_t BufferIndex;
+    uint8_t Buffer[DELTA_PATCH_BUFFER_SIZE];
+    DeltaPatchStatus_t Status;
+}DeltaPatch_t;
+
+/*!
+ * \brief Initializes the delta patcher
+ *
+ * \param [IN] patch      Patcher instance
+ * \param [IN] oldMaxSize Readable size of the old image
+ * \param [IN] newMaxSize Writable size of the new image slot
+ * \param [IN] callbacks  Pointer to the old image read / new image write
+ *                        functions.
+ */
+void DeltaPatchInit( DeltaPatch_t *patch, uint32_t oldMaxSize, uint32_t newMaxSize, DeltaPatchCallbacks_t *callbacks );
+
+/*!
+ * \brief Applies the next bytes of the delta file. Called with the delta file
+ *        chunks in order, e.g. from \ref LmhpFragmentationParams_t.OnRowsReady
+ *        with the newly available rows.
+ *
+ * \param [IN] patch Patcher instance
+ * \param [IN] data  Delta file chunk
+ * \param [IN] size  Delta file chunk size
+ *
+ * \retval status    Patch status. Once different from DELTA_PATCH_ONGOING
+ *                   the following calls have no effect.
+ */
+DeltaPatchStatus_t DeltaPatchProcess( DeltaPatch_t *patch, uint8_t *data, uint32_t size );
+
+/*!
+ * \brief Ends the delta file. To be called once the whole file was given to
+ *        \ref DeltaPatchProcess, e.g. from \ref LmhpFragmentationParams_t.OnDone:
+ *        a corrupted delta may describe a shorter image, which would leave
+ *        \ref DeltaPatchProcess ongoing.
+ *
+ * \param [IN] patch Patcher instance
+ *
+ * \retval status    Final patch status, DELTA_PATCH_ERROR_TRUNCATED when the
+ *                   new image is not complete
+ */
+DeltaPatchStatus_t DeltaPatchFinish( DeltaPatch_t *patch );
+
+/*!
+ * \brief Gets the number of new image bytes already rebuilt
+ *
+ * \param [IN] patch Patcher instance
+ *
+ * \retval size      Rebuilt size
+ */
+uint32_t DeltaPatchGetProgress( DeltaPatch_t *patch );
+
+#endif // __DELTA_PATCH_H__
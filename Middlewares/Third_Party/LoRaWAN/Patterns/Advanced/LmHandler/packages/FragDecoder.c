@@ -48,67 +48,25 @@
  *=============================================================================
  */
 
-typedef struct
-{
-#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-    FragDecoderCallbacks_t *Callbacks;
-#else
-    uint8_t *File;
-    uint32_t FileSize;
-#endif
-    uint16_t FragNb;
-    uint8_t FragSize;
-
-    uint32_t M2BLine;
-    uint8_t MatrixM2B[( ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 ) * FRAG_MAX_REDUNDANCY];
-    uint16_t FragNbMissingIndex[FRAG_MAX_NB];
-
-    uint8_t S[( FRAG_MAX_REDUNDANCY >> 3 ) + 1];
-
-    FragDecoderStatus_t Status;
-}FragDecoder_t;
-
-#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
 /*!
- * \brief Sets a row from source into file destination
+ * \brief Sets a row from source into the decoder file
  *
- * \param [IN] src  Source buffer pointer
- * \param [IN] row  Destination index of the row to be copied
- * \param [IN] size Source number of bytes to be copied
+ * \param [IN] decoder Decoder instance
+ * \param [IN] src     Source buffer pointer
+ * \param [IN] row     Destination index of the row to be copied
+ * \param [IN] size    Source number of bytes to be copied
  */
-static void SetRow( uint8_t *src, uint16_t row, uint16_t size );
-#else
-/*!
- * \brief Sets a row from source into destination
- *
- * \param [IN] dst  Destination buffer pointer
- * \param [IN] src  Source buffer pointer
- * \param [IN] row  Destination index of the row to be copied
- * \param [IN] size Source number of bytes to be copied
- */
-static void SetRow( uint8_t *dst, uint8_t *src, uint16_t row, uint16_t size );
-#endif
+static void SetRow( FragDecoder_t *decoder, uint8_t *src, uint16_t row, uint16_t size );
 
-#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
 /*!
- * \brief Gets a row from source and stores it into file destination
+ * \brief Gets a row from the decoder file and stores it into destination
  *
- * \param [IN] src  Source buffer pointer
- * \param [IN] row  Source index of the row to be copied
- * \param [IN] size Source number of bytes to be copied
+ * \param [IN] decoder Decoder instance
+ * \param [IN] dst     Destination buffer pointer
+ * \param [IN] row     Source index of the row to be copied
+ * \param [IN] size    Source number of bytes to be copied
  */
-static void GetRow( uint8_t *src, uint16_t row, uint16_t size );
-#else
-/*!
- * \brief Gets a row from source and stores it into destination
- *
- * \param [IN] dst  Destination buffer pointer
- * \param [IN] src  Source buffer pointer
- * \param [IN] row  Source index of the row to be copied
- * \param [IN] size Source number of bytes to be copied
- */
-static void GetRow( uint8_t *dst, uint8_t *src, uint16_t row, uint16_t size );
-#endif
+static void GetRow( FragDecoder_t *decoder, uint8_t *dst, uint16_t row, uint16_t size );
 
 /*!
  * \brief Gets the parity value from a given row of the parity matrix
@@ -199,37 +157,41 @@ static uint8_t BitArrayIsAllZeros( uint8_t *bitArray, uint16_t  size );
 /*!
  * \brief Finds & marks missing fragments
  *
+ * \param [IN]  decoder Decoder instance
  * \param [IN]  counter Current fragment counter
- * \param [OUT] FragDecoder.FragNbMissingIndex[] array is updated in place
+ * \param [OUT] decoder->FragNbMissingIndex[] array is updated in place
  */
-static void FragFindMissingFrags( uint16_t counter );
+static void FragFindMissingFrags( FragDecoder_t *decoder, uint16_t counter );
 
 /*!
  * \brief Finds the index (frag counter) of the x th missing frag
  *
- * \param [IN] x   x th missing frag
+ * \param [IN] decoder Decoder instance
+ * \param [IN] x       x th missing frag
  *
  * \retval counter The counter value associated to the x th missing frag
  */
-static uint16_t FragFindMissingIndex( uint16_t x );
+static uint16_t FragFindMissingIndex( FragDecoder_t *decoder, uint16_t x );
 
 /*!
  * \brief Extacts a row from the binary matrix and expands it to a bitArray
  *
+ * \param [IN] decoder   Decoder instance
  * \param [IN] bitArray  Pointer to the bit array
  * \param [IN] rowIndex  Matrix row index
  * \param [IN] bitsInRow Number of bits in one row
  */
-static void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
+static void FragExtractLineFromBinaryMatrix( FragDecoder_t *decoder, uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
 
 /*!
  * \brief Collapses and Pushs a row of a bit array to the matrix
  *
+ * \param [IN] decoder   Decoder instance
  * \param [IN] bitArray  Pointer to the bit array
  * \param [IN] rowIndex  Matrix row index
  * \param [IN] bitsInRow Number of bits in one row
  */
-static void FragPushLineToBinaryMatrix( uint8_t *bitArray, uint16_t rowIndex, uint16_t bitsInRow );
+static void FragPushLineToBinaryMatrix( FragDecoder_t *decoder, uint8_t *bitArray, uint16_t rowIndex, uint16_t bitsInRow );
 
 /*
  *=============================================================================
@@ -237,57 +199,58 @@ static void FragPushLineToBinaryMatrix( uint8_t *bitArray, uint16_t rowIndex, ui
  *=============================================================================
  */
 
-static FragDecoder_t FragDecoder;
-
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-void FragDecoderInit( uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks_t *callbacks )
+void FragDecoderInit( FragDecoder_t *decoder, uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks_t *callbacks )
 #else
-void FragDecoderInit( uint16_t fragNb, uint8_t fragSize, uint8_t *file, uint32_t fileSize )
+void FragDecoderInit( FragDecoder_t *decoder, uint16_t fragNb, uint8_t fragSize, uint8_t *file, uint32_t fileSize )
 #endif
 {
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-    FragDecoder.Callbacks = callbacks;
+    decoder->Callbacks = callbacks;
 #else
-    FragDecoder.File = file;
-    FragDecoder.FileSize = fileSize;
+    decoder->File = file;
+    decoder->FileSize = fileSize;
 #endif
-    FragDecoder.FragNb = fragNb;                                // FragNb = FRAG_MAX_SIZE
-    FragDecoder.FragSize = fragSize;                            // number of byte on a row
-    FragDecoder.Status.FragNbLastRx = 0;
-    FragDecoder.Status.FragNbLost = 0;
-    FragDecoder.M2BLine = 0;
+    decoder->FragNb = fragNb;                                // FragNb = FRAG_MAX_SIZE
+    decoder->FragSize = fragSize;                            // number of byte on a row
+    decoder->Status.FragNbRx = 0;
+    decoder->Status.FragNbLastRx = 0;
+    decoder->Status.FragNbLost = 0;
+    decoder->Status.MatrixError = 0;
+    decoder->M2BLine = 0;
+    decoder->FragNbContiguous = 0;
 
     // Initialize missing fragments index array
     for( uint16_t i = 0; i < FRAG_MAX_NB; i++ )
     {
-        FragDecoder.FragNbMissingIndex[i] = 1;
+        decoder->FragNbMissingIndex[i] = 1;
     }
 
     // Initialize parity matrix
     for( uint32_t i = 0; i < ( ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 ); i++ )
     {
-        FragDecoder.S[i] = 0;
+        decoder->S[i] = 0;
     }
 
     for( uint32_t i = 0; i < ( ( ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 ) * FRAG_MAX_REDUNDANCY ); i++ )
     {
-       FragDecoder.MatrixM2B[i] = 0xFF;
+       decoder->MatrixM2B[i] = 0xFF;
     }
     
     // Initialize final uncoded data buffer ( FRAG_MAX_NB * FRAG_MAX_SIZE )
     for( uint32_t i = 0; i < ( fragNb * fragSize ); i++ )
     {
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-        if( ( FragDecoder.Callbacks != NULL ) && ( FragDecoder.Callbacks->FragDecoderWrite != NULL ) )
+        if( ( decoder->Callbacks != NULL ) && ( decoder->Callbacks->FragDecoderWrite != NULL ) )
         {
-            FragDecoder.Callbacks->FragDecoderWrite( i, ( uint8_t[] ){ 0xFF }, 1 );
+            decoder->Callbacks->FragDecoderWrite( i, ( uint8_t[] ){ 0xFF }, 1 );
         }
 #else
-        FragDecoder.File[i] = 0xFF;
+        decoder->File[i] = 0xFF;
 #endif
     }
-    FragDecoder.Status.FragNbLost = 0;
-    FragDecoder.Status.FragNbLastRx = 0;
+    decoder->Status.FragNbLost = 0;
+    decoder->Status.FragNbLastRx = 0;
 }
 
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
@@ -297,7 +260,7 @@ uint32_t FragDecoderGetMaxFileSize( void )
 }
 #endif
 
-int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData )
+int32_t FragDecoderProcess( FragDecoder_t *decoder, uint16_t fragCounter, uint8_t *rawData )
 {
     uint16_t firstOneInRow = 0;
     int32_t first = 0;
@@ -313,70 +276,62 @@ int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData )
     memset1( dataTempVector, 0, ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 );
     memset1( dataTempVector2, 0, ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 );
 
-    FragDecoder.Status.FragNbRx = fragCounter;
+    decoder->Status.FragNbRx = fragCounter;
 
-    if( fragCounter < FragDecoder.Status.FragNbLastRx )
+    if( fragCounter < decoder->Status.FragNbLastRx )
     {
         return FRAG_SESSION_ONGOING;  // Drop frame out of order
     }
 
     // The M (FragNb) first packets aren't encoded or in other words they are
     // encoded with the unitary matrix
-    if( fragCounter < ( FragDecoder.FragNb + 1 ) )
+    if( fragCounter < ( decoder->FragNb + 1 ) )
     {
         // The M first frame are not encoded store them
-#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-        SetRow( rawData, fragCounter - 1, FragDecoder.FragSize );
-#else
-        SetRow( FragDecoder.File, rawData, fragCounter - 1, FragDecoder.FragSize );
-#endif
+        SetRow( decoder, rawData, fragCounter - 1, decoder->FragSize );
 
-        FragDecoder.FragNbMissingIndex[fragCounter - 1] = 0;
+        decoder->FragNbMissingIndex[fragCounter - 1] = 0;
 
-        // Update the FragDecoder.FragNbMissingIndex with the loosing frame
-        FragFindMissingFrags( fragCounter );
+        // Update the decoder->FragNbMissingIndex with the loosing frame
+        FragFindMissingFrags( decoder, fragCounter );
     }
     else
     {
-        if( FragDecoder.Status.FragNbLost > FRAG_MAX_REDUNDANCY )
+        if( decoder->Status.FragNbLost > FRAG_MAX_REDUNDANCY )
         {
-           FragDecoder.Status.MatrixError = 1;
+           decoder->Status.MatrixError = 1;
            return FRAG_SESSION_FINISHED;
         }
         // At this point we receive encoded frames and the number of loosing frames
-        // is well known: FragDecoder.FragNbLost - 1;
+        // is well known: decoder->FragNbLost - 1;
 
         // In case of the end of true data is missing
-        FragFindMissingFrags( fragCounter );
+        FragFindMissingFrags( decoder, fragCounter );
 
-        if( FragDecoder.Status.FragNbLost == 0 )
+        if( decoder->Status.FragNbLost == 0 )
         { 
             // the case : all the M(FragNb) first rows have been transmitted with no error
-            return FragDecoder.Status.FragNbLost;
+            return decoder->Status.FragNbLost;
         }
 
-        // fragCounter - FragDecoder.FragNb
-        FragGetParityMatrixRow( fragCounter - FragDecoder.FragNb, FragDecoder.FragNb, matrixRow );
+        // fragCounter - decoder->FragNb
+        FragGetParityMatrixRow( fragCounter - decoder->FragNb, decoder->FragNb, matrixRow );
 
-        for( int32_t i = 0; i < FragDecoder.FragNb; i++ )
+        for( int32_t i = 0; i < decoder->FragNb; i++ )
         {
             if( GetParity( i , matrixRow ) == 1 )
             {
-                if( FragDecoder.FragNbMissingIndex[i] == 0 )
+                if( decoder->FragNbMissingIndex[i] == 0 )
                 {
                     // XOR with already receive frag
                     SetParity( i, matrixRow, 0 );
-#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                    GetRow( matrixDataTemp, i, FragDecoder.FragSize );
-#else
-                    GetRow( matrixDataTemp, FragDecoder.File, i, FragDecoder.FragSize );
-#endif
-                    XorDataLine( rawData, matrixDataTemp, FragDecoder.FragSize );
+                    GetRow( decoder, matrixDataTemp, i, decoder->FragSize );
+                    XorDataLine( rawData, matrixDataTemp, decoder->FragSize );
                 }
                 else
                 {
                     // Fill the "little" boolean matrix m2b
-                    SetParity( FragDecoder.FragNbMissingIndex[i] - 1, dataTempVector, 1 );
+                    SetParity( decoder->FragNbMissingIndex[i] - 1, dataTempVector, 1 );
                     if( first == 0 )
                     {
                         first = 1;
@@ -385,7 +340,7 @@ int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData )
             }
         }
 
-        firstOneInRow = BitArrayFindFirstOne( dataTempVector, FragDecoder.Status.FragNbLost );
+        firstOneInRow = BitArrayFindFirstOne( dataTempVector, decoder->Status.FragNbLost );
 
         if( first > 0 )
         {
@@ -393,85 +348,65 @@ int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData )
             int32_t lj;
 
             // Manage a new line in MatrixM2B
-            while( GetParity( firstOneInRow, FragDecoder.S ) == 1 )
+            while( GetParity( firstOneInRow, decoder->S ) == 1 )
             { 
-                // Row already diagonalized exist & ( FragDecoder.MatrixM2B[firstOneInRow][0] )
-                FragExtractLineFromBinaryMatrix( dataTempVector2, firstOneInRow, FragDecoder.Status.FragNbLost );
-                XorParityLine( dataTempVector, dataTempVector2, FragDecoder.Status.FragNbLost );
+                // Row already diagonalized exist & ( decoder->MatrixM2B[firstOneInRow][0] )
+                FragExtractLineFromBinaryMatrix( decoder, dataTempVector2, firstOneInRow, decoder->Status.FragNbLost );
+                XorParityLine( dataTempVector, dataTempVector2, decoder->Status.FragNbLost );
                 // Have to store it in the mi th position of the missing frag
-                li = FragFindMissingIndex( firstOneInRow );
-#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                GetRow( matrixDataTemp, li, FragDecoder.FragSize );
-#else
-                GetRow( matrixDataTemp, FragDecoder.File, li, FragDecoder.FragSize );
-#endif
-                XorDataLine( rawData, matrixDataTemp, FragDecoder.FragSize );
-                if( BitArrayIsAllZeros( dataTempVector, FragDecoder.Status.FragNbLost ) )
+                li = FragFindMissingIndex( decoder, firstOneInRow );
+                GetRow( decoder, matrixDataTemp, li, decoder->FragSize );
+                XorDataLine( rawData, matrixDataTemp, decoder->FragSize );
+                if( BitArrayIsAllZeros( dataTempVector, decoder->Status.FragNbLost ) )
                 {
                     noInfo = 1;
                     break;
                 }
-                firstOneInRow = BitArrayFindFirstOne( dataTempVector, FragDecoder.Status.FragNbLost );
+                firstOneInRow = BitArrayFindFirstOne( dataTempVector, decoder->Status.FragNbLost );
             }
 
             if( noInfo == 0 )
             {
-                FragPushLineToBinaryMatrix( dataTempVector, firstOneInRow, FragDecoder.Status.FragNbLost );
-                li = FragFindMissingIndex( firstOneInRow );
-#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                SetRow( rawData, li, FragDecoder.FragSize );
-#else
-                SetRow( FragDecoder.File, rawData, li, FragDecoder.FragSize );
-#endif
-                SetParity( firstOneInRow, FragDecoder.S, 1 );
-                FragDecoder.M2BLine++;
+                FragPushLineToBinaryMatrix( decoder, dataTempVector, firstOneInRow, decoder->Status.FragNbLost );
+                li = FragFindMissingIndex( decoder, firstOneInRow );
+                SetRow( decoder, rawData, li, decoder->FragSize );
+                SetParity( firstOneInRow, decoder->S, 1 );
+                decoder->M2BLine++;
             }
 
-            if( FragDecoder.M2BLine == FragDecoder.Status.FragNbLost )
+            if( decoder->M2BLine == decoder->Status.FragNbLost )
             { 
                 // Then last step diagonalized
-                if( FragDecoder.Status.FragNbLost > 1 )
+                if( decoder->Status.FragNbLost > 1 )
                 {
                     int32_t i, j;
 
-                    for( i = ( FragDecoder.Status.FragNbLost - 2 ); i >= 0 ; i-- )
+                    for( i = ( decoder->Status.FragNbLost - 2 ); i >= 0 ; i-- )
                     {
-                        li = FragFindMissingIndex( i );
-#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                        GetRow( matrixDataTemp, li, FragDecoder.FragSize );
-#else
-                        GetRow( matrixDataTemp, FragDecoder.File, li, FragDecoder.FragSize );
-#endif
-                        for( j = ( FragDecoder.Status.FragNbLost - 1 ); j > i; j--)
+                        li = FragFindMissingIndex( decoder, i );
+                        GetRow( decoder, matrixDataTemp, li, decoder->FragSize );
+                        for( j = ( decoder->Status.FragNbLost - 1 ); j > i; j--)
                         {
-                            FragExtractLineFromBinaryMatrix( dataTempVector2, i, FragDecoder.Status.FragNbLost );
-                            FragExtractLineFromBinaryMatrix( dataTempVector, j, FragDecoder.Status.FragNbLost );
+                            FragExtractLineFromBinaryMatrix( decoder, dataTempVector2, i, decoder->Status.FragNbLost );
+                            FragExtractLineFromBinaryMatrix( decoder, dataTempVector, j, decoder->Status.FragNbLost );
                             if( GetParity( j, dataTempVector2 ) == 1 )
                             {
-                                XorParityLine( dataTempVector2, dataTempVector, FragDecoder.Status.FragNbLost );
+                                XorParityLine( dataTempVector2, dataTempVector, decoder->Status.FragNbLost );
 
-                                lj = FragFindMissingIndex( j );
+                                lj = FragFindMissingIndex( decoder, j );
 
-#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                                GetRow( rawData, lj, FragDecoder.FragSize );
-#else
-                                GetRow( rawData, FragDecoder.File, lj, FragDecoder.FragSize );
-#endif
-                                XorDataLine( matrixDataTemp , rawData , FragDecoder.FragSize );
+                                GetRow( decoder, rawData, lj, decoder->FragSize );
+                                XorDataLine( matrixDataTemp , rawData , decoder->FragSize );
                             }
                         }
-#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                        SetRow( matrixDataTemp, li, FragDecoder.FragSize );
-#else
-                        SetRow( FragDecoder.File, matrixDataTemp, li, FragDecoder.FragSize );
-#endif
+                        SetRow( decoder, matrixDataTemp, li, decoder->FragSize );
                     }
-                    return FragDecoder.Status.FragNbLost;
+                    return decoder->Status.FragNbLost;
                 }
                 else
                 { 
-                    //If not ( FragDecoder.FragNbLost > 1 )
-                    return FragDecoder.Status.FragNbLost;
+                    //If not ( decoder->FragNbLost > 1 )
+                    return decoder->Status.FragNbLost;
                 }
             }
         }
@@ -479,9 +414,19 @@ int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData )
     return FRAG_SESSION_ONGOING;
 }
 
-FragDecoderStatus_t FragDecoderGetStatus( void )
+uint16_t FragDecoderGetNbContiguous( FragDecoder_t *decoder )
+{
+    while( ( decoder->FragNbContiguous < decoder->FragNb ) &&
+           ( decoder->FragNbMissingIndex[decoder->FragNbContiguous] == 0 ) )
+    {
+        decoder->FragNbContiguous++;
+    }
+    return decoder->FragNbContiguous;
+}
+
+FragDecoderStatus_t FragDecoderGetStatus( FragDecoder_t *decoder )
 { 
-    return FragDecoder.Status;
+    return decoder->Status;
 }
 
 /*
@@ -490,33 +435,29 @@ FragDecoderStatus_t FragDecoderGetStatus( void )
  *=============================================================================
  */
 
-#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-static void SetRow( uint8_t *src, uint16_t row, uint16_t size )
+static void SetRow( FragDecoder_t *decoder, uint8_t *src, uint16_t row, uint16_t size )
 {
-    if( ( FragDecoder.Callbacks != NULL ) && ( FragDecoder.Callbacks->FragDecoderWrite != NULL ) )
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+    if( ( decoder->Callbacks != NULL ) && ( decoder->Callbacks->FragDecoderWrite != NULL ) )
     {
-        FragDecoder.Callbacks->FragDecoderWrite( row * size, src, size );
+        decoder->Callbacks->FragDecoderWrite( row * size, src, size );
     }
+#else
+    memcpy1( &decoder->File[row * size], src, size );
+#endif
 }
 
-static void GetRow( uint8_t *dst, uint16_t row, uint16_t size )
+static void GetRow( FragDecoder_t *decoder, uint8_t *dst, uint16_t row, uint16_t size )
 {
-    if( ( FragDecoder.Callbacks != NULL ) && ( FragDecoder.Callbacks->FragDecoderRead != NULL ) )
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+    if( ( decoder->Callbacks != NULL ) && ( decoder->Callbacks->FragDecoderRead != NULL ) )
     {
-        FragDecoder.Callbacks->FragDecoderRead( row * size, dst, size );
+        decoder->Callbacks->FragDecoderRead( row * size, dst, size );
     }
-}
 #else
-static void SetRow( uint8_t *dst, uint8_t *src, uint16_t row, uint16_t size )
-{
-    memcpy1( &dst[row * size], src, size );
-}
-
-static void GetRow( uint8_t *dst, uint8_t *src, uint16_t row, uint16_t size )
-{
-    memcpy1( dst, &src[row * size], size );
-}
+    memcpy1( dst, &decoder->File[row * size], size );
 #endif
+}
 
 static uint8_t GetParity( uint16_t index, uint8_t *matrixRow  )
 {
@@ -632,45 +573,47 @@ static uint8_t BitArrayIsAllZeros( uint8_t *bitArray, uint16_t  size )
 /*!
  * \brief Finds & marks missing fragments
  *
+ * \param [IN]  decoder Decoder instance
  * \param [IN]  counter Current fragment counter
- * \param [OUT] FragDecoder.FragNbMissingIndex[] array is updated in place
+ * \param [OUT] decoder->FragNbMissingIndex[] array is updated in place
  */
-static void FragFindMissingFrags( uint16_t counter )
+static void FragFindMissingFrags( FragDecoder_t *decoder, uint16_t counter )
 {
     int32_t i;
-    for( i = FragDecoder.Status.FragNbLastRx; i < ( counter - 1 ); i++ )
+    for( i = decoder->Status.FragNbLastRx; i < ( counter - 1 ); i++ )
     {
-        if( i < FragDecoder.FragNb )
+        if( i < decoder->FragNb )
         {
-            FragDecoder.Status.FragNbLost++;
-            FragDecoder.FragNbMissingIndex[i] = FragDecoder.Status.FragNbLost;
+            decoder->Status.FragNbLost++;
+            decoder->FragNbMissingIndex[i] = decoder->Status.FragNbLost;
         }
     }
-    if( i < FragDecoder.FragNb )
+    if( i < decoder->FragNb )
     {
-        FragDecoder.Status.FragNbLastRx = counter;
+        decoder->Status.FragNbLastRx = counter;
     }
     else
     {
-        FragDecoder.Status.FragNbLastRx = FragDecoder.FragNb + 1;
+        decoder->Status.FragNbLastRx = decoder->FragNb + 1;
     }
-    DBG( "RECEIVED    : %5d / %5d Fragments\r\n", FragDecoder.Status.FragNbRx, FragDecoder.FragNb );
-    DBG( "              %5d / %5d Bytes\r\n", FragDecoder.Status.FragNbRx * FragDecoder.FragSize, FragDecoder.FragNb * FragDecoder.FragSize );
-    DBG( "LOST        :       %7d Fragments\r\n\r\n", FragDecoder.Status.FragNbLost );
+    DBG( "RECEIVED    : %5d / %5d Fragments\r\n", decoder->Status.FragNbRx, decoder->FragNb );
+    DBG( "              %5d / %5d Bytes\r\n", decoder->Status.FragNbRx * decoder->FragSize, decoder->FragNb * decoder->FragSize );
+    DBG( "LOST        :       %7d Fragments\r\n\r\n", decoder->Status.FragNbLost );
 }
 
 /*!
  * \brief Finds the index (frag counter) of the x th missing frag
  *
- * \param [IN] x   x th missing frag
+ * \param [IN] decoder Decoder instance
+ * \param [IN] x       x th missing frag
  *
  * \retval counter The counter value associated to the x th missing frag
  */
-static uint16_t FragFindMissingIndex( uint16_t x )
+static uint16_t FragFindMissingIndex( FragDecoder_t *decoder, uint16_t x )
 {
-    for( uint16_t i = 0; i < FragDecoder.FragNb; i++ )
+    for( uint16_t i = 0; i < decoder->FragNb; i++ )
     {
-        if( FragDecoder.FragNbMissingIndex[i] == ( x + 1 ) )
+        if( decoder->FragNbMissingIndex[i] == ( x + 1 ) )
         {
             return i;
         }
@@ -681,11 +624,12 @@ static uint16_t FragFindMissingIndex( uint16_t x )
 /*!
  * \brief Extacts a row from the binary matrix and expands it to a bitArray
  *
+ * \param [IN] decoder   Decoder instance
  * \param [IN] bitArray  Pointer to the bit array
  * \param [IN] rowIndex  Matrix row index
  * \param [IN] bitsInRow Number of bits in one row
  */
-static void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow )
+static void FragExtractLineFromBinaryMatrix( FragDecoder_t *decoder, uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow )
 {
     uint32_t findByte = 0;
     uint32_t findBitInByte = 0;
@@ -706,7 +650,7 @@ static void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowInde
     {
         SetParity( i,
                    bitArray, 
-                   ( FragDecoder.MatrixM2B[findByte] >> ( 7 - findBitInByte ) ) & 0x01 );
+                   ( decoder->MatrixM2B[findByte] >> ( 7 - findBitInByte ) ) & 0x01 );
 
         findBitInByte++;
         if( findBitInByte == 8 )
@@ -720,11 +664,12 @@ static void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowInde
 /*!
  * \brief Collapses and Pushs a row of a bit array to the matrix
  *
+ * \param [IN] decoder   Decoder instance
  * \param [IN] bitArray  Pointer to the bit array
  * \param [IN] rowIndex  Matrix row index
  * \param [IN] bitsInRow Number of bits in one row
  */
-static void FragPushLineToBinaryMatrix( uint8_t *bitArray, uint16_t rowIndex, uint16_t bitsInRow )
+static void FragPushLineToBinaryMatrix( FragDecoder_t *decoder, uint8_t *bitArray, uint16_t rowIndex, uint16_t bitsInRow )
 {
     uint32_t findByte = 0;
     uint32_t findBitInByte = 0;
@@ -738,7 +683,7 @@ static void FragPushLineToBinaryMatrix( uint8_t *bitArray, uint16_t rowIndex, ui
     {
         if( GetParity( i, bitArray ) == 0 )
         {
-            FragDecoder.MatrixM2B[findByte] = FragDecoder.MatrixM2B[findByte] & ( 0xFF - ( 1 << ( 7 - findBitInByte ) ) );
+            decoder->MatrixM2B[findByte] = decoder->MatrixM2B[findByte] & ( 0xFF - ( 1 << ( 7 - findBitInByte ) ) );
         }
         findBitInByte++;
         if( findBitInByte == 8 )
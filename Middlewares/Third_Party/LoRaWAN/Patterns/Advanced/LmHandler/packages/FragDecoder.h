@@ -34,27 +34,36 @@
 /*!
  * Maximum number of fragment that can be handled.
  *
- * \remark This parameter has an impact on the memory footprint.
+ * \remark This parameter has an impact on the memory footprint of each
+ *         \ref FragDecoder_t instance.
  */
+#ifndef FRAG_MAX_NB
 #define FRAG_MAX_NB                                 21
+#endif
 
 /*!
  * Maximum fragment size that can be handled.
  *
  * \remark This parameter has an impact on the memory footprint.
  */
+#ifndef FRAG_MAX_SIZE
 #define FRAG_MAX_SIZE                               50
+#endif
 
 /*!
  * Maximum number of extra frames that can be handled.
  *
- * \remark This parameter has an impact on the memory footprint.
+ * \remark This parameter has an impact on the memory footprint of each
+ *         \ref FragDecoder_t instance.
  */
+#ifndef FRAG_MAX_REDUNDANCY
 #define FRAG_MAX_REDUNDANCY                         5
+#endif
 
 #define FRAG_SESSION_FINISHED                       ( int32_t )0
 #define FRAG_SESSION_NOT_STARTED                    ( int32_t )-2
 #define FRAG_SESSION_ONGOING                        ( int32_t )-1
+#define FRAG_SESSION_ABORTED                        ( int32_t )-3
 
 typedef struct sFragDecoderStatus
 {
@@ -90,25 +99,52 @@ typedef struct sFragDecoderCallbacks
 }FragDecoderCallbacks_t;
 #endif
 
+/*!
+ * Fragmentation decoder instance. Each fragmentation session being decoded
+ * concurrently needs its own instance.
+ */
+typedef struct sFragDecoder
+{
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+    FragDecoderCallbacks_t *Callbacks;
+#else
+    uint8_t *File;
+    uint32_t FileSize;
+#endif
+    uint16_t FragNb;
+    uint8_t FragSize;
+
+    uint32_t M2BLine;
+    uint8_t MatrixM2B[( ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 ) * FRAG_MAX_REDUNDANCY];
+    uint16_t FragNbMissingIndex[FRAG_MAX_NB];
+    uint16_t FragNbContiguous;
+
+    uint8_t S[( FRAG_MAX_REDUNDANCY >> 3 ) + 1];
+
+    FragDecoderStatus_t Status;
+}FragDecoder_t;
+
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
 /*!
  * \brief Initializes the fragmentation decoder
  *
+ * \param [IN] decoder    Decoder instance
  * \param [IN] fragNb     Number of expected fragments (without redundancy packets)
  * \param [IN] fragSize   Size of a fragment
  * \param [IN] callbacks  Pointer to the Write/Read functions.
  */
-void FragDecoderInit( uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks_t *callbacks );
+void FragDecoderInit( FragDecoder_t *decoder, uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks_t *callbacks );
 #else
 /*!
  * \brief Initializes the fragmentation decoder
  *
+ * \param [IN] decoder    Decoder instance
  * \param [IN] fragNb     Number of expected fragments (without redundancy packets)
  * \param [IN] fragSize   Size of a fragment
  * \param [IN] file       Pointer to file buffer size
  * \param [IN] fileSize   File buffer size
  */
-void FragDecoderInit( uint16_t fragNb, uint8_t fragSize, uint8_t *file, uint32_t fileSize );
+void FragDecoderInit( FragDecoder_t *decoder, uint16_t fragNb, uint8_t fragSize, uint8_t *file, uint32_t fileSize );
 #endif
 
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
@@ -124,20 +160,38 @@ uint32_t FragDecoderGetMaxFileSize( void );
  * \brief Function to decode and reconstruct the binary file
  *        Called for each receive frame
  * 
- * \param [IN] fragCounter Fragment counter [1..(FragDecoder.FragNb + FragDecoder.Redundancy)]
- * \param [IN] rawData     Pointer to the fragment to be processed (length = FragDecoder.FragSize)
+ * \param [IN] decoder     Decoder instance
+ * \param [IN] fragCounter Fragment counter [1..(decoder->FragNb + Redundancy)]
+ * \param [IN] rawData     Pointer to the fragment to be processed (length = decoder->FragSize)
  *
  * \retval status          Process status. [FRAG_SESSION_ONGOING,
  *                                          FRAG_SESSION_FINISHED or
- *                                          FragDecoder.Status.FragNbLost]
+ *                                          decoder->Status.FragNbLost]
  */
-int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData );
+int32_t FragDecoderProcess( FragDecoder_t *decoder, uint16_t fragCounter, uint8_t *rawData );
+
+/*!
+ * \brief Gets the number of leading fragments already received, in other
+ *        words the size in rows of the file prefix which content is final.
+ *
+ * \remark Allows the file to be consumed in order ( e.g. by a delta patcher )
+ *         while the remaining fragments are still being received. Rows
+ *         recovered from redundancy are only accounted once the session
+ *         is finished.
+ *
+ * \param [IN] decoder Decoder instance
+ *
+ * \retval nbRows Number of contiguous rows [0..decoder->FragNb]
+ */
+uint16_t FragDecoderGetNbContiguous( FragDecoder_t *decoder );
 
 /*!
  * \brief Gets the current fragmentation status
  * 
+ * \param [IN] decoder Decoder instance
+ *
  * \retval status Fragmentation decoder status
  */
-FragDecoderStatus_t FragDecoderGetStatus( void );
+FragDecoderStatus_t FragDecoderGetStatus( FragDecoder_t *decoder );
 
 #endif // __FRAG_DECODER_H__
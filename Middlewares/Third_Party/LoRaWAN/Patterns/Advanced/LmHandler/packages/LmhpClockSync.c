@@ -19,6 +19,8 @@
  *
  * \author    Miguel Luis ( Semtech )
  */
+#include "utilities.h"
+#include "timer.h"
 #include "systime.h"
 #include "LmHandler.h"
 #include "LmhpClockSync.h"
@@ -31,6 +33,47 @@
 #define CLOCK_SYNC_ID                               1
 #define CLOCK_SYNC_VERSION                          1
 
+/*!
+ * Shortest and longest AppTimeReq periods chosen by the drift tracking, in
+ * seconds. They match AppTimePeriodicityReq Period 0 and 12 ( 128 * 2^Period ),
+ * the longer network periods are clamped to CLOCK_SYNC_PERIOD_MAX
+ */
+#ifndef CLOCK_SYNC_PERIOD_MIN
+#define CLOCK_SYNC_PERIOD_MIN                       128
+#endif
+#ifndef CLOCK_SYNC_PERIOD_MAX
+#define CLOCK_SYNC_PERIOD_MAX                       524288
+#endif
+
+/*!
+ * Residual time error, in ms, the AppTimeReq period is adapted for
+ */
+#ifndef CLOCK_SYNC_MAX_ERROR
+#define CLOCK_SYNC_MAX_ERROR                        500
+#endif
+
+/*!
+ * Largest RTC frequency error tracked, in ppb. A correction beyond what such
+ * a drift explains is applied as a step and restarts the tracking
+ */
+#define CLOCK_SYNC_MAX_DRIFT                        200000
+
+/*!
+ * Shortest time since the reference over which the drift is estimated, in
+ * seconds
+ */
+#define CLOCK_SYNC_MIN_SAMPLE_INTERVAL              600
+
+/*!
+ * Minimum interval between two drift compensation slews, in ms
+ */
+#define CLOCK_SYNC_SLEW_PERIOD                      16000
+
+/*!
+ * Random dither applied to a network imposed AppTimeReq period, in seconds
+ */
+#define CLOCK_SYNC_PERIOD_DITHER                    30
+
 /*!
  * Package current context
  */
@@ -54,6 +97,64 @@ typedef struct LmhpClockSyncState_s
     bool AdrEnabledPrev;
     uint8_t NbTransPrev;
     uint8_t DataratePrev;
+    /*!
+     * Set while an AppTimeReq has not been answered
+     */
+    bool AppTimeAnsPending;
+    /*!
+     * Remaining AppTimeReq transmissions asked by ForceDeviceResyncReq
+     */
+    uint8_t ForceResyncNbTrans;
+    /*!
+     * True once a time correction has been received
+     */
+    bool IsSynchronized;
+    /*!
+     * Number of drift estimates made since the last step
+     */
+    uint8_t NbDriftSamples;
+    /*!
+     * Estimated RTC frequency error compensated by the slews, in ppb.
+     * Positive when the RTC runs slow
+     */
+    int32_t Drift;
+    /*!
+     * Sum of the slews and corrections applied since RefMcuTime, in ms.
+     * Dividing it by the elapsed time gives the drift with an error that
+     * shrinks as the reference gets older, whatever the resolution of the
+     * corrections ( 1 s for AppTimeAns )
+     */
+    int32_t Cumulative;
+    SysTime_t RefMcuTime;
+    /*!
+     * Slew not yet applied, in ms * 10^-9
+     */
+    int32_t SlewRemainder;
+    /*!
+     * System time offset as last set by this package. Any other value means
+     * the time has been corrected elsewhere ( DeviceTimeAns )
+     */
+    SysTime_t ExpectedOffset;
+    /*!
+     * MCU time of the last correction, slew and AppTimeReq
+     */
+    SysTime_t LastSyncMcuTime;
+    SysTime_t LastSlewMcuTime;
+    SysTime_t LastReqMcuTime;
+    /*!
+     * Current AppTimeReq period, in seconds
+     */
+    uint32_t Period;
+    /*!
+     * AppTimeReq period imposed by AppTimePeriodicityReq, in seconds. 0 when
+     * the period follows the observed drift
+     */
+    uint32_t NetworkPeriod;
+    /*!
+     * Statistics reported by LmhpClockSyncGetStatus
+     */
+    uint32_t NbAppTimeReq;
+    int32_t LastCorrection;
 }LmhpClockSyncState_t;
 
 typedef enum LmhpClockSyncMoteCmd_e
@@ -116,6 +217,27 @@ static void LmhpClockSyncOnMcpsConfirm( McpsConfirm_t *mcpsConfirm );
  */
 static void LmhpClockSyncOnMcpsIndication( McpsIndication_t *mcpsIndication );
 
+/*!
+ * Takes a time correction into account: updates the drift estimate and the
+ * AppTimeReq period and restarts the slew from the corrected time
+ *
+ * \param [IN] correction Applied time correction, in ms
+ * \param [IN] mcuTime    MCU time at which the correction was applied
+ */
+static void LmhpClockSyncDiscipline( int32_t correction, SysTime_t mcuTime );
+
+/*!
+ * Compensates the estimated drift accumulated since the last slew
+ *
+ * \param [IN] mcuTime    Current MCU time
+ */
+static void LmhpClockSyncSlew( SysTime_t mcuTime );
+
+/*!
+ * Function executed on AppTimeReq period timer event
+ */
+static void OnClockSyncTimerEvent( void *context );
+
 static LmhpClockSyncState_t LmhpClockSyncState =
 {
     .Initialized = false,
@@ -123,9 +245,25 @@ static LmhpClockSyncState_t LmhpClockSyncState =
     .TimeReqParam.Value = 0,
     .AppTimeReqPending = false,
     .AdrEnabledPrev = false,
-    .NbTransPrev = 0
+    .NbTransPrev = 0,
+    .AppTimeAnsPending = false,
+    .ForceResyncNbTrans = 0,
+    .IsSynchronized = false,
+    .NbDriftSamples = 0,
+    .Drift = 0,
+    .Cumulative = 0,
+    .SlewRemainder = 0,
+    .Period = CLOCK_SYNC_PERIOD_MIN,
+    .NetworkPeriod = 0,
+    .NbAppTimeReq = 0,
+    .LastCorrection = 0
 };
 
+/*!
+ * Wakes the MCU up when the next AppTimeReq is due
+ */
+static TimerEvent_t ClockSyncTimer;
+
 static LmhPackage_t LmhpClockSyncPackage =
 {
     .Port = CLOCK_SYNC_PORT,
@@ -150,6 +288,91 @@ LmhPackage_t *LmphClockSyncPackageFactory( void )
     return &LmhpClockSyncPackage;
 }
 
+/*!
+ * Returns a - b in ms, saturated to +/- CLOCK_SYNC_PERIOD_MAX seconds
+ */
+static int32_t SysTimeDiffMs( SysTime_t a, SysTime_t b )
+{
+    SysTime_t diff = SysTimeSub( a, b );
+    int32_t seconds = ( int32_t )diff.Seconds;
+
+    if( seconds >= CLOCK_SYNC_PERIOD_MAX )
+    {
+        return CLOCK_SYNC_PERIOD_MAX * 1000;
+    }
+    if( seconds < -CLOCK_SYNC_PERIOD_MAX )
+    {
+        return -CLOCK_SYNC_PERIOD_MAX * 1000;
+    }
+    return ( seconds * 1000 ) + diff.SubSeconds;
+}
+
+/*!
+ * Converts a signed duration in ms to a SysTime_t usable with SysTimeAdd
+ */
+static SysTime_t SysTimeFromSignedMs( int32_t timeMs )
+{
+    SysTime_t sysTime = { .Seconds = 0, .SubSeconds = 0 };
+    int32_t seconds = timeMs / 1000;
+    int32_t subSeconds = timeMs - ( seconds * 1000 );
+
+    if( subSeconds < 0 )
+    {
+        seconds--;
+        subSeconds += 1000;
+    }
+    sysTime.Seconds = ( uint32_t )seconds;
+    sysTime.SubSeconds = ( int16_t )subSeconds;
+    return sysTime;
+}
+
+/*!
+ * Returns the delay until the next AppTimeReq, in seconds
+ */
+static uint32_t LmhpClockSyncNextReqDelay( SysTime_t mcuTime )
+{
+    uint32_t elapsed = SysTimeDiffMs( mcuTime, LmhpClockSyncState.LastReqMcuTime ) / 1000;
+
+    if( ( LmhpClockSyncState.ForceResyncNbTrans > 0 ) ||
+        ( ( LmhpClockSyncState.IsSynchronized == false ) && ( LmhpClockSyncState.NbAppTimeReq == 0 ) ) )
+    {
+        return 0;
+    }
+    if( elapsed >= LmhpClockSyncState.Period )
+    {
+        return 0;
+    }
+    return LmhpClockSyncState.Period - elapsed;
+}
+
+/*!
+ * Returns the AppTimeReq period imposed by the network, dithered, in seconds.
+ * The longest AppTimePeriodicityReq periods are clamped to
+ * CLOCK_SYNC_PERIOD_MAX, the range of SysTimeDiffMs
+ */
+static uint32_t LmhpClockSyncNetworkPeriod( void )
+{
+    uint32_t period = LmhpClockSyncState.NetworkPeriod + randr( -CLOCK_SYNC_PERIOD_DITHER, CLOCK_SYNC_PERIOD_DITHER );
+
+    return MIN( period, CLOCK_SYNC_PERIOD_MAX );
+}
+
+/*!
+ * Arms the timer for the next AppTimeReq, in steps of CLOCK_SYNC_PERIOD_MAX
+ * at most: OnClockSyncTimerEvent arms the next step while a delay remains
+ */
+static void LmhpClockSyncTimerStart( SysTime_t mcuTime )
+{
+    uint32_t delay = LmhpClockSyncNextReqDelay( mcuTime );
+
+    TimerStop( &ClockSyncTimer );
+    if( delay > 0 )
+    {
+        TimerSetValue( &ClockSyncTimer, MIN( delay, CLOCK_SYNC_PERIOD_MAX ) * 1000 );
+        TimerStart( &ClockSyncTimer );
+    }
+}
+
 static void LmhpClockSyncInit( void * params, uint8_t *dataBuffer, uint8_t dataBufferMaxSize )
 {
     if( dataBuffer != NULL )
@@ -158,6 +381,8 @@ static void LmhpClockSyncInit( void * params, uint8_t *dataBuffer, uint8_t dataB
         LmhpClockSyncState.DataBufferMaxSize = dataBufferMaxSize;
         LmhpClockSyncState.Initialized = true;
         LmhpClockSyncState.IsRunning = true;
+        LmhpClockSyncState.ExpectedOffset = SysTimeGetOffset( );
+        TimerInit( &ClockSyncTimer, OnClockSyncTimerEvent );
     }
     else
     {
@@ -183,7 +408,123 @@ static bool LmhpClockSyncIsRunning( void )
 
 static void LmhpClockSyncProcess( void )
 {
-    // Nothing to process
+    SysTime_t mcuTime = SysTimeGetMcuTime( );
+    SysTime_t offset = SysTimeGetOffset( );
+
+    if( ( offset.Seconds != LmhpClockSyncState.ExpectedOffset.Seconds ) ||
+        ( offset.SubSeconds != LmhpClockSyncState.ExpectedOffset.SubSeconds ) )
+    {
+        // The system time has been corrected by the MAC layer ( DeviceTimeAns )
+        LmhpClockSyncState.AppTimeAnsPending = false;
+        LmhpClockSyncState.ForceResyncNbTrans = 0;
+        LmhpClockSyncDiscipline( SysTimeDiffMs( offset, LmhpClockSyncState.ExpectedOffset ), mcuTime );
+    }
+
+    LmhpClockSyncSlew( mcuTime );
+
+    if( ( LmhpClockSyncNextReqDelay( mcuTime ) > 0 ) ||
+        ( LmHandlerJoinStatus( ) != LORAMAC_HANDLER_SET ) ||
+        ( LmHandlerIsBusy( ) == true ) )
+    {
+        return;
+    }
+    if( LmhpClockSyncAppTimeReq( ) == LORAMAC_HANDLER_SUCCESS )
+    {
+        if( LmhpClockSyncState.ForceResyncNbTrans > 0 )
+        {
+            LmhpClockSyncState.ForceResyncNbTrans--;
+        }
+    }
+}
+
+static void LmhpClockSyncDiscipline( int32_t correction, SysTime_t mcuTime )
+{
+    uint32_t interval = SysTimeSub( mcuTime, LmhpClockSyncState.LastSyncMcuTime ).Seconds;
+    int32_t magnitude = ( correction < 0 ) ? -correction : correction;
+
+    LmhpClockSyncState.LastCorrection = correction;
+
+    if( ( LmhpClockSyncState.IsSynchronized == true ) &&
+        ( magnitude <= ( ( ( int64_t )interval * CLOCK_SYNC_MAX_DRIFT / 1000000 ) + 1000 ) ) )
+    {
+        uint32_t refInterval = SysTimeSub( mcuTime, LmhpClockSyncState.RefMcuTime ).Seconds;
+
+        LmhpClockSyncState.Cumulative += correction;
+        if( refInterval >= CLOCK_SYNC_MIN_SAMPLE_INTERVAL )
+        {
+            int32_t drift = ( int32_t )( ( int64_t )LmhpClockSyncState.Cumulative * 1000000 / refInterval );
+
+            if( ( drift >= -CLOCK_SYNC_MAX_DRIFT ) && ( drift <= CLOCK_SYNC_MAX_DRIFT ) )
+            {
+                LmhpClockSyncState.Drift = drift;
+                if( LmhpClockSyncState.NbDriftSamples < UINT8_MAX )
+                {
+                    LmhpClockSyncState.NbDriftSamples++;
+                }
+            }
+        }
+
+        // Stretch the period while the error stays well within the target,
+        // shrink it when the target has been exceeded
+        if( LmhpClockSyncState.NetworkPeriod == 0 )
+        {
+            if( magnitude <= ( CLOCK_SYNC_MAX_ERROR / 2 ) )
+            {
+                LmhpClockSyncState.Period = MIN( LmhpClockSyncState.Period * 2, CLOCK_SYNC_PERIOD_MAX );
+            }
+            else if( magnitude > CLOCK_SYNC_MAX_ERROR )
+            {
+                LmhpClockSyncState.Period = MAX( LmhpClockSyncState.Period / 2, CLOCK_SYNC_PERIOD_MIN );
+            }
+        }
+    }
+    else
+    {
+        // First correction or step beyond any plausible drift: restart the
+        // drift estimation from here
+        LmhpClockSyncState.NbDriftSamples = 0;
+        LmhpClockSyncState.Drift = 0;
+        LmhpClockSyncState.Cumulative = 0;
+        LmhpClockSyncState.RefMcuTime = mcuTime;
+    }
+
+    LmhpClockSyncState.IsSynchronized = true;
+    LmhpClockSyncState.SlewRemainder = 0;
+    LmhpClockSyncState.LastSyncMcuTime = mcuTime;
+    LmhpClockSyncState.LastSlewMcuTime = mcuTime;
+    LmhpClockSyncState.LastReqMcuTime = mcuTime;
+    LmhpClockSyncState.ExpectedOffset = SysTimeGetOffset( );
+    LmhpClockSyncTimerStart( mcuTime );
+}
+
+static void LmhpClockSyncSlew( SysTime_t mcuTime )
+{
+    int32_t elapsed = SysTimeDiffMs( mcuTime, LmhpClockSyncState.LastSlewMcuTime );
+
+    if( ( LmhpClockSyncState.NbDriftSamples == 0 ) || ( elapsed < CLOCK_SYNC_SLEW_PERIOD ) )
+    {
+        return;
+    }
+
+    int64_t slew = ( ( int64_t )elapsed * LmhpClockSyncState.Drift ) + LmhpClockSyncState.SlewRemainder;
+    int32_t slewMs = ( int32_t )( slew / 1000000000 );
+
+    LmhpClockSyncState.SlewRemainder = ( int32_t )( slew - ( ( int64_t )slewMs * 1000000000 ) );
+    LmhpClockSyncState.LastSlewMcuTime = mcuTime;
+
+    if( slewMs != 0 )
+    {
+        LmhpClockSyncState.Cumulative += slewMs;
+        LmhpClockSyncState.ExpectedOffset = SysTimeAdd( LmhpClockSyncState.ExpectedOffset, SysTimeFromSignedMs( slewMs ) );
+        SysTimeSetOffset( LmhpClockSyncState.ExpectedOffset );
+    }
+}
+
+static void OnClockSyncTimerEvent( void *context )
+{
+    // The request is sent by LmhpClockSyncProcess once the MCU is awake. A
+    // delay longer than one timer step arms the next step
+    LmhpClockSyncTimerStart( SysTimeGetMcuTime( ) );
 }
 
 static void LmhpClockSyncOnMcpsConfirm( McpsConfirm_t *mcpsConfirm )
@@ -242,10 +583,13 @@ static void LmhpClockSyncOnMcpsIndication( McpsIndication_t *mcpsIndication )
                 timeCorrection += ( mcpsIndication->Buffer[cmdIndex++] << 24 ) & 0xFF000000;
                 if( ( mcpsIndication->Buffer[cmdIndex++] & 0x0F ) == LmhpClockSyncState.TimeReqParam.Fields.TokenReq )
                 {
-                    SysTime_t curTime = { .Seconds = 0, .SubSeconds = 0 };
-                    curTime = SysTimeGet( );
-                    curTime.Seconds += timeCorrection;
-                    SysTimeSet( curTime );
+                    SysTime_t offset = SysTimeGetOffset( );
+                    SysTime_t newOffset = offset;
+                    newOffset.Seconds += timeCorrection;
+                    SysTimeSetOffset( newOffset );
+                    LmhpClockSyncState.AppTimeAnsPending = false;
+                    LmhpClockSyncState.ForceResyncNbTrans = 0;
+                    LmhpClockSyncDiscipline( SysTimeDiffMs( newOffset, offset ), SysTimeGetMcuTime( ) );
                     LmhpClockSyncState.TimeReqParam.Fields.TokenReq = ( LmhpClockSyncState.TimeReqParam.Fields.TokenReq + 1 ) & 0x0F;
                     if( LmhpClockSyncPackage.OnSysTimeUpdate != NULL )
                     {
@@ -259,12 +603,14 @@ static void LmhpClockSyncOnMcpsIndication( McpsIndication_t *mcpsIndication )
             }
             case CLOCK_SYNC_APP_TIME_PERIOD_REQ:
             {
-                // Increment index
-                cmdIndex++;
-                // TODO implement command prosessing and handling
+                // Period = 128 * 2^Period seconds, dithered when scheduled
+                uint32_t period = ( uint32_t )CLOCK_SYNC_PERIOD_MIN << ( mcpsIndication->Buffer[cmdIndex++] & 0x0F );
+                LmhpClockSyncState.NetworkPeriod = MIN( period, CLOCK_SYNC_PERIOD_MAX );
+                LmhpClockSyncState.Period = LmhpClockSyncNetworkPeriod( );
+                LmhpClockSyncTimerStart( SysTimeGetMcuTime( ) );
                 LmhpClockSyncState.DataBuffer[dataBufferIndex++] = CLOCK_SYNC_APP_TIME_PERIOD_ANS;
-                // Answer status not supported.
-                LmhpClockSyncState.DataBuffer[dataBufferIndex++] = 0x01;
+                // Answer status supported.
+                LmhpClockSyncState.DataBuffer[dataBufferIndex++] = 0x00;
 
                 SysTime_t curTime = SysTimeGet( );
                 // Substract Unix to Gps epcoh offset. The system time is based on Unix time.
@@ -277,7 +623,8 @@ static void LmhpClockSyncOnMcpsIndication( McpsIndication_t *mcpsIndication )
             }
             case CLOCK_SYNC_FORCE_RESYNC_REQ:
             {
-                // TODO implement command prosessing and handling
+                // Sent by LmhpClockSyncProcess until answered
+                LmhpClockSyncState.ForceResyncNbTrans = mcpsIndication->Buffer[cmdIndex++] & 0x07;
                 break;
             }
         }
@@ -336,6 +683,18 @@ LmHandlerErrorStatus_t LmhpClockSyncAppTimeReq( void )
     SysTime_t curTime = SysTimeGet( );
     uint8_t dataBufferIndex = 0;
 
+    // An unanswered AppTimeReq means that the network found the time within
+    // its tolerance.
+    if( ( LmhpClockSyncState.AppTimeAnsPending == true ) &&
+        ( LmhpClockSyncState.NetworkPeriod == 0 ) )
+    {
+        LmhpClockSyncState.Period = MIN( LmhpClockSyncState.Period * 2, CLOCK_SYNC_PERIOD_MAX );
+    }
+    else if( LmhpClockSyncState.NetworkPeriod != 0 )
+    {
+        LmhpClockSyncState.Period = LmhpClockSyncNetworkPeriod( );
+    }
+
     // Substract Unix to Gps epcoh offset. The system time is based on Unix time.
     curTime.Seconds -= UNIX_GPS_EPOCH_OFFSET;
 
@@ -354,5 +713,23 @@ LmHandlerErrorStatus_t LmhpClockSyncAppTimeReq( void )
         .Port = CLOCK_SYNC_PORT
     };
     LmhpClockSyncState.AppTimeReqPending = true;
-    return LmhpClockSyncPackage.OnSendRequest( &appData, LORAMAC_HANDLER_UNCONFIRMED_MSG );
+    if( LmhpClockSyncPackage.OnSendRequest( &appData, LORAMAC_HANDLER_UNCONFIRMED_MSG ) != LORAMAC_HANDLER_SUCCESS )
+    {
+        return LORAMAC_HANDLER_ERROR;
+    }
+
+    LmhpClockSyncState.AppTimeAnsPending = true;
+    LmhpClockSyncState.NbAppTimeReq++;
+    LmhpClockSyncState.LastReqMcuTime = SysTimeGetMcuTime( );
+    LmhpClockSyncTimerStart( LmhpClockSyncState.LastReqMcuTime );
+    return LORAMAC_HANDLER_SUCCESS;
+}
+
+void LmhpClockSyncGetStatus( LmhpClockSyncStatus_t *status )
+{
+    status->IsSynchronized = LmhpClockSyncState.IsSynchronized;
+    status->Drift = LmhpClockSyncState.Drift;
+    status->Period = LmhpClockSyncState.Period;
+    status->NbAppTimeReq = LmhpClockSyncState.NbAppTimeReq;
+    status->LastCorrection = LmhpClockSyncState.LastCorrection;
 }
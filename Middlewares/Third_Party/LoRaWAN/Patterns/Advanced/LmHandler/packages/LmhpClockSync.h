@@ -42,8 +42,43 @@
 //{
 //}LmphClockSyncParams_t;
 
+/*!
+ * Clock discipline status
+ */
+typedef struct LmhpClockSyncStatus_s
+{
+    /*!
+     * True once a time correction has been received
+     */
+    bool IsSynchronized;
+    /*!
+     * Estimated RTC frequency error compensated by the package, in ppb.
+     * Positive when the RTC runs slow
+     */
+    int32_t Drift;
+    /*!
+     * Current AppTimeReq period, in seconds
+     */
+    uint32_t Period;
+    /*!
+     * Number of AppTimeReq sent
+     */
+    uint32_t NbAppTimeReq;
+    /*!
+     * Last time correction received, in ms
+     */
+    int32_t LastCorrection;
+}LmhpClockSyncStatus_t;
+
 LmhPackage_t *LmphClockSyncPackageFactory( void );
 
 LmHandlerErrorStatus_t LmhpClockSyncAppTimeReq( void );
 
+/*!
+ * Gets the clock discipline status
+ *
+ * \param [OUT] status Clock discipline status
+ */
+void LmhpClockSyncGetStatus( LmhpClockSyncStatus_t *status );
+
 #endif // __LMHP_CLOCK_SYNC_H__
@@ -33,6 +33,18 @@
 
 #define FRAGMENTATION_MAX_SESSIONS                  4
 
+/*!
+ * Number of sessions that can be decoded concurrently. Each one costs a
+ * FragDecoder_t instance of RAM, sized by FRAG_MAX_NB and FRAG_MAX_REDUNDANCY.
+ */
+#ifndef FRAGMENTATION_MAX_DECODERS
+#define FRAGMENTATION_MAX_DECODERS                  2
+#endif
+
+#if( FRAGMENTATION_MAX_DECODERS > FRAGMENTATION_MAX_SESSIONS )
+#error "FRAGMENTATION_MAX_DECODERS must not exceed FRAGMENTATION_MAX_SESSIONS"
+#endif
+
 /*!
  * Package current context
  */
@@ -144,10 +156,63 @@ typedef struct FragSessionData_s
     FragGroupData_t FragGroupData;
     FragDecoderStatus_t FragDecoderStatus;
     int32_t FragDecoderPorcessStatus;
+    /*!
+     * Decoder taken from FragDecoders while the session is being decoded
+     */
+    FragDecoder_t *FragDecoder;
+    /*!
+     * Number of rows already notified through OnRowsReady
+     */
+    uint16_t NbRowsReady;
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+    /*!
+     * Storage the session is decoded to
+     */
+    FragDecoderCallbacks_t *DecoderCallbacks;
+#endif
 }FragSessionData_t;
 
 FragSessionData_t FragSessionData[FRAGMENTATION_MAX_SESSIONS];
 
+/*!
+ * Decoders shared by the sessions
+ */
+static FragDecoder_t FragDecoders[FRAGMENTATION_MAX_DECODERS];
+
+/*!
+ * Gets a decoder for the given session
+ *
+ * \param [IN] fragIndex Session index
+ *
+ * \retval decoder Decoder already used by the session, else a free decoder,
+ *                 else NULL
+ */
+static FragDecoder_t *LmhpFragmentationGetDecoder( uint8_t fragIndex )
+{
+    if( FragSessionData[fragIndex].FragDecoder != NULL )
+    {
+        return FragSessionData[fragIndex].FragDecoder;
+    }
+    for( uint8_t i = 0; i < FRAGMENTATION_MAX_DECODERS; i++ )
+    {
+        bool isFree = true;
+
+        for( uint8_t j = 0; j < FRAGMENTATION_MAX_SESSIONS; j++ )
+        {
+            if( FragSessionData[j].FragDecoder == &FragDecoders[i] )
+            {
+                isFree = false;
+                break;
+            }
+        }
+        if( isFree == true )
+        {
+            return &FragDecoders[i];
+        }
+    }
+    return NULL;
+}
+
 
 static LmhPackage_t LmhpFragmentationPackage =
 {
@@ -182,6 +247,13 @@ static void LmhpFragmentationInit( void *params, uint8_t *dataBuffer, uint8_t da
         LmhpFragmentationState.DataBufferMaxSize = dataBufferMaxSize;
         LmhpFragmentationState.Initialized = true;
         LmhpFragmentationState.IsRunning = true;
+
+        for( uint8_t i = 0; i < FRAGMENTATION_MAX_SESSIONS; i++ )
+        {
+            FragSessionData[i].FragGroupData.IsActive = false;
+            FragSessionData[i].FragDecoderPorcessStatus = FRAG_SESSION_NOT_STARTED;
+            FragSessionData[i].FragDecoder = NULL;
+        }
     }
     else
     {
@@ -239,8 +311,11 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                 uint8_t fragIndex = mcpsIndication->Buffer[cmdIndex++];
                 uint8_t participants = fragIndex & 0x01;
 
-                fragIndex >>= 1;
-                FragSessionData[fragIndex].FragDecoderStatus = FragDecoderGetStatus( );
+                fragIndex = ( fragIndex >> 1 ) & 0x03;
+                if( FragSessionData[fragIndex].FragDecoder != NULL )
+                {
+                    FragSessionData[fragIndex].FragDecoderStatus = FragDecoderGetStatus( FragSessionData[fragIndex].FragDecoder );
+                }
 
                 if( ( participants == 1 ) ||
                     ( ( participants == 0 ) && ( FragSessionData[fragIndex].FragDecoderStatus.FragNbLost > 0 ) ) )
@@ -263,6 +338,7 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                     break;
                 }
                 FragSessionData_t fragSessionData;
+                FragDecoder_t *fragDecoder = NULL;
                 uint8_t status = 0x00;
 
                 fragSessionData.FragGroupData.FragSession.Value = mcpsIndication->Buffer[cmdIndex++];
@@ -286,8 +362,18 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                     status |= 0x01; // Encoding unsupported
                 }
 
+                uint8_t fragIndex = fragSessionData.FragGroupData.FragSession.Fields.FragIndex;
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                if( ( fragSessionData.FragGroupData.FragNb * fragSessionData.FragGroupData.FragSize ) > FragDecoderGetMaxFileSize( ) )
+                fragSessionData.DecoderCallbacks = &LmhpFragmentationParams->DecoderCallbacks;
+                if( LmhpFragmentationParams->OnSessionSetup != NULL )
+                {
+                    fragSessionData.DecoderCallbacks = LmhpFragmentationParams->OnSessionSetup( fragIndex,
+                                                                                                fragSessionData.FragGroupData.FragNb,
+                                                                                                fragSessionData.FragGroupData.FragSize,
+                                                                                                fragSessionData.FragGroupData.Descriptor );
+                }
+                if( ( fragSessionData.DecoderCallbacks == NULL ) ||
+                    ( ( fragSessionData.FragGroupData.FragNb * fragSessionData.FragGroupData.FragSize ) > FragDecoderGetMaxFileSize( ) ) )
                 {
                     status |= 0x02; // Not enough Memory
                 }
@@ -297,8 +383,26 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                     status |= 0x02; // Not enough Memory
                 }
 #endif
-                status |= ( fragSessionData.FragGroupData.FragSession.Fields.FragIndex << 6 ) & 0xC0;
-                if( fragSessionData.FragGroupData.FragSession.Fields.FragIndex >= FRAGMENTATION_MAX_SESSIONS )
+                // Concurrent sessions need their own decoder and their own storage
+                fragDecoder = LmhpFragmentationGetDecoder( fragIndex );
+                if( fragDecoder == NULL )
+                {
+                    status |= 0x02; // Not enough Memory
+                }
+                for( uint8_t i = 0; i < FRAGMENTATION_MAX_SESSIONS; i++ )
+                {
+                    if( ( i != fragIndex ) && ( FragSessionData[i].FragDecoder != NULL ) )
+                    {
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+                        if( FragSessionData[i].DecoderCallbacks == fragSessionData.DecoderCallbacks )
+#endif
+                        {
+                            status |= 0x02; // Not enough Memory
+                        }
+                    }
+                }
+                status |= ( fragIndex << 6 ) & 0xC0;
+                if( fragIndex >= FRAGMENTATION_MAX_SESSIONS )
                 {
                     status |= 0x04; // FragSession index not supported
                 }
@@ -316,13 +420,17 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                     // The FragSessionSetup is accepted
                     fragSessionData.FragGroupData.IsActive = true;
                     fragSessionData.FragDecoderPorcessStatus = FRAG_SESSION_ONGOING;
-                    FragSessionData[fragSessionData.FragGroupData.FragSession.Fields.FragIndex] = fragSessionData;
+                    fragSessionData.FragDecoder = fragDecoder;
+                    fragSessionData.NbRowsReady = 0;
+                    FragSessionData[fragIndex] = fragSessionData;
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                    FragDecoderInit( fragSessionData.FragGroupData.FragNb,
+                    FragDecoderInit( fragDecoder,
+                                     fragSessionData.FragGroupData.FragNb,
                                      fragSessionData.FragGroupData.FragSize,
-                                     &LmhpFragmentationParams->DecoderCallbacks );
+                                     fragSessionData.DecoderCallbacks );
 #else
-                    FragDecoderInit( fragSessionData.FragGroupData.FragNb,
+                    FragDecoderInit( fragDecoder,
+                                     fragSessionData.FragGroupData.FragNb,
                                      fragSessionData.FragGroupData.FragSize,
                                      LmhpFragmentationParams->Buffer,
                                      LmhpFragmentationParams->BufferSize );
@@ -352,6 +460,8 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                 {
                     // Delete session
                     FragSessionData[id].FragGroupData.IsActive = false;
+                    FragSessionData[id].FragDecoderPorcessStatus = FRAG_SESSION_NOT_STARTED;
+                    FragSessionData[id].FragDecoder = NULL;
                 }
                 LmhpFragmentationState.DataBuffer[dataBufferIndex++] = FRAGMENTATION_FRAG_SESSION_DELETE_ANS;
                 LmhpFragmentationState.DataBuffer[dataBufferIndex++] = status;
@@ -362,6 +472,7 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
             {
                 uint8_t fragIndex = 0;
                 uint16_t fragCounter = 0;
+                uint16_t nbRowsReady = 0;
 
                 fragCounter = ( mcpsIndication->Buffer[cmdIndex++] << 0 ) & 0x00FF;
                 fragCounter |= ( mcpsIndication->Buffer[cmdIndex++] << 8 ) & 0xFF00;
@@ -387,15 +498,52 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
 
                 if( FragSessionData[fragIndex].FragDecoderPorcessStatus == FRAG_SESSION_ONGOING )
                 {
-                    FragSessionData[fragIndex].FragDecoderPorcessStatus = FragDecoderProcess( fragCounter, &mcpsIndication->Buffer[cmdIndex] );
-                    FragSessionData[fragIndex].FragDecoderStatus = FragDecoderGetStatus( );
+                    FragSessionData[fragIndex].FragDecoderPorcessStatus = FragDecoderProcess( FragSessionData[fragIndex].FragDecoder,
+                                                                                              fragCounter, &mcpsIndication->Buffer[cmdIndex] );
+                    FragSessionData[fragIndex].FragDecoderStatus = FragDecoderGetStatus( FragSessionData[fragIndex].FragDecoder );
+                    if( FragSessionData[fragIndex].FragDecoderStatus.MatrixError != 0 )
+                    {
+                        // Too many fragments lost to rebuild the file: the
+                        // rows are not final, abort the session
+                        FragSessionData[fragIndex].FragDecoderPorcessStatus = FRAG_SESSION_NOT_STARTED;
+                        FragSessionData[fragIndex].FragGroupData.IsActive = false;
+                        FragSessionData[fragIndex].FragDecoder = NULL;
+                        if( LmhpFragmentationParams->OnDone != NULL )
+                        {
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+                            LmhpFragmentationParams->OnDone( fragIndex, FRAG_SESSION_ABORTED, 0 );
+#else
+                            LmhpFragmentationParams->OnDone( fragIndex, FRAG_SESSION_ABORTED, LmhpFragmentationParams->Buffer, 0 );
+#endif
+                        }
+                    }
+                    else if( FragSessionData[fragIndex].FragDecoderPorcessStatus != FRAG_SESSION_ONGOING )
+                    {
+                        // The whole file is reconstructed
+                        nbRowsReady = FragSessionData[fragIndex].FragGroupData.FragNb;
+                        // The decoder can serve another session
+                        FragSessionData[fragIndex].FragDecoder = NULL;
+                    }
+                    else
+                    {
+                        nbRowsReady = FragDecoderGetNbContiguous( FragSessionData[fragIndex].FragDecoder );
+                    }
                     if( LmhpFragmentationParams->OnProgress != NULL )
                     {
-                        LmhpFragmentationParams->OnProgress( FragSessionData[fragIndex].FragDecoderStatus.FragNbRx,
+                        LmhpFragmentationParams->OnProgress( fragIndex,
+                                                             FragSessionData[fragIndex].FragDecoderStatus.FragNbRx,
                                                              FragSessionData[fragIndex].FragGroupData.FragNb,
                                                              FragSessionData[fragIndex].FragGroupData.FragSize,
                                                              FragSessionData[fragIndex].FragDecoderStatus.FragNbLost );
                     }
+                    if( nbRowsReady > FragSessionData[fragIndex].NbRowsReady )
+                    {
+                        FragSessionData[fragIndex].NbRowsReady = nbRowsReady;
+                        if( LmhpFragmentationParams->OnRowsReady != NULL )
+                        {
+                            LmhpFragmentationParams->OnRowsReady( fragIndex, nbRowsReady );
+                        }
+                    }
                 }
                 else
                 {
@@ -406,10 +554,12 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                         if( LmhpFragmentationParams->OnDone != NULL )
                         {
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                            LmhpFragmentationParams->OnDone( FragSessionData[fragIndex].FragDecoderPorcessStatus,
+                            LmhpFragmentationParams->OnDone( fragIndex,
+                                                            FragSessionData[fragIndex].FragDecoderPorcessStatus,
                                                             ( FragSessionData[fragIndex].FragGroupData.FragNb * FragSessionData[fragIndex].FragGroupData.FragSize ) - FragSessionData[fragIndex].FragGroupData.Padding );
 #else
-                            LmhpFragmentationParams->OnDone( FragSessionData[fragIndex].FragDecoderPorcessStatus,
+                            LmhpFragmentationParams->OnDone( fragIndex,
+                                                            FragSessionData[fragIndex].FragDecoderPorcessStatus,
                                                             LmhpFragmentationParams->Buffer,
                                                             ( FragSessionData[fragIndex].FragGroupData.FragNb * FragSessionData[fragIndex].FragGroupData.FragSize ) - FragSessionData[fragIndex].FragGroupData.Padding );
 #endif
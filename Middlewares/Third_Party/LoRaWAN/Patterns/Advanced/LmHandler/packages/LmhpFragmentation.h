@@ -41,9 +41,23 @@ typedef struct LmhpFragmentationParams_s
 {
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
     /*!
-     * FragDecoder Write/Read function callbacks
+     * FragDecoder Write/Read function callbacks used when OnSessionSetup is
+     * NULL
      */
     FragDecoderCallbacks_t DecoderCallbacks;
+    /*!
+     * Selects the storage of a new fragmentation session. Sessions decoded
+     * concurrently must use different storages.
+     *
+     * \param [IN] fragIndex  Fragmentation session index
+     * \param [IN] fragNb     Number of fragments
+     * \param [IN] fragSize   Size of fragments
+     * \param [IN] descriptor File descriptor sent by the server
+     *
+     * \retval callbacks FragDecoder Write/Read function callbacks of the
+     *                   storage. NULL rejects the session
+     */
+    FragDecoderCallbacks_t* ( *OnSessionSetup )( uint8_t fragIndex, uint16_t fragNb, uint8_t fragSize, uint32_t descriptor );
 #else
     /*!
      * Pointer to the un-fragmented received buffer.
@@ -55,35 +69,53 @@ typedef struct LmhpFragmentationParams_s
     uint32_t BufferSize;
 #endif
     /*!
-     * Notifies the progress of the current fragmentation session
+     * Notifies the progress of a fragmentation session
      *
+     * \param [IN] fragIndex   Fragmentation session index
      * \param [IN] fragCounter Fragment counter
      * \param [IN] fragNb      Number of fragments
      * \param [IN] fragSize    Size of fragments
      * \param [IN] fragNbLost  Number of lost fragments
      */
-    void ( *OnProgress )( uint16_t fragCounter, uint16_t fragNb, uint8_t fragSize, uint16_t fragNbLost );
+    void ( *OnProgress )( uint8_t fragIndex, uint16_t fragCounter, uint16_t fragNb, uint8_t fragSize, uint16_t fragNbLost );
+    /*!
+     * Notifies that the first rows of a fragmentation session file hold
+     * their final content. Allows the file to be consumed in-stream
+     * ( e.g. \ref DeltaPatchProcess ) before the session is finished.
+     * Can be NULL.
+     *
+     * \param [IN] fragIndex Fragmentation session index
+     * \param [IN] nbRows    Number of rows available from the file start.
+     *                       Equals fragNb once the session is finished.
+     */
+    void ( *OnRowsReady )( uint8_t fragIndex, uint16_t nbRows );
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
     /*!
-     * Notifies that the fragmentation session is finished
+     * Notifies that a fragmentation session is finished
      *
-     * \param [IN] status Fragmentation session status [FRAG_SESSION_ONGOING,
-     *                                                  FRAG_SESSION_FINISHED or
-     *                                                  FragDecoder.Status.FragNbLost]
-     * \param [IN] size   Received file size
+     * \param [IN] fragIndex Fragmentation session index
+     * \param [IN] status    Fragmentation session status [FRAG_SESSION_ONGOING,
+     *                                                     FRAG_SESSION_FINISHED,
+     *                                                     FragDecoder.Status.FragNbLost or
+     *                                                     FRAG_SESSION_ABORTED when too
+     *                                                     many fragments were lost]
+     * \param [IN] size      Received file size
      */
-    void ( *OnDone )( int32_t status, uint32_t size );
+    void ( *OnDone )( uint8_t fragIndex, int32_t status, uint32_t size );
 #else
     /*!
-     * Notifies that the fragmentation session is finished
+     * Notifies that a fragmentation session is finished
      *
-     * \param [IN] status Fragmentation session status [FRAG_SESSION_ONGOING,
-     *                                                  FRAG_SESSION_FINISHED or
-     *                                                  FragDecoder.Status.FragNbLost]
-     * \param [IN] file   Pointer to the reception file buffer
-     * \param [IN] size   Received file size
+     * \param [IN] fragIndex Fragmentation session index
+     * \param [IN] status    Fragmentation session status [FRAG_SESSION_ONGOING,
+     *                                                     FRAG_SESSION_FINISHED,
+     *                                                     FragDecoder.Status.FragNbLost or
+     *                                                     FRAG_SESSION_ABORTED when too
+     *                                                     many fragments were lost]
+     * \param [IN] file      Pointer to the reception file buffer
+     * \param [IN] size      Received file size
      */
-    void ( *OnDone )( int32_t status, uint8_t *file, uint32_t size );
+    void ( *OnDone )( uint8_t fragIndex, int32_t status, uint8_t *file, uint32_t size );
 #endif
 }LmhpFragmentationParams_t;
 
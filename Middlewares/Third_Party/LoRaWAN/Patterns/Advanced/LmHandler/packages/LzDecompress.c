@@ -0,0 +1,246 @@
+/*!
+ * \file      LzDecompress.c
+ *
+ * \brief     Implements a streaming LZSS decompressor writing a firmware
+ *            image while the compressed file is received ( e.g. through
+ *            \ref LmhpFragmentation ).
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include "utilities.h"
+#include "LzDecompress.h"
+
+#if ( LZ_DECOMPRESS_WINDOW_BITS < 4 ) || ( LZ_DECOMPRESS_WINDOW_BITS > 12 )
+#error "LZ_DECOMPRESS_WINDOW_BITS must be in range [4..12]"
+#endif
+
+#if ( ( LZ_DECOMPRESS_WRITE_SIZE & ( LZ_DECOMPRESS_WRITE_SIZE - 1 ) ) != 0 ) || ( LZ_DECOMPRESS_WRITE_SIZE > LZ_DECOMPRESS_WINDOW_SIZE )
+#error "LZ_DECOMPRESS_WRITE_SIZE must be a power of 2 not larger than the window"
+#endif
+
+/*!
+ * Shortest match length
+ */
+#define LZ_DECOMPRESS_MIN_MATCH                     3
+
+/*!
+ * Compressed file parser states
+ */
+enum
+{
+    LZ_DECOMPRESS_STATE_HEADER,
+    LZ_DECOMPRESS_STATE_FLAGS,
+    LZ_DECOMPRESS_STATE_ITEM,
+    LZ_DECOMPRESS_STATE_MATCH_HIGH,
+    LZ_DECOMPRESS_STATE_MATCH_EXTRA,
+};
+
+/*!
+ * \brief Reads a little endian 32 bits value
+ *
+ * \param [IN] buffer Buffer pointer
+ *
+ * \retval value      Read value
+ */
+static uint32_t LzDecompressRead32( uint8_t *buffer )
+{
+    return ( ( uint32_t )buffer[0] << 0 ) | ( ( uint32_t )buffer[1] << 8 ) |
+           ( ( uint32_t )buffer[2] << 16 ) | ( ( uint32_t )buffer[3] << 24 );
+}
+
+/*!
+ * \brief Writes the last window block once it is complete, or is the end of
+ *        the image, and checks the image once complete
+ *
+ * \param [IN] decomp Decompressor instance
+ */
+static void LzDecompressWriteBlock( LzDecompress_t *decomp )
+{
+    uint32_t start;
+    uint8_t *block;
+
+    if( ( ( decomp->Offset & ( LZ_DECOMPRESS_WRITE_SIZE - 1 ) ) != 0 ) && ( decomp->Offset != decomp->Size ) )
+    {
+        return;
+    }
+
+    start = ( decomp->Offset - 1 ) & ~( uint32_t )( LZ_DECOMPRESS_WRITE_SIZE - 1 );
+    block = decomp->Window + ( start & ( LZ_DECOMPRESS_WINDOW_SIZE - 1 ) );
+    decomp->Crc = Crc32Update( decomp->Crc, block, decomp->Offset - start );
+    if( decomp->Callbacks->LzDecompressWrite( start, block, decomp->Offset - start ) != 0 )
+    {
+        decomp->Status = LZ_DECOMPRESS_ERROR_WRITE;
+    }
+    else if( decomp->Offset == decomp->Size )
+    {
+        decomp->Status = ( Crc32Finalize( decomp->Crc ) == decomp->FileCrc ) ? LZ_DECOMPRESS_DONE : LZ_DECOMPRESS_ERROR_CRC;
+    }
+}
+
+/*!
+ * \brief Appends a byte to the image
+ *
+ * \param [IN] decomp Decompressor instance
+ * \param [IN] byte   Image byte
+ */
+static void LzDecompressOutput( LzDecompress_t *decomp, uint8_t byte )
+{
+    decomp->Window[decomp->Offset & ( LZ_DECOMPRESS_WINDOW_SIZE - 1 )] = byte;
+    decomp->Offset++;
+    LzDecompressWriteBlock( decomp );
+}
+
+/*!
+ * \brief Moves to the next item of the current flags group
+ *
+ * \param [IN] decomp Decompressor instance
+ */
+static void LzDecompressNextItem( LzDecompress_t *decomp )
+{
+    decomp->Flags >>= 1;
+    decomp->NbItems--;
+    decomp->State = ( decomp->NbItems == 0 ) ? LZ_DECOMPRESS_STATE_FLAGS : LZ_DECOMPRESS_STATE_ITEM;
+}
+
+/*!
+ * \brief Appends the current match to the image
+ *
+ * \param [IN] decomp Decompressor instance
+ */
+static void LzDecompressCopy( LzDecompress_t *decomp )
+{
+    if( ( decomp->Distance > LZ_DECOMPRESS_WINDOW_SIZE ) || ( decomp->Distance > decomp->Offset ) ||
+        ( decomp->Length > ( decomp->Size - decomp->Offset ) ) )
+    {
+        decomp->Status = LZ_DECOMPRESS_ERROR_FORMAT;
+        return;
+    }
+    while( ( decomp->Length > 0 ) && ( decomp->Status == LZ_DECOMPRESS_ONGOING ) )
+    {
+        LzDecompressOutput( decomp, decomp->Window[( decomp->Offset - decomp->Distance ) & ( LZ_DECOMPRESS_WINDOW_SIZE - 1 )] );
+        decomp->Length--;
+    }
+    LzDecompressNextItem( decomp );
+}
+
+void LzDecompressInit( LzDecompress_t *decomp, LzDecompressCallbacks_t *callbacks )
+{
+    decomp->Callbacks = callbacks;
+    decomp->Size = 0;
+    decomp->FileCrc = 0;
+    decomp->Crc = Crc32Init( );
+    decomp->Offset = 0;
+    decomp->Length = 0;
+    decomp->Distance = 0;
+    decomp->Flags = 0;
+    decomp->NbItems = 0;
+    decomp->State = LZ_DECOMPRESS_STATE_HEADER;
+    decomp->HeaderIndex = 0;
+    decomp->Status = LZ_DECOMPRESS_ONGOING;
+}
+
+LzDecompressStatus_t LzDecompressProcess( LzDecompress_t *decomp, uint8_t *data, uint32_t size )
+{
+    uint32_t index = 0;
+
+    while( ( index < size ) && ( decomp->Status == LZ_DECOMPRESS_ONGOING ) )
+    {
+        uint8_t byte = data[index++];
+
+        switch( decomp->State )
+        {
+            case LZ_DECOMPRESS_STATE_HEADER:
+            {
+                // The header is gathered in the still unused window
+                decomp->Window[decomp->HeaderIndex++] = byte;
+                if( decomp->HeaderIndex == LZ_DECOMPRESS_HEADER_SIZE )
+                {
+                    decomp->Size = LzDecompressRead32( decomp->Window + 4 );
+                    decomp->FileCrc = LzDecompressRead32( decomp->Window + 8 );
+                    if( ( LzDecompressRead32( decomp->Window ) != LZ_DECOMPRESS_MAGIC ) ||
+                        ( decomp->Window[12] > LZ_DECOMPRESS_WINDOW_BITS ) )
+                    {
+                        decomp->Status = LZ_DECOMPRESS_ERROR_HEADER;
+                    }
+                    else if( decomp->Size == 0 )
+                    {
+                        decomp->Status = ( Crc32Finalize( decomp->Crc ) == decomp->FileCrc ) ? LZ_DECOMPRESS_DONE : LZ_DECOMPRESS_ERROR_CRC;
+                    }
+                    decomp->State = LZ_DECOMPRESS_STATE_FLAGS;
+                }
+                break;
+            }
+            case LZ_DECOMPRESS_STATE_FLAGS:
+            {
+                decomp->Flags = byte;
+                decomp->NbItems = 8;
+                decomp->State = LZ_DECOMPRESS_STATE_ITEM;
+                break;
+            }
+            case LZ_DECOMPRESS_STATE_ITEM:
+            {
+                if( ( decomp->Flags & 0x01 ) != 0 )
+                {
+                    decomp->Distance = byte;
+                    decomp->State = LZ_DECOMPRESS_STATE_MATCH_HIGH;
+                }
+                else
+                {
+                    LzDecompressOutput( decomp, byte );
+                    LzDecompressNextItem( decomp );
+                }
+                break;
+            }
+            case LZ_DECOMPRESS_STATE_MATCH_HIGH:
+            {
+                decomp->Distance = ( decomp->Distance | ( ( uint16_t )( byte >> 4 ) << 8 ) ) + 1;
+                decomp->Length = ( byte & 0x0F ) + LZ_DECOMPRESS_MIN_MATCH;
+                if( ( byte & 0x0F ) == 0x0F )
+                {
+                    decomp->State = LZ_DECOMPRESS_STATE_MATCH_EXTRA;
+                }
+                else
+                {
+                    LzDecompressCopy( decomp );
+                }
+                break;
+            }
+            case LZ_DECOMPRESS_STATE_MATCH_EXTRA:
+            {
+                decomp->Length += byte;
+                if( byte != 0xFF )
+                {
+                    LzDecompressCopy( decomp );
+                }
+                else if( decomp->Length > decomp->Size )
+                {
+                    decomp->Status = LZ_DECOMPRESS_ERROR_FORMAT;
+                }
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+    return decomp->Status;
+}
+
+uint32_t LzDecompressGetProgress( LzDecompress_t *decomp )
+{
+    return decomp->Offset;
+}
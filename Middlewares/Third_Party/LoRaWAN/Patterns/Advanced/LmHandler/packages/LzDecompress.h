@@ -0,0 +1,176 @@
+/*!
+ * \file      LzDecompress.h
+ *
+ * \brief     Implements a streaming LZSS decompressor writing a firmware
+ *            image while the compressed file is received ( e.g. through
+ *            \ref LmhpFragmentation ).
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * Compressed file format ( little endian ), as generated by the `compress`
+ * command of prepareimage.py:
+ *
+ *   Header : Magic (4) | Image size (4) | Image CRC32 (4) | Window bits (1) |
+ *            Reserved (3)
+ *   Data   : Groups of a flags byte followed by up to 8 items, the flags LSB
+ *            describing the first item:
+ *            - 0 : Literal byte
+ *            - 1 : Match of 2 bytes, ( Distance - 1 ) on 12 bits ( low byte
+ *                  first, then high nibble ) and ( Length - 3 ) on 4 bits.
+ *                  A length nibble of 15 is followed by extra length bytes,
+ *                  added until one differs from 255.
+ *
+ * Decompression stops once the image size is reached, any trailing byte
+ * ( e.g. fragmentation padding ) is ignored.
+ */
+#ifndef __LZ_DECOMPRESS_H__
+#define __LZ_DECOMPRESS_H__
+
+#include <stdint.h>
+
+/*!
+ * Compressed file magic number ( "LZSS" )
+ */
+#define LZ_DECOMPRESS_MAGIC                         0x53535A4C
+
+/*!
+ * Compressed file header size
+ */
+#define LZ_DECOMPRESS_HEADER_SIZE                   16
+
+/*!
+ * Log2 of the largest window that can be handled [4..12]
+ *
+ * \remark Files compressed with a larger window are rejected. This parameter
+ *         has an impact on the memory footprint of each \ref LzDecompress_t
+ *         instance.
+ */
+#ifndef LZ_DECOMPRESS_WINDOW_BITS
+#define LZ_DECOMPRESS_WINDOW_BITS                   10
+#endif
+
+/*!
+ * Size of the image writes. Every write but the last one is made of
+ * LZ_DECOMPRESS_WRITE_SIZE bytes, at an offset multiple of it.
+ *
+ * \remark Must be a power of 2, a multiple of the flash programming
+ *         granularity and at most the window size.
+ */
+#ifndef LZ_DECOMPRESS_WRITE_SIZE
+#define LZ_DECOMPRESS_WRITE_SIZE                    128
+#endif
+
+#define LZ_DECOMPRESS_WINDOW_SIZE                   ( 1 << LZ_DECOMPRESS_WINDOW_BITS )
+
+typedef enum eLzDecompressStatus
+{
+    /*!
+     * More compressed data is expected
+     */
+    LZ_DECOMPRESS_ONGOING = 0,
+    /*!
+     * The image is written and its CRC is correct
+     */
+    LZ_DECOMPRESS_DONE,
+    /*!
+     * Not a compressed file or its window is too large
+     */
+    LZ_DECOMPRESS_ERROR_HEADER,
+    /*!
+     * A match is out of the window or the image bounds
+     */
+    LZ_DECOMPRESS_ERROR_FORMAT,
+    /*!
+     * The image could not be written
+     */
+    LZ_DECOMPRESS_ERROR_WRITE,
+    /*!
+     * The image CRC is wrong
+     */
+    LZ_DECOMPRESS_ERROR_CRC,
+}LzDecompressStatus_t;
+
+typedef struct sLzDecompressCallbacks
+{
+    /*!
+     * Writes `data` buffer of `size` starting at offset `addr` of the image
+     * slot ( e.g. SE_IMG_Write )
+     *
+     * \param [IN] addr Offset from the image start to write to.
+     * \param [IN] data Data buffer to be written.
+     * \param [IN] size Size of data buffer to be written.
+     *
+     * \retval status Write operation status [0: Success, -1 Fail]
+     */
+    uint8_t ( *LzDecompressWrite )( uint32_t addr, uint8_t *data, uint32_t size );
+}LzDecompressCallbacks_t;
+
+/*!
+ * Decompressor instance
+ */
+typedef struct sLzDecompress
+{
+    LzDecompressCallbacks_t *Callbacks;
+    uint32_t Size;
+    uint32_t FileCrc;
+    uint32_t Crc;
+    uint32_t Offset;
+    uint32_t Length;
+    uint16_t Distance;
+    uint8_t Flags;
+    uint8_t NbItems;
+    uint8_t State;
+    uint8_t HeaderIndex;
+    /*!
+     * History of the last LZ_DECOMPRESS_WINDOW_SIZE bytes, Offset modulo the
+     * window size being the next byte index. Whole LZ_DECOMPRESS_WRITE_SIZE
+     * blocks of it are written as they complete.
+     */
+    uint8_t Window[LZ_DECOMPRESS_WINDOW_SIZE];
+    LzDecompressStatus_t Status;
+}LzDecompress_t;
+
+/*!
+ * \brief Initializes the decompressor
+ *
+ * \param [IN] decomp    Decompressor instance
+ * \param [IN] callbacks Pointer to the image write function.
+ */
+void LzDecompressInit( LzDecompress_t *decomp, LzDecompressCallbacks_t *callbacks );
+
+/*!
+ * \brief Decompresses the next bytes of the compressed file. Called with the
+ *        file chunks in order, e.g. from
+ *        \ref LmhpFragmentationParams_t.OnRowsReady with the newly available
+ *        rows.
+ *
+ * \param [IN] decomp Decompressor instance
+ * \param [IN] data   Compressed file chunk
+ * \param [IN] size   Compressed file chunk size
+ *
+ * \retval status     Decompression status. Once different from
+ *                    LZ_DECOMPRESS_ONGOING the following calls have no effect.
+ */
+LzDecompressStatus_t LzDecompressProcess( LzDecompress_t *decomp, uint8_t *data, uint32_t size );
+
+/*!
+ * \brief Gets the number of image bytes already decompressed
+ *
+ * \param [IN] decomp Decompressor instance
+ *
+ * \retval size       Decompressed size
+ */
+uint32_t LzDecompressGetProgress( LzDecompress_t *decomp );
+
+#endif // __LZ_DECOMPRESS_H__
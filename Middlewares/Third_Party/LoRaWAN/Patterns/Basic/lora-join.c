@@ -0,0 +1,297 @@
+/******************************************************************************
+  * @file    lora-join.c
+  * @author  MCD Application Team
+  * @brief   Join scheduler: jittered exponential back-off of the join requests
+  *          within the regional join duty cycle, with a persisted history
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hw.h"
+#include "LoRaMac.h"
+#include "RegionCommon.h"
+#include "timeServer.h"
+#include "utilities.h"
+#include "lora-join.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/*!
+ * History of the join attempts, kept across the power cycles so that a fleet
+ * rebooting after an outage neither restarts its back-off nor its regional
+ * join duty cycle budget from scratch
+ */
+typedef struct sJoinBackoffHistory
+{
+    uint32_t Magic;
+    uint16_t Attempts;              /* requests sent since the last successful join */
+    uint16_t TimeOnAir;             /* of the last request, ms */
+    uint32_t JoinTime;              /* time spent joining, powered time only, s */
+    uint32_t Check;
+} JoinBackoffHistory_t;
+
+/* Private define ------------------------------------------------------------*/
+#define JOIN_BACKOFF_MAGIC                          0x4A424B31
+
+/* Join duty cycle budget accounted up to its last step */
+#define JOIN_BACKOFF_JOIN_TIME_MAX                  ( 24 * 3600 )
+
+/* Private variables ---------------------------------------------------------*/
+static JoinBackoffParams_t Params;
+
+static JoinBackoffHistory_t History;
+
+/*!
+ * Time of the last update of History.JoinTime
+ */
+static TimerTime_t HistoryTime;
+
+/*!
+ * Random first datarate of the rotation
+ */
+static uint8_t DatarateOffset;
+
+static TimerEvent_t JoinBackoffTimer;
+
+static bool Scheduled = false;
+
+static bool Requesting = false;
+
+/*!
+ * Set by the timer interrupt, the request is sent by JoinBackoff_Process
+ */
+static volatile bool RequestDue = false;
+
+/* Private function prototypes -----------------------------------------------*/
+static void OnJoinBackoffTimerEvent( void *context );
+static void JoinBackoff_Request( void );
+static void JoinBackoff_Schedule( uint32_t delay );
+static uint32_t JoinBackoff_NextDelay( void );
+static void JoinBackoff_Save( void );
+static uint32_t JoinBackoff_Check( const JoinBackoffHistory_t *history );
+
+/* Exported functions ------------------------------------------------------- */
+void JoinBackoff_Init( const JoinBackoffParams_t *params )
+{
+    Params = *params;
+    if( Params.MaxDatarate < Params.MinDatarate )
+    {
+        Params.MaxDatarate = Params.MinDatarate;
+    }
+
+    TimerInit( &JoinBackoffTimer, OnJoinBackoffTimerEvent );
+    Scheduled = false;
+    Requesting = false;
+    RequestDue = false;
+
+    memset1( ( uint8_t * )&History, 0, sizeof( History ) );
+    if( Params.NvmRead != NULL )
+    {
+        Params.NvmRead( ( uint8_t * )&History, sizeof( History ) );
+    }
+    if( ( History.Magic != JOIN_BACKOFF_MAGIC ) || ( History.Check != JoinBackoff_Check( &History ) ) )
+    {
+        memset1( ( uint8_t * )&History, 0, sizeof( History ) );
+        History.Magic = JOIN_BACKOFF_MAGIC;
+    }
+    HistoryTime = TimerGetCurrentTime( );
+
+    DatarateOffset = randr( 0, Params.MaxDatarate - Params.MinDatarate );
+}
+
+void JoinBackoff_Start( void )
+{
+    if( ( Scheduled == true ) || ( Requesting == true ) )
+    {
+        return;
+    }
+
+    if( History.Attempts == 0 )
+    {
+        // Spread the devices powered up together
+        JoinBackoff_Schedule( randr( 0, JOIN_BACKOFF_STARTUP ) );
+    }
+    else
+    {
+        JoinBackoff_Schedule( JoinBackoff_NextDelay( ) );
+    }
+}
+
+void JoinBackoff_Process( void )
+{
+    if( RequestDue == false )
+    {
+        return;
+    }
+    RequestDue = false;
+    JoinBackoff_Request( );
+}
+
+void JoinBackoff_Stop( void )
+{
+    TimerStop( &JoinBackoffTimer );
+    Scheduled = false;
+    Requesting = false;
+    RequestDue = false;
+
+    if( History.Attempts != 0 )
+    {
+        History.Attempts = 0;
+        History.JoinTime = 0;
+        JoinBackoff_Save( );
+    }
+}
+
+void JoinBackoff_OnConfirm( MlmeConfirm_t *mlmeConfirm )
+{
+    if( mlmeConfirm->MlmeRequest != MLME_JOIN )
+    {
+        return;
+    }
+    Requesting = false;
+
+    if( mlmeConfirm->Status == LORAMAC_EVENT_INFO_STATUS_OK )
+    {
+        JoinBackoff_Stop( );
+        return;
+    }
+
+    History.TimeOnAir = ( mlmeConfirm->TxTimeOnAir < 0xFFFF ) ? mlmeConfirm->TxTimeOnAir : 0xFFFF;
+    JoinBackoff_Schedule( JoinBackoff_NextDelay( ) );
+}
+
+uint16_t JoinBackoff_GetAttempts( void )
+{
+    return History.Attempts;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Flags the scheduled join request for JoinBackoff_Process, the MAC
+ *         request and the history write are not done in interrupt context
+ * @param  context not used
+ * @retval None
+ */
+static void OnJoinBackoffTimerEvent( void *context )
+{
+    RequestDue = true;
+
+    if( Params.ProcessNotify != NULL )
+    {
+        Params.ProcessNotify( );
+    }
+}
+
+/**
+ * @brief  Sends the scheduled join request
+ * @param  None
+ * @retval None
+ */
+static void JoinBackoff_Request( void )
+{
+    MlmeReq_t mlmeReq;
+    uint8_t span = Params.MaxDatarate - Params.MinDatarate + 1;
+    TimerTime_t elapsed = TimerGetElapsedTime( HistoryTime );
+
+    Scheduled = false;
+
+    mlmeReq.Type = MLME_JOIN;
+    mlmeReq.Req.Join.Datarate = Params.MaxDatarate - ( ( DatarateOffset + History.Attempts ) % span );
+
+    if( LoRaMacMlmeRequest( &mlmeReq ) != LORAMAC_STATUS_OK )
+    {
+        // MAC busy or no channel yet, not an attempt
+        JoinBackoff_Schedule( JOIN_BACKOFF_MIN );
+        return;
+    }
+    Requesting = true;
+
+    // Accounted when sent, in case of a power cycle before the confirm
+    History.Attempts++;
+    History.JoinTime += elapsed / 1000;
+    if( History.JoinTime > JOIN_BACKOFF_JOIN_TIME_MAX )
+    {
+        History.JoinTime = JOIN_BACKOFF_JOIN_TIME_MAX;
+    }
+    HistoryTime += elapsed - ( elapsed % 1000 );
+    JoinBackoff_Save( );
+}
+
+/**
+ * @brief  Starts the timer of the next attempt
+ * @param  delay ms
+ * @retval None
+ */
+static void JoinBackoff_Schedule( uint32_t delay )
+{
+    Scheduled = true;
+    TimerSetValue( &JoinBackoffTimer, delay );
+    TimerStart( &JoinBackoffTimer );
+}
+
+/**
+ * @brief  Draws the delay of the next attempt: half to all of a window doubled
+ *         at each attempt, and not before the end of the join duty cycle
+ *         time-off of the last request, accounted from the persisted join time
+ *         so that it does not restart at each power cycle as the MAC one
+ * @param  None
+ * @retval delay, ms
+ */
+static uint32_t JoinBackoff_NextDelay( void )
+{
+    uint32_t window = JOIN_BACKOFF_MIN;
+    uint32_t timeOff;
+    uint32_t delay;
+    uint16_t i;
+
+    for( i = 1; ( i < History.Attempts ) && ( window < JOIN_BACKOFF_MAX ); i++ )
+    {
+        window <<= 1;
+    }
+    if( window > JOIN_BACKOFF_MAX )
+    {
+        window = JOIN_BACKOFF_MAX;
+    }
+    delay = ( window / 2 ) + randr( 0, window / 2 );
+
+    timeOff = ( uint32_t )History.TimeOnAir * ( RegionCommonGetJoinDc( ( TimerTime_t )History.JoinTime * 1000 ) - 1 );
+    return ( delay > timeOff ) ? delay : timeOff;
+}
+
+/**
+ * @brief  Writes the history to the non volatile memory
+ * @param  None
+ * @retval None
+ */
+static void JoinBackoff_Save( void )
+{
+    History.Check = JoinBackoff_Check( &History );
+    if( Params.NvmWrite != NULL )
+    {
+        Params.NvmWrite( ( const uint8_t * )&History, sizeof( History ) );
+    }
+}
+
+/**
+ * @brief  Computes the check word of the history, telling apart an erased or
+ *         never written memory
+ * @param  history history
+ * @retval check word
+ */
+static uint32_t JoinBackoff_Check( const JoinBackoffHistory_t *history )
+{
+    return ~( history->Magic ^ ( ( uint32_t )history->Attempts << 16 ) ^ history->TimeOnAir ^
+              ( history->JoinTime * 2654435761UL ) );
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
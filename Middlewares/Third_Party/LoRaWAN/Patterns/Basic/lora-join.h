@@ -0,0 +1,151 @@
+/******************************************************************************
+  * @file    lora-join.h
+  * @author  MCD Application Team
+  * @brief   Join scheduler: jittered exponential back-off of the join requests
+  *          within the regional join duty cycle, with a persisted history
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef __LORA_JOIN_H__
+#define __LORA_JOIN_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "LoRaMac.h"
+
+/* Exported constants --------------------------------------------------------*/
+/*!
+ * Back-off window of the first retry, doubled at each failed attempt, ms
+ */
+#ifndef JOIN_BACKOFF_MIN
+#define JOIN_BACKOFF_MIN                            10000
+#endif
+
+/*!
+ * Largest back-off window, ms
+ */
+#ifndef JOIN_BACKOFF_MAX
+#define JOIN_BACKOFF_MAX                            ( 30 * 60000 )
+#endif
+
+/*!
+ * Window of the first attempt after power up without a pending history, ms
+ */
+#ifndef JOIN_BACKOFF_STARTUP
+#define JOIN_BACKOFF_STARTUP                        30000
+#endif
+
+/*!
+ * Size of the persisted history, bytes
+ */
+#define JOIN_BACKOFF_NVM_SIZE                       16
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct sJoinBackoffParams
+{
+/*!
+ * @brief Most robust datarate of the join requests
+ */
+    int8_t MinDatarate;
+/*!
+ * @brief Fastest datarate of the join requests. The attempts rotate from a
+ *        random datarate of the range to spread the devices over the SFs
+ *        (regions alternating the join datarate themselves, as US915 and
+ *        AU915, override it)
+ */
+    int8_t MaxDatarate;
+/*!
+ * @brief Reads the history from the non volatile memory, NULL when it is
+ *        not persisted
+ *
+ * @param [OUT] data history buffer
+ * @param [IN] size JOIN_BACKOFF_NVM_SIZE
+ */
+    void ( *NvmRead )( uint8_t *data, uint16_t size );
+/*!
+ * @brief Writes the history to the non volatile memory, NULL when it is
+ *        not persisted
+ *
+ * @param [IN] data history buffer
+ * @param [IN] size JOIN_BACKOFF_NVM_SIZE
+ */
+    void ( *NvmWrite )( const uint8_t *data, uint16_t size );
+/*!
+ * @brief Called from the timer interrupt when a join request is due, so that
+ *        the main loop calls JoinBackoff_Process. NULL when it is polled.
+ */
+    void ( *ProcessNotify )( void );
+} JoinBackoffParams_t;
+
+/* External variables --------------------------------------------------------*/
+/* Exported macros -----------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Loads the history. To call once the MAC is initialized.
+ * @param  params scheduler parameters
+ * @retval None
+ */
+void JoinBackoff_Init( const JoinBackoffParams_t *params );
+
+/**
+ * @brief  Schedules a join attempt, unless one is already scheduled or
+ *         running: right after power up it is drawn in JOIN_BACKOFF_STARTUP,
+ *         or resumes the back-off of the history
+ * @param  None
+ * @retval None
+ */
+void JoinBackoff_Start( void );
+
+/**
+ * @brief  Sends the join request which is due. To call from the main loop,
+ *         as LoRaMacProcess.
+ * @param  None
+ * @retval None
+ */
+void JoinBackoff_Process( void );
+
+/**
+ * @brief  Clears the history and cancels the scheduled attempt
+ * @param  None
+ * @retval None
+ */
+void JoinBackoff_Stop( void );
+
+/**
+ * @brief  Accounts the result of a join request and schedules the next
+ *         attempt when it failed. To call from the MLME-Confirm callback.
+ * @param  mlmeConfirm MLME_JOIN confirm
+ * @retval None
+ */
+void JoinBackoff_OnConfirm( MlmeConfirm_t *mlmeConfirm );
+
+/**
+ * @brief  Gets the failed attempts since the last successful join
+ * @param  None
+ * @retval number of attempts, including the previous power cycles
+ */
+uint16_t JoinBackoff_GetAttempts( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__LORA_JOIN_H__*/
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -22,6 +22,9 @@
 #include "LoRaMac.h"
 #include "lora.h"
 #include "lora-test.h"
+#ifdef LORA_JOIN_BACKOFF_ENABLED
+#include "lora-join.h"
+#endif /* LORA_JOIN_BACKOFF_ENABLED */
 
 /*!
  *  Select either Device_Time_req or Beacon_Time_Req following LoRaWAN version 
@@ -35,6 +38,13 @@
  */
 #define OVER_THE_AIR_ACTIVATION_DUTYCYCLE           10000  // 10 [s] value in ms
 
+#ifdef LORA_JOIN_BACKOFF_ENABLED
+/*!
+ * Offset of the join back-off history in the data EEPROM
+ */
+#define LORA_JOIN_EEPROM_OFFSET                     0
+#endif /* LORA_JOIN_BACKOFF_ENABLED */
+
 #if defined( REGION_EU868 ) || defined( REGION_RU864 ) || defined( REGION_CN779 ) || defined( REGION_EU433 )
 
 #include "LoRaMacTest.h"
@@ -144,6 +154,16 @@ const char* MlmeReqStrings[] =
 
 static void TraceUpLinkFrame(McpsConfirm_t *mcpsConfirm);
 static void TraceDownLinkFrame(McpsIndication_t *mcpsIndication);
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+static void TraceLatencyStats(void);
+#endif /* LORAMAC_LATENCY_PROBES_ENABLED */
+#ifdef STACK_MONITOR_ENABLED
+static void TraceStackHighWaterMark(void);
+#endif /* STACK_MONITOR_ENABLED */
+#ifdef LORA_JOIN_BACKOFF_ENABLED
+static void JoinNvmRead( uint8_t *data, uint16_t size );
+static void JoinNvmWrite( const uint8_t *data, uint16_t size );
+#endif /* LORA_JOIN_BACKOFF_ENABLED */
 #ifdef LORAMAC_CLASSB_ENABLED
 static void TraceBeaconInfo(MlmeIndication_t *mlmeIndication);
 #endif /* LORAMAC_CLASSB_ENABLED */
@@ -187,6 +207,12 @@ static void McpsConfirm( McpsConfirm_t *mcpsConfirm )
     
     /*implicitely desactivated when VERBOSE_LEVEL < 2*/
     TraceUpLinkFrame(mcpsConfirm);
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+    TraceLatencyStats();
+#endif /* LORAMAC_LATENCY_PROBES_ENABLED */
+#ifdef STACK_MONITOR_ENABLED
+    TraceStackHighWaterMark();
+#endif /* STACK_MONITOR_ENABLED */
 }
 
 /*!
@@ -287,6 +313,10 @@ static void MlmeConfirm( MlmeConfirm_t *mlmeConfirm )
     {
         case MLME_JOIN:
         {
+#ifdef LORA_JOIN_BACKOFF_ENABLED
+            // Clears the history or schedules the next attempt
+            JoinBackoff_OnConfirm( mlmeConfirm );
+#endif /* LORA_JOIN_BACKOFF_ENABLED */
             if( mlmeConfirm->Status == LORAMAC_EVENT_INFO_STATUS_OK )
             {
               // Status is OK, node has joined the network
@@ -299,11 +329,13 @@ static void MlmeConfirm( MlmeConfirm_t *mlmeConfirm )
 #endif /* USE_DEVICE_TIMING */
 #endif /* LORAMAC_CLASSB_ENABLED */
             }
+#ifndef LORA_JOIN_BACKOFF_ENABLED
             else
             {
                 // Join was not successful. Try to join again
                 LORA_Join();
             }
+#endif /* LORA_JOIN_BACKOFF_ENABLED */
             break;
         }
         case MLME_LINK_CHECK:
@@ -475,6 +507,12 @@ void LORA_Init (LoRaMainCallback_t *callbacks, LoRaParam_t* LoRaParam )
   LoRaMacCallbacks.GetBatteryLevel = LoRaMainCallbacks->BoardGetBatteryLevel;
   LoRaMacCallbacks.GetTemperatureLevel = LoRaMainCallbacks->BoardGetTemperatureLevel;
   LoRaMacCallbacks.MacProcessNotify = LoRaMainCallbacks->MacProcessNotify;
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+  LoRaMacCallbacks.GetCycleCount = HW_GetCycleCount;
+#endif /* LORAMAC_LATENCY_PROBES_ENABLED */
+#ifdef STACK_MONITOR_ENABLED
+  LoRaMacCallbacks.GetStackHighWaterMark = HW_GetStackHighWaterMark;
+#endif /* STACK_MONITOR_ENABLED */
 
 #if defined( REGION_AS923 )
   LoRaMacInitialization( &LoRaMacPrimitives, &LoRaMacCallbacks, LORAMAC_REGION_AS923 );
@@ -559,6 +597,17 @@ void LORA_Init (LoRaMainCallback_t *callbacks, LoRaParam_t* LoRaParam )
 
   /*set Mac statein Idle*/
   LoRaMacStart( );
+
+#ifdef LORA_JOIN_BACKOFF_ENABLED
+  JoinBackoffParams_t joinBackoffParams;
+
+  joinBackoffParams.MinDatarate = DR_0;
+  joinBackoffParams.MaxDatarate = LoRaParamInit->TxDatarate;
+  joinBackoffParams.NvmRead = JoinNvmRead;
+  joinBackoffParams.NvmWrite = JoinNvmWrite;
+  joinBackoffParams.ProcessNotify = LoRaMainCallbacks->MacProcessNotify;
+  JoinBackoff_Init( &joinBackoffParams );
+#endif /* LORA_JOIN_BACKOFF_ENABLED */
 }
 
 
@@ -572,7 +621,12 @@ void LORA_Join( void)
     JoinParameters = mlmeReq.Req.Join;
 
 #if( OVER_THE_AIR_ACTIVATION != 0 )
+#ifdef LORA_JOIN_BACKOFF_ENABLED
+    // The scheduler sends the request, nothing to do if already scheduled
+    JoinBackoff_Start( );
+#else
     LoRaMacMlmeRequest( &mlmeReq );
+#endif /* LORA_JOIN_BACKOFF_ENABLED */
 #else
     mibReq.Type = MIB_NET_ID;
     mibReq.Param.NetID = LORAWAN_NETWORK_ID;
@@ -882,6 +936,58 @@ static void TraceUpLinkFrame(McpsConfirm_t *mcpsConfirm)
 } 
 
 
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+static void TraceLatencyStats(void)
+{
+    const char *stageStrings[] = { "SEND", "PREPARE_FRAME", "SECURE_FRAME", "SEND_FRAME_ON_CHANNEL",
+                                   "RX_DONE", "RX_JOIN_ACCEPT", "RX_UNSECURE", "RETRANSMISSION" };
+    MibRequestConfirm_t mibGet;
+
+    mibGet.Type = MIB_LATENCY_STATS;
+    if( LoRaMacMibGetRequestConfirm( &mibGet ) != LORAMAC_STATUS_OK )
+    {
+        return;
+    }
+
+    /* One CSV line per stage: LATENCY,<stage>,<count>,<last>,<max> in cycles */
+    for( uint8_t i = 0; i < LORAMAC_LATENCY_STAGE_NB; i++ )
+    {
+        PRINTF( "LATENCY,%s,%lu,%lu,%lu\r\n", stageStrings[i], \
+                mibGet.Param.LatencyStats[i].Count, \
+                mibGet.Param.LatencyStats[i].Last, \
+                mibGet.Param.LatencyStats[i].Max );
+    }
+}
+#endif /* LORAMAC_LATENCY_PROBES_ENABLED */
+
+#ifdef STACK_MONITOR_ENABLED
+static void TraceStackHighWaterMark(void)
+{
+    MibRequestConfirm_t mibGet;
+
+    mibGet.Type = MIB_STACK_HIGH_WATER_MARK;
+    if( LoRaMacMibGetRequestConfirm( &mibGet ) != LORAMAC_STATUS_OK )
+    {
+        return;
+    }
+
+    /* CSV line: STACK,<high water mark in bytes> */
+    PRINTF( "STACK,%lu\r\n", mibGet.Param.StackHighWaterMark );
+}
+#endif /* STACK_MONITOR_ENABLED */
+
+#ifdef LORA_JOIN_BACKOFF_ENABLED
+static void JoinNvmRead( uint8_t *data, uint16_t size )
+{
+    HW_EepromRead( LORA_JOIN_EEPROM_OFFSET, data, size );
+}
+
+static void JoinNvmWrite( const uint8_t *data, uint16_t size )
+{
+    HW_EepromWrite( LORA_JOIN_EEPROM_OFFSET, data, size );
+}
+#endif /* LORA_JOIN_BACKOFF_ENABLED */
+
 static void TraceDownLinkFrame(McpsIndication_t *mcpsIndication)
 {
     const char *slotStrings[] = { "1", "2", "C", "Ping-Slot", "Multicast Ping-Slot" };
@@ -91,6 +91,13 @@ typedef struct
      * \param [IN] channelDetected    Channel Activity detected during the CAD
      */
     void ( *CadDone ) ( bool channelActivityDetected );
+    /*!
+     * \brief  Radio interrupt pending callback prototype.
+     *
+     * \remark Called from the interrupt context by the radios which defer
+     *         their interrupt processing to IrqProcess.
+     */
+    void ( *IrqNotify )( void );
 }RadioEvents_t;
 
 /*!
@@ -373,6 +380,15 @@ struct Radio_s
      * \param [in]  sleepTime     Structure describing sleep timeout value
      */
     void ( *SetRxDutyCycle ) ( uint32_t rxTime, uint32_t sleepTime );
+    /*!
+     * \brief Gets the time at which the radio raised the interrupt being
+     *        processed by IrqProcess
+     *
+     * \remark Available on radios deferring their interrupt processing only.
+     *
+     * \retval time Interrupt timestamp in ms
+     */
+    uint32_t ( *GetIrqTime )( void );
 };
 
 /*!
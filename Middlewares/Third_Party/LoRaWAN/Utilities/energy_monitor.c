@@ -0,0 +1,194 @@
+/**
+  ******************************************************************************
+  * @file    energy_monitor.c
+  * @author  MCD Application Team
+  * @brief   Time and charge accounting of the MCU and radio power states
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hw.h"
+#include "energy_monitor.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * Ongoing state period
+ */
+typedef struct
+{
+  uint32_t Start;  /* RTC tick at which the period started */
+  uint32_t Carry;  /* Ticks not yet accounted in ms */
+} EM_Period_t;
+
+/* Private defines -----------------------------------------------------------*/
+/* Private macros ------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static const uint16_t McuCurrents[EM_MCU_STATE_NB] =
+{
+  EM_MCU_RUN_CURRENT, EM_MCU_SLEEP_CURRENT, EM_MCU_STOP_CURRENT, EM_MCU_OFF_CURRENT
+};
+
+static const uint16_t RadioCurrents[EM_RADIO_STATE_NB] =
+{
+  EM_RADIO_SLEEP_CURRENT, EM_RADIO_STANDBY_CURRENT, EM_RADIO_RX_CURRENT,
+  EM_RADIO_TX_CURRENT, EM_RADIO_CAD_CURRENT
+};
+
+static EM_Stats_t Stats;
+static EM_McuState_t McuState = EM_MCU_RUN;
+static EM_RadioState_t RadioState = EM_RADIO_SLEEP;
+static EM_Period_t McuPeriod;
+static EM_Period_t RadioPeriod;
+
+/* Accumulated charge [uA.ms] */
+static uint64_t ChargeUaMs = 0;
+
+/* Global variables ----------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+/**
+ * @brief  Closes the ongoing period of a state
+ * @param  period: ongoing period
+ * @param  now: current RTC tick
+ * @retval Duration of the period [ms]
+ */
+static uint32_t EM_ClosePeriod(EM_Period_t *period, uint32_t now);
+
+/* Functions Definition ------------------------------------------------------*/
+void EM_Init(void)
+{
+  uint32_t now;
+
+  BACKUP_PRIMASK();
+
+  DISABLE_IRQ( );
+
+  now = HW_RTC_GetTimerValue();
+  memset1((uint8_t *)&Stats, 0, sizeof(Stats));
+  ChargeUaMs = 0;
+  McuState = EM_MCU_RUN;
+  RadioState = EM_RADIO_SLEEP;
+  McuPeriod.Start = now;
+  McuPeriod.Carry = 0;
+  RadioPeriod.Start = now;
+  RadioPeriod.Carry = 0;
+
+  RESTORE_PRIMASK( );
+}
+
+void EM_SetMcuState(EM_McuState_t state)
+{
+  uint32_t elapsed;
+
+  BACKUP_PRIMASK();
+
+  DISABLE_IRQ( );
+
+  elapsed = EM_ClosePeriod(&McuPeriod, HW_RTC_GetTimerValue());
+  Stats.McuTime[McuState] += elapsed;
+  ChargeUaMs += (uint64_t)McuCurrents[McuState] * elapsed;
+  McuState = state;
+
+  RESTORE_PRIMASK( );
+}
+
+void EM_SetRadioState(EM_RadioState_t state)
+{
+  uint32_t elapsed;
+
+  BACKUP_PRIMASK();
+
+  DISABLE_IRQ( );
+
+  elapsed = EM_ClosePeriod(&RadioPeriod, HW_RTC_GetTimerValue());
+  Stats.RadioTime[RadioState] += elapsed;
+  ChargeUaMs += (uint64_t)RadioCurrents[RadioState] * elapsed;
+  RadioState = state;
+
+  RESTORE_PRIMASK( );
+}
+
+void EM_AddTx(uint8_t datarate, uint8_t txPower, uint32_t timeOnAir)
+{
+  if (datarate < EM_DATARATE_NB)
+  {
+    Stats.TxTimePerDatarate[datarate] += timeOnAir;
+  }
+  if (txPower < EM_TX_POWER_NB)
+  {
+    Stats.TxTimePerPower[txPower] += timeOnAir;
+  }
+}
+
+const EM_Stats_t *EM_GetStats(void)
+{
+  /* Account the ongoing periods up to now */
+  EM_SetMcuState(McuState);
+  EM_SetRadioState(RadioState);
+
+  Stats.Charge = (uint32_t)(ChargeUaMs / 3600000);
+
+  return &Stats;
+}
+
+uint8_t EM_Serialize(uint8_t *buffer, uint8_t size)
+{
+  const EM_Stats_t *stats;
+  uint32_t value;
+  uint8_t i = 0;
+  uint8_t j;
+
+  if (size < EM_SERIALIZE_SIZE)
+  {
+    return 0;
+  }
+
+  stats = EM_GetStats();
+
+  buffer[i++] = EM_SERIALIZE_VERSION;
+  for (j = 0; j < (EM_MCU_STATE_NB + EM_RADIO_STATE_NB + 1); j++)
+  {
+    if (j < EM_MCU_STATE_NB)
+    {
+      value = stats->McuTime[j];
+    }
+    else if (j < (EM_MCU_STATE_NB + EM_RADIO_STATE_NB))
+    {
+      value = stats->RadioTime[j - EM_MCU_STATE_NB];
+    }
+    else
+    {
+      value = stats->Charge;
+    }
+    buffer[i++] = value & 0xFF;
+    buffer[i++] = (value >> 8) & 0xFF;
+    buffer[i++] = (value >> 16) & 0xFF;
+    buffer[i++] = (value >> 24) & 0xFF;
+  }
+
+  return i;
+}
+
+static uint32_t EM_ClosePeriod(EM_Period_t *period, uint32_t now)
+{
+  uint32_t ticks = (now - period->Start) + period->Carry;
+  uint32_t elapsed = HW_RTC_Tick2ms(ticks);
+
+  /* Keep the sub-millisecond remainder for the next period */
+  period->Carry = ticks - HW_RTC_ms2Tick(elapsed);
+  period->Start = now;
+
+  return elapsed;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
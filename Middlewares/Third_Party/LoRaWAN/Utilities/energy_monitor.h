@@ -0,0 +1,175 @@
+/**
+  ******************************************************************************
+  * @file    energy_monitor.h
+  * @author  MCD Application Team
+  * @brief   Header for energy_monitor.c module
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __ENERGY_MONITOR_H__
+#define __ENERGY_MONITOR_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/**
+ * MCU power states
+ */
+typedef enum
+{
+  EM_MCU_RUN = 0,
+  EM_MCU_SLEEP,
+  EM_MCU_STOP,
+  EM_MCU_OFF,
+  EM_MCU_STATE_NB,
+} EM_McuState_t;
+
+/**
+ * Radio power states
+ */
+typedef enum
+{
+  EM_RADIO_SLEEP = 0,
+  EM_RADIO_STANDBY,
+  EM_RADIO_RX,
+  EM_RADIO_TX,
+  EM_RADIO_CAD,
+  EM_RADIO_STATE_NB,
+} EM_RadioState_t;
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Number of datarates and TX power indexes the TX time is split into
+ */
+#define EM_DATARATE_NB                              16
+#define EM_TX_POWER_NB                              16
+
+/**
+ * Version of the EM_Serialize format
+ */
+#define EM_SERIALIZE_VERSION                        1
+
+/**
+ * Size of the EM_Serialize payload
+ */
+#define EM_SERIALIZE_SIZE                           ( 1 + 4 * ( EM_MCU_STATE_NB + EM_RADIO_STATE_NB + 1 ) )
+
+/**
+ * Typical currents of each state [uA], used for the charge estimate.
+ * They can be overridden with the values measured on the board.
+ */
+#ifndef EM_MCU_RUN_CURRENT
+#define EM_MCU_RUN_CURRENT                          5000
+#endif
+#ifndef EM_MCU_SLEEP_CURRENT
+#define EM_MCU_SLEEP_CURRENT                        1500
+#endif
+#ifndef EM_MCU_STOP_CURRENT
+#define EM_MCU_STOP_CURRENT                         2
+#endif
+#ifndef EM_MCU_OFF_CURRENT
+#define EM_MCU_OFF_CURRENT                          1
+#endif
+#ifndef EM_RADIO_SLEEP_CURRENT
+#define EM_RADIO_SLEEP_CURRENT                      1
+#endif
+#ifndef EM_RADIO_STANDBY_CURRENT
+#define EM_RADIO_STANDBY_CURRENT                    1600
+#endif
+#ifndef EM_RADIO_RX_CURRENT
+#define EM_RADIO_RX_CURRENT                         11500
+#endif
+#ifndef EM_RADIO_TX_CURRENT
+#define EM_RADIO_TX_CURRENT                         44000
+#endif
+#ifndef EM_RADIO_CAD_CURRENT
+#define EM_RADIO_CAD_CURRENT                        11500
+#endif
+
+/**
+ * Accumulated times, free running counters in ms
+ */
+typedef struct
+{
+  uint32_t McuTime[EM_MCU_STATE_NB];
+  uint32_t RadioTime[EM_RADIO_STATE_NB];
+  uint32_t TxTimePerDatarate[EM_DATARATE_NB];
+  uint32_t TxTimePerPower[EM_TX_POWER_NB];
+  uint32_t Charge;  /* Estimated charge drawn since EM_Init [uAh] */
+} EM_Stats_t;
+
+/* External variables --------------------------------------------------------*/
+/* Exported macros -----------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Resets the counters and starts the accounting in MCU run state and
+ *         radio sleep state
+ * @param  None
+ * @retval None
+ */
+void EM_Init(void);
+
+/**
+ * @brief  Notifies the MCU power state changes
+ * @note   Called by the low power manager in critical section
+ * @param  state: new MCU state
+ * @retval None
+ */
+void EM_SetMcuState(EM_McuState_t state);
+
+/**
+ * @brief  Notifies the radio power state changes
+ * @param  state: new radio state
+ * @retval None
+ */
+void EM_SetRadioState(EM_RadioState_t state);
+
+/**
+ * @brief  Accounts a transmission to its datarate and TX power
+ * @param  datarate: datarate of the transmission
+ * @param  txPower: TX power index of the transmission
+ * @param  timeOnAir: duration of the transmission [ms]
+ * @retval None
+ */
+void EM_AddTx(uint8_t datarate, uint8_t txPower, uint32_t timeOnAir);
+
+/**
+ * @brief  Gets the counters, including the time spent in the current states
+ * @param  None
+ * @retval Pointer to the counters
+ */
+const EM_Stats_t *EM_GetStats(void);
+
+/**
+ * @brief  Serializes the MCU and radio state times and the charge estimate
+ *         for a diagnostic uplink, as version byte followed by little endian
+ *         32 bits counters
+ * @param  buffer: destination buffer
+ * @param  size: size of the destination buffer
+ * @retval Number of bytes written, 0 if the buffer is too small
+ */
+uint8_t EM_Serialize(uint8_t *buffer, uint8_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ENERGY_MONITOR_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
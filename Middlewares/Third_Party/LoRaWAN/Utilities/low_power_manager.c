@@ -20,6 +20,9 @@
 /* Includes ------------------------------------------------------------------*/
 #include "hw.h"
 #include "low_power_manager.h"
+#ifdef ENERGY_MONITOR_ENABLED
+#include "energy_monitor.h"
+#endif
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private defines -----------------------------------------------------------*/
@@ -88,6 +91,12 @@ void LPM_SetStopMode(LPM_Id_t id, LPM_SetMode_t mode)
 
 void LPM_EnterLowPower(void)
 {
+#ifdef ENERGY_MONITOR_ENABLED
+  /* EM_MCU_SLEEP, EM_MCU_STOP and EM_MCU_OFF follow the LPM_GetMode_t order.
+   * The time spent in Off mode is lost with the reset on wake up */
+  EM_SetMcuState((EM_McuState_t)(EM_MCU_SLEEP + LPM_GetMode()));
+#endif
+
   if( StopModeDisable )
   {
     /**
@@ -116,6 +125,10 @@ void LPM_EnterLowPower(void)
     }
   }
 
+#ifdef ENERGY_MONITOR_ENABLED
+  EM_SetMcuState(EM_MCU_RUN);
+#endif
+
   return;
 }
 
@@ -140,6 +140,20 @@ SysTime_t SysTimeGetMcuTime( void )
     return calendarTime;
 }
 
+SysTime_t SysTimeGetOffset( void )
+{
+    SysTime_t DeltaTime = { .Seconds = 0, .SubSeconds = 0 };
+
+    HW_RTC_BKUPRead( &DeltaTime.Seconds, ( uint32_t* )&DeltaTime.SubSeconds );
+
+    return DeltaTime;
+}
+
+void SysTimeSetOffset( SysTime_t offset )
+{
+    HW_RTC_BKUPWrite( offset.Seconds, ( uint32_t )offset.SubSeconds );
+}
+
 uint32_t SysTimeToMs( SysTime_t sysTime )
 {
     SysTime_t DeltaTime;
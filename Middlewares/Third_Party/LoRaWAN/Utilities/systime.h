@@ -126,6 +126,23 @@ SysTime_t SysTimeGet( void );
  */
 SysTime_t SysTimeGetMcuTime( void );
 
+/*!
+ * \brief Gets the offset between the system time and the MCU time
+ *
+ * \retval offset    System time minus MCU time
+ */
+SysTime_t SysTimeGetOffset( void );
+
+/*!
+ * \brief Sets the offset between the system time and the MCU time
+ *
+ * \remark Unlike SysTimeSet the RTC calendar is not read, so no time is lost
+ *         when the system time is adjusted by a small amount
+ *
+ * \param  offset    New system time minus MCU time
+ */
+void SysTimeSetOffset( SysTime_t offset );
+
 /*!
  * Converts the given SysTime to the equivalent RTC value in milliseconds
  *
@@ -83,3 +83,46 @@ int8_t Nibble2HexChar( uint8_t a )
         return '?';
     }
 }
+
+uint32_t Crc32( uint8_t *buffer, uint16_t length )
+{
+    if( buffer == NULL )
+    {
+        return 0;
+    }
+    return Crc32Finalize( Crc32Update( Crc32Init( ), buffer, length ) );
+}
+
+uint32_t Crc32Init( void )
+{
+    return 0xFFFFFFFF;
+}
+
+uint32_t Crc32Update( uint32_t crcInit, uint8_t *buffer, uint16_t length )
+{
+    // The CRC calculation follows CCITT - 0x04C11DB7
+    const uint32_t reversedPolynom = 0xEDB88320;
+
+    uint32_t crc = crcInit;
+
+    if( buffer == NULL )
+    {
+        return 0;
+    }
+
+    for( uint16_t i = 0; i < length; ++i )
+    {
+        crc ^= ( uint32_t )buffer[i];
+        for( uint8_t j = 0; j < 8; j++ )
+        {
+            crc = ( crc >> 1 ) ^ ( reversedPolynom & ~( ( crc & 0x01 ) - 1 ) );
+        }
+    }
+
+    return crc;
+}
+
+uint32_t Crc32Finalize( uint32_t crc )
+{
+    return ~crc;
+}
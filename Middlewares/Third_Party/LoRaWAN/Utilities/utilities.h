@@ -88,6 +88,26 @@ typedef uint32_t TimerTime_t;
  */
 #define POW2( n ) ( 1 << n )
 
+/*!
+ * Floating point type of the symbol time, time on air and sensor
+ * computations. Double by default; single precision when
+ * LORA_MATH_SINGLE_PRECISION is defined, for the cores with a single
+ * precision FPU as the Cortex-M4F, which emulates double in software as the
+ * Cortex-M0+ does. The functions are the ones of math.h.
+ */
+#ifdef LORA_MATH_SINGLE_PRECISION
+typedef float MathFloat_t;
+#define MATH_CEIL( x )                              ceilf( x )
+#define MATH_FLOOR( x )                             floorf( x )
+#define MATH_ATAN2( y, x )                          atan2f( y, x )
+#else
+typedef double MathFloat_t;
+#define MATH_CEIL( x )                              ceil( x )
+#define MATH_FLOOR( x )                             floor( x )
+#define MATH_ATAN2( y, x )                          atan2( y, x )
+#endif
+#define MATH_PI                                     ( ( MathFloat_t )3.14159265358979323846 )
+
 /*!
  * Version
  */
@@ -165,4 +185,42 @@ void memset1( uint8_t *dst, uint8_t value, uint16_t size );
  */
 int8_t Nibble2HexChar( uint8_t a );
 
+/*!
+ * \brief Computes a CCITT 32 bits CRC
+ *
+ * \param [IN] buffer   Data buffer used to compute the CRC
+ * \param [IN] length   Data buffer length
+ *
+ * \retval crc          The computed buffer of length CRC
+ */
+uint32_t Crc32( uint8_t *buffer, uint16_t length );
+
+/*!
+ * \brief Computes the initial value of the CCITT 32 bits CRC. This function
+ *        can be used with functions \ref Crc32Update and \ref Crc32Finalize.
+ *
+ * \retval crc          Initial crc value.
+ */
+uint32_t Crc32Init( void );
+
+/*!
+ * \brief Updates the value of the crc value.
+ *
+ * \param [IN] crcInit  Previous or initial crc value.
+ * \param [IN] buffer   Data pointer.
+ * \param [IN] length   Length of the data.
+ *
+ * \retval crc          Updated crc value.
+ */
+uint32_t Crc32Update( uint32_t crcInit, uint8_t *buffer, uint16_t length );
+
+/*!
+ * \brief Finalizes crc value after calls to \ref Crc32Update function.
+ *
+ * \param [IN] crc      Recently updated crc value.
+ *
+ * \retval crc          Updated crc value.
+ */
+uint32_t Crc32Finalize( uint32_t crc );
+
 #endif // __UTILITIES_H__
@@ -109,6 +109,22 @@ extern "C" {
 #define ADCCLK_ENABLE()                 __HAL_RCC_ADC1_CLK_ENABLE() ;
 #define ADCCLK_DISABLE()                __HAL_RCC_ADC1_CLK_DISABLE() ;
 
+/* ADC scan sequence: DMA channel, sampling and oversampling of every scanned channel */
+#define ADC_SCAN_DMA_CHANNEL             DMA1_Channel1
+#define ADC_SCAN_DMA_REQUEST             DMA_REQUEST_0
+/* the temperature sensor needs 10us of sampling time, ADCCLK is PCLK/4 */
+#define ADC_SCAN_SAMPLETIME              ADC_SAMPLETIME_160CYCLES_5
+#define ADC_SCAN_OVERSAMPLING_RATIO      ADC_OVERSAMPLING_RATIO_16
+#define ADC_SCAN_OVERSAMPLING_SHIFT      ADC_RIGHTBITSHIFT_4
+/* maximum number of channels in the scan sequence, VREFINT and temperature included */
+#define ADC_SCAN_CHANNEL_MAX             6
+/* age up to which HW_GetBatteryLevel and HW_GetTemperatureLevel reuse the last scan */
+#ifndef ADC_SCAN_MAX_AGE_MS
+#define ADC_SCAN_MAX_AGE_MS              10000
+#endif
+/* a scan of all channels completes well within this time */
+#define ADC_SCAN_TIMEOUT_MS              10
+
 
 
 /* --------------------------- RTC HW definition -------------------------------- */
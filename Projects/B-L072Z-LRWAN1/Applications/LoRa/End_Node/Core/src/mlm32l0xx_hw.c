@@ -77,16 +77,39 @@ Maintainer: Miguel Luis and Gregory Cristian
   )
 
 static ADC_HandleTypeDef hadc;
+static DMA_HandleTypeDef hdma_adc;
 /*!
  * Flag to indicate if the ADC is Initialized
  */
 static bool AdcInitialized = false;
 
+/*!
+ * Channels of the scan sequence, in the order they were added
+ */
+static uint32_t AdcScanChannels[ADC_SCAN_CHANNEL_MAX] = { ADC_CHANNEL_VREFINT, ADC_CHANNEL_TEMPSENSOR };
+static uint8_t AdcScanChannelNb = 2;
+/*!
+ * Results of the last scan, in increasing channel number order
+ */
+static uint16_t AdcScanBuffer[ADC_SCAN_CHANNEL_MAX];
+/*!
+ * RTC tick of the last scan, valid when AdcScanValid is true
+ */
+static uint32_t AdcScanTime;
+static bool AdcScanValid = false;
+
 /*!
  * Flag to indicate if the MCU is Initialized
  */
 static bool McuInitialized = false;
 
+#if defined( CYCLE_COUNTER_ENABLED ) && !defined( DWT )
+/*!
+ * Upper part of the cycle counter, incremented by 0x10000 on each TIM2 overflow
+ */
+static volatile uint32_t CycleCountHigh = 0;
+#endif
+
 /**
   * @brief This function initializes the hardware
   * @param None
@@ -109,6 +132,10 @@ void HW_Init(void)
 
     HW_RTC_Init();
 
+#ifdef CYCLE_COUNTER_ENABLED
+    HW_CycleCountInit();
+#endif
+
     TraceInit();
 
     BSP_sensor_Init();
@@ -289,13 +316,196 @@ void HW_GetUniqueId(uint8_t *id)
   id[0] = ((*(uint32_t *)ID2));
 }
 
+#ifdef CYCLE_COUNTER_ENABLED
+/**
+  * @brief This function starts the free running CPU cycle counter
+  * @note  The Cortex-M0+ has no DWT cycle counter and SysTick is not running
+  *        (HAL_InitTick does nothing): TIM2 counts the undivided APB1 clock,
+  *        i.e. the core clock, and its overflow interrupt extends it to 32 bits.
+  *        The counter does not run in Stop mode.
+  * @param None
+  * @retval None
+  */
+void HW_CycleCountInit(void)
+{
+#if defined( DWT )
+  /* Cortex-M3/M4 core: the DWT cycle counter is used instead */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#else
+  __HAL_RCC_TIM2_CLK_ENABLE();
+
+  TIM2->CR1 = 0;
+  TIM2->PSC = 0;
+  TIM2->ARR = 0xFFFF;
+  /* Load the prescaler, then drop the update flag raised by it */
+  TIM2->EGR = TIM_EGR_UG;
+  TIM2->SR = 0;
+  TIM2->DIER = TIM_DIER_UIE;
+
+  HAL_NVIC_SetPriority(TIM2_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(TIM2_IRQn);
+
+  TIM2->CR1 = TIM_CR1_CEN;
+#endif
+}
+
+/**
+  * @brief This function handles the cycle counter overflow
+  * @param None
+  * @retval None
+  */
+void HW_CycleCountIrqHandler(void)
+{
+#if !defined( DWT )
+  if ((TIM2->SR & TIM_SR_UIF) != 0)
+  {
+    TIM2->SR = ~TIM_SR_UIF;
+    CycleCountHigh += 0x10000;
+  }
+#endif
+}
+
+/**
+  * @brief This function returns a free running CPU cycle counter
+  * @note  An overflow pending while interrupts are masked is accounted for;
+  *        interrupts must not stay masked for more than 65536 cycles.
+  * @param None
+  * @retval cycle counter
+  */
+uint32_t HW_GetCycleCount(void)
+{
+#if defined( DWT )
+  return DWT->CYCCNT;
+#else
+  uint32_t high;
+  uint32_t count;
+
+  BACKUP_PRIMASK();
+
+  DISABLE_IRQ();
+
+  high = CycleCountHigh;
+  count = TIM2->CNT;
+  /* Overflow not served yet and counter already wrapped */
+  if (((TIM2->SR & TIM_SR_UIF) != 0) && (count < 0x8000))
+  {
+    high += 0x10000;
+  }
+
+  RESTORE_PRIMASK();
+
+  return high + count;
+#endif
+}
+#endif /* CYCLE_COUNTER_ENABLED */
+
+/**
+  * @brief This function reads the data EEPROM
+  * @param Offset offset from the start of the data EEPROM
+  * @param Data buffer to fill, left unchanged beyond the end of the EEPROM
+  * @param Size number of bytes to read
+  * @retval None
+  */
+void HW_EepromRead(uint32_t Offset, uint8_t *Data, uint16_t Size)
+{
+  const uint8_t *eeprom = (const uint8_t *)DATA_EEPROM_BASE;
+
+  while ((Size-- > 0) && (DATA_EEPROM_BASE + Offset <= DATA_EEPROM_BANK2_END))
+  {
+    *Data++ = eeprom[Offset++];
+  }
+}
+
+/**
+  * @brief This function writes the data EEPROM
+  * @note  Only the bytes which change are programmed, about 3 ms each
+  * @param Offset offset from the start of the data EEPROM
+  * @param Data bytes to write, dropped beyond the end of the EEPROM
+  * @param Size number of bytes to write
+  * @retval None
+  */
+void HW_EepromWrite(uint32_t Offset, const uint8_t *Data, uint16_t Size)
+{
+  const uint8_t *eeprom = (const uint8_t *)DATA_EEPROM_BASE;
+
+  HAL_FLASHEx_DATAEEPROM_Unlock();
+  while ((Size-- > 0) && (DATA_EEPROM_BASE + Offset <= DATA_EEPROM_BANK2_END))
+  {
+    if (eeprom[Offset] != *Data)
+    {
+      HAL_FLASHEx_DATAEEPROM_Program(FLASH_TYPEPROGRAMDATA_BYTE, DATA_EEPROM_BASE + Offset, *Data);
+    }
+    Offset++;
+    Data++;
+  }
+  HAL_FLASHEx_DATAEEPROM_Lock();
+}
+
+#ifdef STACK_MONITOR_ENABLED
+/* Pattern of the unused stack area */
+#define STACK_PAINT_PATTERN   0xC5C5C5C5
+/* Words kept clear below the stack pointer of HW_StackPaint */
+#define STACK_PAINT_MARGIN    16
+
+/* Linker script symbols: end of bss, heap reserve size and top of RAM */
+extern uint32_t _end;
+extern uint32_t _Min_Heap_Size;
+extern uint32_t _estack;
+
+/**
+  * @brief Lowest address the stack may use without overlapping the heap reserve
+  */
+static uint32_t *HW_StackLimit(void)
+{
+  return (uint32_t *)((((uint32_t)&_end) + ((uint32_t)&_Min_Heap_Size) + 3) & ~3UL);
+}
+
+/**
+  * @brief This function paints the unused stack area
+  * @note  Must be called before the stack grows, first thing in main
+  * @param None
+  * @retval None
+  */
+void HW_StackPaint(void)
+{
+  uint32_t *p = HW_StackLimit();
+  uint32_t *sp = (uint32_t *)__get_MSP() - STACK_PAINT_MARGIN;
+
+  while (p < sp)
+  {
+    *p++ = STACK_PAINT_PATTERN;
+  }
+}
+
+/**
+  * @brief This function returns the largest stack usage since the painting
+  * @note  Scans up from the stack limit to the first overwritten word
+  * @param None
+  * @retval stack high water mark in bytes
+  */
+uint32_t HW_GetStackHighWaterMark(void)
+{
+  uint32_t *p = HW_StackLimit();
+
+  while ((p < &_estack) && (*p == STACK_PAINT_PATTERN))
+  {
+    p++;
+  }
+  return (uint32_t)&_estack - (uint32_t)p;
+}
+#endif /* STACK_MONITOR_ENABLED */
+
 uint16_t HW_GetTemperatureLevel(void)
 {
   uint16_t measuredLevel = 0;
   uint32_t batteryLevelmV;
   uint16_t temperatureDegreeC;
 
-  measuredLevel = HW_AdcReadChannel(ADC_CHANNEL_VREFINT);
+  HW_AdcScan(ADC_SCAN_MAX_AGE_MS);
+
+  measuredLevel = HW_AdcGetScanValue(ADC_CHANNEL_VREFINT);
 
   if (measuredLevel == 0)
   {
@@ -309,7 +519,7 @@ uint16_t HW_GetTemperatureLevel(void)
   PRINTF("VDDA= %d\n\r", batteryLevelmV);
 #endif
 
-  measuredLevel = HW_AdcReadChannel(ADC_CHANNEL_TEMPSENSOR);
+  measuredLevel = HW_AdcGetScanValue(ADC_CHANNEL_TEMPSENSOR);
 
   temperatureDegreeC = COMPUTE_TEMPERATURE(measuredLevel, batteryLevelmV);
 
@@ -333,7 +543,9 @@ uint16_t HW_GetBatteryLevel(void)
   uint16_t measuredLevel = 0;
   uint32_t batteryLevelmV;
 
-  measuredLevel = HW_AdcReadChannel(ADC_CHANNEL_VREFINT);
+  HW_AdcScan(ADC_SCAN_MAX_AGE_MS);
+
+  measuredLevel = HW_AdcGetScanValue(ADC_CHANNEL_VREFINT);
 
   if (measuredLevel == 0)
   {
@@ -361,7 +573,10 @@ void HW_AdcInit(void)
 
     hadc.Instance  = ADC1;
 
-    hadc.Init.OversamplingMode      = DISABLE;
+    hadc.Init.OversamplingMode      = ENABLE;
+    hadc.Init.Oversample.Ratio          = ADC_SCAN_OVERSAMPLING_RATIO;
+    hadc.Init.Oversample.RightBitShift  = ADC_SCAN_OVERSAMPLING_SHIFT;
+    hadc.Init.Oversample.TriggeredMode  = ADC_TRIGGEREDMODE_SINGLE_TRIGGER;
 
     hadc.Init.ClockPrescaler        = ADC_CLOCK_SYNC_PCLK_DIV4;
     hadc.Init.LowPowerAutoPowerOff  = DISABLE;
@@ -369,7 +584,7 @@ void HW_AdcInit(void)
     hadc.Init.LowPowerAutoWait      = DISABLE;
 
     hadc.Init.Resolution            = ADC_RESOLUTION_12B;
-    hadc.Init.SamplingTime          = ADC_SAMPLETIME_160CYCLES_5;
+    hadc.Init.SamplingTime          = ADC_SCAN_SAMPLETIME;
     hadc.Init.ScanConvMode          = ADC_SCAN_DIRECTION_FORWARD;
     hadc.Init.DataAlign             = ADC_DATAALIGN_RIGHT;
     hadc.Init.ContinuousConvMode    = DISABLE;
@@ -383,6 +598,22 @@ void HW_AdcInit(void)
 
     HAL_ADC_Init(&hadc);
 
+    /* One shot transfer of the scan results */
+    DMAx_CLK_ENABLE();
+
+    hdma_adc.Instance                 = ADC_SCAN_DMA_CHANNEL;
+    hdma_adc.Init.Request             = ADC_SCAN_DMA_REQUEST;
+    hdma_adc.Init.Direction           = DMA_PERIPH_TO_MEMORY;
+    hdma_adc.Init.PeriphInc           = DMA_PINC_DISABLE;
+    hdma_adc.Init.MemInc              = DMA_MINC_ENABLE;
+    hdma_adc.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_adc.Init.MemDataAlignment    = DMA_MDATAALIGN_HALFWORD;
+    hdma_adc.Init.Mode                = DMA_NORMAL;
+    hdma_adc.Init.Priority            = DMA_PRIORITY_LOW;
+
+    HAL_DMA_Init(&hdma_adc);
+
+    __HAL_LINKDMA(&hadc, DMA_Handle, hdma_adc);
   }
 }
 /**
@@ -446,6 +677,125 @@ uint16_t HW_AdcReadChannel(uint32_t Channel)
   return adcData;
 }
 
+/**
+  * @brief Adds a channel to the ADC scan sequence
+  * @param Channel
+  * @retval 0 when the channel is scanned, -1 when the scan is full
+  */
+int8_t HW_AdcScanAddChannel(uint32_t Channel)
+{
+  for (uint8_t i = 0; i < AdcScanChannelNb; i++)
+  {
+    if (AdcScanChannels[i] == Channel)
+    {
+      return 0;
+    }
+  }
+  if (AdcScanChannelNb >= ADC_SCAN_CHANNEL_MAX)
+  {
+    return -1;
+  }
+  AdcScanChannels[AdcScanChannelNb++] = Channel;
+  AdcScanValid = false;
+  return 0;
+}
+
+/**
+  * @brief Converts the scan sequence if the last results are older than MaxAge
+  * @note  The sequencer converts the selected channels in increasing channel
+  *        number order, each one oversampled, and the DMA stores the results
+  * @param MaxAge in ms
+  * @retval none
+  */
+void HW_AdcScan(uint32_t MaxAge)
+{
+  ADC_ChannelConfTypeDef adcConf = {0};
+  uint32_t tickstart;
+
+  if ((AdcScanValid == true) &&
+      (HW_RTC_Tick2ms(HW_RTC_GetTimerValue() - AdcScanTime) < MaxAge))
+  {
+    return;
+  }
+
+  HW_AdcInit();
+
+  /* wait the the Vrefint used by adc is set */
+  while (__HAL_PWR_GET_FLAG(PWR_FLAG_VREFINTRDY) == RESET) {};
+
+  ADCCLK_ENABLE();
+
+  /*calibrate ADC if any calibraiton hardware*/
+  HAL_ADCEx_Calibration_Start(&hadc, ADC_SINGLE_ENDED);
+
+  /* Deselects all channels*/
+  adcConf.Channel = ADC_CHANNEL_MASK;
+  adcConf.Rank = ADC_RANK_NONE;
+  HAL_ADC_ConfigChannel(&hadc, &adcConf);
+
+  /* Selects the scan channels */
+  adcConf.Rank = ADC_RANK_CHANNEL_NUMBER;
+  for (uint8_t i = 0; i < AdcScanChannelNb; i++)
+  {
+    adcConf.Channel = AdcScanChannels[i];
+    HAL_ADC_ConfigChannel(&hadc, &adcConf);
+  }
+
+  HAL_ADC_Start_DMA(&hadc, (uint32_t *) AdcScanBuffer, AdcScanChannelNb);
+
+  /* Wait for the last result, the DMA interrupt is not used. The HAL tick
+     does not run in this project: the timeout is measured on the RTC */
+  AdcScanValid = true;
+  tickstart = HW_RTC_GetTimerValue();
+  while (__HAL_DMA_GET_FLAG(&hdma_adc, __HAL_DMA_GET_TC_FLAG_INDEX(&hdma_adc)) == RESET)
+  {
+    if (HW_RTC_Tick2ms(HW_RTC_GetTimerValue() - tickstart) > ADC_SCAN_TIMEOUT_MS)
+    {
+      AdcScanValid = false;
+      break;
+    }
+  }
+
+  HAL_ADC_Stop_DMA(&hadc);
+
+  ADCCLK_DISABLE();
+
+  AdcScanTime = HW_RTC_GetTimerValue();
+}
+
+/**
+  * @brief Gets the value of a channel from the last scan
+  * @param Channel
+  * @retval Value
+  */
+uint16_t HW_AdcGetScanValue(uint32_t Channel)
+{
+  uint32_t chsel = Channel & ADC_CHANNEL_MASK;
+  uint8_t rank = 0;
+  bool found = false;
+
+  if (AdcScanValid == false)
+  {
+    return 0;
+  }
+
+  /* Results are stored in increasing channel number order */
+  for (uint8_t i = 0; i < AdcScanChannelNb; i++)
+  {
+    uint32_t scanned = AdcScanChannels[i] & ADC_CHANNEL_MASK;
+
+    if (scanned == chsel)
+    {
+      found = true;
+    }
+    else if (scanned < chsel)
+    {
+      rank++;
+    }
+  }
+  return (found == true) ? AdcScanBuffer[rank] : 0;
+}
+
 /**
   * @brief Enters Low Power Stop Mode
   * @note ARM exists the function when waking up
@@ -190,6 +190,13 @@ void RTC_IRQHandler(void)
   HW_RTC_IrqHandler();
 }
 
+#ifdef CYCLE_COUNTER_ENABLED
+void TIM2_IRQHandler(void)
+{
+  HW_CycleCountIrqHandler();
+}
+#endif
+
 void EXTI0_1_IRQHandler(void)
 {
   HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_0);
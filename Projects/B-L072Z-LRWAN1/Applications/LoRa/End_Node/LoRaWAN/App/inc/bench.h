@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  * @file    bench.h
+  * @author  MCD Application Team
+  * @brief   Header for bench.c module
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "bsp.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Exported macros -----------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+#ifdef MATH_BENCH_ENABLED
+/**
+  * @brief  Measures the floating point paths of the math profile on fixed
+  *         inputs. To run before LORA_Join
+  * @param  convertGaussToDegree heading computation of the application
+  * @retval None
+  */
+void MathBench(void (*convertGaussToDegree)(sensor_t *sensor_data));
+#endif
+
+#ifdef TIMER_BENCH_ENABLED
+/**
+  * @brief  Measures the cycles of the timer API reading the RTC
+  * @param  None
+  * @retval None
+  */
+void TimerBench(void);
+#endif
+
+#ifdef SE_BENCH_ENABLED
+/**
+  * @brief  Measures the AES operations of the secure element. To run before
+  *         LORA_Init
+  * @param  None
+  * @retval None
+  */
+void SeBench(void);
+#endif
+
+#ifdef LZ_BENCH_ENABLED
+/**
+  * @brief  Measures the decompression of a FUOTA image
+  * @param  None
+  * @retval None
+  */
+void LzBench(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BENCH_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
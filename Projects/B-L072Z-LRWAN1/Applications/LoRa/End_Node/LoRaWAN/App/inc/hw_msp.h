@@ -50,6 +50,12 @@ extern "C" {
 #define VDD_BAT                  BAT_CR2032
 #define VDD_MIN                  1800
 
+/* The cycle counter is only run for the latency probes and the benchmarks */
+#if defined( LORAMAC_LATENCY_PROBES_ENABLED ) || defined( MATH_BENCH_ENABLED ) || defined( TIMER_BENCH_ENABLED ) || \
+    defined( SE_BENCH_ENABLED ) || defined( LZ_BENCH_ENABLED )
+#define CYCLE_COUNTER_ENABLED
+#endif
+
 /* External variables --------------------------------------------------------*/
 /* Exported macros -----------------------------------------------------------*/
 
@@ -120,6 +126,59 @@ uint32_t HW_GetRandomSeed(void);
  */
 void HW_GetUniqueId(uint8_t *id);
 
+#ifdef CYCLE_COUNTER_ENABLED
+/*!
+ * \brief Starts the free running CPU cycle counter
+ */
+void HW_CycleCountInit(void);
+
+/*!
+ * \brief Handles the cycle counter timer overflow interrupt
+ */
+void HW_CycleCountIrqHandler(void);
+
+/*!
+ * \brief Gets a free running CPU cycle counter, for the latency measurements
+ *        and the benchmarks
+ *
+ * \retval Cycle counter value
+ */
+uint32_t HW_GetCycleCount(void);
+#endif
+
+/*!
+ * \brief Reads the data EEPROM
+ *
+ * \param [IN] Offset Offset from the start of the data EEPROM
+ * \param [OUT] Data Buffer to fill
+ * \param [IN] Size Number of bytes to read
+ */
+void HW_EepromRead(uint32_t Offset, uint8_t *Data, uint16_t Size);
+
+/*!
+ * \brief Writes the data EEPROM, programming only the bytes which change
+ *
+ * \param [IN] Offset Offset from the start of the data EEPROM
+ * \param [IN] Data Bytes to write
+ * \param [IN] Size Number of bytes to write
+ */
+void HW_EepromWrite(uint32_t Offset, const uint8_t *Data, uint16_t Size);
+
+#ifdef STACK_MONITOR_ENABLED
+/*!
+ * \brief Fills the free RAM between the heap reserve and the stack pointer
+ *        with a known pattern. To be called first thing in main.
+ */
+void HW_StackPaint(void);
+
+/*!
+ * \brief Gets the largest stack usage since HW_StackPaint
+ *
+ * \retval Stack high water mark in bytes
+ */
+uint32_t HW_GetStackHighWaterMark(void);
+#endif
+
 /*!
 * \brief Initializes the HW and enters stope mode
 */
@@ -169,6 +228,31 @@ void HW_AdcDeInit(void);
  */
 uint16_t HW_AdcReadChannel(uint32_t Channel);
 
+/*!
+ * \brief Adds a channel to the ADC scan sequence. VREFINT and the temperature
+ *        sensor are always part of it.
+ *
+ * \param [IN] Channel ADC channel to add, e.g. ADC_CHANNEL_4
+ * \retval 0 when the channel is part of the scan, -1 when the scan is full
+ */
+int8_t HW_AdcScanAddChannel(uint32_t Channel);
+
+/*!
+ * \brief Converts all the channels of the scan sequence in one oversampled
+ *        DMA transfer, unless the last results are recent enough
+ *
+ * \param [IN] MaxAge Maximum age in ms of the last results, 0 forces a new scan
+ */
+void HW_AdcScan(uint32_t MaxAge);
+
+/*!
+ * \brief Gets the value of a channel from the last scan
+ *
+ * \param [IN] Channel ADC channel
+ * \retval value    Oversampled channel value, 0 if the channel is not scanned
+ */
+uint16_t HW_AdcGetScanValue(uint32_t Channel);
+
 /*!
  * \brief Configures the sytem Clock at start-up
  *
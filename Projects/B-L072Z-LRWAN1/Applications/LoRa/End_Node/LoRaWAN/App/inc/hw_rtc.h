@@ -107,6 +107,21 @@ uint32_t HW_RTC_GetTimerElapsedTime(void);
  */
 uint32_t HW_RTC_GetTimerValue(void);
 
+/*!
+ * @brief Get the 64 bits time base, monotonic, the timer value is its lower part
+ * @retval time base in ticks
+ */
+uint64_t HW_RTC_GetTimeBase(void);
+
+#ifdef TIMER_BENCH_ENABLED
+/*!
+ * @brief Get the current time in ticks through the HAL calendar, reference of
+ *        the timer benchmark
+ * @retval time in ticks
+ */
+uint64_t HW_RTC_GetCalendarTick(void);
+#endif
+
 /*!
  * @brief Set the RTC timer Reference
  * @retval  Timer Reference Value in  Ticks
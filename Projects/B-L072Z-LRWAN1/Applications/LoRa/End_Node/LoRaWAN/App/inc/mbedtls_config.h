@@ -0,0 +1,37 @@
+/**
+  ******************************************************************************
+  * @file    mbedtls_config.h
+  * @author  MCD Application Team
+  * @brief   mbedTLS configuration of the mbedTLS backend of soft-se.c
+  *          (make SOFT_SE_MBEDTLS=1): the AES block cipher only
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MBEDTLS_CONFIG_H__
+#define __MBEDTLS_CONFIG_H__
+
+/* Modules */
+#define MBEDTLS_AES_C
+
+/* The 8 KB of AES tables are constant, in flash, instead of being generated
+   in RAM on the first key expansion. MBEDTLS_AES_FEWER_TABLES would halve
+   them at the cost of three rotations per table lookup. */
+#define MBEDTLS_AES_ROM_TABLES
+
+#include "mbedtls/check_config.h"
+
+#endif /* __MBEDTLS_CONFIG_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,630 @@
+/**
+  ******************************************************************************
+  * @file    bench.c
+  * @author  MCD Application Team
+  * @brief   benchmarks of the application, built when one of them is enabled
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hw.h"
+#include "timeServer.h"
+#include "bench.h"
+#ifdef MATH_BENCH_ENABLED
+#include "radio.h"
+#include "RegionCommon.h"
+#endif
+#ifdef TIMER_BENCH_ENABLED
+#include "systime.h"
+#endif
+#ifdef SE_BENCH_ENABLED
+#include "secure-element.h"
+#endif
+#ifdef LZ_BENCH_ENABLED
+#include "LzDecompress.h"
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+#ifdef MATH_BENCH_ENABLED
+/* heading of the application, set by its heading computation*/
+extern float heading;
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+#ifdef MATH_BENCH_ENABLED
+static void MathBenchTrace(const char *path, uint32_t calls, uint32_t cycles, uint32_t checksum);
+#endif
+
+#ifdef SE_BENCH_ENABLED
+static void SeBenchTrace(const char *path, uint16_t size, uint32_t cycles, uint32_t checksum);
+#endif
+
+#ifdef LZ_BENCH_ENABLED
+static uint32_t LzBenchGroup(const uint8_t *image, uint32_t *pos, uint8_t *group);
+static uint8_t LzBenchHash(const uint8_t *data);
+static uint8_t LzBenchWrite(uint32_t addr, uint8_t *data, uint32_t size);
+#endif
+
+/* Exported functions ------------------------------------------------------- */
+
+#ifdef MATH_BENCH_ENABLED
+/**
+  * @brief  Runs the symbol time and RX window, LoRa time on air, heading and
+  *         RTC temperature compensation computations on the same inputs
+  *         whatever the profile (LORA_MATH_SINGLE_PRECISION, core), to compare
+  *         the builds: the cycles of each path, and a checksum of the results
+  *         telling whether the profiles compute the same values
+  * @note   To run before LORA_Join: the radio TX configuration is changed.
+  *         The cycles are read from HW_GetCycleCount, started by HW_Init
+  *         when MATH_BENCH_ENABLED is defined
+  * @param  convertGaussToDegree heading computation of the application,
+  *         setting heading
+  * @retval None
+  */
+void MathBench(void (*convertGaussToDegree)(sensor_t *sensor_data))
+{
+  const uint32_t bandwidths[] = { 125000, 250000, 500000 };
+  sensor_t sensor_data;
+  MathFloat_t tSymbol;
+  uint32_t windowTimeout;
+  int32_t windowOffset;
+  uint32_t calls;
+  uint32_t cycles;
+  uint32_t checksum;
+  uint32_t start;
+  uint32_t result;
+
+  PRINTF("MATHBENCH,PROFILE,%s\r\n", (sizeof(MathFloat_t) == sizeof(float)) ? "single" : "double");
+
+  /* Symbol time and RX window of each SF and bandwidth */
+  calls = 0;
+  cycles = 0;
+  checksum = 0;
+  for (uint8_t sf = 7; sf <= 12; sf++)
+  {
+    for (uint8_t bw = 0; bw < 3; bw++)
+    {
+      for (uint32_t rxError = 10; rxError <= 50; rxError += 10)
+      {
+        start = HW_GetCycleCount();
+        tSymbol = RegionCommonComputeSymbolTimeLoRa(sf, bandwidths[bw]);
+        RegionCommonComputeRxWindowParameters(tSymbol, 6, rxError, 1, &windowTimeout, &windowOffset);
+        cycles += HW_GetCycleCount() - start;
+        checksum = (checksum * 31) + windowTimeout;
+        checksum = (checksum * 31) + (uint32_t)windowOffset;
+        calls++;
+      }
+    }
+  }
+  MathBenchTrace("RX_WINDOW", calls, cycles, checksum);
+
+  /* LoRa time on air of each SF, bandwidth and payload size */
+  calls = 0;
+  cycles = 0;
+  checksum = 0;
+  for (uint8_t sf = 7; sf <= 12; sf++)
+  {
+    for (uint8_t bw = 0; bw < 3; bw++)
+    {
+      Radio.SetTxConfig(MODEM_LORA, 14, 0, bw, sf, 1, 8, false, true, false, 0, false, 3000);
+      for (uint16_t size = 0; size <= 255; size++)
+      {
+        start = HW_GetCycleCount();
+        result = Radio.TimeOnAir(MODEM_LORA, size);
+        cycles += HW_GetCycleCount() - start;
+        checksum = (checksum * 31) + result;
+        calls++;
+      }
+    }
+  }
+  Radio.Sleep();
+  MathBenchTrace("TIME_ON_AIR", calls, cycles, checksum);
+
+  /* Heading on a grid of magnetometer values, as sent in the uplink */
+  calls = 0;
+  cycles = 0;
+  checksum = 0;
+  for (int32_t y = -2000; y <= 2000; y += 250)
+  {
+    for (int32_t x = -2000; x <= 2000; x += 250)
+    {
+      sensor_data.magneto.AXIS_X = x;
+      sensor_data.magneto.AXIS_Y = y;
+      start = HW_GetCycleCount();
+      convertGaussToDegree(&sensor_data);
+      cycles += HW_GetCycleCount() - start;
+      checksum = (checksum * 31) + (uint32_t)(int16_t)(heading * 100);
+      calls++;
+    }
+  }
+  MathBenchTrace("HEADING", calls, cycles, checksum);
+
+  /* RTC temperature compensation of a 1 min period */
+  calls = 0;
+  cycles = 0;
+  checksum = 0;
+  for (int32_t temperature = -40; temperature <= 85; temperature++)
+  {
+    start = HW_GetCycleCount();
+    result = RtcTempCompensation(60000, (float)temperature);
+    cycles += HW_GetCycleCount() - start;
+    checksum = (checksum * 31) + result;
+    calls++;
+  }
+  MathBenchTrace("RTC_TEMP_COMPENSATION", calls, cycles, checksum);
+}
+
+/**
+  * @brief  Prints the results of a path as a CSV line:
+  *         MATHBENCH,<path>,<calls>,<cycles per call>,<checksum>
+  * @param  path path name
+  * @param  calls number of calls
+  * @param  cycles cycles of all the calls
+  * @param  checksum checksum of the results
+  * @retval None
+  */
+static void MathBenchTrace(const char *path, uint32_t calls, uint32_t cycles, uint32_t checksum)
+{
+  PRINTF("MATHBENCH,%s,%lu,%lu,%08lX\r\n", path, calls, cycles / calls, checksum);
+}
+#endif /* MATH_BENCH_ENABLED */
+
+#ifdef TIMER_BENCH_ENABLED
+/* Calls of each path of the timer benchmark */
+#define TIMER_BENCH_CALLS 1000
+
+/**
+  * @brief  Measures the cycles per call of the timer API, all reading the RTC:
+  *         the HAL calendar read the timer paths used before the time base,
+  *         the time base, the timer value, TimerGetCurrentTime,
+  *         TimerGetElapsedTime and SysTimeGet. Prints one CSV line per path:
+  *         TIMERBENCH,<path>,<calls>,<cycles per call>
+  * @note   The cycles are read from HW_GetCycleCount, started by HW_Init
+  *         when TIMER_BENCH_ENABLED is defined
+  * @param  None
+  * @retval None
+  */
+void TimerBench(void)
+{
+  static const char *const paths[] =
+  {
+    "HAL_CALENDAR", "TIME_BASE", "TIMER_VALUE", "TIMER_CURRENT_TIME", "TIMER_ELAPSED_TIME", "SYSTIME_GET"
+  };
+  volatile uint64_t sink;
+  TimerTime_t past = TimerGetCurrentTime();
+  uint32_t cycles;
+  uint32_t start;
+
+  for (uint32_t path = 0; path < (sizeof(paths) / sizeof(paths[0])); path++)
+  {
+    cycles = 0;
+    for (uint32_t i = 0; i < TIMER_BENCH_CALLS; i++)
+    {
+      start = HW_GetCycleCount();
+      switch (path)
+      {
+        case 0:
+          sink = HW_RTC_GetCalendarTick();
+          break;
+        case 1:
+          sink = HW_RTC_GetTimeBase();
+          break;
+        case 2:
+          sink = HW_RTC_GetTimerValue();
+          break;
+        case 3:
+          sink = TimerGetCurrentTime();
+          break;
+        case 4:
+          sink = TimerGetElapsedTime(past);
+          break;
+        default:
+          sink = SysTimeGet().Seconds;
+          break;
+      }
+      cycles += HW_GetCycleCount() - start;
+    }
+    PRINTF("TIMERBENCH,%s,%lu,%lu\r\n", paths[path], (uint32_t)TIMER_BENCH_CALLS, cycles / TIMER_BENCH_CALLS);
+  }
+  (void)sink;
+}
+#endif /* TIMER_BENCH_ENABLED */
+
+#ifdef SE_BENCH_ENABLED
+/* Calls of each path of the secure element benchmark */
+#define SE_BENCH_CALLS 100
+
+/* Join accept with a CFList, MHDR and MIC included */
+#define SE_BENCH_JOIN_ACCEPT_SIZE 33
+
+/**
+  * @brief  Measures the cycles per call of the AES operations of the secure
+  *         element, soft-se.c on Crypto/aes.c and cmac.c or on mbedTLS
+  *         (make SOFT_SE_MBEDTLS=1), or stm32l4-se.c on the AES peripheral
+  *         of an STM32L4: MIC of 13 to 255 bytes, FRMPayload encryption,
+  *         join accept decryption and MIC, session key derivation with the
+  *         first use of the key. Prints one CSV line per path and size:
+  *         SEBENCH,<backend>,<path>,<size>,<calls>,<cycles per call>,<checksum>
+  *         the checksums are the same with all the backends.
+  * @note   To run before LORA_Init: the secure element is initialized here
+  *         with a benchmark key, LORA_Init initializes it again. The cycles
+  *         are read from HW_GetCycleCount, started by HW_Init when
+  *         SE_BENCH_ENABLED is defined: TIM2 on the Cortex-M0+, DWT CYCCNT
+  *         on the Cortex-M4, where the builds with soft-se.c and with
+  *         stm32l4-se.c compare the backends line for line
+  * @param  None
+  * @retval None
+  */
+void SeBench(void)
+{
+  static const uint16_t micSizes[] = { 13, 32, 64, 128, 255 };
+  static const uint16_t ctrSizes[] = { 16, 51, 115, 242 };
+  uint8_t key[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+  uint8_t buffer[256];
+  uint8_t block[16];
+  Version_t version;
+  uint32_t cycles;
+  uint32_t checksum;
+  uint32_t start;
+  uint32_t cmac;
+
+  version.Value = 0x01000300;
+  for (uint16_t i = 0; i < sizeof(buffer); i++)
+  {
+    buffer[i] = (uint8_t)(i * 13 + 7);
+  }
+  SecureElementInit(NULL);
+  SecureElementSetKey(APP_S_KEY, key);
+
+  /* MIC of a data frame, B0 block and message */
+  for (uint32_t s = 0; s < (sizeof(micSizes) / sizeof(micSizes[0])); s++)
+  {
+    for (uint8_t i = 0; i < 16; i++)
+    {
+      block[i] = i;
+    }
+    cycles = 0;
+    checksum = 0;
+    for (uint32_t i = 0; i < SE_BENCH_CALLS; i++)
+    {
+      block[10] = (uint8_t)i;
+      start = HW_GetCycleCount();
+      SecureElementComputeAesCmac(block, buffer, micSizes[s], APP_S_KEY, &cmac);
+      cycles += HW_GetCycleCount() - start;
+      checksum = (checksum * 31) + cmac;
+    }
+    SeBenchTrace("MIC", micSizes[s], cycles, checksum);
+  }
+
+  /* FRMPayload encryption in counter mode */
+  for (uint32_t s = 0; s < (sizeof(ctrSizes) / sizeof(ctrSizes[0])); s++)
+  {
+    cycles = 0;
+    checksum = 0;
+    for (uint32_t i = 0; i < SE_BENCH_CALLS; i++)
+    {
+      memset1(block, 0, sizeof(block));
+      block[0] = 0x01;
+      block[10] = (uint8_t)i;
+      block[15] = 0x01;
+      start = HW_GetCycleCount();
+      SecureElementAesCtrEncrypt(buffer, ctrSizes[s], block, APP_S_KEY);
+      cycles += HW_GetCycleCount() - start;
+      checksum = (checksum * 31) + buffer[ctrSizes[s] - 1];
+    }
+    SeBenchTrace("CTR", ctrSizes[s], cycles, checksum);
+  }
+
+  /* Join accept: decryption of all but the MHDR, then MIC of all but the MIC */
+  cycles = 0;
+  checksum = 0;
+  for (uint32_t i = 0; i < SE_BENCH_CALLS; i++)
+  {
+    buffer[1] = (uint8_t)i;
+    start = HW_GetCycleCount();
+    SecureElementAesEncrypt(&buffer[1], SE_BENCH_JOIN_ACCEPT_SIZE - 1, APP_S_KEY, &buffer[1]);
+    SecureElementComputeAesCmac(NULL, buffer, SE_BENCH_JOIN_ACCEPT_SIZE - 4, APP_S_KEY, &cmac);
+    cycles += HW_GetCycleCount() - start;
+    checksum = (checksum * 31) + cmac;
+  }
+  SeBenchTrace("JOIN_ACCEPT", SE_BENCH_JOIN_ACCEPT_SIZE, cycles, checksum);
+
+  /* Session key derivation, with the first use of the new key */
+  cycles = 0;
+  checksum = 0;
+  for (uint32_t i = 0; i < SE_BENCH_CALLS; i++)
+  {
+    block[0] = 0x01;
+    block[1] = (uint8_t)i;
+    start = HW_GetCycleCount();
+    SecureElementDeriveAndStoreKey(version, block, APP_S_KEY, NWK_S_ENC_KEY);
+    SecureElementComputeAesCmac(NULL, buffer, 16, NWK_S_ENC_KEY, &cmac);
+    cycles += HW_GetCycleCount() - start;
+    checksum = (checksum * 31) + cmac;
+  }
+  SeBenchTrace("KEY_DERIVATION", 16, cycles, checksum);
+}
+
+/**
+  * @brief  Prints the results of a path as a CSV line:
+  *         SEBENCH,<backend>,<path>,<size>,<calls>,<cycles per call>,<checksum>
+  * @param  path path name
+  * @param  size message size, bytes
+  * @param  cycles cycles of all the calls
+  * @param  checksum checksum of the results
+  * @retval None
+  */
+static void SeBenchTrace(const char *path, uint16_t size, uint32_t cycles, uint32_t checksum)
+{
+#if defined( SOFT_SE_USE_MBEDTLS )
+  const char *backend = "MBEDTLS";
+#elif defined( HAL_CRYP_MODULE_ENABLED )
+  /* stm32l4-se.c, built with the CRYP HAL */
+  const char *backend = "STM32L4_AES";
+#else
+  const char *backend = "AES_CMAC";
+#endif
+
+  PRINTF("SEBENCH,%s,%s,%u,%lu,%lu,%08lX\r\n", backend, path, size, (uint32_t)SE_BENCH_CALLS,
+         cycles / SE_BENCH_CALLS, checksum);
+}
+#endif /* SE_BENCH_ENABLED */
+
+#ifdef LZ_BENCH_ENABLED
+/* Image of the decompression benchmark: the first bytes of the flash, this
+   firmware */
+#define LZ_BENCH_IMAGE_SIZE 16384
+
+/* Hash table of the benchmark encoder, on the next 3 bytes */
+#define LZ_BENCH_HASH_SIZE 256
+
+/* Candidates of a hash chain the encoder compares */
+#define LZ_BENCH_CHAIN 16
+
+/* Longest match of the encoder, a single extra length byte */
+#define LZ_BENCH_MATCH_MAX 258
+
+/* Largest compressed chunk given to the decompressor */
+#define LZ_BENCH_CHUNK_MAX 242
+
+/* Decompressor, as in the FUOTA path */
+static LzDecompress_t LzBenchDecomp;
+
+/* Hash chains of the encoder, positions + 1, 0 for none */
+static uint16_t LzBenchHead[LZ_BENCH_HASH_SIZE];
+static uint16_t LzBenchPrev[LZ_DECOMPRESS_WINDOW_SIZE];
+
+/* Cycles of the write callback, not counted as decompression */
+static uint32_t LzBenchWriteCycles;
+
+/* Decompressed bytes different from the image */
+static uint32_t LzBenchErrors;
+
+/**
+  * @brief  Measures the cycles per byte of LzDecompressProcess: the first
+  *         LZ_BENCH_IMAGE_SIZE bytes of the flash are compressed in the
+  *         format of prepareimage.py, by a greedy encoder with the window of
+  *         the decompressor, and decompressed as they are compressed, in
+  *         chunks of a fragment size, into a check against the flash. Only
+  *         the LzDecompressProcess calls are counted, less the write
+  *         callback. Prints one CSV line per chunk size:
+  *         LZBENCH,<chunk>,<image size>,<compressed size>,<cycles>,
+  *         <cycles per byte>,<kB/s at SystemCoreClock>,<status>,<errors>
+  *         the status being LZ_DECOMPRESS_DONE (1) once the image and its
+  *         CRC32 are decompressed.
+  * @note   The cycles are read from HW_GetCycleCount, started by HW_Init
+  *         when LZ_BENCH_ENABLED is defined
+  * @param  None
+  * @retval None
+  */
+void LzBench(void)
+{
+  static const uint16_t chunkSizes[] = { 50, LZ_BENCH_CHUNK_MAX };
+  static LzDecompressCallbacks_t callbacks = { LzBenchWrite };
+  uint8_t *image = (uint8_t *)FLASH_BASE;
+  uint8_t chunk[LZ_BENCH_CHUNK_MAX];
+  uint8_t group[1 + (8 * 3)];
+  LzDecompressStatus_t status;
+  uint32_t crc = Crc32(image, LZ_BENCH_IMAGE_SIZE);
+  uint32_t compressed;
+  uint32_t cycles;
+  uint32_t start;
+  uint32_t size;
+  uint32_t pos;
+  uint16_t fill;
+
+  for (uint32_t s = 0; s < (sizeof(chunkSizes) / sizeof(chunkSizes[0])); s++)
+  {
+    memset1((uint8_t *)LzBenchHead, 0, sizeof(LzBenchHead));
+    memset1((uint8_t *)LzBenchPrev, 0, sizeof(LzBenchPrev));
+    LzDecompressInit(&LzBenchDecomp, &callbacks);
+    LzBenchWriteCycles = 0;
+    LzBenchErrors = 0;
+    status = LZ_DECOMPRESS_ONGOING;
+    compressed = 0;
+    cycles = 0;
+    fill = 0;
+
+    /* Header, then the groups of up to 8 items, decompressed whenever a
+       chunk is complete */
+    memset1(group, 0, LZ_DECOMPRESS_HEADER_SIZE);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+      group[i] = (uint8_t)(LZ_DECOMPRESS_MAGIC >> (8 * i));
+      group[4 + i] = (uint8_t)(LZ_BENCH_IMAGE_SIZE >> (8 * i));
+      group[8 + i] = (uint8_t)(crc >> (8 * i));
+    }
+    group[12] = LZ_DECOMPRESS_WINDOW_BITS;
+    size = LZ_DECOMPRESS_HEADER_SIZE;
+    pos = 0;
+    do
+    {
+      compressed += size;
+      for (uint32_t i = 0; i < size; i++)
+      {
+        chunk[fill++] = group[i];
+        if ((fill == chunkSizes[s]) || ((pos == LZ_BENCH_IMAGE_SIZE) && (i == (size - 1))))
+        {
+          start = HW_GetCycleCount();
+          status = LzDecompressProcess(&LzBenchDecomp, chunk, fill);
+          cycles += HW_GetCycleCount() - start;
+          fill = 0;
+        }
+      }
+      size = (pos < LZ_BENCH_IMAGE_SIZE) ? LzBenchGroup(image, &pos, group) : 0;
+    } while (size != 0);
+
+    cycles -= LzBenchWriteCycles;
+    PRINTF("LZBENCH,%u,%lu,%lu,%lu,%lu,%lu,%u,%lu\r\n", chunkSizes[s], (uint32_t)LZ_BENCH_IMAGE_SIZE, compressed,
+           cycles, cycles / LZ_BENCH_IMAGE_SIZE,
+           (uint32_t)(((uint64_t)SystemCoreClock * LZ_BENCH_IMAGE_SIZE) / ((uint64_t)cycles * 1000)), status,
+           LzBenchErrors);
+  }
+}
+
+/**
+  * @brief  Compresses the next group of the image: a flags byte and up to 8
+  *         literals or matches, the longest match in the window among the
+  *         LZ_BENCH_CHAIN last positions of the same hash
+  * @param  image image to compress
+  * @param  pos position of the next byte, advanced past the group
+  * @param  group compressed group
+  * @retval compressed group size
+  */
+static uint32_t LzBenchGroup(const uint8_t *image, uint32_t *pos, uint8_t *group)
+{
+  uint32_t size = 1;
+
+  group[0] = 0;
+  for (uint8_t item = 0; (item < 8) && (*pos < LZ_BENCH_IMAGE_SIZE); item++)
+  {
+    uint32_t p = *pos;
+    uint32_t max = LZ_BENCH_IMAGE_SIZE - p;
+    uint32_t bestLength = 0;
+    uint32_t bestDistance = 0;
+
+    if (max > LZ_BENCH_MATCH_MAX)
+    {
+      max = LZ_BENCH_MATCH_MAX;
+    }
+    if (max >= 3)
+    {
+      uint32_t candidate = LzBenchHead[LzBenchHash(&image[p])];
+
+      for (uint8_t chain = 0; (chain < LZ_BENCH_CHAIN) && (candidate != 0); chain++)
+      {
+        uint32_t c = candidate - 1;
+        uint32_t length = 0;
+
+        if ((p - c) > LZ_DECOMPRESS_WINDOW_SIZE)
+        {
+          break;
+        }
+        while ((length < max) && (image[c + length] == image[p + length]))
+        {
+          length++;
+        }
+        if (length > bestLength)
+        {
+          bestLength = length;
+          bestDistance = p - c;
+          if (length == max)
+          {
+            break;
+          }
+        }
+        /* Older entries of the ring are overwritten by newer positions */
+        candidate = LzBenchPrev[c & (LZ_DECOMPRESS_WINDOW_SIZE - 1)];
+        if (candidate > c)
+        {
+          break;
+        }
+      }
+    }
+
+    if (bestLength >= 3)
+    {
+      group[0] |= 1 << item;
+      group[size++] = (uint8_t)(bestDistance - 1);
+      if ((bestLength - 3) < 15)
+      {
+        group[size++] = (uint8_t)((((bestDistance - 1) >> 8) << 4) | (bestLength - 3));
+      }
+      else
+      {
+        group[size++] = (uint8_t)((((bestDistance - 1) >> 8) << 4) | 15);
+        group[size++] = (uint8_t)(bestLength - 3 - 15);
+      }
+    }
+    else
+    {
+      group[size++] = image[p];
+      bestLength = 1;
+    }
+
+    /* Every position of the item in the hash chains */
+    for (uint32_t i = 0; i < bestLength; i++, p++)
+    {
+      if ((LZ_BENCH_IMAGE_SIZE - p) >= 3)
+      {
+        uint8_t hash = LzBenchHash(&image[p]);
+
+        LzBenchPrev[p & (LZ_DECOMPRESS_WINDOW_SIZE - 1)] = LzBenchHead[hash];
+        LzBenchHead[hash] = (uint16_t)(p + 1);
+      }
+    }
+    *pos = p;
+  }
+  return size;
+}
+
+/**
+  * @brief  Hash of the next 3 bytes for the encoder
+  * @param  data next bytes
+  * @retval hash
+  */
+static uint8_t LzBenchHash(const uint8_t *data)
+{
+  return (uint8_t)((data[0] * 33 * 33) ^ (data[1] * 33) ^ data[2]);
+}
+
+/**
+  * @brief  Write callback of the decompressor: compares the block with the
+  *         flash instead of writing it, its cycles counted apart
+  * @param  addr offset of the block in the image
+  * @param  data block
+  * @param  size block size
+  * @retval 0
+  */
+static uint8_t LzBenchWrite(uint32_t addr, uint8_t *data, uint32_t size)
+{
+  uint32_t start = HW_GetCycleCount();
+  const uint8_t *image = (const uint8_t *)FLASH_BASE + addr;
+
+  for (uint32_t i = 0; i < size; i++)
+  {
+    if (data[i] != image[i])
+    {
+      LzBenchErrors++;
+    }
+  }
+  LzBenchWriteCycles += HW_GetCycleCount() - start;
+  return 0;
+}
+#endif /* LZ_BENCH_ENABLED */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
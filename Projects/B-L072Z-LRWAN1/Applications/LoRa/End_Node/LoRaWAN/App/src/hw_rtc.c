@@ -43,9 +43,11 @@ typedef struct
 {
   uint32_t  Rtc_Time; /* Reference time */
 
-  RTC_TimeTypeDef RTC_Calndr_Time; /* Reference time in calendar format */
+  uint32_t  Rtc_Ssr; /* Reference sub-seconds register */
 
-  RTC_DateTypeDef RTC_Calndr_Date; /* Reference date in calendar format */
+  uint32_t  Rtc_Tr; /* Reference time of day, BCD, converted when an alarm is set */
+
+  uint32_t  Rtc_Dr; /* Reference date register, converted when an alarm is set */
 
 } RtcTimerContext_t;
 
@@ -127,6 +129,15 @@ static RTC_AlarmTypeDef RTC_AlarmStructure;
  */
 static RtcTimerContext_t RtcTimerContext;
 
+/*!
+ * Date register value and its conversion in seconds at midnight
+ * The date changes once a day, the conversion is only done when it does.
+ * Shared by the main loop and the interrupt handlers reading the time base,
+ * it is only accessed with the interrupts masked
+ */
+static uint32_t RtcDateCacheSeconds = 0;
+static uint32_t RtcDateCacheDr = UINT32_MAX;
+
 /* Private function prototypes -----------------------------------------------*/
 
 static void HW_RTC_SetConfig(void);
@@ -135,7 +146,9 @@ static void HW_RTC_SetAlarmConfig(void);
 
 static void HW_RTC_StartWakeUpAlarm(uint32_t timeoutValue);
 
-static uint64_t HW_RTC_GetCalendarValue(RTC_DateTypeDef *RTC_DateStruct, RTC_TimeTypeDef *RTC_TimeStruct);
+static uint64_t HW_RTC_ReadTimeBase(uint32_t *ssr, uint32_t *time, uint32_t *date);
+
+static uint32_t HW_RTC_DateToSeconds(uint32_t year, uint32_t month, uint32_t date);
 
 
 /* Exported functions ---------------------------------------------------------*/
@@ -211,9 +224,6 @@ static void HW_RTC_SetConfig(void)
  */
 void HW_RTC_setMcuWakeUpTime(void)
 {
-  RTC_TimeTypeDef RTC_TimeStruct;
-  RTC_DateTypeDef RTC_DateStruct;
-
   TimerTime_t now, hit;
   int16_t McuWakeUpTime;
 
@@ -223,7 +233,7 @@ void HW_RTC_setMcuWakeUpTime(void)
     /* warning: works ok if now is below 30 days
        it is ok since it's done once at first alarm wake-up*/
     McuWakeUpTimeInitialized = true;
-    now = (uint32_t) HW_RTC_GetCalendarValue(&RTC_DateStruct, &RTC_TimeStruct);
+    now = (uint32_t) HW_RTC_GetTimeBase();
 
     HAL_RTC_GetAlarm(&RtcHandle, &RTC_AlarmStructure, RTC_ALARM_A, RTC_FORMAT_BIN);
     hit = RTC_AlarmStructure.AlarmTime.Seconds +
@@ -309,10 +319,7 @@ void HW_RTC_SetAlarm(uint32_t timeout)
  */
 uint32_t HW_RTC_GetTimerElapsedTime(void)
 {
-  RTC_TimeTypeDef RTC_TimeStruct;
-  RTC_DateTypeDef RTC_DateStruct;
-
-  uint32_t CalendarValue = (uint32_t) HW_RTC_GetCalendarValue(&RTC_DateStruct, &RTC_TimeStruct);
+  uint32_t CalendarValue = (uint32_t) HW_RTC_GetTimeBase();
 
   return ((uint32_t)(CalendarValue - RtcTimerContext.Rtc_Time));
 }
@@ -323,14 +330,65 @@ uint32_t HW_RTC_GetTimerElapsedTime(void)
  * @retval RTC Timer value in ticks
  */
 uint32_t HW_RTC_GetTimerValue(void)
+{
+  uint32_t CalendarValue = (uint32_t) HW_RTC_GetTimeBase();
+
+  return (CalendarValue);
+}
+
+/*!
+ * @brief Get the 64 bits time base
+ * @note  ticks since 01/01/2000 at midnight on the RTC calendar, which is only
+ *        set by HW_RTC_Init: the value never decreases nor wraps. The timer
+ *        values are its 32 lower bits.
+ * @param none
+ * @retval time base in ticks
+ */
+uint64_t HW_RTC_GetTimeBase(void)
+{
+  uint32_t ssr;
+  uint32_t time;
+  uint32_t date;
+
+  return HW_RTC_ReadTimeBase(&ssr, &time, &date);
+}
+
+#ifdef TIMER_BENCH_ENABLED
+/*!
+ * @brief Get the current time in ticks through the HAL calendar and a full
+ *        date conversion, as the timer paths did before the time base
+ * @note  only kept as the reference of the timer benchmark
+ * @param none
+ * @retval time in ticks
+ */
+uint64_t HW_RTC_GetCalendarTick(void)
 {
   RTC_TimeTypeDef RTC_TimeStruct;
   RTC_DateTypeDef RTC_DateStruct;
+  uint32_t first_read;
+  uint32_t seconds;
 
-  uint32_t CalendarValue = (uint32_t) HW_RTC_GetCalendarValue(&RTC_DateStruct, &RTC_TimeStruct);
+  /* Get Time and Date*/
+  HAL_RTC_GetTime(&RtcHandle, &RTC_TimeStruct, RTC_FORMAT_BIN);
 
-  return (CalendarValue);
+  /* make sure it is correct due to asynchronus nature of RTC*/
+  do
+  {
+    first_read = LL_RTC_TIME_GetSubSecond(RTC);
+    HAL_RTC_GetDate(&RtcHandle, &RTC_DateStruct, RTC_FORMAT_BIN);
+    HAL_RTC_GetTime(&RtcHandle, &RTC_TimeStruct, RTC_FORMAT_BIN);
+  }
+  while (first_read != LL_RTC_TIME_GetSubSecond(RTC));
+
+  seconds = HW_RTC_DateToSeconds(RTC_DateStruct.Year, RTC_DateStruct.Month, RTC_DateStruct.Date);
+
+  seconds += ((uint32_t)RTC_TimeStruct.Seconds +
+              ((uint32_t)RTC_TimeStruct.Minutes * SECONDS_IN_1MINUTE) +
+              ((uint32_t)RTC_TimeStruct.Hours * SECONDS_IN_1HOUR));
+
+  return (((uint64_t) seconds) << N_PREDIV_S) + (PREDIV_S - RTC_TimeStruct.SubSeconds);
 }
+#endif /* TIMER_BENCH_ENABLED */
 
 /*!
  * @brief Stop the Alarm
@@ -397,13 +455,15 @@ void HW_RTC_DelayMs(uint32_t delay)
 }
 
 /*!
- * @brief set Time Reference set also the RTC_DateStruct and RTC_TimeStruct
+ * @brief set Time Reference, also keeps the calendar registers it was read
+ *        from for the next alarm
  * @param none
  * @retval Timer Value
  */
 uint32_t HW_RTC_SetTimerContext(void)
 {
-  RtcTimerContext.Rtc_Time = (uint32_t) HW_RTC_GetCalendarValue(&RtcTimerContext.RTC_Calndr_Date, &RtcTimerContext.RTC_Calndr_Time);
+  RtcTimerContext.Rtc_Time = (uint32_t) HW_RTC_ReadTimeBase(&RtcTimerContext.Rtc_Ssr, &RtcTimerContext.Rtc_Tr,
+                                                            &RtcTimerContext.Rtc_Dr);
   return (uint32_t) RtcTimerContext.Rtc_Time;
 }
 
@@ -441,11 +501,21 @@ static void HW_RTC_StartWakeUpAlarm(uint32_t timeoutValue)
   uint16_t rtcAlarmMinutes = 0;
   uint16_t rtcAlarmHours = 0;
   uint16_t rtcAlarmDays = 0;
-  RTC_TimeTypeDef RTC_TimeStruct = RtcTimerContext.RTC_Calndr_Time;
-  RTC_DateTypeDef RTC_DateStruct = RtcTimerContext.RTC_Calndr_Date;
+  RTC_TimeTypeDef RTC_TimeStruct;
+  RTC_DateTypeDef RTC_DateStruct;
 
   HW_RTC_StopAlarm();
 
+  /* calendar format of the reference, the only conversion left on the timer paths */
+  RTC_TimeStruct.Hours = __LL_RTC_CONVERT_BCD2BIN(__LL_RTC_GET_HOUR(RtcTimerContext.Rtc_Tr));
+  RTC_TimeStruct.Minutes = __LL_RTC_CONVERT_BCD2BIN(__LL_RTC_GET_MINUTE(RtcTimerContext.Rtc_Tr));
+  RTC_TimeStruct.Seconds = __LL_RTC_CONVERT_BCD2BIN(__LL_RTC_GET_SECOND(RtcTimerContext.Rtc_Tr));
+  RTC_TimeStruct.SubSeconds = RtcTimerContext.Rtc_Ssr;
+  RTC_TimeStruct.TimeFormat = RTC_HOURFORMAT12_AM;
+  RTC_DateStruct.Year = __LL_RTC_CONVERT_BCD2BIN((RtcTimerContext.Rtc_Dr & (RTC_DR_YT | RTC_DR_YU)) >> RTC_DR_YU_Pos);
+  RTC_DateStruct.Month = __LL_RTC_CONVERT_BCD2BIN((RtcTimerContext.Rtc_Dr & (RTC_DR_MT | RTC_DR_MU)) >> RTC_DR_MU_Pos);
+  RTC_DateStruct.Date = __LL_RTC_CONVERT_BCD2BIN((RtcTimerContext.Rtc_Dr & (RTC_DR_DT | RTC_DR_DU)) >> RTC_DR_DU_Pos);
+
   /*reverse counter */
   rtcAlarmSubSeconds =  PREDIV_S - RTC_TimeStruct.SubSeconds;
   rtcAlarmSubSeconds += (timeoutValue & PREDIV_S);
@@ -539,52 +609,76 @@ static void HW_RTC_StartWakeUpAlarm(uint32_t timeoutValue)
 
 
 /*!
- * @brief get current time from calendar in ticks
- * @param pointer to RTC_DateStruct
- * @param pointer to RTC_TimeStruct
+ * @brief get current time in ticks, reading the RTC registers directly
+ * @note  no calendar structure is filled, and the date is only converted
+ *        when it changes
+ * @param ssr sub-seconds register value
+ * @param time time of day read with it, BCD
+ * @param date date register value read with it
  * @retval time in ticks
  */
-static uint64_t HW_RTC_GetCalendarValue(RTC_DateTypeDef *RTC_DateStruct, RTC_TimeTypeDef *RTC_TimeStruct)
+static uint64_t HW_RTC_ReadTimeBase(uint32_t *ssr, uint32_t *time, uint32_t *date)
 {
-  uint64_t calendarValue = 0;
-  uint32_t first_read;
-  uint32_t correction;
   uint32_t seconds;
 
-  /* Get Time and Date*/
-  HAL_RTC_GetTime(&RtcHandle, RTC_TimeStruct, RTC_FORMAT_BIN);
+  BACKUP_PRIMASK();
 
   /* make sure it is correct due to asynchronus nature of RTC*/
   do
   {
-    first_read = LL_RTC_TIME_GetSubSecond(RTC);
-    HAL_RTC_GetDate(&RtcHandle, RTC_DateStruct, RTC_FORMAT_BIN);
-    HAL_RTC_GetTime(&RtcHandle, RTC_TimeStruct, RTC_FORMAT_BIN);
+    *ssr = LL_RTC_TIME_GetSubSecond(RTC);
+    *time = LL_RTC_TIME_Get(RTC);
+    *date = READ_REG(RTC->DR);
+  }
+  while (*ssr != LL_RTC_TIME_GetSubSecond(RTC));
+
+  /* an interrupt could otherwise update the cache between the comparison
+     and the use of the conversion */
+  DISABLE_IRQ();
 
+  if (*date != RtcDateCacheDr)
+  {
+    RtcDateCacheSeconds = HW_RTC_DateToSeconds(__LL_RTC_CONVERT_BCD2BIN((*date & (RTC_DR_YT | RTC_DR_YU)) >> RTC_DR_YU_Pos),
+                                               __LL_RTC_CONVERT_BCD2BIN((*date & (RTC_DR_MT | RTC_DR_MU)) >> RTC_DR_MU_Pos),
+                                               __LL_RTC_CONVERT_BCD2BIN((*date & (RTC_DR_DT | RTC_DR_DU)) >> RTC_DR_DU_Pos));
+    RtcDateCacheDr = *date;
   }
-  while (first_read != LL_RTC_TIME_GetSubSecond(RTC));
+  seconds = RtcDateCacheSeconds;
 
-  /* calculte amount of elapsed days since 01/01/2000 */
-  seconds = DIVC((DAYS_IN_YEAR * 3 + DAYS_IN_LEAP_YEAR) * RTC_DateStruct->Year, 4);
+  RESTORE_PRIMASK();
 
-  correction = ((RTC_DateStruct->Year % 4) == 0) ? DAYS_IN_MONTH_CORRECTION_LEAP : DAYS_IN_MONTH_CORRECTION_NORM ;
+  seconds += (uint32_t)__LL_RTC_CONVERT_BCD2BIN(__LL_RTC_GET_SECOND(*time)) +
+             ((uint32_t)__LL_RTC_CONVERT_BCD2BIN(__LL_RTC_GET_MINUTE(*time)) * SECONDS_IN_1MINUTE) +
+             ((uint32_t)__LL_RTC_CONVERT_BCD2BIN(__LL_RTC_GET_HOUR(*time)) * SECONDS_IN_1HOUR);
 
-  seconds += (DIVC((RTC_DateStruct->Month - 1) * (30 + 31), 2) - (((correction >> ((RTC_DateStruct->Month - 1) * 2)) & 0x3)));
+  return (((uint64_t) seconds) << N_PREDIV_S) + (PREDIV_S - *ssr);
+}
 
-  seconds += (RTC_DateStruct->Date - 1);
+/*!
+ * @brief converts a calendar date in seconds elapsed since 01/01/2000 at midnight
+ * @param year  years since 2000
+ * @param month month [1..12]
+ * @param date  day of the month [1..31]
+ * @retval time in seconds
+ */
+static uint32_t HW_RTC_DateToSeconds(uint32_t year, uint32_t month, uint32_t date)
+{
+  uint32_t correction;
+  uint32_t seconds;
 
-  /* convert from days to seconds */
-  seconds *= SECONDS_IN_1DAY;
+  /* calculte amount of elapsed days since 01/01/2000 */
+  seconds = DIVC((DAYS_IN_YEAR * 3 + DAYS_IN_LEAP_YEAR) * year, 4);
 
-  seconds += ((uint32_t)RTC_TimeStruct->Seconds +
-              ((uint32_t)RTC_TimeStruct->Minutes * SECONDS_IN_1MINUTE) +
-              ((uint32_t)RTC_TimeStruct->Hours * SECONDS_IN_1HOUR)) ;
+  correction = ((year % 4) == 0) ? DAYS_IN_MONTH_CORRECTION_LEAP : DAYS_IN_MONTH_CORRECTION_NORM ;
 
+  seconds += (DIVC((month - 1) * (30 + 31), 2) - (((correction >> ((month - 1) * 2)) & 0x3)));
 
+  seconds += (date - 1);
 
-  calendarValue = (((uint64_t) seconds) << N_PREDIV_S) + (PREDIV_S - RTC_TimeStruct->SubSeconds);
+  /* convert from days to seconds */
+  seconds *= SECONDS_IN_1DAY;
 
-  return (calendarValue);
+  return seconds;
 }
 
 /*!
@@ -595,11 +689,9 @@ static uint64_t HW_RTC_GetCalendarValue(RTC_DateTypeDef *RTC_DateStruct, RTC_Tim
  */
 uint32_t HW_RTC_GetCalendarTime(uint16_t *mSeconds)
 {
-  RTC_TimeTypeDef RTC_TimeStruct ;
-  RTC_DateTypeDef RTC_DateStruct;
   uint32_t ticks;
 
-  uint64_t calendarValue = HW_RTC_GetCalendarValue(&RTC_DateStruct, &RTC_TimeStruct);
+  uint64_t calendarValue = HW_RTC_GetTimeBase();
 
   uint32_t seconds = (uint32_t)(calendarValue >> N_PREDIV_S);
 
@@ -646,7 +738,7 @@ TimerTime_t RtcTempCompensation(TimerTime_t period, float temperature)
   interim = ((float) period * ppm) / 1000000;
   // Calculate the resulting time period
   interim += period;
-  interim = floor(interim);
+  interim = MATH_FLOOR(interim);
 
   if (interim < 0.0f)
   {
@@ -26,6 +26,13 @@
 #include "vcom.h"
 #include "version.h"
 #include "sensor.h"
+#ifdef ENERGY_MONITOR_ENABLED
+#include "energy_monitor.h"
+#endif
+#ifdef LORA_JOIN_BACKOFF_ENABLED
+#include "lora-join.h"
+#endif
+#include "bench.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -77,6 +84,17 @@
  */
 #define LORAWAN_FSB                                 2
 
+#ifdef ENERGY_MONITOR_ENABLED
+/*!
+ * LoRaWAN port of the energy diagnostic uplink (see EM_Serialize)
+ */
+#define ENERGY_MONITOR_APP_PORT                     4
+/*!
+ * Number of application uplinks between two energy diagnostic uplinks
+ */
+#define ENERGY_MONITOR_TX_PERIOD                    12
+#endif
+
 /*!
  * User application data
  */
@@ -114,6 +132,11 @@ static uint8_t LORA_GetBatteryLevel(void);
 /* LoRa endNode send request*/
 static void Send(void *context);
 
+#ifdef ENERGY_MONITOR_ENABLED
+/* sends the energy diagnostic uplink once the MAC is idle*/
+static void SendEnergyDiagnostic(void);
+#endif
+
 /* start the tx process*/
 static void LoraStartTx(TxEventType_t EventType);
 
@@ -164,6 +187,18 @@ SensorAxesRaw_t ACCELERO_Value_Old  = { 0, 0, 0 };
  */
 uint8_t upCnt = 0;
 
+#ifdef ENERGY_MONITOR_ENABLED
+/*!
+ * Number of application uplinks since the last energy diagnostic uplink
+ */
+static uint8_t EnergyTxCnt = 0;
+
+/*!
+ * Set when an energy diagnostic uplink is due, until it can be sent
+ */
+static bool EnergyTxPending = false;
+#endif
+
 /* !
  *Initialises the Lora Parameters
  */
@@ -182,6 +217,11 @@ static  LoRaParam_t LoRaParamInit = {LORAWAN_ADR_STATE,
   */
 int main(void)
 {
+#ifdef STACK_MONITOR_ENABLED
+  /* Paint the stack for the high water mark measurement*/
+  HW_StackPaint();
+#endif
+
   /* STM32 HAL library initialization*/
   HAL_Init();
 
@@ -194,15 +234,37 @@ int main(void)
   /* Configure the hardware*/
   HW_Init();
 
+#ifdef ENERGY_MONITOR_ENABLED
+  /* Start the power states accounting*/
+  EM_Init();
+#endif
+
   /* USER CODE BEGIN 1 */
   /* USER CODE END 1 */
 
+#ifdef SE_BENCH_ENABLED
+  /* Before LORA_Init, which initializes the secure element again*/
+  SeBench();
+#endif
+
   /*Disbale Stand-by mode*/
   LPM_SetOffMode(LPM_APPLI_Id, LPM_Disable);
 
   /* Configure the Lora Stack*/
   LORA_Init(&LoRaMainCallbacks, &LoRaParamInit);
 
+#ifdef MATH_BENCH_ENABLED
+  MathBench(ConvertGaussToDegree);
+#endif
+
+#ifdef TIMER_BENCH_ENABLED
+  TimerBench();
+#endif
+
+#ifdef LZ_BENCH_ENABLED
+  LzBench();
+#endif
+
   LORA_Join();
 
   LoraStartTx(TX_ON_TIMER);
@@ -221,7 +283,17 @@ int main(void)
       /*reset notification flag*/
       LoraMacProcessRequest = LORA_RESET;
       LoRaMacProcess();
+#ifdef LORA_JOIN_BACKOFF_ENABLED
+      /* the join scheduler timer notifies through LoraMacProcessNotify */
+      JoinBackoff_Process();
+#endif
     }
+#ifdef ENERGY_MONITOR_ENABLED
+    if ((EnergyTxPending == true) && (AppProcessRequest != LORA_SET) && (LoRaMacIsBusy() == false))
+    {
+      SendEnergyDiagnostic();
+    }
+#endif
     /*If a flag is set at this point, mcu must not enter low power and must loop*/
     DISABLE_IRQ();
 
@@ -265,7 +337,7 @@ static void LORA_HasJoined(void)
 
 static void ConvertGaussToDegree(sensor_t *sensor_data)
 {  
-  heading = ( 180.0 * atan2( sensor_data->magneto.AXIS_Y , sensor_data->magneto.AXIS_X  ) / M_PI );
+  heading = ( 180 * MATH_ATAN2( ( MathFloat_t )sensor_data->magneto.AXIS_Y, ( MathFloat_t )sensor_data->magneto.AXIS_X ) / MATH_PI );
 
   if(heading < 0) 
   {
@@ -364,9 +436,50 @@ static void Send(void *context)
    
   LORA_send(&AppData, LORAWAN_DEFAULT_CONFIRM_MSG_STATE);
 
+#ifdef ENERGY_MONITOR_ENABLED
+  /* The diagnostic follows the application uplink, it never replaces it */
+  if (++EnergyTxCnt >= ENERGY_MONITOR_TX_PERIOD)
+  {
+    EnergyTxCnt = 0;
+    EnergyTxPending = true;
+  }
+#endif
+
   /* USER CODE END 3 */
 }
 
+#ifdef ENERGY_MONITOR_ENABLED
+/**
+  * @brief  Sends the pending energy diagnostic as an extra uplink. When it
+  *         does not fit in the current data rate with the pending MAC
+  *         commands, it is kept pending until after the next application uplink
+  * @param  None
+  * @retval None
+  */
+static void SendEnergyDiagnostic(void)
+{
+  LoRaMacTxInfo_t txInfo;
+
+  EnergyTxPending = false;
+
+  if ((LORA_JoinStatus() != LORA_SET) ||
+      (LoRaMacQueryTxPossible(EM_SERIALIZE_SIZE, &txInfo) != LORAMAC_STATUS_OK))
+  {
+    /* Due again after the next application uplink */
+    EnergyTxCnt = ENERGY_MONITOR_TX_PERIOD - 1;
+    return;
+  }
+
+  AppData.Port = ENERGY_MONITOR_APP_PORT;
+  AppData.BuffSize = EM_Serialize(AppData.Buff, LORAWAN_APP_DATA_BUFF_SIZE);
+
+  PRINTF("ENERGY DIAGNOSTIC\n\r");
+  PrintHexBuffer(AppData.Buff, AppData.BuffSize);
+
+  LORA_send(&AppData, LORAWAN_UNCONFIRMED_MSG);
+}
+#endif /* ENERGY_MONITOR_ENABLED */
+
 static void PrintHexBuffer( uint8_t *buffer, uint8_t size )
 {
     PRINTF("PAYLOAD: ");
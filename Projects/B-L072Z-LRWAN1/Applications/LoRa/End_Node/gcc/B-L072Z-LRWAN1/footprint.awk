@@ -0,0 +1,78 @@
+# Sums the input sections of a GNU ld map file per object file
+#
+# Usage: awk -f footprint.awk end_node.map
+# Prints one "<flash> <ram> <module>" line per object file, in bytes, and a
+# TOTAL line. Sections discarded by --gc-sections are not counted.
+
+function hex(s,    i, v)
+{
+  v = 0
+  s = tolower(s)
+  sub(/^0x/, "", s)
+  for (i = 1; i <= length(s); i++)
+  {
+    v = v * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+  }
+  return v
+}
+
+function add(sec, size, file,    n)
+{
+  if ((file == "") || (size !~ /^0x/))
+  {
+    return
+  }
+  n = hex(size)
+  if (n == 0)
+  {
+    return
+  }
+  sub(/^.*\//, "", file)
+  if (sec ~ /^\.(text|rodata|isr_vector|init|fini|glue|ARM\.exidx|ARM\.extab|preinit_array|init_array|fini_array)/)
+  {
+    flash[file] += n
+  }
+  else if (sec ~ /^\.data/)
+  {
+    flash[file] += n
+    ram[file] += n
+  }
+  else if (sec ~ /^(\.bss|COMMON)/)
+  {
+    ram[file] += n
+  }
+  else
+  {
+    return
+  }
+  seen[file] = 1
+}
+
+/^Linker script and memory map/ { inmap = 1; next }
+!inmap { next }
+
+# Input section, with its address, size and file on the same line or on the next one
+/^ (\.[A-Za-z_]|COMMON)/ {
+  if (NF >= 4)
+  {
+    add($1, $3, $4)
+    pending = ""
+  }
+  else if (NF == 1)
+  {
+    pending = $1
+  }
+  next
+}
+(pending != "") && /^ +0x/ { add(pending, $2, $3) }
+{ pending = "" }
+
+END {
+  for (f in seen)
+  {
+    printf "%8d %8d  %s\n", flash[f], ram[f], f
+    totalFlash += flash[f]
+    totalRam += ram[f]
+  }
+  printf "%8d %8d  %s\n", totalFlash, totalRam, "TOTAL"
+}
@@ -0,0 +1,42 @@
+/**
+  ******************************************************************************
+  * @file    hw.h
+  * @author  MCD Application Team
+  * @brief   Simulated hardware of the network simulator nodes
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HW_H__
+#define __HW_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "hw_conf.h"
+#include "hw_rtc.h"
+#include "util_console.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HW_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,225 @@
+/**
+  ******************************************************************************
+  * @file    sim_air.h
+  * @author  MCD Application Team
+  * @brief   Virtual air interface of the network simulator: propagation,
+  *          collisions, capture and gateway demodulators
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_AIR_H__
+#define __SIM_AIR_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Statistics are kept per spreading factor, index 0 being the FSK frames
+ */
+#define SIM_AIR_SF_NB                               13
+
+/**
+ * SX1276 supply current in reception, LnaBoost on, mA
+ */
+#define SIM_AIR_RX_CURRENT                          11.5
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  SIM_AIR_DELIVERED = 0,       /* demodulated by the gateway */
+  SIM_AIR_LOST_SENSITIVITY,    /* received below the gateway sensitivity */
+  SIM_AIR_LOST_DEMODULATOR,    /* all the gateway demodulation paths busy */
+  SIM_AIR_LOST_COLLISION,      /* not captured over an interferer */
+  SIM_AIR_LOST_GATEWAY,        /* gateway off or transmitting a downlink */
+  SIM_AIR_OUTCOME_NB
+} SimAir_Outcome_t;
+
+typedef struct
+{
+  double PathLossRef;              /* path loss at RefDistance, dB */
+  double RefDistance;              /* m */
+  double PathLossExponent;
+  double ShadowingSigma;           /* log normal shadowing of each node to
+                                      gateway link, dB */
+  double FadingSigma;              /* time varying fading of each link around
+                                      its shadowing, Gauss-Markov, dB */
+  double FadingTime;               /* correlation time of the fading, s */
+  double NoiseFigure;              /* gateway noise figure, dB */
+  double Radius;                   /* the nodes are spread uniformly in a disc
+                                      around the gateway, m */
+  double CaptureThreshold;         /* power margin needed over a same SF
+                                      interferer, dB */
+  uint8_t ImperfectOrthogonality;  /* 1 when the different SFs interfere */
+  uint8_t Demodulators;            /* gateway demodulation paths, 8 on SX1301 */
+} SimAir_Params_t;
+
+typedef struct
+{
+  uint32_t Frequency;              /* Hz */
+  uint32_t Bandwidth;              /* Hz */
+  uint8_t SpreadingFactor;         /* 7 to 12, 0 for FSK */
+  uint16_t PreambleLen;            /* symbols */
+  int8_t Power;                    /* EIRP, dBm */
+  uint8_t Size;                    /* PHY payload, bytes */
+  uint64_t Duration;               /* time on air, us */
+  const uint8_t *Payload;          /* PHY payload, passed to the network server
+                                      when delivered */
+} SimAir_Tx_t;
+
+typedef struct
+{
+  uint32_t Requests;               /* application uplink requests */
+  uint32_t Rejected;               /* requests refused by the MAC, e.g. duty
+                                      cycle */
+  uint32_t JoinRequests;           /* join request frames sent */
+  uint32_t Frames[SIM_AIR_SF_NB][SIM_AIR_OUTCOME_NB];
+  uint64_t AirTime;                /* time on air of all the frames, us */
+  uint64_t RxTime;                 /* time the radios of all the nodes
+                                      listened in a window, us */
+  uint64_t DownlinkTime;           /* time they received downlinks, us */
+  double Energy;                   /* energy the radios of all the nodes
+                                      drew to transmit and receive, mJ */
+  uint64_t DeliveredBytes;         /* PHY payload of the delivered frames */
+} SimAir_Stats_t;
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Seeds the simulator random generator
+ * @param  seed seed value
+ * @retval None
+ */
+void SimAir_Seed(uint32_t seed);
+
+/**
+ * @brief  Draws a random number from the simulator generator
+ * @param  None
+ * @retval 32 bits random value
+ */
+uint32_t SimAir_Random(void);
+
+/**
+ * @brief  Places the nodes and draws their link shadowing, clears the
+ *         statistics
+ * @param  params air interface model parameters
+ * @param  nbNodes number of nodes
+ * @retval 0 in case of success, -1 when out of memory
+ */
+int32_t SimAir_Init(const SimAir_Params_t *params, uint32_t nbNodes);
+
+/**
+ * @brief  Frees the nodes and the transmissions
+ * @param  None
+ * @retval None
+ */
+void SimAir_DeInit(void);
+
+/**
+ * @brief  Gets the path loss between a node and the gateway at the current
+ *         time, fading included
+ * @param  node node index
+ * @retval path loss, dB
+ */
+double SimAir_GetGatewayLoss(uint32_t node);
+
+/**
+ * @brief  Gets the noise power of a receiver
+ * @param  bandwidth Hz
+ * @retval noise, dBm
+ */
+double SimAir_GetNoise(uint32_t bandwidth);
+
+/**
+ * @brief  Gets the gateway sensitivity
+ * @param  sf spreading factor, 0 for FSK
+ * @param  bandwidth Hz
+ * @retval sensitivity, dBm
+ */
+double SimAir_GetSensitivity(uint8_t sf, uint32_t bandwidth);
+
+/**
+ * @brief  Computes the time on air of a LoRa frame, as the SX1276 driver
+ * @param  sf spreading factor
+ * @param  bandwidth Hz
+ * @param  coderate 1 to 4 for 4/5 to 4/8
+ * @param  preambleLen symbols
+ * @param  fixLen implicit header
+ * @param  crcOn payload CRC
+ * @param  size PHY payload, bytes
+ * @retval time on air, us
+ */
+uint64_t SimAir_GetLoRaTimeOnAir(uint8_t sf, uint32_t bandwidth, uint8_t coderate, uint16_t preambleLen,
+                                 bool fixLen, bool crcOn, uint8_t size);
+
+/**
+ * @brief  Starts a transmission of the running node. It is accounted once
+ *         its time on air is over.
+ * @param  tx transmission parameters
+ * @retval None
+ */
+void SimAir_Transmit(const SimAir_Tx_t *tx);
+
+/**
+ * @brief  Makes the gateway deaf over a time interval: outage or
+ *         transmission of a downlink, its radio being half duplex
+ * @param  start us
+ * @param  end us
+ * @retval None
+ */
+void SimAir_SetGatewayOff(uint64_t start, uint64_t end);
+
+/**
+ * @brief  Gets the strongest signal received by the running node
+ * @param  frequency Hz
+ * @param  bandwidth Hz
+ * @retval RSSI, dBm, the noise floor when the channel is free
+ */
+int16_t SimAir_GetRssi(uint32_t frequency, uint32_t bandwidth);
+
+/**
+ * @brief  Counts an application uplink request
+ * @param  accepted 1 when the MAC accepted the request, 0 otherwise
+ * @retval None
+ */
+void SimAir_CountRequest(uint8_t accepted);
+
+/**
+ * @brief  Accounts a reception of a node radio
+ * @param  listening time the radio listened before the downlink, the whole
+ *         window without downlink, us
+ * @param  downlink time the radio received the downlink, us
+ * @retval None
+ */
+void SimAir_CountRxTime(uint64_t listening, uint64_t downlink);
+
+/**
+ * @brief  Gets the statistics of the run
+ * @param  None
+ * @retval statistics
+ */
+const SimAir_Stats_t *SimAir_GetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_AIR_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,89 @@
+/**
+  ******************************************************************************
+  * @file    sim_app.h
+  * @author  MCD Application Team
+  * @brief   Application of the simulated nodes: periodic unconfirmed uplinks
+  *          through the unmodified LoRaMac
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_APP_H__
+#define __SIM_APP_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Activation of the nodes
+ */
+#define SIM_APP_ABP                                 0
+#define SIM_APP_OTAA                                1   /* join retried at once on failure, as lora.c */
+#define SIM_APP_OTAA_BACKOFF                        2   /* join through the lora-join.c back-off scheduler */
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t DevAddr;                /* ABP device address, OTAA DevEUI */
+  uint8_t Activation;              /* SIM_APP_ABP, SIM_APP_OTAA or
+                                      SIM_APP_OTAA_BACKOFF */
+  uint32_t Seed;                   /* node random generator seed */
+  uint8_t SpreadingFactor;         /* uplink spreading factor */
+  uint32_t Period;                 /* mean time between uplinks, ms */
+  uint8_t Periodic;                /* 1: fixed period and random phase,
+                                      0: Poisson arrivals */
+  uint8_t PayloadSize;             /* application payload, bytes */
+  uint8_t SubBand;                 /* US915/AU915 sub-band 1 to 8, 0 for all
+                                      the channels */
+  uint8_t DutyCycle;               /* 1 to enforce the regional duty cycle */
+  int32_t RtcDrift;                /* frequency error of the node RTC, ppm */
+  uint8_t ClassC;                  /* 1 to switch to class C once activated */
+} SimApp_Params_t;
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Initializes the running node: LoRaMac, its activation and the
+ *         uplink timer
+ * @param  params node parameters, copied
+ * @retval 0 in case of success, -1 when the MAC refused the configuration
+ */
+int32_t SimApp_Init(const SimApp_Params_t *params);
+
+/**
+ * @brief  Main loop body of the running node, called after each of its events
+ * @param  None
+ * @retval None
+ */
+void SimApp_Process(void);
+
+/**
+ * @brief  Gets the uplink spreading factors of the simulated region
+ * @param  min lowest spreading factor
+ * @param  max highest spreading factor
+ * @retval None
+ */
+void SimApp_GetSpreadingFactors(uint8_t *min, uint8_t *max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_APP_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,46 @@
+/**
+  ******************************************************************************
+  * @file    sim_mbedtls_config.h
+  * @author  MCD Application Team
+  * @brief   mbedTLS configuration of the host programs: the AES block cipher,
+  *          with the AES-NI instructions unless SIM_MBEDTLS_NO_AESNI is
+  *          defined, and the AES-GCM, AES-CBC and SHA256 of the host Secure
+  *          Engine, its heap counted through the platform allocator
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_MBEDTLS_CONFIG_H__
+#define __SIM_MBEDTLS_CONFIG_H__
+
+/* System support */
+#define MBEDTLS_HAVE_ASM
+#define MBEDTLS_PLATFORM_MEMORY
+
+/* Modules, the AES tables are generated in RAM on the first key expansion */
+#define MBEDTLS_AES_C
+#if !defined( SIM_MBEDTLS_NO_AESNI )
+#define MBEDTLS_AESNI_C
+#endif
+#define MBEDTLS_CIPHER_C
+#define MBEDTLS_CIPHER_MODE_CBC
+#define MBEDTLS_GCM_C
+#define MBEDTLS_PLATFORM_C
+#define MBEDTLS_SHA256_C
+
+#include "mbedtls/check_config.h"
+
+#endif /* __SIM_MBEDTLS_CONFIG_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
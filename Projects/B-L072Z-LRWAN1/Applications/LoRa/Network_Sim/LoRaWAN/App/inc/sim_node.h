@@ -0,0 +1,113 @@
+/**
+  ******************************************************************************
+  * @file    sim_node.h
+  * @author  MCD Application Team
+  * @brief   Simulated nodes contexts and discrete event scheduler
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_NODE_H__
+#define __SIM_NODE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * Event handler, called with the event node selected
+ */
+typedef void (*SimNode_Handler_t)(uint32_t arg);
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Node index of the events not bound to a node (e.g. the air interface)
+ */
+#define SIM_NODE_NONE                               0xFFFFFFFF
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Allocates the nodes contexts, each one being a copy of the node
+ *         image (the variables of the stack and of the simulated hardware)
+ *         as it is before any node runs, and clears the event queue
+ * @param  nbNodes number of nodes
+ * @retval 0 in case of success, -1 when out of memory
+ */
+int32_t SimNode_Init(uint32_t nbNodes);
+
+/**
+ * @brief  Frees the nodes contexts and restores the initial node image
+ * @param  None
+ * @retval None
+ */
+void SimNode_DeInit(void);
+
+/**
+ * @brief  Makes a node the running one, saving the image of the previous one
+ * @param  node node index
+ * @retval None
+ */
+void SimNode_Select(uint32_t node);
+
+/**
+ * @brief  Gets the running node
+ * @param  None
+ * @retval node index, SIM_NODE_NONE outside of the node code
+ */
+uint32_t SimNode_Current(void);
+
+/**
+ * @brief  Gets the simulation time
+ * @param  None
+ * @retval time in us since the start of the run
+ */
+uint64_t SimNode_Now(void);
+
+/**
+ * @brief  Gets the size of a node image
+ * @param  None
+ * @retval size in bytes
+ */
+uint32_t SimNode_GetImageSize(void);
+
+/**
+ * @brief  Schedules an event
+ * @param  node node selected when the event occurs, SIM_NODE_NONE for none
+ * @param  time event time in us, the current time when in the past
+ * @param  handler event handler
+ * @param  arg handler argument, e.g. a sequence number to drop the events
+ *         cancelled since
+ * @retval None
+ */
+void SimNode_SetEvent(uint32_t node, uint64_t time, SimNode_Handler_t handler, uint32_t arg);
+
+/**
+ * @brief  Runs the events in time order, calling the node main loop
+ *         (SimApp_Process) after each node event
+ * @param  duration time in us at which the run stops
+ * @retval None
+ */
+void SimNode_Run(uint64_t duration);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_NODE_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,49 @@
+/**
+  ******************************************************************************
+  * @file    sim_radio.h
+  * @author  MCD Application Team
+  * @brief   Simulated radio of a node, besides the Radio_s interface: the
+  *          gateway downlinks it hears
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_RADIO_H__
+#define __SIM_RADIO_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Event of the start of a class C downlink, see
+ *         SimServer_GetClassCDownlink: the radio of the node locks on it if
+ *         it listens on its channel, continuously, in a receive window or
+ *         in RX duty cycle, and does not receive anything else
+ * @param  arg unused
+ * @retval None
+ */
+void SimRadio_OnDownlink(uint32_t arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_RADIO_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,220 @@
+/**
+  ******************************************************************************
+  * @file    sim_server.h
+  * @author  MCD Application Team
+  * @brief   Simulated network and join server, answering the join requests
+  *          through the half duplex gateway
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_SERVER_H__
+#define __SIM_SERVER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Device address of the node 0, the node n gets SIM_SERVER_DEV_ADDR_BASE + n
+ * (ABP) or is assigned it by the join server (OTAA)
+ */
+#define SIM_SERVER_DEV_ADDR_BASE                    0x26000000
+
+/**
+ * Root key shared by all the simulated nodes and the join server
+ */
+#define SIM_SERVER_NWK_KEY                          { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, \
+                                                      0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C }
+
+/**
+ * Join time of a node which has not joined
+ */
+#define SIM_SERVER_NOT_JOINED                       UINT64_MAX
+
+/**
+ * Answers of the network server to the data uplinks
+ */
+#define SIM_SERVER_DOWNLINK_NONE                    0
+#define SIM_SERVER_DOWNLINK_EMPTY                   1   /* data down without FOpts nor payload */
+#define SIM_SERVER_DOWNLINK_FUZZ                    2   /* random MAC commands */
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t JoinAccepts;            /* join accepts sent */
+  uint32_t DownlinksDropped;       /* downlinks not sent, the gateway being
+                                      already transmitting */
+  uint32_t Joined;                 /* nodes joined */
+  uint32_t DataAnswers;            /* data uplinks answered with a downlink */
+  uint32_t DataDownlinks;          /* data downlinks sent, the node receiving */
+  uint32_t DataReceived;           /* data downlinks accepted by the nodes */
+  uint32_t FuzzProcessed;          /* downlinks processed by the nodes */
+  uint64_t FuzzTime;               /* time the nodes spent processing them, host ns */
+  uint32_t FuzzTimeMax;            /* longest processing of a downlink, host ns */
+} SimServer_Stats_t;
+
+/**
+ * Downlink transmitted by the gateway
+ */
+typedef struct
+{
+  uint64_t Start;                  /* us */
+  uint64_t Duration;               /* time on air, us */
+  uint32_t Frequency;              /* Hz */
+  uint32_t Bandwidth;              /* Hz */
+  uint8_t SpreadingFactor;
+  uint16_t PreambleLen;            /* symbols */
+  uint8_t Size;                    /* PHY payload, bytes */
+  uint8_t Payload[32];
+} SimServer_Downlink_t;
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Allocates the nodes state and clears the statistics
+ * @param  nbNodes number of nodes
+ * @retval 0 in case of success, -1 when out of memory
+ */
+int32_t SimServer_Init(uint32_t nbNodes);
+
+/**
+ * @brief  Frees the nodes state
+ * @param  None
+ * @retval None
+ */
+void SimServer_DeInit(void);
+
+/**
+ * @brief  Sets the answer to the data uplinks, sent in the receive windows
+ *         of the node: none, an empty downlink which times the windows, or
+ *         random FOpts fuzzing the MAC commands, mostly well formed commands
+ *         with random payloads, sometimes truncated, unknown or random bytes.
+ *         Kept across the runs.
+ * @param  mode SIM_SERVER_DOWNLINK_NONE, _EMPTY or _FUZZ
+ * @retval None
+ */
+void SimServer_SetDownlinks(uint8_t mode);
+
+/**
+ * @brief  Sets the class C downlinks: empty data downs sent to each node at
+ *         random times on the default RX2 channel, with a preamble long
+ *         enough to wake up the nodes sniffing it. Kept across the runs.
+ * @param  period mean time between the downlinks of a node, ms, 0 for none
+ * @param  preambleTime wake-up preamble, ms, 0 for the usual 8 symbols
+ * @retval None
+ */
+void SimServer_SetClassC(uint32_t period, uint32_t preambleTime);
+
+/**
+ * @brief  Gets the preamble of the class C downlinks
+ * @param  None
+ * @retval symbols
+ */
+uint16_t SimServer_GetClassCPreambleLen(void);
+
+/**
+ * @brief  Schedules the first class C downlink of each node, when set
+ * @param  None
+ * @retval None
+ */
+void SimServer_StartClassC(void);
+
+/**
+ * @brief  Handles an uplink demodulated by the gateway: a join request is
+ *         answered with a join accept in the receive windows of the node, a
+ *         data uplink as set by SimServer_SetDownlinks
+ * @param  node node index
+ * @param  payload PHY payload
+ * @param  size PHY payload size, bytes
+ * @param  end end of the uplink, us
+ * @retval None
+ */
+void SimServer_OnUplink(uint32_t node, const uint8_t *payload, uint8_t size, uint64_t end);
+
+/**
+ * @brief  Gets the downlink pending for a node in a receive window
+ * @param  node node index
+ * @param  from earliest start of the downlink the node can still lock on, us
+ * @param  to end of the receive window, us
+ * @param  payload PHY payload, 255 bytes buffer
+ * @param  start start of the downlink, us
+ * @retval PHY payload size, 0 when no downlink starts in the window
+ */
+uint8_t SimServer_GetDownlink(uint32_t node, uint64_t from, uint64_t to, uint8_t *payload, uint64_t *start);
+
+/**
+ * @brief  Transmits the downlink returned by SimServer_GetDownlink, unless the
+ *         gateway is already transmitting. The gateway does not receive while
+ *         it transmits.
+ * @param  node node index
+ * @param  start us
+ * @param  duration time on air, us
+ * @retval 0 when sent, -1 when dropped
+ */
+int32_t SimServer_SendDownlink(uint32_t node, uint64_t start, uint64_t duration);
+
+/**
+ * @brief  Gets the class C downlink the gateway is transmitting, whichever
+ *         node it is sent to
+ * @param  None
+ * @retval downlink, NULL when none is on air
+ */
+const SimServer_Downlink_t *SimServer_GetClassCDownlink(void);
+
+/**
+ * @brief  Accounts a downlink processed by the running node
+ * @param  time processing time, host ns
+ * @retval None
+ */
+void SimServer_OnDownlinkProcessed(uint32_t time);
+
+/**
+ * @brief  Accounts a data downlink accepted by the running node
+ * @param  None
+ * @retval None
+ */
+void SimServer_OnDownlinkReceived(void);
+
+/**
+ * @brief  Records the join time of the running node
+ * @param  None
+ * @retval None
+ */
+void SimServer_OnJoined(void);
+
+/**
+ * @brief  Gets the join time of a node
+ * @param  node node index
+ * @retval us, SIM_SERVER_NOT_JOINED when the node has not joined
+ */
+uint64_t SimServer_GetJoinTime(uint32_t node);
+
+/**
+ * @brief  Gets the statistics of the run
+ * @param  None
+ * @retval statistics
+ */
+const SimServer_Stats_t *SimServer_GetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_SERVER_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
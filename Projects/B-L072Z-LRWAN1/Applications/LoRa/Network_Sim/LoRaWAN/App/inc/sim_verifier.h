@@ -0,0 +1,225 @@
+/**
+  ******************************************************************************
+  * @file    sim_verifier.h
+  * @author  MCD Application Team
+  * @brief   Network server side verification of the data uplinks of many
+  *          devices: frame counter, MIC and decryption, on a pool of worker
+  *          threads
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_VERIFIER_H__
+#define __SIM_VERIFIER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "mbedtls/aes.h"
+#include "utilities.h"
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Largest PHY payload of a frame
+ */
+#define SIM_VERIFIER_MAX_FRAME_SIZE                 255
+
+/**
+ * Worker threads of a verifier at most
+ */
+#define SIM_VERIFIER_MAX_WORKERS                    64
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * Outcome of the verification of a frame
+ */
+typedef enum
+{
+  SIM_VERIFIER_SUCCESS = 0,        /* authenticated and decrypted */
+  SIM_VERIFIER_FAIL_FORMAT,        /* too short, FOpts beyond the frame or not
+                                      a data uplink */
+  SIM_VERIFIER_FAIL_ADDRESS,       /* no device of this address */
+  SIM_VERIFIER_FAIL_FCNT,          /* replayed frame counter */
+  SIM_VERIFIER_FAIL_MIC,           /* MIC mismatch */
+  SIM_VERIFIER_ERROR,              /* AES failure */
+} SimVerifier_Status_t;
+
+/**
+ * Key expanded once, with its CMAC subkeys, read concurrently by the workers
+ */
+typedef struct
+{
+  mbedtls_aes_context Aes;
+  uint8_t K1[16];
+  uint8_t K2[16];
+} SimVerifier_Key_t;
+
+/**
+ * Session of a device. The state of a device is only changed by the worker
+ * its address is assigned to, a device needs no lock.
+ */
+typedef struct
+{
+  uint32_t DevAddr;
+  Version_t LrWanVersion;          /* LoRaWAN 1.1 MIC and FOpts encryption
+                                      when the minor version is 1 */
+  SimVerifier_Key_t FNwkSIntKey;   /* NwkSKey of a LoRaWAN 1.0 device */
+  SimVerifier_Key_t SNwkSIntKey;   /* LoRaWAN 1.1 only */
+  SimVerifier_Key_t NwkSEncKey;    /* NwkSKey of a LoRaWAN 1.0 device */
+  SimVerifier_Key_t AppSKey;
+  uint32_t FCntUp;                 /* last accepted uplink frame counter */
+  bool FCntUpValid;                /* false until an uplink is accepted */
+  uint32_t ConfFCntDown;           /* frame counter of the last downlink sent
+                                      to the device, acknowledged by the
+                                      uplinks with ACK set; 0xFFFFFFFF before
+                                      the first downlink, as on the device */
+} SimVerifier_Device_t;
+
+/**
+ * Uplink to verify, the results are written back in the frame
+ */
+typedef struct
+{
+  /* Input */
+  uint8_t Buffer[SIM_VERIFIER_MAX_FRAME_SIZE];    /* PHY payload */
+  uint8_t BufSize;
+  uint8_t TxDr;                    /* datarate and channel index of the
+                                      uplink, in the LoRaWAN 1.1 MIC */
+  uint8_t TxCh;
+  /* Output */
+  SimVerifier_Status_t Status;
+  uint32_t DevAddr;
+  uint32_t FCnt;                   /* 32 bits frame counter */
+  uint8_t FPort;
+  uint8_t FOptsLen;
+  uint8_t FOpts[15];               /* decrypted */
+  uint8_t FRMPayloadSize;
+  uint8_t FRMPayload[SIM_VERIFIER_MAX_FRAME_SIZE]; /* decrypted */
+} SimVerifier_Frame_t;
+
+typedef struct SimVerifier_s SimVerifier_t;
+
+/**
+ * Worker thread of a verifier
+ */
+typedef struct
+{
+  pthread_t Thread;
+  SimVerifier_t *Verifier;
+  uint32_t Index;
+} SimVerifier_Worker_t;
+
+/**
+ * Verifier of the uplinks of a set of devices
+ */
+struct SimVerifier_s
+{
+  SimVerifier_Device_t *Devices;   /* sorted by address */
+  uint32_t DevicesNb;
+  SimVerifier_Worker_t Workers[SIM_VERIFIER_MAX_WORKERS];
+  uint32_t WorkersNb;
+  pthread_mutex_t Lock;
+  pthread_cond_t Start;
+  pthread_cond_t Done;
+  uint32_t Generation;             /* incremented by each batch */
+  uint32_t Pending;                /* workers still on the batch */
+  bool Stop;
+  SimVerifier_Frame_t *Frames;     /* current batch */
+  uint32_t FramesNb;
+};
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Sets the session of a device, expanding its keys. A LoRaWAN 1.0
+ *         device passes its NwkSKey as FNwkSIntKey, SNwkSIntKey and
+ *         NwkSEncKey.
+ * @param  device device to set
+ * @param  devAddr device address
+ * @param  version LoRaWAN version of the device
+ * @param  fNwkSIntKey sNwkSIntKey nwkSEncKey appSKey session keys, 16 bytes
+ * @retval 0 in case of success, -1 when a key cannot be set
+ */
+int32_t SimVerifier_SetDevice(SimVerifier_Device_t *device, uint32_t devAddr, Version_t version,
+                              const uint8_t *fNwkSIntKey, const uint8_t *sNwkSIntKey,
+                              const uint8_t *nwkSEncKey, const uint8_t *appSKey);
+
+/**
+ * @brief  Frees the expanded keys of a device
+ * @param  device device set by SimVerifier_SetDevice
+ * @retval None
+ */
+void SimVerifier_FreeDevice(SimVerifier_Device_t *device);
+
+/**
+ * @brief  Verifies and decrypts an uplink of a device: parsing, 32 bits
+ *         frame counter, MIC, FOpts and FRMPayload. The frame counter of the
+ *         device only advances on an authenticated uplink.
+ * @param  device device of the frame address
+ * @param  frame frame to verify, the status and the decrypted fields are
+ *         written back
+ * @retval status of the frame
+ */
+SimVerifier_Status_t SimVerifier_Unsecure(SimVerifier_Device_t *device, SimVerifier_Frame_t *frame);
+
+/**
+ * @brief  Sorts the devices by address and starts the workers. Kept by the
+ *         verifier, the devices must stay allocated until
+ *         SimVerifier_DeInit.
+ * @param  verifier verifier to start
+ * @param  devices devices set by SimVerifier_SetDevice, distinct addresses
+ * @param  devicesNb number of devices
+ * @param  workersNb worker threads, 0 or 1 to verify in the calling thread
+ * @retval 0 in case of success, -1 when a thread cannot be started
+ */
+int32_t SimVerifier_Init(SimVerifier_t *verifier, SimVerifier_Device_t *devices, uint32_t devicesNb,
+                         uint32_t workersNb);
+
+/**
+ * @brief  Gets the device of an address
+ * @param  verifier verifier
+ * @param  devAddr device address
+ * @retval device, NULL when unknown
+ */
+SimVerifier_Device_t *SimVerifier_GetDevice(SimVerifier_t *verifier, uint32_t devAddr);
+
+/**
+ * @brief  Verifies a batch of uplinks and returns when all are done. The
+ *         frames of a device are all verified by the same worker, in their
+ *         order in the batch.
+ * @param  verifier verifier
+ * @param  frames frames to verify
+ * @param  framesNb number of frames
+ * @retval None
+ */
+void SimVerifier_Process(SimVerifier_t *verifier, SimVerifier_Frame_t *frames, uint32_t framesNb);
+
+/**
+ * @brief  Stops the workers
+ * @param  verifier verifier started by SimVerifier_Init
+ * @retval None
+ */
+void SimVerifier_DeInit(SimVerifier_t *verifier);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_VERIFIER_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,48 @@
+/**
+  ******************************************************************************
+  * @file    utilities_conf.h
+  * @author  MCD Application Team
+  * @brief   configuration for utilities
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __UTLITIES_CONF_H
+#define __UTLITIES_CONF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VERBOSE_LEVEL_0 0
+#define VERBOSE_LEVEL_1 1
+#define VERBOSE_LEVEL_2 2
+
+/* Thousands of nodes would flood the console, the simulator reports its
+   results once each run is over */
+#define VERBOSE_LEVEL 0
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Exported macros -----------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__UTLITIES_CONF_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,671 @@
+/**
+  ******************************************************************************
+  * @file    main.c
+  * @author  MCD Application Team
+  * @brief   LoRaWAN network simulator: many nodes running the unmodified
+  *          LoRaMac and region code share one gateway through a virtual air
+  *          interface. Reports the packet delivery ratio and the throughput
+  *          for each node count, or how fast an OTAA fleet joins again after
+  *          a gateway outage, or how many class C downlinks the nodes miss
+  *          and their receive current, listening or sniffing.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim_air.h"
+#include "sim_app.h"
+#include "sim_node.h"
+#include "sim_server.h"
+#include "trace.h"
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+#include "LoRaMac.h"
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define SIM_MAX_RUNS                                32
+
+/* Transmit power assumed to choose the SF of each node, dBm */
+#define SIM_TX_POWER_REF                            14
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static SimAir_Params_t AirParams =
+{
+  .PathLossRef = 107.41,           /* Bor et al., "Do LoRa low-power wide-area */
+  .RefDistance = 40.0,             /* networks scale?" */
+  .PathLossExponent = 2.08,
+  .ShadowingSigma = 3.57,
+  .FadingSigma = 0,
+  .FadingTime = 600.0,
+  .NoiseFigure = 6.0,
+  .Radius = 1500.0,
+  .CaptureThreshold = 6.0,
+  .ImperfectOrthogonality = 0,
+  .Demodulators = 8,
+};
+
+static SimApp_Params_t AppParams =
+{
+  .Period = 600000,
+  .Periodic = 0,
+  .PayloadSize = 20,
+  .SubBand = 2,
+  .DutyCycle = 1,
+};
+
+static uint32_t NodeCounts[SIM_MAX_RUNS] = { 100, 200, 500, 1000, 2000 };
+
+static uint32_t NbRuns = 5;
+
+static uint32_t Duration = 3600;     /* s */
+
+static int32_t FixedSf = 0;          /* 0: from the link budget, -1: random */
+
+static double SfMargin = 10.0;       /* dB */
+
+static uint32_t Seed = 1;
+
+static uint8_t Verbose = 0;
+
+static uint32_t Outage = 0;          /* gateway off from the start, s */
+
+static uint8_t Downlinks = SIM_SERVER_DOWNLINK_NONE;
+
+static uint32_t RtcDrift = 0;        /* ppm */
+
+static uint32_t ClassCPeriod = 0;    /* mean time between the class C downlinks of a node, s, 0 for class A */
+
+#ifdef LORAMAC_CLASS_C_SNIFF_ENABLED
+/* As LoRaMac.h asks for the sniffing nodes, ms */
+static uint32_t ClassCPreamble = LORAMAC_CLASS_C_SNIFF_PERIOD + LORAMAC_CLASS_C_SNIFF_RX_TIME;
+#else
+static uint32_t ClassCPreamble = 0;  /* ms, 0 for the usual preamble */
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+static void Usage(const char *name);
+static int32_t ParseNodeCounts(const char *list);
+static uint8_t ChooseSpreadingFactor(uint32_t node);
+static int32_t Run(uint32_t nbNodes);
+static void PrintResults(uint32_t nbNodes);
+static void PrintJoinResults(uint32_t nbNodes);
+static void PrintDownlinkResults(void);
+static void PrintFuzzResults(void);
+static void PrintClassCResults(uint32_t nbNodes);
+static int CompareJoinTimes(const void *a, const void *b);
+
+/* Exported functions ------------------------------------------------------- */
+int main(int argc, char *argv[])
+{
+  int opt;
+  uint32_t i;
+  char *end;
+
+  while ((opt = getopt(argc, argv, "n:t:p:l:s:m:r:e:w:y:g:c:b:x:j:d:C:ouDJLafvh")) != -1)
+  {
+    switch (opt)
+    {
+      case 'n':
+        if (ParseNodeCounts(optarg) != 0)
+        {
+          Usage(argv[0]);
+          return 1;
+        }
+        break;
+      case 't':
+        Duration = strtoul(optarg, NULL, 0);
+        break;
+      case 'p':
+        AppParams.Period = 1000 * strtoul(optarg, NULL, 0);
+        break;
+      case 'l':
+        AppParams.PayloadSize = (uint8_t)strtoul(optarg, NULL, 0);
+        break;
+      case 's':
+        if (strcmp(optarg, "auto") == 0)
+        {
+          FixedSf = 0;
+        }
+        else if (strcmp(optarg, "random") == 0)
+        {
+          FixedSf = -1;
+        }
+        else
+        {
+          FixedSf = strtol(optarg, NULL, 0);
+        }
+        break;
+      case 'm':
+        SfMargin = strtod(optarg, NULL);
+        break;
+      case 'r':
+        AirParams.Radius = strtod(optarg, NULL);
+        break;
+      case 'e':
+        AirParams.PathLossExponent = strtod(optarg, NULL);
+        break;
+      case 'w':
+        AirParams.ShadowingSigma = strtod(optarg, NULL);
+        break;
+      case 'y':
+        AirParams.FadingSigma = strtod(optarg, &end);
+        if (*end == ',')
+        {
+          AirParams.FadingTime = strtod(end + 1, NULL);
+        }
+        break;
+      case 'g':
+        AirParams.Demodulators = (uint8_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'c':
+        AirParams.CaptureThreshold = strtod(optarg, NULL);
+        break;
+      case 'b':
+        AppParams.SubBand = (uint8_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'x':
+        Seed = strtoul(optarg, NULL, 0);
+        break;
+      case 'o':
+        AirParams.ImperfectOrthogonality = 1;
+        break;
+      case 'u':
+        AppParams.Periodic = 1;
+        break;
+      case 'D':
+        AppParams.DutyCycle = 0;
+        break;
+      case 'L':
+        AppParams.Activation = SIM_APP_OTAA;
+        break;
+      case 'J':
+        AppParams.Activation = SIM_APP_OTAA_BACKOFF;
+        break;
+      case 'j':
+        Outage = strtoul(optarg, NULL, 0);
+        break;
+      case 'd':
+        RtcDrift = strtoul(optarg, NULL, 0);
+        break;
+      case 'C':
+        ClassCPeriod = strtoul(optarg, &end, 0);
+        if (*end == ',')
+        {
+          ClassCPreamble = strtoul(end + 1, NULL, 0);
+        }
+        break;
+      case 'a':
+        Downlinks = SIM_SERVER_DOWNLINK_EMPTY;
+        break;
+      case 'f':
+        Downlinks = SIM_SERVER_DOWNLINK_FUZZ;
+        break;
+      case 'v':
+        Verbose = 1;
+        break;
+      default:
+        Usage(argv[0]);
+        return (opt == 'h') ? 0 : 1;
+    }
+  }
+
+  if ((Duration == 0) || (AppParams.Period == 0) || (RtcDrift >= 1000000) || (AirParams.FadingTime <= 0) ||
+      ((ClassCPeriod != 0) && ((AppParams.Activation != SIM_APP_ABP) || (Downlinks != SIM_SERVER_DOWNLINK_NONE))))
+  {
+    Usage(argv[0]);
+    return 1;
+  }
+  SimServer_SetDownlinks(Downlinks);
+  SimServer_SetClassC(1000 * ClassCPeriod, ClassCPreamble);
+  AppParams.ClassC = (ClassCPeriod != 0) ? 1 : 0;
+
+  printf("# node image %u bytes, %u s per run, uplink every %u s, %u bytes payload\n",
+         SimNode_GetImageSize(), Duration, AppParams.Period / 1000, AppParams.PayloadSize);
+  if (ClassCPeriod != 0)
+  {
+#if !defined( LORAMAC_CLASS_C_SNIFF_ENABLED )
+    printf("# class C listening continuously, ");
+#elif defined( SIM_RADIO_SX126X )
+    printf("# class C sniffing with the RX duty cycle, %u ms every %u ms, ", LORAMAC_CLASS_C_SNIFF_RX_TIME,
+           LORAMAC_CLASS_C_SNIFF_PERIOD);
+#else
+    printf("# class C sniffing with a CAD every %u ms, ", LORAMAC_CLASS_C_SNIFF_PERIOD);
+#endif
+    printf("downlink every %u s per node, %u symbols preamble\n", ClassCPeriod, SimServer_GetClassCPreambleLen());
+  }
+  if (AppParams.Activation == SIM_APP_ABP)
+  {
+    printf("%8s %9s %8s %9s %9s %8s %8s %9s %8s %7s %10s %7s\n", "nodes", "requests", "rejected", "frames",
+           "delivered", "lost_sen", "lost_dem", "lost_coll", "lost_gw", "pdr_%", "goodput", "load");
+  }
+  else
+  {
+    printf("# %s join, gateway off for the first %u s, join times from its restart\n",
+           (AppParams.Activation == SIM_APP_OTAA) ? "immediate retry" : "back-off", Outage);
+    printf("%8s %9s %9s %9s %9s %8s %8s %8s %7s %7s %7s %7s %7s\n", "nodes", "join_req", "frames",
+           "delivered", "lost_coll", "lost_gw", "accepts", "dl_drop", "joined", "t50_s", "t90_s", "t99_s",
+           "t100_s");
+  }
+
+  for (i = 0; i < NbRuns; i++)
+  {
+    if (Run(NodeCounts[i]) != 0)
+    {
+      fprintf(stderr, "run of %u nodes failed\n", NodeCounts[i]);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief  Trace output of the stack, dropped
+ * @param  strFormat printf format
+ * @retval 0
+ */
+int32_t TraceSend(const char *strFormat, ...)
+{
+  return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Prints the command line help
+ * @param  name program name
+ * @retval None
+ */
+static void Usage(const char *name)
+{
+  printf("Usage: %s [options]\n", name);
+  printf("  -n <list>   node counts, comma separated (100,200,500,1000,2000)\n");
+  printf("  -t <s>      simulated time of each run (3600)\n");
+  printf("  -p <s>      mean time between uplinks of a node (600)\n");
+  printf("  -l <bytes>  application payload (20)\n");
+  printf("  -u          periodic uplinks with a random phase instead of Poisson arrivals\n");
+  printf("  -s <sf>     uplink SF: 7 to 12, auto from the link budget or random (auto)\n");
+  printf("  -m <dB>     link margin of the auto SF choice (10)\n");
+  printf("  -r <m>      deployment radius around the gateway (1500)\n");
+  printf("  -e <n>      path loss exponent (2.08)\n");
+  printf("  -w <dB>     shadowing standard deviation (3.57)\n");
+  printf("  -y <dB>[,<s>] fading standard deviation of each link over time, Gauss-Markov\n");
+  printf("              with the given correlation time (0,600)\n");
+  printf("  -g <n>      gateway demodulation paths (8)\n");
+  printf("  -c <dB>     same SF capture threshold (6)\n");
+  printf("  -o          imperfect SF orthogonality\n");
+  printf("  -b <n>      US915/AU915 sub-band, 0 for all the channels (2)\n");
+  printf("  -D          no regional duty cycle\n");
+  printf("  -L          OTAA nodes retrying the join at once, as lora.c\n");
+  printf("  -J          OTAA nodes joining through the lora-join.c back-off scheduler\n");
+  printf("  -j <s>      gateway off from the start of each run (0)\n");
+  printf("  -d <ppm>    RTC frequency error of each node, uniform within +/- ppm (0)\n");
+  printf("  -a          empty downlink after each ABP uplink, reports the receive time\n");
+  printf("              of the nodes per uplink, their air time and energy per\n");
+  printf("              delivered uplink\n");
+  printf("  -f          random MAC commands in a downlink after each ABP uplink, reports\n");
+  printf("              the host time the MAC takes to process them\n");
+  printf("  -C <s>[,<ms>] ABP nodes in class C, an empty downlink to each one at random\n");
+  printf("              times with the given mean and wake-up preamble, reports the\n");
+  printf("              downlinks missed and the receive current of the nodes (0,%u)\n",
+         (unsigned)ClassCPreamble);
+  printf("  -x <seed>   random seed (1)\n");
+  printf("  -v          results per SF\n");
+}
+
+/**
+ * @brief  Parses the node counts list
+ * @param  list comma separated node counts
+ * @retval 0 in case of success, -1 otherwise
+ */
+static int32_t ParseNodeCounts(const char *list)
+{
+  char *end;
+
+  NbRuns = 0;
+  while (*list != '\0')
+  {
+    if (NbRuns == SIM_MAX_RUNS)
+    {
+      return -1;
+    }
+    NodeCounts[NbRuns] = strtoul(list, &end, 0);
+    if ((end == list) || (NodeCounts[NbRuns] == 0))
+    {
+      return -1;
+    }
+    NbRuns++;
+    list = (*end == ',') ? end + 1 : end;
+  }
+  return (NbRuns != 0) ? 0 : -1;
+}
+
+/**
+ * @brief  Chooses the SF of a node, as a converged network ADR would: the
+ *         lowest one keeping the link margin
+ * @param  node node index
+ * @retval spreading factor
+ */
+static uint8_t ChooseSpreadingFactor(uint32_t node)
+{
+  uint8_t min;
+  uint8_t max;
+  uint8_t sf;
+  double rxPower = SIM_TX_POWER_REF - SimAir_GetGatewayLoss(node);
+
+  SimApp_GetSpreadingFactors(&min, &max);
+  if (FixedSf > 0)
+  {
+    return ((uint8_t)FixedSf < min) ? min : (((uint8_t)FixedSf > max) ? max : (uint8_t)FixedSf);
+  }
+  if (FixedSf < 0)
+  {
+    return min + SimAir_Random() % (max - min + 1);
+  }
+  for (sf = min; sf < max; sf++)
+  {
+    if (rxPower >= SimAir_GetSensitivity(sf, 125000) + SfMargin)
+    {
+      break;
+    }
+  }
+  return sf;
+}
+
+/**
+ * @brief  Simulates a network and prints its results
+ * @param  nbNodes number of nodes
+ * @retval 0 in case of success, -1 otherwise
+ */
+static int32_t Run(uint32_t nbNodes)
+{
+  SimApp_Params_t params = AppParams;
+  uint32_t i;
+
+  /* Same seed for each run, the nodes of a run are a superset of the
+     nodes of the smaller runs */
+  SimAir_Seed(Seed);
+  if ((SimNode_Init(nbNodes) != 0) || (SimAir_Init(&AirParams, nbNodes) != 0) ||
+      (SimServer_Init(nbNodes) != 0))
+  {
+    return -1;
+  }
+  if (Outage != 0)
+  {
+    SimAir_SetGatewayOff(0, (uint64_t)Outage * 1000000);
+  }
+
+  for (i = 0; i < nbNodes; i++)
+  {
+    params.DevAddr = SIM_SERVER_DEV_ADDR_BASE + i;
+    params.Seed = SimAir_Random();
+    params.SpreadingFactor = ChooseSpreadingFactor(i);
+    if (RtcDrift != 0)
+    {
+      params.RtcDrift = (int32_t)(SimAir_Random() % (2 * RtcDrift + 1)) - (int32_t)RtcDrift;
+    }
+
+    SimNode_Select(i);
+    if (SimApp_Init(&params) != 0)
+    {
+      return -1;
+    }
+  }
+
+  SimServer_StartClassC();
+
+  SimNode_Run((uint64_t)Duration * 1000000);
+  if (AppParams.Activation == SIM_APP_ABP)
+  {
+    PrintResults(nbNodes);
+    if (ClassCPeriod != 0)
+    {
+      PrintClassCResults(nbNodes);
+    }
+    else if (Downlinks == SIM_SERVER_DOWNLINK_EMPTY)
+    {
+      PrintDownlinkResults();
+    }
+    else if (Downlinks == SIM_SERVER_DOWNLINK_FUZZ)
+    {
+      PrintFuzzResults();
+    }
+  }
+  else
+  {
+    PrintJoinResults(nbNodes);
+  }
+
+  SimServer_DeInit();
+  SimAir_DeInit();
+  SimNode_DeInit();
+  return 0;
+}
+
+/**
+ * @brief  Prints the results of a run
+ * @param  nbNodes number of nodes
+ * @retval None
+ */
+static void PrintResults(uint32_t nbNodes)
+{
+  const SimAir_Stats_t *stats = SimAir_GetStats();
+  uint32_t total[SIM_AIR_OUTCOME_NB];
+  uint32_t frames = 0;
+  uint32_t sfFrames;
+  uint32_t sf;
+  uint32_t j;
+
+  memset(total, 0, sizeof(total));
+  for (sf = 0; sf < SIM_AIR_SF_NB; sf++)
+  {
+    for (j = 0; j < SIM_AIR_OUTCOME_NB; j++)
+    {
+      total[j] += stats->Frames[sf][j];
+      frames += stats->Frames[sf][j];
+    }
+  }
+
+  /* Goodput in application bit/s, load in Erlang (time on air per second) */
+  printf("%8u %9u %8u %9u %9u %8u %8u %9u %8u %7.2f %10.1f %7.3f\n",
+         nbNodes, stats->Requests, stats->Rejected, frames, total[SIM_AIR_DELIVERED],
+         total[SIM_AIR_LOST_SENSITIVITY], total[SIM_AIR_LOST_DEMODULATOR], total[SIM_AIR_LOST_COLLISION],
+         total[SIM_AIR_LOST_GATEWAY],
+         (frames != 0) ? (100.0 * total[SIM_AIR_DELIVERED] / frames) : 0.0,
+         8.0 * total[SIM_AIR_DELIVERED] * AppParams.PayloadSize / Duration,
+         (double)stats->AirTime / (1e6 * Duration));
+
+  if (Verbose != 0)
+  {
+    for (sf = 0; sf < SIM_AIR_SF_NB; sf++)
+    {
+      sfFrames = 0;
+      for (j = 0; j < SIM_AIR_OUTCOME_NB; j++)
+      {
+        sfFrames += stats->Frames[sf][j];
+      }
+      if (sfFrames != 0)
+      {
+        printf("%6s%2u %9s %8s %9u %9u %8u %8u %9u %8u %7.2f\n", (sf != 0) ? "SF" : "FSK", sf, "", "", sfFrames,
+               stats->Frames[sf][SIM_AIR_DELIVERED], stats->Frames[sf][SIM_AIR_LOST_SENSITIVITY],
+               stats->Frames[sf][SIM_AIR_LOST_DEMODULATOR], stats->Frames[sf][SIM_AIR_LOST_COLLISION],
+               stats->Frames[sf][SIM_AIR_LOST_GATEWAY],
+               100.0 * stats->Frames[sf][SIM_AIR_DELIVERED] / sfFrames);
+      }
+    }
+  }
+}
+
+/**
+ * @brief  Prints the join results of a run: how long after the end of the
+ *         gateway outage 50, 90, 99 and 100 % of the nodes were joined
+ * @param  nbNodes number of nodes
+ * @retval None
+ */
+static void PrintJoinResults(uint32_t nbNodes)
+{
+  static const uint32_t percents[] = { 50, 90, 99, 100 };
+  const SimAir_Stats_t *stats = SimAir_GetStats();
+  const SimServer_Stats_t *server = SimServer_GetStats();
+  uint64_t restart = (uint64_t)Outage * 1000000;
+  uint64_t *times;
+  uint32_t total[SIM_AIR_OUTCOME_NB];
+  uint32_t frames = 0;
+  uint32_t sf;
+  uint32_t i;
+  uint32_t j;
+
+  memset(total, 0, sizeof(total));
+  for (sf = 0; sf < SIM_AIR_SF_NB; sf++)
+  {
+    for (j = 0; j < SIM_AIR_OUTCOME_NB; j++)
+    {
+      total[j] += stats->Frames[sf][j];
+      frames += stats->Frames[sf][j];
+    }
+  }
+
+  printf("%8u %9u %9u %9u %9u %8u %8u %8u %7u", nbNodes, stats->JoinRequests, frames,
+         total[SIM_AIR_DELIVERED], total[SIM_AIR_LOST_COLLISION], total[SIM_AIR_LOST_GATEWAY],
+         server->JoinAccepts, server->DownlinksDropped, server->Joined);
+
+  times = malloc(nbNodes * sizeof(uint64_t));
+  if (times == NULL)
+  {
+    printf("\n");
+    return;
+  }
+  for (i = 0; i < nbNodes; i++)
+  {
+    times[i] = SimServer_GetJoinTime(i);
+  }
+  qsort(times, nbNodes, sizeof(uint64_t), CompareJoinTimes);
+
+  for (i = 0; i < sizeof(percents) / sizeof(percents[0]); i++)
+  {
+    /* Rank of the percentile, rounded up */
+    j = (uint32_t)(((uint64_t)nbNodes * percents[i] + 99) / 100);
+    if (times[(j != 0) ? (j - 1) : 0] == SIM_SERVER_NOT_JOINED)
+    {
+      printf(" %7s", "-");
+    }
+    else
+    {
+      printf(" %7.0f", (times[(j != 0) ? (j - 1) : 0] - restart) / 1e6);
+    }
+  }
+  printf("\n");
+  free(times);
+}
+
+/**
+ * @brief  Prints the downlink results of a run: the data uplinks answered,
+ *         the downlinks sent in a receive window of their node and the ones
+ *         it accepted, and the time the radio of a node spends receiving
+ *         and transmitting per uplink, the air time and radio energy per
+ *         delivered uplink
+ * @param  None
+ * @retval None
+ */
+static void PrintDownlinkResults(void)
+{
+  const SimAir_Stats_t *stats = SimAir_GetStats();
+  const SimServer_Stats_t *server = SimServer_GetStats();
+  uint32_t frames = 0;
+  uint32_t delivered = 0;
+  uint32_t sf;
+  uint32_t j;
+
+  for (sf = 0; sf < SIM_AIR_SF_NB; sf++)
+  {
+    for (j = 0; j < SIM_AIR_OUTCOME_NB; j++)
+    {
+      frames += stats->Frames[sf][j];
+    }
+    delivered += stats->Frames[sf][SIM_AIR_DELIVERED];
+  }
+
+  if (frames == 0)
+  {
+    frames = 1;
+  }
+  if (delivered == 0)
+  {
+    delivered = 1;
+  }
+  printf("# downlinks: %u answered, %u sent, %u received, per uplink %.2f ms in windows, "
+         "%.2f ms receiving downlinks, %.2f ms radio on\n", server->DataAnswers, server->DataDownlinks,
+         server->DataReceived, stats->RxTime / 1e3 / frames, stats->DownlinkTime / 1e3 / frames,
+         (stats->RxTime + stats->DownlinkTime + stats->AirTime) / 1e3 / frames);
+  printf("# per delivered uplink: %.2f ms air time, %.3f mJ radio energy\n",
+         stats->AirTime / 1e3 / delivered, stats->Energy / delivered);
+}
+
+/**
+ * @brief  Prints the MAC commands fuzzing results of a run: the downlinks of
+ *         random FOpts sent and processed, and the host time the MAC took
+ *         from their reception up to their indication
+ * @param  None
+ * @retval None
+ */
+static void PrintFuzzResults(void)
+{
+  const SimServer_Stats_t *server = SimServer_GetStats();
+
+  printf("# fuzz: %u downlinks sent, %u processed, %.2f us per frame, %.2f us max (host)\n",
+         server->DataDownlinks, server->FuzzProcessed,
+         (server->FuzzProcessed != 0) ? (server->FuzzTime / 1e3 / server->FuzzProcessed) : 0.0,
+         server->FuzzTimeMax / 1e3);
+}
+
+/**
+ * @brief  Prints the class C results of a run: the downlinks sent, dropped
+ *         as the gateway was transmitting, accepted by their node and
+ *         missed, and the average receive current of a node, class A
+ *         windows and CAD included, against listening all the time
+ * @param  nbNodes number of nodes
+ * @retval None
+ */
+static void PrintClassCResults(uint32_t nbNodes)
+{
+  const SimAir_Stats_t *stats = SimAir_GetStats();
+  const SimServer_Stats_t *server = SimServer_GetStats();
+  double rx = (double)(stats->RxTime + stats->DownlinkTime) / (1e6 * Duration * nbNodes);
+
+  printf("# class C: %u downlinks sent, %u dropped, %u received, %.2f %% missed, "
+         "RX %.3f mA per node, %.2f %% of continuous RX\n", server->DataDownlinks, server->DownlinksDropped,
+         server->DataReceived,
+         (server->DataDownlinks != 0) ? (100.0 * (server->DataDownlinks - server->DataReceived) / server->DataDownlinks) :
+         0.0, SIM_AIR_RX_CURRENT * rx, 100.0 * rx);
+}
+
+/**
+ * @brief  Orders the join times
+ * @param  a first time
+ * @param  b second time
+ * @retval qsort comparison result
+ */
+static int CompareJoinTimes(const void *a, const void *b)
+{
+  uint64_t ta = *(const uint64_t *)a;
+  uint64_t tb = *(const uint64_t *)b;
+
+  return (ta < tb) ? -1 : ((ta > tb) ? 1 : 0);
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,586 @@
+/**
+  ******************************************************************************
+  * @file    sim_air.c
+  * @author  MCD Application Team
+  * @brief   Virtual air interface of the network simulator.
+  *          - Log distance path loss with log normal shadowing of each link
+  *          - Two frames interfere when they overlap in time on the same
+  *            frequency, with the same SF or with any SF when the imperfect
+  *            orthogonality is modeled
+  *          - A frame is only affected by an interferer overlapping its
+  *            critical section, from its last 5 preamble symbols on
+  *          - Capture: a frame survives each interferer it exceeds by the
+  *            capture threshold (same SF) or by the SIR threshold of the
+  *            SF pair (different SFs, Croce et al.)
+  *          - The gateway locks a demodulation path on each frame above
+  *            its sensitivity for the whole frame, the frames arriving with
+  *            all the paths busy are lost
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_air.h"
+#include "sim_node.h"
+#include "sim_server.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  double X;                        /* m, the gateway being at the origin */
+  double Y;
+  double GatewayLoss;              /* dB */
+  double Fading;                   /* dB */
+  uint64_t FadingUpdate;           /* time of the fading value, us */
+} SimAir_Node_t;
+
+typedef struct
+{
+  uint32_t Id;
+  uint32_t Node;
+  SimAir_Tx_t Tx;
+  uint64_t Start;                  /* us */
+  uint64_t End;
+  uint64_t CriticalStart;          /* interferers before are harmless */
+  double RxPower;                  /* at the gateway, dBm */
+  uint8_t Demodulator;             /* 1 when holding a demodulation path */
+  SimAir_Outcome_t Outcome;
+  uint8_t Payload[255];
+} SimAir_Frame_t;
+
+typedef struct
+{
+  uint64_t Start;                  /* us */
+  uint64_t End;
+} SimAir_Interval_t;
+
+/* Private define ------------------------------------------------------------*/
+/* Preamble symbols needed by the receiver to lock on a frame */
+#define SIM_AIR_LOCK_SYMBOLS                        5
+
+/* Thermal noise density, dBm/Hz */
+#define SIM_AIR_NOISE_DENSITY                       -174.0
+
+/* SNR needed by the FSK demodulator, dB */
+#define SIM_AIR_FSK_SNR                             10.0
+
+/* Frames on air, grown as needed */
+#define SIM_AIR_FRAMES_MIN_SIZE                     64
+
+/* Gateway off intervals kept after their end, longer than any frame, us */
+#define SIM_AIR_OFF_KEEP                            60000000
+
+/* Supply voltage, V */
+#define SIM_AIR_SUPPLY                              3.3
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static SimAir_Params_t Params;
+
+static SimAir_Node_t *Nodes = NULL;
+
+static SimAir_Frame_t *Frames = NULL;
+
+static uint32_t FramesCount = 0;
+
+static uint32_t FramesSize = 0;
+
+static uint32_t FrameId = 0;
+
+static uint8_t DemodulatorsBusy = 0;
+
+static SimAir_Interval_t *GatewayOff = NULL;
+
+static uint32_t GatewayOffCount = 0;
+
+static uint32_t GatewayOffSize = 0;
+
+static SimAir_Stats_t Stats;
+
+static uint64_t RandomState = 1;
+
+/* LoRa demodulator SNR limit, by SF from 7 to 12 (SX1276/SX1301), dB */
+static const double LoRaSnr[6] = { -7.5, -10.0, -12.5, -15.0, -17.5, -20.0 };
+
+/* SX1276 supply current in transmission: output power, dBm, and current, mA
+   (RFO up to 13 dBm, PA_BOOST above) */
+static const double TxCurrent[4][2] = { { 7, 20 }, { 13, 29 }, { 17, 87 }, { 20, 120 } };
+
+/* SIR needed by a frame over an interferer of another SF, rows for the
+   frame SF and columns for the interferer SF from 7 to 12, dB (Croce et
+   al., "Impact of LoRa imperfect orthogonality") */
+static const double InterSfSir[6][6] =
+{
+  {   0,  -8,  -9,  -9,  -9,  -9 },
+  { -11,   0, -11, -12, -13, -13 },
+  { -15, -13,   0, -13, -14, -15 },
+  { -19, -18, -17,   0, -17, -18 },
+  { -22, -22, -21, -20,   0, -20 },
+  { -25, -25, -25, -24, -23,   0 },
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static double SimAir_Uniform(void);
+static double SimAir_Gaussian(void);
+static double SimAir_PathLoss(double distance);
+static double SimAir_GetFading(uint32_t node);
+static double SimAir_GetTxCurrent(int8_t power);
+static void SimAir_Interfere(SimAir_Frame_t *frame, const SimAir_Frame_t *interferer);
+static uint8_t SimAir_IsGatewayOff(uint64_t start, uint64_t end);
+static void SimAir_OnFrameEnd(uint32_t id);
+
+/* Exported functions ------------------------------------------------------- */
+void SimAir_Seed(uint32_t seed)
+{
+  RandomState = ((uint64_t)seed << 1) | 1;
+}
+
+uint32_t SimAir_Random(void)
+{
+  /* xorshift64* */
+  RandomState ^= RandomState >> 12;
+  RandomState ^= RandomState << 25;
+  RandomState ^= RandomState >> 27;
+  return (uint32_t)((RandomState * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+int32_t SimAir_Init(const SimAir_Params_t *params, uint32_t nbNodes)
+{
+  double r;
+  double theta;
+  uint32_t i;
+
+  SimAir_DeInit();
+
+  Params = *params;
+  Nodes = malloc(sizeof(SimAir_Node_t) * nbNodes);
+  FramesSize = SIM_AIR_FRAMES_MIN_SIZE;
+  Frames = malloc(sizeof(SimAir_Frame_t) * FramesSize);
+  if ((Nodes == NULL) || (Frames == NULL))
+  {
+    SimAir_DeInit();
+    return -1;
+  }
+
+  for (i = 0; i < nbNodes; i++)
+  {
+    /* Uniform in the disc */
+    r = Params.Radius * sqrt(SimAir_Uniform());
+    theta = 2 * M_PI * SimAir_Uniform();
+    Nodes[i].X = r * cos(theta);
+    Nodes[i].Y = r * sin(theta);
+    Nodes[i].GatewayLoss = SimAir_PathLoss(r) + Params.ShadowingSigma * SimAir_Gaussian();
+    Nodes[i].Fading = 0;
+    Nodes[i].FadingUpdate = 0;
+  }
+  if (Params.FadingSigma > 0)
+  {
+    for (i = 0; i < nbNodes; i++)
+    {
+      Nodes[i].Fading = Params.FadingSigma * SimAir_Gaussian();
+    }
+  }
+  return 0;
+}
+
+void SimAir_DeInit(void)
+{
+  free(Nodes);
+  Nodes = NULL;
+  free(Frames);
+  Frames = NULL;
+  FramesCount = 0;
+  FramesSize = 0;
+  free(GatewayOff);
+  GatewayOff = NULL;
+  GatewayOffCount = 0;
+  GatewayOffSize = 0;
+  DemodulatorsBusy = 0;
+  memset(&Stats, 0, sizeof(Stats));
+}
+
+double SimAir_GetGatewayLoss(uint32_t node)
+{
+  return Nodes[node].GatewayLoss + SimAir_GetFading(node);
+}
+
+double SimAir_GetNoise(uint32_t bandwidth)
+{
+  return SIM_AIR_NOISE_DENSITY + 10 * log10(bandwidth) + Params.NoiseFigure;
+}
+
+double SimAir_GetSensitivity(uint8_t sf, uint32_t bandwidth)
+{
+  double noise = SimAir_GetNoise(bandwidth);
+
+  if ((sf < 7) || (sf > 12))
+  {
+    return noise + SIM_AIR_FSK_SNR;
+  }
+  return noise + LoRaSnr[sf - 7];
+}
+
+uint64_t SimAir_GetLoRaTimeOnAir(uint8_t sf, uint32_t bandwidth, uint8_t coderate, uint16_t preambleLen,
+                                 bool fixLen, bool crcOn, uint8_t size)
+{
+  double ts = (double)(1 << sf) / bandwidth;
+  double tmp;
+  bool lowDatarateOptimize = (ts > 0.016) ? true : false;
+
+  tmp = ceil((8 * size - 4 * sf + 28 + 16 * (crcOn ? 1 : 0) - (fixLen ? 20 : 0)) /
+             (double)(4 * (sf - (lowDatarateOptimize ? 2 : 0)))) * (coderate + 4);
+  return (uint64_t)(1e6 * ts * ((preambleLen + 4.25) + 8 + ((tmp > 0) ? tmp : 0)));
+}
+
+void SimAir_Transmit(const SimAir_Tx_t *tx)
+{
+  SimAir_Frame_t *frame;
+  SimAir_Frame_t *frames;
+  double symbol;
+  uint32_t i;
+
+  if (FramesCount == FramesSize)
+  {
+    frames = realloc(Frames, sizeof(SimAir_Frame_t) * FramesSize * 2);
+    if (frames == NULL)
+    {
+      abort();
+    }
+    Frames = frames;
+    FramesSize *= 2;
+  }
+
+  frame = &Frames[FramesCount];
+  frame->Id = FrameId++;
+  frame->Node = SimNode_Current();
+  frame->Tx = *tx;
+  frame->Start = SimNode_Now();
+  frame->End = frame->Start + tx->Duration;
+  frame->RxPower = tx->Power - SimAir_GetGatewayLoss(frame->Node);
+  Stats.Energy += SimAir_GetTxCurrent(tx->Power) * SIM_AIR_SUPPLY * tx->Duration / 1e6;
+  frame->Demodulator = 0;
+  frame->Outcome = SIM_AIR_DELIVERED;
+  if (tx->Payload != NULL)
+  {
+    memcpy(frame->Payload, tx->Payload, tx->Size);
+    if ((tx->Size != 0) && ((tx->Payload[0] >> 5) == 0))
+    {
+      Stats.JoinRequests++;
+    }
+  }
+
+  frame->CriticalStart = frame->Start;
+  if ((tx->SpreadingFactor != 0) && (tx->PreambleLen > SIM_AIR_LOCK_SYMBOLS))
+  {
+    symbol = 1e6 * (double)(1 << tx->SpreadingFactor) / tx->Bandwidth;
+    frame->CriticalStart += (uint64_t)((tx->PreambleLen - SIM_AIR_LOCK_SYMBOLS) * symbol);
+  }
+
+  if (SimAir_IsGatewayOff(frame->Start, frame->Start) != 0)
+  {
+    frame->Outcome = SIM_AIR_LOST_GATEWAY;
+  }
+  else if (frame->RxPower < SimAir_GetSensitivity(tx->SpreadingFactor, tx->Bandwidth))
+  {
+    frame->Outcome = SIM_AIR_LOST_SENSITIVITY;
+  }
+  else if (DemodulatorsBusy < Params.Demodulators)
+  {
+    DemodulatorsBusy++;
+    frame->Demodulator = 1;
+  }
+  else
+  {
+    frame->Outcome = SIM_AIR_LOST_DEMODULATOR;
+  }
+
+  /* Every overlapping pair is seen here: one of the two frames starts while
+     the other one is on air */
+  for (i = 0; i < FramesCount; i++)
+  {
+    SimAir_Interfere(frame, &Frames[i]);
+    SimAir_Interfere(&Frames[i], frame);
+  }
+  FramesCount++;
+
+  SimNode_SetEvent(SIM_NODE_NONE, frame->End, SimAir_OnFrameEnd, frame->Id);
+}
+
+void SimAir_SetGatewayOff(uint64_t start, uint64_t end)
+{
+  SimAir_Interval_t *intervals;
+  uint32_t i = 0;
+
+  /* Drops the intervals no frame on air can overlap any more */
+  while (i < GatewayOffCount)
+  {
+    if (GatewayOff[i].End + SIM_AIR_OFF_KEEP < start)
+    {
+      GatewayOff[i] = GatewayOff[--GatewayOffCount];
+    }
+    else
+    {
+      i++;
+    }
+  }
+
+  if (GatewayOffCount == GatewayOffSize)
+  {
+    GatewayOffSize = (GatewayOffSize != 0) ? (2 * GatewayOffSize) : 16;
+    intervals = realloc(GatewayOff, sizeof(SimAir_Interval_t) * GatewayOffSize);
+    if (intervals == NULL)
+    {
+      abort();
+    }
+    GatewayOff = intervals;
+  }
+  GatewayOff[GatewayOffCount].Start = start;
+  GatewayOff[GatewayOffCount].End = end;
+  GatewayOffCount++;
+}
+
+int16_t SimAir_GetRssi(uint32_t frequency, uint32_t bandwidth)
+{
+  SimAir_Node_t *node = &Nodes[SimNode_Current()];
+  SimAir_Node_t *source;
+  double rssi = SIM_AIR_NOISE_DENSITY + 10 * log10(bandwidth) + Params.NoiseFigure;
+  double power;
+  uint32_t i;
+
+  for (i = 0; i < FramesCount; i++)
+  {
+    if ((Frames[i].Tx.Frequency == frequency) && (Frames[i].Node != SimNode_Current()))
+    {
+      /* No shadowing between the nodes */
+      source = &Nodes[Frames[i].Node];
+      power = Frames[i].Tx.Power - SimAir_PathLoss(hypot(node->X - source->X, node->Y - source->Y));
+      if (power > rssi)
+      {
+        rssi = power;
+      }
+    }
+  }
+  return (int16_t)floor(rssi);
+}
+
+void SimAir_CountRequest(uint8_t accepted)
+{
+  Stats.Requests++;
+  if (accepted == 0)
+  {
+    Stats.Rejected++;
+  }
+}
+
+void SimAir_CountRxTime(uint64_t listening, uint64_t downlink)
+{
+  Stats.RxTime += listening;
+  Stats.DownlinkTime += downlink;
+  Stats.Energy += SIM_AIR_RX_CURRENT * SIM_AIR_SUPPLY * (listening + downlink) / 1e6;
+}
+
+const SimAir_Stats_t *SimAir_GetStats(void)
+{
+  return &Stats;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Draws a uniform random number
+ * @param  None
+ * @retval value in ]0, 1]
+ */
+static double SimAir_Uniform(void)
+{
+  return ((double)SimAir_Random() + 1.0) / 4294967296.0;
+}
+
+/**
+ * @brief  Draws a normal random number (Box-Muller)
+ * @param  None
+ * @retval value of mean 0 and standard deviation 1
+ */
+static double SimAir_Gaussian(void)
+{
+  return sqrt(-2 * log(SimAir_Uniform())) * cos(2 * M_PI * SimAir_Uniform());
+}
+
+/**
+ * @brief  Computes the log distance path loss, without shadowing
+ * @param  distance m
+ * @retval path loss, dB
+ */
+static double SimAir_PathLoss(double distance)
+{
+  if (distance < 1.0)
+  {
+    distance = 1.0;
+  }
+  return Params.PathLossRef + 10 * Params.PathLossExponent * log10(distance / Params.RefDistance);
+}
+
+/**
+ * @brief  Brings the fading of a link to the current time: first order
+ *         Gauss-Markov process, its correlation decaying exponentially
+ * @param  node node index
+ * @retval fading, dB
+ */
+static double SimAir_GetFading(uint32_t node)
+{
+  SimAir_Node_t *n = &Nodes[node];
+  uint64_t now = SimNode_Now();
+  double rho;
+
+  if ((Params.FadingSigma <= 0) || (now <= n->FadingUpdate))
+  {
+    return n->Fading;
+  }
+  rho = exp(-(double)(now - n->FadingUpdate) / (1e6 * Params.FadingTime));
+  n->Fading = rho * n->Fading + sqrt(1 - rho * rho) * Params.FadingSigma * SimAir_Gaussian();
+  n->FadingUpdate = now;
+  return n->Fading;
+}
+
+/**
+ * @brief  Interpolates the supply current of the transmitter
+ * @param  power output power, dBm
+ * @retval mA
+ */
+static double SimAir_GetTxCurrent(int8_t power)
+{
+  uint32_t i;
+
+  if (power <= TxCurrent[0][0])
+  {
+    return TxCurrent[0][1];
+  }
+  for (i = 1; i < 3; i++)
+  {
+    if (power <= TxCurrent[i][0])
+    {
+      break;
+    }
+  }
+  return TxCurrent[i - 1][1] + (TxCurrent[i][1] - TxCurrent[i - 1][1]) * (power - TxCurrent[i - 1][0]) /
+         (TxCurrent[i][0] - TxCurrent[i - 1][0]);
+}
+
+/**
+ * @brief  Applies the interference of a frame on another one
+ * @param  frame interfered frame
+ * @param  interferer interfering frame, overlapping frame in time
+ * @retval None
+ */
+static void SimAir_Interfere(SimAir_Frame_t *frame, const SimAir_Frame_t *interferer)
+{
+  uint8_t sf = frame->Tx.SpreadingFactor;
+  uint8_t otherSf = interferer->Tx.SpreadingFactor;
+  uint64_t overlapEnd = (frame->End < interferer->End) ? frame->End : interferer->End;
+  double threshold;
+
+  if ((frame->Outcome != SIM_AIR_DELIVERED) || (frame->Tx.Frequency != interferer->Tx.Frequency))
+  {
+    return;
+  }
+  /* Locked on the frame before the interferer started */
+  if (overlapEnd <= frame->CriticalStart)
+  {
+    return;
+  }
+
+  if (sf == otherSf)
+  {
+    threshold = Params.CaptureThreshold;
+  }
+  else if ((Params.ImperfectOrthogonality != 0) && (sf >= 7) && (sf <= 12) && (otherSf >= 7) && (otherSf <= 12))
+  {
+    threshold = InterSfSir[sf - 7][otherSf - 7];
+  }
+  else
+  {
+    return;
+  }
+
+  if (frame->RxPower - interferer->RxPower < threshold)
+  {
+    frame->Outcome = SIM_AIR_LOST_COLLISION;
+  }
+}
+
+/**
+ * @brief  Checks whether the gateway is off during a time interval
+ * @param  start us
+ * @param  end us
+ * @retval 1 when it is off during part of the interval, 0 otherwise
+ */
+static uint8_t SimAir_IsGatewayOff(uint64_t start, uint64_t end)
+{
+  uint32_t i;
+
+  for (i = 0; i < GatewayOffCount; i++)
+  {
+    if ((GatewayOff[i].Start <= end) && (GatewayOff[i].End > start))
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief  Accounts a frame at the end of its time on air
+ * @param  id frame identifier
+ * @retval None
+ */
+static void SimAir_OnFrameEnd(uint32_t id)
+{
+  SimAir_Frame_t *frame = NULL;
+  uint32_t i;
+
+  for (i = 0; i < FramesCount; i++)
+  {
+    if (Frames[i].Id == id)
+    {
+      frame = &Frames[i];
+      break;
+    }
+  }
+  if (frame == NULL)
+  {
+    return;
+  }
+
+  if (frame->Demodulator != 0)
+  {
+    DemodulatorsBusy--;
+  }
+  /* Downlink started during the reception */
+  if ((frame->Outcome == SIM_AIR_DELIVERED) && (SimAir_IsGatewayOff(frame->Start, frame->End) != 0))
+  {
+    frame->Outcome = SIM_AIR_LOST_GATEWAY;
+  }
+  Stats.Frames[frame->Tx.SpreadingFactor][frame->Outcome]++;
+  Stats.AirTime += frame->Tx.Duration;
+  if (frame->Outcome == SIM_AIR_DELIVERED)
+  {
+    Stats.DeliveredBytes += frame->Tx.Size;
+    SimServer_OnUplink(frame->Node, frame->Payload, frame->Tx.Size, frame->End);
+  }
+
+  Frames[i] = Frames[--FramesCount];
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,536 @@
+/**
+  ******************************************************************************
+  * @file    sim_app.c
+  * @author  MCD Application Team
+  * @brief   Application of the simulated nodes: ABP or OTAA activation and
+  *          unconfirmed uplinks through the unmodified LoRaMac, as lora.c,
+  *          in class A or in class C for the ABP nodes
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <time.h>
+#include "hw.h"
+#include "timeServer.h"
+#include "LoRaMac.h"
+#include "LoRaMacTest.h"
+#include "lora-join.h"
+#include "sim_air.h"
+#include "sim_app.h"
+#include "sim_server.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define SIM_APP_PORT                                2
+
+#define SIM_APP_NETWORK_ID                          0
+
+#define SIM_APP_MAX_PAYLOAD                         242
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* The node variables are part of its image, see sim_node.c */
+static SimApp_Params_t Params;
+
+static LoRaMacPrimitives_t LoRaMacPrimitives;
+
+static LoRaMacCallback_t LoRaMacCallbacks;
+
+static TimerEvent_t UplinkTimer;
+
+static uint8_t UplinkPending = 0;
+
+static uint8_t AppBuffer[SIM_APP_MAX_PAYLOAD];
+
+/* Same session keys for all the nodes, no network server checks them */
+static uint8_t FNwkSIntKey[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+
+static uint8_t SNwkSIntKey[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+
+static uint8_t NwkSEncKey[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+
+static uint8_t AppSKey[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+
+/* Same root keys for all the nodes, known by the join server */
+static uint8_t NwkKey[16] = SIM_SERVER_NWK_KEY;
+
+static uint8_t AppKey[16] = SIM_SERVER_NWK_KEY;
+
+static uint8_t JoinEui[8] = { 0 };
+
+static uint8_t DevEui[8];
+
+/* Non volatile memory of the join back-off history */
+static uint8_t JoinNvm[JOIN_BACKOFF_NVM_SIZE];
+
+/* Private function prototypes -----------------------------------------------*/
+static void McpsConfirm(McpsConfirm_t *mcpsConfirm);
+static void McpsIndication(McpsIndication_t *mcpsIndication);
+static void MlmeConfirm(MlmeConfirm_t *mlmeConfirm);
+static void MlmeIndication(MlmeIndication_t *mlmeIndication);
+static uint8_t SimApp_GetBatteryLevel(void);
+static uint16_t SimApp_GetTemperatureLevel(void);
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+static uint32_t SimApp_GetCycleCount(void);
+#endif
+static void SimApp_OnUplinkTimer(void *context);
+static void SimApp_StartUplinkTimer(uint32_t mean);
+static void SimApp_Send(void);
+static void SimApp_InitAbp(void);
+static void SimApp_Join(void);
+static uint8_t SimApp_IsJoined(void);
+static int8_t SimApp_GetDatarate(void);
+static void SimApp_JoinNvmRead(uint8_t *data, uint16_t size);
+static void SimApp_JoinNvmWrite(const uint8_t *data, uint16_t size);
+
+/* Exported functions ------------------------------------------------------- */
+int32_t SimApp_Init(const SimApp_Params_t *params)
+{
+  MibRequestConfirm_t mibReq;
+  LoRaMacStatus_t status;
+  JoinBackoffParams_t joinBackoffParams;
+  uint8_t i;
+#if defined( REGION_AU915 ) || defined( REGION_US915 )
+  uint16_t channelMask[6] = { 0, 0, 0, 0, 0, 0 };
+#endif
+
+  Params = *params;
+  srand1(Params.Seed);
+  HW_RTC_SetDrift(Params.RtcDrift);
+
+  LoRaMacPrimitives.MacMcpsConfirm = McpsConfirm;
+  LoRaMacPrimitives.MacMcpsIndication = McpsIndication;
+  LoRaMacPrimitives.MacMlmeConfirm = MlmeConfirm;
+  LoRaMacPrimitives.MacMlmeIndication = MlmeIndication;
+  LoRaMacCallbacks.GetBatteryLevel = SimApp_GetBatteryLevel;
+  LoRaMacCallbacks.GetTemperatureLevel = SimApp_GetTemperatureLevel;
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+  LoRaMacCallbacks.GetCycleCount = SimApp_GetCycleCount;
+#endif
+
+#if defined( REGION_AS923 )
+  status = LoRaMacInitialization(&LoRaMacPrimitives, &LoRaMacCallbacks, LORAMAC_REGION_AS923);
+#elif defined( REGION_AU915 )
+  status = LoRaMacInitialization(&LoRaMacPrimitives, &LoRaMacCallbacks, LORAMAC_REGION_AU915);
+#elif defined( REGION_CN470 )
+  status = LoRaMacInitialization(&LoRaMacPrimitives, &LoRaMacCallbacks, LORAMAC_REGION_CN470);
+#elif defined( REGION_CN779 )
+  status = LoRaMacInitialization(&LoRaMacPrimitives, &LoRaMacCallbacks, LORAMAC_REGION_CN779);
+#elif defined( REGION_EU433 )
+  status = LoRaMacInitialization(&LoRaMacPrimitives, &LoRaMacCallbacks, LORAMAC_REGION_EU433);
+#elif defined( REGION_IN865 )
+  status = LoRaMacInitialization(&LoRaMacPrimitives, &LoRaMacCallbacks, LORAMAC_REGION_IN865);
+#elif defined( REGION_EU868 )
+  status = LoRaMacInitialization(&LoRaMacPrimitives, &LoRaMacCallbacks, LORAMAC_REGION_EU868);
+#elif defined( REGION_KR920 )
+  status = LoRaMacInitialization(&LoRaMacPrimitives, &LoRaMacCallbacks, LORAMAC_REGION_KR920);
+#elif defined( REGION_US915 )
+  status = LoRaMacInitialization(&LoRaMacPrimitives, &LoRaMacCallbacks, LORAMAC_REGION_US915);
+#elif defined( REGION_RU864 )
+  status = LoRaMacInitialization(&LoRaMacPrimitives, &LoRaMacCallbacks, LORAMAC_REGION_RU864);
+#else
+    #error "Please define a region in the compiler options."
+#endif
+  if (status != LORAMAC_STATUS_OK)
+  {
+    return -1;
+  }
+
+#if defined( REGION_AU915 ) || defined( REGION_US915 )
+  if ((Params.SubBand >= 1) && (Params.SubBand <= 8))
+  {
+    /* 8 channels of 125 kHz and 1 channel of 500 kHz, as a 8 channels gateway */
+    channelMask[(Params.SubBand - 1) / 2] = ((Params.SubBand % 2) != 0) ? 0x00FF : 0xFF00;
+    channelMask[4] = 1 << (Params.SubBand - 1);
+    mibReq.Type = MIB_CHANNELS_MASK;
+    mibReq.Param.ChannelsMask = channelMask;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+    mibReq.Type = MIB_CHANNELS_DEFAULT_MASK;
+    mibReq.Param.ChannelsDefaultMask = channelMask;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+  }
+#endif
+
+  mibReq.Type = MIB_ADR;
+  mibReq.Param.AdrEnable = false;
+  LoRaMacMibSetRequestConfirm(&mibReq);
+
+  mibReq.Type = MIB_PUBLIC_NETWORK;
+  mibReq.Param.EnablePublicNetwork = true;
+  LoRaMacMibSetRequestConfirm(&mibReq);
+
+  mibReq.Type = MIB_DEVICE_CLASS;
+  mibReq.Param.Class = CLASS_A;
+  LoRaMacMibSetRequestConfirm(&mibReq);
+
+#if defined( REGION_EU868 ) || defined( REGION_RU864 ) || defined( REGION_CN779 ) || defined( REGION_EU433 )
+  LoRaMacTestSetDutyCycleOn((Params.DutyCycle != 0) ? true : false);
+#endif
+
+  if (Params.Activation != SIM_APP_ABP)
+  {
+    /* DevEUI from the node address, big endian as the MIB expects it */
+    for (i = 0; i < 8; i++)
+    {
+      DevEui[i] = (i < 4) ? 0 : (uint8_t)(Params.DevAddr >> (8 * (7 - i)));
+    }
+    mibReq.Type = MIB_DEV_EUI;
+    mibReq.Param.DevEui = DevEui;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    mibReq.Type = MIB_JOIN_EUI;
+    mibReq.Param.JoinEui = JoinEui;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    mibReq.Type = MIB_APP_KEY;
+    mibReq.Param.AppKey = AppKey;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    mibReq.Type = MIB_NWK_KEY;
+    mibReq.Param.NwkKey = NwkKey;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    LoRaMacStart();
+
+    if (Params.Activation == SIM_APP_OTAA_BACKOFF)
+    {
+      joinBackoffParams.MinDatarate = DR_0;
+      joinBackoffParams.MaxDatarate = SimApp_GetDatarate();
+      joinBackoffParams.NvmRead = SimApp_JoinNvmRead;
+      joinBackoffParams.NvmWrite = SimApp_JoinNvmWrite;
+      /* SimApp_Process runs after every event of the node */
+      joinBackoffParams.ProcessNotify = NULL;
+      JoinBackoff_Init(&joinBackoffParams);
+    }
+    /* Joins at power up as the End_Node application */
+    SimApp_Join();
+  }
+  else
+  {
+    SimApp_InitAbp();
+
+    if (Params.ClassC != 0)
+    {
+      /* Listens, or sniffs, on the default class C channel */
+      mibReq.Type = MIB_DEVICE_CLASS;
+      mibReq.Param.Class = CLASS_C;
+      if (LoRaMacMibSetRequestConfirm(&mibReq) != LORAMAC_STATUS_OK)
+      {
+        return -1;
+      }
+    }
+  }
+
+  /* The first uplink occurs at a random time within the first period */
+  TimerInit(&UplinkTimer, SimApp_OnUplinkTimer);
+  TimerSetValue(&UplinkTimer, randr(0, Params.Period));
+  TimerStart(&UplinkTimer);
+  return 0;
+}
+
+void SimApp_Process(void)
+{
+  LoRaMacProcess();
+
+  if (Params.Activation == SIM_APP_OTAA_BACKOFF)
+  {
+    JoinBackoff_Process();
+  }
+
+  if (UplinkPending != 0)
+  {
+    UplinkPending = 0;
+    if ((Params.Activation != SIM_APP_ABP) && (SimApp_IsJoined() == 0))
+    {
+      /* As the End_Node application, each uplink period retries the join */
+      SimApp_Join();
+    }
+    else
+    {
+      SimApp_Send();
+    }
+    SimApp_StartUplinkTimer(Params.Period);
+  }
+}
+
+void SimApp_GetSpreadingFactors(uint8_t *min, uint8_t *max)
+{
+  *min = 7;
+#if defined( REGION_US915 )
+  /* SF11 and SF12 are not allowed on the 125 kHz uplink channels */
+  *max = 10;
+#else
+  *max = 12;
+#endif
+}
+
+/* Private functions ---------------------------------------------------------*/
+static void McpsConfirm(McpsConfirm_t *mcpsConfirm)
+{
+}
+
+static void McpsIndication(McpsIndication_t *mcpsIndication)
+{
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+  MibRequestConfirm_t mibReq;
+#endif
+
+  if (mcpsIndication->Status == LORAMAC_EVENT_INFO_STATUS_OK)
+  {
+    SimServer_OnDownlinkReceived();
+  }
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+
+  /* The reception is processed up to its indication */
+  mibReq.Type = MIB_LATENCY_STATS;
+  LoRaMacMibGetRequestConfirm(&mibReq);
+  SimServer_OnDownlinkProcessed(mibReq.Param.LatencyStats[LORAMAC_LATENCY_RX_DONE].Last);
+#endif
+}
+
+static void MlmeConfirm(MlmeConfirm_t *mlmeConfirm)
+{
+  if (mlmeConfirm->MlmeRequest != MLME_JOIN)
+  {
+    return;
+  }
+  if (Params.Activation == SIM_APP_OTAA_BACKOFF)
+  {
+    JoinBackoff_OnConfirm(mlmeConfirm);
+  }
+  if (mlmeConfirm->Status == LORAMAC_EVENT_INFO_STATUS_OK)
+  {
+    SimServer_OnJoined();
+  }
+  else if (Params.Activation == SIM_APP_OTAA)
+  {
+    SimApp_Join();
+  }
+}
+
+static void MlmeIndication(MlmeIndication_t *mlmeIndication)
+{
+}
+
+/**
+ * @brief  Battery level reported in the DevStatusAns
+ * @param  None
+ * @retval 254 for the maximum level
+ */
+static uint8_t SimApp_GetBatteryLevel(void)
+{
+  return 254;
+}
+
+/**
+ * @brief  Temperature used by the class B beacon timing compensation
+ * @param  None
+ * @retval 25 degree C
+ */
+static uint16_t SimApp_GetTemperatureLevel(void)
+{
+  return 25;
+}
+
+#ifdef LORAMAC_LATENCY_PROBES_ENABLED
+/**
+ * @brief  Cycle counter of the latency probes of the MAC: the host time
+ * @param  None
+ * @retval ns, wrapping
+ */
+static uint32_t SimApp_GetCycleCount(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)((uint64_t)now.tv_sec * 1000000000 + now.tv_nsec);
+}
+#endif
+
+/**
+ * @brief  Uplink timer callback, the uplink is sent from SimApp_Process
+ * @param  context unused
+ * @retval None
+ */
+static void SimApp_OnUplinkTimer(void *context)
+{
+  UplinkPending = 1;
+}
+
+/**
+ * @brief  Starts the uplink timer for the next uplink
+ * @param  mean mean time between uplinks, ms
+ * @retval None
+ */
+static void SimApp_StartUplinkTimer(uint32_t mean)
+{
+  uint32_t delay = mean;
+  double u;
+
+  if (Params.Periodic == 0)
+  {
+    /* Poisson arrivals: exponential time between uplinks */
+    u = (randr(1, 0x7FFFFFFF) / 2147483648.0);
+    delay = (uint32_t)(-log(u) * mean);
+  }
+  TimerSetValue(&UplinkTimer, delay);
+  TimerStart(&UplinkTimer);
+}
+
+/**
+ * @brief  Requests an unconfirmed uplink of the configured payload size
+ * @param  None
+ * @retval None
+ */
+static void SimApp_Send(void)
+{
+  McpsReq_t mcpsReq;
+  LoRaMacStatus_t status;
+  uint8_t size = (Params.PayloadSize < SIM_APP_MAX_PAYLOAD) ? Params.PayloadSize : SIM_APP_MAX_PAYLOAD;
+  int8_t datarate = SimApp_GetDatarate();
+
+  memset1(AppBuffer, (uint8_t)randr(0, 255), size);
+
+  mcpsReq.Type = MCPS_UNCONFIRMED;
+  mcpsReq.Req.Unconfirmed.fPort = SIM_APP_PORT;
+  mcpsReq.Req.Unconfirmed.fBuffer = AppBuffer;
+  mcpsReq.Req.Unconfirmed.fBufferSize = size;
+  mcpsReq.Req.Unconfirmed.Datarate = datarate;
+  status = LoRaMacMcpsRequest(&mcpsReq);
+
+  SimAir_CountRequest((status == LORAMAC_STATUS_OK) ? 1 : 0);
+}
+
+/**
+ * @brief  Activates the node by personalization, with the same session keys
+ *         for all the nodes
+ * @param  None
+ * @retval None
+ */
+static void SimApp_InitAbp(void)
+{
+  MibRequestConfirm_t mibReq;
+  Version_t abpLrWanVersion;
+
+  mibReq.Type = MIB_NET_ID;
+  mibReq.Param.NetID = SIM_APP_NETWORK_ID;
+  LoRaMacMibSetRequestConfirm(&mibReq);
+
+  mibReq.Type = MIB_DEV_ADDR;
+  mibReq.Param.DevAddr = Params.DevAddr;
+  LoRaMacMibSetRequestConfirm(&mibReq);
+
+  mibReq.Type = MIB_F_NWK_S_INT_KEY;
+  mibReq.Param.FNwkSIntKey = FNwkSIntKey;
+  LoRaMacMibSetRequestConfirm(&mibReq);
+
+  mibReq.Type = MIB_S_NWK_S_INT_KEY;
+  mibReq.Param.SNwkSIntKey = SNwkSIntKey;
+  LoRaMacMibSetRequestConfirm(&mibReq);
+
+  mibReq.Type = MIB_NWK_S_ENC_KEY;
+  mibReq.Param.NwkSEncKey = NwkSEncKey;
+  LoRaMacMibSetRequestConfirm(&mibReq);
+
+  mibReq.Type = MIB_APP_S_KEY;
+  mibReq.Param.AppSKey = AppSKey;
+  LoRaMacMibSetRequestConfirm(&mibReq);
+
+  mibReq.Type = MIB_NETWORK_ACTIVATION;
+  mibReq.Param.NetworkActivation = ACTIVATION_TYPE_ABP;
+  LoRaMacMibSetRequestConfirm(&mibReq);
+
+  abpLrWanVersion.Fields.Major    = 1;
+  abpLrWanVersion.Fields.Minor    = 0;
+  abpLrWanVersion.Fields.Revision = 3;
+  abpLrWanVersion.Fields.Rfu      = 0;
+  mibReq.Type = MIB_ABP_LORAWAN_VERSION;
+  mibReq.Param.AbpLrWanVersion = abpLrWanVersion;
+  LoRaMacMibSetRequestConfirm(&mibReq);
+
+  LoRaMacStart();
+}
+
+/**
+ * @brief  Requests a join, as LORA_Join in lora.c or through the back-off
+ *         scheduler
+ * @param  None
+ * @retval None
+ */
+static void SimApp_Join(void)
+{
+  MlmeReq_t mlmeReq;
+
+  if (Params.Activation == SIM_APP_OTAA_BACKOFF)
+  {
+    JoinBackoff_Start();
+    return;
+  }
+  mlmeReq.Type = MLME_JOIN;
+  mlmeReq.Req.Join.Datarate = SimApp_GetDatarate();
+  LoRaMacMlmeRequest(&mlmeReq);
+}
+
+/**
+ * @brief  Tells whether the node is activated
+ * @param  None
+ * @retval 1 when activated, 0 otherwise
+ */
+static uint8_t SimApp_IsJoined(void)
+{
+  MibRequestConfirm_t mibReq;
+
+  mibReq.Type = MIB_NETWORK_ACTIVATION;
+  LoRaMacMibGetRequestConfirm(&mibReq);
+  return (mibReq.Param.NetworkActivation != ACTIVATION_TYPE_NONE) ? 1 : 0;
+}
+
+/**
+ * @brief  Gets the datarate of the node spreading factor
+ * @param  None
+ * @retval datarate
+ */
+static int8_t SimApp_GetDatarate(void)
+{
+#if defined( REGION_US915 )
+  return 10 - Params.SpreadingFactor;
+#else
+  return 12 - Params.SpreadingFactor;
+#endif
+}
+
+/**
+ * @brief  Reads the join back-off history from the node memory
+ * @param  data history buffer
+ * @param  size history size
+ * @retval None
+ */
+static void SimApp_JoinNvmRead(uint8_t *data, uint16_t size)
+{
+  memcpy1(data, JoinNvm, (size < sizeof(JoinNvm)) ? size : sizeof(JoinNvm));
+}
+
+/**
+ * @brief  Writes the join back-off history to the node memory
+ * @param  data history buffer
+ * @param  size history size
+ * @retval None
+ */
+static void SimApp_JoinNvmWrite(const uint8_t *data, uint16_t size)
+{
+  memcpy1(JoinNvm, data, (size < sizeof(JoinNvm)) ? size : sizeof(JoinNvm));
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
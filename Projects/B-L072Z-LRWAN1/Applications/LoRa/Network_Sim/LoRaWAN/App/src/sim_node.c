@@ -0,0 +1,298 @@
+/**
+  ******************************************************************************
+  * @file    sim_node.c
+  * @author  MCD Application Team
+  * @brief   Simulated nodes contexts and discrete event scheduler.
+  *          The stack is linked once and keeps its state in static variables.
+  *          The node objects are built with their .data and .bss sections
+  *          renamed to sim_node_data and sim_node_bss (see the Makefile), so
+  *          that switching nodes amounts to saving and restoring these two
+  *          ranges: the stack runs unmodified for every node.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include "sim_node.h"
+#include "sim_app.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint64_t Time;
+  uint64_t Order;                  /* insertion order, for the equal times */
+  uint32_t Node;
+  uint32_t Arg;
+  SimNode_Handler_t Handler;
+} SimNode_Event_t;
+
+/* Private define ------------------------------------------------------------*/
+#define SIM_NODE_QUEUE_MIN_SIZE                     256
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Node image bounds, defined by the linker */
+extern uint8_t __start_sim_node_data[];
+extern uint8_t __stop_sim_node_data[];
+extern uint8_t __start_sim_node_bss[];
+extern uint8_t __stop_sim_node_bss[];
+
+static uint8_t *InitialImage = NULL;
+
+static uint8_t *Images = NULL;
+
+static uint32_t CurrentNode = SIM_NODE_NONE;
+
+static uint64_t Now = 0;
+
+static SimNode_Event_t *Queue = NULL;
+
+static uint32_t QueueCount = 0;
+
+static uint32_t QueueSize = 0;
+
+static uint64_t QueueOrder = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t SimNode_DataSize(void);
+static void SimNode_SaveImage(uint8_t *image);
+static void SimNode_LoadImage(const uint8_t *image);
+static int32_t SimNode_Before(const SimNode_Event_t *a, const SimNode_Event_t *b);
+static void SimNode_Pop(SimNode_Event_t *event);
+
+/* Exported functions ------------------------------------------------------- */
+int32_t SimNode_Init(uint32_t nbNodes)
+{
+  uint32_t size = SimNode_GetImageSize();
+  uint32_t i;
+
+  SimNode_DeInit();
+
+  if (InitialImage == NULL)
+  {
+    /* Nothing ran yet, this is the image of a node out of reset */
+    InitialImage = malloc(size);
+    if (InitialImage == NULL)
+    {
+      return -1;
+    }
+    SimNode_SaveImage(InitialImage);
+  }
+
+  Images = malloc((size_t)size * nbNodes);
+  QueueSize = SIM_NODE_QUEUE_MIN_SIZE + 4 * nbNodes;
+  Queue = malloc(sizeof(SimNode_Event_t) * QueueSize);
+  if ((Images == NULL) || (Queue == NULL))
+  {
+    SimNode_DeInit();
+    return -1;
+  }
+  for (i = 0; i < nbNodes; i++)
+  {
+    memcpy(&Images[(size_t)size * i], InitialImage, size);
+  }
+  Now = 0;
+  return 0;
+}
+
+void SimNode_DeInit(void)
+{
+  if (InitialImage != NULL)
+  {
+    SimNode_LoadImage(InitialImage);
+  }
+  CurrentNode = SIM_NODE_NONE;
+  free(Images);
+  Images = NULL;
+  free(Queue);
+  Queue = NULL;
+  QueueCount = 0;
+  QueueSize = 0;
+  QueueOrder = 0;
+}
+
+void SimNode_Select(uint32_t node)
+{
+  uint32_t size = SimNode_GetImageSize();
+
+  if (node == CurrentNode)
+  {
+    return;
+  }
+  if (CurrentNode != SIM_NODE_NONE)
+  {
+    SimNode_SaveImage(&Images[(size_t)size * CurrentNode]);
+  }
+  if (node != SIM_NODE_NONE)
+  {
+    SimNode_LoadImage(&Images[(size_t)size * node]);
+  }
+  CurrentNode = node;
+}
+
+uint32_t SimNode_Current(void)
+{
+  return CurrentNode;
+}
+
+uint64_t SimNode_Now(void)
+{
+  return Now;
+}
+
+uint32_t SimNode_GetImageSize(void)
+{
+  return SimNode_DataSize() + (uint32_t)(__stop_sim_node_bss - __start_sim_node_bss);
+}
+
+void SimNode_SetEvent(uint32_t node, uint64_t time, SimNode_Handler_t handler, uint32_t arg)
+{
+  SimNode_Event_t *queue;
+  SimNode_Event_t event;
+  uint32_t i;
+  uint32_t parent;
+
+  if (QueueCount == QueueSize)
+  {
+    queue = realloc(Queue, sizeof(SimNode_Event_t) * QueueSize * 2);
+    if (queue == NULL)
+    {
+      abort();
+    }
+    Queue = queue;
+    QueueSize *= 2;
+  }
+
+  event.Time = (time < Now) ? Now : time;
+  event.Order = QueueOrder++;
+  event.Node = node;
+  event.Arg = arg;
+  event.Handler = handler;
+
+  /* Binary heap ordered by time, then by insertion */
+  i = QueueCount++;
+  while (i > 0)
+  {
+    parent = (i - 1) / 2;
+    if (SimNode_Before(&Queue[parent], &event) != 0)
+    {
+      break;
+    }
+    Queue[i] = Queue[parent];
+    i = parent;
+  }
+  Queue[i] = event;
+}
+
+void SimNode_Run(uint64_t duration)
+{
+  SimNode_Event_t event;
+
+  while ((QueueCount != 0) && (Queue[0].Time < duration))
+  {
+    SimNode_Pop(&event);
+    Now = event.Time;
+
+    SimNode_Select(event.Node);
+    event.Handler(event.Arg);
+    if (event.Node != SIM_NODE_NONE)
+    {
+      /* The node main loop runs once its interrupt is handled */
+      SimApp_Process();
+    }
+  }
+  Now = duration;
+  SimNode_Select(SIM_NODE_NONE);
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Gets the size of the initialized part of the node image
+ * @param  None
+ * @retval size in bytes
+ */
+static uint32_t SimNode_DataSize(void)
+{
+  return (uint32_t)(__stop_sim_node_data - __start_sim_node_data);
+}
+
+/**
+ * @brief  Copies the node variables to a context
+ * @param  image context
+ * @retval None
+ */
+static void SimNode_SaveImage(uint8_t *image)
+{
+  memcpy(image, __start_sim_node_data, SimNode_DataSize());
+  memcpy(image + SimNode_DataSize(), __start_sim_node_bss, __stop_sim_node_bss - __start_sim_node_bss);
+}
+
+/**
+ * @brief  Copies a context to the node variables
+ * @param  image context
+ * @retval None
+ */
+static void SimNode_LoadImage(const uint8_t *image)
+{
+  memcpy(__start_sim_node_data, image, SimNode_DataSize());
+  memcpy(__start_sim_node_bss, image + SimNode_DataSize(), __stop_sim_node_bss - __start_sim_node_bss);
+}
+
+/**
+ * @brief  Compares two events
+ * @param  a first event
+ * @param  b second event
+ * @retval 1 when a occurs first, 0 otherwise
+ */
+static int32_t SimNode_Before(const SimNode_Event_t *a, const SimNode_Event_t *b)
+{
+  if (a->Time != b->Time)
+  {
+    return (a->Time < b->Time) ? 1 : 0;
+  }
+  return (a->Order < b->Order) ? 1 : 0;
+}
+
+/**
+ * @brief  Removes the next event from the queue
+ * @param  event next event
+ * @retval None
+ */
+static void SimNode_Pop(SimNode_Event_t *event)
+{
+  SimNode_Event_t last;
+  uint32_t i = 0;
+  uint32_t child;
+
+  *event = Queue[0];
+  last = Queue[--QueueCount];
+
+  while ((child = 2 * i + 1) < QueueCount)
+  {
+    if ((child + 1 < QueueCount) && (SimNode_Before(&Queue[child + 1], &Queue[child]) != 0))
+    {
+      child++;
+    }
+    if (SimNode_Before(&last, &Queue[child]) != 0)
+    {
+      break;
+    }
+    Queue[i] = Queue[child];
+    i = child;
+  }
+  Queue[i] = last;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,679 @@
+/**
+  ******************************************************************************
+  * @file    sim_radio.c
+  * @author  MCD Application Team
+  * @brief   Simulated radio of a node, implementing the Radio_s interface on
+  *          the virtual air interface. A receive window gets the downlink
+  *          the server scheduled in it, if any, and times out otherwise. A
+  *          radio listening on the class C channel locks on the class C
+  *          downlinks, a CAD detects their preambles. Build with
+  *          SIM_RADIO_SX126X for the RX duty cycle of the SX126x radios.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "hw.h"
+#include "radio.h"
+#include "sim_air.h"
+#include "sim_node.h"
+#include "sim_radio.h"
+#include "sim_server.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  RadioModems_t Modem;
+  uint32_t Bandwidth;              /* Hz */
+  uint32_t Datarate;               /* SF for LoRa, bit/s for FSK */
+  uint8_t Coderate;                /* LoRa 1 to 4 for 4/5 to 4/8 */
+  uint16_t PreambleLen;
+  bool FixLen;
+  bool CrcOn;
+  int8_t Power;
+} SimRadio_TxConfig_t;
+
+typedef struct
+{
+  uint32_t Bandwidth;              /* Hz */
+  uint32_t Datarate;
+  uint16_t SymbTimeout;
+  bool RxContinuous;
+} SimRadio_RxConfig_t;
+
+/* Private define ------------------------------------------------------------*/
+/* Same wake up time as the SX1276 on the B-L072Z-LRWAN1, ms */
+#define SIM_RADIO_WAKEUP_TIME                       7
+
+/* Noise floor reference bandwidth of the RSSI measurements, Hz */
+#define SIM_RADIO_RSSI_BANDWIDTH                    125000
+
+/* Preamble symbols the receiver can still lock on after the start of a frame */
+#define SIM_RADIO_LOCK_SYMBOLS                      3
+
+/* Preamble of the downlinks without wake-up preamble, symbols */
+#define SIM_RADIO_PREAMBLE_LEN                      8
+
+/* Gateway downlink EIRP, dBm */
+#define SIM_RADIO_GATEWAY_POWER                     14
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* The node variables are part of its image, see sim_node.c */
+static RadioEvents_t *RadioEvents = NULL;
+
+static RadioState_t State = RF_IDLE;
+
+static RadioModems_t Modem = MODEM_FSK;
+
+static uint32_t Channel = 0;
+
+static SimRadio_TxConfig_t TxConfig;
+
+static SimRadio_RxConfig_t RxConfig;
+
+static uint32_t EventSeq = 0;        /* changed on each operation, drops the events of the previous ones */
+
+static uint8_t RxBuffer[255];
+
+static uint8_t RxSize = 0;
+
+static uint64_t RxStart = 0;         /* start of the current reception, us */
+
+static uint64_t RxFrameStart = 0;    /* start of the downlink it receives, 0 for none */
+
+static uint32_t RxDutyTime = 0;      /* listening time of each RX duty cycle period, us */
+
+static uint32_t RxDutyPeriod = 0;    /* RX duty cycle period, us, 0 when listening continuously */
+
+/* Private function prototypes -----------------------------------------------*/
+static void SimRadio_IoInit(void);
+static void SimRadio_IoDeInit(void);
+static uint32_t SimRadio_Init(RadioEvents_t *events);
+static RadioState_t SimRadio_GetStatus(void);
+static void SimRadio_SetModem(RadioModems_t modem);
+static void SimRadio_SetChannel(uint32_t freq);
+static bool SimRadio_IsChannelFree(RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime);
+static uint32_t SimRadio_Random(void);
+static void SimRadio_SetRxConfig(RadioModems_t modem, uint32_t bandwidth,
+                                 uint32_t datarate, uint8_t coderate,
+                                 uint32_t bandwidthAfc, uint16_t preambleLen,
+                                 uint16_t symbTimeout, bool fixLen,
+                                 uint8_t payloadLen,
+                                 bool crcOn, bool freqHopOn, uint8_t hopPeriod,
+                                 bool iqInverted, bool rxContinuous);
+static void SimRadio_SetTxConfig(RadioModems_t modem, int8_t power, uint32_t fdev,
+                                 uint32_t bandwidth, uint32_t datarate,
+                                 uint8_t coderate, uint16_t preambleLen,
+                                 bool fixLen, bool crcOn, bool freqHopOn,
+                                 uint8_t hopPeriod, bool iqInverted, uint32_t timeout);
+static bool SimRadio_CheckRfFrequency(uint32_t frequency);
+static uint32_t SimRadio_TimeOnAir(RadioModems_t modem, uint8_t pktLen);
+static void SimRadio_Send(uint8_t *buffer, uint8_t size);
+static void SimRadio_Sleep(void);
+static void SimRadio_Standby(void);
+static void SimRadio_Rx(uint32_t timeout);
+static void SimRadio_StartCad(void);
+static void SimRadio_SetTxContinuousWave(uint32_t freq, int8_t power, uint16_t time);
+static int16_t SimRadio_Rssi(RadioModems_t modem);
+static void SimRadio_Write(uint16_t addr, uint8_t data);
+static uint8_t SimRadio_Read(uint16_t addr);
+static void SimRadio_WriteBuffer(uint16_t addr, uint8_t *buffer, uint8_t size);
+static void SimRadio_ReadBuffer(uint16_t addr, uint8_t *buffer, uint8_t size);
+static void SimRadio_SetMaxPayloadLength(RadioModems_t modem, uint8_t max);
+static void SimRadio_SetPublicNetwork(bool enable);
+static uint32_t SimRadio_GetWakeupTime(void);
+#ifdef SIM_RADIO_SX126X
+static void SimRadio_SetRxDutyCycle(uint32_t rxTime, uint32_t sleepTime);
+#endif
+static uint64_t SimRadio_TimeOnAirUs(uint8_t pktLen);
+static uint32_t SimRadio_LoRaBandwidth(uint32_t bandwidth);
+static bool SimRadio_IsClassCChannel(const SimServer_Downlink_t *downlink);
+static bool SimRadio_LockClassC(uint64_t detect);
+static uint64_t SimRadio_ListenTime(uint64_t end);
+static void SimRadio_SetState(RadioState_t state);
+static void SimRadio_OnTxDone(uint32_t seq);
+static void SimRadio_OnRxTimeout(uint32_t seq);
+static void SimRadio_OnRxDone(uint32_t seq);
+static void SimRadio_OnCadDone(uint32_t seq);
+
+/* Exported variables --------------------------------------------------------*/
+const struct Radio_s Radio =
+{
+  SimRadio_IoInit,
+  SimRadio_IoDeInit,
+  SimRadio_Init,
+  SimRadio_GetStatus,
+  SimRadio_SetModem,
+  SimRadio_SetChannel,
+  SimRadio_IsChannelFree,
+  SimRadio_Random,
+  SimRadio_SetRxConfig,
+  SimRadio_SetTxConfig,
+  SimRadio_CheckRfFrequency,
+  SimRadio_TimeOnAir,
+  SimRadio_Send,
+  SimRadio_Sleep,
+  SimRadio_Standby,
+  SimRadio_Rx,
+  SimRadio_StartCad,
+  SimRadio_SetTxContinuousWave,
+  SimRadio_Rssi,
+  SimRadio_Write,
+  SimRadio_Read,
+  SimRadio_WriteBuffer,
+  SimRadio_ReadBuffer,
+  SimRadio_SetMaxPayloadLength,
+  SimRadio_SetPublicNetwork,
+  SimRadio_GetWakeupTime,
+  NULL,                            /* IrqProcess: the events are not deferred */
+  SimRadio_Rx,                     /* RxBoosted */
+#ifdef SIM_RADIO_SX126X
+  SimRadio_SetRxDutyCycle,
+#else
+  NULL,                            /* SetRxDutyCycle: none on the SX1276, the
+                                      class C sniff uses CAD */
+#endif
+  NULL,                            /* GetIrqTime */
+};
+
+/* Exported functions ------------------------------------------------------- */
+void SimRadio_OnDownlink(uint32_t arg)
+{
+  uint64_t now = SimNode_Now();
+  uint64_t phase;
+
+  /* Asleep, transmitting or in CAD, which finds the preamble once done */
+  if (State != RF_RX_RUNNING)
+  {
+    return;
+  }
+  if (RxDutyPeriod != 0)
+  {
+    /* Detected in the current listening slot or at the start of the next one */
+    phase = (now - RxStart) % RxDutyPeriod;
+    SimRadio_LockClassC((phase < RxDutyTime) ? now : (now + RxDutyPeriod - phase));
+  }
+  else
+  {
+    SimRadio_LockClassC(now);
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+static void SimRadio_IoInit(void)
+{
+}
+
+static void SimRadio_IoDeInit(void)
+{
+}
+
+static uint32_t SimRadio_Init(RadioEvents_t *events)
+{
+  RadioEvents = events;
+  SimRadio_SetState(RF_IDLE);
+  EventSeq++;
+  return SIM_RADIO_WAKEUP_TIME;
+}
+
+static RadioState_t SimRadio_GetStatus(void)
+{
+  return State;
+}
+
+static void SimRadio_SetModem(RadioModems_t modem)
+{
+  Modem = modem;
+}
+
+static void SimRadio_SetChannel(uint32_t freq)
+{
+  Channel = freq;
+}
+
+static bool SimRadio_IsChannelFree(RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime)
+{
+  /* Sensed at once, the carrier sense time is not simulated */
+  return (SimAir_GetRssi(freq, SIM_RADIO_RSSI_BANDWIDTH) <= rssiThresh) ? true : false;
+}
+
+static uint32_t SimRadio_Random(void)
+{
+  return SimAir_Random();
+}
+
+static void SimRadio_SetRxConfig(RadioModems_t modem, uint32_t bandwidth,
+                                 uint32_t datarate, uint8_t coderate,
+                                 uint32_t bandwidthAfc, uint16_t preambleLen,
+                                 uint16_t symbTimeout, bool fixLen,
+                                 uint8_t payloadLen,
+                                 bool crcOn, bool freqHopOn, uint8_t hopPeriod,
+                                 bool iqInverted, bool rxContinuous)
+{
+  Modem = modem;
+  RxConfig.Bandwidth = (modem == MODEM_LORA) ? SimRadio_LoRaBandwidth(bandwidth) : bandwidth;
+  RxConfig.Datarate = datarate;
+  RxConfig.SymbTimeout = symbTimeout;
+  RxConfig.RxContinuous = rxContinuous;
+
+  /* The SX1276 driver keeps a single set of modulation settings: the time on
+     air is the one of a received frame until the next Tx configuration */
+  TxConfig.Modem = modem;
+  if (modem == MODEM_LORA)
+  {
+    TxConfig.Bandwidth = RxConfig.Bandwidth;
+    TxConfig.Coderate = coderate;
+  }
+  TxConfig.Datarate = datarate;
+  TxConfig.PreambleLen = preambleLen;
+  TxConfig.FixLen = fixLen;
+  TxConfig.CrcOn = crcOn;
+}
+
+static void SimRadio_SetTxConfig(RadioModems_t modem, int8_t power, uint32_t fdev,
+                                 uint32_t bandwidth, uint32_t datarate,
+                                 uint8_t coderate, uint16_t preambleLen,
+                                 bool fixLen, bool crcOn, bool freqHopOn,
+                                 uint8_t hopPeriod, bool iqInverted, uint32_t timeout)
+{
+  Modem = modem;
+  TxConfig.Modem = modem;
+  if (modem == MODEM_LORA)
+  {
+    TxConfig.Bandwidth = SimRadio_LoRaBandwidth(bandwidth);
+  }
+  else
+  {
+    /* Carson bandwidth */
+    TxConfig.Bandwidth = 2 * fdev + datarate;
+  }
+  TxConfig.Datarate = datarate;
+  TxConfig.Coderate = coderate;
+  TxConfig.PreambleLen = preambleLen;
+  TxConfig.FixLen = fixLen;
+  TxConfig.CrcOn = crcOn;
+  TxConfig.Power = power;
+}
+
+static bool SimRadio_CheckRfFrequency(uint32_t frequency)
+{
+  return true;
+}
+
+static uint32_t SimRadio_TimeOnAir(RadioModems_t modem, uint8_t pktLen)
+{
+  /* Rounded up to the ms as the SX1276 driver */
+  return (uint32_t)((SimRadio_TimeOnAirUs(pktLen) + 999) / 1000);
+}
+
+static void SimRadio_Send(uint8_t *buffer, uint8_t size)
+{
+  SimAir_Tx_t tx;
+
+  tx.Frequency = Channel;
+  tx.Bandwidth = TxConfig.Bandwidth;
+  tx.SpreadingFactor = (TxConfig.Modem == MODEM_LORA) ? (uint8_t)TxConfig.Datarate : 0;
+  tx.PreambleLen = TxConfig.PreambleLen;
+  tx.Power = TxConfig.Power;
+  tx.Size = size;
+  tx.Duration = SimRadio_TimeOnAirUs(size);
+  tx.Payload = buffer;
+  SimAir_Transmit(&tx);
+
+  SimRadio_SetState(RF_TX_RUNNING);
+  EventSeq++;
+  SimNode_SetEvent(SimNode_Current(), SimNode_Now() + tx.Duration, SimRadio_OnTxDone, EventSeq);
+}
+
+static void SimRadio_Sleep(void)
+{
+  SimRadio_SetState(RF_IDLE);
+  EventSeq++;
+}
+
+static void SimRadio_Standby(void)
+{
+  SimRadio_SetState(RF_IDLE);
+  EventSeq++;
+}
+
+static void SimRadio_Rx(uint32_t timeout)
+{
+  uint64_t window = (uint64_t)timeout * 1000;
+  uint64_t now = SimNode_Now();
+  uint64_t symbol;
+  uint64_t symbols;
+  uint64_t from;
+  uint64_t start;
+  uint64_t duration;
+
+  SimRadio_SetState(RF_RX_RUNNING);
+  EventSeq++;
+
+  if (Modem == MODEM_LORA)
+  {
+    symbol = ((uint64_t)1000000 << RxConfig.Datarate) / RxConfig.Bandwidth;
+    if (RxConfig.RxContinuous == false)
+    {
+      /* Single reception, ended by the symbol timeout without preamble */
+      symbols = (uint64_t)RxConfig.SymbTimeout * symbol;
+      if ((window == 0) || (symbols < window))
+      {
+        window = symbols;
+      }
+    }
+
+    /* Downlink from the gateway starting in the window, sent at the node
+       datarate with the downlink settings: CR 4/5, 8 symbols preamble, no CRC */
+    from = (now > SIM_RADIO_LOCK_SYMBOLS * symbol) ? (now - SIM_RADIO_LOCK_SYMBOLS * symbol) : 0;
+    RxSize = SimServer_GetDownlink(SimNode_Current(), from, (window != 0) ? (now + window) : UINT64_MAX,
+                                   RxBuffer, &start);
+    if (RxSize != 0)
+    {
+      duration = SimAir_GetLoRaTimeOnAir(RxConfig.Datarate, RxConfig.Bandwidth, 1, SIM_RADIO_PREAMBLE_LEN, false,
+                                         false, RxSize);
+      if (SimServer_SendDownlink(SimNode_Current(), start, duration) == 0)
+      {
+        RxFrameStart = (start > now) ? start : now;
+        SimNode_SetEvent(SimNode_Current(), start + duration, SimRadio_OnRxDone, EventSeq);
+        return;
+      }
+    }
+
+    /* Class C downlink already on air */
+    if (SimRadio_LockClassC(now) == true)
+    {
+      return;
+    }
+  }
+  if (window != 0)
+  {
+    SimNode_SetEvent(SimNode_Current(), SimNode_Now() + window, SimRadio_OnRxTimeout, EventSeq);
+  }
+}
+
+static void SimRadio_StartCad(void)
+{
+  uint64_t symbol = ((uint64_t)1000000 << RxConfig.Datarate) / RxConfig.Bandwidth;
+
+  /* Listens on the channel and settings of the last reception */
+  SimRadio_SetState(RF_CAD);
+  EventSeq++;
+  SimNode_SetEvent(SimNode_Current(), SimNode_Now() + 2 * symbol, SimRadio_OnCadDone, EventSeq);
+}
+
+static void SimRadio_SetTxContinuousWave(uint32_t freq, int8_t power, uint16_t time)
+{
+}
+
+static int16_t SimRadio_Rssi(RadioModems_t modem)
+{
+  return SimAir_GetRssi(Channel, SIM_RADIO_RSSI_BANDWIDTH);
+}
+
+static void SimRadio_Write(uint16_t addr, uint8_t data)
+{
+}
+
+static uint8_t SimRadio_Read(uint16_t addr)
+{
+  return 0;
+}
+
+static void SimRadio_WriteBuffer(uint16_t addr, uint8_t *buffer, uint8_t size)
+{
+}
+
+static void SimRadio_ReadBuffer(uint16_t addr, uint8_t *buffer, uint8_t size)
+{
+}
+
+static void SimRadio_SetMaxPayloadLength(RadioModems_t modem, uint8_t max)
+{
+}
+
+static void SimRadio_SetPublicNetwork(bool enable)
+{
+}
+
+static uint32_t SimRadio_GetWakeupTime(void)
+{
+  return SIM_RADIO_WAKEUP_TIME;
+}
+
+#ifdef SIM_RADIO_SX126X
+static void SimRadio_SetRxDutyCycle(uint32_t rxTime, uint32_t sleepTime)
+{
+  SimRadio_SetState(RF_RX_RUNNING);
+  EventSeq++;
+
+  /* Steps of 15.625 us, each period starts listening */
+  RxDutyTime = (uint32_t)(((uint64_t)rxTime * 15625) / 1000);
+  RxDutyPeriod = (uint32_t)(((uint64_t)(rxTime + sleepTime) * 15625) / 1000);
+  SimRadio_LockClassC(SimNode_Now());
+}
+#endif
+
+/**
+ * @brief  Computes the time on air of a frame with the current Tx settings,
+ *         as the SX1276 driver
+ * @param  pktLen payload length, bytes
+ * @retval time on air, us
+ */
+static uint64_t SimRadio_TimeOnAirUs(uint8_t pktLen)
+{
+  if (TxConfig.Modem == MODEM_FSK)
+  {
+    /* Preamble, 3 bytes sync word, length, payload and CRC */
+    return (uint64_t)(8e6 * (TxConfig.PreambleLen + 3 + (TxConfig.FixLen ? 0 : 1) + pktLen +
+                             (TxConfig.CrcOn ? 2 : 0)) / TxConfig.Datarate);
+  }
+  return SimAir_GetLoRaTimeOnAir((uint8_t)TxConfig.Datarate, TxConfig.Bandwidth, TxConfig.Coderate,
+                                 TxConfig.PreambleLen, TxConfig.FixLen, TxConfig.CrcOn, pktLen);
+}
+
+/**
+ * @brief  Converts the LoRa bandwidth setting
+ * @param  bandwidth 0: 125 kHz, 1: 250 kHz, 2: 500 kHz
+ * @retval bandwidth, Hz
+ */
+static uint32_t SimRadio_LoRaBandwidth(uint32_t bandwidth)
+{
+  return 125000 << ((bandwidth <= 2) ? bandwidth : 0);
+}
+
+/**
+ * @brief  Tells whether the radio is set on the channel of a class C downlink
+ * @param  downlink class C downlink on air, NULL for none
+ * @retval true when the radio can receive it
+ */
+static bool SimRadio_IsClassCChannel(const SimServer_Downlink_t *downlink)
+{
+  return ((downlink != NULL) && (Modem == MODEM_LORA) && (downlink->Frequency == Channel) &&
+          (downlink->SpreadingFactor == RxConfig.Datarate) && (downlink->Bandwidth == RxConfig.Bandwidth)) ? true : false;
+}
+
+/**
+ * @brief  Locks the reception on the class C downlink on air, when the radio
+ *         is on its channel, not receiving another frame, and finds enough
+ *         preamble symbols left
+ * @param  detect time the radio starts looking for the preamble, us
+ * @retval true when locked
+ */
+static bool SimRadio_LockClassC(uint64_t detect)
+{
+  const SimServer_Downlink_t *downlink = SimServer_GetClassCDownlink();
+  uint64_t symbol;
+
+  if ((RxFrameStart != 0) || (SimRadio_IsClassCChannel(downlink) == false))
+  {
+    return false;
+  }
+  /* As many symbols left as on a usual preamble locked on at the latest */
+  symbol = ((uint64_t)1000000 << downlink->SpreadingFactor) / downlink->Bandwidth;
+  if (detect > downlink->Start + (downlink->PreambleLen + SIM_RADIO_LOCK_SYMBOLS - SIM_RADIO_PREAMBLE_LEN) * symbol)
+  {
+    return false;
+  }
+
+  memcpy(RxBuffer, downlink->Payload, downlink->Size);
+  RxSize = downlink->Size;
+  RxFrameStart = detect;
+  EventSeq++;
+  SimNode_SetEvent(SimNode_Current(), downlink->Start + downlink->Duration, SimRadio_OnRxDone, EventSeq);
+  return true;
+}
+
+/**
+ * @brief  Gets the time the radio listened since the start of the reception
+ *         or of the CAD: all of it, or the listening slots of the RX duty
+ *         cycle
+ * @param  end us
+ * @retval us
+ */
+static uint64_t SimRadio_ListenTime(uint64_t end)
+{
+  uint64_t elapsed = end - RxStart;
+
+  if (RxDutyPeriod == 0)
+  {
+    return elapsed;
+  }
+  return (elapsed / RxDutyPeriod) * RxDutyTime +
+         (((elapsed % RxDutyPeriod) < RxDutyTime) ? (elapsed % RxDutyPeriod) : RxDutyTime);
+}
+
+/**
+ * @brief  Changes the radio state, accounting the time it was receiving,
+ *         CAD included
+ * @param  state new state
+ * @retval None
+ */
+static void SimRadio_SetState(RadioState_t state)
+{
+  uint64_t now = SimNode_Now();
+
+  if ((State == RF_RX_RUNNING) || (State == RF_CAD))
+  {
+    if ((RxFrameStart != 0) && (RxFrameStart <= now))
+    {
+      SimAir_CountRxTime(SimRadio_ListenTime(RxFrameStart), now - RxFrameStart);
+    }
+    else
+    {
+      SimAir_CountRxTime(SimRadio_ListenTime(now), 0);
+    }
+    RxFrameStart = 0;
+  }
+  RxDutyPeriod = 0;
+  if ((state == RF_RX_RUNNING) || (state == RF_CAD))
+  {
+    RxStart = now;
+  }
+  State = state;
+}
+
+/**
+ * @brief  End of transmission event
+ * @param  seq operation sequence number
+ * @retval None
+ */
+static void SimRadio_OnTxDone(uint32_t seq)
+{
+  if (seq != EventSeq)
+  {
+    return;
+  }
+  SimRadio_SetState(RF_IDLE);
+  if ((RadioEvents != NULL) && (RadioEvents->TxDone != NULL))
+  {
+    RadioEvents->TxDone();
+  }
+}
+
+/**
+ * @brief  End of reception window event
+ * @param  seq operation sequence number
+ * @retval None
+ */
+static void SimRadio_OnRxTimeout(uint32_t seq)
+{
+  if (seq != EventSeq)
+  {
+    return;
+  }
+  SimRadio_SetState(RF_IDLE);
+  if ((RadioEvents != NULL) && (RadioEvents->RxTimeout != NULL))
+  {
+    RadioEvents->RxTimeout();
+  }
+}
+
+/**
+ * @brief  End of reception of a downlink event
+ * @param  seq operation sequence number
+ * @retval None
+ */
+static void SimRadio_OnRxDone(uint32_t seq)
+{
+  double power;
+  double snr;
+
+  if (seq != EventSeq)
+  {
+    return;
+  }
+  SimRadio_SetState(RF_IDLE);
+  power = SIM_RADIO_GATEWAY_POWER - SimAir_GetGatewayLoss(SimNode_Current());
+  snr = power - SimAir_GetNoise(RxConfig.Bandwidth);
+  snr = (snr > INT8_MAX) ? INT8_MAX : (snr < INT8_MIN) ? INT8_MIN : snr;
+  if ((RadioEvents != NULL) && (RadioEvents->RxDone != NULL))
+  {
+    RadioEvents->RxDone(RxBuffer, RxSize, (int16_t)power, (int8_t)snr);
+  }
+}
+
+/**
+ * @brief  End of channel activity detection event
+ * @param  seq operation sequence number
+ * @retval None
+ */
+static void SimRadio_OnCadDone(uint32_t seq)
+{
+  const SimServer_Downlink_t *downlink = SimServer_GetClassCDownlink();
+  uint64_t symbol = ((uint64_t)1000000 << RxConfig.Datarate) / RxConfig.Bandwidth;
+  bool busy;
+
+  if (seq != EventSeq)
+  {
+    return;
+  }
+  SimRadio_SetState(RF_IDLE);
+  /* Another node transmitting above the noise floor, the RSSI does not go
+     below it */
+  busy = (SimAir_GetRssi(Channel, RxConfig.Bandwidth) > SimAir_GetNoise(RxConfig.Bandwidth)) ? true : false;
+  /* Class C preamble over the whole CAD */
+  if ((SimRadio_IsClassCChannel(downlink) == true) && (downlink->Start + 2 * symbol <= SimNode_Now()) &&
+      (downlink->Start + downlink->PreambleLen * symbol >= SimNode_Now()))
+  {
+    busy = true;
+  }
+  if ((RadioEvents != NULL) && (RadioEvents->CadDone != NULL))
+  {
+    RadioEvents->CadDone(busy);
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,187 @@
+/**
+  ******************************************************************************
+  * @file    sim_rtc.c
+  * @author  MCD Application Team
+  * @brief   Simulated RTC of a node, running on the simulation clock with a
+  *          1 ms tick and the frequency error of the node crystal. Its alarm
+  *          is an event of the simulator queue.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hw.h"
+#include "timeServer.h"
+#include "sim_node.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Same minimum alarm delay as the MCU RTC, in ticks */
+#define MIN_ALARM_DELAY               3
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* The node variables are part of its image, see sim_node.c */
+static uint32_t RtcTimerContext = 0;
+
+static uint32_t RtcAlarmSeq = 0;     /* changed each time the alarm is set or stopped */
+
+static uint32_t RtcBackup[2] = { 0, 0 };
+
+static int32_t RtcDrift = 0;         /* ppm */
+
+/* Private function prototypes -----------------------------------------------*/
+static uint64_t HW_RTC_GetLocalTime(void);
+static void HW_RTC_OnAlarm(uint32_t seq);
+
+/* Exported functions ---------------------------------------------------------*/
+void HW_RTC_Init(void)
+{
+  HW_RTC_SetTimerContext();
+}
+
+void HW_RTC_setMcuWakeUpTime(void)
+{
+}
+
+int16_t HW_RTC_getMcuWakeUpTime(void)
+{
+  return 0;
+}
+
+uint32_t HW_RTC_GetMinimumTimeout(void)
+{
+  return MIN_ALARM_DELAY;
+}
+
+uint32_t HW_RTC_ms2Tick(TimerTime_t timeMilliSec)
+{
+  return timeMilliSec;
+}
+
+TimerTime_t HW_RTC_Tick2ms(uint32_t tick)
+{
+  return tick;
+}
+
+void HW_RTC_SetAlarm(uint32_t timeout)
+{
+  /* The alarm is relative to the timer context, intentional wrap around */
+  int32_t delay = (int32_t)(RtcTimerContext + timeout - HW_RTC_GetTimerValue());
+  uint64_t alarm = (HW_RTC_GetLocalTime() / 1000 + ((delay > 0) ? delay : 0)) * 1000;
+
+  /* Simulation time when the RTC reaches the alarm tick, rounded up */
+  if (RtcDrift != 0)
+  {
+    alarm = (alarm * 1000000 + 1000000 + RtcDrift - 1) / (1000000 + RtcDrift);
+  }
+  RtcAlarmSeq++;
+  SimNode_SetEvent(SimNode_Current(), alarm, HW_RTC_OnAlarm, RtcAlarmSeq);
+}
+
+uint32_t HW_RTC_GetTimerElapsedTime(void)
+{
+  return HW_RTC_GetTimerValue() - RtcTimerContext;
+}
+
+uint32_t HW_RTC_GetTimerValue(void)
+{
+  return (uint32_t)(HW_RTC_GetLocalTime() / 1000);
+}
+
+uint64_t HW_RTC_GetTimeBase(void)
+{
+  return HW_RTC_GetLocalTime() / 1000;
+}
+
+void HW_RTC_StopAlarm(void)
+{
+  /* The pending alarm event is dropped when it occurs */
+  RtcAlarmSeq++;
+}
+
+void HW_RTC_IrqHandler(void)
+{
+  TimerIrqHandler();
+}
+
+uint32_t HW_RTC_SetTimerContext(void)
+{
+  RtcTimerContext = HW_RTC_GetTimerValue();
+  return RtcTimerContext;
+}
+
+uint32_t HW_RTC_GetTimerContext(void)
+{
+  return RtcTimerContext;
+}
+
+uint32_t HW_RTC_GetCalendarTime(uint16_t *mSeconds)
+{
+  uint64_t now = HW_RTC_GetLocalTime() / 1000;
+
+  *mSeconds = (uint16_t)(now % 1000);
+  return (uint32_t)(now / 1000);
+}
+
+void HW_RTC_BKUPWrite(uint32_t Data0, uint32_t Data1)
+{
+  RtcBackup[0] = Data0;
+  RtcBackup[1] = Data1;
+}
+
+void HW_RTC_BKUPRead(uint32_t *Data0, uint32_t *Data1)
+{
+  *Data0 = RtcBackup[0];
+  *Data1 = RtcBackup[1];
+}
+
+TimerTime_t RtcTempCompensation(TimerTime_t period, float temperature)
+{
+  return period;
+}
+
+void HW_RTC_SetDrift(int32_t ppm)
+{
+  RtcDrift = ppm;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Gets the time of the RTC of the node, which started with the
+ *         simulation
+ * @param  None
+ * @retval us
+ */
+static uint64_t HW_RTC_GetLocalTime(void)
+{
+  uint64_t now = SimNode_Now();
+
+  return now + (int64_t)now * RtcDrift / 1000000;
+}
+
+/**
+ * @brief  Alarm event of the node
+ * @param  seq alarm sequence number when the event was scheduled
+ * @retval None
+ */
+static void HW_RTC_OnAlarm(uint32_t seq)
+{
+  if (seq == RtcAlarmSeq)
+  {
+    RtcAlarmSeq++;
+    HW_RTC_IrqHandler();
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
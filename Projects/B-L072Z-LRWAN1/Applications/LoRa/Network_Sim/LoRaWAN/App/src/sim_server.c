@@ -0,0 +1,585 @@
+/**
+  ******************************************************************************
+  * @file    sim_server.c
+  * @author  MCD Application Team
+  * @brief   Simulated network and join server.
+  *          - Each join request demodulated by the gateway is answered with a
+  *            LoRaWAN 1.0.x join accept, in RX1 or else in RX2
+  *          - The gateway transmits one downlink at a time and is deaf while
+  *            transmitting; the downlinks are not lost on air, the gateway
+  *            duty cycle is not limited
+  *          - Optionally, each node gets class C downlinks at random times,
+  *            with a wake-up preamble for the nodes sniffing the channel
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "aes.h"
+#include "cmac.h"
+#include "sim_air.h"
+#include "sim_node.h"
+#include "sim_radio.h"
+#include "sim_server.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint64_t Rx1;                    /* start of the downlink in RX1, us, 0 when
+                                      none is pending */
+  uint64_t Rx2;
+  uint64_t JoinTime;
+  uint32_t FCntDown;               /* frame counter of the next data downlink */
+  uint8_t JoinAccept;              /* 1 when the pending downlink is a join
+                                      accept */
+  uint8_t Size;
+  uint8_t Payload[32];             /* join accept or data down */
+} SimServer_Node_t;
+
+/* Private define ------------------------------------------------------------*/
+#define SIM_SERVER_JOIN_REQUEST_SIZE                23
+#define SIM_SERVER_JOIN_ACCEPT_SIZE                 17
+
+/* JOIN_ACCEPT_DELAY1 and 2 of the regions, us */
+#define SIM_SERVER_JOIN_RX1_DELAY                   5000000
+#define SIM_SERVER_JOIN_RX2_DELAY                   6000000
+
+/* RX2 datarate of the join accept DLSettings, the default one of the region */
+#if defined( REGION_US915 ) || defined( REGION_AU915 )
+#define SIM_SERVER_RX2_DATARATE                     8
+#elif defined( REGION_AS923 )
+#define SIM_SERVER_RX2_DATARATE                     2
+#else
+#define SIM_SERVER_RX2_DATARATE                     0
+#endif
+
+/* Default RX2 channel of the region, the class C channel of the ABP nodes */
+#if defined( REGION_US915 ) || defined( REGION_AU915 )
+#define SIM_SERVER_RXC_FREQUENCY                    923300000
+#define SIM_SERVER_RXC_SF                           12
+#define SIM_SERVER_RXC_BANDWIDTH                    500000
+#elif defined( REGION_AS923 ) || defined( REGION_IN865 )
+#if defined( REGION_AS923 )
+#define SIM_SERVER_RXC_FREQUENCY                    923200000
+#else
+#define SIM_SERVER_RXC_FREQUENCY                    866550000
+#endif
+#define SIM_SERVER_RXC_SF                           10
+#define SIM_SERVER_RXC_BANDWIDTH                    125000
+#else
+#if defined( REGION_CN470 )
+#define SIM_SERVER_RXC_FREQUENCY                    505300000
+#elif defined( REGION_CN779 )
+#define SIM_SERVER_RXC_FREQUENCY                    786000000
+#elif defined( REGION_EU433 )
+#define SIM_SERVER_RXC_FREQUENCY                    434665000
+#elif defined( REGION_KR920 )
+#define SIM_SERVER_RXC_FREQUENCY                    921900000
+#elif defined( REGION_RU864 )
+#define SIM_SERVER_RXC_FREQUENCY                    869100000
+#else
+#define SIM_SERVER_RXC_FREQUENCY                    869525000
+#endif
+#define SIM_SERVER_RXC_SF                           12
+#define SIM_SERVER_RXC_BANDWIDTH                    125000
+#endif
+
+/* Preamble of the downlinks without wake-up preamble, symbols */
+#define SIM_SERVER_PREAMBLE_LEN                     8
+
+/* RxDelay of the join accept, s */
+#define SIM_SERVER_RX_DELAY                         1
+
+/* RECEIVE_DELAY1 and 2 of the regions, us */
+#define SIM_SERVER_RX1_DELAY                        1000000
+#define SIM_SERVER_RX2_DELAY                        2000000
+
+/* MHDR | DevAddr | FCtrl | FCnt | FOpts | MIC */
+#define SIM_SERVER_MIN_DATA_SIZE                    12
+#define SIM_SERVER_MAX_FOPTS_SIZE                   15
+
+/* Network server MAC commands */
+#define SIM_SERVER_DUTY_CYCLE_REQ                   0x04
+#define SIM_SERVER_RX_TIMING_SETUP_REQ              0x08
+#define SIM_SERVER_MAX_CID                          0x13
+
+/* Private variables ---------------------------------------------------------*/
+static SimServer_Node_t *Nodes = NULL;
+
+static uint32_t NbNodes = 0;
+
+static uint32_t JoinNonce = 0;
+
+/* Last downlink scheduled on the gateway transmitter, us */
+static uint64_t GatewayTxStart = 0;
+
+static uint64_t GatewayTxEnd = 0;
+
+static SimServer_Stats_t Stats;
+
+static const uint8_t NwkKey[16] = SIM_SERVER_NWK_KEY;
+
+static uint8_t DownlinkMode = SIM_SERVER_DOWNLINK_NONE;
+
+/* Mean time between the class C downlinks of a node, ms, 0 for none */
+static uint32_t ClassCPeriod = 0;
+
+static uint16_t ClassCPreambleLen = SIM_SERVER_PREAMBLE_LEN;
+
+/* Last class C downlink of the gateway */
+static SimServer_Downlink_t ClassC;
+
+/* Payload size of the network server MAC commands, indexed by CID, 0 for the
+   unknown ones */
+static const uint8_t FuzzCmdSizes[SIM_SERVER_MAX_CID + 1] =
+{
+  0, 0, 2, 4, 1, 4, 0, 5, 1, 1, 4, 0, 0, 5, 0, 0, 0, 4, 3, 3
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void SimServer_BuildJoinAccept(uint32_t node, uint8_t *payload);
+static uint8_t SimServer_BuildFuzzOpts(uint8_t *fOpts);
+static uint8_t SimServer_BuildDataDown(uint32_t node, uint32_t devAddr, const uint8_t *fOpts, uint8_t fOptsLen,
+                                       uint8_t *payload);
+static void SimServer_ScheduleClassC(uint32_t node);
+static void SimServer_OnClassCTimer(uint32_t node);
+
+/* Exported functions ------------------------------------------------------- */
+int32_t SimServer_Init(uint32_t nbNodes)
+{
+  uint32_t i;
+
+  Nodes = calloc(nbNodes, sizeof(SimServer_Node_t));
+  if (Nodes == NULL)
+  {
+    return -1;
+  }
+  for (i = 0; i < nbNodes; i++)
+  {
+    Nodes[i].JoinTime = SIM_SERVER_NOT_JOINED;
+  }
+  NbNodes = nbNodes;
+  JoinNonce = 0;
+  GatewayTxStart = 0;
+  GatewayTxEnd = 0;
+  memset(&ClassC, 0, sizeof(ClassC));
+  memset(&Stats, 0, sizeof(Stats));
+  return 0;
+}
+
+void SimServer_DeInit(void)
+{
+  free(Nodes);
+  Nodes = NULL;
+  NbNodes = 0;
+}
+
+void SimServer_SetDownlinks(uint8_t mode)
+{
+  DownlinkMode = mode;
+}
+
+void SimServer_SetClassC(uint32_t period, uint32_t preambleTime)
+{
+  double symbol = 1e3 * (double)(1 << SIM_SERVER_RXC_SF) / SIM_SERVER_RXC_BANDWIDTH;
+
+  ClassCPeriod = period;
+  ClassCPreambleLen = SIM_SERVER_PREAMBLE_LEN;
+  if (ceil(preambleTime / symbol) > SIM_SERVER_PREAMBLE_LEN)
+  {
+    ClassCPreambleLen = (uint16_t)ceil(preambleTime / symbol);
+  }
+}
+
+uint16_t SimServer_GetClassCPreambleLen(void)
+{
+  return ClassCPreambleLen;
+}
+
+void SimServer_StartClassC(void)
+{
+  uint32_t i;
+
+  if (ClassCPeriod == 0)
+  {
+    return;
+  }
+  for (i = 0; i < NbNodes; i++)
+  {
+    SimServer_ScheduleClassC(i);
+  }
+}
+
+void SimServer_OnUplink(uint32_t node, const uint8_t *payload, uint8_t size, uint64_t end)
+{
+  SimServer_Node_t *n;
+  uint8_t fOpts[SIM_SERVER_MAX_FOPTS_SIZE];
+  uint8_t fOptsLen = 0;
+  uint8_t mType = payload[0] >> 5;
+
+  if (node >= NbNodes)
+  {
+    return;
+  }
+  n = &Nodes[node];
+
+  /* Join request: MHDR 0x00 | JoinEUI | DevEUI | DevNonce | MIC, the MIC and
+     the DevNonce replays are not checked */
+  if ((size == SIM_SERVER_JOIN_REQUEST_SIZE) && (mType == 0))
+  {
+    SimServer_BuildJoinAccept(node, n->Payload);
+    n->Size = SIM_SERVER_JOIN_ACCEPT_SIZE;
+    n->JoinAccept = 1;
+    n->Rx1 = end + SIM_SERVER_JOIN_RX1_DELAY;
+    n->Rx2 = end + SIM_SERVER_JOIN_RX2_DELAY;
+  }
+  /* Unconfirmed or confirmed data up */
+  else if ((DownlinkMode != SIM_SERVER_DOWNLINK_NONE) && (size >= SIM_SERVER_MIN_DATA_SIZE) &&
+           ((mType == 2) || (mType == 4)))
+  {
+    if (DownlinkMode == SIM_SERVER_DOWNLINK_FUZZ)
+    {
+      fOptsLen = SimServer_BuildFuzzOpts(fOpts);
+    }
+    n->Size = SimServer_BuildDataDown(node, payload[1] | (payload[2] << 8) | (payload[3] << 16) |
+                                      ((uint32_t)payload[4] << 24), fOpts, fOptsLen, n->Payload);
+    n->JoinAccept = 0;
+    Stats.DataAnswers++;
+    n->Rx1 = end + SIM_SERVER_RX1_DELAY;
+    n->Rx2 = end + SIM_SERVER_RX2_DELAY;
+  }
+}
+
+uint8_t SimServer_GetDownlink(uint32_t node, uint64_t from, uint64_t to, uint8_t *payload, uint64_t *start)
+{
+  SimServer_Node_t *n;
+
+  if ((node >= NbNodes) || (Nodes[node].Rx1 == 0))
+  {
+    return 0;
+  }
+
+  n = &Nodes[node];
+  if (n->Rx2 < from)
+  {
+    /* Both windows missed */
+    n->Rx1 = 0;
+    return 0;
+  }
+  if ((n->Rx1 >= from) && (n->Rx1 <= to))
+  {
+    *start = n->Rx1;
+  }
+  else if ((n->Rx2 >= from) && (n->Rx2 <= to))
+  {
+    *start = n->Rx2;
+  }
+  else
+  {
+    return 0;
+  }
+  memcpy(payload, n->Payload, n->Size);
+  return n->Size;
+}
+
+int32_t SimServer_SendDownlink(uint32_t node, uint64_t start, uint64_t duration)
+{
+  SimServer_Node_t *n = &Nodes[node];
+
+  if ((start < GatewayTxEnd) && (start + duration > GatewayTxStart))
+  {
+    /* Tried again in RX2 when this was RX1 */
+    if (start != n->Rx2)
+    {
+      n->Rx1 = n->Rx2;
+    }
+    else
+    {
+      n->Rx1 = 0;
+      Stats.DownlinksDropped++;
+    }
+    return -1;
+  }
+
+  GatewayTxStart = start;
+  GatewayTxEnd = start + duration;
+  SimAir_SetGatewayOff(start, start + duration);
+  n->Rx1 = 0;
+  if (n->JoinAccept != 0)
+  {
+    Stats.JoinAccepts++;
+  }
+  else
+  {
+    Stats.DataDownlinks++;
+  }
+  return 0;
+}
+
+const SimServer_Downlink_t *SimServer_GetClassCDownlink(void)
+{
+  uint64_t now = SimNode_Now();
+
+  if ((ClassC.Size == 0) || (now < ClassC.Start) || (now >= ClassC.Start + ClassC.Duration))
+  {
+    return NULL;
+  }
+  return &ClassC;
+}
+
+void SimServer_OnDownlinkProcessed(uint32_t time)
+{
+  Stats.FuzzProcessed++;
+  Stats.FuzzTime += time;
+  if (time > Stats.FuzzTimeMax)
+  {
+    Stats.FuzzTimeMax = time;
+  }
+}
+
+void SimServer_OnDownlinkReceived(void)
+{
+  Stats.DataReceived++;
+}
+
+void SimServer_OnJoined(void)
+{
+  uint32_t node = SimNode_Current();
+
+  if ((node < NbNodes) && (Nodes[node].JoinTime == SIM_SERVER_NOT_JOINED))
+  {
+    Nodes[node].JoinTime = SimNode_Now();
+    Stats.Joined++;
+  }
+}
+
+uint64_t SimServer_GetJoinTime(uint32_t node)
+{
+  return (node < NbNodes) ? Nodes[node].JoinTime : SIM_SERVER_NOT_JOINED;
+}
+
+const SimServer_Stats_t *SimServer_GetStats(void)
+{
+  return &Stats;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Builds the join accept of a node: MHDR | JoinNonce | NetID |
+ *         DevAddr | DLSettings | RxDelay | MIC, encrypted as the join server
+ *         does, with an AES decryption the node reverts with an encryption
+ * @param  node node index
+ * @param  payload join accept, SIM_SERVER_JOIN_ACCEPT_SIZE bytes
+ * @retval None
+ */
+static void SimServer_BuildJoinAccept(uint32_t node, uint8_t *payload)
+{
+  uint8_t plain[SIM_SERVER_JOIN_ACCEPT_SIZE];
+  uint8_t mic[AES_CMAC_DIGEST_LENGTH];
+  uint32_t devAddr = SIM_SERVER_DEV_ADDR_BASE + node;
+  AES_CMAC_CTX cmacCtx;
+  aes_context aesCtx;
+
+  JoinNonce++;
+  plain[0] = 0x20;
+  plain[1] = JoinNonce & 0xFF;
+  plain[2] = (JoinNonce >> 8) & 0xFF;
+  plain[3] = (JoinNonce >> 16) & 0xFF;
+  plain[4] = 0;                    /* NetID */
+  plain[5] = 0;
+  plain[6] = 0;
+  plain[7] = devAddr & 0xFF;
+  plain[8] = (devAddr >> 8) & 0xFF;
+  plain[9] = (devAddr >> 16) & 0xFF;
+  plain[10] = (devAddr >> 24) & 0xFF;
+  plain[11] = SIM_SERVER_RX2_DATARATE;
+  plain[12] = SIM_SERVER_RX_DELAY;
+
+  AES_CMAC_Init(&cmacCtx);
+  AES_CMAC_SetKey(&cmacCtx, NwkKey);
+  AES_CMAC_Update(&cmacCtx, plain, SIM_SERVER_JOIN_ACCEPT_SIZE - 4);
+  AES_CMAC_Final(mic, &cmacCtx);
+  memcpy(&plain[13], mic, 4);
+
+  memset(&aesCtx, 0, sizeof(aesCtx));
+  aes_set_key(NwkKey, 16, &aesCtx);
+  payload[0] = plain[0];
+  aes_decrypt(&plain[1], &payload[1], &aesCtx);
+}
+
+/**
+ * @brief  Draws random FOpts: well formed commands with random payloads, the
+ *         last one possibly truncated, and once in a while random bytes. The
+ *         DutyCycleReq and RxTimingSetupReq keep the node sending and
+ *         receiving in RX1.
+ * @param  fOpts SIM_SERVER_MAX_FOPTS_SIZE bytes buffer
+ * @retval FOpts length
+ */
+static uint8_t SimServer_BuildFuzzOpts(uint8_t *fOpts)
+{
+  uint8_t fOptsLen = SimAir_Random() % (SIM_SERVER_MAX_FOPTS_SIZE + 1);
+  uint8_t size = 0;
+  uint8_t cid;
+  uint8_t i;
+
+  if ((SimAir_Random() % 8) == 0)
+  {
+    for (i = 0; i < SIM_SERVER_MAX_FOPTS_SIZE; i++)
+    {
+      fOpts[i] = (uint8_t)SimAir_Random();
+    }
+  }
+  else
+  {
+    while (size < SIM_SERVER_MAX_FOPTS_SIZE)
+    {
+      cid = SimAir_Random() % (SIM_SERVER_MAX_CID + 1);
+      fOpts[size++] = cid;
+      for (i = 0; (i < FuzzCmdSizes[cid]) && (size < SIM_SERVER_MAX_FOPTS_SIZE); i++)
+      {
+        fOpts[size] = (uint8_t)SimAir_Random();
+        if (i == 0)
+        {
+          if (cid == SIM_SERVER_DUTY_CYCLE_REQ)
+          {
+            /* No aggregated duty cycle */
+            fOpts[size] &= 0xF0;
+          }
+          else if (cid == SIM_SERVER_RX_TIMING_SETUP_REQ)
+          {
+            /* RX1 delay of 1 s */
+            fOpts[size] = (fOpts[size] & 0xF0) | 0x01;
+          }
+        }
+        size++;
+      }
+    }
+  }
+  return fOptsLen;
+}
+
+/**
+ * @brief  Builds an unconfirmed data down for a node
+ * @param  node node index
+ * @param  devAddr device address of the node
+ * @param  fOpts MAC commands
+ * @param  fOptsLen MAC commands length, up to SIM_SERVER_MAX_FOPTS_SIZE
+ * @param  payload downlink, 32 bytes buffer
+ * @retval downlink size
+ */
+static uint8_t SimServer_BuildDataDown(uint32_t node, uint32_t devAddr, const uint8_t *fOpts, uint8_t fOptsLen,
+                                       uint8_t *payload)
+{
+  uint8_t b0[16];
+  uint8_t mic[AES_CMAC_DIGEST_LENGTH];
+  uint32_t fCnt = Nodes[node].FCntDown++;
+  AES_CMAC_CTX cmacCtx;
+  uint8_t size = 0;
+
+  /* MHDR: unconfirmed data down, no FPort */
+  payload[size++] = 0x60;
+  payload[size++] = devAddr & 0xFF;
+  payload[size++] = (devAddr >> 8) & 0xFF;
+  payload[size++] = (devAddr >> 16) & 0xFF;
+  payload[size++] = (devAddr >> 24) & 0xFF;
+  payload[size++] = fOptsLen;
+  payload[size++] = fCnt & 0xFF;
+  payload[size++] = (fCnt >> 8) & 0xFF;
+  memcpy(&payload[size], fOpts, fOptsLen);
+  size += fOptsLen;
+
+  /* LoRaWAN 1.0 downlink MIC, the session keys of the ABP nodes equal the
+     root key */
+  memset(b0, 0, sizeof(b0));
+  b0[0] = 0x49;
+  b0[5] = 0x01;
+  memcpy(&b0[6], &payload[1], 4);
+  b0[10] = fCnt & 0xFF;
+  b0[11] = (fCnt >> 8) & 0xFF;
+  b0[12] = (fCnt >> 16) & 0xFF;
+  b0[13] = (fCnt >> 24) & 0xFF;
+  b0[15] = size;
+  AES_CMAC_Init(&cmacCtx);
+  AES_CMAC_SetKey(&cmacCtx, NwkKey);
+  AES_CMAC_Update(&cmacCtx, b0, sizeof(b0));
+  AES_CMAC_Update(&cmacCtx, payload, size);
+  AES_CMAC_Final(mic, &cmacCtx);
+  memcpy(&payload[size], mic, 4);
+  return size + 4;
+}
+
+/**
+ * @brief  Schedules the next class C downlink of a node, Poisson arrivals
+ * @param  node node index
+ * @retval None
+ */
+static void SimServer_ScheduleClassC(uint32_t node)
+{
+  double u = (SimAir_Random() | 1) / 4294967296.0;
+
+  SimNode_SetEvent(SIM_NODE_NONE, SimNode_Now() + (uint64_t)(-log(u) * ClassCPeriod * 1000), SimServer_OnClassCTimer,
+                   node);
+}
+
+/**
+ * @brief  Sends an empty class C downlink to a node on its class C channel,
+ *         unless the gateway is already transmitting, and tells all the
+ *         nodes a preamble starts: the ones listening on the channel
+ *         receive it, the addressed one accepts it
+ * @param  node node index
+ * @retval None
+ */
+static void SimServer_OnClassCTimer(uint32_t node)
+{
+  uint64_t now = SimNode_Now();
+  uint64_t duration;
+  uint8_t payload[sizeof(ClassC.Payload)];
+  uint8_t fOpts[1];
+  uint8_t size;
+  uint32_t i;
+
+  SimServer_ScheduleClassC(node);
+
+  size = SimServer_BuildDataDown(node, SIM_SERVER_DEV_ADDR_BASE + node, fOpts, 0, payload);
+  duration = SimAir_GetLoRaTimeOnAir(SIM_SERVER_RXC_SF, SIM_SERVER_RXC_BANDWIDTH, 1, ClassCPreambleLen, false, false,
+                                     size);
+  if ((now < GatewayTxEnd) && (now + duration > GatewayTxStart))
+  {
+    Stats.DownlinksDropped++;
+    return;
+  }
+
+  GatewayTxStart = now;
+  GatewayTxEnd = now + duration;
+  SimAir_SetGatewayOff(now, now + duration);
+  Stats.DataDownlinks++;
+
+  ClassC.Start = now;
+  ClassC.Duration = duration;
+  ClassC.Frequency = SIM_SERVER_RXC_FREQUENCY;
+  ClassC.Bandwidth = SIM_SERVER_RXC_BANDWIDTH;
+  ClassC.SpreadingFactor = SIM_SERVER_RXC_SF;
+  ClassC.PreambleLen = ClassCPreambleLen;
+  ClassC.Size = size;
+  memcpy(ClassC.Payload, payload, size);
+
+  for (i = 0; i < NbNodes; i++)
+  {
+    SimNode_SetEvent(i, now, SimRadio_OnDownlink, 0);
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
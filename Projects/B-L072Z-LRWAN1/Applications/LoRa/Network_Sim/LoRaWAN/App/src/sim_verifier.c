@@ -0,0 +1,567 @@
+/**
+  ******************************************************************************
+  * @file    sim_verifier.c
+  * @author  MCD Application Team
+  * @brief   Network server side verification of the data uplinks of many
+  *          devices.
+  *          - The frames are parsed by LoRaMacParserData and the B0 and B1
+  *            blocks built by LoRaMacCrypto, as on the devices; the keys are
+  *            the ones of each device, expanded once by mbedTLS (AES-NI when
+  *            the host has it) and read concurrently by the workers
+  *          - The frames of a batch are assigned to the workers by a hash of
+  *            their address, so the frame counter of a device is only
+  *            changed by one worker, in the order of the batch, without lock
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include "LoRaMacCrypto.h"
+#include "LoRaMacParser.h"
+#include "mbedtls/aesni.h"
+#include "sim_verifier.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* MHDR | DevAddr | FCtrl | FCnt | MIC */
+#define SIM_VERIFIER_MIN_DATA_SIZE                  12
+
+#define SIM_VERIFIER_MIC_SIZE                       4
+
+#define SIM_VERIFIER_UPLINK                         0
+
+/* MType of the data uplinks */
+#define SIM_VERIFIER_UNCONFIRMED_UP                 0x02
+#define SIM_VERIFIER_CONFIRMED_UP                   0x04
+
+/* LoRaWAN 1.1.0, the FOpts encryption block changed after it */
+#define SIM_VERIFIER_LRWAN_1_1_0                    0x01010000
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static int32_t SimVerifier_SetKey(SimVerifier_Key_t *key, const uint8_t *value);
+
+static void SimVerifier_CmacDouble(const uint8_t *in, uint8_t *out);
+
+static int32_t SimVerifier_Cmac(const SimVerifier_Key_t *key, const uint8_t *bx, const uint8_t *buffer,
+                                uint16_t size, uint32_t *cmac);
+
+static int32_t SimVerifier_Ctr(const SimVerifier_Key_t *key, uint8_t *aBlock, uint8_t *buffer, uint16_t size);
+
+static uint32_t SimVerifier_Shard(const SimVerifier_Frame_t *frame, uint32_t workersNb);
+
+static void SimVerifier_Verify(SimVerifier_t *verifier, SimVerifier_Frame_t *frame);
+
+static void *SimVerifier_Worker(void *arg);
+
+static int SimVerifier_CompareDevices(const void *a, const void *b);
+
+/* Exported functions ---------------------------------------------------------*/
+int32_t SimVerifier_SetDevice(SimVerifier_Device_t *device, uint32_t devAddr, Version_t version,
+                              const uint8_t *fNwkSIntKey, const uint8_t *sNwkSIntKey,
+                              const uint8_t *nwkSEncKey, const uint8_t *appSKey)
+{
+  memset(device, 0, sizeof(SimVerifier_Device_t));
+  device->DevAddr = devAddr;
+  device->LrWanVersion = version;
+  device->ConfFCntDown = UINT32_MAX;
+
+  if ((SimVerifier_SetKey(&device->FNwkSIntKey, fNwkSIntKey) != 0) ||
+      (SimVerifier_SetKey(&device->SNwkSIntKey, sNwkSIntKey) != 0) ||
+      (SimVerifier_SetKey(&device->NwkSEncKey, nwkSEncKey) != 0) ||
+      (SimVerifier_SetKey(&device->AppSKey, appSKey) != 0))
+  {
+    SimVerifier_FreeDevice(device);
+    return -1;
+  }
+  return 0;
+}
+
+void SimVerifier_FreeDevice(SimVerifier_Device_t *device)
+{
+  mbedtls_aes_free(&device->FNwkSIntKey.Aes);
+  mbedtls_aes_free(&device->SNwkSIntKey.Aes);
+  mbedtls_aes_free(&device->NwkSEncKey.Aes);
+  mbedtls_aes_free(&device->AppSKey.Aes);
+}
+
+SimVerifier_Status_t SimVerifier_Unsecure(SimVerifier_Device_t *device, SimVerifier_Frame_t *frame)
+{
+  LoRaMacMessageData_t macMsg;
+  uint8_t mType;
+  uint8_t fOptsLen;
+  uint16_t len;
+  uint32_t fCnt;
+  uint32_t mic;
+  uint8_t block[16];
+
+  if (frame->BufSize < SIM_VERIFIER_MIN_DATA_SIZE)
+  {
+    return SIM_VERIFIER_FAIL_FORMAT;
+  }
+  mType = frame->Buffer[0] >> 5;
+  fOptsLen = frame->Buffer[5] & 0x0F;
+  if (((mType != SIM_VERIFIER_UNCONFIRMED_UP) && (mType != SIM_VERIFIER_CONFIRMED_UP)) ||
+      (frame->BufSize < SIM_VERIFIER_MIN_DATA_SIZE + fOptsLen))
+  {
+    return SIM_VERIFIER_FAIL_FORMAT;
+  }
+
+  /* The parser copies the FRMPayload, still encrypted, to the frame */
+  memset(&macMsg, 0, sizeof(macMsg));
+  macMsg.Buffer = frame->Buffer;
+  macMsg.BufSize = frame->BufSize;
+  macMsg.FRMPayload = frame->FRMPayload;
+  if (LoRaMacParserData(&macMsg) != LORAMAC_PARSER_SUCCESS)
+  {
+    return SIM_VERIFIER_FAIL_FORMAT;
+  }
+  if (macMsg.FHDR.DevAddr != device->DevAddr)
+  {
+    return SIM_VERIFIER_FAIL_ADDRESS;
+  }
+
+  /* 32 bits frame counter: the first one above the last accepted one with
+     these 16 low bits */
+  fCnt = macMsg.FHDR.FCnt;
+  if (device->FCntUpValid == true)
+  {
+    if (fCnt == (device->FCntUp & 0xFFFF))
+    {
+      return SIM_VERIFIER_FAIL_FCNT;
+    }
+    fCnt |= device->FCntUp & 0xFFFF0000;
+    if (fCnt < device->FCntUp)
+    {
+      fCnt += 0x10000;
+    }
+  }
+
+  /* MIC, cmacF = aes128_cmac(FNwkSIntKey, B0 | msg), as sent by the device */
+  len = frame->BufSize - SIM_VERIFIER_MIC_SIZE;
+  LoRaMacCryptoPrepareB0(len, 0, SIM_VERIFIER_UPLINK, macMsg.FHDR.DevAddr, fCnt, block);
+  if (SimVerifier_Cmac(&device->FNwkSIntKey, block, frame->Buffer, len, &mic) != 0)
+  {
+    return SIM_VERIFIER_ERROR;
+  }
+  if (device->LrWanVersion.Fields.Minor == 1)
+  {
+    uint32_t cmacS;
+    uint16_t confFCnt = 0;
+
+    /* cmacS = aes128_cmac(SNwkSIntKey, B1 | msg), MIC = cmacS[0..1] | cmacF[0..1] */
+    if (macMsg.FHDR.FCtrl.Bits.Ack == 1)
+    {
+      confFCnt = (uint16_t)(device->ConfFCntDown % 65536);
+    }
+    LoRaMacCryptoPrepareB1(len, confFCnt, frame->TxDr, frame->TxCh, macMsg.FHDR.DevAddr, fCnt, block);
+    if (SimVerifier_Cmac(&device->SNwkSIntKey, block, frame->Buffer, len, &cmacS) != 0)
+    {
+      return SIM_VERIFIER_ERROR;
+    }
+    mic = ((mic << 16) & 0xFFFF0000) | (cmacS & 0x0000FFFF);
+  }
+  if (mic != macMsg.MIC)
+  {
+    return SIM_VERIFIER_FAIL_MIC;
+  }
+  device->FCntUp = fCnt;
+  device->FCntUpValid = true;
+
+  frame->DevAddr = macMsg.FHDR.DevAddr;
+  frame->FCnt = fCnt;
+  frame->FPort = macMsg.FPort;
+  frame->FOptsLen = fOptsLen;
+  frame->FRMPayloadSize = macMsg.FRMPayloadSize;
+  memcpy(frame->FOpts, macMsg.FHDR.FOpts, fOptsLen);
+
+  /* A blocks of the FOpts and FRMPayload encryption */
+  memset(block, 0, sizeof(block));
+  block[0] = 0x01;
+  block[5] = SIM_VERIFIER_UPLINK;
+  block[6] = frame->DevAddr & 0xFF;
+  block[7] = (frame->DevAddr >> 8) & 0xFF;
+  block[8] = (frame->DevAddr >> 16) & 0xFF;
+  block[9] = (frame->DevAddr >> 24) & 0xFF;
+  block[10] = fCnt & 0xFF;
+  block[11] = (fCnt >> 8) & 0xFF;
+  block[12] = (fCnt >> 16) & 0xFF;
+  block[13] = (fCnt >> 24) & 0xFF;
+
+  if ((device->LrWanVersion.Fields.Minor == 1) && (fOptsLen != 0))
+  {
+    uint8_t fOptsBlock[16];
+
+    memcpy(fOptsBlock, block, sizeof(fOptsBlock));
+    if (device->LrWanVersion.Value > SIM_VERIFIER_LRWAN_1_1_0)
+    {
+      /* Introduced in LoRaWAN 1.1.1, the uplink frame counter */
+      fOptsBlock[4] = 0x01;
+      fOptsBlock[15] = 0x01;
+    }
+    if (SimVerifier_Ctr(&device->NwkSEncKey, fOptsBlock, frame->FOpts, fOptsLen) != 0)
+    {
+      return SIM_VERIFIER_ERROR;
+    }
+  }
+
+  block[15] = 0x01;
+  if (SimVerifier_Ctr((frame->FPort == 0) ? &device->NwkSEncKey : &device->AppSKey, block,
+                      frame->FRMPayload, frame->FRMPayloadSize) != 0)
+  {
+    return SIM_VERIFIER_ERROR;
+  }
+  return SIM_VERIFIER_SUCCESS;
+}
+
+int32_t SimVerifier_Init(SimVerifier_t *verifier, SimVerifier_Device_t *devices, uint32_t devicesNb,
+                         uint32_t workersNb)
+{
+  memset(verifier, 0, sizeof(SimVerifier_t));
+  qsort(devices, devicesNb, sizeof(SimVerifier_Device_t), SimVerifier_CompareDevices);
+  verifier->Devices = devices;
+  verifier->DevicesNb = devicesNb;
+
+#if defined( MBEDTLS_AESNI_C ) && defined( MBEDTLS_HAVE_X86_64 )
+  /* The CPU support is probed and cached on the first call, before the
+     workers share it */
+  mbedtls_aesni_has_support(MBEDTLS_AESNI_AES);
+#endif
+
+  if (workersNb <= 1)
+  {
+    return 0;
+  }
+  if (workersNb > SIM_VERIFIER_MAX_WORKERS)
+  {
+    workersNb = SIM_VERIFIER_MAX_WORKERS;
+  }
+  pthread_mutex_init(&verifier->Lock, NULL);
+  pthread_cond_init(&verifier->Start, NULL);
+  pthread_cond_init(&verifier->Done, NULL);
+  for (uint32_t i = 0; i < workersNb; i++)
+  {
+    verifier->Workers[i].Verifier = verifier;
+    verifier->Workers[i].Index = i;
+    if (pthread_create(&verifier->Workers[i].Thread, NULL, SimVerifier_Worker, &verifier->Workers[i]) != 0)
+    {
+      SimVerifier_DeInit(verifier);
+      return -1;
+    }
+    verifier->WorkersNb++;
+  }
+  return 0;
+}
+
+SimVerifier_Device_t *SimVerifier_GetDevice(SimVerifier_t *verifier, uint32_t devAddr)
+{
+  uint32_t low = 0;
+  uint32_t high = verifier->DevicesNb;
+
+  while (low < high)
+  {
+    uint32_t middle = low + (high - low) / 2;
+
+    if (verifier->Devices[middle].DevAddr == devAddr)
+    {
+      return &verifier->Devices[middle];
+    }
+    if (verifier->Devices[middle].DevAddr < devAddr)
+    {
+      low = middle + 1;
+    }
+    else
+    {
+      high = middle;
+    }
+  }
+  return NULL;
+}
+
+void SimVerifier_Process(SimVerifier_t *verifier, SimVerifier_Frame_t *frames, uint32_t framesNb)
+{
+  if (verifier->WorkersNb <= 1)
+  {
+    for (uint32_t i = 0; i < framesNb; i++)
+    {
+      SimVerifier_Verify(verifier, &frames[i]);
+    }
+    return;
+  }
+
+  pthread_mutex_lock(&verifier->Lock);
+  verifier->Frames = frames;
+  verifier->FramesNb = framesNb;
+  verifier->Pending = verifier->WorkersNb;
+  verifier->Generation++;
+  pthread_cond_broadcast(&verifier->Start);
+  while (verifier->Pending != 0)
+  {
+    pthread_cond_wait(&verifier->Done, &verifier->Lock);
+  }
+  pthread_mutex_unlock(&verifier->Lock);
+}
+
+void SimVerifier_DeInit(SimVerifier_t *verifier)
+{
+  if (verifier->WorkersNb == 0)
+  {
+    return;
+  }
+  pthread_mutex_lock(&verifier->Lock);
+  verifier->Stop = true;
+  pthread_cond_broadcast(&verifier->Start);
+  pthread_mutex_unlock(&verifier->Lock);
+  for (uint32_t i = 0; i < verifier->WorkersNb; i++)
+  {
+    pthread_join(verifier->Workers[i].Thread, NULL);
+  }
+  pthread_cond_destroy(&verifier->Done);
+  pthread_cond_destroy(&verifier->Start);
+  pthread_mutex_destroy(&verifier->Lock);
+  verifier->WorkersNb = 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Expands a key and derives its CMAC subkeys
+ */
+static int32_t SimVerifier_SetKey(SimVerifier_Key_t *key, const uint8_t *value)
+{
+  uint8_t l[16] = { 0 };
+
+  mbedtls_aes_init(&key->Aes);
+  if ((mbedtls_aes_setkey_enc(&key->Aes, value, 128) != 0) ||
+      (mbedtls_aes_crypt_ecb(&key->Aes, MBEDTLS_AES_ENCRYPT, l, l) != 0))
+  {
+    return -1;
+  }
+  SimVerifier_CmacDouble(l, key->K1);
+  SimVerifier_CmacDouble(key->K1, key->K2);
+  return 0;
+}
+
+/**
+ * @brief  Doubles a CMAC subkey in GF(2^128)
+ */
+static void SimVerifier_CmacDouble(const uint8_t *in, uint8_t *out)
+{
+  uint8_t msb = in[0] & 0x80;
+
+  for (uint8_t i = 0; i < 15; i++)
+  {
+    out[i] = (uint8_t)((in[i] << 1) | (in[i + 1] >> 7));
+  }
+  out[15] = (uint8_t)(in[15] << 1);
+  if (msb != 0)
+  {
+    out[15] ^= 0x87;
+  }
+}
+
+/**
+ * @brief  Computes the CMAC of a Bx block followed by a message, the 4 first
+ *         bytes of the tag little endian as the MIC
+ */
+static int32_t SimVerifier_Cmac(const SimVerifier_Key_t *key, const uint8_t *bx, const uint8_t *buffer,
+                                uint16_t size, uint32_t *cmac)
+{
+  mbedtls_aes_context *aes = (mbedtls_aes_context *) &key->Aes;
+  uint8_t x[16];
+  uint16_t i;
+
+  /* The Bx block is a complete block followed by the message */
+  memcpy(x, bx, sizeof(x));
+  if ((size != 0) && (mbedtls_aes_crypt_ecb(aes, MBEDTLS_AES_ENCRYPT, x, x) != 0))
+  {
+    return -1;
+  }
+
+  /* All message blocks but the last one */
+  while (size > 16)
+  {
+    for (i = 0; i < 16; i++)
+    {
+      x[i] ^= buffer[i];
+    }
+    if (mbedtls_aes_crypt_ecb(aes, MBEDTLS_AES_ENCRYPT, x, x) != 0)
+    {
+      return -1;
+    }
+    buffer += 16;
+    size -= 16;
+  }
+
+  /* Last block, complete or padded */
+  for (i = 0; i < size; i++)
+  {
+    x[i] ^= buffer[i];
+  }
+  if ((size == 16) || (size == 0))
+  {
+    for (i = 0; i < 16; i++)
+    {
+      x[i] ^= key->K1[i];
+    }
+  }
+  else
+  {
+    x[size] ^= 0x80;
+    for (i = 0; i < 16; i++)
+    {
+      x[i] ^= key->K2[i];
+    }
+  }
+  if (mbedtls_aes_crypt_ecb(aes, MBEDTLS_AES_ENCRYPT, x, x) != 0)
+  {
+    return -1;
+  }
+
+  *cmac = (uint32_t)x[3] << 24 | (uint32_t)x[2] << 16 | (uint32_t)x[1] << 8 | (uint32_t)x[0];
+  return 0;
+}
+
+/**
+ * @brief  Encrypts or decrypts in counter mode, the counter in the last byte
+ *         of the A block
+ */
+static int32_t SimVerifier_Ctr(const SimVerifier_Key_t *key, uint8_t *aBlock, uint8_t *buffer, uint16_t size)
+{
+  mbedtls_aes_context *aes = (mbedtls_aes_context *) &key->Aes;
+  uint8_t sBlock[16];
+
+  while (size > 0)
+  {
+    uint16_t n = (size > 16) ? 16 : size;
+
+    if (mbedtls_aes_crypt_ecb(aes, MBEDTLS_AES_ENCRYPT, aBlock, sBlock) != 0)
+    {
+      return -1;
+    }
+    for (uint16_t i = 0; i < n; i++)
+    {
+      buffer[i] ^= sBlock[i];
+    }
+    aBlock[15]++;
+    buffer += n;
+    size -= n;
+  }
+  return 0;
+}
+
+/**
+ * @brief  Worker of a frame: a hash of its address, the frames too short to
+ *         carry one go to the first worker
+ */
+static uint32_t SimVerifier_Shard(const SimVerifier_Frame_t *frame, uint32_t workersNb)
+{
+  uint32_t devAddr;
+
+  if (frame->BufSize < 5)
+  {
+    return 0;
+  }
+  devAddr = (uint32_t)frame->Buffer[1] | ((uint32_t)frame->Buffer[2] << 8) |
+            ((uint32_t)frame->Buffer[3] << 16) | ((uint32_t)frame->Buffer[4] << 24);
+  return ((devAddr * 0x9E3779B1) >> 16) % workersNb;
+}
+
+/**
+ * @brief  Looks the device of a frame up and verifies the frame
+ */
+static void SimVerifier_Verify(SimVerifier_t *verifier, SimVerifier_Frame_t *frame)
+{
+  SimVerifier_Device_t *device;
+  uint32_t devAddr;
+
+  frame->FRMPayloadSize = 0;
+  frame->FOptsLen = 0;
+  if (frame->BufSize < SIM_VERIFIER_MIN_DATA_SIZE)
+  {
+    frame->Status = SIM_VERIFIER_FAIL_FORMAT;
+    return;
+  }
+  devAddr = (uint32_t)frame->Buffer[1] | ((uint32_t)frame->Buffer[2] << 8) |
+            ((uint32_t)frame->Buffer[3] << 16) | ((uint32_t)frame->Buffer[4] << 24);
+  device = SimVerifier_GetDevice(verifier, devAddr);
+  if (device == NULL)
+  {
+    frame->Status = SIM_VERIFIER_FAIL_ADDRESS;
+    return;
+  }
+  frame->Status = SimVerifier_Unsecure(device, frame);
+}
+
+/**
+ * @brief  Worker thread: verifies its share of each batch
+ */
+static void *SimVerifier_Worker(void *arg)
+{
+  SimVerifier_Worker_t *worker = (SimVerifier_Worker_t *) arg;
+  SimVerifier_t *verifier = worker->Verifier;
+  uint32_t generation = 0;
+
+  pthread_mutex_lock(&verifier->Lock);
+  for (;;)
+  {
+    SimVerifier_Frame_t *frames;
+    uint32_t framesNb;
+    uint32_t workersNb;
+
+    while ((verifier->Generation == generation) && (verifier->Stop == false))
+    {
+      pthread_cond_wait(&verifier->Start, &verifier->Lock);
+    }
+    if (verifier->Stop == true)
+    {
+      break;
+    }
+    generation = verifier->Generation;
+    frames = verifier->Frames;
+    framesNb = verifier->FramesNb;
+    workersNb = verifier->WorkersNb;
+    pthread_mutex_unlock(&verifier->Lock);
+
+    for (uint32_t i = 0; i < framesNb; i++)
+    {
+      if (SimVerifier_Shard(&frames[i], workersNb) == worker->Index)
+      {
+        SimVerifier_Verify(verifier, &frames[i]);
+      }
+    }
+
+    pthread_mutex_lock(&verifier->Lock);
+    if (--verifier->Pending == 0)
+    {
+      pthread_cond_signal(&verifier->Done);
+    }
+  }
+  pthread_mutex_unlock(&verifier->Lock);
+  return NULL;
+}
+
+/**
+ * @brief  Orders the devices by address
+ */
+static int SimVerifier_CompareDevices(const void *a, const void *b)
+{
+  uint32_t addrA = ((const SimVerifier_Device_t *) a)->DevAddr;
+  uint32_t addrB = ((const SimVerifier_Device_t *) b)->DevAddr;
+
+  return (addrA > addrB) - (addrA < addrB);
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
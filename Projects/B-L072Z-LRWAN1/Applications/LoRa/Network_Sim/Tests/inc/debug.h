@@ -0,0 +1,41 @@
+/**
+  ******************************************************************************
+  * @file    debug.h
+  * @author  MCD Application Team
+  * @brief   Host replacement of the debug header of the AT master applications
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DEBUG_H__
+#define __DEBUG_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+
+/* Exported macros -----------------------------------------------------------*/
+/* The tests report their own failures, the driver traces are dropped */
+#define DBG_PRINTF(...)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DEBUG_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
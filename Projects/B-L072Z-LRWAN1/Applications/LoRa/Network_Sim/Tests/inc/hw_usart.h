@@ -0,0 +1,52 @@
+/**
+  ******************************************************************************
+  * @file    hw_usart.h
+  * @author  MCD Application Team
+  * @brief   Host replacement of the modem UART configuration of the AT master
+  *          applications, implemented by sim_modem.c
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HW_USART_H__
+#define __HW_USART_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32l0xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define BAUD_RATE                                   9600
+
+/* External variables --------------------------------------------------------*/
+extern UART_HandleTypeDef huart1;
+extern UART_HandleTypeDef huart2;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef HW_UART_Modem_Init(uint32_t BaudRate);
+
+FlagStatus HW_UART_Modem_IsNewCharReceived(void);
+
+uint8_t HW_UART_Modem_GetNewChar(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HW_USART_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
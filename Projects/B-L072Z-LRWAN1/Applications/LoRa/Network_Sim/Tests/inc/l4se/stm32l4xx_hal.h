@@ -0,0 +1,140 @@
+/**
+  ******************************************************************************
+  * @file    stm32l4xx_hal.h
+  * @author  MCD Application Team
+  * @brief   Host replacement of the HAL used by stm32l4-se.c: the AES
+  *          peripheral in ECB and CTR, on Crypto/aes.c, and the SRAM2 write
+  *          protection of SYSCFG, implemented by sim_l4_cryp.c
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32L4xx_HAL_H
+#define __STM32L4xx_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include "aes.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  HAL_OK       = 0x00U,
+  HAL_ERROR    = 0x01U,
+  HAL_BUSY     = 0x02U,
+  HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum
+{
+  HAL_CRYP_STATE_RESET = 0x00U,
+  HAL_CRYP_STATE_READY = 0x01U
+} HAL_CRYP_STATETypeDef;
+
+/* Registers of the simulated peripherals, only the ones read by the driver */
+typedef struct
+{
+  volatile uint32_t CR;
+} AES_TypeDef;
+
+typedef struct
+{
+  volatile uint32_t SWPR;
+} SYSCFG_TypeDef;
+
+typedef struct
+{
+  uint32_t DataType;
+  uint32_t KeySize;
+  uint32_t OperatingMode;
+  uint32_t ChainingMode;
+  uint32_t KeyWriteFlag;
+  uint8_t *pKey;
+  uint8_t *pInitVect;
+} CRYP_InitTypeDef;
+
+typedef struct
+{
+  AES_TypeDef *Instance;
+  CRYP_InitTypeDef Init;
+  volatile HAL_CRYP_STATETypeDef State;
+  /* Key schedule and counter block of the simulated peripheral */
+  aes_context Context;
+  uint8_t Counter[16];
+} CRYP_HandleTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+#define CRYP_DATATYPE_8B                0x00000004U
+#define CRYP_KEYSIZE_128B               0x00000000U
+#define CRYP_ALGOMODE_ENCRYPT           0x00000000U
+#define CRYP_CHAINMODE_AES_ECB          0x00000000U
+#define CRYP_CHAINMODE_AES_CTR          0x00000040U
+#define CRYP_KEY_WRITE_ENABLE           0x00000001U
+
+/* External variables --------------------------------------------------------*/
+extern AES_TypeDef SimAesRegisters;
+
+extern SYSCFG_TypeDef SimSyscfgRegisters;
+
+/* SRAM2 of the test: the section of the root keys, see L4_SE_ROOT_KEY_SECTION
+   in the Makefile */
+extern uint8_t __start_sram2_wp[];
+
+/* Exported macros -----------------------------------------------------------*/
+#define AES                                       (&SimAesRegisters)
+
+#define SYSCFG                                    (&SimSyscfgRegisters)
+
+#define SRAM2_BASE                                ((uint32_t)(uintptr_t) __start_sram2_wp)
+
+#define __HAL_RCC_AES_CLK_ENABLE()
+#define __HAL_RCC_AES_FORCE_RESET()
+#define __HAL_RCC_AES_RELEASE_RESET()
+#define __HAL_RCC_SYSCFG_CLK_ENABLE()
+
+/* The pages stay write protected until SimL4_Reset */
+#define __HAL_SYSCFG_SRAM2_WRP_1_31_ENABLE(__SRAM2WRP__) \
+  do { SimSyscfgRegisters.SWPR |= (__SRAM2WRP__); } while (0)
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef HAL_CRYP_Init(CRYP_HandleTypeDef *hcryp);
+
+HAL_StatusTypeDef HAL_CRYP_DeInit(CRYP_HandleTypeDef *hcryp);
+
+HAL_StatusTypeDef HAL_CRYPEx_AES(CRYP_HandleTypeDef *hcryp, uint8_t *pInputData, uint16_t Size,
+                                 uint8_t *pOutputData, uint32_t Timeout);
+
+/**
+ * @brief  System reset of the simulated peripherals: clears the SRAM2 write
+ *         protection, the SRAM2 content is kept
+ */
+void SimL4_Reset(void);
+
+/**
+ * @brief  Number of keys loaded in the AES peripheral since the start
+ */
+uint32_t SimL4_GetKeyLoads(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32L4xx_HAL_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
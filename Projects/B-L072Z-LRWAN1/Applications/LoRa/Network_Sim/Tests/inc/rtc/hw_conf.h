@@ -0,0 +1,57 @@
+/**
+  ******************************************************************************
+  * @file    hw_conf.h
+  * @author  MCD Application Team
+  * @brief   Host replacement of the hardware configuration of the End_Node
+  *          RTC driver: the simulated RTC and an emulated PRIMASK, so that
+  *          the critical sections of the driver can be checked
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HW_CONF_H__
+#define __HW_CONF_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32l0xx_hal.h"
+#include "stm32l0xx_ll_rtc.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define RTC_OUTPUT                  RTC_OUTPUT_DISABLE
+
+/* Exported functions ------------------------------------------------------- */
+/* Interrupt mask of the simulated core, implemented by sim_rtc_hal.c */
+uint32_t __get_PRIMASK(void);
+
+void __set_PRIMASK(uint32_t priMask);
+
+void __disable_irq(void);
+
+void __enable_irq(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HW_CONF_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
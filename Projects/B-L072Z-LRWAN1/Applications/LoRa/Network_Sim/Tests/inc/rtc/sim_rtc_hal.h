@@ -0,0 +1,92 @@
+/**
+  ******************************************************************************
+  * @file    sim_rtc_hal.h
+  * @author  MCD Application Team
+  * @brief   Simulated RTC behind the host replacement of the RTC HAL: a
+  *          1024 Hz calendar counted from 01/01/2000, which can advance while
+  *          the driver reads it
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_RTC_HAL_H__
+#define __SIM_RTC_HAL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm32l0xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Ticks per second of the simulated RTC, the synchronous prescaler of the
+ * driver
+ */
+#define SIM_RTC_TICKS_PER_SECOND                    1024
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief  Interrupt handler run by the simulated core
+ */
+typedef void (*SimRtc_Handler_t)(void);
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Sets the simulated RTC
+ * @param  Tick ticks elapsed since 01/01/2000 at midnight
+ */
+void SimRtc_Set(uint64_t Tick);
+
+/**
+ * @brief  Gets the simulated RTC
+ * @retval ticks elapsed since 01/01/2000 at midnight
+ */
+uint64_t SimRtc_Get(void);
+
+/**
+ * @brief  Advances the RTC by one tick every Reads reads of the sub-seconds
+ *         register, the time can then change between the reads of the driver
+ * @param  Reads reads per tick, 0 to freeze the RTC
+ */
+void SimRtc_SetStepOnRead(uint32_t Reads);
+
+/**
+ * @brief  Runs a handler, as an interrupt, on the reads of the sub-seconds
+ *         register done with the interrupts enabled
+ * @param  Handler interrupt handler, NULL for none
+ */
+void SimRtc_SetIrqOnRead(SimRtc_Handler_t Handler);
+
+/**
+ * @brief  Gets the last alarm set by the driver
+ * @retval alarm configuration
+ */
+const RTC_AlarmTypeDef *SimRtc_GetAlarm(void);
+
+/**
+ * @brief  Counts the times the driver masked the interrupts
+ * @retval calls of __disable_irq
+ */
+uint32_t SimRtc_GetIrqMasks(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_RTC_HAL_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
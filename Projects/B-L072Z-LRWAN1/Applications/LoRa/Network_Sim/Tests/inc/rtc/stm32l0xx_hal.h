@@ -0,0 +1,192 @@
+/**
+  ******************************************************************************
+  * @file    stm32l0xx_hal.h
+  * @author  MCD Application Team
+  * @brief   Host replacement of the HAL used by the End_Node RTC driver: the
+  *          RTC calendar, alarm and backup registers and the NVIC pending
+  *          state, implemented by sim_rtc_hal.c
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32L0xx_HAL_H
+#define __STM32L0xx_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  HAL_OK       = 0x00U,
+  HAL_ERROR    = 0x01U,
+  HAL_BUSY     = 0x02U,
+  HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum
+{
+  RESET = 0U,
+  SET = !RESET
+} FlagStatus, ITStatus;
+
+typedef enum
+{
+  RTC_Alarm_IRQn = 2
+} IRQn_Type;
+
+/* Registers of the simulated RTC, only the ones read by the driver */
+typedef struct
+{
+  volatile uint32_t TR;
+  volatile uint32_t DR;
+  volatile uint32_t SSR;
+} RTC_TypeDef;
+
+typedef struct
+{
+  uint32_t HourFormat;
+  uint32_t AsynchPrediv;
+  uint32_t SynchPrediv;
+  uint32_t OutPut;
+  uint32_t OutPutPolarity;
+  uint32_t OutPutType;
+} RTC_InitTypeDef;
+
+typedef struct
+{
+  uint8_t Hours;
+  uint8_t Minutes;
+  uint8_t Seconds;
+  uint8_t TimeFormat;
+  uint32_t SubSeconds;
+  uint32_t DayLightSaving;
+  uint32_t StoreOperation;
+} RTC_TimeTypeDef;
+
+typedef struct
+{
+  uint8_t WeekDay;
+  uint8_t Month;
+  uint8_t Date;
+  uint8_t Year;
+} RTC_DateTypeDef;
+
+typedef struct
+{
+  RTC_TimeTypeDef AlarmTime;
+  uint32_t AlarmMask;
+  uint32_t AlarmSubSecondMask;
+  uint32_t AlarmDateWeekDaySel;
+  uint8_t AlarmDateWeekDay;
+  uint32_t Alarm;
+} RTC_AlarmTypeDef;
+
+typedef struct
+{
+  RTC_TypeDef *Instance;
+  RTC_InitTypeDef Init;
+} RTC_HandleTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+#define RTC_TR_PM                       0x00400000U
+
+#define RTC_DR_YT                       0x00F00000U
+#define RTC_DR_YU                       0x000F0000U
+#define RTC_DR_YU_Pos                   16U
+#define RTC_DR_WDU                      0x0000E000U
+#define RTC_DR_WDU_Pos                  13U
+#define RTC_DR_MT                       0x00001000U
+#define RTC_DR_MU                       0x00000F00U
+#define RTC_DR_MU_Pos                   8U
+#define RTC_DR_DT                       0x00000030U
+#define RTC_DR_DU                       0x0000000FU
+#define RTC_DR_DU_Pos                   0U
+
+#define RTC_ALRMASSR_MASKSS_Pos         24U
+
+#define RTC_HOURFORMAT_24               0x00000000U
+#define RTC_HOURFORMAT12_AM             0x00U
+#define RTC_OUTPUT_DISABLE              0x00000000U
+#define RTC_OUTPUT_POLARITY_HIGH        0x00000000U
+#define RTC_OUTPUT_TYPE_OPENDRAIN       0x00000000U
+#define RTC_FORMAT_BIN                  0x00000000U
+#define RTC_MONTH_JANUARY               0x01U
+#define RTC_WEEKDAY_MONDAY              0x01U
+#define RTC_DAYLIGHTSAVING_NONE         0x00000000U
+#define RTC_STOREOPERATION_RESET        0x00000000U
+#define RTC_ALARM_A                     0x00000100U
+#define RTC_ALARMMASK_NONE              0x00000000U
+#define RTC_ALARMDATEWEEKDAYSEL_DATE    0x00000000U
+#define RTC_FLAG_ALRAF                  0x00000100U
+#define RTC_IT_ALRA                     0x00001000U
+#define RTC_BKP_DR0                     0x00000000U
+#define RTC_BKP_DR1                     0x00000001U
+
+/* External variables --------------------------------------------------------*/
+extern RTC_TypeDef SimRtcRegisters;
+
+/* Exported macros -----------------------------------------------------------*/
+#define RTC                                       (&SimRtcRegisters)
+
+#define READ_REG(REG)                             ((REG))
+
+#define __NOP()
+
+/* The simulated alarm never fires by itself, its configuration is checked */
+#define __HAL_RTC_ALARM_CLEAR_FLAG(__HANDLE__, __FLAG__)
+#define __HAL_RTC_ALARM_EXTI_CLEAR_FLAG()
+#define __HAL_RTC_ALARM_GET_IT_SOURCE(__HANDLE__, __IT__) RESET
+#define __HAL_RTC_ALARM_GET_FLAG(__HANDLE__, __FLAG__)    RESET
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef HAL_RTC_Init(RTC_HandleTypeDef *hrtc);
+
+HAL_StatusTypeDef HAL_RTC_SetTime(RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *sTime, uint32_t Format);
+
+HAL_StatusTypeDef HAL_RTC_GetTime(RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *sTime, uint32_t Format);
+
+HAL_StatusTypeDef HAL_RTC_SetDate(RTC_HandleTypeDef *hrtc, RTC_DateTypeDef *sDate, uint32_t Format);
+
+HAL_StatusTypeDef HAL_RTC_GetDate(RTC_HandleTypeDef *hrtc, RTC_DateTypeDef *sDate, uint32_t Format);
+
+HAL_StatusTypeDef HAL_RTC_SetAlarm_IT(RTC_HandleTypeDef *hrtc, RTC_AlarmTypeDef *sAlarm, uint32_t Format);
+
+HAL_StatusTypeDef HAL_RTC_GetAlarm(RTC_HandleTypeDef *hrtc, RTC_AlarmTypeDef *sAlarm, uint32_t Alarm,
+                                   uint32_t Format);
+
+HAL_StatusTypeDef HAL_RTC_DeactivateAlarm(RTC_HandleTypeDef *hrtc, uint32_t Alarm);
+
+void HAL_RTC_AlarmAEventCallback(RTC_HandleTypeDef *hrtc);
+
+HAL_StatusTypeDef HAL_RTCEx_EnableBypassShadow(RTC_HandleTypeDef *hrtc);
+
+void HAL_RTCEx_BKUPWrite(RTC_HandleTypeDef *hrtc, uint32_t BackupRegister, uint32_t Data);
+
+uint32_t HAL_RTCEx_BKUPRead(RTC_HandleTypeDef *hrtc, uint32_t BackupRegister);
+
+uint32_t HAL_NVIC_GetPendingIRQ(IRQn_Type IRQn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32L0xx_HAL_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file    stm32l0xx_ll_rtc.h
+  * @author  MCD Application Team
+  * @brief   Host replacement of the RTC LL functions used by the End_Node RTC
+  *          driver, reading the simulated RTC of sim_rtc_hal.c
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32L0xx_LL_RTC_H
+#define __STM32L0xx_LL_RTC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32l0xx_hal.h"
+
+/* Exported macros -----------------------------------------------------------*/
+#define __LL_RTC_CONVERT_BCD2BIN(__VALUE__) \
+  (uint8_t)((((uint8_t)(__VALUE__) & 0xF0U) >> 4U) * 10U + ((__VALUE__) & 0x0FU))
+
+#define __LL_RTC_GET_HOUR(__RTC_TIME__)     (((__RTC_TIME__) >> 16U) & 0xFFU)
+#define __LL_RTC_GET_MINUTE(__RTC_TIME__)   (((__RTC_TIME__) >> 8U) & 0xFFU)
+#define __LL_RTC_GET_SECOND(__RTC_TIME__)   ((__RTC_TIME__) & 0xFFU)
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Reads the sub-seconds register, the simulated RTC may advance on
+ *         the read, see SimRtc_SetStepOnRead
+ * @param  RTCx RTC instance
+ * @retval sub-seconds down counter
+ */
+uint32_t LL_RTC_TIME_Get_SubSecond(RTC_TypeDef *RTCx);
+
+#define LL_RTC_TIME_GetSubSecond(RTCx)      LL_RTC_TIME_Get_SubSecond(RTCx)
+
+/**
+ * @brief  Reads the time of day
+ * @param  RTCx RTC instance
+ * @retval time of day, BCD 0x00HHMMSS
+ */
+uint32_t LL_RTC_TIME_Get(RTC_TypeDef *RTCx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32L0xx_LL_RTC_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
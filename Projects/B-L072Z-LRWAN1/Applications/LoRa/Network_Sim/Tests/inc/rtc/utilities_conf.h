@@ -0,0 +1,49 @@
+/**
+  ******************************************************************************
+  * @file    utilities_conf.h
+  * @author  MCD Application Team
+  * @brief   Host replacement of the utilities configuration of the End_Node
+  *          RTC driver: the low power manager users
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __UTLITIES_CONF_H
+#define __UTLITIES_CONF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*low power manager configuration*/
+typedef enum
+{
+  LPM_APPLI_Id = (1 << 0),
+  LPM_LIB_Id = (1 << 1),
+  LPM_RTC_Id = (1 << 2),
+} LPM_Id_t;
+
+#define VERBOSE_LEVEL_0 0
+#define VERBOSE_LEVEL_1 1
+#define VERBOSE_LEVEL_2 2
+
+#define VERBOSE_LEVEL 0
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__UTLITIES_CONF_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,47 @@
+/**
+  ******************************************************************************
+  * @file    se_crypto_config.h
+  * @author  MCD Application Team
+  * @brief   Crypto scheme of the host Secure Engine, AES-GCM unless
+  *          SIM_SE_AES_CBC_SHA256 is defined
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SE_CRYPTO_CONFIG_H
+#define SE_CRYPTO_CONFIG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define SECBOOT_ECCDSA_WITHOUT_ENCRYPT_SHA256        (1U) /*!< asymmetric crypto, no FW encryption         */
+#define SECBOOT_ECCDSA_WITH_AES128_CBC_SHA256        (2U) /*!< asymmetric crypto with encrypted Firmware   */
+#define SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM     (3U) /*!< symmetric crypto                            */
+
+/* Selected Crypto Scheme for bootloader operations */
+#if defined( SIM_SE_AES_CBC_SHA256 )
+#define SECBOOT_CRYPTO_SCHEME                        SECBOOT_ECCDSA_WITH_AES128_CBC_SHA256
+#else
+#define SECBOOT_CRYPTO_SCHEME                        SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SE_CRYPTO_CONFIG_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
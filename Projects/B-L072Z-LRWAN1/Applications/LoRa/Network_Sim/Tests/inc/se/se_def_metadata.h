@@ -0,0 +1,62 @@
+/**
+  ******************************************************************************
+  * @file    se_def_metadata.h
+  * @author  MCD Application Team
+  * @brief   Metadata of the firmware images of the host Secure Engine
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SE_DEF_METADATA_H
+#define SE_DEF_METADATA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "se_crypto_config.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define SE_FW_IMAGE_COMPLETE    (0)                   /*!< complete firmware image */
+#define SE_FW_IMAGE_PARTIAL     (1)                   /*!< partial firmware image */
+
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+#define SE_TAG_LEN              (16)                  /*!< GCM tag of the encrypted firmware */
+#define SE_NONCE_LEN            (12)                  /*!< GCM nonce */
+#else
+#define SE_TAG_LEN              (32)                  /*!< SHA256 of the clear firmware */
+#define SE_NONCE_LEN            (16)                  /*!< CBC initialization vector */
+#endif /* SECBOOT_CRYPTO_SCHEME */
+
+#define SE_FW_HEADER_TOT_LEN    ((int32_t) sizeof(SE_FwRawHeaderTypeDef))   /*!< FW INFO header Total Length*/
+#define SE_FW_HEADER_METADATA_LEN    ((int32_t) sizeof(SE_FwRawHeaderTypeDef))   /*!< FW Metadata INFO header Length*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint16_t FwVersion;              /*!< Firmware version*/
+  uint32_t FwSize;                 /*!< Firmware size (bytes)*/
+  uint8_t  FwTag[SE_TAG_LEN];      /*!< Firmware Tag*/
+  uint8_t  Nonce[SE_NONCE_LEN];    /*!< Nonce or initialization vector of the encryption*/
+} SE_FwRawHeaderTypeDef;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SE_DEF_METADATA_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
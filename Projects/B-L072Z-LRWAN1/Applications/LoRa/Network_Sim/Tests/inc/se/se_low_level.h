@@ -0,0 +1,38 @@
+/**
+  ******************************************************************************
+  * @file    se_low_level.h
+  * @author  MCD Application Team
+  * @brief   Host replacement of the se_low_level.h of SE_CoreBin: the
+  *          bootloader interface uses none of its services
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SE_LOW_LEVEL_H
+#define SE_LOW_LEVEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "se_def.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SE_LOW_LEVEL_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,135 @@
+/**
+  ******************************************************************************
+  * @file    sim_flash.h
+  * @author  MCD Application Team
+  * @brief   File-backed flash of the host Secure Engine programs: erased bytes
+  *          are 0xFF and only them can be programmed, the programming time of
+  *          each double word is slept, either in the caller (blocking write)
+  *          or in a programming thread (write started, then waited), which
+  *          reads the source buffer at the end only, as a DMA would
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_FLASH_H__
+#define __SIM_FLASH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "se_def.h"
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Address of the first byte of the flash
+ */
+#define SIM_FLASH_BASE                              0x08000000UL
+
+/**
+ * Programming granularity, the destination of a write must be aligned on it
+ */
+#define SIM_FLASH_DOUBLE_WORD                       8
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * Writes made to the flash
+ */
+typedef struct
+{
+  uint32_t Writes;                 /* writes started or done */
+  uint32_t Bytes;                  /* bytes programmed */
+  uint32_t Errors;                 /* writes out of the flash, misaligned, on
+                                      programmed bytes or started while
+                                      another one is pending */
+} SimFlash_Stats_t;
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Creates the flash, erased, in a temporary file and starts its
+ *         programming thread
+ * @param  Size flash size, bytes
+ * @param  ProgramTime programming time of a double word, ns
+ * @retval 0 in case of success, -1 otherwise
+ */
+int32_t SimFlash_Init(uint32_t Size, uint32_t ProgramTime);
+
+/**
+ * @brief  Stops the programming thread and removes the file
+ * @retval None
+ */
+void SimFlash_DeInit(void);
+
+/**
+ * @brief  Erases the whole flash
+ * @retval None
+ */
+void SimFlash_Erase(void);
+
+/**
+ * @brief  Reads the flash
+ * @param  Address flash address
+ * @param  Buffer destination
+ * @param  Length bytes to read
+ * @retval 0 in case of success, -1 out of the flash
+ */
+int32_t SimFlash_Read(uint32_t Address, void *Buffer, uint32_t Length);
+
+/**
+ * @brief  Starts a write, done by the programming thread
+ * @param  pDestination flash address
+ * @param  pSource data to program, read at the end of the programming time
+ * @param  Length bytes to program
+ * @retval SE_SUCCESS if started, SE_ERROR otherwise
+ */
+SE_ErrorStatus SimFlash_WriteStart(void *pDestination, const void *pSource, uint32_t Length);
+
+/**
+ * @brief  Waits for the write started last
+ * @retval SE_SUCCESS if programmed, SE_ERROR otherwise
+ */
+SE_ErrorStatus SimFlash_WriteWait(void);
+
+/**
+ * @brief  Programs the flash in the calling thread
+ * @param  pDestination flash address
+ * @param  pSource data to program
+ * @param  Length bytes to program
+ * @retval SE_SUCCESS if programmed, SE_ERROR otherwise
+ */
+SE_ErrorStatus SimFlash_Write(void *pDestination, const void *pSource, uint32_t Length);
+
+/**
+ * @brief  Wait of the blocking writes, returns at once
+ * @retval SE_SUCCESS
+ */
+SE_ErrorStatus SimFlash_WriteNone(void);
+
+/**
+ * @brief  Gets the writes made since the last reset
+ * @param  Reset resets the counters after reading them
+ * @retval counters
+ */
+SimFlash_Stats_t SimFlash_GetStats(bool Reset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_FLASH_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
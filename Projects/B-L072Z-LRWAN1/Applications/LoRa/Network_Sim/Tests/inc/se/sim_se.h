@@ -0,0 +1,135 @@
+/**
+  ******************************************************************************
+  * @file    sim_se.h
+  * @author  MCD Application Team
+  * @brief   Host Secure Engine behind the unmodified se_interface_bootloader.c:
+  *          its call gate runs the CRYPTO_LL services on mbedTLS, AES-GCM or
+  *          AES-CBC and SHA256 as selected by se_crypto_config.h.
+  *          Force included (-include) before the Secure Engine sources, it
+  *          stands in for se_intrinsics.h and se_interface_common.h, whose
+  *          Cortex-M instructions and fixed call gate address do not build on
+  *          the host: their include guards are defined here.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_SE_H__
+#define __SIM_SE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "se_def.h"
+
+/* Host replacement of se_intrinsics.h and se_interface_common.h -------------*/
+#define SE_INTRINSICS_H
+#define SE_INTERFACE_COMMON_H
+
+/**
+ * Addresses of the Secure Engine binary, only cast by SE_Startup which the
+ * host programs do not call
+ */
+#define SE_STARTUP_REGION_ROM_START                 0x08000200UL
+#define SE_CALLGATE_REGION_ROM_START                0x08000300UL
+
+/**
+ * The caller region is not checked on the host
+ */
+#define __IS_SFU_RESERVED()                         do { } while (0)
+
+/**
+ * The call gate is SimSe_CallGate
+ */
+#define SET_CALLGATE() \
+  SE_ErrorStatus(*SE_CallGatePtr)(uint32_t ID, SE_StatusTypeDef *peSE_Status, ...) = SimSe_CallGate
+
+void SE_EnterSecureMode(void);
+void SE_ExitSecureMode(void);
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * Calls made to the host Secure Engine
+ */
+typedef struct
+{
+  uint32_t CallGates;              /* services called */
+  uint32_t SecureModeErrors;       /* nested entries or exits without entry */
+  uint32_t SecureMode;             /* 1 between SE_EnterSecureMode and
+                                      SE_ExitSecureMode */
+  uint32_t DecryptedBytes;         /* bytes out of SE_CRYPTO_LL_DECRYPT_xxx */
+  uint32_t AuthenticatedBytes;     /* bytes into
+                                      SE_CRYPTO_LL_AUTHENTICATE_FW_APPEND */
+} SimSe_Stats_t;
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Call gate of the host Secure Engine: SE_CRYPTO_LL_DECRYPT_xxx and
+ *         SE_CRYPTO_LL_AUTHENTICATE_FW_xxx with the arguments of
+ *         se_callgate.c, the other services fail
+ * @param  ID service identifier
+ * @param  peSE_Status Secure Engine status
+ * @retval SE_SUCCESS or SE_ERROR
+ */
+SE_ErrorStatus SimSe_CallGate(uint32_t ID, SE_StatusTypeDef *peSE_Status, ...);
+
+/**
+ * @brief  Encrypts a firmware image with the key of the host Secure Engine
+ *         and fills its metadata, as the image preparation tool does
+ * @param  Clear clear firmware
+ * @param  Size firmware size, a multiple of 16 bytes with AES-CBC
+ * @param  Metadata metadata of the image, filled
+ * @param  Encrypted encrypted firmware, Size bytes
+ * @retval 0 in case of success, -1 otherwise
+ */
+int32_t SimSe_EncryptImage(const uint8_t *Clear, uint32_t Size, SE_FwRawHeaderTypeDef *Metadata, uint8_t *Encrypted);
+
+/**
+ * @brief  Adds a busy time to each decrypted byte, to run the services at the
+ *         speed of a target CPU instead of the host one
+ * @param  NsPerByte time per decrypted byte, 0 for the host speed
+ * @retval None
+ */
+void SimSe_SetCryptoTime(uint32_t NsPerByte);
+
+/**
+ * @brief  Gets the calls made to the host Secure Engine since the last reset
+ * @param  Reset resets the counters after reading them
+ * @retval counters
+ */
+SimSe_Stats_t SimSe_GetStats(bool Reset);
+
+/**
+ * @brief  Gets the heap allocated by mbedTLS at most since the last call
+ * @retval bytes
+ */
+uint32_t SimSe_GetPeakHeap(void);
+
+/**
+ * @brief  Gets the size of the static state of the CRYPTO_LL services: cipher
+ *         contexts, and the SHA256 one with AES-CBC
+ * @retval bytes
+ */
+uint32_t SimSe_GetContextSize(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_SE_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,99 @@
+/**
+  ******************************************************************************
+  * @file    sim_modem.h
+  * @author  MCD Application Team
+  * @brief   Simulated external modem on the host replacement of the UART,
+  *          its reception DMA, the tick and the timer server
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_MODEM_H__
+#define __SIM_MODEM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Characters carried per ms on the link, about 9600 bauds
+ */
+#define SIM_MODEM_CHARS_PER_MS                      1
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief  Handles a command received by the modem
+ * @param  Cmd received command, null terminated
+ * @param  Len command length
+ * @retval None
+ */
+typedef void (*SimModem_OnCommand_t)(const char *Cmd, uint16_t Len);
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Resets the link, the time and the timers
+ * @param  OnCommand modem behaviour, called once each command is transmitted
+ * @retval None
+ */
+void SimModem_Init(SimModem_OnCommand_t OnCommand);
+
+/**
+ * @brief  Queues characters sent by the modem, they reach the MCU at the
+ *         link speed
+ * @param  Data characters
+ * @param  Len number of characters
+ * @retval None
+ */
+void SimModem_Send(const char *Data, uint16_t Len);
+
+/**
+ * @brief  Queues a string sent by the modem
+ * @param  Text null terminated string
+ * @retval None
+ */
+void SimModem_SendString(const char *Text);
+
+/**
+ * @brief  Aborts the reception as a UART error does
+ * @param  None
+ * @retval None
+ */
+void SimModem_RxError(void);
+
+/**
+ * @brief  Advances the simulated time: carries the characters on the link,
+ *         completes the transmissions and fires the timers
+ * @param  Ms elapsed time in ms
+ * @retval None
+ */
+void SimModem_Step(uint32_t Ms);
+
+/**
+ * @brief  Gets the simulated time
+ * @param  None
+ * @retval time in ms
+ */
+uint32_t SimModem_GetTime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_MODEM_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
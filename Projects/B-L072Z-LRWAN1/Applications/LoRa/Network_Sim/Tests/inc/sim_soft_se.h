@@ -0,0 +1,56 @@
+/**
+  ******************************************************************************
+  * @file    sim_soft_se.h
+  * @author  MCD Application Team
+  * @brief   soft-se.c under the SoftSe_ prefix, built by sim_soft_se.c
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_SOFT_SE_H__
+#define __SIM_SOFT_SE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "secure-element.h"
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * The functions of secure-element.h, the ones compared by the tests
+ */
+SecureElementStatus_t SoftSe_Init(SecureElementNvmEvent seNvmCtxChanged);
+
+SecureElementStatus_t SoftSe_SetKey(KeyIdentifier_t keyID, uint8_t *key);
+
+SecureElementStatus_t SoftSe_ComputeAesCmac(uint8_t *micBxBuffer, uint8_t *buffer, uint16_t size,
+                                            KeyIdentifier_t keyID, uint32_t *cmac);
+
+SecureElementStatus_t SoftSe_AesEncrypt(uint8_t *buffer, uint16_t size, KeyIdentifier_t keyID, uint8_t *encBuffer);
+
+SecureElementStatus_t SoftSe_AesCtrEncrypt(uint8_t *buffer, uint16_t size, uint8_t *ctrBlock, KeyIdentifier_t keyID);
+
+SecureElementStatus_t SoftSe_DeriveAndStoreKey(Version_t version, uint8_t *input, KeyIdentifier_t rootKeyID,
+                                               KeyIdentifier_t targetKeyID);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_SOFT_SE_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
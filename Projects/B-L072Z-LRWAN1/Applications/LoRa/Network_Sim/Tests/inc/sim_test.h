@@ -0,0 +1,62 @@
+/**
+  ******************************************************************************
+  * @file    sim_test.h
+  * @author  MCD Application Team
+  * @brief   Checks and report of the host tests
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_TEST_H__
+#define __SIM_TEST_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Exported macros -----------------------------------------------------------*/
+/**
+ * Checks a condition, a failed one is printed with its location and the test
+ * goes on
+ */
+#define SIM_TEST_CHECK( cond )   SimTest_Check( ( cond ), #cond, __FILE__, __LINE__ )
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Counts a check, prints it when failed
+ * @param  Passed check result
+ * @param  Text checked condition
+ * @param  File Location source location of the check
+ * @retval Passed
+ */
+bool SimTest_Check(bool Passed, const char *Text, const char *File, int Location);
+
+/**
+ * @brief  Prints the test summary
+ * @param  Name test name
+ * @retval program exit code, 0 when all the checks passed
+ */
+int SimTest_Report(const char *Name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_TEST_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
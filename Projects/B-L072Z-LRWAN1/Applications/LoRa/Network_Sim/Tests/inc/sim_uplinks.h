@@ -0,0 +1,93 @@
+/**
+  ******************************************************************************
+  * @file    sim_uplinks.h
+  * @author  MCD Application Team
+  * @brief   Data uplinks secured by the LoRaMacCrypto and soft-se sources of
+  *          the devices, for the host tests of the network server side
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_UPLINKS_H__
+#define __SIM_UPLINKS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "utilities.h"
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * Session of a simulated device
+ */
+typedef struct
+{
+  uint32_t DevAddr;
+  Version_t LrWanVersion;
+  uint8_t FNwkSIntKey[16];         /* the three network keys are the NwkSKey
+                                      of a LoRaWAN 1.0 device */
+  uint8_t SNwkSIntKey[16];
+  uint8_t NwkSEncKey[16];
+  uint8_t AppSKey[16];
+} SimUplinks_Device_t;
+
+/**
+ * Content of an uplink
+ */
+typedef struct
+{
+  uint32_t FCnt;                   /* from 1, as the MAC counts them */
+  bool Confirmed;
+  bool Ack;                        /* acknowledges a downlink, none was
+                                      received by the device */
+  uint8_t FPort;
+  const uint8_t *FOpts;
+  uint8_t FOptsLen;
+  const uint8_t *Payload;
+  uint8_t PayloadSize;
+  uint8_t TxDr;
+  uint8_t TxCh;
+} SimUplinks_Uplink_t;
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Sets the session of a device from its index, distinct keys per
+ *         device
+ * @param  device device to set
+ * @param  index index of the device
+ * @param  version LoRaWAN version, 1.0.x or 1.1.x
+ * @retval None
+ */
+void SimUplinks_SetDevice(SimUplinks_Device_t *device, uint32_t index, Version_t version);
+
+/**
+ * @brief  Secures an uplink of a device with the crypto sources of the MAC
+ * @param  device device sending the uplink
+ * @param  uplink content of the uplink
+ * @param  buffer PHY payload, 255 bytes buffer
+ * @retval PHY payload size, 0 when the uplink cannot be secured
+ */
+uint8_t SimUplinks_Secure(const SimUplinks_Device_t *device, const SimUplinks_Uplink_t *uplink, uint8_t *buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_UPLINKS_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
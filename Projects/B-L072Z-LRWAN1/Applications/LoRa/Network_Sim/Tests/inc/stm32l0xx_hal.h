@@ -0,0 +1,146 @@
+/**
+  ******************************************************************************
+  * @file    stm32l0xx_hal.h
+  * @author  MCD Application Team
+  * @brief   Host replacement of the HAL used by the modem drivers: the UART,
+  *          its reception DMA and the tick, implemented by sim_modem.c
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32L0xx_HAL_H
+#define __STM32L0xx_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include "hw_conf.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  HAL_OK       = 0x00U,
+  HAL_ERROR    = 0x01U,
+  HAL_BUSY     = 0x02U,
+  HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum
+{
+  RESET = 0U,
+  SET = !RESET
+} FlagStatus, ITStatus;
+
+typedef enum
+{
+  HAL_UART_STATE_RESET   = 0x00U,
+  HAL_UART_STATE_READY   = 0x20U,
+  HAL_UART_STATE_BUSY    = 0x24U,
+  HAL_UART_STATE_BUSY_TX = 0x21U,
+  HAL_UART_STATE_BUSY_RX = 0x22U,
+  HAL_UART_STATE_ERROR   = 0xE0U
+} HAL_UART_StateTypeDef;
+
+/* Registers of the simulated peripherals, only the bits used by the drivers */
+typedef struct
+{
+  volatile uint32_t CR1;
+  volatile uint32_t ISR;
+} USART_TypeDef;
+
+typedef struct
+{
+  volatile uint32_t CNDTR;
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+  uint32_t Mode;
+} DMA_InitTypeDef;
+
+typedef struct
+{
+  DMA_Channel_TypeDef *Instance;
+  DMA_InitTypeDef Init;
+} DMA_HandleTypeDef;
+
+typedef struct
+{
+  USART_TypeDef *Instance;
+  uint8_t *pRxBuffPtr;
+  uint16_t RxXferSize;
+  DMA_HandleTypeDef *hdmarx;
+  volatile HAL_UART_StateTypeDef gState;
+  volatile HAL_UART_StateTypeDef RxState;
+} UART_HandleTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+#define DMA_NORMAL                  0x00000000U
+#define DMA_CIRCULAR                0x00000020U
+
+#define UART_FLAG_IDLE              0x00000010U
+#define UART_IT_IDLE                0x00000010U
+
+#define PWR_MAINREGULATOR_ON        0x00000000U
+#define PWR_SLEEPENTRY_WFI          0x01U
+
+/* Exported macros -----------------------------------------------------------*/
+#define __HAL_UART_GET_FLAG(__HANDLE__, __FLAG__) \
+  ((((__HANDLE__)->Instance->ISR & (__FLAG__)) == (__FLAG__)) ? SET : RESET)
+
+#define __HAL_UART_CLEAR_IDLEFLAG(__HANDLE__)     ((__HANDLE__)->Instance->ISR &= ~UART_FLAG_IDLE)
+
+#define __HAL_UART_ENABLE_IT(__HANDLE__, __IT__)  ((__HANDLE__)->Instance->CR1 |= (__IT__))
+
+#define __HAL_UART_DISABLE_IT(__HANDLE__, __IT__) ((__HANDLE__)->Instance->CR1 &= ~(__IT__))
+
+#define __HAL_DMA_GET_COUNTER(__HANDLE__)         ((__HANDLE__)->Instance->CNDTR)
+
+/* HAL parameter checks, off as without USE_FULL_ASSERT */
+#define assert_param(expr)                        ((void)0U)
+
+/* Exported functions ------------------------------------------------------- */
+uint32_t HAL_GetTick(void);
+
+void HAL_Delay(uint32_t Delay);
+
+void HAL_PWR_EnterSLEEPMode(uint32_t Regulator, uint8_t SLEEPEntry);
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+
+HAL_StatusTypeDef HAL_UART_DMAStop(UART_HandleTypeDef *huart);
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart);
+
+void HAL_UART_MspDeInit(UART_HandleTypeDef *huart);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32L0xx_HAL_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,41 @@
+/**
+  ******************************************************************************
+  * @file    tiny_vsnprintf.h
+  * @author  MCD Application Team
+  * @brief   Host replacement of tiny_vsnprintf_like, the C library vsnprintf
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TINY_VSNPRINTF_H__
+#define __TINY_VSNPRINTF_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdio.h>
+
+/* Exported macros -----------------------------------------------------------*/
+#define tiny_vsnprintf_like                         vsnprintf
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TINY_VSNPRINTF_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
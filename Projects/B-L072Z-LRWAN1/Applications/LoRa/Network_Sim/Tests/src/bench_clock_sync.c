@@ -0,0 +1,536 @@
+/**
+  ******************************************************************************
+  * @file    bench_clock_sync.c
+  * @author  MCD Application Team
+  * @brief   Sync traffic against residual time error of the clock discipline
+  *          of LmhpClockSync.c over 30 days: a node on a drifting RTC with a
+  *          daily temperature swing, uplinks and downlinks lost, a network
+  *          answering AppTimeReq with AppTimeAns (1 s resolution) or the
+  *          DeviceTimeReq sent along with DeviceTimeAns (1/256 s). The drift
+  *          tracking periods, a network imposed AppTimePeriodicityReq period
+  *          and the integer second steps the package made before the
+  *          discipline are compared
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "hw_rtc.h"
+#include "systime.h"
+#include "timer.h"
+#include "utilities.h"
+#include "LmHandler.h"
+#include "LmhpClockSync.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum
+{
+  MODE_ADAPTIVE,                   /* period following the drift */
+  MODE_NETWORK,                    /* period of AppTimePeriodicityReq */
+  MODE_STEPS,                      /* steps only, period of the application */
+} Mode_t;
+
+typedef enum
+{
+  SERVER_APP_TIME_ANS,
+  SERVER_DEVICE_TIME_ANS,
+} Server_t;
+
+typedef struct
+{
+  double Drift;                    /* ppm, positive when the RTC runs slow */
+  Server_t Server;
+  Mode_t Mode;
+} Scenario_t;
+
+/* Private define ------------------------------------------------------------*/
+#define SIM_DAYS                     30
+#define SIM_DURATION                 ((uint64_t) SIM_DAYS * 86400 * 1000)
+
+/* Unix time at the start, the node clock then being SIM_START_ERROR off */
+#define SIM_START                    1600000000ULL
+#define SIM_START_ERROR              7300
+
+/* Daily swing of the RTC frequency error, ppm */
+#define SIM_DRIFT_SWING              3.0
+
+/* Loss rate of the uplinks and of the downlinks, % */
+#define SIM_LOSS                     10
+
+/* The node wakes up for its application every SIM_WAKE_PERIOD ms, on its
+   timer and on a downlink; the error is sampled every SIM_SAMPLE_PERIOD ms */
+#define SIM_WAKE_PERIOD              60000
+#define SIM_SAMPLE_PERIOD            60000
+#define SIM_SAMPLES_MAX              (SIM_DURATION / SIM_SAMPLE_PERIOD)
+
+/* Delay of a downlink after its uplink, RX1 */
+#define SIM_RX_DELAY                 1000
+
+/* AppTimePeriodicityReq Period of MODE_NETWORK and application period of
+   MODE_STEPS: 128 * 2^9 s, about 18 h */
+#define SIM_NETWORK_PERIOD           9
+#define SIM_STEPS_PERIOD             ((uint64_t) 128000 << SIM_NETWORK_PERIOD)
+
+/* Clock synchronization package */
+#define CLOCK_SYNC_PORT              202
+#define CLOCK_SYNC_APP_TIME_REQ      0x01
+#define CLOCK_SYNC_APP_TIME_ANS      0x01
+#define CLOCK_SYNC_PERIOD_REQ        0x02
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static const Scenario_t Scenarios[] =
+{
+  { 10, SERVER_APP_TIME_ANS, MODE_ADAPTIVE },
+  { 10, SERVER_APP_TIME_ANS, MODE_NETWORK },
+  { 10, SERVER_APP_TIME_ANS, MODE_STEPS },
+  { 35, SERVER_APP_TIME_ANS, MODE_ADAPTIVE },
+  { 35, SERVER_APP_TIME_ANS, MODE_NETWORK },
+  { 35, SERVER_APP_TIME_ANS, MODE_STEPS },
+  { -100, SERVER_APP_TIME_ANS, MODE_ADAPTIVE },
+  { -100, SERVER_APP_TIME_ANS, MODE_NETWORK },
+  { -100, SERVER_APP_TIME_ANS, MODE_STEPS },
+  { 10, SERVER_DEVICE_TIME_ANS, MODE_ADAPTIVE },
+  { 10, SERVER_DEVICE_TIME_ANS, MODE_NETWORK },
+  { 10, SERVER_DEVICE_TIME_ANS, MODE_STEPS },
+  { 35, SERVER_DEVICE_TIME_ANS, MODE_ADAPTIVE },
+  { 35, SERVER_DEVICE_TIME_ANS, MODE_NETWORK },
+  { 35, SERVER_DEVICE_TIME_ANS, MODE_STEPS },
+  { -100, SERVER_DEVICE_TIME_ANS, MODE_ADAPTIVE },
+  { -100, SERVER_DEVICE_TIME_ANS, MODE_NETWORK },
+  { -100, SERVER_DEVICE_TIME_ANS, MODE_STEPS },
+};
+
+static const Scenario_t *Scenario;
+
+/* True time since the start, ms */
+static uint64_t Now;
+
+/* Node RTC, its backup registers holding the system time offset */
+static uint32_t BkupSeconds;
+static uint32_t BkupSubSeconds;
+
+/* Timer of the package, its expiry in RTC ms */
+static TimerEvent_t *Timer = NULL;
+static uint64_t TimerExpiry;
+
+/* Uplinks of the node and the downlink due, if any */
+static uint32_t NbUplinks;
+static uint32_t NbAppTimeReq;
+static uint32_t NbAnswers;
+static bool DeviceTimeReq = false;
+static bool ConfirmDue = false;
+static uint64_t ConfirmTime;
+static bool DownlinkDue = false;
+static uint64_t DownlinkTime;
+static uint8_t Downlink[8];
+static uint8_t DownlinkSize;
+static bool DownlinkDeviceTime;
+
+static int32_t Errors[SIM_SAMPLES_MAX];
+
+static uint8_t DataBuffer[242];
+
+/* Private function prototypes -----------------------------------------------*/
+static void SimRun(void);
+static void SimServer(const uint8_t *buffer, uint8_t size);
+static void SimDeliver(LmhPackage_t *package);
+static void SimConfirm(LmhPackage_t *package);
+static uint64_t SimRtcMs(uint64_t now);
+static int64_t SimSysTimeMs(void);
+static int SimCompare(const void *a, const void *b);
+static LmHandlerErrorStatus_t SimSendRequest(LmHandlerAppData_t *appData, LmHandlerMsgTypes_t isTxConfirmed);
+static LmHandlerErrorStatus_t SimDeviceTimeRequest(void);
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  printf("%u days, node awake every %u s, %u %% of the uplinks and downlinks lost\n", (unsigned) SIM_DAYS,
+         (unsigned)(SIM_WAKE_PERIOD / 1000), (unsigned) SIM_LOSS);
+  printf("drift ppm  answer      period    AppTimeReq  answers  uplinks/day  |err| mean ms  p95 ms  max ms  est ppm\n");
+  for (uint32_t i = 0; i < sizeof(Scenarios) / sizeof(Scenarios[0]); i++)
+  {
+    pid_t pid;
+    int status;
+
+    /* The package keeps its state in statics: each scenario runs in its own
+       process */
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0)
+    {
+      Scenario = &Scenarios[i];
+      SimRun();
+      fflush(stdout);
+      _exit(0);
+    }
+    if ((pid < 0) || (waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+    {
+      printf("scenario %u failed\n", (unsigned) i);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Radio of the node: LoRaMac is not run, the package settings are ignored */
+LoRaMacStatus_t LoRaMacMibGetRequestConfirm(MibRequestConfirm_t *mibGet)
+{
+  return LORAMAC_STATUS_OK;
+}
+
+LoRaMacStatus_t LoRaMacMibSetRequestConfirm(MibRequestConfirm_t *mibSet)
+{
+  return LORAMAC_STATUS_OK;
+}
+
+bool LmHandlerIsBusy(void)
+{
+  return false;
+}
+
+LmHandlerFlagStatus_t LmHandlerJoinStatus(void)
+{
+  return LORAMAC_HANDLER_SET;
+}
+
+/* RTC of the node, drifting from the true time */
+uint32_t HW_RTC_GetCalendarTime(uint16_t *subSeconds)
+{
+  uint64_t rtc = SimRtcMs(Now);
+
+  *subSeconds = (uint16_t)(rtc % 1000);
+  return (uint32_t)(rtc / 1000);
+}
+
+void HW_RTC_BKUPRead(uint32_t *Data0, uint32_t *Data1)
+{
+  *Data0 = BkupSeconds;
+  *Data1 = BkupSubSeconds;
+}
+
+void HW_RTC_BKUPWrite(uint32_t Data0, uint32_t Data1)
+{
+  BkupSeconds = Data0;
+  BkupSubSeconds = Data1;
+}
+
+/* Single timer of the package, on the RTC */
+void TimerInit(TimerEvent_t *obj, void (*callback)(void *context))
+{
+  obj->Callback = callback;
+  obj->IsStarted = false;
+  Timer = obj;
+}
+
+void TimerSetValue(TimerEvent_t *obj, uint32_t value)
+{
+  obj->ReloadValue = value;
+}
+
+void TimerStart(TimerEvent_t *obj)
+{
+  obj->IsStarted = true;
+  TimerExpiry = SimRtcMs(Now) + obj->ReloadValue;
+}
+
+void TimerStop(TimerEvent_t *obj)
+{
+  obj->IsStarted = false;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Runs the scenario second by second and prints its row
+ */
+static void SimRun(void)
+{
+  LmhPackage_t *package = LmphClockSyncPackageFactory();
+  LmhpClockSyncStatus_t status = { 0 };
+  uint64_t nextWake = 0;
+  uint64_t nextSteps = 0;
+  uint32_t samples = 0;
+  double sum = 0;
+  static const char *servers[] = { "AppTimeAns", "DeviceTime" };
+  static const char *modes[] = { "drift", "network", "steps" };
+
+  srand(1);
+  srand1(1);
+  Now = 0;
+  SysTimeSet((SysTime_t) { .Seconds = SIM_START + (SIM_START_ERROR / 1000), .SubSeconds = SIM_START_ERROR % 1000 });
+
+  package->OnSendRequest = SimSendRequest;
+  package->OnDeviceTimeRequest = SimDeviceTimeRequest;
+  if (Scenario->Mode != MODE_STEPS)
+  {
+    package->Init(NULL, DataBuffer, sizeof(DataBuffer));
+  }
+  if (Scenario->Mode == MODE_NETWORK)
+  {
+    Downlink[0] = CLOCK_SYNC_PERIOD_REQ;
+    Downlink[1] = SIM_NETWORK_PERIOD;
+    DownlinkSize = 2;
+    DownlinkDeviceTime = false;
+    DownlinkDue = true;
+    DownlinkTime = 0;
+  }
+
+  for (Now = 0; Now < SIM_DURATION; Now += 1000)
+  {
+    bool wake = false;
+
+    if (DownlinkDue && (Now >= DownlinkTime))
+    {
+      SimDeliver(package);
+      wake = true;
+    }
+    if (ConfirmDue && (Now >= ConfirmTime))
+    {
+      SimConfirm(package);
+      wake = true;
+    }
+    if ((Timer != NULL) && Timer->IsStarted && (SimRtcMs(Now) >= TimerExpiry))
+    {
+      Timer->IsStarted = false;
+      Timer->Callback(NULL);
+      wake = true;
+    }
+    if (Now >= nextWake)
+    {
+      nextWake += SIM_WAKE_PERIOD;
+      wake = true;
+    }
+
+    if (wake && (Scenario->Mode != MODE_STEPS))
+    {
+      package->Process();
+    }
+    else if (wake && (Now >= nextSteps))
+    {
+      /* Before the discipline: an AppTimeReq, with a DeviceTimeReq, on the
+         application period, the integer second correction added to the time */
+      uint8_t request[6];
+      SysTime_t curTime = SysTimeGet();
+
+      nextSteps += SIM_STEPS_PERIOD;
+      curTime.Seconds -= UNIX_GPS_EPOCH_OFFSET;
+      request[0] = CLOCK_SYNC_APP_TIME_REQ;
+      request[1] = (curTime.Seconds >> 0) & 0xFF;
+      request[2] = (curTime.Seconds >> 8) & 0xFF;
+      request[3] = (curTime.Seconds >> 16) & 0xFF;
+      request[4] = (curTime.Seconds >> 24) & 0xFF;
+      request[5] = 0;
+      DeviceTimeReq = true;
+      NbAppTimeReq++;
+      SimServer(request, sizeof(request));
+    }
+
+    if ((Now % SIM_SAMPLE_PERIOD) == 0)
+    {
+      if (Scenario->Mode != MODE_STEPS)
+      {
+        LmhpClockSyncGetStatus(&status);
+      }
+      else
+      {
+        status.IsSynchronized = (NbAnswers != 0) ? true : false;
+      }
+      if (status.IsSynchronized && (samples < SIM_SAMPLES_MAX))
+      {
+        int64_t error = SimSysTimeMs() - (int64_t)(SIM_START * 1000 + Now);
+
+        Errors[samples++] = (int32_t)((error < 0) ? -error : error);
+        sum += (error < 0) ? -error : error;
+      }
+    }
+  }
+
+  qsort(Errors, samples, sizeof(Errors[0]), SimCompare);
+  printf("%9.0f  %-10s  %-8s  %10u  %7u  %11.2f  %13.0f  %6d  %6d  ", Scenario->Drift, servers[Scenario->Server],
+         modes[Scenario->Mode], (unsigned) NbAppTimeReq, (unsigned) NbAnswers, (double) NbUplinks / SIM_DAYS,
+         (samples != 0) ? sum / samples : 0.0, (samples != 0) ? (int) Errors[samples * 95 / 100] : 0,
+         (samples != 0) ? (int) Errors[samples - 1] : 0);
+  if (Scenario->Mode != MODE_STEPS)
+  {
+    printf("%7.1f\n", status.Drift / 1000.0);
+  }
+  else
+  {
+    printf("%7s\n", "-");
+  }
+}
+
+/**
+ * @brief  Network server: answers an AppTimeReq unless the node time is
+ *         right to the second, and a DeviceTimeReq always, one RX1 later.
+ *         The uplink is confirmed after its receive windows, answered or not
+ */
+static void SimServer(const uint8_t *buffer, uint8_t size)
+{
+  uint64_t gps = SIM_START + (Now / 1000) - UNIX_GPS_EPOCH_OFFSET;
+  int32_t correction;
+
+  NbUplinks++;
+  ConfirmDue = true;
+  ConfirmTime = Now + 2 * SIM_RX_DELAY;
+  if (((rand() % 100) < SIM_LOSS) || ((rand() % 100) < SIM_LOSS))
+  {
+    DeviceTimeReq = false;
+    return;
+  }
+
+  DownlinkSize = 0;
+  DownlinkDeviceTime = (DeviceTimeReq && (Scenario->Server == SERVER_DEVICE_TIME_ANS)) ? true : false;
+  DeviceTimeReq = false;
+  if ((size == 6) && (buffer[0] == CLOCK_SYNC_APP_TIME_REQ) && !DownlinkDeviceTime)
+  {
+    correction = (int32_t)(gps - ((uint32_t) buffer[1] | ((uint32_t) buffer[2] << 8) | ((uint32_t) buffer[3] << 16)
+                                  | ((uint32_t) buffer[4] << 24)));
+    if (correction != 0)
+    {
+      Downlink[0] = CLOCK_SYNC_APP_TIME_ANS;
+      Downlink[1] = (correction >> 0) & 0xFF;
+      Downlink[2] = (correction >> 8) & 0xFF;
+      Downlink[3] = (correction >> 16) & 0xFF;
+      Downlink[4] = (correction >> 24) & 0xFF;
+      Downlink[5] = buffer[5] & 0x0F;
+      DownlinkSize = 6;
+    }
+  }
+  if ((DownlinkSize != 0) || DownlinkDeviceTime)
+  {
+    DownlinkDue = true;
+    DownlinkTime = Now + SIM_RX_DELAY;
+  }
+}
+
+/**
+ * @brief  Receives the downlink due: DeviceTimeAns sets the system time as
+ *         the MAC does, the package port goes to the package
+ */
+static void SimDeliver(LmhPackage_t *package)
+{
+  McpsIndication_t indication = { 0 };
+  uint8_t buffer[sizeof(Downlink)];
+
+  DownlinkDue = false;
+  if (DownlinkDeviceTime)
+  {
+    uint64_t time = (SIM_START * 1000 + Now) * 256 / 1000;
+
+    SysTimeSet((SysTime_t) { .Seconds = (uint32_t)(time / 256), .SubSeconds = (int16_t)((time % 256) * 1000 / 256) });
+    NbAnswers++;
+  }
+  if (DownlinkSize != 0)
+  {
+    if (Downlink[0] == CLOCK_SYNC_APP_TIME_ANS)
+    {
+      NbAnswers++;
+    }
+    if (Scenario->Mode == MODE_STEPS)
+    {
+      /* Integer second correction added to the time */
+      SysTime_t curTime = SysTimeGet();
+
+      curTime.Seconds += (int32_t)((uint32_t) Downlink[1] | ((uint32_t) Downlink[2] << 8)
+                                   | ((uint32_t) Downlink[3] << 16) | ((uint32_t) Downlink[4] << 24));
+      SysTimeSet(curTime);
+      return;
+    }
+  }
+  if (Scenario->Mode == MODE_STEPS)
+  {
+    return;
+  }
+  indication.Port = CLOCK_SYNC_PORT;
+  /* The answers of the package are sent while it parses the downlink */
+  memcpy1(buffer, Downlink, DownlinkSize);
+  indication.Buffer = buffer;
+  indication.BufferSize = DownlinkSize;
+  indication.DeviceTimeAnsReceived = DownlinkDeviceTime;
+  if (DownlinkSize != 0)
+  {
+    package->OnMcpsIndicationProcess(&indication);
+  }
+}
+
+/**
+ * @brief  Confirms the last uplink to the package
+ */
+static void SimConfirm(LmhPackage_t *package)
+{
+  McpsConfirm_t confirm = { 0 };
+
+  ConfirmDue = false;
+  if (Scenario->Mode != MODE_STEPS)
+  {
+    package->OnMcpsConfirmProcess(&confirm);
+  }
+}
+
+/**
+ * @brief  RTC time, ms, at the true time now: the frequency error integrated
+ *         from the start
+ */
+static uint64_t SimRtcMs(uint64_t now)
+{
+  double t = now / 1000.0;
+  double w = 2 * M_PI / 86400;
+  double lost = (Scenario->Drift * t + SIM_DRIFT_SWING * (1 - cos(w * t)) / w) / 1000000.0;
+
+  return (uint64_t) floor((t - lost) * 1000.0);
+}
+
+/**
+ * @brief  System time of the node, ms since the Unix epoch
+ */
+static int64_t SimSysTimeMs(void)
+{
+  SysTime_t sysTime = SysTimeGet();
+
+  return (int64_t) sysTime.Seconds * 1000 + sysTime.SubSeconds;
+}
+
+static int SimCompare(const void *a, const void *b)
+{
+  return *(const int32_t *) a - *(const int32_t *) b;
+}
+
+/**
+ * @brief  Uplinks of the package: AppTimeReq, with the DeviceTimeReq asked
+ *         before, and the answers to the network
+ */
+static LmHandlerErrorStatus_t SimSendRequest(LmHandlerAppData_t *appData, LmHandlerMsgTypes_t isTxConfirmed)
+{
+  if ((appData->BufferSize >= 1) && (appData->Buffer[0] == CLOCK_SYNC_APP_TIME_REQ))
+  {
+    NbAppTimeReq++;
+  }
+  SimServer(appData->Buffer, appData->BufferSize);
+  return LORAMAC_HANDLER_SUCCESS;
+}
+
+static LmHandlerErrorStatus_t SimDeviceTimeRequest(void)
+{
+  DeviceTimeReq = true;
+  return LORAMAC_HANDLER_SUCCESS;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,168 @@
+/**
+  ******************************************************************************
+  * @file    bench_frame_verifier.c
+  * @author  MCD Application Team
+  * @brief   Throughput of the network server side verification of the
+  *          uplinks: frames verified per second by 1 to 8 workers, on a batch
+  *          of uplinks of many LoRaWAN 1.0 and 1.1 devices
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mbedtls/aesni.h"
+#include "sim_uplinks.h"
+#include "sim_verifier.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define BENCH_DEVICES_NB             1000
+#define BENCH_FRAMES_NB              20000
+
+/* Application payload of the uplinks, bytes */
+#define BENCH_PAYLOAD_MIN            11
+#define BENCH_PAYLOAD_MAX            51
+
+/* Minimum duration of a measure, ns */
+#define BENCH_MIN_TIME               500000000ULL
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static SimUplinks_Device_t Devices[BENCH_DEVICES_NB];
+
+static SimVerifier_Device_t Sessions[BENCH_DEVICES_NB];
+
+static SimVerifier_Frame_t Frames[BENCH_FRAMES_NB];
+
+static const uint32_t WorkersNb[] = { 1, 2, 4, 8 };
+
+/* Private function prototypes -----------------------------------------------*/
+static uint64_t BenchTime(void);
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  uint32_t fCnt[BENCH_DEVICES_NB];
+  uint32_t bytes = 0;
+
+  srand(1);
+  for (uint32_t i = 0; i < BENCH_DEVICES_NB; i++)
+  {
+    Version_t version;
+
+    /* One device in 4 on LoRaWAN 1.1, two CMACs per uplink */
+    version.Value = ((i % 4) == 0) ? 0x01010100 : 0x01000300;
+    SimUplinks_SetDevice(&Devices[i], i, version);
+    if (SimVerifier_SetDevice(&Sessions[i], Devices[i].DevAddr, version, Devices[i].FNwkSIntKey,
+                              Devices[i].SNwkSIntKey, Devices[i].NwkSEncKey, Devices[i].AppSKey) != 0)
+    {
+      printf("cannot set the device %u\n", (unsigned) i);
+      return 1;
+    }
+    fCnt[i] = 1;
+  }
+
+  for (uint32_t i = 0; i < BENCH_FRAMES_NB; i++)
+  {
+    uint32_t d = rand() % BENCH_DEVICES_NB;
+    uint8_t payload[BENCH_PAYLOAD_MAX];
+    SimUplinks_Uplink_t uplink;
+
+    memset(&uplink, 0, sizeof(uplink));
+    uplink.FCnt = fCnt[d]++;
+    uplink.FPort = 2;
+    uplink.PayloadSize = BENCH_PAYLOAD_MIN + rand() % (BENCH_PAYLOAD_MAX - BENCH_PAYLOAD_MIN + 1);
+    uplink.Payload = payload;
+    uplink.TxDr = rand() % 6;
+    uplink.TxCh = rand() % 8;
+    for (uint8_t k = 0; k < uplink.PayloadSize; k++)
+    {
+      payload[k] = rand();
+    }
+    Frames[i].BufSize = SimUplinks_Secure(&Devices[d], &uplink, Frames[i].Buffer);
+    Frames[i].TxDr = uplink.TxDr;
+    Frames[i].TxCh = uplink.TxCh;
+    bytes += Frames[i].BufSize;
+  }
+
+#if defined( MBEDTLS_AESNI_C ) && defined( MBEDTLS_HAVE_X86_64 )
+  printf("AES: mbedTLS, AES-NI %s\n", mbedtls_aesni_has_support(MBEDTLS_AESNI_AES) ? "used" : "not supported");
+#else
+  printf("AES: mbedTLS, tables\n");
+#endif
+  printf("%u devices (1 in 4 LoRaWAN 1.1), %u frames, %u bytes per frame on average\n",
+         (unsigned) BENCH_DEVICES_NB, (unsigned) BENCH_FRAMES_NB, (unsigned)(bytes / BENCH_FRAMES_NB));
+  printf("workers   frames/s  us/frame  failed\n");
+
+  for (uint32_t w = 0; w < sizeof(WorkersNb) / sizeof(WorkersNb[0]); w++)
+  {
+    SimVerifier_t verifier;
+    uint64_t start;
+    uint64_t elapsed;
+    uint32_t passes = 0;
+    uint32_t failed = 0;
+
+    if (SimVerifier_Init(&verifier, Sessions, BENCH_DEVICES_NB, WorkersNb[w]) != 0)
+    {
+      printf("cannot start %u workers\n", (unsigned) WorkersNb[w]);
+      return 1;
+    }
+    start = BenchTime();
+    do
+    {
+      /* Each pass verifies the same uplinks again, the frame counters of
+         the devices start over */
+      for (uint32_t i = 0; i < BENCH_DEVICES_NB; i++)
+      {
+        Sessions[i].FCntUpValid = false;
+      }
+      SimVerifier_Process(&verifier, Frames, BENCH_FRAMES_NB);
+      passes++;
+      elapsed = BenchTime() - start;
+    } while (elapsed < BENCH_MIN_TIME);
+    SimVerifier_DeInit(&verifier);
+
+    for (uint32_t i = 0; i < BENCH_FRAMES_NB; i++)
+    {
+      failed += Frames[i].Status != SIM_VERIFIER_SUCCESS;
+    }
+    printf("%7u %10.0f %9.3f %7u\n", (unsigned) WorkersNb[w],
+           (double) passes * BENCH_FRAMES_NB * 1e9 / elapsed,
+           (double) elapsed / 1e3 / ((double) passes * BENCH_FRAMES_NB), (unsigned) failed);
+  }
+
+  for (uint32_t i = 0; i < BENCH_DEVICES_NB; i++)
+  {
+    SimVerifier_FreeDevice(&Sessions[i]);
+  }
+  return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Host monotonic time, ns
+ */
+static uint64_t BenchTime(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
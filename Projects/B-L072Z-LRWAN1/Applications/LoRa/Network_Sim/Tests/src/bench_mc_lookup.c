@@ -0,0 +1,244 @@
+/**
+  ******************************************************************************
+  * @file    bench_mc_lookup.c
+  * @author  MCD Application Team
+  * @brief   Host time of the multicast address match of LoRaMac.c, the
+  *          binary search on the address index against the scan of every
+  *          group it replaces, with all the LORAMAC_MAX_MC_CTX groups
+  *          enabled, and the RAM of the MAC, crypto and secure element
+  *          contexts per group
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "LoRaMac.h"
+#include "radio.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * Layout of a key of soft-se.c, three per group
+ */
+typedef struct
+{
+  KeyIdentifier_t KeyID;
+  uint8_t KeyValue[16];
+} BenchKey_t;
+
+/**
+ * Layout of a key-address item of LoRaMacCrypto.c, one per group
+ */
+typedef struct
+{
+  AddressIdentifier_t AddrID;
+  KeyIdentifier_t AppSkey;
+  KeyIdentifier_t NwkSkey;
+  KeyIdentifier_t RootKey;
+} BenchKeyAddr_t;
+
+/* Private define ------------------------------------------------------------*/
+/* Lookups of each path */
+#define BENCH_LOOKUPS                2000000
+
+/* Addresses looked up, half of the groups and half of no group */
+#define BENCH_ADDRESSES              256
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Groups as the MAC keeps them, for the scan of LoRaMac.c before the index */
+static MulticastCtx_t Channels[LORAMAC_MAX_MC_CTX];
+
+static uint32_t Hits[BENCH_ADDRESSES];
+
+static uint32_t Misses[BENCH_ADDRESSES];
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t BenchScan(uint32_t address);
+static uint64_t BenchLookups(const uint32_t *addresses, bool index, uint32_t *checksum);
+static uint32_t BenchRandom(void);
+static uint64_t BenchTime(void);
+static uint32_t BenchInit(RadioEvents_t *events);
+static void BenchSetPublicNetwork(bool enable);
+static void BenchSleep(void);
+static void BenchMcpsConfirm(McpsConfirm_t *McpsConfirm);
+static void BenchMcpsIndication(McpsIndication_t *McpsIndication);
+static void BenchMlmeConfirm(MlmeConfirm_t *MlmeConfirm);
+static void BenchMlmeIndication(MlmeIndication_t *MlmeIndication);
+
+/* Radio of the MAC, only initialized */
+const struct Radio_s Radio =
+{
+  .Init = BenchInit,
+  .Random = BenchRandom,
+  .SetPublicNetwork = BenchSetPublicNetwork,
+  .Sleep = BenchSleep,
+};
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  static LoRaMacPrimitives_t primitives = { BenchMcpsConfirm, BenchMcpsIndication, BenchMlmeConfirm,
+                                            BenchMlmeIndication };
+  static LoRaMacCallback_t callbacks;
+  uint8_t key[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+  MibRequestConfirm_t mib;
+  LoRaMacCtxs_t *ctxs;
+  uint32_t checksum[4] = { 0 };
+  uint64_t time[4];
+  uint32_t group_ram;
+
+  srand(1);
+  if (LoRaMacInitialization(&primitives, &callbacks, LORAMAC_REGION_EU868) != LORAMAC_STATUS_OK)
+  {
+    printf("cannot initialize the MAC\n");
+    return 1;
+  }
+
+  /* Groups of random addresses, in no particular order */
+  for (uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++)
+  {
+    McChannelParams_t channel = { 0 };
+
+    channel.Class = CLASS_C;
+    channel.IsEnabled = true;
+    channel.GroupID = (AddressIdentifier_t) i;
+    channel.Address = ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+    channel.McKeyE = key;
+    channel.FCountMax = UINT32_MAX;
+    if (LoRaMacMcChannelSetup(&channel) != LORAMAC_STATUS_OK)
+    {
+      printf("cannot set up multicast group %u\n", (unsigned) i);
+      return 1;
+    }
+    Channels[i].ChannelParams = channel;
+  }
+  for (uint32_t i = 0; i < BENCH_ADDRESSES; i++)
+  {
+    Hits[i] = Channels[rand() % LORAMAC_MAX_MC_CTX].ChannelParams.Address;
+    do
+    {
+      Misses[i] = ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+    } while (BenchScan(Misses[i]) != 0xFF);
+  }
+
+  time[0] = BenchLookups(Hits, false, &checksum[0]);
+  time[1] = BenchLookups(Hits, true, &checksum[1]);
+  time[2] = BenchLookups(Misses, false, &checksum[2]);
+  time[3] = BenchLookups(Misses, true, &checksum[3]);
+
+  /* Channel, address index entry, downlink counter, key-address item and
+     key triplet of a group */
+  group_ram = sizeof(MulticastCtx_t) + sizeof(uint8_t) + sizeof(uint32_t) + sizeof(BenchKeyAddr_t)
+              + 3 * sizeof(BenchKey_t);
+  mib.Type = MIB_NVM_CTXS;
+  LoRaMacMibGetRequestConfirm(&mib);
+  ctxs = mib.Param.Contexts;
+
+  printf("groups  scan hit ns  index hit ns  scan miss ns  index miss ns  MAC/crypto/SE nvm B  RAM B/group\n");
+  printf("%6u  %11.1f  %12.1f  %12.1f  %13.1f  %7u/%u/%u  %11u\n", (unsigned) LORAMAC_MAX_MC_CTX,
+         (double) time[0] / BENCH_LOOKUPS, (double) time[1] / BENCH_LOOKUPS, (double) time[2] / BENCH_LOOKUPS,
+         (double) time[3] / BENCH_LOOKUPS, (unsigned) ctxs->MacNvmCtxSize, (unsigned) ctxs->CryptoNvmCtxSize,
+         (unsigned) ctxs->SecureElementNvmCtxSize, (unsigned) group_ram);
+
+  if ((checksum[0] != checksum[1]) || (checksum[2] != checksum[3]))
+  {
+    printf("the index and the scan match different groups\n");
+    return 1;
+  }
+  return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Address match of ProcessRadioRxDone before the index: every group
+ *         compared
+ */
+static uint8_t __attribute__((noinline)) BenchScan(uint32_t address)
+{
+  for (uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++)
+  {
+    if ((Channels[i].ChannelParams.Address == address) && (Channels[i].ChannelParams.IsEnabled == true))
+    {
+      return i;
+    }
+  }
+  return 0xFF;
+}
+
+/**
+ * @brief  Looks the addresses up in turn, with the index of the MAC or the
+ *         scan, and sums the groups matched
+ */
+static uint64_t BenchLookups(const uint32_t *addresses, bool index, uint32_t *checksum)
+{
+  uint64_t start = BenchTime();
+
+  for (uint32_t i = 0; i < BENCH_LOOKUPS; i++)
+  {
+    uint32_t address = addresses[i % BENCH_ADDRESSES];
+
+    *checksum += (index) ? LoRaMacMcChannelGetGroupId(address) : BenchScan(address);
+  }
+  return BenchTime() - start;
+}
+
+static uint32_t BenchRandom(void)
+{
+  return (uint32_t) rand();
+}
+
+/**
+ * @brief  Host monotonic time, ns
+ */
+static uint64_t BenchTime(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static uint32_t BenchInit(RadioEvents_t *events)
+{
+  return 0;
+}
+
+static void BenchSetPublicNetwork(bool enable)
+{
+}
+
+static void BenchSleep(void)
+{
+}
+
+static void BenchMcpsConfirm(McpsConfirm_t *McpsConfirm)
+{
+}
+
+static void BenchMcpsIndication(McpsIndication_t *McpsIndication)
+{
+}
+
+static void BenchMlmeConfirm(MlmeConfirm_t *MlmeConfirm)
+{
+}
+
+static void BenchMlmeIndication(MlmeIndication_t *MlmeIndication)
+{
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
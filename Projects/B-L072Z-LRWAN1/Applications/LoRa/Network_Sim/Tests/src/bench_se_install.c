@@ -0,0 +1,250 @@
+/**
+  ******************************************************************************
+  * @file    bench_se_install.c
+  * @author  MCD Application Team
+  * @brief   Install time and peak RAM of the streaming install of
+  *          se_interface_bootloader.c, writes blocking or pipelined with the
+  *          decryption, on a file-backed flash with the programming time of
+  *          an STM32L4 double word and the AES-GCM of mbedTLS at the host
+  *          speed or at a target CPU speed
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "se_interface_bootloader.h"
+#include "sim_flash.h"
+#include "sim_se.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * Install run by the install thread
+ */
+typedef struct
+{
+  const SE_IMG_FlashOpsTypeDef *Ops;
+  uint32_t ChunkSize;
+  SE_ErrorStatus Status;
+  uint64_t Time;                   /* ns */
+} BenchInstall_t;
+
+/* Private define ------------------------------------------------------------*/
+#define FLASH_SIZE                   ( 128 * 1024 )
+
+/* Programming time of a double word, STM32L4 datasheet typical value */
+#define FLASH_PROGRAM_TIME           81690
+
+/* Download slot of the image */
+#define SLOT_ADDRESS                 ( SIM_FLASH_BASE + 0x8000 )
+
+#define IMAGE_SIZE                   ( 32 * 1024 )
+
+#define CHUNK_SIZE_MAX               4096
+
+/* Software AES-GCM of a Cortex-M4 at 80 MHz, about 160 cycles per byte */
+#define TARGET_CRYPTO_TIME           2000
+
+/* Stack of the install thread, painted to measure its high-water mark */
+#define STACK_SIZE                   ( 64 * 1024 )
+#define STACK_PAINT                  0xA5
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static const SE_IMG_FlashOpsTypeDef PipelineOps = { SimFlash_WriteStart, SimFlash_WriteWait };
+
+static const SE_IMG_FlashOpsTypeDef BlockingOps = { SimFlash_Write, SimFlash_WriteNone };
+
+static const uint32_t ChunkSizes[] = { 256, 1024, CHUNK_SIZE_MAX };
+
+static const uint32_t CryptoTimes[] = { 0, TARGET_CRYPTO_TIME };
+
+static uint8_t Clear[IMAGE_SIZE];
+
+static uint8_t Encrypted[IMAGE_SIZE];
+
+static SE_FwRawHeaderTypeDef Metadata;
+
+static uint8_t Buffers[2][CHUNK_SIZE_MAX];
+
+static uint8_t Stack[STACK_SIZE] __attribute__((aligned(64)));
+
+/* Private function prototypes -----------------------------------------------*/
+static int BenchRun(BenchInstall_t *Install);
+static void *BenchThread(void *Arg);
+static uint32_t BenchStack(void);
+static uint64_t BenchTime(void);
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  BenchInstall_t idle = { NULL, 0, SE_SUCCESS, 0 };
+  BenchInstall_t warmup[2] = { { &BlockingOps, CHUNK_SIZE_MAX, SE_ERROR, 0 },
+    { &PipelineOps, CHUNK_SIZE_MAX, SE_ERROR, 0 }
+  };
+  uint32_t idle_stack;
+  uint32_t errors = 0;
+
+  srand(1);
+  for (uint32_t i = 0; i < IMAGE_SIZE; i++)
+  {
+    Clear[i] = (uint8_t) rand();
+  }
+  if ((SimSe_EncryptImage(Clear, IMAGE_SIZE, &Metadata, Encrypted) != 0)
+      || (SimFlash_Init(FLASH_SIZE, FLASH_PROGRAM_TIME) != 0))
+  {
+    printf("cannot prepare the image\n");
+    return 1;
+  }
+
+  /* The thread descriptor and TLS of the host are in the stack of the idle
+     thread, the first installs resolve the dynamic symbols */
+  if ((BenchRun(&warmup[0]) != 0) || (BenchRun(&warmup[1]) != 0) || (BenchRun(&idle) != 0))
+  {
+    printf("cannot start the install thread\n");
+    return 1;
+  }
+  idle_stack = BenchStack();
+
+  printf("image %u bytes, flash %u ns per double word, flash only %.1f ms\n", (unsigned) IMAGE_SIZE,
+         (unsigned) FLASH_PROGRAM_TIME,
+         (double) FLASH_PROGRAM_TIME * (IMAGE_SIZE / SIM_FLASH_DOUBLE_WORD) / 1000000.0);
+  printf("crypto ns/B  chunk  writes      time ms   RAM B  (buffers  ctx  engine  heap)  host stack B\n");
+  for (uint32_t t = 0; t < sizeof(CryptoTimes) / sizeof(CryptoTimes[0]); t++)
+  {
+    SimSe_SetCryptoTime(CryptoTimes[t]);
+    for (uint32_t c = 0; c < sizeof(ChunkSizes) / sizeof(ChunkSizes[0]); c++)
+    {
+      for (uint32_t pipeline = 0; pipeline < 2; pipeline++)
+      {
+        BenchInstall_t install = { (pipeline != 0) ? &PipelineOps : &BlockingOps, ChunkSizes[c], SE_ERROR, 0 };
+        uint32_t buffers = 2 * ChunkSizes[c];
+        uint32_t heap;
+
+        SimSe_GetPeakHeap();
+        if (BenchRun(&install) != 0)
+        {
+          printf("cannot start the install thread\n");
+          return 1;
+        }
+        heap = SimSe_GetPeakHeap();
+        if (install.Status != SE_SUCCESS)
+        {
+          errors++;
+        }
+
+        printf("%12u  %5u  %-9s %8.1f  %6u  (%7u  %3u  %6u  %4u)  %12u\n", (unsigned) CryptoTimes[t],
+               (unsigned) ChunkSizes[c], (pipeline != 0) ? "pipeline" : "blocking", (double) install.Time / 1000000.0,
+               (unsigned)(buffers + sizeof(SE_IMG_InstallCtxTypeDef) + SimSe_GetContextSize() + heap),
+               (unsigned) buffers, (unsigned) sizeof(SE_IMG_InstallCtxTypeDef), (unsigned) SimSe_GetContextSize(),
+               (unsigned) heap, (unsigned)(BenchStack() - idle_stack));
+      }
+    }
+  }
+  SimFlash_DeInit();
+
+  if (errors != 0)
+  {
+    printf("%u installs failed\n", (unsigned) errors);
+    return 1;
+  }
+  return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Runs an install in a thread on the painted stack, on an erased flash
+ */
+static int BenchRun(BenchInstall_t *Install)
+{
+  pthread_attr_t attr;
+  pthread_t thread;
+  int ret;
+
+  SimFlash_Erase();
+  memset(Stack, STACK_PAINT, sizeof(Stack));
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, Stack, sizeof(Stack));
+  ret = pthread_create(&thread, &attr, BenchThread, Install);
+  if (ret == 0)
+  {
+    pthread_join(thread, NULL);
+  }
+  pthread_attr_destroy(&attr);
+  return ret;
+}
+
+/**
+ * @brief  Install thread: the whole image, timed, nothing without flash
+ *         operations
+ */
+static void *BenchThread(void *Arg)
+{
+  BenchInstall_t *install = Arg;
+  SE_IMG_InstallCtxTypeDef ctx;
+  SE_StatusTypeDef status;
+  uint8_t output[32];
+  int32_t output_size;
+  uint64_t start;
+
+  if (install->Ops == NULL)
+  {
+    return NULL;
+  }
+  start = BenchTime();
+  install->Status = SE_IMG_Install_Init(&status, &ctx, install->Ops, Buffers[0], Buffers[1], install->ChunkSize,
+                                        (void *)(uintptr_t) SLOT_ADDRESS, &Metadata, SE_FW_IMAGE_COMPLETE);
+  for (uint32_t offset = 0; (offset < IMAGE_SIZE) && (install->Status == SE_SUCCESS); offset += install->ChunkSize)
+  {
+    install->Status = SE_IMG_Install_Append(&status, &ctx, &Encrypted[offset], (int32_t) install->ChunkSize);
+  }
+  if (SE_IMG_Install_Finish(&status, &ctx, output, &output_size) != SE_SUCCESS)
+  {
+    install->Status = SE_ERROR;
+  }
+  install->Time = BenchTime() - start;
+  return NULL;
+}
+
+/**
+ * @brief  Stack used by the install thread: the bytes overwritten below the
+ *         untouched paint
+ */
+static uint32_t BenchStack(void)
+{
+  uint32_t i = 0;
+
+  while ((i < sizeof(Stack)) && (Stack[i] == STACK_PAINT))
+  {
+    i++;
+  }
+  return (uint32_t)(sizeof(Stack) - i);
+}
+
+/**
+ * @brief  Host monotonic time, ns
+ */
+static uint64_t BenchTime(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
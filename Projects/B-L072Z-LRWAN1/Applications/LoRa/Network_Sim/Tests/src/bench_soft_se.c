@@ -0,0 +1,194 @@
+/**
+  ******************************************************************************
+  * @file    bench_soft_se.c
+  * @author  MCD Application Team
+  * @brief   Host time of the AES operations of soft-se.c, on Crypto/aes.c
+  *          and cmac.c or, built with SOFT_SE_USE_MBEDTLS, on mbedTLS: MIC of
+  *          13 to 255 bytes, payload encryption, join accept decryption and
+  *          key derivation. The checksum of each path is the same with both
+  *          backends.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "radio.h"
+#include "secure-element.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Calls of each path */
+#define BENCH_CALLS                  20000
+
+/* Keys of the benchmark, the multicast keys cannot compute a CMAC */
+#define BENCH_KEY                    APP_S_KEY
+#define BENCH_DERIVED_KEY            NWK_S_ENC_KEY
+
+/* Join accept with a CFList, MHDR and MIC included */
+#define BENCH_JOIN_ACCEPT_SIZE       33
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static const uint16_t MicSizes[] = { 13, 32, 64, 128, 255 };
+
+static const uint16_t CtrSizes[] = { 16, 51, 115, 242 };
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t BenchRandom(void);
+static uint64_t BenchTime(void);
+static void BenchTrace(const char *path, uint16_t size, uint64_t time, uint32_t checksum);
+
+/* Radio of soft-se.c, only its random numbers are used */
+const struct Radio_s Radio =
+{
+  .Random = BenchRandom,
+};
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  uint8_t key[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+  uint8_t buffer[256];
+  uint8_t block[16];
+  Version_t version;
+  uint32_t checksum;
+  uint32_t cmac;
+  uint32_t errors = 0;
+  uint64_t start;
+
+  version.Value = 0x01000300;
+  for (uint16_t i = 0; i < sizeof(buffer); i++)
+  {
+    buffer[i] = (uint8_t)(i * 13 + 7);
+  }
+  SecureElementInit(NULL);
+  if (SecureElementSetKey(BENCH_KEY, key) != SECURE_ELEMENT_SUCCESS)
+  {
+    printf("cannot set the key\n");
+    return 1;
+  }
+
+#if defined( SOFT_SE_USE_MBEDTLS )
+  printf("soft-se backend: mbedTLS\n");
+#else
+  printf("soft-se backend: Crypto/aes.c and cmac.c\n");
+#endif
+  printf("path          size    ns/call  checksum\n");
+
+  /* MIC of a data frame, B0 block and message */
+  for (uint32_t s = 0; s < sizeof(MicSizes) / sizeof(MicSizes[0]); s++)
+  {
+    for (uint8_t i = 0; i < 16; i++)
+    {
+      block[i] = (uint8_t) i;
+    }
+    checksum = 0;
+    start = BenchTime();
+    for (uint32_t i = 0; i < BENCH_CALLS; i++)
+    {
+      block[10] = (uint8_t) i;
+      errors += SecureElementComputeAesCmac(block, buffer, MicSizes[s], BENCH_KEY, &cmac) != SECURE_ELEMENT_SUCCESS;
+      checksum = (checksum * 31) + cmac;
+    }
+    BenchTrace("MIC", MicSizes[s], BenchTime() - start, checksum);
+  }
+
+  /* FRMPayload encryption in counter mode */
+  for (uint32_t s = 0; s < sizeof(CtrSizes) / sizeof(CtrSizes[0]); s++)
+  {
+    checksum = 0;
+    start = BenchTime();
+    for (uint32_t i = 0; i < BENCH_CALLS; i++)
+    {
+      for (uint8_t k = 0; k < 16; k++)
+      {
+        block[k] = 0;
+      }
+      block[0] = 0x01;
+      block[10] = (uint8_t) i;
+      block[15] = 0x01;
+      errors += SecureElementAesCtrEncrypt(buffer, CtrSizes[s], block, BENCH_KEY) != SECURE_ELEMENT_SUCCESS;
+      checksum = (checksum * 31) + buffer[CtrSizes[s] - 1];
+    }
+    BenchTrace("CTR", CtrSizes[s], BenchTime() - start, checksum);
+  }
+
+  /* Join accept: decryption of all but the MHDR, then MIC of all but the MIC */
+  checksum = 0;
+  start = BenchTime();
+  for (uint32_t i = 0; i < BENCH_CALLS; i++)
+  {
+    buffer[1] = (uint8_t) i;
+    errors += SecureElementAesEncrypt(&buffer[1], BENCH_JOIN_ACCEPT_SIZE - 1, BENCH_KEY,
+                                      &buffer[1]) != SECURE_ELEMENT_SUCCESS;
+    errors += SecureElementComputeAesCmac(NULL, buffer, BENCH_JOIN_ACCEPT_SIZE - 4, BENCH_KEY,
+                                          &cmac) != SECURE_ELEMENT_SUCCESS;
+    checksum = (checksum * 31) + cmac;
+  }
+  BenchTrace("JOIN_ACCEPT", BENCH_JOIN_ACCEPT_SIZE, BenchTime() - start, checksum);
+
+  /* Session key derivation, with the first use of the new key */
+  checksum = 0;
+  start = BenchTime();
+  for (uint32_t i = 0; i < BENCH_CALLS; i++)
+  {
+    block[0] = 0x01;
+    block[1] = (uint8_t) i;
+    errors += SecureElementDeriveAndStoreKey(version, block, BENCH_KEY,
+                                             BENCH_DERIVED_KEY) != SECURE_ELEMENT_SUCCESS;
+    errors += SecureElementComputeAesCmac(NULL, buffer, 16, BENCH_DERIVED_KEY, &cmac) != SECURE_ELEMENT_SUCCESS;
+    checksum = (checksum * 31) + cmac;
+  }
+  BenchTrace("KEY_DERIVATION", 16, BenchTime() - start, checksum);
+
+  if (errors != 0)
+  {
+    printf("%u calls failed\n", (unsigned) errors);
+    return 1;
+  }
+  return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Random numbers of the radio
+ */
+static uint32_t BenchRandom(void)
+{
+  return (uint32_t) rand();
+}
+
+/**
+ * @brief  Host monotonic time, ns
+ */
+static uint64_t BenchTime(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/**
+ * @brief  Prints the time per call and the checksum of a path
+ */
+static void BenchTrace(const char *path, uint16_t size, uint64_t time, uint32_t checksum)
+{
+  printf("%-14s %3u %10.1f  %08X\n", path, (unsigned) size, (double) time / BENCH_CALLS, (unsigned) checksum);
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,311 @@
+/**
+  ******************************************************************************
+  * @file    sim_flash.c
+  * @author  MCD Application Team
+  * @brief   File-backed flash of the host Secure Engine programs, with a
+  *          programming thread for the writes started and waited
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sim_flash.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * Write handed over to the programming thread
+ */
+typedef struct
+{
+  uint32_t Address;
+  const uint8_t *Source;
+  uint32_t Length;
+  bool Pending;                    /* started and not programmed yet */
+  bool Waited;                     /* programmed and not waited yet */
+  SE_ErrorStatus Status;
+} SimFlash_Write_t;
+
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static int Fd = -1;
+
+static uint32_t FlashSize;
+
+static uint32_t DoubleWordTime;
+
+static SimFlash_Stats_t Stats;
+
+static pthread_t Thread;
+static pthread_mutex_t Lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t Started = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t Done = PTHREAD_COND_INITIALIZER;
+static bool Stop;
+
+static SimFlash_Write_t Write;
+
+/* Private function prototypes -----------------------------------------------*/
+static void *SimFlash_Thread(void *Arg);
+
+static SE_ErrorStatus SimFlash_Check(uint32_t Address, uint32_t Length);
+
+static SE_ErrorStatus SimFlash_Program(uint32_t Address, const uint8_t *Source, uint32_t Length);
+
+/* Exported functions ---------------------------------------------------------*/
+int32_t SimFlash_Init(uint32_t Size, uint32_t ProgramTime)
+{
+  char path[] = "/tmp/sim_flash_XXXXXX";
+
+  Fd = mkstemp(path);
+  if (Fd < 0)
+  {
+    return -1;
+  }
+  unlink(path);
+  FlashSize = Size;
+  DoubleWordTime = ProgramTime;
+  SimFlash_Erase();
+  memset(&Stats, 0, sizeof(Stats));
+  memset(&Write, 0, sizeof(Write));
+  Stop = false;
+  if (pthread_create(&Thread, NULL, SimFlash_Thread, NULL) != 0)
+  {
+    close(Fd);
+    Fd = -1;
+    return -1;
+  }
+  return 0;
+}
+
+void SimFlash_DeInit(void)
+{
+  pthread_mutex_lock(&Lock);
+  Stop = true;
+  pthread_cond_signal(&Started);
+  pthread_mutex_unlock(&Lock);
+  pthread_join(Thread, NULL);
+  close(Fd);
+  Fd = -1;
+}
+
+void SimFlash_Erase(void)
+{
+  uint8_t erased[4096];
+
+  memset(erased, 0xFF, sizeof(erased));
+  for (uint32_t offset = 0; offset < FlashSize; offset += sizeof(erased))
+  {
+    uint32_t length = FlashSize - offset;
+
+    if (length > sizeof(erased))
+    {
+      length = sizeof(erased);
+    }
+    if (pwrite(Fd, erased, length, offset) != (ssize_t) length)
+    {
+      perror("flash erase");
+    }
+  }
+}
+
+int32_t SimFlash_Read(uint32_t Address, void *Buffer, uint32_t Length)
+{
+  if ((Address < SIM_FLASH_BASE) || (Address - SIM_FLASH_BASE > FlashSize)
+      || (Length > FlashSize - (Address - SIM_FLASH_BASE)))
+  {
+    return -1;
+  }
+  return (pread(Fd, Buffer, Length, Address - SIM_FLASH_BASE) == (ssize_t) Length) ? 0 : -1;
+}
+
+SE_ErrorStatus SimFlash_WriteStart(void *pDestination, const void *pSource, uint32_t Length)
+{
+  uint32_t address = (uint32_t)(uintptr_t) pDestination;
+
+  pthread_mutex_lock(&Lock);
+  Stats.Writes++;
+  /* A single write is programmed at once */
+  if (Write.Pending || Write.Waited || (SimFlash_Check(address, Length) != SE_SUCCESS))
+  {
+    Stats.Errors++;
+    pthread_mutex_unlock(&Lock);
+    return SE_ERROR;
+  }
+  Write.Address = address;
+  Write.Source = pSource;
+  Write.Length = Length;
+  Write.Pending = true;
+  pthread_cond_signal(&Started);
+  pthread_mutex_unlock(&Lock);
+  return SE_SUCCESS;
+}
+
+SE_ErrorStatus SimFlash_WriteWait(void)
+{
+  SE_ErrorStatus status;
+
+  pthread_mutex_lock(&Lock);
+  while (Write.Pending)
+  {
+    pthread_cond_wait(&Done, &Lock);
+  }
+  if (Write.Waited)
+  {
+    Write.Waited = false;
+    status = Write.Status;
+  }
+  else
+  {
+    /* Nothing started */
+    Stats.Errors++;
+    status = SE_ERROR;
+  }
+  pthread_mutex_unlock(&Lock);
+  return status;
+}
+
+SE_ErrorStatus SimFlash_Write(void *pDestination, const void *pSource, uint32_t Length)
+{
+  uint32_t address = (uint32_t)(uintptr_t) pDestination;
+  SE_ErrorStatus status;
+
+  pthread_mutex_lock(&Lock);
+  Stats.Writes++;
+  status = SimFlash_Check(address, Length);
+  if (status != SE_SUCCESS)
+  {
+    Stats.Errors++;
+  }
+  pthread_mutex_unlock(&Lock);
+  if (status == SE_SUCCESS)
+  {
+    status = SimFlash_Program(address, pSource, Length);
+  }
+  return status;
+}
+
+SE_ErrorStatus SimFlash_WriteNone(void)
+{
+  return SE_SUCCESS;
+}
+
+SimFlash_Stats_t SimFlash_GetStats(bool Reset)
+{
+  SimFlash_Stats_t stats;
+
+  pthread_mutex_lock(&Lock);
+  stats = Stats;
+  if (Reset)
+  {
+    memset(&Stats, 0, sizeof(Stats));
+  }
+  pthread_mutex_unlock(&Lock);
+  return stats;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Programming thread, one write at a time
+ */
+static void *SimFlash_Thread(void *Arg)
+{
+  pthread_mutex_lock(&Lock);
+  while (!Stop)
+  {
+    if (!Write.Pending)
+    {
+      pthread_cond_wait(&Started, &Lock);
+      continue;
+    }
+    pthread_mutex_unlock(&Lock);
+    Write.Status = SimFlash_Program(Write.Address, Write.Source, Write.Length);
+    pthread_mutex_lock(&Lock);
+    Write.Pending = false;
+    Write.Waited = true;
+    pthread_cond_signal(&Done);
+  }
+  pthread_mutex_unlock(&Lock);
+  return NULL;
+}
+
+/**
+ * @brief  Checks the destination of a write: in the flash and aligned on a
+ *         double word
+ */
+static SE_ErrorStatus SimFlash_Check(uint32_t Address, uint32_t Length)
+{
+  if ((Length == 0) || (Address < SIM_FLASH_BASE) || (Address - SIM_FLASH_BASE > FlashSize)
+      || (Length > FlashSize - (Address - SIM_FLASH_BASE)) || ((Address % SIM_FLASH_DOUBLE_WORD) != 0))
+  {
+    return SE_ERROR;
+  }
+  return SE_SUCCESS;
+}
+
+/**
+ * @brief  Sleeps the programming time, then programs the source as it is at
+ *         the end of the programming time, on erased bytes only
+ */
+static SE_ErrorStatus SimFlash_Program(uint32_t Address, const uint8_t *Source, uint32_t Length)
+{
+  uint64_t time = (uint64_t) DoubleWordTime * ((Length + SIM_FLASH_DOUBLE_WORD - 1) / SIM_FLASH_DOUBLE_WORD);
+  struct timespec sleep = { (time_t)(time / 1000000000ULL), (long)(time % 1000000000ULL) };
+  uint8_t current[256];
+  uint32_t offset = Address - SIM_FLASH_BASE;
+
+  while (nanosleep(&sleep, &sleep) != 0)
+  {
+  }
+
+  for (uint32_t done = 0; done < Length; done += sizeof(current))
+  {
+    uint32_t length = Length - done;
+
+    if (length > sizeof(current))
+    {
+      length = sizeof(current);
+    }
+    if (pread(Fd, current, length, offset + done) != (ssize_t) length)
+    {
+      return SE_ERROR;
+    }
+    for (uint32_t i = 0; i < length; i++)
+    {
+      if (current[i] != 0xFF)
+      {
+        pthread_mutex_lock(&Lock);
+        Stats.Errors++;
+        pthread_mutex_unlock(&Lock);
+        return SE_ERROR;
+      }
+    }
+    if (pwrite(Fd, &Source[done], length, offset + done) != (ssize_t) length)
+    {
+      return SE_ERROR;
+    }
+  }
+  pthread_mutex_lock(&Lock);
+  Stats.Bytes += Length;
+  pthread_mutex_unlock(&Lock);
+  return SE_SUCCESS;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,109 @@
+/**
+  ******************************************************************************
+  * @file    sim_l4_cryp.c
+  * @author  MCD Application Team
+  * @brief   Simulated AES peripheral and SRAM2 write protection behind the
+  *          host replacement of the STM32L4 HAL used by stm32l4-se.c
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+#include "stm32l4xx_hal.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+AES_TypeDef SimAesRegisters;
+
+SYSCFG_TypeDef SimSyscfgRegisters;
+
+static uint32_t KeyLoads = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+/* Exported functions ---------------------------------------------------------*/
+HAL_StatusTypeDef HAL_CRYP_Init(CRYP_HandleTypeDef *hcryp)
+{
+  if ((hcryp->Instance != AES) || (hcryp->Init.pKey == NULL) || (hcryp->Init.KeySize != CRYP_KEYSIZE_128B))
+  {
+    return HAL_ERROR;
+  }
+  if (hcryp->Init.ChainingMode == CRYP_CHAINMODE_AES_CTR)
+  {
+    if (hcryp->Init.pInitVect == NULL)
+    {
+      return HAL_ERROR;
+    }
+    memcpy(hcryp->Counter, hcryp->Init.pInitVect, sizeof(hcryp->Counter));
+  }
+  memset(&hcryp->Context, 0, sizeof(hcryp->Context));
+  aes_set_key(hcryp->Init.pKey, 16, &hcryp->Context);
+  hcryp->State = HAL_CRYP_STATE_READY;
+  KeyLoads++;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CRYP_DeInit(CRYP_HandleTypeDef *hcryp)
+{
+  memset(&hcryp->Context, 0, sizeof(hcryp->Context));
+  memset(hcryp->Counter, 0, sizeof(hcryp->Counter));
+  hcryp->State = HAL_CRYP_STATE_RESET;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CRYPEx_AES(CRYP_HandleTypeDef *hcryp, uint8_t *pInputData, uint16_t Size,
+                                 uint8_t *pOutputData, uint32_t Timeout)
+{
+  uint8_t block[16];
+
+  if ((hcryp->State != HAL_CRYP_STATE_READY) || ((Size % 16) != 0))
+  {
+    return HAL_ERROR;
+  }
+  for (uint16_t offset = 0; offset < Size; offset += 16)
+  {
+    if (hcryp->Init.ChainingMode == CRYP_CHAINMODE_AES_CTR)
+    {
+      /* 32-bit counter in the last word of the block, as the peripheral */
+      aes_encrypt(hcryp->Counter, block, &hcryp->Context);
+      for (uint8_t i = 0; i < 16; i++)
+      {
+        pOutputData[offset + i] = pInputData[offset + i] ^ block[i];
+      }
+      for (int8_t i = 15; (i >= 12) && (++hcryp->Counter[i] == 0); i--)
+      {
+      }
+    }
+    else
+    {
+      memcpy(block, &pInputData[offset], 16);
+      aes_encrypt(block, &pOutputData[offset], &hcryp->Context);
+    }
+  }
+  return HAL_OK;
+}
+
+void SimL4_Reset(void)
+{
+  SimSyscfgRegisters.SWPR = 0;
+}
+
+uint32_t SimL4_GetKeyLoads(void)
+{
+  return KeyLoads;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
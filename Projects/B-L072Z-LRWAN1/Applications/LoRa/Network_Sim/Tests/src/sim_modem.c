@@ -0,0 +1,379 @@
+/**
+  ******************************************************************************
+  * @file    sim_modem.c
+  * @author  MCD Application Team
+  * @brief   Simulated external modem: the UART link, its reception DMA, the
+  *          tick and the timer server of the AT master on the simulated time
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "stm32l0xx_hal.h"
+#include "hw_usart.h"
+#include "timeServer.h"
+#include "sim_modem.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define SIM_MODEM_LINK_SIZE          4096    /* characters sent by the modem, not received yet */
+
+#define SIM_MODEM_CMD_SIZE           512     /* longest command */
+
+#define SIM_MODEM_TIMER_NB           8       /* timers started at the same time */
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static USART_TypeDef Usart1;
+static USART_TypeDef Usart2;
+
+static DMA_Channel_TypeDef DmaRx1;
+static DMA_Channel_TypeDef DmaRx2;
+
+static DMA_HandleTypeDef hdma_usart1_rx = { &DmaRx1, { DMA_NORMAL } };
+static DMA_HandleTypeDef hdma_usart2_rx = { &DmaRx2, { DMA_NORMAL } };
+
+UART_HandleTypeDef huart1 = { &Usart1, NULL, 0, &hdma_usart1_rx, HAL_UART_STATE_READY, HAL_UART_STATE_READY };
+UART_HandleTypeDef huart2 = { &Usart2, NULL, 0, &hdma_usart2_rx, HAL_UART_STATE_READY, HAL_UART_STATE_READY };
+
+static SimModem_OnCommand_t OnCommand = NULL;
+
+static uint32_t Now = 0;                           /* ms */
+
+/* Modem to MCU */
+static char Link[SIM_MODEM_LINK_SIZE];
+static uint32_t LinkHead = 0;
+static uint32_t LinkTail = 0;
+
+static UART_HandleTypeDef *RxUart = NULL;          /* reception by DMA in progress */
+
+/* MCU to modem */
+static char Cmd[SIM_MODEM_CMD_SIZE + 1];
+static uint16_t CmdLen = 0;
+static UART_HandleTypeDef *TxUart = NULL;          /* interrupt transmission in progress */
+static uint32_t TxRemaining = 0;                   /* ms */
+
+static TimerEvent_t *Timers[SIM_MODEM_TIMER_NB];
+
+/* Private function prototypes -----------------------------------------------*/
+static void SimModem_ReceiveCommand(uint8_t *pData, uint16_t Size);
+static void SimModem_StepLink(void);
+static void SimModem_StepTimers(void);
+
+/* Exported functions ------------------------------------------------------- */
+void SimModem_Init(SimModem_OnCommand_t Callback)
+{
+  OnCommand = Callback;
+  Now = 0;
+  LinkHead = 0;
+  LinkTail = 0;
+  RxUart = NULL;
+  TxUart = NULL;
+  TxRemaining = 0;
+  memset(Timers, 0, sizeof(Timers));
+  huart1.gState = HAL_UART_STATE_READY;
+  huart1.RxState = HAL_UART_STATE_READY;
+  huart2.gState = HAL_UART_STATE_READY;
+  huart2.RxState = HAL_UART_STATE_READY;
+}
+
+void SimModem_Send(const char *Data, uint16_t Len)
+{
+  uint16_t i;
+
+  for (i = 0; (i < Len) && (LinkHead - LinkTail < SIM_MODEM_LINK_SIZE); i++)
+  {
+    Link[LinkHead++ % SIM_MODEM_LINK_SIZE] = Data[i];
+  }
+}
+
+void SimModem_SendString(const char *Text)
+{
+  SimModem_Send(Text, strlen(Text));
+}
+
+void SimModem_RxError(void)
+{
+  if (RxUart != NULL)
+  {
+    RxUart->RxState = HAL_UART_STATE_READY;
+    RxUart = NULL;
+  }
+}
+
+void SimModem_Step(uint32_t Ms)
+{
+  while (Ms-- != 0)
+  {
+    Now++;
+    SimModem_StepLink();
+    SimModem_StepTimers();
+  }
+}
+
+uint32_t SimModem_GetTime(void)
+{
+  return Now;
+}
+
+/* HAL ---------------------------------------------------------------------- */
+uint32_t HAL_GetTick(void)
+{
+  return Now;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+  SimModem_Step(Delay);
+}
+
+void HAL_PWR_EnterSLEEPMode(uint32_t Regulator, uint8_t SLEEPEntry)
+{
+  /* Woken up by the next tick at the latest */
+  SimModem_Step(1);
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+  if ((huart->gState != HAL_UART_STATE_READY) || (Size > SIM_MODEM_CMD_SIZE))
+  {
+    return HAL_BUSY;
+  }
+  SimModem_Step((Size + SIM_MODEM_CHARS_PER_MS - 1) / SIM_MODEM_CHARS_PER_MS);
+  SimModem_ReceiveCommand(pData, Size);
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+  if ((huart->gState != HAL_UART_STATE_READY) || (Size > SIM_MODEM_CMD_SIZE))
+  {
+    return HAL_BUSY;
+  }
+  /* Copied at once, the modem gets the command once it is transmitted */
+  memcpy(Cmd, pData, Size);
+  CmdLen = Size;
+  TxUart = huart;
+  TxRemaining = (Size + SIM_MODEM_CHARS_PER_MS - 1) / SIM_MODEM_CHARS_PER_MS;
+  huart->gState = HAL_UART_STATE_BUSY_TX;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+  /* The characters are read one by one with HW_UART_Modem_GetNewChar */
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+  if ((RxUart != NULL) && (RxUart != huart))
+  {
+    return HAL_BUSY;
+  }
+  huart->pRxBuffPtr = pData;
+  huart->RxXferSize = Size;
+  huart->hdmarx->Instance->CNDTR = Size;
+  huart->RxState = HAL_UART_STATE_BUSY_RX;
+  RxUart = huart;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_DMAStop(UART_HandleTypeDef *huart)
+{
+  huart->RxState = HAL_UART_STATE_READY;
+  if (RxUart == huart)
+  {
+    RxUart = NULL;
+  }
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart)
+{
+  return HAL_UART_DMAStop(huart);
+}
+
+void HAL_UART_MspDeInit(UART_HandleTypeDef *huart)
+{
+}
+
+HAL_StatusTypeDef HW_UART_Modem_Init(uint32_t BaudRate)
+{
+  return HAL_OK;
+}
+
+FlagStatus HW_UART_Modem_IsNewCharReceived(void)
+{
+  if (LinkHead == LinkTail)
+  {
+    SimModem_Step(1);
+  }
+  return ((RxUart == NULL) && (LinkHead != LinkTail)) ? SET : RESET;
+}
+
+uint8_t HW_UART_Modem_GetNewChar(void)
+{
+  return (uint8_t)Link[LinkTail++ % SIM_MODEM_LINK_SIZE];
+}
+
+/* Timer server ------------------------------------------------------------- */
+void TimerInit(TimerEvent_t *obj, void (*callback)(void *context))
+{
+  memset(obj, 0, sizeof(TimerEvent_t));
+  obj->Callback = callback;
+}
+
+void TimerSetContext(TimerEvent_t *obj, void *context)
+{
+  obj->Context = context;
+}
+
+void TimerSetValue(TimerEvent_t *obj, uint32_t value)
+{
+  obj->ReloadValue = value;
+}
+
+void TimerStart(TimerEvent_t *obj)
+{
+  int i;
+  int free = -1;
+
+  obj->Timestamp = Now + obj->ReloadValue;
+  obj->IsStarted = true;
+  for (i = 0; i < SIM_MODEM_TIMER_NB; i++)
+  {
+    if (Timers[i] == obj)
+    {
+      return;
+    }
+    if ((Timers[i] == NULL) && (free < 0))
+    {
+      free = i;
+    }
+  }
+  if (free >= 0)
+  {
+    Timers[free] = obj;
+  }
+}
+
+void TimerStop(TimerEvent_t *obj)
+{
+  int i;
+
+  obj->IsStarted = false;
+  for (i = 0; i < SIM_MODEM_TIMER_NB; i++)
+  {
+    if (Timers[i] == obj)
+    {
+      Timers[i] = NULL;
+    }
+  }
+}
+
+bool TimerIsStarted(TimerEvent_t *obj)
+{
+  return obj->IsStarted;
+}
+
+TimerTime_t TimerGetCurrentTime(void)
+{
+  return Now;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Hands a command to the modem behaviour
+ * @param  pData command
+ * @param  Size command length
+ * @retval None
+ */
+static void SimModem_ReceiveCommand(uint8_t *pData, uint16_t Size)
+{
+  memmove(Cmd, pData, Size);
+  Cmd[Size] = '\0';
+  if (OnCommand != NULL)
+  {
+    OnCommand(Cmd, Size);
+  }
+}
+
+/**
+ * @brief  Carries the characters of one ms on the link, both ways
+ * @param  None
+ * @retval None
+ */
+static void SimModem_StepLink(void)
+{
+  DMA_Channel_TypeDef *dma;
+  int i;
+
+  if ((TxUart != NULL) && (--TxRemaining == 0))
+  {
+    TxUart->gState = HAL_UART_STATE_READY;
+    TxUart = NULL;
+    SimModem_ReceiveCommand((uint8_t *)Cmd, CmdLen);
+  }
+
+  if (RxUart == NULL)
+  {
+    return;
+  }
+  dma = RxUart->hdmarx->Instance;
+  for (i = 0; (i < SIM_MODEM_CHARS_PER_MS) && (LinkTail != LinkHead); i++)
+  {
+    RxUart->pRxBuffPtr[RxUart->RxXferSize - dma->CNDTR] = Link[LinkTail++ % SIM_MODEM_LINK_SIZE];
+    if (--dma->CNDTR == 0)
+    {
+      /* Circular mode */
+      dma->CNDTR = RxUart->RxXferSize;
+    }
+    if (LinkTail == LinkHead)
+    {
+      RxUart->Instance->ISR |= UART_FLAG_IDLE;
+    }
+  }
+}
+
+/**
+ * @brief  Fires the timers expired at the current time
+ * @param  None
+ * @retval None
+ */
+static void SimModem_StepTimers(void)
+{
+  TimerEvent_t *timer;
+  int i;
+
+  for (i = 0; i < SIM_MODEM_TIMER_NB; i++)
+  {
+    timer = Timers[i];
+    if ((timer != NULL) && ((int32_t)(Now - timer->Timestamp) >= 0))
+    {
+      Timers[i] = NULL;
+      timer->IsStarted = false;
+      timer->Callback(timer->Context);
+    }
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,285 @@
+/**
+  ******************************************************************************
+  * @file    sim_rtc_hal.c
+  * @author  MCD Application Team
+  * @brief   Simulated RTC behind the host replacement of the RTC HAL, the
+  *          interrupt mask of the core and the low power manager calls of the
+  *          End_Node RTC driver
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "hw_conf.h"
+#include "low_power_manager.h"
+#include "sim_rtc_hal.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define SIM_RTC_EPOCH                ((time_t) 946684800)    /* 01/01/2000 in Unix time */
+
+#define SIM_RTC_BKP_NB               2
+
+/* Private macro -------------------------------------------------------------*/
+#define BIN2BCD(x)                   ((uint32_t)((((x) / 10) << 4) | ((x) % 10)))
+
+/* Private variables ---------------------------------------------------------*/
+RTC_TypeDef SimRtcRegisters;
+
+static uint64_t Tick = 0;
+
+static uint32_t StepOnRead = 0;
+static uint32_t Reads = 0;
+
+static SimRtc_Handler_t IrqOnRead = NULL;
+static bool InIrq = false;
+
+static uint32_t PriMask = 0;
+static uint32_t IrqMasks = 0;
+
+static RTC_AlarmTypeDef Alarm;
+
+static uint32_t Bkp[SIM_RTC_BKP_NB];
+
+static LPM_GetMode_t LpmMode = LPM_StopMode;
+
+/* Private function prototypes -----------------------------------------------*/
+static void SimRtc_Update(void);
+
+static void SimRtc_GetCalendar(struct tm *Calendar);
+
+/* Exported functions ---------------------------------------------------------*/
+void SimRtc_Set(uint64_t NewTick)
+{
+  Tick = NewTick;
+  Reads = 0;
+  SimRtc_Update();
+}
+
+uint64_t SimRtc_Get(void)
+{
+  return Tick;
+}
+
+void SimRtc_SetStepOnRead(uint32_t NewReads)
+{
+  StepOnRead = NewReads;
+  Reads = 0;
+}
+
+void SimRtc_SetIrqOnRead(SimRtc_Handler_t Handler)
+{
+  IrqOnRead = Handler;
+}
+
+const RTC_AlarmTypeDef *SimRtc_GetAlarm(void)
+{
+  return &Alarm;
+}
+
+uint32_t SimRtc_GetIrqMasks(void)
+{
+  return IrqMasks;
+}
+
+/* LL RTC --------------------------------------------------------------------*/
+uint32_t LL_RTC_TIME_Get_SubSecond(RTC_TypeDef *RTCx)
+{
+  uint32_t ssr = RTCx->SSR;
+
+  if ((StepOnRead != 0) && (++Reads >= StepOnRead))
+  {
+    Reads = 0;
+    Tick++;
+    SimRtc_Update();
+  }
+  if ((IrqOnRead != NULL) && (PriMask == 0) && (InIrq == false))
+  {
+    InIrq = true;
+    IrqOnRead();
+    InIrq = false;
+  }
+  return ssr;
+}
+
+uint32_t LL_RTC_TIME_Get(RTC_TypeDef *RTCx)
+{
+  return RTCx->TR & ~RTC_TR_PM;
+}
+
+/* HAL RTC -------------------------------------------------------------------*/
+HAL_StatusTypeDef HAL_RTC_Init(RTC_HandleTypeDef *hrtc)
+{
+  SimRtc_Update();
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RTC_SetTime(RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *sTime, uint32_t Format)
+{
+  uint64_t midnight = Tick - (Tick % (SIM_RTC_TICKS_PER_SECOND * 86400ULL));
+
+  Tick = midnight + (((uint64_t) sTime->Hours * 3600 + sTime->Minutes * 60 + sTime->Seconds) *
+                     SIM_RTC_TICKS_PER_SECOND);
+  SimRtc_Update();
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RTC_GetTime(RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *sTime, uint32_t Format)
+{
+  struct tm calendar;
+
+  SimRtc_GetCalendar(&calendar);
+  sTime->Hours = calendar.tm_hour;
+  sTime->Minutes = calendar.tm_min;
+  sTime->Seconds = calendar.tm_sec;
+  sTime->TimeFormat = RTC_HOURFORMAT12_AM;
+  sTime->SubSeconds = SimRtcRegisters.SSR;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RTC_SetDate(RTC_HandleTypeDef *hrtc, RTC_DateTypeDef *sDate, uint32_t Format)
+{
+  struct tm calendar;
+  uint64_t dayTicks = SIM_RTC_TICKS_PER_SECOND * 86400ULL;
+
+  memset(&calendar, 0, sizeof(calendar));
+  calendar.tm_year = sDate->Year + 100;
+  calendar.tm_mon = sDate->Month - 1;
+  calendar.tm_mday = sDate->Date;
+  Tick = (uint64_t)(timegm(&calendar) - SIM_RTC_EPOCH) * SIM_RTC_TICKS_PER_SECOND + (Tick % dayTicks);
+  SimRtc_Update();
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RTC_GetDate(RTC_HandleTypeDef *hrtc, RTC_DateTypeDef *sDate, uint32_t Format)
+{
+  struct tm calendar;
+
+  SimRtc_GetCalendar(&calendar);
+  sDate->Year = calendar.tm_year - 100;
+  sDate->Month = calendar.tm_mon + 1;
+  sDate->Date = calendar.tm_mday;
+  sDate->WeekDay = (calendar.tm_wday == 0) ? 7 : calendar.tm_wday;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RTC_SetAlarm_IT(RTC_HandleTypeDef *hrtc, RTC_AlarmTypeDef *sAlarm, uint32_t Format)
+{
+  Alarm = *sAlarm;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RTC_GetAlarm(RTC_HandleTypeDef *hrtc, RTC_AlarmTypeDef *sAlarm, uint32_t AlarmId,
+                                   uint32_t Format)
+{
+  *sAlarm = Alarm;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RTC_DeactivateAlarm(RTC_HandleTypeDef *hrtc, uint32_t AlarmId)
+{
+  return HAL_OK;
+}
+
+void HAL_RTC_AlarmAEventCallback(RTC_HandleTypeDef *hrtc)
+{
+}
+
+HAL_StatusTypeDef HAL_RTCEx_EnableBypassShadow(RTC_HandleTypeDef *hrtc)
+{
+  return HAL_OK;
+}
+
+void HAL_RTCEx_BKUPWrite(RTC_HandleTypeDef *hrtc, uint32_t BackupRegister, uint32_t Data)
+{
+  Bkp[BackupRegister % SIM_RTC_BKP_NB] = Data;
+}
+
+uint32_t HAL_RTCEx_BKUPRead(RTC_HandleTypeDef *hrtc, uint32_t BackupRegister)
+{
+  return Bkp[BackupRegister % SIM_RTC_BKP_NB];
+}
+
+uint32_t HAL_NVIC_GetPendingIRQ(IRQn_Type IRQn)
+{
+  return 0;
+}
+
+/* Core ----------------------------------------------------------------------*/
+uint32_t __get_PRIMASK(void)
+{
+  return PriMask;
+}
+
+void __set_PRIMASK(uint32_t priMask)
+{
+  PriMask = priMask;
+}
+
+void __disable_irq(void)
+{
+  PriMask = 1;
+  IrqMasks++;
+}
+
+void __enable_irq(void)
+{
+  PriMask = 0;
+}
+
+/* Low power manager ---------------------------------------------------------*/
+void LPM_SetStopMode(LPM_Id_t id, LPM_SetMode_t mode)
+{
+  LpmMode = (mode == LPM_Enable) ? LPM_StopMode : LPM_SleepMode;
+}
+
+LPM_GetMode_t LPM_GetMode(void)
+{
+  return LpmMode;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Updates the calendar registers from the tick count
+ */
+static void SimRtc_Update(void)
+{
+  struct tm calendar;
+  uint32_t weekDay;
+
+  SimRtc_GetCalendar(&calendar);
+  weekDay = (calendar.tm_wday == 0) ? 7 : calendar.tm_wday;
+
+  SimRtcRegisters.SSR = (SIM_RTC_TICKS_PER_SECOND - 1) - (uint32_t)(Tick % SIM_RTC_TICKS_PER_SECOND);
+  SimRtcRegisters.TR = (BIN2BCD(calendar.tm_hour) << 16) | (BIN2BCD(calendar.tm_min) << 8) |
+                       BIN2BCD(calendar.tm_sec);
+  SimRtcRegisters.DR = (BIN2BCD(calendar.tm_year - 100) << RTC_DR_YU_Pos) | (weekDay << RTC_DR_WDU_Pos) |
+                       (BIN2BCD(calendar.tm_mon + 1) << RTC_DR_MU_Pos) |
+                       (BIN2BCD(calendar.tm_mday) << RTC_DR_DU_Pos);
+}
+
+/**
+ * @brief  Converts the tick count in calendar
+ */
+static void SimRtc_GetCalendar(struct tm *Calendar)
+{
+  time_t seconds = SIM_RTC_EPOCH + (time_t)(Tick / SIM_RTC_TICKS_PER_SECOND);
+
+  gmtime_r(&seconds, Calendar);
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,501 @@
+/**
+  ******************************************************************************
+  * @file    sim_se.c
+  * @author  MCD Application Team
+  * @brief   Host Secure Engine: call gate and CRYPTO_LL services on mbedTLS,
+  *          AES-GCM, or AES-CBC and SHA256 when SIM_SE_AES_CBC_SHA256 is
+  *          defined, with the arguments and checks of se_callgate.c
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "se_callgate.h"
+#include "sim_se.h"
+#include "mbedtls/platform.h"
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+#include "mbedtls/gcm.h"
+#else
+#include "mbedtls/aes.h"
+#include "mbedtls/sha256.h"
+#endif /* SECBOOT_CRYPTO_SCHEME */
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * Heap block of mbedTLS, its size first, the data aligned as by malloc
+ */
+typedef struct
+{
+  size_t Size;
+  long double Data[];
+} SimSe_Block_t;
+
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Firmware key of the Secure Engine, in SE_CoreBin se_key.c on the target */
+static const uint8_t FwKey[16] =
+{
+  0x4F, 0x55, 0x52, 0x2D, 0x41, 0x45, 0x53, 0x2D, 0x4B, 0x45, 0x59, 0x2D, 0x30, 0x31, 0x32, 0x33
+};
+
+static SimSe_Stats_t Stats;
+
+static uint32_t CryptoTime;
+
+static size_t Heap;
+static size_t PeakHeap;
+
+/* State of the CRYPTO_LL services */
+static SE_FwRawHeaderTypeDef *Metadata;
+static bool DecryptStarted;
+static bool DecryptLastBlock;      /* a partial block ends the firmware */
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+static mbedtls_gcm_context Gcm;
+#else
+static mbedtls_aes_context Aes;
+static uint8_t Iv[16];
+static bool AuthenticateStarted;
+static mbedtls_sha256_context Sha256;
+#endif /* SECBOOT_CRYPTO_SCHEME */
+
+/* Private function prototypes -----------------------------------------------*/
+static void *SimSe_Calloc(size_t Nb, size_t Size);
+static void SimSe_Free(void *Ptr);
+static void SimSe_Spin(uint32_t Bytes);
+
+static SE_ErrorStatus SimSe_DecryptInit(SE_FwRawHeaderTypeDef *pxSE_Metadata, int32_t SE_FwType);
+static SE_ErrorStatus SimSe_DecryptAppend(const uint8_t *pInputBuffer, int32_t InputSize, uint8_t *pOutputBuffer,
+                                          int32_t *pOutputSize);
+static SE_ErrorStatus SimSe_DecryptFinish(uint8_t *pOutputBuffer, int32_t *pOutputSize);
+static SE_ErrorStatus SimSe_AuthenticateInit(SE_FwRawHeaderTypeDef *pxSE_Metadata, int32_t SE_FwType);
+static SE_ErrorStatus SimSe_AuthenticateAppend(const uint8_t *pInputBuffer, int32_t InputSize,
+                                               uint8_t *pOutputBuffer, int32_t *pOutputSize);
+static SE_ErrorStatus SimSe_AuthenticateFinish(uint8_t *pOutputBuffer, int32_t *pOutputSize);
+
+/* Exported functions ---------------------------------------------------------*/
+void SE_EnterSecureMode(void)
+{
+  if (Stats.SecureMode != 0)
+  {
+    Stats.SecureModeErrors++;
+  }
+  Stats.SecureMode = 1;
+}
+
+void SE_ExitSecureMode(void)
+{
+  if (Stats.SecureMode == 0)
+  {
+    Stats.SecureModeErrors++;
+  }
+  Stats.SecureMode = 0;
+}
+
+SE_ErrorStatus SimSe_CallGate(uint32_t ID, SE_StatusTypeDef *peSE_Status, ...)
+{
+  SE_ErrorStatus e_ret_status = SE_ERROR;
+  va_list arguments;
+
+  Stats.CallGates++;
+  if (Stats.SecureMode == 0)
+  {
+    /* Called out of the secure mode */
+    Stats.SecureModeErrors++;
+  }
+  if (peSE_Status == NULL)
+  {
+    return SE_ERROR;
+  }
+  *peSE_Status = SE_KO;
+
+  va_start(arguments, peSE_Status);
+  switch (ID)
+  {
+    case SE_CRYPTO_LL_DECRYPT_INIT_ID:
+    case SE_CRYPTO_LL_AUTHENTICATE_FW_INIT_ID:
+    {
+      SE_FwRawHeaderTypeDef *p_x_se_Metadata = va_arg(arguments, SE_FwRawHeaderTypeDef *);
+      int32_t se_FwType = va_arg(arguments, int32_t);
+
+      if (p_x_se_Metadata == NULL)
+      {
+        break;
+      }
+      if ((se_FwType != SE_FW_IMAGE_COMPLETE) && (se_FwType != SE_FW_IMAGE_PARTIAL))
+      {
+        break;
+      }
+      e_ret_status = (ID == SE_CRYPTO_LL_DECRYPT_INIT_ID) ? SimSe_DecryptInit(p_x_se_Metadata, se_FwType)
+                     : SimSe_AuthenticateInit(p_x_se_Metadata, se_FwType);
+      break;
+    }
+
+    case SE_CRYPTO_LL_DECRYPT_APPEND_ID:
+    case SE_CRYPTO_LL_AUTHENTICATE_FW_APPEND_ID:
+    {
+      const uint8_t *input_buffer = va_arg(arguments, const uint8_t *);
+      int32_t input_size = va_arg(arguments, int32_t);
+      uint8_t *output_buffer = va_arg(arguments, uint8_t *);
+      int32_t *output_size = va_arg(arguments, int32_t *);
+
+      if ((input_size <= 0) || (input_buffer == NULL) || (output_buffer == NULL) || (output_size == NULL))
+      {
+        break;
+      }
+      e_ret_status = (ID == SE_CRYPTO_LL_DECRYPT_APPEND_ID)
+                     ? SimSe_DecryptAppend(input_buffer, input_size, output_buffer, output_size)
+                     : SimSe_AuthenticateAppend(input_buffer, input_size, output_buffer, output_size);
+      break;
+    }
+
+    case SE_CRYPTO_LL_DECRYPT_FINISH_ID:
+    case SE_CRYPTO_LL_AUTHENTICATE_FW_FINISH_ID:
+    {
+      uint8_t *output_buffer = va_arg(arguments, uint8_t *);
+      int32_t *output_size = va_arg(arguments, int32_t *);
+
+      if ((output_buffer == NULL) || (output_size == NULL))
+      {
+        break;
+      }
+      e_ret_status = (ID == SE_CRYPTO_LL_DECRYPT_FINISH_ID) ? SimSe_DecryptFinish(output_buffer, output_size)
+                     : SimSe_AuthenticateFinish(output_buffer, output_size);
+      if (e_ret_status != SE_SUCCESS)
+      {
+        *peSE_Status = SE_SIGNATURE_ERR;
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+  va_end(arguments);
+
+  if (e_ret_status == SE_SUCCESS)
+  {
+    *peSE_Status = SE_OK;
+  }
+  return e_ret_status;
+}
+
+int32_t SimSe_EncryptImage(const uint8_t *Clear, uint32_t Size, SE_FwRawHeaderTypeDef *Metadata, uint8_t *Encrypted)
+{
+  int32_t ret = 0;
+
+  memset(Metadata, 0, sizeof(*Metadata));
+  Metadata->FwVersion = 1;
+  Metadata->FwSize = Size;
+  for (uint32_t i = 0; i < SE_NONCE_LEN; i++)
+  {
+    Metadata->Nonce[i] = (uint8_t) rand();
+  }
+  mbedtls_platform_set_calloc_free(SimSe_Calloc, SimSe_Free);
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+  mbedtls_gcm_context gcm;
+
+  mbedtls_gcm_init(&gcm);
+  if ((mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, FwKey, 128) != 0)
+      || (mbedtls_gcm_crypt_and_tag(&gcm, MBEDTLS_GCM_ENCRYPT, Size, Metadata->Nonce, SE_NONCE_LEN, NULL, 0,
+                                    Clear, Encrypted, SE_TAG_LEN, Metadata->FwTag) != 0))
+  {
+    ret = -1;
+  }
+  mbedtls_gcm_free(&gcm);
+#else
+  mbedtls_aes_context aes;
+  uint8_t iv[16];
+
+  if ((Size % 16) != 0)
+  {
+    return -1;
+  }
+  memcpy(iv, Metadata->Nonce, sizeof(iv));
+  mbedtls_aes_init(&aes);
+  if ((mbedtls_aes_setkey_enc(&aes, FwKey, 128) != 0)
+      || (mbedtls_aes_crypt_cbc(&aes, MBEDTLS_AES_ENCRYPT, Size, iv, Clear, Encrypted) != 0)
+      || (mbedtls_sha256_ret(Clear, Size, Metadata->FwTag, 0) != 0))
+  {
+    ret = -1;
+  }
+  mbedtls_aes_free(&aes);
+#endif /* SECBOOT_CRYPTO_SCHEME */
+  return ret;
+}
+
+void SimSe_SetCryptoTime(uint32_t NsPerByte)
+{
+  CryptoTime = NsPerByte;
+}
+
+SimSe_Stats_t SimSe_GetStats(bool Reset)
+{
+  SimSe_Stats_t stats = Stats;
+
+  if (Reset)
+  {
+    memset(&Stats, 0, sizeof(Stats));
+    Stats.SecureMode = stats.SecureMode;
+  }
+  return stats;
+}
+
+uint32_t SimSe_GetPeakHeap(void)
+{
+  uint32_t peak = (uint32_t) PeakHeap;
+
+  PeakHeap = Heap;
+  return peak;
+}
+
+uint32_t SimSe_GetContextSize(void)
+{
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+  return sizeof(Gcm);
+#else
+  return sizeof(Aes) + sizeof(Iv) + sizeof(Sha256);
+#endif /* SECBOOT_CRYPTO_SCHEME */
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Heap of mbedTLS, counted
+ */
+static void *SimSe_Calloc(size_t Nb, size_t Size)
+{
+  SimSe_Block_t *block;
+
+  if ((Size != 0) && (Nb > (SIZE_MAX - sizeof(SimSe_Block_t)) / Size))
+  {
+    return NULL;
+  }
+  block = calloc(1, sizeof(SimSe_Block_t) + Nb * Size);
+  if (block == NULL)
+  {
+    return NULL;
+  }
+  block->Size = Nb * Size;
+  Heap += block->Size;
+  if (Heap > PeakHeap)
+  {
+    PeakHeap = Heap;
+  }
+  return block->Data;
+}
+
+static void SimSe_Free(void *Ptr)
+{
+  SimSe_Block_t *block;
+
+  if (Ptr == NULL)
+  {
+    return;
+  }
+  block = (SimSe_Block_t *)((uint8_t *) Ptr - offsetof(SimSe_Block_t, Data));
+  Heap -= block->Size;
+  free(block);
+}
+
+/**
+ * @brief  Busy time of the target CPU on a number of bytes
+ */
+static void SimSe_Spin(uint32_t Bytes)
+{
+  struct timespec start;
+  struct timespec now;
+  uint64_t time = (uint64_t) CryptoTime * Bytes;
+
+  if (time == 0)
+  {
+    return;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  do
+  {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+  } while ((uint64_t)(now.tv_sec - start.tv_sec) * 1000000000ULL + now.tv_nsec - start.tv_nsec < time);
+}
+
+/**
+ * @brief  SE_CRYPTO_Decrypt_Init
+ */
+static SE_ErrorStatus SimSe_DecryptInit(SE_FwRawHeaderTypeDef *pxSE_Metadata, int32_t SE_FwType)
+{
+  mbedtls_platform_set_calloc_free(SimSe_Calloc, SimSe_Free);
+  Metadata = pxSE_Metadata;
+  DecryptStarted = false;
+  DecryptLastBlock = false;
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+  mbedtls_gcm_free(&Gcm);
+  mbedtls_gcm_init(&Gcm);
+  if ((mbedtls_gcm_setkey(&Gcm, MBEDTLS_CIPHER_ID_AES, FwKey, 128) != 0)
+      || (mbedtls_gcm_starts(&Gcm, MBEDTLS_GCM_DECRYPT, Metadata->Nonce, SE_NONCE_LEN, NULL, 0) != 0))
+  {
+    return SE_ERROR;
+  }
+#else
+  mbedtls_aes_free(&Aes);
+  mbedtls_aes_init(&Aes);
+  if (mbedtls_aes_setkey_dec(&Aes, FwKey, 128) != 0)
+  {
+    return SE_ERROR;
+  }
+  memcpy(Iv, Metadata->Nonce, sizeof(Iv));
+#endif /* SECBOOT_CRYPTO_SCHEME */
+  DecryptStarted = true;
+  return SE_SUCCESS;
+}
+
+/**
+ * @brief  SE_CRYPTO_Decrypt_Append: blocks of 16 bytes, but the last one with
+ *         AES-GCM
+ */
+static SE_ErrorStatus SimSe_DecryptAppend(const uint8_t *pInputBuffer, int32_t InputSize, uint8_t *pOutputBuffer,
+                                          int32_t *pOutputSize)
+{
+  if (!DecryptStarted || DecryptLastBlock)
+  {
+    return SE_ERROR;
+  }
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+  DecryptLastBlock = (InputSize % 16) != 0;
+  if (mbedtls_gcm_update(&Gcm, (size_t) InputSize, pInputBuffer, pOutputBuffer) != 0)
+  {
+    return SE_ERROR;
+  }
+#else
+  if (((InputSize % 16) != 0)
+      || (mbedtls_aes_crypt_cbc(&Aes, MBEDTLS_AES_DECRYPT, (size_t) InputSize, Iv, pInputBuffer, pOutputBuffer) != 0))
+  {
+    return SE_ERROR;
+  }
+#endif /* SECBOOT_CRYPTO_SCHEME */
+  SimSe_Spin((uint32_t) InputSize);
+  Stats.DecryptedBytes += (uint32_t) InputSize;
+  *pOutputSize = InputSize;
+  return SE_SUCCESS;
+}
+
+/**
+ * @brief  SE_CRYPTO_Decrypt_Finish: checks the GCM tag, no output
+ */
+static SE_ErrorStatus SimSe_DecryptFinish(uint8_t *pOutputBuffer, int32_t *pOutputSize)
+{
+  SE_ErrorStatus e_ret_status = SE_SUCCESS;
+
+  *pOutputSize = 0;
+  if (!DecryptStarted)
+  {
+    return SE_ERROR;
+  }
+  DecryptStarted = false;
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+  uint8_t tag[SE_TAG_LEN];
+  uint8_t diff = 0;
+
+  if (mbedtls_gcm_finish(&Gcm, tag, sizeof(tag)) != 0)
+  {
+    e_ret_status = SE_ERROR;
+  }
+  for (uint32_t i = 0; i < SE_TAG_LEN; i++)
+  {
+    diff |= tag[i] ^ Metadata->FwTag[i];
+  }
+  if (diff != 0)
+  {
+    e_ret_status = SE_ERROR;
+  }
+  mbedtls_gcm_free(&Gcm);
+#else
+  mbedtls_aes_free(&Aes);
+#endif /* SECBOOT_CRYPTO_SCHEME */
+  return e_ret_status;
+}
+
+/**
+ * @brief  SE_CRYPTO_AuthenticateFW_Init: SHA256 of the clear firmware, the
+ *         AES-GCM scheme authenticates while decrypting
+ */
+static SE_ErrorStatus SimSe_AuthenticateInit(SE_FwRawHeaderTypeDef *pxSE_Metadata, int32_t SE_FwType)
+{
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+  return SE_ERROR;
+#else
+  Metadata = pxSE_Metadata;
+  mbedtls_sha256_init(&Sha256);
+  AuthenticateStarted = mbedtls_sha256_starts_ret(&Sha256, 0) == 0;
+  return AuthenticateStarted ? SE_SUCCESS : SE_ERROR;
+#endif /* SECBOOT_CRYPTO_SCHEME */
+}
+
+/**
+ * @brief  SE_CRYPTO_AuthenticateFW_Append, no output
+ */
+static SE_ErrorStatus SimSe_AuthenticateAppend(const uint8_t *pInputBuffer, int32_t InputSize,
+                                               uint8_t *pOutputBuffer, int32_t *pOutputSize)
+{
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+  return SE_ERROR;
+#else
+  if (!AuthenticateStarted || (mbedtls_sha256_update_ret(&Sha256, pInputBuffer, (size_t) InputSize) != 0))
+  {
+    return SE_ERROR;
+  }
+  Stats.AuthenticatedBytes += (uint32_t) InputSize;
+  *pOutputSize = 0;
+  return SE_SUCCESS;
+#endif /* SECBOOT_CRYPTO_SCHEME */
+}
+
+/**
+ * @brief  SE_CRYPTO_AuthenticateFW_Finish: outputs the SHA256 of the clear
+ *         firmware and checks it against the firmware tag
+ */
+static SE_ErrorStatus SimSe_AuthenticateFinish(uint8_t *pOutputBuffer, int32_t *pOutputSize)
+{
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+  *pOutputSize = 0;
+  return SE_ERROR;
+#else
+  uint8_t diff = 0;
+
+  *pOutputSize = 0;
+  if (!AuthenticateStarted)
+  {
+    return SE_ERROR;
+  }
+  AuthenticateStarted = false;
+  if (mbedtls_sha256_finish_ret(&Sha256, pOutputBuffer) != 0)
+  {
+    mbedtls_sha256_free(&Sha256);
+    return SE_ERROR;
+  }
+  mbedtls_sha256_free(&Sha256);
+  *pOutputSize = SE_TAG_LEN;
+  for (uint32_t i = 0; i < SE_TAG_LEN; i++)
+  {
+    diff |= pOutputBuffer[i] ^ Metadata->FwTag[i];
+  }
+  return (diff == 0) ? SE_SUCCESS : SE_ERROR;
+#endif /* SECBOOT_CRYPTO_SCHEME */
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,42 @@
+/**
+  ******************************************************************************
+  * @file    sim_soft_se.c
+  * @author  MCD Application Team
+  * @brief   soft-se.c under the SoftSe_ prefix, the reference the host tests
+  *          of the other secure elements are compared with in one program
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_soft_se.h"
+
+#define SecureElementInit               SoftSe_Init
+#define SecureElementRestoreNvmCtx      SoftSe_RestoreNvmCtx
+#define SecureElementGetNvmCtx          SoftSe_GetNvmCtx
+#define SecureElementSetKey             SoftSe_SetKey
+#define SecureElementComputeAesCmac     SoftSe_ComputeAesCmac
+#define SecureElementVerifyAesCmac      SoftSe_VerifyAesCmac
+#define SecureElementAesEncrypt         SoftSe_AesEncrypt
+#define SecureElementAesCtrEncrypt      SoftSe_AesCtrEncrypt
+#define SecureElementDeriveAndStoreKey  SoftSe_DeriveAndStoreKey
+#define SecureElementRandomNumber       SoftSe_RandomNumber
+#define SecureElementSetDevEui          SoftSe_SetDevEui
+#define SecureElementGetDevEui          SoftSe_GetDevEui
+#define SecureElementSetJoinEui         SoftSe_SetJoinEui
+#define SecureElementGetJoinEui         SoftSe_GetJoinEui
+#define GetKeyByID                      SoftSe_GetKeyByID
+
+#include "soft-se.c"
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
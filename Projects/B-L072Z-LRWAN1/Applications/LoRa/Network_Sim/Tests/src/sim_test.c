@@ -0,0 +1,47 @@
+/**
+  ******************************************************************************
+  * @file    sim_test.c
+  * @author  MCD Application Team
+  * @brief   Checks and report of the host tests
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "sim_test.h"
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t Checks = 0;
+
+static uint32_t Failures = 0;
+
+/* Exported functions ------------------------------------------------------- */
+bool SimTest_Check(bool Passed, const char *Text, const char *File, int Location)
+{
+  Checks++;
+  if (!Passed)
+  {
+    Failures++;
+    printf("%s:%d: check failed: %s\n", File, Location, Text);
+  }
+  return Passed;
+}
+
+int SimTest_Report(const char *Name)
+{
+  printf("%s: %u checks, %u failed\n", Name, (unsigned)Checks, (unsigned)Failures);
+  return ((Failures == 0) && (Checks != 0)) ? 0 : 1;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
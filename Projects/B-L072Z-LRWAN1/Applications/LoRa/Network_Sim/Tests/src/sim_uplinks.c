@@ -0,0 +1,124 @@
+/**
+  ******************************************************************************
+  * @file    sim_uplinks.c
+  * @author  MCD Application Team
+  * @brief   Data uplinks secured by the LoRaMacCrypto and soft-se sources of
+  *          the devices. The crypto context is set up again for each uplink,
+  *          the devices need no state of their own.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include "LoRaMacCrypto.h"
+#include "radio.h"
+#include "secure-element.h"
+#include "sim_uplinks.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define SIM_UPLINKS_DEV_ADDR_BASE                   0x26000000
+
+#define SIM_UPLINKS_MAX_PAYLOAD_SIZE                242
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t SimUplinks_Random(void);
+
+/* Radio of soft-se.c, only its random numbers are used */
+const struct Radio_s Radio =
+{
+  .Random = SimUplinks_Random,
+};
+
+/* Exported functions ---------------------------------------------------------*/
+void SimUplinks_SetDevice(SimUplinks_Device_t *device, uint32_t index, Version_t version)
+{
+  memset(device, 0, sizeof(SimUplinks_Device_t));
+  device->DevAddr = SIM_UPLINKS_DEV_ADDR_BASE + index * 0x2F;
+  device->LrWanVersion = version;
+
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    device->FNwkSIntKey[i] = (uint8_t)(index * 7 + i);
+    device->SNwkSIntKey[i] = (uint8_t)(index * 11 + i * 3 + 1);
+    device->NwkSEncKey[i] = (uint8_t)(index * 13 + i * 5 + 2);
+    device->AppSKey[i] = (uint8_t)(index * 17 + i * 9 + 3);
+  }
+  if (version.Fields.Minor == 0)
+  {
+    memcpy(device->SNwkSIntKey, device->FNwkSIntKey, 16);
+    memcpy(device->NwkSEncKey, device->FNwkSIntKey, 16);
+  }
+}
+
+uint8_t SimUplinks_Secure(const SimUplinks_Device_t *device, const SimUplinks_Uplink_t *uplink, uint8_t *buffer)
+{
+  LoRaMacMessageData_t macMsg;
+  uint8_t payload[SIM_UPLINKS_MAX_PAYLOAD_SIZE];
+
+  /* The MAC only encrypts the frames above its frame counter, from 0 */
+  if ((uplink->FCnt == 0) || (uplink->FOptsLen > 15) || (uplink->PayloadSize > sizeof(payload)))
+  {
+    return 0;
+  }
+
+  /* Crypto context of a device after its activation */
+  SecureElementInit(NULL);
+  LoRaMacCryptoInit(NULL);
+  LoRaMacCryptoSetLrWanVersion(device->LrWanVersion);
+  if ((LoRaMacCryptoSetKey(F_NWK_S_INT_KEY, (uint8_t *) device->FNwkSIntKey) != LORAMAC_CRYPTO_SUCCESS) ||
+      (LoRaMacCryptoSetKey(S_NWK_S_INT_KEY, (uint8_t *) device->SNwkSIntKey) != LORAMAC_CRYPTO_SUCCESS) ||
+      (LoRaMacCryptoSetKey(NWK_S_ENC_KEY, (uint8_t *) device->NwkSEncKey) != LORAMAC_CRYPTO_SUCCESS) ||
+      (LoRaMacCryptoSetKey(APP_S_KEY, (uint8_t *) device->AppSKey) != LORAMAC_CRYPTO_SUCCESS))
+  {
+    return 0;
+  }
+
+  /* Encrypted in place by the MAC */
+  memcpy(payload, uplink->Payload, uplink->PayloadSize);
+
+  memset(&macMsg, 0, sizeof(macMsg));
+  macMsg.Buffer = buffer;
+  macMsg.BufSize = 255;
+  macMsg.MHDR.Bits.MType = (uplink->Confirmed == true) ? FRAME_TYPE_DATA_CONFIRMED_UP :
+                           FRAME_TYPE_DATA_UNCONFIRMED_UP;
+  macMsg.FHDR.DevAddr = device->DevAddr;
+  macMsg.FHDR.FCtrl.Bits.Ack = (uplink->Ack == true) ? 1 : 0;
+  macMsg.FHDR.FCtrl.Bits.FOptsLen = uplink->FOptsLen;
+  macMsg.FHDR.FCnt = (uint16_t) uplink->FCnt;
+  memcpy(macMsg.FHDR.FOpts, uplink->FOpts, uplink->FOptsLen);
+  macMsg.FPort = uplink->FPort;
+  macMsg.FRMPayload = payload;
+  macMsg.FRMPayloadSize = uplink->PayloadSize;
+
+  if (LoRaMacCryptoSecureMessage(uplink->FCnt, uplink->TxDr, uplink->TxCh, &macMsg) != LORAMAC_CRYPTO_SUCCESS)
+  {
+    return 0;
+  }
+  return macMsg.BufSize;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Random numbers of the radio
+ */
+static uint32_t SimUplinks_Random(void)
+{
+  return (uint32_t) rand();
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
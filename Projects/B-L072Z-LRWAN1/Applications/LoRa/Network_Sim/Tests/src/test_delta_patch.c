@@ -0,0 +1,271 @@
+/**
+  ******************************************************************************
+  * @file    test_delta_patch.c
+  * @author  MCD Application Team
+  * @brief   Applies the delta prepareimage.py makes between two images of
+  *          Bin, fed in chunks of several sizes, and checks the corrupted,
+  *          truncated and out of bounds deltas are rejected
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "DeltaPatch.h"
+#include "sim_test.h"
+
+/* Private define ------------------------------------------------------------*/
+/* Set by the Makefile, which makes the delta with prepareimage.py */
+#ifndef TEST_OLD_IMAGE
+#define TEST_OLD_IMAGE               "../../../../../../../Bin/kore.bin"
+#endif
+#ifndef TEST_NEW_IMAGE
+#define TEST_NEW_IMAGE               "../../../../../../../Bin/ttn.bin"
+#endif
+#ifndef TEST_DELTA
+#define TEST_DELTA                   "obj/test/kore_ttn.delta"
+#endif
+
+/* Old image and new image slots */
+#define SLOT_SIZE                    ( 256 * 1024 )
+
+/* Corrupted deltas, one byte changed each */
+#define CORRUPTIONS                  200
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t OldImage[SLOT_SIZE];
+static uint32_t OldSize;
+
+static uint8_t NewImage[SLOT_SIZE];
+static uint32_t NewSize;
+
+static uint8_t Delta[SLOT_SIZE];
+static uint32_t DeltaSize;
+
+/* New image slot written by the patcher */
+static uint8_t Slot[SLOT_SIZE];
+
+/* Bytes past the current end of the new image, out of order writes or
+   accesses out of the slots */
+static uint32_t BadAccesses;
+
+static uint32_t NextWrite;
+
+static bool ReadFails;
+
+static bool WriteFails;
+
+/* Private functions ---------------------------------------------------------*/
+static uint8_t ReadOld(uint32_t addr, uint8_t *data, uint32_t size)
+{
+  if ((addr > OldSize) || (size > (OldSize - addr)))
+  {
+    BadAccesses++;
+    return 1;
+  }
+  memcpy(data, OldImage + addr, size);
+  return ReadFails ? 1 : 0;
+}
+
+static uint8_t WriteNew(uint32_t addr, uint8_t *data, uint32_t size)
+{
+  /* The new image is written in order, by whole buffers but the last */
+  if ((addr != NextWrite) || ((addr % DELTA_PATCH_BUFFER_SIZE) != 0) ||
+      (size > DELTA_PATCH_BUFFER_SIZE) || (addr > SLOT_SIZE) || (size > (SLOT_SIZE - addr)))
+  {
+    BadAccesses++;
+    return 1;
+  }
+  memcpy(Slot + addr, data, size);
+  NextWrite += size;
+  return WriteFails ? 1 : 0;
+}
+
+static DeltaPatchCallbacks_t Callbacks =
+{
+  .DeltaPatchReadOld = ReadOld,
+  .DeltaPatchWriteNew = WriteNew,
+};
+
+static uint32_t LoadFile(const char *Path, uint8_t *Buffer, uint32_t Size)
+{
+  FILE *File = fopen(Path, "rb");
+  size_t Read;
+
+  if (File == NULL)
+  {
+    printf("%s: cannot open\n", Path);
+    return 0;
+  }
+  Read = fread(Buffer, 1, Size, File);
+  fclose(File);
+  return (uint32_t)Read;
+}
+
+/* Applies Size bytes of Data in chunks of Chunk bytes, 0 for a single one */
+static DeltaPatchStatus_t Apply(DeltaPatch_t *Patch, uint8_t *Data, uint32_t Size, uint32_t Chunk,
+                                uint32_t OldMaxSize, uint32_t NewMaxSize)
+{
+  uint32_t Index = 0;
+
+  memset(Slot, 0, sizeof(Slot));
+  NextWrite = 0;
+  BadAccesses = 0;
+  DeltaPatchInit(Patch, OldMaxSize, NewMaxSize, &Callbacks);
+  while (Index < Size)
+  {
+    uint32_t Length = ((Chunk == 0) || (Chunk > (Size - Index))) ? (Size - Index) : Chunk;
+
+    if (DeltaPatchProcess(Patch, Data + Index, Length) != DELTA_PATCH_ONGOING)
+    {
+      break;
+    }
+    Index += Length;
+  }
+  return DeltaPatchFinish(Patch);
+}
+
+static void TestChunks(void)
+{
+  static const uint32_t Chunks[] = { 1, 7, 16, 50, 128, 242, 1000, 0 };
+  DeltaPatch_t Patch;
+
+  for (uint32_t i = 0; i < (sizeof(Chunks) / sizeof(Chunks[0])); i++)
+  {
+    SIM_TEST_CHECK(Apply(&Patch, Delta, DeltaSize, Chunks[i], SLOT_SIZE, SLOT_SIZE) == DELTA_PATCH_DONE);
+    SIM_TEST_CHECK(BadAccesses == 0);
+    SIM_TEST_CHECK(NextWrite == NewSize);
+    SIM_TEST_CHECK(DeltaPatchGetProgress(&Patch) == NewSize);
+    SIM_TEST_CHECK(memcmp(Slot, NewImage, NewSize) == 0);
+  }
+
+  /* Slots just large enough */
+  SIM_TEST_CHECK(Apply(&Patch, Delta, DeltaSize, 0, OldSize, NewSize) == DELTA_PATCH_DONE);
+  SIM_TEST_CHECK(memcmp(Slot, NewImage, NewSize) == 0);
+}
+
+static void TestHeader(void)
+{
+  uint8_t Header[DELTA_PATCH_HEADER_SIZE];
+  DeltaPatch_t Patch;
+
+  /* Images larger than their slot */
+  SIM_TEST_CHECK(Apply(&Patch, Delta, DeltaSize, 0, OldSize - 1, SLOT_SIZE) == DELTA_PATCH_ERROR_HEADER);
+  SIM_TEST_CHECK(Apply(&Patch, Delta, DeltaSize, 0, SLOT_SIZE, NewSize - 1) == DELTA_PATCH_ERROR_HEADER);
+  SIM_TEST_CHECK(NextWrite == 0);
+
+  /* Not a delta */
+  memcpy(Header, Delta, sizeof(Header));
+  Header[3] ^= 0x01;
+  SIM_TEST_CHECK(Apply(&Patch, Header, sizeof(Header), 0, SLOT_SIZE, SLOT_SIZE) == DELTA_PATCH_ERROR_HEADER);
+  SIM_TEST_CHECK(BadAccesses == 0);
+}
+
+static void TestVarint(void)
+{
+  /* INSERT of 1 byte, its 5th varint byte only carries bits past 32 bits */
+  static const uint8_t Overlong[] = { 0x82, 0x80, 0x80, 0x80, 0x10, 0x00 };
+  /* Same command without the extra bits */
+  static const uint8_t Insert[] = { 0x02, 0x5A };
+  uint8_t Data[DELTA_PATCH_HEADER_SIZE + sizeof(Overlong)];
+  DeltaPatch_t Patch;
+
+  memcpy(Data, Delta, DELTA_PATCH_HEADER_SIZE);
+  memcpy(Data + DELTA_PATCH_HEADER_SIZE, Overlong, sizeof(Overlong));
+  SIM_TEST_CHECK(Apply(&Patch, Data, sizeof(Data), 1, SLOT_SIZE, SLOT_SIZE) == DELTA_PATCH_ERROR_FORMAT);
+  SIM_TEST_CHECK(DeltaPatchGetProgress(&Patch) == 0);
+
+  memcpy(Data + DELTA_PATCH_HEADER_SIZE, Insert, sizeof(Insert));
+  SIM_TEST_CHECK(Apply(&Patch, Data, DELTA_PATCH_HEADER_SIZE + sizeof(Insert), 1, SLOT_SIZE, SLOT_SIZE) ==
+                 DELTA_PATCH_ERROR_TRUNCATED);
+  SIM_TEST_CHECK(DeltaPatchGetProgress(&Patch) == 1);
+}
+
+static void TestTruncated(void)
+{
+  DeltaPatch_t Patch;
+
+  for (uint32_t Size = 0; Size < DeltaSize; Size += (Size < 64) ? 1 : 97)
+  {
+    SIM_TEST_CHECK(Apply(&Patch, Delta, Size, 50, SLOT_SIZE, SLOT_SIZE) == DELTA_PATCH_ERROR_TRUNCATED);
+    SIM_TEST_CHECK(BadAccesses == 0);
+  }
+  SIM_TEST_CHECK(Apply(&Patch, Delta, DeltaSize - 1, 50, SLOT_SIZE, SLOT_SIZE) == DELTA_PATCH_ERROR_TRUNCATED);
+}
+
+static void TestCorrupted(void)
+{
+  static uint8_t Corrupted[SLOT_SIZE];
+  DeltaPatch_t Patch;
+
+  srand(1);
+  for (uint32_t i = 0; i < CORRUPTIONS; i++)
+  {
+    uint32_t Index = DELTA_PATCH_HEADER_SIZE + ((uint32_t)rand() % (DeltaSize - DELTA_PATCH_HEADER_SIZE));
+    DeltaPatchStatus_t Status;
+
+    memcpy(Corrupted, Delta, DeltaSize);
+    Corrupted[Index] ^= (uint8_t)(1 + ((uint32_t)rand() % 255));
+    Status = Apply(&Patch, Corrupted, DeltaSize, 242, SLOT_SIZE, SLOT_SIZE);
+    SIM_TEST_CHECK((Status == DELTA_PATCH_ERROR_FORMAT) || (Status == DELTA_PATCH_ERROR_CRC) ||
+                   (Status == DELTA_PATCH_ERROR_TRUNCATED));
+    SIM_TEST_CHECK(BadAccesses == 0);
+  }
+
+  /* New image CRC */
+  memcpy(Corrupted, Delta, DeltaSize);
+  Corrupted[12] ^= 0x80;
+  SIM_TEST_CHECK(Apply(&Patch, Corrupted, DeltaSize, 0, SLOT_SIZE, SLOT_SIZE) == DELTA_PATCH_ERROR_CRC);
+  SIM_TEST_CHECK(NextWrite == NewSize);
+}
+
+static void TestCallbacks(void)
+{
+  DeltaPatch_t Patch;
+
+  ReadFails = true;
+  SIM_TEST_CHECK(Apply(&Patch, Delta, DeltaSize, 0, SLOT_SIZE, SLOT_SIZE) == DELTA_PATCH_ERROR_READ);
+  ReadFails = false;
+
+  WriteFails = true;
+  SIM_TEST_CHECK(Apply(&Patch, Delta, DeltaSize, 0, SLOT_SIZE, SLOT_SIZE) == DELTA_PATCH_ERROR_WRITE);
+  SIM_TEST_CHECK(NextWrite == DELTA_PATCH_BUFFER_SIZE);
+  WriteFails = false;
+}
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  OldSize = LoadFile(TEST_OLD_IMAGE, OldImage, sizeof(OldImage));
+  NewSize = LoadFile(TEST_NEW_IMAGE, NewImage, sizeof(NewImage));
+  DeltaSize = LoadFile(TEST_DELTA, Delta, sizeof(Delta));
+  if (!SIM_TEST_CHECK((OldSize != 0) && (NewSize != 0) && (DeltaSize > DELTA_PATCH_HEADER_SIZE)))
+  {
+    return SimTest_Report("delta patch");
+  }
+
+  TestChunks();
+  TestHeader();
+  TestVarint();
+  TestTruncated();
+  TestCorrupted();
+  TestCallbacks();
+
+  return SimTest_Report("delta patch");
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,432 @@
+/**
+  ******************************************************************************
+  * @file    test_frag_sessions.c
+  * @author  MCD Application Team
+  * @brief   Test of the concurrent sessions of the fragmentation package:
+  *          interleaved fragments of two sessions, with losses, against the
+  *          same fragments decoded by a single session
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "LmhpFragmentation.h"
+#include "sim_test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum
+{
+  OUTCOME_PENDING,
+  OUTCOME_FINISHED,
+  OUTCOME_ABORTED
+} Outcome_t;
+
+/* Private define ------------------------------------------------------------*/
+#define TRIALS                       200
+
+/* Concurrent sessions, one per decoder of the package */
+#define SESSIONS                     2
+
+#define FRAG_NB                      20
+#define FRAG_SIZE                    10
+
+/* Fragments sent by the server for each session, coded ones included. One
+   more fragment, never lost, reports the end of a session completed by the
+   last one */
+#define FRAG_SENT_MAX                ( FRAG_NB + 3 * FRAG_MAX_REDUNDANCY )
+
+/* Package commands */
+#define FRAG_SESSION_SETUP_REQ       0x02
+#define FRAG_SESSION_SETUP_ANS       0x02
+#define DATA_FRAGMENT                0x08
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static uint8_t Original[SESSIONS][FRAG_NB * FRAG_SIZE];
+
+static uint8_t Storage[SESSIONS][FRAG_NB * FRAG_SIZE];
+
+static uint8_t SoloStorage[FRAG_NB * FRAG_SIZE];
+
+/* Last answer sent by the package */
+static uint8_t Answer[16];
+static uint8_t AnswerSize = 0;
+
+static Outcome_t Outcome[SESSIONS];
+static uint32_t DoneSize[SESSIONS];
+static uint32_t DoneNb[SESSIONS];
+static uint16_t ProgressNb[SESSIONS];
+static bool ProgressOther = false;          /* progress of another session */
+
+static uint8_t DataBuffer[242];
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t StorageWrite0(uint32_t addr, uint8_t *data, uint32_t size);
+static uint8_t StorageRead0(uint32_t addr, uint8_t *data, uint32_t size);
+static uint8_t StorageWrite1(uint32_t addr, uint8_t *data, uint32_t size);
+static uint8_t StorageRead1(uint32_t addr, uint8_t *data, uint32_t size);
+static uint8_t SoloWrite(uint32_t addr, uint8_t *data, uint32_t size);
+static uint8_t SoloRead(uint32_t addr, uint8_t *data, uint32_t size);
+static FragDecoderCallbacks_t *OnSessionSetup(uint8_t fragIndex, uint16_t fragNb, uint8_t fragSize, uint32_t descriptor);
+static void OnProgress(uint8_t fragIndex, uint16_t fragCounter, uint16_t fragNb, uint8_t fragSize, uint16_t fragNbLost);
+static void OnDone(uint8_t fragIndex, int32_t status, uint32_t size);
+static LmHandlerErrorStatus_t OnSendRequest(LmHandlerAppData_t *appData, LmHandlerMsgTypes_t isTxConfirmed);
+static uint8_t SetupSession(LmhPackage_t *Package, uint8_t FragIndex);
+static void BuildFragment(uint8_t Session, uint16_t Counter, uint8_t *Fragment);
+static Outcome_t ReplaySolo(uint8_t Session, const uint16_t *Counters, uint16_t CountersNb);
+
+static FragDecoderCallbacks_t StorageCallbacks[SESSIONS] =
+{
+  { StorageWrite0, StorageRead0 },
+  { StorageWrite1, StorageRead1 },
+};
+
+static FragDecoderCallbacks_t SoloCallbacks = { SoloWrite, SoloRead };
+
+static LmhpFragmentationParams_t FragmentationParams =
+{
+  .DecoderCallbacks = { NULL, NULL },
+  .OnSessionSetup = OnSessionSetup,
+  .OnProgress = OnProgress,
+  .OnRowsReady = NULL,
+  .OnDone = OnDone,
+};
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  LmhPackage_t *package = LmhpFragmentationPackageFactory();
+  uint32_t finished = 0;
+  uint32_t aborted = 0;
+  uint32_t mismatches = 0;
+
+  package->OnSendRequest = OnSendRequest;
+  package->Init(&FragmentationParams, DataBuffer, sizeof(DataBuffer));
+  SIM_TEST_CHECK(package->IsInitialized() == true);
+
+  srand(1);
+  for (uint32_t trial = 0; trial < TRIALS; trial++)
+  {
+    uint16_t counters[SESSIONS][FRAG_SENT_MAX + 1];
+    uint16_t countersNb[SESSIONS] = { 0 };
+    uint16_t next[SESSIONS];
+    uint16_t lost[SESSIONS] = { 0 };
+    /* No loss in the first trial, all the fragments must be decoded. Beyond
+       FRAG_MAX_REDUNDANCY losses the sessions may be aborted */
+    uint16_t lostMax = (trial == 0) ? 0 : (rand() % (FRAG_MAX_REDUNDANCY + 4));
+
+    for (uint8_t s = 0; s < SESSIONS; s++)
+    {
+      for (uint32_t i = 0; i < sizeof(Original[s]); i++)
+      {
+        Original[s][i] = rand();
+      }
+      memset(Storage[s], 0, sizeof(Storage[s]));
+      Outcome[s] = OUTCOME_PENDING;
+      DoneNb[s] = 0;
+      ProgressNb[s] = 0;
+      next[s] = 1;
+      SIM_TEST_CHECK(SetupSession(package, s) == ((s << 6) & 0xC0));
+    }
+    /* No decoder left for a third session while the two are running */
+    if (trial == 0)
+    {
+      SIM_TEST_CHECK((SetupSession(package, SESSIONS) & 0x0F) == 0x02);
+    }
+
+    while (true)
+    {
+      uint8_t frame[2 * (3 + FRAG_SIZE)];
+      uint8_t frameSize = 0;
+      McpsIndication_t indication;
+      uint8_t sessions[SESSIONS];
+      uint8_t sessionsNb = 0;
+      uint8_t first;
+
+      for (uint8_t s = 0; s < SESSIONS; s++)
+      {
+        if ((DoneNb[s] == 0) && (next[s] <= (FRAG_SENT_MAX + 1)))
+        {
+          sessions[sessionsNb++] = s;
+        }
+      }
+      if (sessionsNb == 0)
+      {
+        break;
+      }
+      /* A fragment of a random session, sometimes followed in the same frame
+         by a fragment of the other session */
+      first = rand() % sessionsNb;
+      for (uint8_t k = 0; k < sessionsNb; k++)
+      {
+        uint8_t s = sessions[(first + k) % sessionsNb];
+        uint16_t counter;
+
+        if ((k > 0) && ((rand() % 4) != 0))
+        {
+          break;
+        }
+        counter = next[s]++;
+        if ((counter <= FRAG_SENT_MAX) && (lost[s] < lostMax) && ((rand() % 5) == 0))
+        {
+          lost[s]++;
+          continue;
+        }
+        counters[s][countersNb[s]++] = counter;
+        frame[frameSize++] = DATA_FRAGMENT;
+        frame[frameSize++] = counter & 0xFF;
+        frame[frameSize++] = ((counter >> 8) & 0x3F) | (s << 6);
+        BuildFragment(s, counter, &frame[frameSize]);
+        frameSize += FRAG_SIZE;
+      }
+      if (frameSize == 0)
+      {
+        continue;
+      }
+      memset(&indication, 0, sizeof(indication));
+      indication.Port = package->Port;
+      indication.Buffer = frame;
+      indication.BufferSize = frameSize;
+      package->OnMcpsIndicationProcess(&indication);
+    }
+
+    for (uint8_t s = 0; s < SESSIONS; s++)
+    {
+      /* Same outcome and same file as the fragments decoded alone */
+      if ((ReplaySolo(s, counters[s], countersNb[s]) != Outcome[s]) ||
+          ((Outcome[s] == OUTCOME_FINISHED) && (memcmp(SoloStorage, Storage[s], sizeof(SoloStorage)) != 0)))
+      {
+        mismatches++;
+      }
+      SIM_TEST_CHECK(DoneNb[s] <= 1);
+      SIM_TEST_CHECK(ProgressNb[s] > 0);
+      if (Outcome[s] == OUTCOME_FINISHED)
+      {
+        finished++;
+        SIM_TEST_CHECK(DoneSize[s] == sizeof(Original[s]));
+        SIM_TEST_CHECK(memcmp(Storage[s], Original[s], sizeof(Original[s])) == 0);
+      }
+      else if (Outcome[s] == OUTCOME_ABORTED)
+      {
+        aborted++;
+      }
+    }
+    if (trial == 0)
+    {
+      SIM_TEST_CHECK((Outcome[0] == OUTCOME_FINISHED) && (Outcome[1] == OUTCOME_FINISHED));
+    }
+  }
+  SIM_TEST_CHECK(mismatches == 0);
+  SIM_TEST_CHECK(ProgressOther == false);
+  /* Both ends of a session are exercised */
+  SIM_TEST_CHECK(finished > (TRIALS * SESSIONS) / 2);
+  SIM_TEST_CHECK(aborted > 0);
+  printf("%u sessions: %u finished, %u aborted, %u mismatches\n",
+         (unsigned)(TRIALS * SESSIONS), (unsigned)finished, (unsigned)aborted, (unsigned)mismatches);
+
+  return SimTest_Report("test_frag_sessions");
+}
+
+/* Private functions ---------------------------------------------------------*/
+static uint8_t StorageWrite0(uint32_t addr, uint8_t *data, uint32_t size)
+{
+  memcpy(&Storage[0][addr], data, size);
+  return 0;
+}
+
+static uint8_t StorageRead0(uint32_t addr, uint8_t *data, uint32_t size)
+{
+  memcpy(data, &Storage[0][addr], size);
+  return 0;
+}
+
+static uint8_t StorageWrite1(uint32_t addr, uint8_t *data, uint32_t size)
+{
+  memcpy(&Storage[1][addr], data, size);
+  return 0;
+}
+
+static uint8_t StorageRead1(uint32_t addr, uint8_t *data, uint32_t size)
+{
+  memcpy(data, &Storage[1][addr], size);
+  return 0;
+}
+
+static uint8_t SoloWrite(uint32_t addr, uint8_t *data, uint32_t size)
+{
+  memcpy(&SoloStorage[addr], data, size);
+  return 0;
+}
+
+static uint8_t SoloRead(uint32_t addr, uint8_t *data, uint32_t size)
+{
+  memcpy(data, &SoloStorage[addr], size);
+  return 0;
+}
+
+/**
+ * @brief  Each session is decoded to its own storage
+ */
+static FragDecoderCallbacks_t *OnSessionSetup(uint8_t fragIndex, uint16_t fragNb, uint8_t fragSize, uint32_t descriptor)
+{
+  if (fragIndex >= SESSIONS)
+  {
+    /* Storage of the first session, shared on purpose */
+    return &StorageCallbacks[0];
+  }
+  return &StorageCallbacks[fragIndex];
+}
+
+static void OnProgress(uint8_t fragIndex, uint16_t fragCounter, uint16_t fragNb, uint8_t fragSize, uint16_t fragNbLost)
+{
+  if ((fragIndex >= SESSIONS) || (fragNb != FRAG_NB) || (fragSize != FRAG_SIZE))
+  {
+    ProgressOther = true;
+    return;
+  }
+  ProgressNb[fragIndex]++;
+}
+
+static void OnDone(uint8_t fragIndex, int32_t status, uint32_t size)
+{
+  if (fragIndex >= SESSIONS)
+  {
+    ProgressOther = true;
+    return;
+  }
+  DoneNb[fragIndex]++;
+  DoneSize[fragIndex] = size;
+  Outcome[fragIndex] = (status == FRAG_SESSION_ABORTED) ? OUTCOME_ABORTED : OUTCOME_FINISHED;
+}
+
+static LmHandlerErrorStatus_t OnSendRequest(LmHandlerAppData_t *appData, LmHandlerMsgTypes_t isTxConfirmed)
+{
+  AnswerSize = (appData->BufferSize < sizeof(Answer)) ? appData->BufferSize : sizeof(Answer);
+  memcpy(Answer, appData->Buffer, AnswerSize);
+  return LORAMAC_HANDLER_SUCCESS;
+}
+
+/**
+ * @brief  Sends a FragSessionSetupReq on the unicast address
+ * @retval Status of the FragSessionSetupAns, 0xFF when not answered
+ */
+static uint8_t SetupSession(LmhPackage_t *Package, uint8_t FragIndex)
+{
+  uint8_t frame[] =
+  {
+    FRAG_SESSION_SETUP_REQ, (FragIndex << 4) & 0x30,
+    FRAG_NB & 0xFF, (FRAG_NB >> 8) & 0xFF, FRAG_SIZE,
+    0x00, 0x00,
+    0x04, 0x03, 0x02, 0x01
+  };
+  McpsIndication_t indication;
+
+  memset(&indication, 0, sizeof(indication));
+  indication.Port = Package->Port;
+  indication.Buffer = frame;
+  indication.BufferSize = sizeof(frame);
+  AnswerSize = 0;
+  Package->OnMcpsIndicationProcess(&indication);
+  if ((AnswerSize != 2) || (Answer[0] != FRAG_SESSION_SETUP_ANS))
+  {
+    return 0xFF;
+  }
+  return Answer[1];
+}
+
+static int32_t Prbs23(int32_t Value)
+{
+  int32_t b0 = Value & 0x01;
+  int32_t b1 = (Value & 0x20) >> 5;
+
+  return (Value >> 1) + ((b0 ^ b1) << 22);
+}
+
+/**
+ * @brief  Server side encoding: the first FRAG_NB fragments are the file
+ *         rows, the next ones XOR the rows selected by the parity matrix of
+ *         the LoRaWAN fragmentation specification
+ */
+static void BuildFragment(uint8_t Session, uint16_t Counter, uint8_t *Fragment)
+{
+  uint8_t bits[FRAG_NB];
+  int32_t m = FRAG_NB;
+  int32_t mt = ((m & (m - 1)) == 0) ? 1 : 0;
+  int32_t x = 1 + (1001 * (Counter - FRAG_NB));
+  int32_t nbCoeff = 0;
+
+  if (Counter <= FRAG_NB)
+  {
+    memcpy(Fragment, &Original[Session][(Counter - 1) * FRAG_SIZE], FRAG_SIZE);
+    return;
+  }
+  memset(bits, 0, sizeof(bits));
+  while (nbCoeff < (m >> 1))
+  {
+    int32_t r = 1 << 16;
+
+    while (r >= m)
+    {
+      x = Prbs23(x);
+      r = x % (m + mt);
+    }
+    bits[r] = 1;
+    nbCoeff++;
+  }
+  memset(Fragment, 0, FRAG_SIZE);
+  for (int32_t i = 0; i < m; i++)
+  {
+    if (bits[i] != 0)
+    {
+      for (uint32_t k = 0; k < FRAG_SIZE; k++)
+      {
+        Fragment[k] ^= Original[Session][(i * FRAG_SIZE) + k];
+      }
+    }
+  }
+}
+
+/**
+ * @brief  Decodes the fragments a session received with a decoder of its own
+ */
+static Outcome_t ReplaySolo(uint8_t Session, const uint16_t *Counters, uint16_t CountersNb)
+{
+  static FragDecoder_t decoder;
+  int32_t status = FRAG_SESSION_ONGOING;
+
+  memset(SoloStorage, 0, sizeof(SoloStorage));
+  FragDecoderInit(&decoder, FRAG_NB, FRAG_SIZE, &SoloCallbacks);
+  for (uint16_t i = 0; i < CountersNb; i++)
+  {
+    uint8_t fragment[FRAG_SIZE];
+
+    BuildFragment(Session, Counters[i], fragment);
+    status = FragDecoderProcess(&decoder, Counters[i], fragment);
+    if (FragDecoderGetStatus(&decoder).MatrixError != 0)
+    {
+      return OUTCOME_ABORTED;
+    }
+    if (status != FRAG_SESSION_ONGOING)
+    {
+      return OUTCOME_FINISHED;
+    }
+  }
+  return OUTCOME_PENDING;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
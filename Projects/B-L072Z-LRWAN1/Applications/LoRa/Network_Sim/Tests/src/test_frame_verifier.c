@@ -0,0 +1,388 @@
+/**
+  ******************************************************************************
+  * @file    test_frame_verifier.c
+  * @author  MCD Application Team
+  * @brief   Test of the network server side verification of the uplinks:
+  *          LoRaWAN 1.0 and 1.1 frames secured by the crypto of the devices,
+  *          frame counter rollover, replays, corrupted and unknown frames,
+  *          and the same batch verified by one and by several workers
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_test.h"
+#include "sim_uplinks.h"
+#include "sim_verifier.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define LRWAN_1_0_3                  0x01000300
+#define LRWAN_1_1_0                  0x01010000
+#define LRWAN_1_1_1                  0x01010100
+
+#define DEVICES_NB                   48
+#define FRAMES_PER_DEVICE            12
+#define BATCH_NB                     ( DEVICES_NB * FRAMES_PER_DEVICE )
+
+#define WORKERS_NB                   4
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static SimUplinks_Device_t Devices[DEVICES_NB];
+
+static SimVerifier_Device_t Sessions[DEVICES_NB];
+
+static SimVerifier_Device_t SessionsMt[DEVICES_NB];
+
+static SimVerifier_Frame_t Batch[BATCH_NB];
+
+static SimVerifier_Frame_t BatchMt[BATCH_NB];
+
+/* Sent content of the frames of the batch */
+static SimUplinks_Uplink_t Sent[BATCH_NB];
+static uint8_t SentPayload[BATCH_NB][64];
+static uint8_t SentFOpts[BATCH_NB][15];
+static uint32_t SentBy[BATCH_NB];
+
+/* Private function prototypes -----------------------------------------------*/
+static Version_t DeviceVersion(uint32_t Index);
+static void SetSession(SimVerifier_Device_t *Session, const SimUplinks_Device_t *Device);
+static void RandomUplink(SimUplinks_Uplink_t *Uplink, uint8_t *Payload, uint8_t *FOpts, uint32_t FCnt, bool Lrwan11);
+static void SecureFrame(SimVerifier_Frame_t *Frame, const SimUplinks_Device_t *Device,
+                        const SimUplinks_Uplink_t *Uplink);
+static bool Matches(const SimVerifier_Frame_t *Frame, const SimUplinks_Uplink_t *Uplink);
+static void TestSingleDevice(void);
+static void TestCorruption(void);
+static void TestBatch(void);
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  srand(1);
+  for (uint32_t i = 0; i < DEVICES_NB; i++)
+  {
+    SimUplinks_SetDevice(&Devices[i], i, DeviceVersion(i));
+  }
+
+  TestSingleDevice();
+  TestCorruption();
+  TestBatch();
+
+#if defined( SOFT_SE_USE_MBEDTLS )
+  return SimTest_Report("frame verifier, devices on the mbedTLS soft-se");
+#else
+  return SimTest_Report("frame verifier");
+#endif
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  LoRaWAN 1.0.3, 1.1.0 and 1.1.1 devices in turn
+ */
+static Version_t DeviceVersion(uint32_t Index)
+{
+  static const uint32_t versions[] = { LRWAN_1_0_3, LRWAN_1_1_0, LRWAN_1_1_1 };
+  Version_t version;
+
+  version.Value = versions[Index % 3];
+  return version;
+}
+
+/**
+ * @brief  Sets the network server session of a device
+ */
+static void SetSession(SimVerifier_Device_t *Session, const SimUplinks_Device_t *Device)
+{
+  SIM_TEST_CHECK(SimVerifier_SetDevice(Session, Device->DevAddr, Device->LrWanVersion, Device->FNwkSIntKey,
+                                       Device->SNwkSIntKey, Device->NwkSEncKey, Device->AppSKey) == 0);
+}
+
+/**
+ * @brief  Draws the content of an uplink: application or MAC payload,
+ *         FOpts, ACK, datarate and channel
+ */
+static void RandomUplink(SimUplinks_Uplink_t *Uplink, uint8_t *Payload, uint8_t *FOpts, uint32_t FCnt, bool Lrwan11)
+{
+  memset(Uplink, 0, sizeof(SimUplinks_Uplink_t));
+  Uplink->FCnt = FCnt;
+  Uplink->Confirmed = (rand() % 2) == 0;
+  Uplink->Ack = Lrwan11 && ((rand() % 3) == 0);
+  Uplink->FPort = ((rand() % 5) == 0) ? 0 : (1 + rand() % 223);
+  Uplink->PayloadSize = rand() % 64;
+  Uplink->FOptsLen = (Uplink->FPort == 0) ? 0 : (rand() % 16);
+  Uplink->TxDr = rand() % 6;
+  Uplink->TxCh = rand() % 16;
+  for (uint8_t i = 0; i < Uplink->PayloadSize; i++)
+  {
+    Payload[i] = rand();
+  }
+  for (uint8_t i = 0; i < Uplink->FOptsLen; i++)
+  {
+    FOpts[i] = rand();
+  }
+  Uplink->Payload = Payload;
+  Uplink->FOpts = FOpts;
+}
+
+/**
+ * @brief  Secures an uplink in a frame to verify
+ */
+static void SecureFrame(SimVerifier_Frame_t *Frame, const SimUplinks_Device_t *Device,
+                        const SimUplinks_Uplink_t *Uplink)
+{
+  memset(Frame, 0, sizeof(SimVerifier_Frame_t));
+  Frame->BufSize = SimUplinks_Secure(Device, Uplink, Frame->Buffer);
+  Frame->TxDr = Uplink->TxDr;
+  Frame->TxCh = Uplink->TxCh;
+  SIM_TEST_CHECK(Frame->BufSize != 0);
+}
+
+/**
+ * @brief  Checks a verified frame against the uplink sent
+ */
+static bool Matches(const SimVerifier_Frame_t *Frame, const SimUplinks_Uplink_t *Uplink)
+{
+  return (Frame->Status == SIM_VERIFIER_SUCCESS) && (Frame->FCnt == Uplink->FCnt) &&
+         (Frame->FOptsLen == Uplink->FOptsLen) && (memcmp(Frame->FOpts, Uplink->FOpts, Uplink->FOptsLen) == 0) &&
+         (Frame->FRMPayloadSize == Uplink->PayloadSize) &&
+         ((Uplink->PayloadSize == 0) || (Frame->FPort == Uplink->FPort)) &&
+         (memcmp(Frame->FRMPayload, Uplink->Payload, Uplink->PayloadSize) == 0);
+}
+
+/**
+ * @brief  Uplinks of single devices across the 16 bits frame counter
+ *         rollover, replays and the acknowledged downlink counter
+ */
+static void TestSingleDevice(void)
+{
+  for (uint32_t d = 0; d < 3; d++)
+  {
+    const SimUplinks_Device_t *device = &Devices[d];
+    bool lrwan11 = device->LrWanVersion.Fields.Minor == 1;
+    SimVerifier_Device_t session;
+    SimVerifier_Frame_t frame;
+    SimVerifier_Frame_t replay;
+    SimUplinks_Uplink_t uplink;
+    uint8_t payload[64];
+    uint8_t fOpts[15];
+    uint32_t fCnt = 0xFFF0;
+
+    SetSession(&session, device);
+    while (fCnt < 0x10010)
+    {
+      RandomUplink(&uplink, payload, fOpts, fCnt, lrwan11);
+      SecureFrame(&frame, device, &uplink);
+      replay = frame;
+      SIM_TEST_CHECK(SimVerifier_Unsecure(&session, &frame) == SIM_VERIFIER_SUCCESS);
+      SIM_TEST_CHECK(Matches(&frame, &uplink));
+      SIM_TEST_CHECK(session.FCntUp == fCnt);
+
+      /* The same frame again is a replay */
+      SIM_TEST_CHECK(SimVerifier_Unsecure(&session, &replay) == SIM_VERIFIER_FAIL_FCNT);
+      SIM_TEST_CHECK(session.FCntUp == fCnt);
+
+      /* Frames lost now and then */
+      fCnt += 1 + ((rand() % 4 == 0) ? rand() % 5 : 0);
+    }
+
+    /* An old frame counter is taken for the next rollover, its MIC fails */
+    RandomUplink(&uplink, payload, fOpts, session.FCntUp - 3, lrwan11);
+    SecureFrame(&frame, device, &uplink);
+    SIM_TEST_CHECK(SimVerifier_Unsecure(&session, &frame) == SIM_VERIFIER_FAIL_MIC);
+
+    /* The ACK of a LoRaWAN 1.1 uplink is bound to the last downlink */
+    RandomUplink(&uplink, payload, fOpts, session.FCntUp + 1, lrwan11);
+    uplink.Ack = true;
+    SecureFrame(&frame, device, &uplink);
+    replay = frame;
+    session.ConfFCntDown = 7;
+    SIM_TEST_CHECK(SimVerifier_Unsecure(&session, &frame) ==
+                   (lrwan11 ? SIM_VERIFIER_FAIL_MIC : SIM_VERIFIER_SUCCESS));
+    session.ConfFCntDown = UINT32_MAX;
+    if (lrwan11)
+    {
+      SIM_TEST_CHECK(SimVerifier_Unsecure(&session, &replay) == SIM_VERIFIER_SUCCESS);
+      SIM_TEST_CHECK(Matches(&replay, &uplink));
+    }
+
+    /* Frames of another device or too short */
+    RandomUplink(&uplink, payload, fOpts, session.FCntUp + 1, lrwan11);
+    SecureFrame(&frame, &Devices[d + 3], &uplink);
+    SIM_TEST_CHECK(SimVerifier_Unsecure(&session, &frame) == SIM_VERIFIER_FAIL_ADDRESS);
+    frame.BufSize = 11;
+    SIM_TEST_CHECK(SimVerifier_Unsecure(&session, &frame) == SIM_VERIFIER_FAIL_FORMAT);
+
+    SimVerifier_FreeDevice(&session);
+  }
+}
+
+/**
+ * @brief  Every single bit flip of a frame is rejected and leaves the frame
+ *         counter of the device
+ */
+static void TestCorruption(void)
+{
+  for (uint32_t d = 0; d < 3; d++)
+  {
+    const SimUplinks_Device_t *device = &Devices[d];
+    SimVerifier_Device_t session;
+    SimVerifier_Frame_t original;
+    SimVerifier_Frame_t frame;
+    SimUplinks_Uplink_t uplink;
+    uint8_t payload[64];
+    uint8_t fOpts[15];
+    uint32_t rejected = 0;
+
+    SetSession(&session, device);
+    RandomUplink(&uplink, payload, fOpts, 10, device->LrWanVersion.Fields.Minor == 1);
+    uplink.FOptsLen = 3;
+    SecureFrame(&original, device, &uplink);
+
+    for (uint32_t bit = 0; bit < original.BufSize * 8; bit++)
+    {
+      frame = original;
+      frame.Buffer[bit / 8] ^= 1 << (bit % 8);
+      rejected += SimVerifier_Unsecure(&session, &frame) != SIM_VERIFIER_SUCCESS;
+    }
+    SIM_TEST_CHECK(rejected == original.BufSize * 8);
+    SIM_TEST_CHECK(session.FCntUpValid == false);
+
+    /* The LoRaWAN 1.1 MIC also covers the datarate and the channel */
+    frame = original;
+    frame.TxCh ^= 1;
+    SIM_TEST_CHECK(SimVerifier_Unsecure(&session, &frame) ==
+                   ((device->LrWanVersion.Fields.Minor == 1) ? SIM_VERIFIER_FAIL_MIC : SIM_VERIFIER_SUCCESS));
+
+    SimVerifier_FreeDevice(&session);
+  }
+}
+
+/**
+ * @brief  The uplinks of many devices interleaved in a batch, with replays,
+ *         verified by the calling thread and by a pool of workers
+ */
+static void TestBatch(void)
+{
+  SimVerifier_t verifier;
+  SimVerifier_t verifierMt;
+  uint32_t next[DEVICES_NB];
+  uint32_t sent[DEVICES_NB] = { 0 };
+  uint32_t framesNb = 0;
+  uint32_t replays = 0;
+  uint32_t mismatches = 0;
+  uint32_t succeeded = 0;
+
+  for (uint32_t i = 0; i < DEVICES_NB; i++)
+  {
+    SetSession(&Sessions[i], &Devices[i]);
+    SetSession(&SessionsMt[i], &Devices[i]);
+    next[i] = 1 + rand() % 1000;
+  }
+
+  /* Devices drawn at random, one frame in 16 a replay of the previous frame
+     of its device */
+  while (framesNb < BATCH_NB)
+  {
+    uint32_t d = rand() % DEVICES_NB;
+
+    if (sent[d] == FRAMES_PER_DEVICE)
+    {
+      continue;
+    }
+    if ((sent[d] != 0) && ((rand() % 16) == 0))
+    {
+      for (int32_t k = framesNb - 1; k >= 0; k--)
+      {
+        if ((SentBy[k] == d) && (Sent[k].FCnt == next[d] - 1))
+        {
+          Batch[framesNb] = Batch[k];
+          Sent[framesNb] = Sent[k];
+          Sent[framesNb].FCnt = 0;
+          break;
+        }
+      }
+      replays++;
+    }
+    else
+    {
+      RandomUplink(&Sent[framesNb], SentPayload[framesNb], SentFOpts[framesNb], next[d],
+                   Devices[d].LrWanVersion.Fields.Minor == 1);
+      SecureFrame(&Batch[framesNb], &Devices[d], &Sent[framesNb]);
+      next[d]++;
+    }
+    SentBy[framesNb] = d;
+    sent[d]++;
+    framesNb++;
+  }
+  memcpy(BatchMt, Batch, sizeof(Batch));
+
+  SIM_TEST_CHECK(SimVerifier_Init(&verifier, Sessions, DEVICES_NB, 1) == 0);
+  SIM_TEST_CHECK(SimVerifier_Init(&verifierMt, SessionsMt, DEVICES_NB, WORKERS_NB) == 0);
+  SIM_TEST_CHECK(verifierMt.WorkersNb == WORKERS_NB);
+  SimVerifier_Process(&verifier, Batch, framesNb);
+  SimVerifier_Process(&verifierMt, BatchMt, framesNb);
+
+  for (uint32_t i = 0; i < framesNb; i++)
+  {
+    /* A replay is the copy of a frame with its sent counter cleared */
+    if (Sent[i].FCnt == 0)
+    {
+      SIM_TEST_CHECK(Batch[i].Status == SIM_VERIFIER_FAIL_FCNT);
+    }
+    else
+    {
+      succeeded += Matches(&Batch[i], &Sent[i]);
+    }
+    mismatches += (Batch[i].Status != BatchMt[i].Status) || (Batch[i].FCnt != BatchMt[i].FCnt) ||
+                  (Batch[i].FRMPayloadSize != BatchMt[i].FRMPayloadSize) ||
+                  (memcmp(Batch[i].FRMPayload, BatchMt[i].FRMPayload, Batch[i].FRMPayloadSize) != 0);
+  }
+  SIM_TEST_CHECK(succeeded + replays == framesNb);
+  SIM_TEST_CHECK(mismatches == 0);
+
+  /* Lookups, the devices are sorted by the verifiers */
+  for (uint32_t i = 0; i < DEVICES_NB; i++)
+  {
+    SIM_TEST_CHECK(SimVerifier_GetDevice(&verifierMt, Devices[i].DevAddr)->DevAddr == Devices[i].DevAddr);
+  }
+  SIM_TEST_CHECK(SimVerifier_GetDevice(&verifierMt, 0x01020304) == NULL);
+
+  /* A second batch reuses the workers: the whole batch again, all replays or
+     old counters */
+  memcpy(BatchMt, Batch, sizeof(Batch));
+  SimVerifier_Process(&verifierMt, BatchMt, framesNb);
+  succeeded = 0;
+  for (uint32_t i = 0; i < framesNb; i++)
+  {
+    succeeded += BatchMt[i].Status == SIM_VERIFIER_SUCCESS;
+  }
+  SIM_TEST_CHECK(succeeded == 0);
+
+  SimVerifier_DeInit(&verifier);
+  SimVerifier_DeInit(&verifierMt);
+  for (uint32_t i = 0; i < DEVICES_NB; i++)
+  {
+    SimVerifier_FreeDevice(&Sessions[i]);
+    SimVerifier_FreeDevice(&SessionsMt[i]);
+  }
+  printf("frame verifier: %u frames of %u devices, %u replays, %u workers\n", (unsigned) framesNb,
+         (unsigned) DEVICES_NB, (unsigned) replays, (unsigned) WORKERS_NB);
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,261 @@
+/**
+  ******************************************************************************
+  * @file    test_lz_decompress.c
+  * @author  MCD Application Team
+  * @brief   Decompresses an image of Bin compressed by prepareimage.py, fed in
+  *          chunks of 1 to 242 bytes, and checks the corrupted files and the
+  *          files of a too large window are rejected
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "LzDecompress.h"
+#include "sim_test.h"
+
+/* Private define ------------------------------------------------------------*/
+/* Set by the Makefile, which compresses the image with prepareimage.py with a
+   256 bytes, 1 KB and 4 KB window */
+#ifndef TEST_IMAGE
+#define TEST_IMAGE                   "../../../../../../../Bin/ttn.bin"
+#endif
+#ifndef TEST_LZ_W8
+#define TEST_LZ_W8                   "obj/test/ttn_w8.lz"
+#endif
+#ifndef TEST_LZ_W10
+#define TEST_LZ_W10                  "obj/test/ttn_w10.lz"
+#endif
+#ifndef TEST_LZ_W12
+#define TEST_LZ_W12                  "obj/test/ttn_w12.lz"
+#endif
+
+/* Image slot */
+#define SLOT_SIZE                    ( 256 * 1024 )
+
+/* Largest chunk, a fragment of the largest LoRaWAN payload */
+#define CHUNK_MAX                    242
+
+/* Corrupted files, one byte changed each */
+#define CORRUPTIONS                  200
+
+/* Offset of the window bits in the header */
+#define HEADER_WINDOW_BITS           12
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t Image[SLOT_SIZE];
+static uint32_t ImageSize;
+
+static uint8_t Lz[SLOT_SIZE];
+static uint32_t LzSize;
+
+/* Image slot written by the decompressor */
+static uint8_t Slot[SLOT_SIZE];
+
+/* Out of order writes, writes not made of whole blocks but the last one, or
+   out of the slot */
+static uint32_t BadWrites;
+
+static uint32_t NextWrite;
+
+static bool WriteFails;
+
+/* Private functions ---------------------------------------------------------*/
+static uint8_t Write(uint32_t addr, uint8_t *data, uint32_t size)
+{
+  if ((addr != NextWrite) || ((addr % LZ_DECOMPRESS_WRITE_SIZE) != 0) ||
+      (size > LZ_DECOMPRESS_WRITE_SIZE) || (addr > SLOT_SIZE) || (size > (SLOT_SIZE - addr)))
+  {
+    BadWrites++;
+    return 1;
+  }
+  memcpy(Slot + addr, data, size);
+  NextWrite += size;
+  return WriteFails ? 1 : 0;
+}
+
+static LzDecompressCallbacks_t Callbacks =
+{
+  .LzDecompressWrite = Write,
+};
+
+static uint32_t LoadFile(const char *Path, uint8_t *Buffer, uint32_t Size)
+{
+  FILE *File = fopen(Path, "rb");
+  size_t Read;
+
+  if (File == NULL)
+  {
+    printf("%s: cannot open\n", Path);
+    return 0;
+  }
+  Read = fread(Buffer, 1, Size, File);
+  fclose(File);
+  return (uint32_t)Read;
+}
+
+/* Decompresses Size bytes of Data in chunks of Chunk bytes */
+static LzDecompressStatus_t Decompress(LzDecompress_t *Decomp, uint8_t *Data, uint32_t Size, uint32_t Chunk)
+{
+  LzDecompressStatus_t Status = LZ_DECOMPRESS_ONGOING;
+  uint32_t Index = 0;
+
+  memset(Slot, 0, sizeof(Slot));
+  NextWrite = 0;
+  BadWrites = 0;
+  LzDecompressInit(Decomp, &Callbacks);
+  while ((Index < Size) && (Status == LZ_DECOMPRESS_ONGOING))
+  {
+    uint32_t Length = (Chunk > (Size - Index)) ? (Size - Index) : Chunk;
+
+    Status = LzDecompressProcess(Decomp, Data + Index, Length);
+    Index += Length;
+  }
+  return Status;
+}
+
+static void TestChunks(void)
+{
+  LzDecompress_t Decomp;
+  uint32_t Failures = 0;
+
+  /* Every chunk size, counted apart not to report thousands of checks */
+  for (uint32_t Chunk = 1; Chunk <= CHUNK_MAX; Chunk++)
+  {
+    if ((Decompress(&Decomp, Lz, LzSize, Chunk) != LZ_DECOMPRESS_DONE) || (BadWrites != 0) ||
+        (NextWrite != ImageSize) || (LzDecompressGetProgress(&Decomp) != ImageSize) ||
+        (memcmp(Slot, Image, ImageSize) != 0))
+    {
+      printf("chunks of %u bytes: wrong image\n", (unsigned)Chunk);
+      Failures++;
+    }
+  }
+  SIM_TEST_CHECK(Failures == 0);
+
+  /* Trailing bytes, e.g. the padding of the last fragment, are ignored */
+  Lz[LzSize] = 0xA5;
+  SIM_TEST_CHECK(Decompress(&Decomp, Lz, LzSize + 1, CHUNK_MAX) == LZ_DECOMPRESS_DONE);
+  SIM_TEST_CHECK(LzDecompressProcess(&Decomp, Lz, 1) == LZ_DECOMPRESS_DONE);
+  SIM_TEST_CHECK(NextWrite == ImageSize);
+}
+
+static void TestWindow(void)
+{
+  static uint8_t Other[SLOT_SIZE];
+  uint8_t Header[LZ_DECOMPRESS_HEADER_SIZE];
+  LzDecompress_t Decomp;
+  uint32_t Size;
+
+  /* Smaller window than the largest one */
+  Size = LoadFile(TEST_LZ_W8, Other, sizeof(Other));
+  SIM_TEST_CHECK(Other[HEADER_WINDOW_BITS] == 8);
+  SIM_TEST_CHECK(Decompress(&Decomp, Other, Size, 50) == LZ_DECOMPRESS_DONE);
+  SIM_TEST_CHECK(memcmp(Slot, Image, ImageSize) == 0);
+
+  /* Too large window, rejected before anything is written */
+  Size = LoadFile(TEST_LZ_W12, Other, sizeof(Other));
+  SIM_TEST_CHECK(Other[HEADER_WINDOW_BITS] == 12);
+  SIM_TEST_CHECK(Decompress(&Decomp, Other, Size, 50) == LZ_DECOMPRESS_ERROR_HEADER);
+  SIM_TEST_CHECK((LzDecompressGetProgress(&Decomp) == 0) && (NextWrite == 0));
+
+  memcpy(Header, Lz, sizeof(Header));
+  Header[HEADER_WINDOW_BITS] = LZ_DECOMPRESS_WINDOW_BITS + 1;
+  SIM_TEST_CHECK(Decompress(&Decomp, Header, sizeof(Header), 1) == LZ_DECOMPRESS_ERROR_HEADER);
+
+  /* Not a compressed file */
+  memcpy(Header, Lz, sizeof(Header));
+  Header[0] ^= 0x01;
+  SIM_TEST_CHECK(Decompress(&Decomp, Header, sizeof(Header), 1) == LZ_DECOMPRESS_ERROR_HEADER);
+}
+
+static void TestTruncated(void)
+{
+  LzDecompress_t Decomp;
+
+  /* The decompressor waits for the missing bytes */
+  for (uint32_t Size = 0; Size < LzSize; Size += (Size < 64) ? 1 : 97)
+  {
+    SIM_TEST_CHECK(Decompress(&Decomp, Lz, Size, 50) == LZ_DECOMPRESS_ONGOING);
+    SIM_TEST_CHECK((BadWrites == 0) && (LzDecompressGetProgress(&Decomp) < ImageSize));
+  }
+  SIM_TEST_CHECK(Decompress(&Decomp, Lz, LzSize - 1, 50) == LZ_DECOMPRESS_ONGOING);
+}
+
+static void TestCorrupted(void)
+{
+  static uint8_t Corrupted[SLOT_SIZE];
+  LzDecompress_t Decomp;
+
+  srand(1);
+  for (uint32_t i = 0; i < CORRUPTIONS; i++)
+  {
+    uint32_t Index = LZ_DECOMPRESS_HEADER_SIZE + ((uint32_t)rand() % (LzSize - LZ_DECOMPRESS_HEADER_SIZE));
+    LzDecompressStatus_t Status;
+
+    memcpy(Corrupted, Lz, LzSize);
+    Corrupted[Index] ^= (uint8_t)(1 + ((uint32_t)rand() % 255));
+    Status = Decompress(&Decomp, Corrupted, LzSize, CHUNK_MAX);
+    /* A changed flag or match length leaves the image short of some bytes */
+    SIM_TEST_CHECK((Status == LZ_DECOMPRESS_ERROR_FORMAT) || (Status == LZ_DECOMPRESS_ERROR_CRC) ||
+                   ((Status == LZ_DECOMPRESS_ONGOING) && (LzDecompressGetProgress(&Decomp) < ImageSize)));
+    SIM_TEST_CHECK(BadWrites == 0);
+  }
+
+  /* Match before the image start */
+  memcpy(Corrupted, Lz, LZ_DECOMPRESS_HEADER_SIZE);
+  Corrupted[LZ_DECOMPRESS_HEADER_SIZE] = 0x01;
+  Corrupted[LZ_DECOMPRESS_HEADER_SIZE + 1] = 0x00;
+  Corrupted[LZ_DECOMPRESS_HEADER_SIZE + 2] = 0x00;
+  SIM_TEST_CHECK(Decompress(&Decomp, Corrupted, LZ_DECOMPRESS_HEADER_SIZE + 3, 1) == LZ_DECOMPRESS_ERROR_FORMAT);
+
+  /* Image CRC */
+  memcpy(Corrupted, Lz, LzSize);
+  Corrupted[8] ^= 0x80;
+  SIM_TEST_CHECK(Decompress(&Decomp, Corrupted, LzSize, CHUNK_MAX) == LZ_DECOMPRESS_ERROR_CRC);
+  SIM_TEST_CHECK(NextWrite == ImageSize);
+}
+
+static void TestWrite(void)
+{
+  LzDecompress_t Decomp;
+
+  WriteFails = true;
+  SIM_TEST_CHECK(Decompress(&Decomp, Lz, LzSize, CHUNK_MAX) == LZ_DECOMPRESS_ERROR_WRITE);
+  SIM_TEST_CHECK(NextWrite == LZ_DECOMPRESS_WRITE_SIZE);
+  WriteFails = false;
+}
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  ImageSize = LoadFile(TEST_IMAGE, Image, sizeof(Image));
+  LzSize = LoadFile(TEST_LZ_W10, Lz, sizeof(Lz) - 1);
+  if (!SIM_TEST_CHECK((ImageSize != 0) && (LzSize > LZ_DECOMPRESS_HEADER_SIZE)))
+  {
+    return SimTest_Report("lz decompress");
+  }
+
+  TestChunks();
+  TestWindow();
+  TestTruncated();
+  TestCorrupted();
+  TestWrite();
+
+  return SimTest_Report("lz decompress");
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
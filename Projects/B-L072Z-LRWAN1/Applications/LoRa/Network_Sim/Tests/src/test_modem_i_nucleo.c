@@ -0,0 +1,194 @@
+/**
+  ******************************************************************************
+  * @file    test_modem_i_nucleo.c
+  * @author  MCD Application Team
+  * @brief   Loopback test of the I-NUCLEO-LRWAN1 AT driver, its modem_uart
+  *          reception and modem_engine pipeline against a simulated
+  *          WM-SG-SM-42 modem
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "stm32l0xx_hal.h"
+#include "modem_uart.h"
+#include "modem_engine.h"
+#include "i_nucleo_lrwan1_wm_sg_sm_xx.h"
+#include "sim_modem.h"
+#include "sim_test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define DONE_MAX                     16
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Modem state kept by the lora_driver.c of the application */
+uint8_t FWVersion = 30;
+ATCmd_t gFlagException = AT_END_AT;
+
+static bool ModemMute = false;
+
+static char Received[1024];                /* commands received by the modem */
+
+static uint32_t DoneNb = 0;
+static ATCmd_t DoneCmd[DONE_MAX];
+static ATEerror_t DoneStatus[DONE_MAX];
+
+static char Events[256];
+
+/* Private function prototypes -----------------------------------------------*/
+static void OnModemCommand(const char *Cmd, uint16_t Len);
+static void OnCmdDone(ATCmd_t Cmd, ATEerror_t Status);
+static void OnEvent(const char *Event);
+static void Run(uint32_t Ms);
+
+static const Modem_AT_Callbacks_t AtCallbacks = { OnCmdDone, OnEvent };
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  char deui[32];
+  char small[8 + 1];
+  uint8_t adr = 1;
+  uint8_t dr = 9;
+  uint32_t start;
+
+  SimModem_Init(OnModemCommand);
+  SIM_TEST_CHECK(Modem_IO_Init() == AT_OK);
+
+  /* Blocking command on the per character reception */
+  SIM_TEST_CHECK(Modem_AT_Cmd(AT_SET, AT_ADR, &adr) == AT_OK);
+
+  /* Pipeline, the reception moves to the DMA */
+  SIM_TEST_CHECK(Modem_AT_AsyncInit(&AtCallbacks) == AT_OK);
+  Received[0] = '\0';
+  memset(deui, 0, sizeof(deui));
+  start = SimModem_GetTime();
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_GET, AT_DEUI, deui, sizeof(deui)) == AT_OK);
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_SET, AT_ADR, &adr, 0) == AT_OK);
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_SET, AT_DR, &dr, 0) == AT_OK);
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_CTRL, AT_JOIN, NULL, 0) == AT_OK);
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_CTRL, AT, NULL, 0) == AT_UART_LINK_ERROR);
+  while ((DoneNb < 4) && (SimModem_GetTime() - start < 1000))
+  {
+    Run(1);
+  }
+  SIM_TEST_CHECK(strcmp(Received, "AT+EUI\rAT+ADR=1\rAT+DR=9\rAT+JOIN\r") == 0);
+  SIM_TEST_CHECK(DoneNb == 4);
+  SIM_TEST_CHECK((DoneCmd[0] == AT_DEUI) && (DoneStatus[0] == AT_OK));
+  SIM_TEST_CHECK(strcmp(deui, "01:02:03:04:05:06:07:08") == 0);
+  SIM_TEST_CHECK((DoneCmd[1] == AT_ADR) && (DoneStatus[1] == AT_OK));
+  SIM_TEST_CHECK((DoneCmd[2] == AT_DR) && (DoneStatus[2] == AT_ERROR_OUT_OF_RANGE));
+  SIM_TEST_CHECK((DoneCmd[3] == AT_JOIN) && (DoneStatus[3] == AT_OK));
+  SIM_TEST_CHECK(Modem_Engine_IsIdle() == 1);
+  printf("4 pipelined commands in %u ms\n", (unsigned)(SimModem_GetTime() - start));
+  Run(100);
+  SIM_TEST_CHECK(strcmp(Events, "+JoinAccepted|") == 0);
+
+  /* A GET value longer than its buffer is truncated */
+  memset(small, '#', sizeof(small));
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_GET, AT_DEUI, small, sizeof(small) - 1) == AT_OK);
+  Run(100);
+  SIM_TEST_CHECK((DoneNb == 5) && (DoneStatus[4] == AT_OK));
+  SIM_TEST_CHECK(strcmp(small, "01:02:0") == 0);
+  SIM_TEST_CHECK(small[sizeof(small) - 1] == '#');
+
+  /* No response: timeout, then the next command goes through */
+  ModemMute = true;
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_CTRL, AT, NULL, 0) == AT_OK);
+  Run(11000);
+  SIM_TEST_CHECK((DoneNb == 6) && (DoneStatus[5] == AT_UART_LINK_ERROR));
+  ModemMute = false;
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_CTRL, AT, NULL, 0) == AT_OK);
+  Run(50);
+  SIM_TEST_CHECK((DoneNb == 7) && (DoneStatus[6] == AT_OK));
+
+  /* Downlink notified between the commands */
+  Events[0] = '\0';
+  SimModem_SendString("\r\n+RXPORT:2\r\n+PAYLOADSIZE:4\r\n+RCV:01020304\r\n");
+  Run(100);
+  SIM_TEST_CHECK(strcmp(Events, "+RXPORT:2|+PAYLOADSIZE:4|+RCV:01020304|") == 0);
+
+  Modem_IO_DeInit();
+  return SimTest_Report("test_modem_i_nucleo");
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  WM-SG-SM-42 modem in brief mode: a GET value line before the
+ *         return code, +JoinAccepted sent after the join return code
+ * @param  Cmd received command
+ * @param  Len command length
+ * @retval None
+ */
+static void OnModemCommand(const char *Cmd, uint16_t Len)
+{
+  strncat(Received, Cmd, sizeof(Received) - strlen(Received) - 1);
+  if (ModemMute)
+  {
+    return;
+  }
+  if (strcmp(Cmd, "AT+EUI\r") == 0)
+  {
+    SimModem_SendString("\r\n01:02:03:04:05:06:07:08\r\nOK\r\n");
+  }
+  else if (strncmp(Cmd, "AT+JOIN", 7) == 0)
+  {
+    SimModem_SendString("\r\nOK\r\n\r\n+JoinAccepted\r\n");
+  }
+  else if (strcmp(Cmd, "AT+DR=9\r") == 0)
+  {
+    SimModem_SendString("\r\nERROR_OUT_OF_RANGE\r\n");
+  }
+  else
+  {
+    SimModem_SendString("\r\nOK\r\n");
+  }
+}
+
+static void OnCmdDone(ATCmd_t Cmd, ATEerror_t Status)
+{
+  if (DoneNb < DONE_MAX)
+  {
+    DoneCmd[DoneNb] = Cmd;
+    DoneStatus[DoneNb] = Status;
+  }
+  DoneNb++;
+}
+
+static void OnEvent(const char *Event)
+{
+  strncat(Events, Event, sizeof(Events) - strlen(Events) - 2);
+  strcat(Events, "|");
+}
+
+/**
+ * @brief  Main loop of the application
+ * @param  Ms duration in ms
+ * @retval None
+ */
+static void Run(uint32_t Ms)
+{
+  while (Ms-- != 0)
+  {
+    Modem_Engine_Process();
+    SimModem_Step(1);
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
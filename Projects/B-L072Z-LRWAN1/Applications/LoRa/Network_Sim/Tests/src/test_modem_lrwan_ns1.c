@@ -0,0 +1,189 @@
+/**
+  ******************************************************************************
+  * @file    test_modem_lrwan_ns1.c
+  * @author  MCD Application Team
+  * @brief   Loopback test of the LRWAN_NS1 AT driver, its modem_uart reception
+  *          and modem_engine pipeline against a simulated RHF0M003 modem
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "stm32l0xx_hal.h"
+#include "modem_uart.h"
+#include "modem_engine.h"
+#include "lrwan_ns1_atcmd.h"
+#include "sim_modem.h"
+#include "sim_test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define DONE_MAX                     16
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Parsed responses, kept by the lora_driver.c of the application */
+atctl_data_t dt;
+
+static const uint8_t DevEui[8] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+
+static bool ModemMute = false;
+
+static char Received[1024];                /* commands received by the modem */
+
+static uint32_t DoneNb = 0;
+static ATCmd_t DoneCmd[DONE_MAX];
+static ATEerror_t DoneStatus[DONE_MAX];
+
+static bool DoneDevEui = false;            /* dt.id.deveui parsed when AT_DEUI completed */
+
+static char Events[256];
+
+/* Private function prototypes -----------------------------------------------*/
+static void OnModemCommand(const char *Cmd, uint16_t Len);
+static void OnCmdDone(ATCmd_t Cmd, ATEerror_t Status);
+static void OnEvent(const char *Event);
+static void Run(uint32_t Ms);
+
+static const Modem_AT_Callbacks_t AtCallbacks = { OnCmdDone, OnEvent };
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  sSendDataString_t msg = { "hi", 2 };
+  uint8_t adr = 1;
+  uint32_t start;
+
+  SimModem_Init(OnModemCommand);
+  SIM_TEST_CHECK(Modem_IO_Init() == HAL_OK);
+
+  /* Blocking command, the MCU sleeps on the reception buffer */
+  memset(&dt, 0, sizeof(dt));
+  SIM_TEST_CHECK(Modem_AT_Cmd(AT_GET, AT_DEUI, NULL) == ATCTL_RET_CMD_ID);
+  SIM_TEST_CHECK(memcmp(dt.id.deveui, DevEui, sizeof(DevEui)) == 0);
+
+  /* Pipeline: a message up to its Done line, a GET, an error and a test */
+  SIM_TEST_CHECK(Modem_AT_AsyncInit(&AtCallbacks) == ATCTL_RET_IDLE);
+  Received[0] = '\0';
+  memset(&dt, 0, sizeof(dt));
+  start = SimModem_GetTime();
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_SET, AT_SEND, &msg) == ATCTL_RET_IDLE);
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_GET, AT_DEUI, NULL) == ATCTL_RET_IDLE);
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_SET, AT_ADR, &adr) == ATCTL_RET_IDLE);
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_CTRL, AT, NULL) == ATCTL_RET_IDLE);
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_CTRL, AT, NULL) == ATCTL_RET_ERR);
+  while ((DoneNb < 4) && (SimModem_GetTime() - start < 2000))
+  {
+    Run(1);
+  }
+  SIM_TEST_CHECK(DoneNb == 4);
+  SIM_TEST_CHECK((DoneCmd[0] == AT_SEND) && (DoneStatus[0] == ATCTL_RET_CMD_MSG));
+  SIM_TEST_CHECK((DoneCmd[1] == AT_DEUI) && (DoneStatus[1] == ATCTL_RET_CMD_ID) && DoneDevEui);
+  SIM_TEST_CHECK((DoneCmd[2] == AT_ADR) && (DoneStatus[2] == ATCTL_RET_CMD_ERR));
+  SIM_TEST_CHECK((DoneCmd[3] == AT) && (DoneStatus[3] == ATCTL_RET_CMD_AT));
+  SIM_TEST_CHECK(strcmp(Events, "+EVT: X|") == 0);
+  SIM_TEST_CHECK(Modem_Engine_IsIdle() == 1);
+  printf("4 pipelined commands in %u ms\n", (unsigned)(SimModem_GetTime() - start));
+
+  /* No response: the timeout reports no return code, then the next command
+     goes through */
+  ModemMute = true;
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_CTRL, AT, NULL) == ATCTL_RET_IDLE);
+  Run(3500);
+  SIM_TEST_CHECK((DoneNb == 5) && (DoneStatus[4] == ATCTL_RET_IDLE));
+  ModemMute = false;
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_CTRL, AT, NULL) == ATCTL_RET_IDLE);
+  Run(100);
+  SIM_TEST_CHECK((DoneNb == 6) && (DoneStatus[5] == ATCTL_RET_CMD_AT));
+
+  Modem_IO_DeInit();
+  return SimTest_Report("test_modem_lrwan_ns1");
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  RHF0M003 modem: the commands follow a wake up sequence of 0xFF
+ *         characters, a message is answered line by line up to its Done
+ * @param  Cmd received command
+ * @param  Len command length
+ * @retval None
+ */
+static void OnModemCommand(const char *Cmd, uint16_t Len)
+{
+  Cmd += strspn(Cmd, "\xFF");
+  if (*Cmd == '\0')
+  {
+    return;
+  }
+  strncat(Received, Cmd, sizeof(Received) - strlen(Received) - 1);
+  if (ModemMute)
+  {
+    return;
+  }
+  if (strncmp(Cmd, "AT+MSG=", 7) == 0)
+  {
+    SimModem_SendString("+MSG: Start\r\n+EVT: X\r\n+MSG: TX \"hi\"\r\n+MSG: ACK Received\r\n+MSG: Done\r\n");
+  }
+  else if (strncmp(Cmd, "AT+ID=DevEui", 12) == 0)
+  {
+    SimModem_SendString("+ID: DevEui, 01:02:03:04:05:06:07:08\r\n");
+  }
+  else if (strncmp(Cmd, "AT+ADR", 6) == 0)
+  {
+    SimModem_SendString("+ADR: ERROR(-1)\r\n");
+  }
+  else
+  {
+    SimModem_SendString("+AT: OK\r\n");
+  }
+}
+
+static void OnCmdDone(ATCmd_t Cmd, ATEerror_t Status)
+{
+  if (DoneNb < DONE_MAX)
+  {
+    DoneCmd[DoneNb] = Cmd;
+    DoneStatus[DoneNb] = Status;
+  }
+  if (Cmd == AT_DEUI)
+  {
+    DoneDevEui = (memcmp(dt.id.deveui, DevEui, sizeof(DevEui)) == 0);
+  }
+  DoneNb++;
+}
+
+static void OnEvent(const char *Event)
+{
+  strncat(Events, Event, sizeof(Events) - strlen(Events) - 2);
+  strcat(Events, "|");
+}
+
+/**
+ * @brief  Main loop of the application
+ * @param  Ms duration in ms
+ * @retval None
+ */
+static void Run(uint32_t Ms)
+{
+  while (Ms-- != 0)
+  {
+    Modem_Engine_Process();
+    SimModem_Step(1);
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
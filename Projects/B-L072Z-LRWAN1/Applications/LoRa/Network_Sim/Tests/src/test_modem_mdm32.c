@@ -0,0 +1,226 @@
+/**
+  ******************************************************************************
+  * @file    test_modem_mdm32.c
+  * @author  MCD Application Team
+  * @brief   Loopback test of the MDM32L07X01 AT driver, its modem_uart
+  *          reception and modem_engine pipeline against a simulated AT slave
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "stm32l0xx_hal.h"
+#include "modem_uart.h"
+#include "modem_engine.h"
+#include "atcmd.h"
+#include "sim_modem.h"
+#include "sim_test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define DONE_MAX                     16
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static bool ModemMute = false;
+
+static char Received[1024];                /* commands received by the modem */
+
+static uint32_t DoneNb = 0;
+static ATCmd_t DoneCmd[DONE_MAX];
+static ATEerror_t DoneStatus[DONE_MAX];
+
+static char Events[256];
+
+/* Private function prototypes -----------------------------------------------*/
+static void OnModemCommand(const char *Cmd, uint16_t Len);
+static void OnCmdDone(ATCmd_t Cmd, ATEerror_t Status);
+static void OnEvent(const char *Event);
+static void Run(uint32_t Ms);
+
+static const Modem_AT_Callbacks_t AtCallbacks = { OnCmdDone, OnEvent };
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  char deui[32];
+  char small[8 + 1];
+  uint8_t adr = 1;
+  uint8_t dr = 9;
+  uint32_t start;
+  char longline[300];
+
+  SimModem_Init(OnModemCommand);
+  SIM_TEST_CHECK(Modem_IO_Init() == AT_OK);
+
+  /* Blocking commands, the MCU sleeps on the reception buffer. The GET value
+     is the line up to its '\n' */
+  memset(deui, 0, sizeof(deui));
+  SIM_TEST_CHECK(Modem_AT_Cmd(AT_GET, AT_DEUI, deui) == AT_OK);
+  SIM_TEST_CHECK(strcmp(deui, "01:02:03:04:05:06:07:08\r") == 0);
+  SIM_TEST_CHECK(Modem_AT_Cmd(AT_SET, AT_ADR, &adr) == AT_OK);
+  SIM_TEST_CHECK(Modem_AT_Cmd(AT_SET, AT_DR, &dr) == AT_PARAM_ERROR);
+
+  /* No room for a line: no wait, an empty string */
+  start = SimModem_GetTime();
+  small[0] = '#';
+  SIM_TEST_CHECK(Modem_UART_ReadLine(small, 1, 1000) == 0);
+  SIM_TEST_CHECK((small[0] == '\0') && (SimModem_GetTime() == start));
+
+  /* Not a command: nothing is sent */
+  SIM_TEST_CHECK(Modem_AT_Cmd(AT_GET, AT_END_AT, deui) == AT_END_ERROR);
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_GET, AT_END_AT, deui, sizeof(deui)) == AT_END_ERROR);
+
+  /* Pipeline: the queue takes four commands, each one leaves as soon as the
+     previous response is complete */
+  SIM_TEST_CHECK(Modem_AT_AsyncInit(&AtCallbacks) == AT_OK);
+  Received[0] = '\0';
+  memset(deui, 0, sizeof(deui));
+  start = SimModem_GetTime();
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_GET, AT_DEUI, deui, sizeof(deui)) == AT_OK);
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_SET, AT_ADR, &adr, 0) == AT_OK);
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_SET, AT_DR, &dr, 0) == AT_OK);
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_CTRL, AT_JOIN, NULL, 0) == AT_OK);
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_CTRL, AT, NULL, 0) == AT_BUSY_ERROR);
+  SIM_TEST_CHECK(Modem_Engine_IsIdle() == 0);
+  while ((DoneNb < 4) && (SimModem_GetTime() - start < 1000))
+  {
+    Run(1);
+  }
+  SIM_TEST_CHECK(strcmp(Received, "AT+DEUI=?\r\nAT+ADR=1\r\nAT+DR=9\r\nAT+JOIN\r\n") == 0);
+  SIM_TEST_CHECK(DoneNb == 4);
+  SIM_TEST_CHECK((DoneCmd[0] == AT_DEUI) && (DoneStatus[0] == AT_OK));
+  SIM_TEST_CHECK(strcmp(deui, "01:02:03:04:05:06:07:08") == 0);
+  SIM_TEST_CHECK((DoneCmd[1] == AT_ADR) && (DoneStatus[1] == AT_OK));
+  SIM_TEST_CHECK((DoneCmd[2] == AT_DR) && (DoneStatus[2] == AT_PARAM_ERROR));
+  SIM_TEST_CHECK((DoneCmd[3] == AT_JOIN) && (DoneStatus[3] == AT_OK));
+  SIM_TEST_CHECK(Modem_Engine_IsIdle() == 1);
+  printf("4 pipelined commands in %u ms\n", (unsigned)(SimModem_GetTime() - start));
+  Run(100);
+  SIM_TEST_CHECK(strcmp(Events, "JOINED|") == 0);
+
+  /* A GET value longer than its buffer is truncated */
+  memset(small, '#', sizeof(small));
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_GET, AT_DEUI, small, sizeof(small) - 1) == AT_OK);
+  Run(100);
+  SIM_TEST_CHECK((DoneNb == 5) && (DoneStatus[4] == AT_OK));
+  SIM_TEST_CHECK(strcmp(small, "01:02:0") == 0);
+  SIM_TEST_CHECK(small[sizeof(small) - 1] == '#');
+
+  /* No response: timeout, then the next command goes through */
+  ModemMute = true;
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_CTRL, AT, NULL, 0) == AT_OK);
+  Run(9000);
+  SIM_TEST_CHECK(DoneNb == 5);
+  Run(2000);
+  SIM_TEST_CHECK((DoneNb == 6) && (DoneStatus[5] == AT_UART_LINK_ERROR));
+  ModemMute = false;
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_CTRL, AT, NULL, 0) == AT_OK);
+  Run(50);
+  SIM_TEST_CHECK((DoneNb == 7) && (DoneStatus[6] == AT_OK));
+
+  /* The reset is not answered, it completes once sent */
+  SIM_TEST_CHECK(Modem_AT_CmdAsync(AT_CTRL, AT_RESET, NULL, 0) == AT_OK);
+  Run(50);
+  SIM_TEST_CHECK((DoneNb == 8) && (DoneCmd[7] == AT_RESET) && (DoneStatus[7] == AT_OK));
+
+  /* Unsolicited lines: a null character sent on wake up, a line longer than
+     the engine buffer dropped */
+  Events[0] = '\0';
+  SimModem_Send("\0+RX:1\r\n", 8);
+  memset(longline, 'x', sizeof(longline));
+  SimModem_Send(longline, sizeof(longline));
+  SimModem_SendString("\r\nEVT2\r\n");
+  Run(400);
+  SIM_TEST_CHECK(strcmp(Events, "+RX:1|EVT2|") == 0);
+
+  /* A UART error stops the DMA, the reception restarts on the next read */
+  Events[0] = '\0';
+  SimModem_RxError();
+  Run(10);
+  SimModem_SendString("EVT3\r\n");
+  Run(50);
+  SIM_TEST_CHECK(strcmp(Events, "EVT3|") == 0);
+
+  Modem_IO_DeInit();
+  return SimTest_Report("test_modem_mdm32");
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  B-L072Z-LRWAN1 AT slave: a GET value line before the return code,
+ *         JOINED sent after the join return code
+ * @param  Cmd received command
+ * @param  Len command length
+ * @retval None
+ */
+static void OnModemCommand(const char *Cmd, uint16_t Len)
+{
+  strncat(Received, Cmd, sizeof(Received) - strlen(Received) - 1);
+  if (ModemMute)
+  {
+    return;
+  }
+  if (strcmp(Cmd, "AT+DEUI=?\r\n") == 0)
+  {
+    SimModem_SendString("01:02:03:04:05:06:07:08\r\n\r\nOK\r\n");
+  }
+  else if (strcmp(Cmd, "AT+JOIN\r\n") == 0)
+  {
+    SimModem_SendString("\r\nOK\r\n\r\nJOINED\r\n");
+  }
+  else if (strcmp(Cmd, "AT+DR=9\r\n") == 0)
+  {
+    SimModem_SendString("\r\nAT_PARAM_ERROR\r\n");
+  }
+  else if (strcmp(Cmd, "ATZ\r\n") != 0)
+  {
+    SimModem_SendString("\r\nOK\r\n");
+  }
+}
+
+static void OnCmdDone(ATCmd_t Cmd, ATEerror_t Status)
+{
+  if (DoneNb < DONE_MAX)
+  {
+    DoneCmd[DoneNb] = Cmd;
+    DoneStatus[DoneNb] = Status;
+  }
+  DoneNb++;
+}
+
+static void OnEvent(const char *Event)
+{
+  strncat(Events, Event, sizeof(Events) - strlen(Events) - 2);
+  strcat(Events, "|");
+}
+
+/**
+ * @brief  Main loop of the application
+ * @param  Ms duration in ms
+ * @retval None
+ */
+static void Run(uint32_t Ms)
+{
+  while (Ms-- != 0)
+  {
+    Modem_Engine_Process();
+    SimModem_Step(1);
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,362 @@
+/**
+  ******************************************************************************
+  * @file    test_rtc_timebase.c
+  * @author  MCD Application Team
+  * @brief   Test of the time base of the End_Node RTC driver against a
+  *          simulated RTC: calendar boundaries, monotonicity, reads racing
+  *          the RTC and interrupts, interrupt mask and alarm calendar
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "hw.h"
+#include "sim_rtc_hal.h"
+#include "sim_test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define TICKS_PER_SECOND             ((uint64_t) SIM_RTC_TICKS_PER_SECOND)
+
+#define TICKS_PER_DAY                (TICKS_PER_SECOND * 86400)
+
+#define REFERENCES_NB                (sizeof(References) / sizeof(References[0]))
+
+/* Reads of the time base around each reference */
+#define STEPS_NB                     (3 * TICKS_PER_SECOND)
+
+/* Largest number of ticks a read can span, its reads of the sub-seconds
+   register included */
+#define ISR_READS_MAX                16
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Calendar references, the last tick of a day unless noted */
+static const struct
+{
+  int Year;
+  int Month;
+  int Date;
+  int Hours;
+  int Minutes;
+  int Seconds;
+} References[] =
+{
+  { 2000, 1, 1, 0, 0, 0 },                  /* start of the time base */
+  { 2000, 1, 31, 23, 59, 59 },
+  { 2000, 2, 18, 13, 5, 4 },                /* wrap of the 32 bits timer value */
+  { 2000, 2, 28, 23, 59, 59 },              /* leap year */
+  { 2000, 2, 29, 23, 59, 59 },
+  { 2000, 12, 31, 23, 59, 59 },
+  { 2001, 2, 28, 23, 59, 59 },
+  { 2003, 12, 31, 23, 59, 59 },
+  { 2004, 2, 29, 23, 59, 59 },
+  { 2019, 6, 30, 23, 59, 59 },
+  { 2024, 2, 29, 12, 0, 0 },
+  { 2099, 12, 31, 23, 59, 59 },             /* end of the RTC calendar */
+};
+
+/* Timeouts of the alarms, in ticks */
+static const uint32_t Timeouts[] =
+{
+  4, 1000, 1024, 65 * 1024 + 17, 3600 * 1024 + 1023, 86400 * 1024, 86400 * 1024 + 5000, 10 * 86400 * 1024 + 3
+};
+
+/* Time base read by the interrupt handler, once per read of the main loop */
+static bool IsrArmed = false;
+static uint64_t IsrTimeBase = 0;
+static uint32_t IsrCalls = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint64_t Ticks(int Year, int Month, int Date, int Hours, int Minutes, int Seconds);
+
+static void TestCalendar(void);
+
+static void TestRacingReads(void);
+
+static void TestInterrupts(void);
+
+static void TestPrimask(void);
+
+static void TestAlarms(void);
+
+static void OnIrq(void);
+
+/* Exported functions ---------------------------------------------------------*/
+int main(void)
+{
+  HW_RTC_Init();
+
+  TestCalendar();
+  TestRacingReads();
+  TestInterrupts();
+  TestPrimask();
+  TestAlarms();
+
+  return SimTest_Report("rtc time base");
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Ticks of a date since 01/01/2000 at midnight
+ */
+static uint64_t Ticks(int Year, int Month, int Date, int Hours, int Minutes, int Seconds)
+{
+  struct tm calendar;
+  struct tm origin;
+
+  memset(&calendar, 0, sizeof(calendar));
+  calendar.tm_year = Year - 1900;
+  calendar.tm_mon = Month - 1;
+  calendar.tm_mday = Date;
+  calendar.tm_hour = Hours;
+  calendar.tm_min = Minutes;
+  calendar.tm_sec = Seconds;
+
+  memset(&origin, 0, sizeof(origin));
+  origin.tm_year = 100;
+  origin.tm_mday = 1;
+
+  return (uint64_t)(timegm(&calendar) - timegm(&origin)) * TICKS_PER_SECOND;
+}
+
+/**
+ * @brief  The time base, the timer value and the calendar time across the
+ *         day, month and year boundaries, against the HAL calendar path
+ */
+static void TestCalendar(void)
+{
+  for (uint32_t i = 0; i < REFERENCES_NB; i++)
+  {
+    uint64_t start = Ticks(References[i].Year, References[i].Month, References[i].Date,
+                           References[i].Hours, References[i].Minutes, References[i].Seconds);
+
+    /* from the first tick of the second before */
+    if (start >= TICKS_PER_SECOND)
+    {
+      start -= TICKS_PER_SECOND;
+    }
+
+    uint64_t previous = 0;
+
+    for (uint64_t tick = start; tick < (start + STEPS_NB); tick++)
+    {
+      uint64_t timeBase;
+      uint32_t seconds;
+      uint16_t mSeconds;
+
+      SimRtc_Set(tick);
+      timeBase = HW_RTC_GetTimeBase();
+      if (!SIM_TEST_CHECK(timeBase == tick))
+      {
+        printf("  %04d-%02d-%02d: tick %llu read %llu\n", References[i].Year, References[i].Month,
+               References[i].Date, (unsigned long long) tick, (unsigned long long) timeBase);
+        break;
+      }
+      if ((tick != start) && !SIM_TEST_CHECK(timeBase == (previous + 1)))
+      {
+        break;
+      }
+      previous = timeBase;
+
+      if ((tick % 97) == 0)
+      {
+        SIM_TEST_CHECK(HW_RTC_GetCalendarTick() == tick);
+        SIM_TEST_CHECK(HW_RTC_GetTimerValue() == (uint32_t) tick);
+
+        seconds = HW_RTC_GetCalendarTime(&mSeconds);
+        SIM_TEST_CHECK(seconds == (uint32_t)(tick / TICKS_PER_SECOND));
+        SIM_TEST_CHECK(mSeconds == HW_RTC_Tick2ms((uint32_t)(tick % TICKS_PER_SECOND)));
+      }
+    }
+    SIM_TEST_CHECK(HW_RTC_GetCalendarTick() == (start + STEPS_NB - 1));
+  }
+}
+
+/**
+ * @brief  The RTC advances between the reads of its registers, across the
+ *         midnight of a month end: every time base read lies between the
+ *         RTC before and after the read, and never decreases
+ */
+static void TestRacingReads(void)
+{
+  uint64_t midnight = Ticks(2000, 3, 1, 0, 0, 0);
+
+  /* the driver reads the sub-seconds twice per attempt, a tick on every
+     attempt would never let it complete, as no RTC would do */
+  for (uint32_t readsPerTick = 3; readsPerTick <= 6; readsPerTick++)
+  {
+    for (uint32_t phase = 0; phase < readsPerTick; phase++)
+    {
+      uint64_t previous = 0;
+      bool passed = true;
+
+      SimRtc_Set(midnight - 4);
+      SimRtc_SetStepOnRead(readsPerTick);
+      /* shifts the reads of the driver against the RTC steps */
+      for (uint32_t k = 0; k < phase; k++)
+      {
+        LL_RTC_TIME_GetSubSecond(RTC);
+      }
+
+      for (uint32_t k = 0; k < 32; k++)
+      {
+        uint64_t before = SimRtc_Get();
+        uint64_t timeBase = HW_RTC_GetTimeBase();
+        uint64_t after = SimRtc_Get();
+
+        passed &= SIM_TEST_CHECK((timeBase >= before) && (timeBase <= after));
+        passed &= SIM_TEST_CHECK(timeBase >= previous);
+        previous = timeBase;
+        if (!passed)
+        {
+          printf("  %u reads per tick, phase %u: read %llu between %llu and %llu\n", readsPerTick, phase,
+                 (unsigned long long) timeBase, (unsigned long long) before, (unsigned long long) after);
+          break;
+        }
+      }
+      SIM_TEST_CHECK(previous > midnight);
+      SimRtc_SetStepOnRead(0);
+    }
+  }
+}
+
+/**
+ * @brief  Interrupt reading the time base
+ */
+static void OnIrq(void)
+{
+  if (IsrArmed == false)
+  {
+    return;
+  }
+  IsrArmed = false;
+  IsrTimeBase = HW_RTC_GetTimeBase();
+  IsrCalls++;
+}
+
+/**
+ * @brief  An interrupt reading the time base during every read of the main
+ *         loop, the date cache switching day under both
+ */
+static void TestInterrupts(void)
+{
+  uint64_t midnight = Ticks(2000, 12, 31, 0, 0, 0) + TICKS_PER_DAY;
+
+  SimRtc_Set(midnight - 4);
+  SimRtc_SetStepOnRead(3);
+  SimRtc_SetIrqOnRead(OnIrq);
+
+  for (uint32_t k = 0; k < 16; k++)
+  {
+    uint64_t before = SimRtc_Get();
+    uint32_t calls = IsrCalls;
+    uint64_t timeBase;
+
+    IsrArmed = true;
+    timeBase = HW_RTC_GetTimeBase();
+    uint64_t after = SimRtc_Get();
+
+    SIM_TEST_CHECK(IsrCalls > calls);
+    SIM_TEST_CHECK((IsrTimeBase >= before) && (IsrTimeBase <= after));
+    SIM_TEST_CHECK((timeBase >= before) && (timeBase <= after));
+    SIM_TEST_CHECK((after - before) <= ISR_READS_MAX);
+  }
+
+  SimRtc_SetIrqOnRead(NULL);
+  SimRtc_SetStepOnRead(0);
+
+  /* the cache holds the new date */
+  SimRtc_Set(midnight + 1);
+  SIM_TEST_CHECK(HW_RTC_GetTimeBase() == (midnight + 1));
+  SimRtc_Set(midnight - 1);
+  SIM_TEST_CHECK(HW_RTC_GetTimeBase() == (midnight - 1));
+}
+
+/**
+ * @brief  The date cache is accessed with the interrupts masked, and the
+ *         interrupt mask of the caller is restored
+ */
+static void TestPrimask(void)
+{
+  uint32_t masks = SimRtc_GetIrqMasks();
+
+  SimRtc_Set(Ticks(2012, 7, 14, 10, 0, 0));
+
+  __set_PRIMASK(0);
+  HW_RTC_GetTimeBase();
+  SIM_TEST_CHECK(SimRtc_GetIrqMasks() == (masks + 1));
+  SIM_TEST_CHECK(__get_PRIMASK() == 0);
+
+  __set_PRIMASK(1);
+  HW_RTC_GetTimeBase();
+  HW_RTC_GetTimerValue();
+  SIM_TEST_CHECK(__get_PRIMASK() == 1);
+
+  __set_PRIMASK(0);
+}
+
+/**
+ * @brief  The alarm calendar converted from the timer context is the
+ *         calendar of the context plus the timeout
+ */
+static void TestAlarms(void)
+{
+  for (uint32_t i = 0; i < REFERENCES_NB; i++)
+  {
+    uint64_t reference = Ticks(References[i].Year, References[i].Month, References[i].Date,
+                               References[i].Hours, References[i].Minutes, References[i].Seconds) +
+                         (i * 131) % TICKS_PER_SECOND;
+
+    for (uint32_t j = 0; j < (sizeof(Timeouts) / sizeof(Timeouts[0])); j++)
+    {
+      const RTC_AlarmTypeDef *alarm = SimRtc_GetAlarm();
+      uint64_t expected = reference + Timeouts[j];
+      time_t seconds = (time_t)(expected / TICKS_PER_SECOND) + 946684800;
+      struct tm calendar;
+
+      /* the calendar of the RTC stops at the end of 2099 */
+      if (expected >= Ticks(2100, 1, 1, 0, 0, 0))
+      {
+        continue;
+      }
+
+      SimRtc_Set(reference);
+      SIM_TEST_CHECK(HW_RTC_SetTimerContext() == (uint32_t) reference);
+      SIM_TEST_CHECK(HW_RTC_GetTimerContext() == (uint32_t) reference);
+      HW_RTC_SetAlarm(Timeouts[j]);
+
+      gmtime_r(&seconds, &calendar);
+      if (!SIM_TEST_CHECK((alarm->AlarmDateWeekDay == calendar.tm_mday) &&
+                          (alarm->AlarmTime.Hours == calendar.tm_hour) &&
+                          (alarm->AlarmTime.Minutes == calendar.tm_min) &&
+                          (alarm->AlarmTime.Seconds == calendar.tm_sec) &&
+                          (alarm->AlarmTime.SubSeconds == ((TICKS_PER_SECOND - 1) - (expected % TICKS_PER_SECOND)))))
+      {
+        printf("  %04d-%02d-%02d + %u ticks: alarm %u %02u:%02u:%02u ssr %u, expected %d %02d:%02d:%02d ssr %u\n",
+               References[i].Year, References[i].Month, References[i].Date, Timeouts[j],
+               alarm->AlarmDateWeekDay, alarm->AlarmTime.Hours, alarm->AlarmTime.Minutes,
+               alarm->AlarmTime.Seconds, (unsigned) alarm->AlarmTime.SubSeconds, calendar.tm_mday,
+               calendar.tm_hour, calendar.tm_min, calendar.tm_sec,
+               (unsigned)((TICKS_PER_SECOND - 1) - (expected % TICKS_PER_SECOND)));
+      }
+    }
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
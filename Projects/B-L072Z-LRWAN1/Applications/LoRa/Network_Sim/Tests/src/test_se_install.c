@@ -0,0 +1,303 @@
+/**
+  ******************************************************************************
+  * @file    test_se_install.c
+  * @author  MCD Application Team
+  * @brief   Host test of the streaming install of se_interface_bootloader.c:
+  *          SE_IMG_Install_Init/Append/Finish decrypt an image into the
+  *          file-backed flash, with the writes started and waited (pipeline)
+  *          or blocking, and fail on a corrupted image or bad parameters.
+  *          AES-GCM, or AES-CBC and SHA256 when SIM_SE_AES_CBC_SHA256 is
+  *          defined.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "se_interface_bootloader.h"
+#include "sim_flash.h"
+#include "sim_se.h"
+#include "sim_test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define FLASH_SIZE                   ( 128 * 1024 )
+
+/* Programming time of a double word, short to keep the test fast but long
+   enough for the decryption to overlap the writes */
+#define FLASH_PROGRAM_TIME           2000
+
+/* Download slot of the image */
+#define SLOT_ADDRESS                 ( SIM_FLASH_BASE + 0x8000 )
+
+/* Image size, AES-CBC needs whole blocks, AES-GCM ends with a partial one */
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+#define IMAGE_SIZE                   ( 48 * 1024 + 5 )
+#else
+#define IMAGE_SIZE                   ( 48 * 1024 )
+#endif /* SECBOOT_CRYPTO_SCHEME */
+
+#define CHUNK_SIZE_MAX               4096
+
+/* Room left at the end of the flash by the overflowing install */
+#define OVERFLOW_ROOM                ( 16 * 1024 )
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static const SE_IMG_FlashOpsTypeDef PipelineOps = { SimFlash_WriteStart, SimFlash_WriteWait };
+
+static const SE_IMG_FlashOpsTypeDef BlockingOps = { SimFlash_Write, SimFlash_WriteNone };
+
+static const uint32_t ChunkSizes[] = { 16, 64, 1024, CHUNK_SIZE_MAX };
+
+static uint8_t Clear[IMAGE_SIZE];
+
+static uint8_t Encrypted[IMAGE_SIZE];
+
+static uint8_t Flash[FLASH_SIZE];
+
+static SE_FwRawHeaderTypeDef Metadata;
+
+static uint8_t Buffers[2][CHUNK_SIZE_MAX];
+
+/* Private function prototypes -----------------------------------------------*/
+static SE_ErrorStatus Install(const SE_IMG_FlashOpsTypeDef *Ops, uint32_t ChunkSize, uint32_t Address,
+                              SE_StatusTypeDef *Status, SE_IMG_InstallCtxTypeDef *Ctx);
+static bool Installed(uint32_t Address);
+static void TestInstall(void);
+static void TestCorruption(void);
+static void TestParameters(void);
+static void TestOverflow(void);
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  srand(1);
+  for (uint32_t i = 0; i < IMAGE_SIZE; i++)
+  {
+    Clear[i] = (uint8_t) rand();
+  }
+  if ((SimSe_EncryptImage(Clear, IMAGE_SIZE, &Metadata, Encrypted) != 0)
+      || (SimFlash_Init(FLASH_SIZE, FLASH_PROGRAM_TIME) != 0))
+  {
+    printf("cannot prepare the image\n");
+    return 1;
+  }
+
+  TestInstall();
+  TestCorruption();
+  TestParameters();
+  TestOverflow();
+
+  SIM_TEST_CHECK(SimSe_GetStats(false).SecureModeErrors == 0);
+  SimFlash_DeInit();
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+  return SimTest_Report("se install");
+#else
+  return SimTest_Report("se install, AES-CBC and SHA256");
+#endif /* SECBOOT_CRYPTO_SCHEME */
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Installs the encrypted image in chunks of ChunkSize bytes, the
+ *         pipeline is always flushed by SE_IMG_Install_Finish
+ */
+static SE_ErrorStatus Install(const SE_IMG_FlashOpsTypeDef *Ops, uint32_t ChunkSize, uint32_t Address,
+                              SE_StatusTypeDef *Status, SE_IMG_InstallCtxTypeDef *Ctx)
+{
+  SE_ErrorStatus e_ret_status;
+  uint8_t output[32];
+  int32_t output_size;
+
+  e_ret_status = SE_IMG_Install_Init(Status, Ctx, Ops, Buffers[0], Buffers[1], ChunkSize,
+                                     (void *)(uintptr_t) Address, &Metadata, SE_FW_IMAGE_COMPLETE);
+  if (e_ret_status != SE_SUCCESS)
+  {
+    return e_ret_status;
+  }
+  for (uint32_t offset = 0; (offset < IMAGE_SIZE) && (e_ret_status == SE_SUCCESS); offset += ChunkSize)
+  {
+    uint32_t size = IMAGE_SIZE - offset;
+
+    if (size > ChunkSize)
+    {
+      size = ChunkSize;
+    }
+    e_ret_status = SE_IMG_Install_Append(Status, Ctx, &Encrypted[offset], (int32_t) size);
+  }
+  if (SE_IMG_Install_Finish(Status, Ctx, output, &output_size) != SE_SUCCESS)
+  {
+    e_ret_status = SE_ERROR;
+  }
+  return e_ret_status;
+}
+
+/**
+ * @brief  Checks the flash: the clear image at Address, erased elsewhere
+ */
+static bool Installed(uint32_t Address)
+{
+  uint32_t offset = Address - SIM_FLASH_BASE;
+
+  if (SimFlash_Read(SIM_FLASH_BASE, Flash, FLASH_SIZE) != 0)
+  {
+    return false;
+  }
+  if (memcmp(&Flash[offset], Clear, IMAGE_SIZE) != 0)
+  {
+    return false;
+  }
+  for (uint32_t i = 0; i < FLASH_SIZE; i++)
+  {
+    if (((i < offset) || (i >= offset + IMAGE_SIZE)) && (Flash[i] != 0xFF))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief  Installs with each chunk size, pipelined and blocking writes
+ */
+static void TestInstall(void)
+{
+  SE_IMG_InstallCtxTypeDef ctx;
+  SE_StatusTypeDef status;
+  SimFlash_Stats_t flash;
+  SimSe_Stats_t se;
+
+  for (uint32_t c = 0; c < sizeof(ChunkSizes) / sizeof(ChunkSizes[0]); c++)
+  {
+    for (uint32_t pipeline = 0; pipeline < 2; pipeline++)
+    {
+      uint32_t chunks = (IMAGE_SIZE + ChunkSizes[c] - 1) / ChunkSizes[c];
+
+      SimFlash_Erase();
+      SimFlash_GetStats(true);
+      SimSe_GetStats(true);
+      SIM_TEST_CHECK(Install((pipeline != 0) ? &PipelineOps : &BlockingOps, ChunkSizes[c], SLOT_ADDRESS, &status,
+                             &ctx) == SE_SUCCESS);
+      SIM_TEST_CHECK(status == SE_OK);
+      SIM_TEST_CHECK(ctx.InstalledSize == IMAGE_SIZE);
+      SIM_TEST_CHECK(ctx.WritePending == 0);
+      SIM_TEST_CHECK(Installed(SLOT_ADDRESS));
+
+      flash = SimFlash_GetStats(false);
+      SIM_TEST_CHECK(flash.Errors == 0);
+      SIM_TEST_CHECK(flash.Writes == chunks);
+      SIM_TEST_CHECK(flash.Bytes == IMAGE_SIZE);
+
+      se = SimSe_GetStats(false);
+      SIM_TEST_CHECK(se.DecryptedBytes == IMAGE_SIZE);
+#if (SECBOOT_CRYPTO_SCHEME == SECBOOT_AES128_GCM_AES128_GCM_AES128_GCM)
+      SIM_TEST_CHECK(se.CallGates == chunks + 2);
+#else
+      SIM_TEST_CHECK(se.AuthenticatedBytes == IMAGE_SIZE);
+      SIM_TEST_CHECK(se.CallGates == 2 * chunks + 4);
+#endif /* SECBOOT_CRYPTO_SCHEME */
+    }
+  }
+}
+
+/**
+ * @brief  A corrupted image or tag fails the install at the Finish
+ */
+static void TestCorruption(void)
+{
+  SE_IMG_InstallCtxTypeDef ctx;
+  SE_StatusTypeDef status;
+
+  /* Ciphertext byte */
+  Encrypted[IMAGE_SIZE / 2] ^= 0x01;
+  SimFlash_Erase();
+  SIM_TEST_CHECK(Install(&PipelineOps, 1024, SLOT_ADDRESS, &status, &ctx) == SE_ERROR);
+  SIM_TEST_CHECK(status == SE_SIGNATURE_ERR);
+  SIM_TEST_CHECK(ctx.WritePending == 0);
+  Encrypted[IMAGE_SIZE / 2] ^= 0x01;
+
+  /* Firmware tag */
+  Metadata.FwTag[0] ^= 0x80;
+  SimFlash_Erase();
+  SIM_TEST_CHECK(Install(&BlockingOps, 1024, SLOT_ADDRESS, &status, &ctx) == SE_ERROR);
+  SIM_TEST_CHECK(status == SE_SIGNATURE_ERR);
+  Metadata.FwTag[0] ^= 0x80;
+
+  /* The engine is usable again */
+  SimFlash_Erase();
+  SIM_TEST_CHECK(Install(&PipelineOps, 1024, SLOT_ADDRESS, &status, &ctx) == SE_SUCCESS);
+  SIM_TEST_CHECK(Installed(SLOT_ADDRESS));
+}
+
+/**
+ * @brief  Parameters rejected before any Secure Engine call
+ */
+static void TestParameters(void)
+{
+  const SE_IMG_FlashOpsTypeDef no_wait = { SimFlash_WriteStart, NULL };
+  SE_IMG_InstallCtxTypeDef ctx;
+  SE_StatusTypeDef status;
+  uint8_t output[32];
+  void *slot = (void *)(uintptr_t) SLOT_ADDRESS;
+
+  SimSe_GetStats(true);
+  SIM_TEST_CHECK(SE_IMG_Install_Init(&status, &ctx, NULL, Buffers[0], Buffers[1], 1024, slot, &Metadata,
+                                     SE_FW_IMAGE_COMPLETE) == SE_ERROR);
+  SIM_TEST_CHECK(SE_IMG_Install_Init(&status, &ctx, &no_wait, Buffers[0], Buffers[1], 1024, slot, &Metadata,
+                                     SE_FW_IMAGE_COMPLETE) == SE_ERROR);
+  SIM_TEST_CHECK(SE_IMG_Install_Init(&status, &ctx, &PipelineOps, Buffers[0], NULL, 1024, slot, &Metadata,
+                                     SE_FW_IMAGE_COMPLETE) == SE_ERROR);
+  SIM_TEST_CHECK(SE_IMG_Install_Init(&status, &ctx, &PipelineOps, Buffers[0], Buffers[1], 8, slot, &Metadata,
+                                     SE_FW_IMAGE_COMPLETE) == SE_ERROR);
+  SIM_TEST_CHECK(SE_IMG_Install_Init(&status, &ctx, &PipelineOps, Buffers[0], Buffers[1], 1024, slot, &Metadata,
+                                     2) == SE_ERROR);
+  SIM_TEST_CHECK(SimSe_GetStats(false).CallGates == 0);
+
+  SimFlash_Erase();
+  SIM_TEST_CHECK(SE_IMG_Install_Init(&status, &ctx, &PipelineOps, Buffers[0], Buffers[1], 1024, slot, &Metadata,
+                                     SE_FW_IMAGE_COMPLETE) == SE_SUCCESS);
+  SIM_TEST_CHECK(SE_IMG_Install_Append(&status, &ctx, Encrypted, 1025) == SE_ERROR);
+  SIM_TEST_CHECK(SE_IMG_Install_Append(&status, &ctx, Encrypted, 0) == SE_ERROR);
+  SIM_TEST_CHECK(SE_IMG_Install_Append(&status, NULL, Encrypted, 1024) == SE_ERROR);
+  SIM_TEST_CHECK(ctx.InstalledSize == 0);
+  SIM_TEST_CHECK(SE_IMG_Install_Finish(&status, &ctx, output, NULL) == SE_ERROR);
+  /* The decryption is left started, the next Init restarts it */
+}
+
+/**
+ * @brief  An image crossing the end of the flash fails at the first write out
+ *         of it, the chunks before it are programmed
+ */
+static void TestOverflow(void)
+{
+  SE_IMG_InstallCtxTypeDef ctx;
+  SE_StatusTypeDef status;
+
+  for (uint32_t pipeline = 0; pipeline < 2; pipeline++)
+  {
+    SimFlash_Erase();
+    SimFlash_GetStats(true);
+    SIM_TEST_CHECK(Install((pipeline != 0) ? &PipelineOps : &BlockingOps, 1024,
+                           SIM_FLASH_BASE + FLASH_SIZE - OVERFLOW_ROOM, &status, &ctx) == SE_ERROR);
+    SIM_TEST_CHECK(ctx.InstalledSize == OVERFLOW_ROOM);
+    SIM_TEST_CHECK(ctx.WritePending == 0);
+    SIM_TEST_CHECK(SimFlash_GetStats(false).Errors == 1);
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
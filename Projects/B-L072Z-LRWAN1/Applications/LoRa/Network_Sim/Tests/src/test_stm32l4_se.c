@@ -0,0 +1,402 @@
+/**
+  ******************************************************************************
+  * @file    test_stm32l4_se.c
+  * @author  MCD Application Team
+  * @brief   Host test of stm32l4-se.c on the simulated AES peripheral: CMAC,
+  *          ECB, CTR and key derivation against soft-se.c, the write
+  *          protection of the root keys at their first use, and the NVM
+  *          context, which holds their check values but never the keys,
+  *          restored with and without a system reset
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2018 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "aes.h"
+#include "radio.h"
+#include "secure-element.h"
+#include "sim_soft_se.h"
+#include "sim_test.h"
+#include "stm32l4xx_hal.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Random operations compared with soft-se.c */
+#define COMPARE_ROUNDS               2000
+
+#define BUFFER_SIZE_MAX              256
+
+/* Size of the key check values of stm32l4-se.c */
+#define KCV_SIZE                     3
+
+/* NVM context copies */
+#define CTX_SIZE_MAX                 2048
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static const KeyIdentifier_t CompareKeys[] =
+{
+  APP_KEY, NWK_KEY, J_S_INT_KEY, J_S_ENC_KEY, F_NWK_S_INT_KEY, S_NWK_S_INT_KEY, NWK_S_ENC_KEY, APP_S_KEY
+};
+
+static const KeyIdentifier_t DerivedKeys[] =
+{
+  J_S_INT_KEY, J_S_ENC_KEY, F_NWK_S_INT_KEY, S_NWK_S_INT_KEY, NWK_S_ENC_KEY, APP_S_KEY
+};
+
+static uint8_t AppKey[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+
+static uint8_t NwkKey[16] = { 0x60, 0x3D, 0xEB, 0x10, 0x15, 0xCA, 0x71, 0xBE, 0x2B, 0x73, 0xAE, 0xF0, 0x85, 0x7D, 0x77, 0x81 };
+
+static uint8_t OtherKey[16] = { 0x1F, 0x35, 0x2C, 0x07, 0x3B, 0x61, 0x08, 0xD7, 0x2D, 0x98, 0x10, 0xA3, 0x09, 0x14, 0xDF, 0xF4 };
+
+static uint32_t NvmCtxChanges = 0;
+
+/* Root keys of stm32l4-se.c, alone in their section */
+extern uint8_t __stop_sram2_wp[];
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t TestRandom(void);
+static void OnNvmCtxChanged(void);
+static bool Contains(const uint8_t *Data, size_t Size, const uint8_t *Pattern, size_t PatternSize);
+static uint8_t *FindKcv(uint8_t *Ctx, size_t Size, const uint8_t *Key);
+static void TestCompare(void);
+static void TestRootKeys(void);
+static void TestRestore(void);
+
+/* Radio of the secure elements, only its random numbers are used */
+const struct Radio_s Radio =
+{
+  .Random = TestRandom,
+};
+
+/* Exported functions ------------------------------------------------------- */
+int main(void)
+{
+  srand(1);
+
+  TestCompare();
+  TestRootKeys();
+  TestRestore();
+
+  return SimTest_Report("stm32l4-se");
+}
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t TestRandom(void)
+{
+  return (uint32_t) rand();
+}
+
+static void OnNvmCtxChanged(void)
+{
+  NvmCtxChanges++;
+}
+
+static bool Contains(const uint8_t *Data, size_t Size, const uint8_t *Pattern, size_t PatternSize)
+{
+  for (size_t i = 0; i + PatternSize <= Size; i++)
+  {
+    if (memcmp(&Data[i], Pattern, PatternSize) == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief  Finds the key list slot of a root key in an NVM context: its check
+ *         value followed by zeros
+ */
+static uint8_t *FindKcv(uint8_t *Ctx, size_t Size, const uint8_t *Key)
+{
+  uint8_t slot[16] = { 0 };
+  uint8_t block[16] = { 0 };
+  aes_context context;
+
+  aes_set_key(Key, 16, &context);
+  aes_encrypt(block, block, &context);
+  memcpy(slot, block, KCV_SIZE);
+  for (size_t i = 0; i + sizeof(slot) <= Size; i++)
+  {
+    if (memcmp(&Ctx[i], slot, sizeof(slot)) == 0)
+    {
+      return &Ctx[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief  Random CMAC, ECB, CTR and key derivations with the root and session
+ *         keys, the results of soft-se.c expected
+ */
+static void TestCompare(void)
+{
+  uint8_t buffer[BUFFER_SIZE_MAX];
+  uint8_t reference[BUFFER_SIZE_MAX];
+  uint8_t b0[16];
+  uint8_t ctr[16];
+  uint8_t key[16];
+  Version_t version;
+  uint32_t cmac;
+  uint32_t referenceCmac;
+  uint32_t mismatches = 0;
+  uint32_t errors = 0;
+
+  version.Value = 0x01010000;
+  SimL4_Reset();
+  SIM_TEST_CHECK(SecureElementInit(NULL) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SoftSe_Init(NULL) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementSetKey(APP_KEY, AppKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementSetKey(NWK_KEY, NwkKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SoftSe_SetKey(APP_KEY, AppKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SoftSe_SetKey(NWK_KEY, NwkKey) == SECURE_ELEMENT_SUCCESS);
+
+  for (uint32_t round = 0; round < COMPARE_ROUNDS; round++)
+  {
+    KeyIdentifier_t keyID = CompareKeys[rand() % (sizeof(CompareKeys) / sizeof(CompareKeys[0]))];
+    uint16_t size = (uint16_t)(rand() % BUFFER_SIZE_MAX);
+    uint8_t *micBx = ((rand() & 1) != 0) ? b0 : NULL;
+
+    /* New session keys, set or derived from a root key */
+    if ((rand() % 8) == 0)
+    {
+      KeyIdentifier_t target = DerivedKeys[rand() % (sizeof(DerivedKeys) / sizeof(DerivedKeys[0]))];
+
+      for (uint8_t i = 0; i < 16; i++)
+      {
+        key[i] = (uint8_t) rand();
+      }
+      if ((rand() & 1) != 0)
+      {
+        errors += SecureElementSetKey(target, key) != SECURE_ELEMENT_SUCCESS;
+        errors += SoftSe_SetKey(target, key) != SECURE_ELEMENT_SUCCESS;
+      }
+      else
+      {
+        KeyIdentifier_t root = ((rand() & 1) != 0) ? APP_KEY : NWK_KEY;
+
+        errors += SecureElementDeriveAndStoreKey(version, key, root, target) != SECURE_ELEMENT_SUCCESS;
+        errors += SoftSe_DeriveAndStoreKey(version, key, root, target) != SECURE_ELEMENT_SUCCESS;
+      }
+    }
+
+    for (uint16_t i = 0; i < size; i++)
+    {
+      buffer[i] = (uint8_t) rand();
+    }
+    for (uint8_t i = 0; i < 16; i++)
+    {
+      b0[i] = (uint8_t) rand();
+      ctr[i] = (uint8_t) rand();
+    }
+    ctr[14] = 0;
+    ctr[15] = 1;
+
+    errors += SecureElementComputeAesCmac(micBx, buffer, size, keyID, &cmac) != SECURE_ELEMENT_SUCCESS;
+    errors += SoftSe_ComputeAesCmac(micBx, buffer, size, keyID, &referenceCmac) != SECURE_ELEMENT_SUCCESS;
+    mismatches += cmac != referenceCmac;
+
+    memcpy(reference, buffer, size);
+    errors += SecureElementAesCtrEncrypt(buffer, size, ctr, keyID) != SECURE_ELEMENT_SUCCESS;
+    errors += SoftSe_AesCtrEncrypt(reference, size, ctr, keyID) != SECURE_ELEMENT_SUCCESS;
+    mismatches += memcmp(buffer, reference, size) != 0;
+
+    if (size >= 16)
+    {
+      size &= ~15;
+      errors += SecureElementAesEncrypt(buffer, size, keyID, buffer) != SECURE_ELEMENT_SUCCESS;
+      errors += SoftSe_AesEncrypt(reference, size, keyID, reference) != SECURE_ELEMENT_SUCCESS;
+      mismatches += memcmp(buffer, reference, size) != 0;
+    }
+  }
+  SIM_TEST_CHECK(errors == 0);
+  SIM_TEST_CHECK(mismatches == 0);
+
+  /* The empty message of the CMAC */
+  SIM_TEST_CHECK(SecureElementComputeAesCmac(NULL, buffer, 0, NWK_KEY, &cmac) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SoftSe_ComputeAesCmac(NULL, buffer, 0, NWK_KEY, &referenceCmac) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(cmac == referenceCmac);
+
+  /* Frames of the same session key in ECB do not reload it */
+  uint32_t loads = SimL4_GetKeyLoads();
+  for (uint8_t i = 0; i < 8; i++)
+  {
+    SIM_TEST_CHECK(SecureElementComputeAesCmac(b0, buffer, 64, APP_S_KEY, &cmac) == SECURE_ELEMENT_SUCCESS);
+  }
+  SIM_TEST_CHECK(SimL4_GetKeyLoads() - loads <= 1);
+}
+
+/**
+ * @brief  Provisioning of the root keys, write protected at their first use
+ *         until the next system reset
+ */
+static void TestRootKeys(void)
+{
+  size_t rootKeysSize = (size_t)(__stop_sram2_wp - __start_sram2_wp);
+  uint8_t rootKeys[64];
+  uint8_t *ctx;
+  size_t ctxSize;
+  uint32_t cmac;
+  uint32_t lockedCmac;
+  uint8_t buffer[32] = { 0 };
+
+  SimL4_Reset();
+  NvmCtxChanges = 0;
+  SIM_TEST_CHECK(SecureElementInit(OnNvmCtxChanged) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(rootKeysSize <= sizeof(rootKeys));
+
+  /* Cleared at the start, unlike the retained SRAM2 */
+  for (size_t i = 0; i < rootKeysSize; i++)
+  {
+    SIM_TEST_CHECK(__start_sram2_wp[i] == 0);
+  }
+
+  /* Provisioning, a root key may be replaced until its first use */
+  SIM_TEST_CHECK(SecureElementSetKey(APP_KEY, AppKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementSetKey(NWK_KEY, OtherKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementSetKey(NWK_KEY, NwkKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(NvmCtxChanges == 3);
+  SIM_TEST_CHECK(SecureElementSetKey(APP_S_KEY, OtherKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementComputeAesCmac(NULL, buffer, sizeof(buffer), APP_S_KEY, &cmac) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SYSCFG->SWPR == 0);
+
+  /* The exported context has the check values, not the keys */
+  ctx = SecureElementGetNvmCtx(&ctxSize);
+  SIM_TEST_CHECK(!Contains(ctx, ctxSize, AppKey, sizeof(AppKey)));
+  SIM_TEST_CHECK(!Contains(ctx, ctxSize, NwkKey, sizeof(NwkKey)));
+  SIM_TEST_CHECK(FindKcv(ctx, ctxSize, AppKey) != NULL);
+  SIM_TEST_CHECK(FindKcv(ctx, ctxSize, NwkKey) != NULL);
+  SIM_TEST_CHECK(FindKcv(ctx, ctxSize, OtherKey) == NULL);
+
+  /* First use: the page of the root keys is write protected */
+  SIM_TEST_CHECK(SecureElementComputeAesCmac(NULL, buffer, sizeof(buffer), NWK_KEY, &lockedCmac) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SYSCFG->SWPR == 0x00000001);
+  memcpy(rootKeys, __start_sram2_wp, rootKeysSize);
+
+  /* The same key is accepted, another one rejected and not written */
+  SIM_TEST_CHECK(SecureElementSetKey(NWK_KEY, NwkKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementSetKey(NWK_KEY, OtherKey) == SECURE_ELEMENT_ERROR);
+  SIM_TEST_CHECK(SecureElementSetKey(APP_KEY, OtherKey) == SECURE_ELEMENT_ERROR);
+  SIM_TEST_CHECK(memcmp(rootKeys, __start_sram2_wp, rootKeysSize) == 0);
+  SIM_TEST_CHECK(SecureElementComputeAesCmac(NULL, buffer, sizeof(buffer), NWK_KEY, &cmac) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(cmac == lockedCmac);
+
+  /* The session keys are still set */
+  SIM_TEST_CHECK(SecureElementSetKey(APP_S_KEY, AppKey) == SECURE_ELEMENT_SUCCESS);
+
+  /* A restart without system reset keeps the protected keys */
+  SIM_TEST_CHECK(SecureElementInit(OnNvmCtxChanged) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SYSCFG->SWPR == 0x00000001);
+  SIM_TEST_CHECK(SecureElementComputeAesCmac(NULL, buffer, sizeof(buffer), NWK_KEY, &cmac) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(cmac == lockedCmac);
+  ctx = SecureElementGetNvmCtx(&ctxSize);
+  SIM_TEST_CHECK(FindKcv(ctx, ctxSize, NwkKey) != NULL);
+}
+
+/**
+ * @brief  NVM context restored with the root keys still protected, then
+ *         after a system reset before and after their provisioning
+ */
+static void TestRestore(void)
+{
+  static uint8_t saved[CTX_SIZE_MAX];
+  static uint8_t copy[CTX_SIZE_MAX];
+  uint8_t buffer[32] = { 0 };
+  uint8_t *ctx;
+  uint8_t *kcv;
+  size_t ctxSize;
+  uint32_t rootCmac;
+  uint32_t sessionCmac;
+  uint32_t cmac;
+
+  /* Provisioned and protected keys, a session key */
+  SimL4_Reset();
+  SIM_TEST_CHECK(SecureElementInit(OnNvmCtxChanged) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementSetKey(APP_KEY, AppKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementSetKey(NWK_KEY, NwkKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementSetKey(APP_S_KEY, OtherKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementComputeAesCmac(NULL, buffer, sizeof(buffer), NWK_KEY, &rootCmac) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementComputeAesCmac(NULL, buffer, sizeof(buffer), APP_S_KEY, &sessionCmac) == SECURE_ELEMENT_SUCCESS);
+  ctx = SecureElementGetNvmCtx(&ctxSize);
+  SIM_TEST_CHECK(ctxSize <= sizeof(saved));
+  memcpy(saved, ctx, ctxSize);
+
+  /* Same keys, check values matching */
+  SIM_TEST_CHECK(SecureElementRestoreNvmCtx(saved) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementComputeAesCmac(NULL, buffer, sizeof(buffer), NWK_KEY, &cmac) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(cmac == rootCmac);
+
+  /* Context of another root key */
+  memcpy(copy, saved, ctxSize);
+  kcv = FindKcv(copy, ctxSize, NwkKey);
+  SIM_TEST_CHECK(kcv != NULL);
+  if (kcv != NULL)
+  {
+    kcv[0] ^= 0x01;
+  }
+  SIM_TEST_CHECK(SecureElementRestoreNvmCtx(copy) == SECURE_ELEMENT_ERROR);
+  ctx = SecureElementGetNvmCtx(&ctxSize);
+  SIM_TEST_CHECK(FindKcv(ctx, ctxSize, NwkKey) != NULL);
+  SIM_TEST_CHECK(SecureElementRestoreNvmCtx(NULL) == SECURE_ELEMENT_ERROR_NPE);
+
+  /* System reset: the root keys are cleared, the restored context keeps the
+     session keys and the root keys are provisioned again */
+  SimL4_Reset();
+  SIM_TEST_CHECK(SecureElementInit(OnNvmCtxChanged) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementRestoreNvmCtx(saved) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementComputeAesCmac(NULL, buffer, sizeof(buffer), APP_S_KEY, &cmac) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(cmac == sessionCmac);
+  SIM_TEST_CHECK(SYSCFG->SWPR == 0);
+  NvmCtxChanges = 0;
+  SIM_TEST_CHECK(SecureElementSetKey(APP_KEY, AppKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementSetKey(NWK_KEY, NwkKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(NvmCtxChanges == 0);
+  SIM_TEST_CHECK(SecureElementComputeAesCmac(NULL, buffer, sizeof(buffer), NWK_KEY, &cmac) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(cmac == rootCmac);
+  SIM_TEST_CHECK(SYSCFG->SWPR == 0x00000001);
+
+  /* System reset, the root keys provisioned before the restore */
+  SimL4_Reset();
+  SIM_TEST_CHECK(SecureElementInit(OnNvmCtxChanged) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementSetKey(APP_KEY, AppKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementSetKey(NWK_KEY, OtherKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementRestoreNvmCtx(saved) == SECURE_ELEMENT_ERROR);
+  SIM_TEST_CHECK(SecureElementSetKey(NWK_KEY, NwkKey) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementRestoreNvmCtx(saved) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(SecureElementComputeAesCmac(NULL, buffer, sizeof(buffer), NWK_KEY, &cmac) == SECURE_ELEMENT_SUCCESS);
+  SIM_TEST_CHECK(cmac == rootCmac);
+
+  /* A context holding a root key in clear, as soft-se.c ones: only its
+     check value is kept */
+  SimL4_Reset();
+  SIM_TEST_CHECK(SecureElementInit(OnNvmCtxChanged) == SECURE_ELEMENT_SUCCESS);
+  memcpy(copy, saved, ctxSize);
+  kcv = FindKcv(copy, ctxSize, NwkKey);
+  if (kcv != NULL)
+  {
+    memcpy(kcv, NwkKey, sizeof(NwkKey));
+  }
+  SIM_TEST_CHECK(SecureElementRestoreNvmCtx(copy) == SECURE_ELEMENT_SUCCESS);
+  ctx = SecureElementGetNvmCtx(&ctxSize);
+  SIM_TEST_CHECK(!Contains(ctx, ctxSize, NwkKey, sizeof(NwkKey)));
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/